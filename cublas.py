@@ -0,0 +1,72 @@
+#! /usr/bin/env python
+# encoding: utf-8
+
+import os
+
+def configure(conf):
+    def get_param(varname,default):
+        return getattr(Options.options,varname,'')or default
+
+    if not conf.options.cublas_dir:
+        for d in ['CUDA_DIR','CUDA_HOME']:
+            env_dir=os.getenv(d)
+            if env_dir:
+                conf.to_log('Setting cublas_dir using environment variable: ' + d + '=' + env_dir)
+                conf.options.cublas_dir=env_dir
+
+    # cuBLAS is optional.  Only look for it if asked.
+    if not (conf.options.enable_cublas or conf.options.cublas_dir
+            or conf.options.cublas_incdir or conf.options.cublas_libdir):
+        return
+
+    # Find cuBLAS
+    if conf.options.cublas_dir:
+        conf.to_log('Using cublas_dir: ' + conf.options.cublas_dir)
+        if not conf.options.cublas_incdir:
+            conf.to_log('Setting cublas_incdir using cublas_dir: ' + conf.options.cublas_dir)
+            conf.options.cublas_incdir=conf.options.cublas_dir + "/include"
+        if not conf.options.cublas_libdir:
+            conf.to_log('Setting cublas_libdir using cublas_dir: ' + conf.options.cublas_dir)
+            conf.options.cublas_libdir=conf.options.cublas_dir + "/lib64"
+
+    if conf.options.cublas_incdir:
+        conf.to_log('Using cublas_incdir: ' + conf.options.cublas_incdir)
+        cublas_incdir=conf.options.cublas_incdir.split()
+    else:
+        cublas_incdir=[]
+    if conf.options.cublas_libdir:
+        conf.to_log('Using cublas_libdir: ' + conf.options.cublas_libdir)
+        cublas_libdir=conf.options.cublas_libdir.split()
+    else:
+        cublas_libdir=[]
+
+    if conf.options.cublas_libs:
+        conf.to_log('Using cublas_libs: ' + conf.options.cublas_libs)
+        cublas_libs=conf.options.cublas_libs.split()
+    else:
+        cublas_libs=['cublas','cudart']
+
+    conf.check_cxx(msg="Checking for cuBLAS",
+                   header_name='cublas_v2.h',
+                   includes=cublas_incdir,
+                   uselib_store='cublas',
+                   libpath=cublas_libdir,
+                   rpath=cublas_libdir,
+                   lib=cublas_libs,
+                   defines=['SDPB_USE_CUBLAS'],
+                   use=['cxx14'])
+
+def options(opt):
+    cublas=opt.add_option_group('cuBLAS Options')
+    cublas.add_option('--enable-cublas', action='store_true', default=False,
+                   help='Use cuBLAS for the double precision products in '
+                   'the mpmat matrix backend')
+    cublas.add_option('--cublas-dir',
+                   help='Base directory where CUDA is installed')
+    cublas.add_option('--cublas-incdir',
+                   help='Directory where cuBLAS include files are installed')
+    cublas.add_option('--cublas-libdir',
+                   help='Directory where cuBLAS library files are installed')
+    cublas.add_option('--cublas-libs',
+                   help='Names of the cuBLAS libraries without prefix or suffix\n'
+                   '(e.g. "cublas cudart")')
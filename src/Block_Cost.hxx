@@ -6,10 +6,17 @@
 struct Block_Cost
 {
   size_t cost, index;
+  // Estimated memory in bytes, or 0 if unknown.
+  size_t memory = 0;
   // Make sure that cost>0.  Otherwise, compute_block_grid_mapping can fail.
   Block_Cost(const size_t &Cost, const size_t &Index)
       : cost(Cost == 0 ? 1 : Cost), index(Index)
   {}
+  Block_Cost(const size_t &Cost, const size_t &Index, const size_t &Memory)
+      : Block_Cost(Cost, Index)
+  {
+    memory = Memory;
+  }
   Block_Cost() = delete;
   bool operator<(const Block_Cost &b) const { return cost < b.cost; }
 };
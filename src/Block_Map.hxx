@@ -8,6 +8,9 @@ struct Block_Map
   // not both.
   size_t num_procs = 0;
   size_t cost = 0;
+  // Estimated memory in bytes of all of the blocks and of the
+  // per-group workspace.
+  size_t memory = 0;
   std::vector<size_t> block_indices;
 
   Block_Map() = default;
@@ -17,7 +20,7 @@ struct Block_Map
   {}
   void clear()
   {
-    num_procs = cost = 0;
+    num_procs = cost = memory = 0;
     block_indices.clear();
   }
   // Sort by average cost
@@ -0,0 +1,35 @@
+#pragma once
+
+// An SDP that a converter hands straight to the solver, without
+// writing it to an sdp directory and reading it back.
+//
+// Each rank holds the blocks that it converted.  Every block records
+// the sizes that would go into blocks.<rank>, and its numbers are
+// kept as the images of files in the binary format of
+// binary_sdp_format.hxx, in the order
+//
+//   primal_objective_c, free_var_matrix, bilinear_bases[0],
+//   bilinear_bases[1]
+//
+// so that the solver can send each block to the ranks that own it as
+// a single message, and decode it at its own precision.  The
+// objectives are the same on every rank.
+
+#include <El.hpp>
+
+#include <array>
+#include <vector>
+
+struct In_Memory_Block
+{
+  size_t index, dimension, degree, schur_block_size, precision;
+  std::array<size_t, 2> psd_matrix_block_sizes, bilinear_pairing_block_sizes;
+  std::vector<char> data;
+};
+
+struct In_Memory_SDP
+{
+  El::BigFloat objective_const;
+  std::vector<El::BigFloat> dual_objective_b;
+  std::vector<In_Memory_Block> blocks;
+};
@@ -1,10 +1,12 @@
 #pragma once
 
+#include "set_number.hxx"
+
 #include <El.hpp>
 
 #include <libxml2/libxml/parser.h>
 #include <vector>
-#include <sstream>
+#include <string>
 #include <stdexcept>
 
 template <typename Float_Type> class Number_State
@@ -13,8 +15,8 @@ public:
   bool inside = false;
   // Need a string intermediate value because the parser may give the
   // element in chunks.  We need to concatenate them together
-  // ourselves.
-  std::stringstream string_value;
+  // ourselves.  Clearing it keeps its capacity for the next number.
+  std::string string_value;
   Float_Type value;
   std::string name;
 
@@ -37,7 +39,6 @@ public:
         inside = (element_name == name);
         if(inside)
           {
-            string_value.str("");
             string_value.clear();
           }
       }
@@ -50,15 +51,7 @@ public:
     if(inside)
       {
         inside = false;
-        try
-          {
-            value = Float_Type(string_value.str());
-          }
-        catch(...)
-          {
-            throw std::runtime_error("Invalid number: '" + string_value.str()
-                                     + "'");
-          }
+        set_number(string_value.c_str(), value);
       }
     return result;
   }
@@ -67,7 +60,8 @@ public:
   {
     if(inside)
       {
-        string_value.write(reinterpret_cast<const char *>(characters), length);
+        string_value.append(reinterpret_cast<const char *>(characters),
+                            length);
       }
     return inside;
   }
@@ -79,16 +73,11 @@ public:
                              + "' when expecting a number.");
   }
 
-  void json_string(const std::string &s)
+  void json_string(const std::string &s) { set_number(s.c_str(), value); }
+
+  void json_binary_number(const Binary_Number &number)
   {
-    try
-      {
-        value = Float_Type(s);
-      }
-    catch(...)
-      {
-        throw std::runtime_error("Invalid number: '" + s + "'");
-      }
+    set_number(number, value);
   }
 
   void json_start_array()
@@ -84,6 +84,7 @@ inline Polynomial operator/(const Polynomial &a, const El::BigFloat &b)
 inline void swap(std::vector<Polynomial> &polynomials,
                  std::vector<std::vector<El::BigFloat>> &elements_vector)
 {
+  polynomials.reserve(polynomials.size() + elements_vector.size());
   for(auto &elements : elements_vector)
     {
       polynomials.emplace_back();
@@ -95,6 +96,8 @@ inline void swap(
   std::vector<std::vector<Polynomial>> &polynomials_vector,
   std::vector<std::vector<std::vector<El::BigFloat>>> &elements_vector_vector)
 {
+  polynomials_vector.reserve(polynomials_vector.size()
+                             + elements_vector_vector.size());
   for(auto &elements_vector : elements_vector_vector)
     {
       polynomials_vector.emplace_back();
@@ -107,6 +110,8 @@ inline void swap(
   std::vector<std::vector<std::vector<std::vector<El::BigFloat>>>>
     &elements_vector_vector_vector)
 {
+  polynomials_vector_vector.reserve(polynomials_vector_vector.size()
+                                    + elements_vector_vector_vector.size());
   for(auto &elements_vector_vector : elements_vector_vector_vector)
     {
       polynomials_vector_vector.emplace_back();
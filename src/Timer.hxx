@@ -1,14 +1,111 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <malloc.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+struct Timer_Statistics;
+
+// Memory use of this process in bytes.  rss is the current resident
+// set size, peak_rss the high-water mark of the resident set so far,
+// and heap the bytes allocated with malloc.
+struct Memory_Sample
+{
+  int64_t rss = 0, peak_rss = 0, heap = 0;
+
+  static Memory_Sample now()
+  {
+    Memory_Sample result;
+    std::ifstream statm("/proc/self/statm");
+    int64_t size, resident;
+    if(statm >> size >> resident)
+      {
+        result.rss = resident * sysconf(_SC_PAGESIZE);
+      }
+    // ru_maxrss is in kilobytes on Linux.
+    rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0)
+      {
+        result.peak_rss = int64_t(usage.ru_maxrss) * 1024;
+      }
+#if defined(__GLIBC__)                                                        \
+  && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 info(mallinfo2());
+    result.heap = int64_t(info.uordblks) + int64_t(info.hblkhd);
+#elif defined(__GLIBC__)
+    // mallinfo() uses int, so this wraps above 2 GiB.
+    const struct mallinfo info(mallinfo());
+    result.heap = int64_t(unsigned(info.uordblks)) + unsigned(info.hblkhd);
+#endif
+    return result;
+  }
+};
+
+// Totals over the MPI calls made by this process, kept by the PMPI
+// wrappers in src/sdpb/mpi_statistics.cxx.  messages counts the
+// calls, bytes the data passed in send buffers, and blocking the time
+// spent inside calls that block.  Programs that do not link the
+// wrappers always see 0.
+struct Mpi_Sample
+{
+  int64_t messages = 0, bytes = 0;
+  std::chrono::high_resolution_clock::duration blocking
+    = std::chrono::high_resolution_clock::duration::zero();
+
+  // The counters may be updated from several threads.
+  struct Counters
+  {
+    std::atomic<int64_t> messages{0}, bytes{0}, blocking{0};
+  };
+  static Counters &counters()
+  {
+    static Counters result;
+    return result;
+  }
+
+  static Mpi_Sample now()
+  {
+    Mpi_Sample result;
+    const Counters &totals(counters());
+    result.messages = totals.messages.load(std::memory_order_relaxed);
+    result.bytes = totals.bytes.load(std::memory_order_relaxed);
+    result.blocking = std::chrono::high_resolution_clock::duration(
+      totals.blocking.load(std::memory_order_relaxed));
+    return result;
+  }
+};
+
+// One interval for a trace of the run.  Lane 0 holds intervals timed
+// with start and stop.  Lane 1 holds work that was timed in pieces and
+// added with Timers::add_elapsed, drawn as ending when it was added.
+struct Trace_Event
+{
+  size_t id;
+  int lane;
+  std::chrono::time_point<std::chrono::high_resolution_clock> start, stop;
+};
 
 struct Timer
 {
   std::chrono::time_point<std::chrono::high_resolution_clock> start_time,
     stop_time;
+  // If set, stop() adds the elapsed time to these statistics.
+  Timer_Statistics *statistics = nullptr;
+  // Only set when the statistics track memory.
+  Memory_Sample start_memory;
+  Mpi_Sample start_mpi;
   Timer() : start_time(std::chrono::high_resolution_clock::now()) {}
-  auto stop() { stop_time = std::chrono::high_resolution_clock::now(); }
+  void stop();
 
   int64_t elapsed_milliseconds() const
   {
@@ -24,6 +121,117 @@ struct Timer
   }
 };
 
+// Aggregate of all of the intervals timed under one name.  The
+// iteration totals are rotated by Timers::start_iteration().
+struct Timer_Statistics
+{
+  using Duration = std::chrono::high_resolution_clock::duration;
+
+  std::string name;
+  size_t id = 0;
+  int64_t count = 0;
+  Duration total = Duration::zero(), min = Duration::max(),
+           max = Duration::zero();
+  int64_t iteration_count = 0, previous_iteration_count = 0;
+  Duration iteration_total = Duration::zero(),
+           previous_iteration_total = Duration::zero();
+  // The most recent interval started with Timers::add_and_start().
+  Timer timer;
+  // If set, every interval is also appended here.
+  std::vector<Trace_Event> *trace = nullptr;
+  // With track_memory, the high-water marks over all intervals
+  // started with add_and_start.
+  bool track_memory = false;
+  int64_t max_rss = 0, max_heap = 0;
+  // The MPI traffic during the intervals started with add_and_start.
+  // Intervals are inclusive, so this counts nested intervals and
+  // calls made by other threads at the same time.
+  Mpi_Sample mpi, iteration_mpi, previous_iteration_mpi;
+
+  Timer_Statistics(const std::string &Name, const size_t &Id)
+      : name(Name), id(Id)
+  {
+    timer.statistics = this;
+  }
+  Timer_Statistics(const Timer_Statistics &) = delete;
+  void operator=(const Timer_Statistics &) = delete;
+
+  // add() may be called from several threads.
+  void add(const std::chrono::time_point<std::chrono::high_resolution_clock>
+             &start,
+           const std::chrono::time_point<std::chrono::high_resolution_clock>
+             &stop,
+           const int &lane)
+  {
+    const Duration elapsed(stop - start);
+    std::lock_guard<std::mutex> lock(mutex());
+    ++count;
+    total += elapsed;
+    min = std::min(min, elapsed);
+    max = std::max(max, elapsed);
+    ++iteration_count;
+    iteration_total += elapsed;
+    if(trace != nullptr)
+      {
+        trace->push_back({id, lane, start, stop});
+      }
+  }
+  // The resident set is only sampled at the start and stop of an
+  // interval.  If the peak of the process rose during the interval,
+  // that peak was reached during this interval (or a nested one).
+  void add_memory(const Memory_Sample &start, const Memory_Sample &stop)
+  {
+    int64_t rss(std::max(start.rss, stop.rss));
+    if(stop.peak_rss > start.peak_rss)
+      {
+        rss = std::max(rss, stop.peak_rss);
+      }
+    std::lock_guard<std::mutex> lock(mutex());
+    max_rss = std::max(max_rss, rss);
+    max_heap = std::max(max_heap, std::max(start.heap, stop.heap));
+  }
+  void add_mpi(const Mpi_Sample &start, const Mpi_Sample &stop)
+  {
+    std::lock_guard<std::mutex> lock(mutex());
+    for(Mpi_Sample *sum : {&mpi, &iteration_mpi})
+      {
+        sum->messages += stop.messages - start.messages;
+        sum->bytes += stop.bytes - start.bytes;
+        sum->blocking += stop.blocking - start.blocking;
+      }
+  }
+  void add(const Duration &elapsed)
+  {
+    const auto now(std::chrono::high_resolution_clock::now());
+    add(now - elapsed, now, 1);
+  }
+
+  static double seconds(const Duration &duration)
+  {
+    return std::chrono::duration<double>(duration).count();
+  }
+
+  static std::mutex &mutex()
+  {
+    static std::mutex result;
+    return result;
+  }
+};
+
+inline void Timer::stop()
+{
+  stop_time = std::chrono::high_resolution_clock::now();
+  if(statistics != nullptr)
+    {
+      statistics->add(start_time, stop_time, 0);
+      statistics->add_mpi(start_mpi, Mpi_Sample::now());
+      if(statistics->track_memory)
+        {
+          statistics->add_memory(start_memory, Memory_Sample::now());
+        }
+    }
+}
+
 inline std::ostream &operator<<(std::ostream &os, const Timer &timer)
 {
   os << (timer.elapsed_milliseconds()/1000.0);
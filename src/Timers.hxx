@@ -11,42 +11,156 @@
 
 #include <El.hpp>
 
+#include <deque>
 #include <fstream>
+#include <memory>
 #include <string>
-#include <list>
+#include <unordered_map>
+#include <vector>
 #include <algorithm>
+#include <mutex>
 
-struct Timers : public std::list<std::pair<std::string, Timer>>
+// Each name is interned once, and all of the intervals timed under that
+// name are aggregated into a single Timer_Statistics.  So the memory
+// use does not grow with the number of iterations, and starting and
+// stopping a timer is a hash lookup and a few additions.  Names are
+// hierarchical, with '.' separating scopes, so sorting them gives the
+// tree of scopes.
+//
+// In debug mode, each interval also samples the memory of the process
+// when it starts and stops, and keeps the high-water marks per name.
+//
+// Timers is a deque of Timer_Statistics, in the order that names were
+// first used, so references to them stay valid.
+struct Timers : public std::deque<Timer_Statistics>
 {
   bool debug = false;
   Timers(const bool &Debug) : debug(Debug) {}
+  Timers(Timers &&) = default;
 
+  // The id of a name, adding it if needed.
+  size_t id(const std::string &name)
+  {
+    std::lock_guard<std::mutex> lock(Timer_Statistics::mutex());
+    return id_locked(name);
+  }
+
+  // add_and_start and add_elapsed may be called from several threads.
+  Timer &add_and_start(const size_t &timer_id)
+  {
+    Timer *result;
+    {
+      std::lock_guard<std::mutex> lock(Timer_Statistics::mutex());
+      result = &(*this)[timer_id].timer;
+    }
+    if(debug)
+      {
+        result->start_memory = Memory_Sample::now();
+      }
+    result->start_mpi = Mpi_Sample::now();
+    result->start_time = std::chrono::high_resolution_clock::now();
+    return *result;
+  }
   Timer &add_and_start(const std::string &name)
   {
+    Timer *result;
+    {
+      std::lock_guard<std::mutex> lock(Timer_Statistics::mutex());
+      result = &(*this)[id_locked(name)].timer;
+    }
     if(debug)
       {
-        std::ifstream stat_file("/proc/self/statm");
-        if(stat_file.good())
-          {
-            std::string stats;
-            std::getline(stat_file, stats);
-            El::Output(El::mpi::Rank(), " ", name, " ", stats);
-          }
+        result->start_memory = Memory_Sample::now();
       }
-    emplace_back(name, Timer());
-    return back().second;
+    result->start_mpi = Mpi_Sample::now();
+    result->start_time = std::chrono::high_resolution_clock::now();
+    return *result;
   }
 
+  // Add a timer for work that was done in several separate
+  // intervals, with a total time of 'elapsed'.
+  void add_elapsed(const std::string &name,
+                   const std::chrono::high_resolution_clock::duration &elapsed)
+  {
+    Timer_Statistics *statistics;
+    {
+      std::lock_guard<std::mutex> lock(Timer_Statistics::mutex());
+      statistics = &(*this)[id_locked(name)];
+    }
+    statistics->add(elapsed);
+  }
+
+  // Start a new iteration.  The totals for the current iteration
+  // become the totals for the previous iteration.
+  void start_iteration()
+  {
+    std::lock_guard<std::mutex> lock(Timer_Statistics::mutex());
+    for(auto &statistics : *this)
+      {
+        statistics.previous_iteration_count = statistics.iteration_count;
+        statistics.previous_iteration_total = statistics.iteration_total;
+        statistics.iteration_count = 0;
+        statistics.iteration_total = Timer_Statistics::Duration::zero();
+        statistics.previous_iteration_mpi = statistics.iteration_mpi;
+        statistics.iteration_mpi = Mpi_Sample();
+      }
+  }
+
+  // Record every interval from now on, with times relative to
+  // origin.  See write_trace().
+  void start_trace(
+    const std::chrono::time_point<std::chrono::high_resolution_clock>
+      &origin)
+  {
+    std::lock_guard<std::mutex> lock(Timer_Statistics::mutex());
+    trace_origin = origin;
+    trace.reset(new std::vector<Trace_Event>());
+    for(auto &statistics : *this)
+      {
+        statistics.trace = trace.get();
+      }
+  }
+  const std::vector<Trace_Event> *trace_events() const { return trace.get(); }
+
+  const Timer_Statistics *find(const std::string &name) const
+  {
+    auto iter(ids.find(name));
+    return iter == ids.end() ? nullptr : &(*this)[iter->second];
+  }
+
+  // Each line is {name, total, count, min, max, max_rss, max_heap,
+  // mpi_messages, mpi_bytes, mpi_blocking}, with times in seconds and
+  // memory in bytes, sorted by name.  Memory is only tracked in debug
+  // mode, and is 0 otherwise.
   void write_profile(const std::string &filename) const
   {
-    std::ofstream f(filename);
+    std::vector<const Timer_Statistics *> sorted;
+    for(auto &statistics : *this)
+      {
+        sorted.push_back(&statistics);
+      }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Timer_Statistics *a, const Timer_Statistics *b) {
+                return a->name < b->name;
+              });
 
+    std::ofstream f(filename);
     f << "{" << '\n';
-    for(auto it(begin()); it != end();)
+    for(auto it(sorted.begin()); it != sorted.end();)
       {
-        f << "    {\"" << it->first << "\", " << it->second << "}";
+        const Timer_Statistics &statistics(**it);
+        f << "    {\"" << statistics.name << "\", "
+          << Timer_Statistics::seconds(statistics.total) << ", "
+          << statistics.count << ", "
+          << Timer_Statistics::seconds(statistics.count == 0
+                                         ? statistics.total
+                                         : statistics.min)
+          << ", " << Timer_Statistics::seconds(statistics.max) << ", "
+          << statistics.max_rss << ", " << statistics.max_heap << ", "
+          << statistics.mpi.messages << ", " << statistics.mpi.bytes << ", "
+          << Timer_Statistics::seconds(statistics.mpi.blocking) << "}";
         ++it;
-        if(it != end())
+        if(it != sorted.end())
           {
             f << ",";
           }
@@ -60,16 +174,36 @@ struct Timers : public std::list<std::pair<std::string, Timer>>
       }
   }
 
+  // The time of the most recent interval started by add_and_start.
   int64_t elapsed_milliseconds(const std::string &s) const
   {
-    auto iter(std::find_if(rbegin(), rend(),
-                           [&s](const std::pair<std::string, Timer> &timer) {
-                             return timer.first == s;
-                           }));
-    if(iter == rend())
+    const Timer_Statistics *statistics(find(s));
+    if(statistics == nullptr)
       {
         throw std::runtime_error("Could not find timing for " + s);
       }
-    return iter->second.elapsed_milliseconds();
+    return statistics->timer.elapsed_milliseconds();
+  }
+
+  std::chrono::time_point<std::chrono::high_resolution_clock> trace_origin;
+
+private:
+  std::unordered_map<std::string, size_t> ids;
+  // A unique_ptr, so that the pointers in Timer_Statistics stay valid
+  // when Timers is moved.
+  std::unique_ptr<std::vector<Trace_Event>> trace;
+
+  size_t id_locked(const std::string &name)
+  {
+    auto iter(ids.find(name));
+    if(iter != ids.end())
+      {
+        return iter->second;
+      }
+    emplace_back(name, size());
+    back().trace = trace.get();
+    back().track_memory = debug;
+    ids.emplace(name, size() - 1);
+    return size() - 1;
   }
 };
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "set_number.hxx"
+
 #include <libxml2/libxml/parser.h>
 #include <vector>
 #include <string>
@@ -16,19 +18,19 @@ public:
   Vector_State(const std::vector<std::string> &names, const size_t &offset)
       : name(names.at(offset)), element_state(names, offset + 1)
   {}
-  template <typename U, typename V, typename W>
+  template <typename... Args>
   Vector_State(const std::vector<std::string> &names, const size_t &offset,
-               U &u, V &v, W &w)
-      : name(names.at(offset)), element_state(names, offset + 1, u, v, w)
+               Args &... args)
+      : name(names.at(offset)), element_state(names, offset + 1, args...)
   {}
 
   Vector_State(const std::initializer_list<std::string> &names)
       : Vector_State(names, 0)
   {}
-  template <typename U, typename V, typename W>
-  Vector_State(const std::initializer_list<std::string> &names, U &u, V &v,
-               W &w)
-      : Vector_State(names, 0, u, v, w)
+  template <typename... Args>
+  Vector_State(const std::initializer_list<std::string> &names,
+               Args &... args)
+      : Vector_State(names, 0, args...)
   {}
 
   // XML Functions
@@ -98,6 +100,17 @@ public:
       }
   }
 
+  // Binary numbers from CBOR input
+  void json_binary_number(const Binary_Number &number)
+  {
+    element_state.json_binary_number(number);
+    if(!element_state.inside)
+      {
+        value.emplace_back();
+        std::swap(value.back(), element_state.value);
+      }
+  }
+
   void json_start_array()
   {
     if(inside)
@@ -0,0 +1,141 @@
+#pragma once
+
+// Binary format for the per-block matrices of an SDP
+// (free_var_matrix.* and primal_objective_c.*).
+//
+// The file starts with a fixed size header, followed by
+// height*width records in row major order.  Every record has the
+// same size, so a reader can seek straight to the elements it owns.
+// A record is
+//
+//   int32_t size;            // GMP's _mp_size: sign * number of limbs
+//   int64_t exponent;        // GMP's _mp_exp, in limbs
+//   mp_limb_t limbs[num_limbs];
+//
+// with the limbs least significant first, as GMP stores them.  If
+// the number has fewer than num_limbs limbs, the rest are zero.
+//
+// Files in this format start with binary_sdp_magic.  sdpb checks for
+// it, so text files keep working unchanged.
+
+#include <El.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+const char binary_sdp_magic[8] = {'S', 'D', 'P', 'B', 'B', 'I', 'N', '\0'};
+const uint32_t binary_sdp_version(1);
+
+struct Binary_SDP_Header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t num_limbs;
+  int64_t height, width;
+};
+
+inline size_t binary_sdp_record_size(const uint32_t &num_limbs)
+{
+  return sizeof(int32_t) + sizeof(int64_t) + num_limbs * sizeof(mp_limb_t);
+}
+
+// Limbs needed for a BigFloat at the current precision
+inline uint32_t binary_sdp_num_limbs()
+{
+  return El::BigFloat(0).gmp_float.get_mpf_t()->_mp_prec + 1;
+}
+
+inline void write_binary_sdp_header(std::ostream &os, const int64_t &height,
+                                    const int64_t &width)
+{
+  Binary_SDP_Header header;
+  std::memcpy(header.magic, binary_sdp_magic, sizeof(header.magic));
+  header.version = binary_sdp_version;
+  header.num_limbs = binary_sdp_num_limbs();
+  header.height = height;
+  header.width = width;
+  os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+inline void write_binary_sdp_element(std::ostream &os, const El::BigFloat &x,
+                                     const uint32_t &num_limbs)
+{
+  mpf_srcptr mpf(x.gmp_float.get_mpf_t());
+  int32_t size(mpf->_mp_size);
+  const int32_t used_limbs(std::min(int32_t(std::abs(size)),
+                                    int32_t(num_limbs)));
+  // If x somehow has more limbs than num_limbs, drop the least
+  // significant ones.
+  const mp_limb_t *limbs(mpf->_mp_d + (std::abs(size) - used_limbs));
+  size = (size < 0 ? -used_limbs : used_limbs);
+  const int64_t exponent(mpf->_mp_exp);
+
+  os.write(reinterpret_cast<const char *>(&size), sizeof(size));
+  os.write(reinterpret_cast<const char *>(&exponent), sizeof(exponent));
+  os.write(reinterpret_cast<const char *>(limbs),
+           used_limbs * sizeof(mp_limb_t));
+  const mp_limb_t zero(0);
+  for(uint32_t limb = used_limbs; limb < num_limbs; ++limb)
+    {
+      os.write(reinterpret_cast<const char *>(&zero), sizeof(zero));
+    }
+}
+
+// Decode a record into x at x's precision.  If the record has more
+// limbs than x can hold, the least significant limbs are dropped,
+// which truncates like reading a longer decimal string would round.
+inline void read_binary_sdp_element(const char *record, El::BigFloat &x)
+{
+  int32_t size;
+  int64_t exponent;
+  std::memcpy(&size, record, sizeof(size));
+  std::memcpy(&exponent, record + sizeof(size), sizeof(exponent));
+  const char *limbs(record + sizeof(size) + sizeof(exponent));
+
+  mpf_ptr mpf(x.gmp_float.get_mpf_t());
+  const int32_t num_limbs(std::abs(size)),
+    kept_limbs(std::min(num_limbs, int32_t(mpf->_mp_prec + 1)));
+  std::memcpy(mpf->_mp_d,
+              limbs + (num_limbs - kept_limbs) * sizeof(mp_limb_t),
+              kept_limbs * sizeof(mp_limb_t));
+  mpf->_mp_size = (size < 0 ? -kept_limbs : kept_limbs);
+  mpf->_mp_exp = exponent;
+}
+
+inline bool is_binary_sdp_header(const char *data, const size_t &size)
+{
+  return size >= sizeof(binary_sdp_magic)
+         && std::memcmp(data, binary_sdp_magic, sizeof(binary_sdp_magic))
+              == 0;
+}
+
+inline Binary_SDP_Header
+read_binary_sdp_header(const char *data, const size_t &size,
+                       const std::string &filename)
+{
+  Binary_SDP_Header header;
+  if(size < sizeof(header))
+    {
+      throw std::runtime_error("Truncated header in binary file: "
+                               + filename);
+    }
+  std::memcpy(&header, data, sizeof(header));
+  if(header.version != binary_sdp_version)
+    {
+      throw std::runtime_error("Unsupported version "
+                               + std::to_string(header.version)
+                               + " in binary file: " + filename);
+    }
+  if(header.height < 0 || header.width < 0
+     || size
+          != sizeof(header)
+               + size_t(header.height) * size_t(header.width)
+                   * binary_sdp_record_size(header.num_limbs))
+    {
+      throw std::runtime_error("Corrupted binary file: " + filename);
+    }
+  return header;
+}
@@ -2,27 +2,101 @@
 
 #include <algorithm>
 #include <iostream>
+#include <string>
+
+void simulate(const std::string &timings_file, const size_t &num_nodes,
+              const size_t &procs_per_node, const size_t &memory_per_node,
+              const size_t &group_memory);
 
 int main(int argc, char *argv[])
 {
-  if(argc < 4)
+  // Optional leading arguments --memoryPerNode=BYTES and
+  // --groupMemory=BYTES.  Costs may be given as cost:memory.
+  //
+  // With --timings=FILE, --numNodes=N and --procsPerNode=P, compare
+  // mappings for the costs in a block_timings file instead.
+  size_t memory_per_node(0), group_memory(0), sim_nodes(0), sim_procs(0);
+  std::string timings_file;
+  int first(1);
+  for(; first < argc && std::string(argv[first]).substr(0, 2) == "--";
+      ++first)
+    {
+      const std::string arg(argv[first]);
+      const size_t equal(arg.find('='));
+      const std::string name(arg.substr(0, equal)),
+        value(equal == std::string::npos ? "" : arg.substr(equal + 1));
+      if(value.empty())
+        {
+          std::cerr << "Missing value for option: " << arg << "\n";
+          exit(1);
+        }
+      if(name == "--timings")
+        {
+          timings_file = value;
+        }
+      else if(name == "--memoryPerNode" || name == "--groupMemory"
+              || name == "--numNodes" || name == "--procsPerNode")
+        {
+          (name == "--memoryPerNode"
+             ? memory_per_node
+             : name == "--groupMemory"
+                 ? group_memory
+                 : name == "--numNodes" ? sim_nodes : sim_procs)
+            = std::stoull(value);
+        }
+      else
+        {
+          std::cerr << "Unknown option: " << arg << "\n";
+          exit(1);
+        }
+    }
+  if(!timings_file.empty())
     {
-      std::cerr
-        << "Need at least 3 arguments: procs_per_node, num_nodes, costs...\n";
+      if(sim_nodes == 0 || sim_procs == 0 || first != argc)
+        {
+          std::cerr << "--timings needs --numNodes and --procsPerNode, and "
+                       "no costs\n";
+          exit(1);
+        }
+      simulate(timings_file, sim_nodes, sim_procs, memory_per_node,
+               group_memory);
+      return 0;
+    }
+  if(argc - first < 3)
+    {
+      std::cerr << "Need at least 3 arguments: [--memoryPerNode=BYTES] "
+                   "[--groupMemory=BYTES] procs_per_node, num_nodes, "
+                   "costs[:memory]...\n"
+                   "or: --timings=FILE --numNodes=N --procsPerNode=P "
+                   "[--memoryPerNode=BYTES] [--groupMemory=BYTES]\n";
       exit(1);
     }
-  size_t num_procs(std::stoi(argv[1])), procs_per_node(std::stoi(argv[2]));
+  size_t procs_per_node(std::stoi(argv[first])),
+    num_nodes(std::stoi(argv[first + 1]));
   std::vector<Block_Cost> costs;
-  for(int ii = 3; ii < argc; ++ii)
+  for(int ii = first + 2; ii < argc; ++ii)
     {
-      costs.emplace_back(std::stoi(argv[ii]), ii - 3);
+      const std::string arg(argv[ii]);
+      const size_t colon(arg.find(':'));
+      costs.emplace_back(std::stoi(arg.substr(0, colon)), ii - first - 2,
+                         colon == std::string::npos
+                           ? 0
+                           : std::stoull(arg.substr(colon + 1)));
     }
   std::sort(costs.rbegin(), costs.rend());
   std::vector<std::vector<Block_Map>> mapping(
-    compute_block_grid_mapping(num_procs, procs_per_node, costs));
+    compute_block_grid_mapping(procs_per_node, num_nodes, memory_per_node,
+                               group_memory, costs));
+  refine_block_grid_mapping(memory_per_node, group_memory, costs, mapping);
 
   for(size_t node = 0; node < mapping.size(); ++node)
     {
+      size_t node_memory(0);
+      for(auto &m : mapping[node])
+        {
+          node_memory += m.memory;
+        }
+      std::cout << "Node " << node << " memory: " << node_memory << "\n";
       for(auto &m : mapping[node])
         {
           std::cout << node << " " << m.num_procs << ": "
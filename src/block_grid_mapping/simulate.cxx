@@ -0,0 +1,104 @@
+// Read a block_timings file and predict the time per iteration for
+// different choices of procsPerNode and procGranularity, with and
+// without refine_block_grid_mapping.  The prediction assumes that
+// the time for a block group scales inversely with the number of
+// procs in the group, so it is only a guide for comparing mappings.
+
+#include "../compute_block_grid_mapping.hxx"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+  double makespan(const std::vector<std::vector<Block_Map>> &mapping,
+                  const size_t &proc_granularity)
+  {
+    double result(0);
+    for(auto &node : mapping)
+      for(auto &block_map : node)
+        {
+          if(block_map.num_procs != 0)
+            {
+              result = std::max(
+                result, block_map.cost
+                          / static_cast<double>(block_map.num_procs
+                                                * proc_granularity));
+            }
+        }
+    return result;
+  }
+}
+
+void simulate(const std::string &timings_file, const size_t &num_nodes,
+              const size_t &procs_per_node, const size_t &memory_per_node,
+              const size_t &group_memory)
+{
+  std::vector<Block_Cost> costs;
+  {
+    std::ifstream infile(timings_file);
+    if(!infile.good())
+      {
+        throw std::runtime_error("Unable to open '" + timings_file + "'");
+      }
+    size_t index(0), cost;
+    infile >> cost;
+    while(infile.good())
+      {
+        costs.emplace_back(cost, index);
+        ++index;
+        infile >> cost;
+      }
+    if(costs.empty())
+      {
+        throw std::runtime_error("No timings found in '" + timings_file
+                                 + "'");
+      }
+  }
+  std::sort(costs.rbegin(), costs.rend());
+
+  std::cout << "procsPerNode\tprocGranularity\tWorst Fit\tRefined\n";
+  double best_makespan(-1);
+  size_t best_procs_per_node(0), best_granularity(0);
+  for(size_t node_procs = procs_per_node; node_procs > 0; --node_procs)
+    {
+      if(procs_per_node % node_procs != 0)
+        {
+          continue;
+        }
+      for(size_t granularity = 1; granularity <= node_procs; ++granularity)
+        {
+          if(node_procs % granularity != 0)
+            {
+              continue;
+            }
+          std::vector<std::vector<Block_Map>> mapping(
+            compute_block_grid_mapping(node_procs / granularity, num_nodes,
+                                       memory_per_node, group_memory,
+                                       costs));
+          const double worst_fit(makespan(mapping, granularity));
+          refine_block_grid_mapping(memory_per_node, group_memory, costs,
+                                    mapping);
+          const double refined(makespan(mapping, granularity));
+          std::cout << node_procs << "\t\t" << granularity << "\t\t"
+                    << worst_fit << "\t\t" << refined << "\n";
+          if(best_makespan < 0 || refined < best_makespan)
+            {
+              best_makespan = refined;
+              best_procs_per_node = node_procs;
+              best_granularity = granularity;
+            }
+        }
+    }
+  std::cout << "\nBest: --procsPerNode=" << best_procs_per_node
+            << " --procGranularity=" << best_granularity
+            << " (predicted time per iteration " << best_makespan << ")\n";
+  if(best_procs_per_node != procs_per_node)
+    {
+      std::cout << "This uses fewer MPI processes than the " << procs_per_node
+                << " available on each node.\n";
+    }
+}
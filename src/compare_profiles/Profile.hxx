@@ -0,0 +1,25 @@
+#pragma once
+
+#include <boost/filesystem.hpp>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// One line of a file written by Timers::write_profile.  Only the
+// fields needed for comparisons are kept.
+struct Profile_Entry
+{
+  double total = 0, max = 0;
+  int64_t count = 0;
+};
+
+// The profile of one rank, keyed by timer name.
+using Profile = std::map<std::string, Profile_Entry>;
+
+Profile read_profile(const boost::filesystem::path &path);
+
+// The profiles of all of the ranks of a run, read from
+// prefix.0, prefix.1, ...
+std::vector<Profile> read_run(const std::string &prefix);
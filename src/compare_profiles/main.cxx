@@ -0,0 +1,294 @@
+// Compare the profiles of a baseline and a candidate run, such as
+// before and after an upgrade of Elemental, GMP or MPI, and report the
+// timers that got slower.  Each run is given as the prefix of its
+// profile files, e.g. test/test.ck.profiling for
+// test/test.ck.profiling.0, test/test.ck.profiling.1, ...
+//
+// For each timer, the time of a run is its maximum total over the
+// ranks, which is what the slowest rank waits for.  The mean and the
+// imbalance (max / mean) over ranks are reported as well.
+//
+// A timer is a regression if it is slower by more than --threshold
+// and the slowdown is significant at level --alpha in a one sided
+// t-test.  With several runs on each side, the test is a Welch test on
+// the per-run times.  With one run on each side and the same number
+// of ranks, it is a paired test on the per-rank totals.  Otherwise
+// there is nothing to test against, and the threshold alone decides.
+//
+// The exit code is 0 if there are no regressions, 1 if there are, and
+// 2 on errors.
+
+#include "Profile.hxx"
+
+#include <boost/math/distributions/students_t.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <set>
+
+namespace po = boost::program_options;
+
+namespace
+{
+  struct Run_Times
+  {
+    // Totals per rank, with 0 for ranks without this timer.
+    std::vector<double> totals;
+    double max = 0, mean = 0;
+  };
+
+  Run_Times run_times(const std::vector<Profile> &run,
+                      const std::string &name)
+  {
+    Run_Times result;
+    for(auto &profile : run)
+      {
+        auto entry(profile.find(name));
+        result.totals.push_back(entry == profile.end() ? 0
+                                                       : entry->second.total);
+      }
+    result.max = *std::max_element(result.totals.begin(), result.totals.end());
+    for(auto &total : result.totals)
+      {
+        result.mean += total / result.totals.size();
+      }
+    return result;
+  }
+
+  void mean_and_variance(const std::vector<double> &samples, double &mean,
+                         double &variance)
+  {
+    mean = 0;
+    for(auto &sample : samples)
+      {
+        mean += sample / samples.size();
+      }
+    variance = 0;
+    for(auto &sample : samples)
+      {
+        variance += (sample - mean) * (sample - mean) / (samples.size() - 1);
+      }
+  }
+
+  // The probability of a t at least this large if there is no
+  // slowdown.
+  double one_sided_p(const double &t, const double &degrees_of_freedom)
+  {
+    if(!std::isfinite(t))
+      {
+        return t > 0 ? 0 : 1;
+      }
+    boost::math::students_t distribution(degrees_of_freedom);
+    return boost::math::cdf(boost::math::complement(distribution, t));
+  }
+
+  // NaN if there are not enough samples for a test.
+  double p_value(const std::vector<Run_Times> &baseline,
+                 const std::vector<Run_Times> &candidate)
+  {
+    if(baseline.size() > 1 && candidate.size() > 1)
+      {
+        std::vector<double> baseline_max, candidate_max;
+        for(auto &times : baseline)
+          {
+            baseline_max.push_back(times.max);
+          }
+        for(auto &times : candidate)
+          {
+            candidate_max.push_back(times.max);
+          }
+        double mean_b, variance_b, mean_c, variance_c;
+        mean_and_variance(baseline_max, mean_b, variance_b);
+        mean_and_variance(candidate_max, mean_c, variance_c);
+        const double s_b(variance_b / baseline_max.size()),
+          s_c(variance_c / candidate_max.size());
+        if(s_b + s_c == 0)
+          {
+            return mean_c > mean_b ? 0 : 1;
+          }
+        const double degrees_of_freedom(
+          (s_b + s_c) * (s_b + s_c)
+          / (s_b * s_b / (baseline_max.size() - 1)
+             + s_c * s_c / (candidate_max.size() - 1)));
+        return one_sided_p((mean_c - mean_b) / std::sqrt(s_b + s_c),
+                           degrees_of_freedom);
+      }
+    if(baseline.size() == 1 && candidate.size() == 1
+       && baseline[0].totals.size() == candidate[0].totals.size()
+       && baseline[0].totals.size() > 1)
+      {
+        std::vector<double> differences;
+        for(size_t rank = 0; rank < baseline[0].totals.size(); ++rank)
+          {
+            differences.push_back(candidate[0].totals[rank]
+                                  - baseline[0].totals[rank]);
+          }
+        double mean, variance;
+        mean_and_variance(differences, mean, variance);
+        if(variance == 0)
+          {
+            return mean > 0 ? 0 : 1;
+          }
+        return one_sided_p(mean / std::sqrt(variance / differences.size()),
+                           differences.size() - 1);
+      }
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+
+  double average_max(const std::vector<Run_Times> &runs)
+  {
+    double result(0);
+    for(auto &times : runs)
+      {
+        result += times.max / runs.size();
+      }
+    return result;
+  }
+
+  double average_imbalance(const std::vector<Run_Times> &runs)
+  {
+    double result(0);
+    for(auto &times : runs)
+      {
+        result += (times.mean == 0 ? 1 : times.max / times.mean) / runs.size();
+      }
+    return result;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  try
+    {
+      std::vector<std::string> baseline_prefixes, candidate_prefixes;
+      double threshold, alpha, min_seconds;
+      std::string match;
+
+      po::options_description options("Basic options");
+      options.add_options()("help,h", "Show this helpful message.");
+      options.add_options()(
+        "baseline,b",
+        po::value<std::vector<std::string>>(&baseline_prefixes)
+          ->multitoken()
+          ->required(),
+        "Profile prefixes of one or more baseline runs.");
+      options.add_options()(
+        "candidate,c",
+        po::value<std::vector<std::string>>(&candidate_prefixes)
+          ->multitoken()
+          ->required(),
+        "Profile prefixes of one or more candidate runs.");
+      options.add_options()(
+        "threshold", po::value<double>(&threshold)->default_value(0.05),
+        "Smallest relative slowdown that counts as a regression.");
+      options.add_options()(
+        "alpha", po::value<double>(&alpha)->default_value(0.05),
+        "Significance level for the t-test.");
+      options.add_options()(
+        "minSeconds", po::value<double>(&min_seconds)->default_value(0.01),
+        "Ignore timers that take less than this in both runs.");
+      options.add_options()(
+        "match", po::value<std::string>(&match)->default_value(""),
+        "Only compare timers whose names start with this.");
+
+      po::variables_map variables_map;
+      po::store(po::parse_command_line(argc, argv, options), variables_map);
+      if(variables_map.count("help") != 0)
+        {
+          std::cout << options << '\n';
+          return 0;
+        }
+      po::notify(variables_map);
+
+      std::vector<std::vector<Profile>> baseline_runs, candidate_runs;
+      for(auto &prefix : baseline_prefixes)
+        {
+          baseline_runs.push_back(read_run(prefix));
+        }
+      for(auto &prefix : candidate_prefixes)
+        {
+          candidate_runs.push_back(read_run(prefix));
+        }
+
+      std::set<std::string> names;
+      for(auto *runs : {&baseline_runs, &candidate_runs})
+        for(auto &run : *runs)
+          for(auto &profile : run)
+            for(auto &entry : profile)
+              {
+                if(entry.first.compare(0, match.size(), match) == 0)
+                  {
+                    names.insert(entry.first);
+                  }
+              }
+
+      std::cout << std::left << std::setw(60) << "timer" << std::right
+                << std::setw(12) << "baseline" << std::setw(12)
+                << "candidate" << std::setw(9) << "change" << std::setw(11)
+                << "imbal_base" << std::setw(11) << "imbal_cand"
+                << std::setw(10) << "p" << "\n";
+      size_t num_regressions(0);
+      for(auto &name : names)
+        {
+          std::vector<Run_Times> baseline, candidate;
+          for(auto &run : baseline_runs)
+            {
+              baseline.push_back(run_times(run, name));
+            }
+          for(auto &run : candidate_runs)
+            {
+              candidate.push_back(run_times(run, name));
+            }
+          const double baseline_max(average_max(baseline)),
+            candidate_max(average_max(candidate));
+          if(baseline_max < min_seconds && candidate_max < min_seconds)
+            {
+              continue;
+            }
+          const double change(baseline_max == 0
+                                ? std::numeric_limits<double>::infinity()
+                                : candidate_max / baseline_max - 1),
+            p(p_value(baseline, candidate));
+          const bool is_regression(change > threshold
+                                   && (std::isnan(p) || p < alpha));
+          if(is_regression)
+            {
+              ++num_regressions;
+            }
+          std::cout << std::left << std::setw(60) << name << std::right
+                    << std::fixed << std::setprecision(3) << std::setw(12)
+                    << baseline_max << std::setw(12) << candidate_max
+                    << std::setprecision(1) << std::setw(8) << 100 * change
+                    << "%" << std::setprecision(2) << std::setw(11)
+                    << average_imbalance(baseline) << std::setw(11)
+                    << average_imbalance(candidate) << std::setprecision(3)
+                    << std::setw(10);
+          if(std::isnan(p))
+            {
+              std::cout << "-";
+            }
+          else
+            {
+              std::cout << p;
+            }
+          std::cout << (is_regression ? "  REGRESSION" : "") << "\n";
+        }
+      std::cout << "\n" << num_regressions << " regression"
+                << (num_regressions == 1 ? "" : "s") << "\n";
+      return num_regressions == 0 ? 0 : 1;
+    }
+  catch(std::exception &e)
+    {
+      std::cerr << "Error: " << e.what() << "\n" << std::flush;
+      return 2;
+    }
+  catch(...)
+    {
+      std::cerr << "Unknown Error\n" << std::flush;
+      return 2;
+    }
+}
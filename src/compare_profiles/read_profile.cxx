@@ -0,0 +1,73 @@
+#include "Profile.hxx"
+
+#include <boost/filesystem/fstream.hpp>
+
+#include <sstream>
+
+// Each line is
+//
+//   {"name", total, count, min, max, ...},
+//
+// between lines with a single '{' and '}'.  Older profiles have fewer
+// fields after max, which are ignored anyway.
+
+Profile read_profile(const boost::filesystem::path &path)
+{
+  boost::filesystem::ifstream infile(path);
+  if(!infile.good())
+    {
+      throw std::runtime_error("Unable to open '" + path.string() + "'");
+    }
+  Profile result;
+  std::string line;
+  size_t line_number(0);
+  while(std::getline(infile, line))
+    {
+      ++line_number;
+      const size_t open_quote(line.find('"'));
+      if(open_quote == std::string::npos)
+        {
+          continue;
+        }
+      const size_t close_quote(line.rfind('"'));
+      const std::string name(
+        line.substr(open_quote + 1, close_quote - open_quote - 1));
+      std::string fields(line.substr(close_quote + 1));
+      for(auto &c : fields)
+        {
+          if(c == ',' || c == '}')
+            {
+              c = ' ';
+            }
+        }
+      std::stringstream ss(fields);
+      Profile_Entry entry;
+      double min;
+      if(close_quote == open_quote
+         || !(ss >> entry.total >> entry.count >> min >> entry.max))
+        {
+          throw std::runtime_error("Invalid line "
+                                   + std::to_string(line_number) + " in '"
+                                   + path.string() + "': " + line);
+        }
+      result.emplace(name, entry);
+    }
+  return result;
+}
+
+std::vector<Profile> read_run(const std::string &prefix)
+{
+  std::vector<Profile> result;
+  for(size_t rank = 0;
+      boost::filesystem::exists(prefix + "." + std::to_string(rank)); ++rank)
+    {
+      result.push_back(read_profile(prefix + "." + std::to_string(rank)));
+    }
+  if(result.empty())
+    {
+      throw std::runtime_error("No profiles found for '" + prefix
+                               + "'.  Expected files named " + prefix
+                               + ".0, " + prefix + ".1, ...");
+    }
+  return result;
+}
@@ -0,0 +1,295 @@
+#pragma once
+
+// Compressed format for the text files of an SDP (objectives,
+// free_var_matrix.* and primal_objective_c.*).
+//
+// The file starts with compressed_sdp_magic, followed by frames of
+// up to compressed_sdp_frame_size bytes of the text:
+//
+//   varint text_size;
+//   varint compressed_size;
+//   char compressed[compressed_size];
+//
+// The numbers are decimal, so almost every byte of the text is one of
+// the 15 compressed_sdp_symbols.  Those are packed two to a byte, and
+// any other byte is an escape nibble followed by its two nibbles.
+// The packed bytes are then compressed with the LZ77 codec of the
+// compressed checkpoints, which removes repeated numbers and
+// exponents.
+//
+// SDP_Input_Stream reads both this format and plain text, and
+// decompresses one frame at a time, so a reader never holds more of a
+// file than a plain stream would.
+
+#include "sdpb/solve/SDP_Solver/checkpoint_compression.hxx"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <vector>
+
+const char compressed_sdp_magic[8] = {'S', 'D', 'P', 'B', 'L', 'Z', 'T', '\0'};
+const size_t compressed_sdp_frame_size(size_t(1) << 20);
+const char compressed_sdp_symbols[15]
+  = {'0', '1', '2', '3', '4', '5', '6', '7',
+     '8', '9', '.', '-', 'e', '\n', ' '};
+const uint8_t compressed_sdp_escape(15);
+
+inline void pack_sdp_text(const char *text, const size_t &size,
+                          std::vector<char> &packed)
+{
+  packed.clear();
+  packed.reserve(size / 2 + 1);
+  uint8_t pending(0);
+  bool has_pending(false);
+  auto put = [&](const uint8_t &nibble) {
+    if(has_pending)
+      {
+        packed.push_back(char(pending | (nibble << 4)));
+      }
+    pending = nibble;
+    has_pending = !has_pending;
+  };
+  for(size_t position = 0; position < size; ++position)
+    {
+      const void *symbol(std::memchr(compressed_sdp_symbols, text[position],
+                                     sizeof(compressed_sdp_symbols)));
+      if(symbol != nullptr)
+        {
+          put(static_cast<const char *>(symbol) - compressed_sdp_symbols);
+        }
+      else
+        {
+          const uint8_t byte(text[position]);
+          put(compressed_sdp_escape);
+          put(byte >> 4);
+          put(byte & 0xf);
+        }
+    }
+  if(has_pending)
+    {
+      packed.push_back(char(pending));
+    }
+}
+
+inline void unpack_sdp_text(const std::vector<char> &packed,
+                            const size_t &size, std::vector<char> &text)
+{
+  text.clear();
+  text.reserve(size);
+  size_t nibble_index(0);
+  auto next = [&]() {
+    if(nibble_index == 2 * packed.size())
+      {
+        throw std::runtime_error("Corrupted compressed SDP data");
+      }
+    const uint8_t byte(packed[nibble_index / 2]);
+    return uint8_t(nibble_index++ % 2 == 0 ? byte & 0xf : byte >> 4);
+  };
+  while(text.size() < size)
+    {
+      const uint8_t nibble(next());
+      if(nibble == compressed_sdp_escape)
+        {
+          const uint8_t high(next());
+          text.push_back(char((high << 4) | next()));
+        }
+      else
+        {
+          text.push_back(compressed_sdp_symbols[nibble]);
+        }
+    }
+}
+
+// Buffers compressed_sdp_frame_size bytes, and writes them to output
+// as a frame when the buffer is full or the stream is flushed.
+class Compressing_SDP_Streambuf : public std::streambuf
+{
+public:
+  explicit Compressing_SDP_Streambuf(std::ostream &Output)
+      : output(Output), text(compressed_sdp_frame_size)
+  {
+    setp(text.data(), text.data() + text.size());
+  }
+  ~Compressing_SDP_Streambuf() { sync(); }
+
+protected:
+  int_type overflow(int_type c) override
+  {
+    if(!write_frame())
+      {
+        return traits_type::eof();
+      }
+    if(!traits_type::eq_int_type(c, traits_type::eof()))
+      {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+      }
+    return traits_type::not_eof(c);
+  }
+  int sync() override { return write_frame() && output.flush() ? 0 : -1; }
+
+private:
+  std::ostream &output;
+  std::vector<char> text, packed, frame;
+
+  bool write_frame()
+  {
+    const size_t size(pptr() - pbase());
+    if(size == 0)
+      {
+        return output.good();
+      }
+    pack_sdp_text(pbase(), size, packed);
+    std::vector<char> compressed;
+    checkpoint_compression::compress(packed.data(), packed.size(),
+                                     compressed);
+    frame.clear();
+    checkpoint_compression::write_varint(size, frame);
+    checkpoint_compression::write_varint(compressed.size(), frame);
+    output.write(frame.data(), frame.size());
+    output.write(compressed.data(), compressed.size());
+    setp(text.data(), text.data() + text.size());
+    return output.good();
+  }
+};
+
+// Reads the frames from input one at a time.  Corrupted data makes
+// the reading stream fail.
+class Decompressing_SDP_Streambuf : public std::streambuf
+{
+public:
+  explicit Decompressing_SDP_Streambuf(std::istream &Input) : input(Input) {}
+
+protected:
+  int_type underflow() override
+  {
+    if(gptr() == egptr())
+      {
+        if(!read_frame())
+          {
+            return traits_type::eof();
+          }
+        setg(text.data(), text.data(), text.data() + text.size());
+      }
+    return traits_type::to_int_type(*gptr());
+  }
+
+private:
+  std::istream &input;
+  std::vector<char> compressed, packed, text;
+
+  // Returns false at the end of the input
+  bool read_frame()
+  {
+    if(input.peek() == std::istream::traits_type::eof())
+      {
+        return false;
+      }
+    const uint64_t size(read_varint()), compressed_size(read_varint());
+    if(size == 0 || size > compressed_sdp_frame_size
+       || compressed_size > 2 * compressed_sdp_frame_size)
+      {
+        throw std::runtime_error("Corrupted compressed SDP data");
+      }
+    compressed.resize(compressed_size);
+    input.read(compressed.data(), compressed.size());
+    if(!input.good())
+      {
+        throw std::runtime_error("Truncated compressed SDP data");
+      }
+    packed.clear();
+    checkpoint_compression::decompress(compressed.data(), compressed.size(),
+                                       packed);
+    unpack_sdp_text(packed, size, text);
+    return true;
+  }
+
+  uint64_t read_varint()
+  {
+    uint64_t result(0);
+    for(size_t shift = 0; shift < 64; shift += 7)
+      {
+        const int byte(input.get());
+        if(byte == std::istream::traits_type::eof())
+          {
+            break;
+          }
+        result |= uint64_t(byte & 0x7f) << shift;
+        if((byte & 0x80) == 0)
+          {
+            return result;
+          }
+      }
+    throw std::runtime_error("Corrupted compressed SDP data");
+  }
+};
+
+// A text file of an SDP, compressed or not
+class SDP_Input_Stream : public std::istream
+{
+public:
+  explicit SDP_Input_Stream(const boost::filesystem::path &path)
+      : std::istream(nullptr), file(path, std::ios::binary)
+  {
+    char magic[sizeof(compressed_sdp_magic)];
+    file.read(magic, sizeof(magic));
+    if(file.gcount() == sizeof(magic)
+       && std::memcmp(magic, compressed_sdp_magic, sizeof(magic)) == 0)
+      {
+        decompressing.reset(new Decompressing_SDP_Streambuf(file));
+        rdbuf(decompressing.get());
+      }
+    else
+      {
+        file.clear();
+        file.seekg(0);
+        rdbuf(file.rdbuf());
+      }
+    if(!file.is_open())
+      {
+        setstate(std::ios::failbit);
+      }
+  }
+
+private:
+  boost::filesystem::ifstream file;
+  std::unique_ptr<Decompressing_SDP_Streambuf> decompressing;
+};
+
+// The writing counterpart.  Call flush() before checking good(), so
+// that the last frame is written.
+class SDP_Output_Stream : public std::ostream
+{
+public:
+  SDP_Output_Stream(const boost::filesystem::path &path,
+                    const bool &compress)
+      : std::ostream(nullptr), file(path, std::ios::binary)
+  {
+    if(compress)
+      {
+        file.write(compressed_sdp_magic, sizeof(compressed_sdp_magic));
+        compressing.reset(new Compressing_SDP_Streambuf(file));
+        rdbuf(compressing.get());
+      }
+    else
+      {
+        rdbuf(file.rdbuf());
+      }
+    if(!file.good())
+      {
+        setstate(std::ios::badbit);
+      }
+  }
+
+private:
+  boost::filesystem::ofstream file;
+  std::unique_ptr<Compressing_SDP_Streambuf> compressing;
+};
@@ -43,10 +43,21 @@
 //
 // 2) When large blocks are forced to fit into a node, there is no
 // sharing of procs between the existing block_maps and the new entry.
+//
+// refine_block_grid_mapping partly addresses 1) by moving and swapping
+// blocks between the single proc block_maps afterwards.
+
+// If memory_per_node is not zero, it is also a constraint.  Each
+// block_map needs the memory of its blocks plus group_memory for
+// per-group workspace (e.g. Q_group).  Blocks only go to nodes where
+// they fit.  If they do not fit anywhere, they go to the node with
+// the most free memory, and the caller can warn about the predicted
+// peak memory in block_map.memory.
 
 #include "Block_Cost.hxx"
 #include "Block_Map.hxx"
 
+#include <limits>
 #include <numeric>
 #include <algorithm>
 #include <stdexcept>
@@ -56,8 +67,21 @@
 std::vector<std::vector<Block_Map>>
 compute_block_grid_mapping(const size_t &procs_per_node,
                            const size_t &num_nodes,
+                           const size_t &memory_per_node,
+                           const size_t &group_memory,
                            const std::vector<Block_Cost> &block_costs)
 {
+  std::vector<size_t> node_memory(num_nodes, 0);
+  auto fits = [&](const size_t &node, const size_t &memory) {
+    return memory_per_node == 0
+           || node_memory[node] + memory <= memory_per_node;
+  };
+  auto most_free_memory_node = [&]() {
+    return size_t(std::distance(
+      node_memory.begin(),
+      std::min_element(node_memory.begin(), node_memory.end())));
+  };
+
   // We do computations in integers to make sure that the results are
   // the same on different processers.
   const size_t total_cost(
@@ -79,16 +103,30 @@ compute_block_grid_mapping(const size_t &procs_per_node,
   for(auto block(block_costs.begin()); block != multi_proc_end; ++block)
     {
       // Always add block_map's to the node with the most available
-      // procs.  This is Worst Fit First.
-
-      size_t max_available_node(std::distance(
-        available_procs.begin(),
-        std::max_element(available_procs.begin(), available_procs.end())));
+      // procs where the block fits.  This is Worst Fit First.
+      const size_t memory(block->memory + group_memory);
+      size_t max_available_node(num_nodes);
+      for(size_t node = 0; node < num_nodes; ++node)
+        {
+          if(fits(node, memory)
+             && (max_available_node == num_nodes
+                 || available_procs[node]
+                      > available_procs[max_available_node]))
+            {
+              max_available_node = node;
+            }
+        }
+      if(max_available_node == num_nodes)
+        {
+          max_available_node = most_free_memory_node();
+        }
 
       size_t procs_for_block = std::min(
         available_procs[max_available_node],
         std::max(size_t(1), size_t(block->cost * num_procs / total_cost)));
       Block_Map block_map(procs_for_block, block->cost, {block->index});
+      block_map.memory = memory;
+      node_memory[max_available_node] += memory;
       result[max_available_node].push_back(block_map);
       available_procs[max_available_node] -= procs_for_block;
       remaining_cost -= block->cost;
@@ -142,26 +180,59 @@ compute_block_grid_mapping(const size_t &procs_per_node,
 
   for(auto block(multi_proc_end); block != block_costs.end(); ++block)
     {
-      size_t min_cost(std::numeric_limits<size_t>::max());
+      auto memory_for = [&](const Block_Map &block_map) {
+        return block->memory
+               + (block_map.block_indices.empty() ? group_memory : 0);
+      };
+      size_t min_cost(std::numeric_limits<size_t>::max()), min_node(0);
       auto min_block(available_block_maps.at(0).end());
-      for(size_t node(0); node < num_nodes; ++node)
+      for(const bool &require_fit : {true, false})
         {
-          if(!available_block_maps[node].empty())
+          // If the block does not fit anywhere, use the node with the
+          // most free memory that still has free procs.
+          size_t fallback_node(num_nodes);
+          for(size_t node(0); node < num_nodes; ++node)
             {
-              auto block = std::min_element(available_block_maps[node].begin(),
-                                            available_block_maps[node].end());
-              if(block->cost < min_cost)
+              if(!available_block_maps[node].empty()
+                 && (fallback_node == num_nodes
+                     || node_memory[node] < node_memory[fallback_node]))
                 {
-                  min_block = block;
-                  min_cost = block->cost;
+                  fallback_node = node;
                 }
             }
+          for(size_t node(0); node < num_nodes; ++node)
+            {
+              if(available_block_maps[node].empty()
+                 || (!require_fit && node != fallback_node))
+                {
+                  continue;
+                }
+              for(auto candidate(available_block_maps[node].begin());
+                  candidate != available_block_maps[node].end();
+                  ++candidate)
+                {
+                  if(candidate->cost < min_cost
+                     && (!require_fit || fits(node, memory_for(*candidate))))
+                    {
+                      min_block = candidate;
+                      min_cost = candidate->cost;
+                      min_node = node;
+                    }
+                }
+            }
+          if(min_block != available_block_maps.at(0).end())
+            {
+              break;
+            }
         }
       if(min_block==available_block_maps.at(0).end())
         {
           throw std::runtime_error("INTERNAL ERROR: Unable to find any "
                                    "free processors for remaining blocks");
         }
+      const size_t memory(memory_for(*min_block));
+      node_memory[min_node] += memory;
+      min_block->memory += memory;
       min_block->cost += block->cost;
       min_block->block_indices.push_back(block->index);
     }
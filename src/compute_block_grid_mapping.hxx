@@ -6,4 +6,11 @@
 std::vector<std::vector<Block_Map>>
 compute_block_grid_mapping(const size_t &procs_per_node,
                            const size_t &num_nodes,
+                           const size_t &memory_per_node,
+                           const size_t &group_memory,
                            const std::vector<Block_Cost> &block_costs);
+
+void refine_block_grid_mapping(const size_t &memory_per_node,
+                               const size_t &group_memory,
+                               const std::vector<Block_Cost> &block_costs,
+                               std::vector<std::vector<Block_Map>> &mapping);
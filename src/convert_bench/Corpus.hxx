@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../generate_sdp/Random.hxx"
+
+#include <boost/filesystem.hpp>
+
+#include <string>
+
+// The shape of a generated input: num_matrices positive matrices of
+// dimension dim, whose elements are polynomial vectors of length
+// num_free_variables + 1 and the given degree.  Every number is
+// written with digits significant digits.
+struct Corpus
+{
+  int64_t degree, dim, num_matrices, num_free_variables;
+  size_t digits;
+  uint64_t seed;
+};
+
+// A random decimal in (-1, 1), or in [0, 1) if not is_signed, with
+// digits digits after the point, so that parsing costs as much as it
+// does for a real input at the same precision.
+inline std::string random_decimal(Random &random, const size_t &digits,
+                                  const bool &is_signed = true)
+{
+  std::string result(
+    is_signed && random.integer(0, 1) == 1 ? "-0." : "0.");
+  for(size_t digit = 0; digit < digits; ++digit)
+    {
+      result.push_back(char('0' + random.integer(0, 9)));
+    }
+  return result;
+}
+
+// The total size in bytes of the regular files under path
+inline uintmax_t directory_bytes(const boost::filesystem::path &path)
+{
+  uintmax_t result(0);
+  for(boost::filesystem::recursive_directory_iterator entry(path), end;
+      entry != end; ++entry)
+    {
+      if(boost::filesystem::is_regular_file(entry->path()))
+        {
+          result += boost::filesystem::file_size(entry->path());
+        }
+    }
+  return result;
+}
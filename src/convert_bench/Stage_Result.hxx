@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+
+// The time on this rank for one stage of a converter.  bytes and
+// numbers are the amount of data that the stage reads or writes, or 0
+// if that does not apply to the stage.  They are only used on rank 0.
+struct Stage_Result
+{
+  std::string stage;
+  double seconds;
+  double bytes, numbers;
+};
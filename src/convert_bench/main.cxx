@@ -0,0 +1,302 @@
+// Time sdp2input and pvm2sdp stage by stage on generated inputs, for
+// finding which stage of the conversion to optimize, and for checking
+// changes to the parsers and writers for slowdowns.  For each
+// precision, degree and matrix dimension, rank 0 writes a random JSON
+// input for sdp2input and an XML input of the same shape for pvm2sdp,
+// and every rank runs both converters on them, as they would run in a
+// real conversion.  The results are written as CSV, one line per
+// converter, stage and configuration.
+
+#include "Corpus.hxx"
+#include "Stage_Result.hxx"
+#include "../sdp2input/Boost_Float.hxx"
+#include "../sdpb/limb_pool.hxx"
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <sstream>
+
+namespace po = boost::program_options;
+
+size_t write_json_corpus(const Corpus &corpus,
+                         const boost::filesystem::path &path);
+size_t write_xml_corpus(const Corpus &corpus,
+                        const boost::filesystem::path &path);
+
+std::vector<Stage_Result>
+time_sdp2input(const boost::filesystem::path &input_file,
+               const boost::filesystem::path &output_dir,
+               const double &num_numbers, const bool &binary,
+               const size_t &num_threads);
+
+std::vector<Stage_Result>
+time_pvm2sdp(const boost::filesystem::path &input_file,
+             const boost::filesystem::path &output_dir,
+             const double &num_numbers, const bool &binary);
+
+namespace
+{
+  std::vector<int> parse_list(const std::string &list)
+  {
+    std::vector<int> result;
+    std::stringstream ss(list);
+    std::string element;
+    while(std::getline(ss, element, ','))
+      {
+        try
+          {
+            result.push_back(std::stoi(element));
+          }
+        catch(std::exception &)
+          {
+            throw std::runtime_error("Invalid element '" + element
+                                     + "' in list '" + list + "'");
+          }
+        if(result.back() <= 0)
+          {
+            throw std::runtime_error("Elements of '" + list
+                                     + "' must be positive");
+          }
+      }
+    return result;
+  }
+
+  // Run a converter repeats times, keeping the fastest time of each
+  // stage on this rank.  The output directory is removed before each
+  // run, so that every run converts every block.
+  std::vector<Stage_Result>
+  fastest(const boost::filesystem::path &output_dir, const size_t &repeats,
+          const std::function<std::vector<Stage_Result>()> &run)
+  {
+    std::vector<Stage_Result> result;
+    for(size_t repeat = 0; repeat < repeats; ++repeat)
+      {
+        if(El::mpi::Rank() == 0)
+          {
+            boost::filesystem::remove_all(output_dir);
+          }
+        El::mpi::Barrier(El::mpi::COMM_WORLD);
+        const std::vector<Stage_Result> stages(run());
+        if(result.empty())
+          {
+            result = stages;
+          }
+        for(size_t stage = 0; stage < stages.size(); ++stage)
+          {
+            result[stage].seconds
+              = std::min(result[stage].seconds, stages[stage].seconds);
+          }
+      }
+    return result;
+  }
+
+  // Summarize the times over all ranks, and write them from rank 0.
+  // The rates use the slowest rank, since that is the time that the
+  // stage adds to a conversion.
+  void write_results(std::ostream &output, const std::string &converter,
+                     const int &precision, const Corpus &corpus,
+                     const std::vector<Stage_Result> &results)
+  {
+    const int num_procs(El::mpi::Size(El::mpi::COMM_WORLD));
+    std::vector<double> min_seconds, max_seconds, sum_seconds;
+    for(auto &result : results)
+      {
+        min_seconds.push_back(result.seconds);
+      }
+    max_seconds = sum_seconds = min_seconds;
+    El::mpi::AllReduce(min_seconds.data(), results.size(), El::mpi::MIN,
+                       El::mpi::COMM_WORLD);
+    El::mpi::AllReduce(max_seconds.data(), results.size(), El::mpi::MAX,
+                       El::mpi::COMM_WORLD);
+    El::mpi::AllReduce(sum_seconds.data(), results.size(), El::mpi::SUM,
+                       El::mpi::COMM_WORLD);
+    for(size_t index = 0; El::mpi::Rank() == 0 && index < results.size();
+        ++index)
+      {
+        const Stage_Result &result(results[index]);
+        const double seconds(max_seconds[index]);
+        output << converter << "," << result.stage << "," << precision
+               << "," << corpus.degree << "," << corpus.dim << ","
+               << corpus.num_matrices << "," << corpus.num_free_variables
+               << "," << num_procs << "," << result.bytes << ","
+               << result.numbers << "," << min_seconds[index] << ","
+               << seconds << "," << sum_seconds[index] / num_procs << ","
+               << (seconds > 0 ? result.bytes / seconds / 1e6 : 0) << ","
+               << (seconds > 0 ? result.numbers / seconds : 0) << "\n"
+               << std::flush;
+      }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  // As in sdp2input and pvm2sdp, so that the benchmark measures the
+  // same allocator.
+  install_limb_pool();
+  El::Environment env(argc, argv);
+
+  try
+    {
+      std::string precisions_list, degrees_list, dims_list;
+      int64_t num_matrices, num_free_variables;
+      size_t repeats, num_threads;
+      uint64_t seed;
+      bool binary(false);
+      boost::filesystem::path work_dir, output_file;
+
+      po::options_description options("Basic options");
+      options.add_options()("help,h", "Show this helpful message.");
+      options.add_options()(
+        "precisions",
+        po::value<std::string>(&precisions_list)->default_value("512,1024"),
+        "Comma separated list of precisions, in bits.  The numbers in the "
+        "inputs have as many decimal digits as the precision holds.");
+      options.add_options()(
+        "degrees",
+        po::value<std::string>(&degrees_list)->default_value("10,20,40"),
+        "Comma separated list of the degrees of the polynomials.");
+      options.add_options()(
+        "dims", po::value<std::string>(&dims_list)->default_value("1,2"),
+        "Comma separated list of the dimensions of the positive "
+        "matrices.");
+      options.add_options()(
+        "numMatrices", po::value<int64_t>(&num_matrices)->default_value(16),
+        "The number of positive matrices in each input.");
+      options.add_options()(
+        "numFreeVariables",
+        po::value<int64_t>(&num_free_variables)->default_value(8),
+        "The number of free variables.  Each polynomial vector has one "
+        "more element.");
+      options.add_options()(
+        "threads", po::value<size_t>(&num_threads)->default_value(1),
+        "Number of threads each process uses in sdp2input.");
+      options.add_options()("binary", po::bool_switch(&binary),
+                            "Write the binary output format.");
+      options.add_options()("repeats",
+                            po::value<size_t>(&repeats)->default_value(3),
+                            "The number of times to run each converter.  "
+                            "The fastest run of each stage is reported.");
+      options.add_options()("seed",
+                            po::value<uint64_t>(&seed)->default_value(0),
+                            "Seed for the random inputs.");
+      options.add_options()(
+        "workDir",
+        po::value<boost::filesystem::path>(&work_dir)
+          ->default_value("convert_bench.work"),
+        "Directory for the inputs and outputs, which must be visible to "
+        "every process.  It is removed at the end.");
+      options.add_options()(
+        "output,o", po::value<boost::filesystem::path>(&output_file),
+        "CSV file for the results.  Defaults to standard output.");
+
+      po::variables_map variables_map;
+      po::store(po::parse_command_line(argc, argv, options), variables_map);
+
+      if(variables_map.count("help") != 0)
+        {
+          if(El::mpi::Rank() == 0)
+            {
+              std::cout << options << '\n';
+            }
+          return 0;
+        }
+      po::notify(variables_map);
+
+      const int rank(El::mpi::Rank(El::mpi::COMM_WORLD));
+      const std::vector<int> precisions(parse_list(precisions_list)),
+        degrees(parse_list(degrees_list)), dims(parse_list(dims_list));
+      if(num_matrices <= 0 || num_free_variables < 0)
+        {
+          throw std::runtime_error("numMatrices must be positive, and "
+                                   "numFreeVariables not negative");
+        }
+      if(repeats == 0 || num_threads == 0)
+        {
+          throw std::runtime_error("repeats and threads must be positive");
+        }
+
+      boost::filesystem::ofstream output_stream;
+      if(rank == 0 && !output_file.empty())
+        {
+          output_stream.open(output_file);
+          if(!output_stream.good())
+            {
+              throw std::runtime_error("Unable to open '"
+                                       + output_file.string() + "'");
+            }
+        }
+      std::ostream &output(output_file.empty() ? std::cout : output_stream);
+      if(rank == 0)
+        {
+          output << "converter,stage,precision,degree,dim,num_matrices,"
+                    "num_free_variables,num_procs,bytes,numbers,"
+                    "min_seconds,max_seconds,mean_seconds,MB_per_second,"
+                    "numbers_per_second\n";
+          boost::filesystem::create_directories(work_dir);
+        }
+
+      const boost::filesystem::path json_file(work_dir / "input.json"),
+        xml_file(work_dir / "input.xml"), output_dir(work_dir / "output");
+      for(auto &precision : precisions)
+        {
+          El::gmp::SetPrecision(precision);
+          // El::gmp wants base-2 bits, but boost::multiprecision want
+          // base-10 digits.
+          const size_t digits(precision * log(2) / log(10));
+          Boost_Float::default_precision(digits);
+          for(auto &degree : degrees)
+            {
+              for(auto &dim : dims)
+                {
+                  const Corpus corpus{degree, dim, num_matrices,
+                                      num_free_variables, digits, seed};
+                  uint64_t num_numbers[2] = {0, 0};
+                  if(rank == 0)
+                    {
+                      num_numbers[0] = write_json_corpus(corpus, json_file);
+                      num_numbers[1] = write_xml_corpus(corpus, xml_file);
+                    }
+                  MPI_Bcast(num_numbers, 2, MPI_UINT64_T, 0,
+                            El::mpi::COMM_WORLD.comm);
+
+                  write_results(output, "sdp2input", precision, corpus,
+                                fastest(output_dir, repeats, [&]() {
+                                  return time_sdp2input(
+                                    json_file, output_dir, num_numbers[0],
+                                    binary, num_threads);
+                                }));
+                  write_results(output, "pvm2sdp", precision, corpus,
+                                fastest(output_dir, repeats, [&]() {
+                                  return time_pvm2sdp(xml_file, output_dir,
+                                                      num_numbers[1],
+                                                      binary);
+                                }));
+                }
+            }
+        }
+      El::mpi::Barrier(El::mpi::COMM_WORLD);
+      if(rank == 0)
+        {
+          boost::filesystem::remove_all(work_dir);
+          if(!output.good())
+            {
+              throw std::runtime_error("Error when writing results");
+            }
+        }
+    }
+  catch(std::exception &e)
+    {
+      std::cerr << "Error: " << e.what() << "\n" << std::flush;
+      El::mpi::Abort(El::mpi::COMM_WORLD, 1);
+    }
+  catch(...)
+    {
+      std::cerr << "Unknown Error\n" << std::flush;
+      El::mpi::Abort(El::mpi::COMM_WORLD, 1);
+    }
+}
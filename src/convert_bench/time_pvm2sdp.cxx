@@ -0,0 +1,48 @@
+#include "Corpus.hxx"
+#include "Stage_Result.hxx"
+#include "../sdp_convert.hxx"
+#include "../Timers.hxx"
+
+void scan_xml_input(const boost::filesystem::path &input_file,
+                    std::vector<Block_Cost> &costs);
+
+void read_input_files(
+  const std::vector<boost::filesystem::path> &input_files,
+  const boost::filesystem::path &output_dir, const bool &binary,
+  const bool &compress, const bool &incremental);
+
+// One run of pvm2sdp.  pvm2sdp streams each matrix from the parser to
+// the writer, so parsing, converting and writing can not be timed
+// separately.  The scan, the first pass over the input that every rank
+// makes to assign the matrices to ranks, is timed on its own, and
+// measures the speed of the XML parser.  "output" is the size of the
+// output over the time of the whole run.  Collective.
+
+std::vector<Stage_Result>
+time_pvm2sdp(const boost::filesystem::path &input_file,
+             const boost::filesystem::path &output_dir,
+             const double &num_numbers, const bool &binary)
+{
+  Timers timers(false);
+
+  El::mpi::Barrier(El::mpi::COMM_WORLD);
+  auto &scan_timer(timers.add_and_start("scan"));
+  std::vector<Block_Cost> costs;
+  scan_xml_input(input_file, costs);
+  scan_timer.stop();
+
+  El::mpi::Barrier(El::mpi::COMM_WORLD);
+  auto &total_timer(timers.add_and_start("total"));
+  read_input_files({input_file}, output_dir, binary, false, false);
+  total_timer.stop();
+  El::mpi::Barrier(El::mpi::COMM_WORLD);
+
+  const double input_bytes(boost::filesystem::file_size(input_file)),
+    output_bytes(El::mpi::Rank() == 0 ? directory_bytes(output_dir) : 0);
+  return {{"scan", Timer_Statistics::seconds(timers.find("scan")->total),
+           input_bytes, num_numbers},
+          {"total", Timer_Statistics::seconds(timers.find("total")->total),
+           input_bytes, num_numbers},
+          {"output", Timer_Statistics::seconds(timers.find("total")->total),
+           output_bytes, 0}};
+}
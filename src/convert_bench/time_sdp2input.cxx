@@ -0,0 +1,81 @@
+#include "Corpus.hxx"
+#include "Stage_Result.hxx"
+#include "../sdp2input/Positive_Matrix_With_Prefactor.hxx"
+#include "../Timers.hxx"
+
+void read_input(const boost::filesystem::path &input_file,
+                std::vector<El::BigFloat> &objectives,
+                std::vector<El::BigFloat> &normalization,
+                std::vector<Positive_Matrix_With_Prefactor> &matrices,
+                std::vector<size_t> &indices, const size_t &num_threads);
+
+void write_output(const boost::filesystem::path &output_dir,
+                  const std::vector<El::BigFloat> &objectives,
+                  const std::vector<El::BigFloat> &normalization,
+                  const std::vector<Positive_Matrix_With_Prefactor> &matrices,
+                  const std::vector<size_t> &indices, const bool &binary,
+                  const bool &compress, const bool &incremental,
+                  const size_t &low_precision,
+                  const size_t &low_precision_max_degree,
+                  const size_t &num_threads, Timers &timers);
+
+// One run of sdp2input's conversion, split into the stages that it
+// already times.  Every rank parses the whole file, but only converts
+// its own matrices.  bilinear_basis and dual_constraint_group are
+// summed over the matrices of this rank, and over threads, so with
+// several threads they can be longer than the run.  The blocks are
+// written on a background thread, so write is the time that the
+// conversion waits for that thread.  Collective.
+
+namespace
+{
+  double sum_seconds(const Timers &timers, const std::string &prefix)
+  {
+    double result(0);
+    for(auto &statistics : timers)
+      {
+        if(statistics.name.compare(0, prefix.size(), prefix) == 0)
+          {
+            result += Timer_Statistics::seconds(statistics.total);
+          }
+      }
+    return result;
+  }
+}
+
+std::vector<Stage_Result>
+time_sdp2input(const boost::filesystem::path &input_file,
+               const boost::filesystem::path &output_dir,
+               const double &num_numbers, const bool &binary,
+               const size_t &num_threads)
+{
+  std::vector<El::BigFloat> objectives, normalization;
+  std::vector<Positive_Matrix_With_Prefactor> matrices;
+  std::vector<size_t> indices;
+  Timers timers(false);
+
+  El::mpi::Barrier(El::mpi::COMM_WORLD);
+  auto &total_timer(timers.add_and_start("total"));
+  auto &read_input_timer(timers.add_and_start("read_input"));
+  read_input(input_file, objectives, normalization, matrices, indices,
+             num_threads);
+  read_input_timer.stop();
+  write_output(output_dir, objectives, normalization, matrices, indices,
+               binary, false, false, 0, 0, num_threads, timers);
+  total_timer.stop();
+  El::mpi::Barrier(El::mpi::COMM_WORLD);
+
+  const double input_bytes(boost::filesystem::file_size(input_file)),
+    output_bytes(El::mpi::Rank() == 0 ? directory_bytes(output_dir) : 0);
+  return {
+    {"parse", sum_seconds(timers, "read_input"), input_bytes, num_numbers},
+    {"bilinear_basis",
+     sum_seconds(timers, "write_output.matrices.bilinear_basis_"), 0, 0},
+    {"dual_constraint_group",
+     sum_seconds(timers, "write_output.matrices.dual_constraint_"), 0, 0},
+    {"write",
+     sum_seconds(timers, "write_output.write_")
+       + sum_seconds(timers, "write_output.finish"),
+     output_bytes, 0},
+    {"total", sum_seconds(timers, "total"), input_bytes, num_numbers}};
+}
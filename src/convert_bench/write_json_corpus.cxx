@@ -0,0 +1,87 @@
+#include "Corpus.hxx"
+
+#include <boost/filesystem/fstream.hpp>
+
+#include <sstream>
+#include <vector>
+
+// Write a random sdp2input JSON file.  The matrices are symmetric, and
+// all have the prefactor of a typical conformal bootstrap problem.
+// Returns the number of numbers in the file.
+
+namespace
+{
+  void write_vector(std::ostream &output, const size_t &length,
+                    const size_t &digits, Random &random)
+  {
+    output << "[";
+    for(size_t index = 0; index < length; ++index)
+      {
+        output << (index == 0 ? "" : ",") << "\""
+               << random_decimal(random, digits) << "\"";
+      }
+    output << "]";
+  }
+}
+
+size_t write_json_corpus(const Corpus &corpus,
+                         const boost::filesystem::path &path)
+{
+  Random random(corpus.seed, 0);
+  const size_t vector_length(corpus.num_free_variables + 1),
+    num_coefficients(corpus.degree + 1);
+  size_t result(2 * vector_length);
+
+  boost::filesystem::ofstream output(path);
+  output << "{\"objective\":";
+  write_vector(output, vector_length, corpus.digits, random);
+  output << ",\"normalization\":";
+  write_vector(output, vector_length, corpus.digits, random);
+  output << ",\"PositiveMatrixWithPrefactorArray\":[";
+  for(int64_t matrix = 0; matrix < corpus.num_matrices; ++matrix)
+    {
+      output << (matrix == 0 ? "" : ",")
+             << "{\"DampedRational\":{\"base\":"
+                "\"0.171572875253809902396622551580603842860656249246\","
+                "\"constant\":\"1\",\"poles\":[\"-0.5\",\"-1.5\"]},"
+                "\"polynomials\":[";
+      result += 4;
+      // The upper triangle, mirrored into the lower one
+      std::vector<std::string> elements(corpus.dim * corpus.dim);
+      for(int64_t row = 0; row < corpus.dim; ++row)
+        {
+          for(int64_t column = row; column < corpus.dim; ++column)
+            {
+              std::stringstream element;
+              for(size_t polynomial = 0; polynomial < vector_length;
+                  ++polynomial)
+                {
+                  element << (polynomial == 0 ? "" : ",");
+                  write_vector(element, num_coefficients, corpus.digits,
+                               random);
+                }
+              elements[row * corpus.dim + column] = element.str();
+              elements[column * corpus.dim + row]
+                = elements[row * corpus.dim + column];
+            }
+        }
+      for(int64_t row = 0; row < corpus.dim; ++row)
+        {
+          output << (row == 0 ? "[" : ",[");
+          for(int64_t column = 0; column < corpus.dim; ++column)
+            {
+              output << (column == 0 ? "[" : ",[")
+                     << elements[row * corpus.dim + column] << "]";
+            }
+          output << "]";
+        }
+      output << "]}";
+      result += corpus.dim * corpus.dim * vector_length * num_coefficients;
+    }
+  output << "]}\n";
+  if(!output.good())
+    {
+      throw std::runtime_error("Error when writing " + path.string());
+    }
+  return result;
+}
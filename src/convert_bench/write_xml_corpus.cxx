@@ -0,0 +1,105 @@
+#include "Corpus.hxx"
+
+#include <boost/filesystem/fstream.hpp>
+
+#include <sstream>
+#include <vector>
+
+// Write a random pvm2sdp XML file with the same shape as the JSON file
+// from write_json_corpus.  The sample points and scalings are random,
+// and the bilinear basis is the monomials, since pvm2sdp does not
+// check them.  Returns the number of numbers in the file.
+
+namespace
+{
+  void write_elements(std::ostream &output, const std::string &tag,
+                      const size_t &length, const bool &is_signed,
+                      const size_t &digits, Random &random)
+  {
+    output << "<" << tag << ">";
+    for(size_t index = 0; index < length; ++index)
+      {
+        output << "<elt>" << random_decimal(random, digits, is_signed)
+               << "</elt>";
+      }
+    output << "</" << tag << ">\n";
+  }
+}
+
+size_t write_xml_corpus(const Corpus &corpus,
+                        const boost::filesystem::path &path)
+{
+  Random random(corpus.seed, 1);
+  const size_t vector_length(corpus.num_free_variables + 1),
+    num_coefficients(corpus.degree + 1),
+    basis_size(corpus.degree / 2 + 1);
+  size_t result(vector_length);
+
+  boost::filesystem::ofstream output(path);
+  output << "<?xml version=\"1.0\"?>\n<sdp>\n";
+  write_elements(output, "objective", vector_length, true, corpus.digits,
+                 random);
+  output << "<polynomialVectorMatrices>\n";
+  for(int64_t matrix = 0; matrix < corpus.num_matrices; ++matrix)
+    {
+      output << "<polynomialVectorMatrix>\n<rows>" << corpus.dim
+             << "</rows><cols>" << corpus.dim << "</cols>\n<elements>\n";
+      // The upper triangle, mirrored into the lower one
+      std::vector<std::string> elements(corpus.dim * corpus.dim);
+      for(int64_t row = 0; row < corpus.dim; ++row)
+        {
+          for(int64_t column = row; column < corpus.dim; ++column)
+            {
+              std::stringstream element;
+              element << "<polynomialVector>";
+              for(size_t polynomial = 0; polynomial < vector_length;
+                  ++polynomial)
+                {
+                  element << "<polynomial>";
+                  for(size_t coefficient = 0;
+                      coefficient < num_coefficients; ++coefficient)
+                    {
+                      element << "<coeff>"
+                              << random_decimal(random, corpus.digits)
+                              << "</coeff>";
+                    }
+                  element << "</polynomial>";
+                }
+              element << "</polynomialVector>\n";
+              elements[row * corpus.dim + column] = element.str();
+              elements[column * corpus.dim + row]
+                = elements[row * corpus.dim + column];
+            }
+        }
+      for(auto &element : elements)
+        {
+          output << element;
+        }
+      output << "</elements>\n";
+      write_elements(output, "samplePoints", num_coefficients, false,
+                     corpus.digits, random);
+      write_elements(output, "sampleScalings", num_coefficients, false,
+                     corpus.digits, random);
+      output << "<bilinearBasis>";
+      for(size_t polynomial = 0; polynomial < basis_size; ++polynomial)
+        {
+          output << "<polynomial>";
+          for(size_t coefficient = 0; coefficient <= polynomial;
+              ++coefficient)
+            {
+              output << "<coeff>" << (coefficient == polynomial ? 1 : 0)
+                     << "</coeff>";
+            }
+          output << "</polynomial>";
+        }
+      output << "</bilinearBasis>\n</polynomialVectorMatrix>\n";
+      result += corpus.dim * corpus.dim * vector_length * num_coefficients
+                + 2 * num_coefficients + basis_size * (basis_size + 1) / 2;
+    }
+  output << "</polynomialVectorMatrices>\n</sdp>\n";
+  if(!output.good())
+    {
+      throw std::runtime_error("Error when writing " + path.string());
+    }
+  return result;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+// A random number generator whose output only depends on the seeds.
+// std::mt19937_64 and std::seed_seq are fully specified by the
+// standard, but the std distributions are not, so the conversions to
+// integers and doubles are done here.
+struct Random
+{
+  std::mt19937_64 generator;
+
+  Random(const uint64_t &seed, const uint64_t &stream)
+  {
+    std::seed_seq sequence({uint32_t(seed), uint32_t(seed >> 32),
+                            uint32_t(stream), uint32_t(stream >> 32)});
+    generator.seed(sequence);
+  }
+
+  // Uniform in [min, max]
+  int64_t integer(const int64_t &min, const int64_t &max)
+  {
+    return min + int64_t(generator() % uint64_t(max - min + 1));
+  }
+  // Uniform in [-1, 1)
+  double symmetric()
+  {
+    return 2 * std::ldexp(double(generator() >> 11), -53) - 1;
+  }
+};
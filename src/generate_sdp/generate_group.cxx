@@ -0,0 +1,78 @@
+#include "Random.hxx"
+#include "../sdp_convert.hxx"
+
+// Make a random positivity constraint
+//
+//   M(x) = M_{-1}(x) + \sum_n y_n M_n(x) is positive semidefinite
+//
+// with dim x dim symmetric matrices of polynomials of the given
+// degree, and convert it to a Dual_Constraint_Group.  The M_n have
+// coefficients uniform in [-1, 1), so that no direction of y stays
+// feasible forever once there are a few blocks.
+//
+// M_{-1} has dim (1 + x^degree) on the diagonal, and off-diagonal
+// coefficients of at most 1/(degree + 1) in size.  For x >= 0, each
+// off-diagonal element is then at most (1 + x^degree), so M_{-1} is
+// strictly diagonally dominant and y = 0 is strictly feasible.
+//
+// The sample points are the rescaled Laguerre points that sdp2input
+// uses, with scalings exp(-x_k) and the monomials as the bilinear
+// basis.
+
+Dual_Constraint_Group generate_group(const size_t &dim, const size_t &degree,
+                                     const size_t &num_free_variables,
+                                     Random &random)
+{
+  Polynomial_Vector_Matrix m;
+  m.rows = dim;
+  m.cols = dim;
+  m.elements.resize(dim * dim);
+
+  for(size_t c = 0; c < dim; ++c)
+    for(size_t r = 0; r <= c; ++r)
+      {
+        std::vector<Polynomial> &element(m.elt(r, c));
+        element.resize(num_free_variables + 1,
+                       Polynomial(degree + 1, El::BigFloat(0)));
+        for(auto &coefficient : element[0].coefficients)
+          {
+            coefficient = (r == c ? El::BigFloat(0)
+                                  : El::BigFloat(random.symmetric())
+                                      / El::BigFloat(int(degree + 1)));
+          }
+        if(r == c)
+          {
+            element[0].coefficients.front() += El::BigFloat(int(dim));
+            element[0].coefficients.back() += El::BigFloat(int(dim));
+          }
+        for(size_t n = 1; n < element.size(); ++n)
+          for(auto &coefficient : element[n].coefficients)
+            {
+              coefficient = El::BigFloat(random.symmetric());
+            }
+        if(r != c)
+          {
+            m.elt(c, r) = element;
+          }
+      }
+
+  const size_t num_points(degree + 1);
+  const El::BigFloat constant(
+    -El::Pi<El::BigFloat>() * El::Pi<El::BigFloat>()
+    / (El::BigFloat(int(64 * num_points))
+       * El::Log(3 - 2 * El::Sqrt(El::BigFloat(2)))));
+  for(size_t k = 0; k < num_points; ++k)
+    {
+      const El::BigFloat x((-1 + 4 * El::BigFloat(int(k)))
+                           * (-1 + 4 * El::BigFloat(int(k))) * constant);
+      m.sample_points.push_back(x);
+      m.sample_scalings.push_back(El::Exp(-x));
+    }
+  for(size_t power = 0; power <= degree / 2; ++power)
+    {
+      Polynomial monomial(power + 1, El::BigFloat(0));
+      monomial.coefficients.back() = 1;
+      m.bilinear_basis.push_back(monomial);
+    }
+  return Dual_Constraint_Group(m);
+}
@@ -0,0 +1,191 @@
+// Write a random SDP in the format that sdpb reads, for benchmarking
+// and scaling studies.  The block structure and all of the numbers
+// only depend on the options and the seed, not on the number of
+// processes used to write it.  Each rank writes the blocks with index
+// equal to its rank modulo the number of processes, as pvm2sdp and
+// sdp2input do.
+
+#include "Random.hxx"
+#include "../sdp_convert.hxx"
+
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+Dual_Constraint_Group generate_group(const size_t &dim, const size_t &degree,
+                                     const size_t &num_free_variables,
+                                     Random &random);
+
+namespace
+{
+  // "min:max" or a single number.
+  std::pair<int64_t, int64_t>
+  parse_range(const std::string &name, const std::string &range)
+  {
+    std::pair<int64_t, int64_t> result;
+    try
+      {
+        const size_t colon(range.find(':'));
+        result.first = std::stoll(range.substr(0, colon));
+        result.second = (colon == std::string::npos
+                           ? result.first
+                           : std::stoll(range.substr(colon + 1)));
+      }
+    catch(std::exception &)
+      {
+        throw std::runtime_error("Invalid range for " + name + ": '" + range
+                                 + "'");
+      }
+    if(result.first < 0 || result.second < result.first)
+      {
+        throw std::runtime_error("Invalid range for " + name + ": '" + range
+                                 + "'");
+      }
+    return result;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  El::Environment env(argc, argv);
+
+  const int rank(El::mpi::Rank()),
+    num_procs(El::mpi::Size(El::mpi::COMM_WORLD));
+
+  try
+    {
+      int precision;
+      size_t num_blocks, num_free_variables, low_precision,
+        low_precision_max_degree;
+      uint64_t seed;
+      std::string dims_range, degrees_range;
+      boost::filesystem::path output_dir;
+      bool binary(false);
+
+      po::options_description options("Basic options");
+      options.add_options()("help,h", "Show this helpful message.");
+      options.add_options()(
+        "output,o",
+        po::value<boost::filesystem::path>(&output_dir)->required(),
+        "Directory to place output");
+      options.add_options()(
+        "precision", po::value<int>(&precision)->required(),
+        "The precision, in the number of bits, for numbers in the "
+        "computation. ");
+      options.add_options()("blocks",
+                            po::value<size_t>(&num_blocks)->required(),
+                            "The number of positivity constraints.");
+      options.add_options()(
+        "dims", po::value<std::string>(&dims_range)->default_value("1"),
+        "The dimension of the polynomial matrix of each constraint, as a "
+        "range min:max.  Each constraint gets a dimension uniformly "
+        "distributed in the range.");
+      options.add_options()(
+        "degrees",
+        po::value<std::string>(&degrees_range)->default_value("20"),
+        "The degree of the polynomials in each constraint, as a range "
+        "min:max.");
+      options.add_options()(
+        "numFreeVariables",
+        po::value<size_t>(&num_free_variables)->default_value(100),
+        "The number of free variables N, which is the width of the free "
+        "variable matrix B.");
+      options.add_options()("seed",
+                            po::value<uint64_t>(&seed)->default_value(0),
+                            "Seed for the random numbers.");
+      options.add_options()(
+        "binary", po::bool_switch(&binary),
+        "Write the free variable matrix and primal objective in a binary "
+        "format that sdpb reads much faster than text.");
+      options.add_options()(
+        "lowPrecision",
+        po::value<size_t>(&low_precision)->default_value(0),
+        "Precision in bits that sdpb uses for the block-local kernels of "
+        "the blocks with degree at most lowPrecisionMaxDegree.  0 means "
+        "sdpb's precision for every block.");
+      options.add_options()(
+        "lowPrecisionMaxDegree",
+        po::value<size_t>(&low_precision_max_degree)->default_value(0),
+        "The largest degree of a block that uses lowPrecision.");
+
+      po::variables_map variables_map;
+      po::store(po::parse_command_line(argc, argv, options), variables_map);
+
+      if(variables_map.count("help") != 0)
+        {
+          if(rank == 0)
+            {
+              std::cout << options << '\n';
+            }
+          return 0;
+        }
+      po::notify(variables_map);
+
+      const std::pair<int64_t, int64_t> dims(parse_range("dims", dims_range)),
+        degrees(parse_range("degrees", degrees_range));
+      if(dims.first == 0)
+        {
+          throw std::runtime_error("dims must be positive");
+        }
+      if(num_blocks == 0 || num_free_variables == 0)
+        {
+          throw std::runtime_error(
+            "blocks and numFreeVariables must be positive");
+        }
+      if(boost::filesystem::exists(output_dir)
+         && !boost::filesystem::is_directory(output_dir))
+        {
+          throw std::runtime_error("Output directory '" + output_dir.string()
+                                   + "' exists and is not a directory");
+        }
+      El::gmp::SetPrecision(precision);
+
+      // Stream 0 is the block structure, stream 1 the objective, and
+      // stream 2 + j the numbers in block j.
+      Random structure_random(seed, 0);
+      std::vector<size_t> block_dims, block_degrees;
+      for(size_t block = 0; block < num_blocks; ++block)
+        {
+          block_dims.push_back(
+            structure_random.integer(dims.first, dims.second));
+          block_degrees.push_back(
+            structure_random.integer(degrees.first, degrees.second));
+        }
+
+      Random objective_random(seed, 1);
+      const El::BigFloat objective_const(0);
+      std::vector<El::BigFloat> dual_objective_b;
+      for(size_t n = 0; n < num_free_variables; ++n)
+        {
+          dual_objective_b.emplace_back(objective_random.symmetric());
+        }
+
+      std::vector<size_t> indices;
+      std::vector<Dual_Constraint_Group> dual_constraint_groups;
+      for(size_t block = rank; block < num_blocks; block += num_procs)
+        {
+          Random block_random(seed, 2 + block);
+          indices.push_back(block);
+          dual_constraint_groups.push_back(
+            generate_group(block_dims[block], block_degrees[block],
+                           num_free_variables, block_random));
+          if(block_degrees[block] <= low_precision_max_degree)
+            {
+              dual_constraint_groups.back().precision = low_precision;
+            }
+        }
+      write_sdpb_input_files(output_dir, rank, num_procs, indices,
+                             objective_const, dual_objective_b,
+                             dual_constraint_groups, binary);
+    }
+  catch(std::exception &e)
+    {
+      std::cerr << "Error: " << e.what() << "\n" << std::flush;
+      El::mpi::Abort(El::mpi::COMM_WORLD, 1);
+    }
+  catch(...)
+    {
+      std::cerr << "Unknown Error\n" << std::flush;
+      El::mpi::Abort(El::mpi::COMM_WORLD, 1);
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Call f(item) for every 0 <= item < num_items using num_threads
+// threads, including the calling thread.  Threads take the next
+// unclaimed item when they finish one, so uneven items are balanced
+// automatically.
+//
+// f must not make any MPI calls, including Elemental routines that
+// communicate, since the threads share the same communicators.  If f
+// throws, the first exception is rethrown after all threads finish.
+
+template <typename F>
+void parallel_for(const size_t &num_threads, const size_t &num_items,
+                  const F &f)
+{
+  if(num_threads <= 1 || num_items <= 1)
+    {
+      for(size_t item = 0; item < num_items; ++item)
+        {
+          f(item);
+        }
+      return;
+    }
+
+  std::atomic<size_t> next_item(0);
+  std::exception_ptr exception;
+  std::mutex exception_mutex;
+  auto worker([&]() {
+    try
+      {
+        for(size_t item(next_item++); item < num_items; item = next_item++)
+          {
+            f(item);
+          }
+      }
+    catch(...)
+      {
+        std::lock_guard<std::mutex> lock(exception_mutex);
+        if(!exception)
+          {
+            exception = std::current_exception();
+          }
+        next_item = num_items;
+      }
+  });
+
+  std::vector<std::thread> threads;
+  threads.reserve(std::min(num_threads, num_items) - 1);
+  for(size_t thread = 1; thread < std::min(num_threads, num_items); ++thread)
+    {
+      threads.emplace_back(worker);
+    }
+  worker();
+  for(auto &thread : threads)
+    {
+      thread.join();
+    }
+  if(exception)
+    {
+      std::rethrow_exception(exception);
+    }
+}
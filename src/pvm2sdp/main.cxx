@@ -1,41 +1,37 @@
 #include "../sdp_convert.hxx"
+#include "../sdpb/limb_pool.hxx"
 
 void parse_command_line(int argc, char **argv, int &precision,
                         std::vector<boost::filesystem::path> &input_files,
-                        boost::filesystem::path &output_dir);
+                        boost::filesystem::path &output_dir, bool &binary,
+                        bool &compress, bool &incremental);
 
 void read_input_files(
   const std::vector<boost::filesystem::path> &input_files,
-  El::BigFloat &objective_const, std::vector<El::BigFloat> &dual_objectives_b,
-  std::vector<Dual_Constraint_Group> &dual_constraint_groups,
-  std::vector<size_t> &indices);
+  const boost::filesystem::path &output_dir, const bool &binary,
+  const bool &compress, const bool &incremental);
 
 int main(int argc, char **argv)
 {
+  // The coefficients of the polynomials are many small, long lived
+  // GMP allocations.  This has to come before anything allocates
+  // GMP limbs.
+  install_limb_pool();
   El::Environment env(argc, argv);
 
-  const int rank(El::mpi::Rank()),
-    num_procs(El::mpi::Size(El::mpi::COMM_WORLD));
-
   try
     {
       int precision;
       std::vector<boost::filesystem::path> input_files;
       boost::filesystem::path output_dir;
+      bool binary, compress, incremental;
 
-      parse_command_line(argc, argv, precision, input_files, output_dir);
+      parse_command_line(argc, argv, precision, input_files, output_dir,
+                         binary, compress, incremental);
       El::gmp::SetPrecision(precision);
 
-      std::vector<size_t> indices;
-      El::BigFloat objective_const;
-      std::vector<El::BigFloat> dual_objective_b;
-      std::vector<Dual_Constraint_Group> dual_constraint_groups;
-      read_input_files(input_files, objective_const, dual_objective_b,
-                       dual_constraint_groups, indices);
-
-      write_sdpb_input_files(output_dir, rank, num_procs, indices,
-                             objective_const, dual_objective_b,
-                             dual_constraint_groups);
+      read_input_files(input_files, output_dir, binary, compress,
+                       incremental);
     }
   catch(std::exception &e)
     {
@@ -7,9 +7,22 @@ using namespace std::literals;
 
 void parse_command_line(int argc, char **argv, int &precision,
                         std::vector<boost::filesystem::path> &input_files,
-                        boost::filesystem::path &output_dir)
+                        boost::filesystem::path &output_dir, bool &binary,
+                        bool &compress, bool &incremental)
 {
-  std::string usage("pvm2sdp [PRECISION] [INPUT]... [OUTPUT_DIR]\n");
+  std::string usage(
+    "pvm2sdp [--binary] [--compress] [--incremental] [PRECISION] "
+    "[INPUT]... [OUTPUT_DIR]\n"
+    "  --binary       Write the free variable matrix and primal objective\n"
+    "                 in a binary format that sdpb reads much faster.\n"
+    "  --compress     Compress the free variable matrix, the primal\n"
+    "                 objective and the objectives.  Not available with\n"
+    "                 --binary.\n"
+    "  --incremental  Keep the existing output of blocks whose input has\n"
+    "                 not changed since the last run in OUTPUT_DIR.\n");
+  binary = false;
+  compress = false;
+  incremental = false;
   for(int arg = 1; arg < argc; ++arg)
     {
       if((argv[arg] == "-h"s) || argv[arg] == "--help"s)
@@ -18,6 +31,29 @@ void parse_command_line(int argc, char **argv, int &precision,
           exit(0);
         }
     }
+  // Remove the flags, so that the rest are the positional arguments.
+  std::vector<char *> arguments;
+  for(int arg = 0; arg < argc; ++arg)
+    {
+      if(argv[arg] == "--binary"s)
+        {
+          binary = true;
+        }
+      else if(argv[arg] == "--compress"s)
+        {
+          compress = true;
+        }
+      else if(argv[arg] == "--incremental"s)
+        {
+          incremental = true;
+        }
+      else
+        {
+          arguments.push_back(argv[arg]);
+        }
+    }
+  argc = arguments.size();
+  argv = arguments.data();
 
   if(argc < 4)
     {
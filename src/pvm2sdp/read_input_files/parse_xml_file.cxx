@@ -0,0 +1,64 @@
+// Runs a SAX parser over an XML file with libxml2's push parser.  The
+// file is memory mapped and handed to the parser in large chunks,
+// instead of the small reads of xmlSAXUserParseFile(), and
+// XML_PARSE_HUGE lifts libxml2's limits on the size of text nodes and
+// the depth of the input, which inputs with many gigabytes of numbers
+// can run into.
+
+#include <libxml2/libxml/parser.h>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+void parse_xml_file(const boost::filesystem::path &input_file,
+                    xmlSAXHandler &xml_handlers, void *user_data)
+{
+  LIBXML_TEST_VERSION;
+
+  if(boost::filesystem::file_size(input_file) == 0)
+    {
+      throw std::runtime_error("Empty input file: " + input_file.string());
+    }
+  boost::interprocess::file_mapping mapped_file(
+    input_file.c_str(), boost::interprocess::read_only);
+  boost::interprocess::mapped_region mapped_region(
+    mapped_file, boost::interprocess::read_only);
+  mapped_region.advise(boost::interprocess::mapped_region::advice_sequential);
+  const char *begin(static_cast<const char *>(mapped_region.get_address()));
+  const size_t size(mapped_region.get_size());
+
+  // The handlers may throw, so the context is freed by unique_ptr.
+  std::unique_ptr<xmlParserCtxt, decltype(&xmlFreeParserCtxt)> context(
+    xmlCreatePushParserCtxt(&xml_handlers, user_data, nullptr, 0,
+                            input_file.c_str()),
+    &xmlFreeParserCtxt);
+  if(!context)
+    {
+      throw std::runtime_error("Unable to create an XML parser for "
+                               + input_file.string());
+    }
+  xmlCtxtUseOptions(context.get(), XML_PARSE_HUGE);
+
+  // xmlParseChunk() takes an int size
+  const size_t chunk_size(size_t(1) << 26);
+  int error(0);
+  for(size_t offset(0); error == 0 && offset < size; offset += chunk_size)
+    {
+      error = xmlParseChunk(context.get(), begin + offset,
+                            std::min(chunk_size, size - offset), 0);
+    }
+  if(error == 0)
+    {
+      error = xmlParseChunk(context.get(), nullptr, 0, 1);
+    }
+  if(error != 0 || !context->wellFormed)
+    {
+      throw std::runtime_error("Unable to parse input file: "
+                               + input_file.string());
+    }
+}
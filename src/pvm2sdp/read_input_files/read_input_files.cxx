@@ -1,51 +1,76 @@
 #include "../../sdp_convert.hxx"
 
-void read_xml_input(const boost::filesystem::path &input_file,
-                    El::BigFloat &objective_const,
-                    std::vector<El::BigFloat> &dual_objectives_b,
-                    std::vector<Dual_Constraint_Group> &dual_constraint_groups,
-                    std::vector<size_t> &indices, size_t &num_processed);
+#include <algorithm>
+#include <iterator>
 
-void read_input_files(
-  const std::vector<boost::filesystem::path> &input_files,
-  El::BigFloat &objective_const, std::vector<El::BigFloat> &dual_objectives_b,
-  std::vector<Dual_Constraint_Group> &dual_constraint_groups,
-  std::vector<size_t> &indices, size_t &num_processed);
+void scan_xml_input(const boost::filesystem::path &input_file,
+                    std::vector<Block_Cost> &costs);
 
-void read_input_files(
-  const std::vector<boost::filesystem::path> &input_files,
-  El::BigFloat &objective_const, std::vector<El::BigFloat> &dual_objectives_b,
-  std::vector<Dual_Constraint_Group> &dual_constraint_groups,
-  std::vector<size_t> &indices)
-{
-  size_t num_processed(0);
-
-  read_input_files(input_files, objective_const, dual_objectives_b,
-                   dual_constraint_groups, indices, num_processed);
-}
+void read_xml_input(const boost::filesystem::path &input_file,
+                    std::vector<El::BigFloat> &objective,
+                    const std::vector<int> &block_owners,
+                    SDPB_Input_Writer &writer, size_t &num_processed);
 
+// The matrices are assigned to ranks by their estimated conversion
+// cost, from a quick first pass over the input (see Input_File_Plan).
+// Each rank then only converts its own matrices in the second pass,
+// writing each block's files as soon as it is converted, so that only
+// one matrix is held in memory at a time.
 void read_input_files(
   const std::vector<boost::filesystem::path> &input_files,
-  El::BigFloat &objective_const, std::vector<El::BigFloat> &dual_objectives_b,
-  std::vector<Dual_Constraint_Group> &dual_constraint_groups,
-  std::vector<size_t> &indices, size_t &num_processed)
+  const boost::filesystem::path &output_dir, const bool &binary,
+  const bool &compress, const bool &incremental)
 {
-  for(auto &input_file : input_files)
+  const std::vector<boost::filesystem::path> files(
+    flatten_input_files(input_files));
+  const Input_File_Plan plan(files, scan_xml_input);
+  const int rank(El::mpi::Rank()),
+    num_procs(El::mpi::Size(El::mpi::COMM_WORLD));
+
+  SDPB_Input_Writer writer(output_dir, rank,
+                           std::count(plan.block_owners.begin(),
+                                      plan.block_owners.end(), rank),
+                           binary, incremental,
+                           SDPB_Input_Writer::default_max_queued_blocks,
+                           compress);
+  // The objective constant followed by b, from the last file
+  // that has an objective.
+  std::vector<El::BigFloat> objective;
+  int64_t objective_file(-1);
+  for(size_t file = 0; file < files.size(); ++file)
     {
-      if(input_file.empty())
-        {
-          continue;
-        }
-      if(input_file.extension() == ".nsv")
-        {
-          read_input_files(read_file_list(input_file), objective_const,
-                           dual_objectives_b, dual_constraint_groups, indices,
-                           num_processed);
-        }
-      else
+      if(plan.is_read(file))
         {
-          read_xml_input(input_file, objective_const, dual_objectives_b,
-                         dual_constraint_groups, indices, num_processed);
+          size_t num_processed(plan.file_offsets[file]);
+          std::vector<El::BigFloat> file_objective;
+          read_xml_input(files[file], file_objective, plan.block_owners,
+                         writer, num_processed);
+          if(num_processed != plan.file_offsets[file + 1])
+            {
+              throw std::runtime_error(
+                "Found "
+                + std::to_string(plan.file_offsets[file + 1]
+                                 - plan.file_offsets[file])
+                + " polynomialVectorMatrix in " + files[file].string()
+                + " when scanning, but "
+                + std::to_string(num_processed - plan.file_offsets[file])
+                + " when reading it.");
+            }
+          if(!file_objective.empty())
+            {
+              std::swap(objective, file_objective);
+              objective_file = file;
+            }
         }
     }
+  plan.share_last(objective_file, objective);
+
+  El::BigFloat objective_const(objective.empty() ? El::BigFloat(0)
+                                                 : objective.front());
+  std::vector<El::BigFloat> dual_objectives_b;
+  if(!objective.empty())
+    {
+      dual_objectives_b.assign(std::next(objective.begin()), objective.end());
+    }
+  writer.finish(num_procs, objective_const, dual_objectives_b);
 }
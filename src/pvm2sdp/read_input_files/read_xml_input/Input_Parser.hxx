@@ -13,12 +13,12 @@ public:
   Vector_State<Number_State<El::BigFloat>> objective_state;
   Vector_State<Polynomial_Vector_Matrix_State> polynomial_vector_matrices_state;
 
-  Input_Parser(std::vector<Dual_Constraint_Group> &dual_constraint_groups,
-               std::vector<size_t> &indices, size_t &num_processed)
+  Input_Parser(const std::vector<int> &block_owners,
+               SDPB_Input_Writer &writer, size_t &num_processed)
       : objective_state({"objective"s, "elt"s}),
         polynomial_vector_matrices_state(
           {"polynomialVectorMatrices"s, "polynomialVectorMatrix"s},
-          dual_constraint_groups, indices, num_processed)
+          block_owners, writer, num_processed)
   {}
 
   void on_start_element(const std::string &element_name);
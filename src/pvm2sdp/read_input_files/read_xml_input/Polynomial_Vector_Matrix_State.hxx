@@ -13,11 +13,14 @@ public:
               columns_string;
   bool inside = false, inside_rows = false, inside_columns = false;
   Polynomial_Vector_Matrix value;
-  std::vector<Dual_Constraint_Group> &dual_constraint_groups;
-  std::vector<size_t> &indices;
-  const size_t rank = El::mpi::Rank(),
-               num_procs = El::mpi::Size(El::mpi::COMM_WORLD);
+  // The rank that converts each matrix
+  const std::vector<int> &block_owners;
+  SDPB_Input_Writer &writer;
+  const int rank = El::mpi::Rank();
   size_t &num_processed;
+  // The depth of elements inside a matrix that another rank converts,
+  // or 0.  Such a matrix is skipped without touching the states below.
+  size_t skip_depth = 0;
 
   using Polynomial_State = Vector_State<Number_State<El::BigFloat>>;
   using Polynomial_Vector_State = Vector_State<Polynomial_State>;
@@ -28,10 +31,10 @@ public:
 
   Polynomial_Vector_Matrix_State(
     const std::vector<std::string> &names, const size_t &offset,
-    std::vector<Dual_Constraint_Group> &Dual_constraint_groups,
-    std::vector<size_t> &Indices, size_t &Num_processed)
-      : name(names.at(offset)), dual_constraint_groups(Dual_constraint_groups),
-        indices(Indices), num_processed(Num_processed),
+    const std::vector<int> &Block_owners, SDPB_Input_Writer &Writer,
+    size_t &Num_processed)
+      : name(names.at(offset)), block_owners(Block_owners), writer(Writer),
+        num_processed(Num_processed),
         elements_state(
           {"elements"s, "polynomialVector"s, "polynomial"s, "coeff"s}),
         sample_points_state({"samplePoints"s, "elt"s}),
@@ -41,7 +44,11 @@ public:
 
   bool xml_on_start_element(const std::string &element_name)
   {
-    if(inside)
+    if(skip_depth != 0)
+      {
+        ++skip_depth;
+      }
+    else if(inside)
       {
         if(element_name == rows_name)
           {
@@ -63,6 +70,11 @@ public:
               + element_name + "'");
           }
       }
+    else if(element_name == name && block_owners.at(num_processed) != rank)
+      {
+        inside = true;
+        skip_depth = 1;
+      }
     else if(element_name == name)
       {
         inside = true;
@@ -79,19 +91,31 @@ public:
   bool xml_on_end_element(const std::string &element_name)
   {
     bool result(inside);
-    if(inside)
+    if(skip_depth != 0)
+      {
+        --skip_depth;
+        if(skip_depth == 0)
+          {
+            inside = false;
+            ++num_processed;
+          }
+      }
+    else if(inside)
       {
         if(element_name == name)
           {
             inside = false;
             // Jump through hoops so that we immediately clear the
-            // polynomial_vector_matrix after constructing any needed
-            // dual_constraint_groups.  This significantly reduces the
-            // memory usage, but does complicate the code.
-            if(num_processed % num_procs == rank)
+            // polynomial_vector_matrix after converting and writing
+            // it.  Only one matrix and its Dual_Constraint_Group are
+            // ever in memory, but this does complicate the code.
+            const uint64_t hash(writer.is_incremental()
+                                  ? hash_polynomial_vector_matrix(value)
+                                  : 0);
+            if(!writer.write_unchanged(num_processed, hash))
               {
-                dual_constraint_groups.emplace_back(value);
-                indices.push_back(num_processed);
+                writer.write(num_processed, Dual_Constraint_Group(value),
+                             hash);
               }
             ++num_processed;
             value.clear();
@@ -140,7 +164,7 @@ public:
 
   bool xml_on_characters(const xmlChar *characters, int length)
   {
-    if(inside)
+    if(inside && skip_depth == 0)
       {
         if(inside_rows)
           {
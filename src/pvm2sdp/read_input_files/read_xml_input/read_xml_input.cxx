@@ -4,6 +4,9 @@
 
 #include <boost/filesystem.hpp>
 
+void parse_xml_file(const boost::filesystem::path &input_file,
+                    xmlSAXHandler &xml_handlers, void *user_data);
+
 namespace
 {
   void start_element_callback(void *user_data, const xmlChar *name,
@@ -45,14 +48,11 @@ namespace
 }
 
 void read_xml_input(const boost::filesystem::path &input_file,
-                    El::BigFloat &objective_const,
-                    std::vector<El::BigFloat> &dual_objectives_b,
-                    std::vector<Dual_Constraint_Group> &dual_constraint_groups,
-                    std::vector<size_t> &indices, size_t &num_processed)
+                    std::vector<El::BigFloat> &objective,
+                    const std::vector<int> &block_owners,
+                    SDPB_Input_Writer &writer, size_t &num_processed)
 {
-  LIBXML_TEST_VERSION;
-
-  Input_Parser input_parser(dual_constraint_groups, indices, num_processed);
+  Input_Parser input_parser(block_owners, writer, num_processed);
 
   xmlSAXHandler xml_handlers;
   // This feels unclean.
@@ -63,22 +63,11 @@ void read_xml_input(const boost::filesystem::path &input_file,
   xml_handlers.warning = warning_callback;
   xml_handlers.error = error_callback;
 
-  if(xmlSAXUserParseFile(&xml_handlers, &input_parser, input_file.c_str()) < 0)
-    {
-      throw std::runtime_error("Unable to parse input file: "
-                               + input_file.string());
-    }
+  parse_xml_file(input_file, xml_handlers, &input_parser);
 
-  // Overwrite the objective with whatever is in the last file
-  // that has an objective, but polynomial_vector_matrices get
-  // appended.
-  auto iterator(input_parser.objective_state.value.begin()),
-    end(input_parser.objective_state.value.end());
-  if(iterator != end)
+  // Only overwrite the objective if this file has one.
+  if(!input_parser.objective_state.value.empty())
     {
-      objective_const = *iterator;
-      ++iterator;
-      dual_objectives_b.clear();
-      dual_objectives_b.insert(dual_objectives_b.end(), iterator, end);
+      std::swap(objective, input_parser.objective_state.value);
     }
 }
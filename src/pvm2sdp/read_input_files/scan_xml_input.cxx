@@ -0,0 +1,92 @@
+// A quick first pass over the XML input that only counts the sample
+// points and polynomials of each polynomialVectorMatrix, without
+// converting any numbers, to estimate the cost of converting it.
+
+#include "../../sdp_convert.hxx"
+
+#include <libxml2/libxml/parser.h>
+
+#include <algorithm>
+#include <cstring>
+
+void parse_xml_file(const boost::filesystem::path &input_file,
+                    xmlSAXHandler &xml_handlers, void *user_data);
+
+namespace
+{
+  struct Scanner
+  {
+    std::vector<Block_Cost> &costs;
+    bool inside_elements = false, inside_sample_points = false;
+    size_t num_polynomials = 0, num_sample_points = 0;
+
+    explicit Scanner(std::vector<Block_Cost> &Costs) : costs(Costs) {}
+  };
+
+  void start_element_callback(void *user_data, const xmlChar *xml_name,
+                              const xmlChar **)
+  {
+    Scanner &scanner(*static_cast<Scanner *>(user_data));
+    const char *name(reinterpret_cast<const char *>(xml_name));
+    if(std::strcmp(name, "polynomialVectorMatrix") == 0)
+      {
+        scanner.num_polynomials = 0;
+        scanner.num_sample_points = 0;
+      }
+    else if(std::strcmp(name, "elements") == 0)
+      {
+        scanner.inside_elements = true;
+      }
+    else if(std::strcmp(name, "samplePoints") == 0)
+      {
+        scanner.inside_sample_points = true;
+      }
+    else if(scanner.inside_elements && std::strcmp(name, "polynomial") == 0)
+      {
+        ++scanner.num_polynomials;
+      }
+    else if(scanner.inside_sample_points && std::strcmp(name, "elt") == 0)
+      {
+        ++scanner.num_sample_points;
+      }
+  }
+
+  void end_element_callback(void *user_data, const xmlChar *xml_name)
+  {
+    Scanner &scanner(*static_cast<Scanner *>(user_data));
+    const char *name(reinterpret_cast<const char *>(xml_name));
+    if(std::strcmp(name, "polynomialVectorMatrix") == 0)
+      {
+        scanner.costs.emplace_back(
+          block_conversion_cost(scanner.num_polynomials,
+                                std::max(scanner.num_sample_points,
+                                         size_t(1))
+                                  - 1,
+                                0),
+          scanner.costs.size());
+      }
+    else if(std::strcmp(name, "elements") == 0)
+      {
+        scanner.inside_elements = false;
+      }
+    else if(std::strcmp(name, "samplePoints") == 0)
+      {
+        scanner.inside_sample_points = false;
+      }
+  }
+}
+
+// Append the estimated cost of each polynomialVectorMatrix in
+// input_file to costs.  Errors in the input are reported by
+// read_xml_input().
+void scan_xml_input(const boost::filesystem::path &input_file,
+                    std::vector<Block_Cost> &costs)
+{
+  Scanner scanner(costs);
+  xmlSAXHandler xml_handlers;
+  memset(&xml_handlers, 0, sizeof(xml_handlers));
+  xml_handlers.startElement = start_element_callback;
+  xml_handlers.endElement = end_element_callback;
+
+  parse_xml_file(input_file, xml_handlers, &scanner);
+}
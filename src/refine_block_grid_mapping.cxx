@@ -0,0 +1,196 @@
+// Improve a mapping from compute_block_grid_mapping with a local
+// search.  Only block_maps with a single proc are touched, since
+// those are the only ones with more than one block.  Moving blocks
+// between them never changes the number of procs in a group, so the
+// node-boundary rule still holds.
+//
+// At each step, we look at the single proc block_map with the
+// highest cost.  We either move one of its blocks to another
+// block_map, or swap one of its blocks with a cheaper block from
+// another block_map.  We pick the move or swap that gives the lowest
+// cost for the pair, and only accept it if that is strictly less than
+// the current maximum.  This stops when no move or swap helps.
+//
+// If memory_per_node is not zero, moves and swaps that would put a
+// node over memory_per_node are not allowed.
+
+#include "Block_Cost.hxx"
+#include "Block_Map.hxx"
+
+#include <algorithm>
+#include <cstdint>
+
+void refine_block_grid_mapping(const size_t &memory_per_node,
+                               const size_t &group_memory,
+                               const std::vector<Block_Cost> &block_costs,
+                               std::vector<std::vector<Block_Map>> &mapping)
+{
+  size_t max_index(0);
+  for(auto &block : block_costs)
+    {
+      max_index = std::max(max_index, block.index);
+    }
+  std::vector<const Block_Cost *> costs(max_index + 1, nullptr);
+  for(auto &block : block_costs)
+    {
+      costs[block.index] = &block;
+    }
+
+  struct Candidate
+  {
+    Block_Map *block_map;
+    size_t node;
+  };
+  std::vector<Candidate> candidates;
+  std::vector<size_t> node_memory(mapping.size(), 0);
+  for(size_t node = 0; node < mapping.size(); ++node)
+    for(auto &block_map : mapping[node])
+      {
+        node_memory[node] += block_map.memory;
+        if(block_map.num_procs == 1)
+          {
+            candidates.push_back({&block_map, node});
+          }
+      }
+  if(candidates.size() < 2)
+    {
+      return;
+    }
+
+  // Memory change of a block_map when a block is added.  An empty
+  // block_map does not have any group memory yet.
+  auto memory_added = [&](const Block_Map &block_map, const size_t &added) {
+    return int64_t(added)
+           + (block_map.block_indices.empty() ? int64_t(group_memory) : 0);
+  };
+  auto fits_on = [&](const size_t &node, const int64_t &change) {
+    return change <= 0
+           || int64_t(node_memory[node]) + change <= int64_t(memory_per_node);
+  };
+  auto fits = [&](const size_t &source_node, const int64_t &source_change,
+                  const size_t &dest_node, const int64_t &dest_change) {
+    if(memory_per_node == 0)
+      {
+        return true;
+      }
+    if(source_node == dest_node)
+      {
+        return fits_on(dest_node, source_change + dest_change);
+      }
+    return fits_on(source_node, source_change)
+           && fits_on(dest_node, dest_change);
+  };
+
+  // Every accepted step strictly lowers the cost of the most
+  // expensive block_map it touches, so this terminates.  The limit
+  // only guards against pathological inputs.
+  const size_t max_steps(10 * block_costs.size());
+  for(size_t step = 0; step < max_steps; ++step)
+    {
+      auto max_candidate(std::max_element(
+        candidates.begin(), candidates.end(),
+        [](const Candidate &a, const Candidate &b) {
+          return a.block_map->cost < b.block_map->cost;
+        }));
+      Block_Map &source(*max_candidate->block_map);
+      if(source.block_indices.size() < 2)
+        {
+          break;
+        }
+
+      size_t best_cost(source.cost), best_source_position(0),
+        best_dest_position(0);
+      Candidate *best_dest(nullptr);
+      bool best_is_swap(false);
+      for(size_t source_position = 0;
+          source_position < source.block_indices.size(); ++source_position)
+        {
+          const Block_Cost &block(
+            *costs[source.block_indices[source_position]]);
+          for(auto &dest : candidates)
+            {
+              Block_Map &dest_map(*dest.block_map);
+              if(&dest_map == &source)
+                {
+                  continue;
+                }
+              // Move
+              const size_t move_cost(std::max(source.cost - block.cost,
+                                              dest_map.cost + block.cost));
+              if(move_cost < best_cost
+                 && fits(max_candidate->node, -int64_t(block.memory),
+                         dest.node, memory_added(dest_map, block.memory)))
+                {
+                  best_cost = move_cost;
+                  best_source_position = source_position;
+                  best_dest = &dest;
+                  best_is_swap = false;
+                }
+              // Swap
+              for(size_t dest_position = 0;
+                  dest_position < dest_map.block_indices.size();
+                  ++dest_position)
+                {
+                  const Block_Cost &other(
+                    *costs[dest_map.block_indices[dest_position]]);
+                  if(other.cost >= block.cost)
+                    {
+                      continue;
+                    }
+                  const size_t swap_cost(
+                    std::max(source.cost - block.cost + other.cost,
+                             dest_map.cost - other.cost + block.cost));
+                  if(swap_cost < best_cost
+                     && fits(max_candidate->node,
+                             int64_t(other.memory) - int64_t(block.memory),
+                             dest.node,
+                             int64_t(block.memory) - int64_t(other.memory)))
+                    {
+                      best_cost = swap_cost;
+                      best_source_position = source_position;
+                      best_dest_position = dest_position;
+                      best_dest = &dest;
+                      best_is_swap = true;
+                    }
+                }
+            }
+        }
+      if(best_dest == nullptr)
+        {
+          break;
+        }
+
+      Block_Map &dest_map(*best_dest->block_map);
+      const size_t source_node(max_candidate->node),
+        dest_node(best_dest->node);
+      const Block_Cost &block(
+        *costs[source.block_indices[best_source_position]]);
+      int64_t source_change(-int64_t(block.memory)), dest_change;
+      if(best_is_swap)
+        {
+          const Block_Cost &other(
+            *costs[dest_map.block_indices[best_dest_position]]);
+          source_change += other.memory;
+          dest_change = int64_t(block.memory) - int64_t(other.memory);
+          source.cost += other.cost;
+          dest_map.cost -= other.cost;
+          source.block_indices.push_back(other.index);
+          dest_map.block_indices.erase(dest_map.block_indices.begin()
+                                       + best_dest_position);
+        }
+      else
+        {
+          dest_change = memory_added(dest_map, block.memory);
+        }
+      source.cost -= block.cost;
+      dest_map.cost += block.cost;
+      dest_map.block_indices.push_back(block.index);
+      source.block_indices.erase(source.block_indices.begin()
+                                 + best_source_position);
+
+      source.memory += source_change;
+      dest_map.memory += dest_change;
+      node_memory[source_node] += source_change;
+      node_memory[dest_node] += dest_change;
+    }
+}
@@ -1,20 +1,36 @@
 #pragma once
 
 #include "../set_stream_precision.hxx"
+#include "../set_number.hxx"
 
+#include <El.hpp>
 #include <boost/multiprecision/mpfr.hpp>
 #include <sstream>
 
 using Boost_Float = boost::multiprecision::mpfr_float;
 
-inline std::string to_string(const Boost_Float &boost_float)
+// Convert directly from the MPFR value to the GMP value inside the
+// BigFloat, rounding to nearest at the BigFloat's precision.  This
+// avoids formatting the number as decimal text and parsing it back,
+// which is slow at high precision and may lose a bit or two.
+inline El::BigFloat to_BigFloat(const Boost_Float &boost_float)
 {
-  // Using a stringstream seems to the best way to convert between
-  // MPFR and GMP.  It may lose a bit or two since string
-  // conversion is not sufficient for round-tripping.
-  std::stringstream ss;
-  set_stream_precision(ss);
-  ss << boost_float;
-  return ss.str();
+  El::BigFloat result;
+  mpfr_get_f(result.gmp_float.get_mpf_t(), boost_float.backend().data(),
+             MPFR_RNDN);
+  return result;
 }
 
+// x = number, rounded to nearest at x's precision
+inline void set_number(const Binary_Number &number, Boost_Float &x)
+{
+  mpz_class mantissa;
+  mpz_import(mantissa.get_mpz_t(), number.mantissa_size, 1, 1, 1, 0,
+             number.mantissa);
+  if(number.is_negative)
+    {
+      mpz_neg(mantissa.get_mpz_t(), mantissa.get_mpz_t());
+    }
+  mpfr_set_z_2exp(x.backend().data(), mantissa.get_mpz_t(), number.exponent,
+                  MPFR_RNDN);
+}
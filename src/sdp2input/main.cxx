@@ -1,6 +1,7 @@
 #include "Boost_Float.hxx"
 #include "Positive_Matrix_With_Prefactor.hxx"
 #include "../Timers.hxx"
+#include "../sdpb/limb_pool.hxx"
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
@@ -10,23 +11,33 @@ namespace po = boost::program_options;
 void read_input(const boost::filesystem::path &input_file,
                 std::vector<El::BigFloat> &objectives,
                 std::vector<El::BigFloat> &normalization,
-                std::vector<Positive_Matrix_With_Prefactor> &matrices);
+                std::vector<Positive_Matrix_With_Prefactor> &matrices,
+                std::vector<size_t> &indices, const size_t &num_threads);
 
 void write_output(const boost::filesystem::path &output_dir,
                   const std::vector<El::BigFloat> &objectives,
                   const std::vector<El::BigFloat> &normalization,
                   const std::vector<Positive_Matrix_With_Prefactor> &matrices,
-                  Timers &timers);
+                  const std::vector<size_t> &indices, const bool &binary,
+                  const bool &compress, const bool &incremental,
+                  const size_t &low_precision,
+                  const size_t &low_precision_max_degree,
+                  const size_t &num_threads, Timers &timers);
 
 int main(int argc, char **argv)
 {
+  // The coefficients of the polynomials are many small, long lived
+  // GMP allocations.  This has to come before anything, including
+  // MPI and Elemental, allocates GMP limbs.
+  install_limb_pool();
   El::Environment env(argc, argv);
 
   try
     {
       int precision;
       boost::filesystem::path input_file, output_dir;
-      bool debug(false);
+      bool debug(false), binary(false), compress(false), incremental(false);
+      size_t low_precision, low_precision_max_degree, num_threads;
 
       po::options_description options("Basic options");
       options.add_options()("help,h", "Show this helpful message.");
@@ -44,6 +55,34 @@ int main(int argc, char **argv)
       options.add_options()("debug",
                             po::value<bool>(&debug)->default_value(false),
                             "Write out debugging output.");
+      options.add_options()(
+        "binary", po::bool_switch(&binary),
+        "Write the free variable matrix and primal objective in a binary "
+        "format that sdpb reads much faster than text.");
+      options.add_options()(
+        "compress", po::bool_switch(&compress),
+        "Compress the free variable matrix, the primal objective and the "
+        "objectives.  sdpb decompresses them while reading.  Not "
+        "available with --binary.");
+      options.add_options()(
+        "incremental", po::bool_switch(&incremental),
+        "Keep the existing output of blocks whose input has not changed "
+        "since the last run in the output directory, and only convert the "
+        "blocks that did.");
+      options.add_options()(
+        "lowPrecision",
+        po::value<size_t>(&low_precision)->default_value(0),
+        "Precision in bits that sdpb uses for the block-local kernels of "
+        "the blocks with degree at most lowPrecisionMaxDegree.  0 means "
+        "sdpb's precision for every block.");
+      options.add_options()(
+        "lowPrecisionMaxDegree",
+        po::value<size_t>(&low_precision_max_degree)->default_value(0),
+        "The largest degree of a block that uses lowPrecision.");
+      options.add_options()(
+        "threads", po::value<size_t>(&num_threads)->default_value(1),
+        "Number of threads each process uses to parse its matrices from "
+        "Mathematica input, and to compute the bilinear bases.");
 
       po::positional_options_description positional;
       positional.add("precision", 1);
@@ -60,6 +99,10 @@ int main(int argc, char **argv)
         }
 
       po::notify(variables_map);
+      if(num_threads == 0)
+        {
+          throw std::runtime_error("threads must be at least 1");
+        }
 
       if(!boost::filesystem::exists(input_file))
         {
@@ -86,12 +129,16 @@ int main(int argc, char **argv)
 
       std::vector<El::BigFloat> objectives, normalization;
       std::vector<Positive_Matrix_With_Prefactor> matrices;
+      std::vector<size_t> indices;
       Timers timers(debug);
       auto &read_input_timer(timers.add_and_start("read_input"));
-      read_input(input_file, objectives, normalization, matrices);
+      read_input(input_file, objectives, normalization, matrices, indices,
+                 num_threads);
       read_input_timer.stop();
       auto &write_output_timer(timers.add_and_start("write_output"));
-      write_output(output_dir, objectives, normalization, matrices, timers);
+      write_output(output_dir, objectives, normalization, matrices, indices,
+                   binary, compress, incremental, low_precision,
+                   low_precision_max_degree, num_threads, timers);
       write_output_timer.stop();
       if(debug)
         {
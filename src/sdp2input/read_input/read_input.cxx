@@ -3,37 +3,126 @@
 
 #include <boost/filesystem.hpp>
 
+void scan_json(const boost::filesystem::path &input_path,
+               std::vector<Block_Cost> &costs);
+
+void scan_cbor(const boost::filesystem::path &input_path,
+               std::vector<Block_Cost> &costs);
+
+void scan_mathematica(const boost::filesystem::path &input_path,
+                      std::vector<Block_Cost> &costs);
+
 void read_json(const boost::filesystem::path &input_path,
+               const std::vector<int> &block_owners,
+               std::vector<El::BigFloat> &objectives,
+               std::vector<El::BigFloat> &normalization,
+               std::vector<Positive_Matrix_With_Prefactor> &matrices);
+
+void read_cbor(const boost::filesystem::path &input_path,
+               const std::vector<int> &block_owners,
                std::vector<El::BigFloat> &objectives,
                std::vector<El::BigFloat> &normalization,
                std::vector<Positive_Matrix_With_Prefactor> &matrices);
 
 void read_mathematica(const boost::filesystem::path &input_path,
+                      const std::vector<int> &block_owners,
                       std::vector<El::BigFloat> &objectives,
                       std::vector<El::BigFloat> &normalization,
-                      std::vector<Positive_Matrix_With_Prefactor> &matrices);
+                      std::vector<Positive_Matrix_With_Prefactor> &matrices,
+                      const size_t &num_threads);
 
+namespace
+{
+  void scan_input(const boost::filesystem::path &input_file,
+                  std::vector<Block_Cost> &costs)
+  {
+    if(input_file.extension() == ".json")
+      {
+        scan_json(input_file, costs);
+      }
+    else if(input_file.extension() == ".cbor")
+      {
+        scan_cbor(input_file, costs);
+      }
+    else
+      {
+        scan_mathematica(input_file, costs);
+      }
+  }
+}
+
+// The matrices are assigned to ranks by their estimated conversion
+// cost, from a quick first pass over the input (see Input_File_Plan).
+// Each rank then only parses its own matrices, which are listed in
+// indices, and leaves the others empty.
 void read_input(const boost::filesystem::path &input_file,
                 std::vector<El::BigFloat> &objectives,
                 std::vector<El::BigFloat> &normalization,
-                std::vector<Positive_Matrix_With_Prefactor> &matrices)
+                std::vector<Positive_Matrix_With_Prefactor> &matrices,
+                std::vector<size_t> &indices, const size_t &num_threads)
 {
-  if(input_file.extension() == ".nsv")
+  const std::vector<boost::filesystem::path> files(
+    flatten_input_files({input_file}));
+  const Input_File_Plan plan(files, scan_input);
+  const std::vector<int> &block_owners(plan.block_owners);
+
+  // The objectives and normalization come from the last file that has
+  // them.
+  int64_t objectives_file(-1), normalization_file(-1);
+  for(size_t file = 0; file < files.size(); ++file)
     {
-      for(auto &filename : read_file_list(input_file))
+      if(!plan.is_read(file))
         {
-          if(!filename.empty())
-            {
-              read_input(filename, objectives, normalization, matrices);
-            }
+          matrices.resize(plan.file_offsets[file + 1]);
+          continue;
+        }
+      std::vector<El::BigFloat> file_objectives, file_normalization;
+      if(files[file].extension() == ".json")
+        {
+          read_json(files[file], block_owners, file_objectives,
+                    file_normalization, matrices);
+        }
+      else if(files[file].extension() == ".cbor")
+        {
+          read_cbor(files[file], block_owners, file_objectives,
+                    file_normalization, matrices);
+        }
+      else
+        {
+          read_mathematica(files[file], block_owners, file_objectives,
+                           file_normalization, matrices, num_threads);
+        }
+      if(matrices.size() != plan.file_offsets[file + 1])
+        {
+          throw std::runtime_error(
+            "Found "
+            + std::to_string(plan.file_offsets[file + 1]
+                             - plan.file_offsets[file])
+            + " PositiveMatrixWithPrefactor in " + files[file].string()
+            + " when scanning, but "
+            + std::to_string(matrices.size() - plan.file_offsets[file])
+            + " when reading it.");
+        }
+      if(!file_objectives.empty())
+        {
+          std::swap(objectives, file_objectives);
+          objectives_file = file;
+        }
+      if(!file_normalization.empty())
+        {
+          std::swap(normalization, file_normalization);
+          normalization_file = file;
         }
     }
-  else if(input_file.extension() == ".json")
-    {
-      read_json(input_file, objectives, normalization, matrices);
-    }
-  else
+  plan.share_last(objectives_file, objectives);
+  plan.share_last(normalization_file, normalization);
+
+  const int rank(El::mpi::Rank(El::mpi::COMM_WORLD));
+  for(size_t index = 0; index < block_owners.size(); ++index)
     {
-      read_mathematica(input_file, objectives, normalization, matrices);
+      if(block_owners[index] == rank)
+        {
+          indices.push_back(index);
+        }
     }
 }
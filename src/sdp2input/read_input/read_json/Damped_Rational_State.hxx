@@ -29,6 +29,7 @@ struct Damped_Rational_State
 
   void json_key(const std::string &key);
   void json_string(const std::string &s);
+  void json_binary_number(const Binary_Number &number);
   void json_start_array();
   void json_end_array();
   void json_start_object();
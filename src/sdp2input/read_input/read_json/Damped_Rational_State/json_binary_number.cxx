@@ -0,0 +1,27 @@
+#include "../Damped_Rational_State.hxx"
+
+void Damped_Rational_State::json_binary_number(const Binary_Number &number)
+{
+  if(parsing_constant)
+    {
+      constant_state.json_binary_number(number);
+      parsing_constant = false;
+      value.constant = constant_state.value;
+    }
+  else if(parsing_base)
+    {
+      base_state.json_binary_number(number);
+      parsing_base = false;
+      value.base = base_state.value;
+    }
+  else if(parsing_poles)
+    {
+      poles_state.json_binary_number(number);
+    }
+  else
+    {
+      throw std::runtime_error("Invalid input file.  Unexpected number "
+                               "inside '"
+                               + name + "'");
+    }
+}
@@ -17,14 +17,37 @@ struct JSON_Parser
   Vector_State<Positive_Matrix_With_Prefactor_State>
     positive_matrices_with_prefactor_state;
 
-  JSON_Parser()
+  // Only the matrices with block_owners[matrix_offset + index] == rank
+  // are written by this rank, so the others are skipped without
+  // converting any numbers, and left empty in
+  // positive_matrices_with_prefactor_state.value.  skip_depth is the
+  // nesting depth inside the matrix being skipped, or 0.
+  size_t matrix_offset;
+  const std::vector<int> &block_owners;
+  int rank = El::mpi::Rank();
+  size_t skip_depth = 0;
+
+  JSON_Parser(const size_t &Matrix_offset,
+              const std::vector<int> &Block_owners)
       : objective_state({"objective"s, ""s}),
         normalization_state({"normalization"s, ""s}),
         positive_matrices_with_prefactor_state(
           {"PositiveMatrixWithPrefactorArray"s, ""s, "DampedRational"s,
-           "polynomials"s, ""s, ""s, ""s, ""s})
+           "polynomials"s, ""s, ""s, ""s, ""s}),
+        matrix_offset(Matrix_offset), block_owners(Block_owners)
   {}
 
+  // Whether an object that starts now is a matrix for another rank
+  bool is_skipped_matrix() const
+  {
+    return positive_matrices_with_prefactor_state.inside
+           && !positive_matrices_with_prefactor_state.element_state.inside
+           && block_owners.at(
+                matrix_offset
+                + positive_matrices_with_prefactor_state.value.size())
+                != rank;
+  }
+
   bool Null() { throw std::runtime_error("Null not allowed"); }
   bool Bool(bool) { throw std::runtime_error("Bool not allowed"); }
   bool Int(int)
@@ -58,6 +81,8 @@ struct JSON_Parser
       "Numbers not allowed.  You must quote all numbers as strings.");
   }
   bool String(const Ch *str, rapidjson::SizeType length, bool copy);
+  // Numbers from CBOR input, which do not have to be strings
+  bool Binary(const Binary_Number &number);
   bool StartObject();
   bool Key(const Ch *str, rapidjson::SizeType length, bool copy);
   bool EndObject(rapidjson::SizeType memberCount);
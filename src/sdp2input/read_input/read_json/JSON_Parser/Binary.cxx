@@ -0,0 +1,34 @@
+#include "../JSON_Parser.hxx"
+
+bool JSON_Parser::Binary(const Binary_Number &number)
+{
+  if(skip_depth != 0)
+    {
+      return true;
+    }
+  if(inside)
+    {
+      if(parsing_objective)
+        {
+          objective_state.json_binary_number(number);
+        }
+      else if(parsing_normalization)
+        {
+          normalization_state.json_binary_number(number);
+        }
+      else if(parsing_positive_matrices_with_prefactor)
+        {
+          positive_matrices_with_prefactor_state.json_binary_number(number);
+        }
+      else
+        {
+          throw std::runtime_error(
+            "Invalid input file.  Unexpected number in the main object");
+        }
+    }
+  else
+    {
+      throw std::runtime_error("Found a number outside of the SDP");
+    }
+  return true;
+}
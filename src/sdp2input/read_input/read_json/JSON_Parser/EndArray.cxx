@@ -2,7 +2,11 @@
 
 bool JSON_Parser::EndArray(rapidjson::SizeType)
 {
-  if(inside)
+  if(skip_depth != 0)
+    {
+      --skip_depth;
+    }
+  else if(inside)
     {
       if(parsing_objective)
         {
@@ -2,7 +2,15 @@
 
 bool JSON_Parser::EndObject(rapidjson::SizeType)
 {
-  if(inside)
+  if(skip_depth != 0)
+    {
+      --skip_depth;
+      if(skip_depth == 0)
+        {
+          positive_matrices_with_prefactor_state.value.emplace_back();
+        }
+    }
+  else if(inside)
     {
       if(parsing_objective)
         {
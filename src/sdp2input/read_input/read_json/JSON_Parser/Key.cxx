@@ -2,6 +2,10 @@
 
 bool JSON_Parser::Key(const Ch *str, rapidjson::SizeType length, bool)
 {
+  if(skip_depth != 0)
+    {
+      return true;
+    }
   std::string key(str, length);
   if(inside)
     {
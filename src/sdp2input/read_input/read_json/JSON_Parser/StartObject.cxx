@@ -2,7 +2,11 @@
 
 bool JSON_Parser::StartObject()
 {
-  if(inside)
+  if(skip_depth != 0)
+    {
+      ++skip_depth;
+    }
+  else if(inside)
     {
       if(parsing_objective)
         {
@@ -18,7 +22,14 @@ bool JSON_Parser::StartObject()
         }
       else if(parsing_positive_matrices_with_prefactor)
         {
-          positive_matrices_with_prefactor_state.json_start_object();
+          if(is_skipped_matrix())
+            {
+              skip_depth = 1;
+            }
+          else
+            {
+              positive_matrices_with_prefactor_state.json_start_object();
+            }
         }
       else
         {
@@ -31,6 +31,7 @@ struct Positive_Matrix_With_Prefactor_State
 
   void json_key(const std::string &key);
   void json_string(const std::string &s);
+  void json_binary_number(const Binary_Number &number);
   void json_start_array();
   void json_end_array();
   void json_start_object();
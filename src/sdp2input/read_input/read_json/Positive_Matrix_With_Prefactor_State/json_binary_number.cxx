@@ -0,0 +1,20 @@
+#include "../Positive_Matrix_With_Prefactor_State.hxx"
+
+void Positive_Matrix_With_Prefactor_State::json_binary_number(
+  const Binary_Number &number)
+{
+  if(parsing_damped_rational)
+    {
+      damped_rational_state.json_binary_number(number);
+    }
+  else if(parsing_polynomials)
+    {
+      polynomials_state.json_binary_number(number);
+    }
+  else
+    {
+      throw std::runtime_error("Invalid input file.  Unexpected "
+                               "number inside '"
+                               + name + "'");
+    }
+}
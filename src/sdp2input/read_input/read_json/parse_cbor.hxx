@@ -0,0 +1,366 @@
+#pragma once
+
+// A streaming reader for CBOR (RFC 8949) input with the same layout
+// as the JSON input.  It calls the same handler functions as
+// rapidjson::Reader, so JSON_Parser and the scanner work unchanged,
+// with one addition: numbers are passed to handler.Binary() as exact
+// binary numbers, without any decimal conversion.
+//
+// Supported items are
+//
+//   maps with text string keys, and arrays, of definite or indefinite
+//     length,
+//   text strings of definite length,
+//   integers, and bignums (tags 2 and 3),
+//   bigfloats (tag 5), [exponent, mantissa] for mantissa * 2^exponent,
+//     which hold numbers of any precision exactly,
+//   decimal fractions (tag 4), [exponent, mantissa] for
+//     mantissa * 10^exponent, which are passed on as decimal strings,
+//   single and double precision floats,
+//   false, true and null, which the handlers reject like in JSON.
+//
+// Everything else is an error.
+
+#include "../../../set_number.hxx"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+template <typename Handler> class CBOR_Reader
+{
+public:
+  CBOR_Reader(const char *Begin, const char *End,
+              const std::string &Filename, Handler &Handler_)
+      : begin(reinterpret_cast<const unsigned char *>(Begin)),
+        current(begin), end(reinterpret_cast<const unsigned char *>(End)),
+        filename(Filename), handler(Handler_)
+  {}
+
+  void parse()
+  {
+    parse_item(false);
+    if(current != end)
+      {
+        error("Unexpected data after the end of the SDP");
+      }
+  }
+
+private:
+  const unsigned char *begin, *current, *end;
+  const std::string &filename;
+  Handler &handler;
+  // Big endian magnitudes of integers that are not in the input as is
+  std::vector<unsigned char> scratch;
+
+  static const uint64_t indefinite = std::numeric_limits<uint64_t>::max();
+
+  struct Head
+  {
+    int major;
+    int additional;
+    // The count or value, or indefinite
+    uint64_t argument;
+  };
+
+  [[noreturn]] void error(const std::string &message) const
+  {
+    throw std::runtime_error(message + " at byte "
+                             + std::to_string(current - begin) + " of "
+                             + filename);
+  }
+
+  void check(const bool &is_ok)
+  {
+    if(!is_ok)
+      {
+        error("Parsing stopped");
+      }
+  }
+
+  void need(const size_t &size) const
+  {
+    if(size_t(end - current) < size)
+      {
+        error("Unexpected end of file");
+      }
+  }
+
+  Head read_head()
+  {
+    need(1);
+    Head head;
+    head.major = *current >> 5;
+    head.additional = *current & 0x1f;
+    ++current;
+    if(head.additional < 24)
+      {
+        head.argument = head.additional;
+      }
+    else if(head.additional <= 27)
+      {
+        const size_t size(size_t(1) << (head.additional - 24));
+        need(size);
+        head.argument = 0;
+        for(size_t byte = 0; byte < size; ++byte)
+          {
+            head.argument = (head.argument << 8) | *current;
+            ++current;
+          }
+      }
+    else if(head.additional == 31 && head.major >= 2 && head.major <= 5)
+      {
+        head.argument = indefinite;
+      }
+    else
+      {
+        error("Invalid CBOR item");
+      }
+    return head;
+  }
+
+  bool is_break() const { return current != end && *current == 0xff; }
+
+  // Whether there is another element in an array or map with count
+  // elements, of which index have been read.
+  bool has_next(const uint64_t &count, const uint64_t &index)
+  {
+    if(count != indefinite)
+      {
+        return index < count;
+      }
+    if(is_break())
+      {
+        ++current;
+        return false;
+      }
+    return true;
+  }
+
+  // The magnitude of an integer in scratch, as big endian bytes
+  void set_scratch(const uint64_t &value)
+  {
+    scratch.resize(8);
+    for(size_t byte = 0; byte < 8; ++byte)
+      {
+        scratch[byte] = (value >> (8 * (7 - byte))) & 0xff;
+      }
+  }
+
+  // magnitude += 1
+  static void increment(std::vector<unsigned char> &magnitude)
+  {
+    for(auto byte(magnitude.rbegin()); byte != magnitude.rend(); ++byte)
+      {
+        if(++*byte != 0)
+          {
+            return;
+          }
+      }
+    magnitude.insert(magnitude.begin(), 1);
+  }
+
+  // An integer or bignum that starts with head, with the magnitude in
+  // scratch
+  void read_integer(const Head &head, bool &is_negative)
+  {
+    if(head.major == 0 || head.major == 1)
+      {
+        // -1 - n for negative integers
+        is_negative = (head.major == 1);
+        set_scratch(head.argument);
+      }
+    else if(head.major == 6 && (head.argument == 2 || head.argument == 3))
+      {
+        is_negative = (head.argument == 3);
+        const Head bytes(read_head());
+        if(bytes.major != 2 || bytes.argument == indefinite)
+          {
+            error("Expected a byte string of definite length in a bignum");
+          }
+        need(bytes.argument);
+        scratch.assign(current, current + bytes.argument);
+        current += bytes.argument;
+      }
+    else
+      {
+        error("Expected an integer");
+      }
+    if(is_negative)
+      {
+        increment(scratch);
+      }
+  }
+
+  int64_t read_exponent()
+  {
+    const Head head(read_head());
+    if((head.major != 0 && head.major != 1)
+       || head.argument > uint64_t(std::numeric_limits<int64_t>::max()))
+      {
+        error("Expected an integer exponent");
+      }
+    return head.major == 0 ? int64_t(head.argument)
+                           : -1 - int64_t(head.argument);
+  }
+
+  void read_binary(const int64_t &exponent, const bool &is_negative)
+  {
+    Binary_Number number;
+    number.is_negative = is_negative;
+    number.exponent = exponent;
+    number.mantissa = scratch.data();
+    number.mantissa_size = scratch.size();
+    check(handler.Binary(number));
+  }
+
+  void parse_tag(const Head &head)
+  {
+    const uint64_t &tag(head.argument);
+    bool is_negative;
+    if(tag == 2 || tag == 3)
+      {
+        read_integer(head, is_negative);
+        read_binary(0, is_negative);
+        return;
+      }
+    if(tag != 4 && tag != 5)
+      {
+        error("Unsupported CBOR tag " + std::to_string(tag));
+      }
+    const Head array(read_head());
+    if(array.major != 4 || array.argument != 2)
+      {
+        error("Expected an array of length 2 for a bigfloat or decimal "
+              "fraction");
+      }
+    const int64_t exponent(read_exponent());
+    read_integer(read_head(), is_negative);
+    if(tag == 5)
+      {
+        read_binary(exponent, is_negative);
+        return;
+      }
+    mpz_class mantissa;
+    mpz_import(mantissa.get_mpz_t(), scratch.size(), 1, 1, 1, 0,
+               scratch.data());
+    const std::string decimal((is_negative ? "-" : "")
+                              + mantissa.get_str() + "e"
+                              + std::to_string(exponent));
+    check(handler.String(decimal.c_str(), decimal.size(), true));
+  }
+
+  void parse_float(const double &value)
+  {
+    if(!std::isfinite(value))
+      {
+        error("Infinite and NaN floats are not allowed");
+      }
+    int exponent;
+    const double fraction(std::frexp(std::abs(value), &exponent));
+    // A double has 53 bits of mantissa
+    set_scratch(uint64_t(std::ldexp(fraction, 53)));
+    read_binary(exponent - 53, value < 0);
+  }
+
+  void parse_simple(const Head &head)
+  {
+    if(head.additional == 20 || head.additional == 21)
+      {
+        check(handler.Bool(head.additional == 21));
+      }
+    else if(head.additional == 22)
+      {
+        check(handler.Null());
+      }
+    else if(head.additional == 26)
+      {
+        const uint32_t bits(head.argument);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        parse_float(value);
+      }
+    else if(head.additional == 27)
+      {
+        double value;
+        std::memcpy(&value, &head.argument, sizeof(value));
+        parse_float(value);
+      }
+    else
+      {
+        error("Unsupported CBOR simple value or float");
+      }
+  }
+
+  void parse_item(const bool &is_key)
+  {
+    const Head head(read_head());
+    if(is_key && head.major != 3)
+      {
+        error("Map keys must be text strings");
+      }
+    if(head.major == 0 || head.major == 1)
+      {
+        bool is_negative;
+        read_integer(head, is_negative);
+        read_binary(0, is_negative);
+      }
+    else if(head.major == 2)
+      {
+        error("Unexpected byte string");
+      }
+    else if(head.major == 3)
+      {
+        if(head.argument == indefinite)
+          {
+            error("Text strings of indefinite length are not supported");
+          }
+        need(head.argument);
+        const char *text(reinterpret_cast<const char *>(current));
+        current += head.argument;
+        check(is_key ? handler.Key(text, head.argument, true)
+                     : handler.String(text, head.argument, true));
+      }
+    else if(head.major == 4)
+      {
+        check(handler.StartArray());
+        uint64_t index(0);
+        for(; has_next(head.argument, index); ++index)
+          {
+            parse_item(false);
+          }
+        check(handler.EndArray(index));
+      }
+    else if(head.major == 5)
+      {
+        check(handler.StartObject());
+        uint64_t index(0);
+        for(; has_next(head.argument, index); ++index)
+          {
+            parse_item(true);
+            parse_item(false);
+          }
+        check(handler.EndObject(index));
+      }
+    else if(head.major == 6)
+      {
+        parse_tag(head);
+      }
+    else
+      {
+        parse_simple(head);
+      }
+  }
+};
+
+// Parse the CBOR item in [begin, end) with handler.
+template <typename Handler>
+void parse_cbor(const char *begin, const char *end,
+                const std::string &filename, Handler &handler)
+{
+  CBOR_Reader<Handler>(begin, end, filename, handler).parse();
+}
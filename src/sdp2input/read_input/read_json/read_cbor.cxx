@@ -0,0 +1,49 @@
+#include "JSON_Parser.hxx"
+#include "parse_cbor.hxx"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+// The CBOR input has the same layout as the JSON input, so it goes
+// through the same JSON_Parser.  Its numbers are binary, and go into
+// the BigFloats and Boost_Floats without a decimal conversion.
+void read_cbor(const boost::filesystem::path &input_path,
+               const std::vector<int> &block_owners,
+               std::vector<El::BigFloat> &objectives,
+               std::vector<El::BigFloat> &normalization,
+               std::vector<Positive_Matrix_With_Prefactor> &matrices)
+{
+  boost::filesystem::ifstream input_stream(input_path);
+  if(!input_stream.good())
+    {
+      throw std::runtime_error("Unable to open input: " + input_path.string());
+    }
+
+  boost::interprocess::file_mapping mapped_file(
+    input_path.c_str(), boost::interprocess::read_only);
+  boost::interprocess::mapped_region mapped_region(
+    mapped_file, boost::interprocess::read_only);
+
+  const char *begin(static_cast<const char *>(mapped_region.get_address())),
+    *end(begin + mapped_region.get_size());
+  JSON_Parser parser(matrices.size(), block_owners);
+  parse_cbor(begin, end, input_path.string(), parser);
+
+  if(!parser.objective_state.value.empty())
+    {
+      std::swap(objectives, parser.objective_state.value);
+    }
+  if(!parser.normalization_state.value.empty())
+    {
+      std::swap(normalization, parser.normalization_state.value);
+    }
+  size_t offset(matrices.size());
+  auto &temp_matrices(
+    parser.positive_matrices_with_prefactor_state.value);
+  matrices.resize(matrices.size() + temp_matrices.size());
+  for(size_t index = 0; index < temp_matrices.size(); ++index)
+    {
+      std::swap(matrices[offset + index], temp_matrices[index]);
+    }
+}
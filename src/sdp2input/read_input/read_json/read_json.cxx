@@ -6,13 +6,14 @@
 #include <boost/filesystem/fstream.hpp>
 
 void read_json(const boost::filesystem::path &input_path,
+               const std::vector<int> &block_owners,
                std::vector<El::BigFloat> &objectives,
                std::vector<El::BigFloat> &normalization,
                std::vector<Positive_Matrix_With_Prefactor> &matrices)
 {
   boost::filesystem::ifstream input_file(input_path);
   rapidjson::IStreamWrapper wrapper(input_file);
-  JSON_Parser parser;
+  JSON_Parser parser(matrices.size(), block_owners);
   rapidjson::Reader reader;
   reader.Parse(wrapper, parser);
 
@@ -0,0 +1,146 @@
+#include "parse_cbor.hxx"
+#include "../../../sdp_convert.hxx"
+
+#include <rapidjson/reader.h>
+#include <rapidjson/istreamwrapper.h>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <algorithm>
+
+// A quick first pass over the JSON or CBOR input that only counts the poles,
+// polynomials and coefficients of each PositiveMatrixWithPrefactor,
+// without converting any numbers, to estimate the cost of converting
+// it.  Errors in the input are reported by JSON_Parser.
+
+namespace
+{
+  struct JSON_Scanner
+      : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, JSON_Scanner>
+  {
+    std::vector<Block_Cost> &costs;
+    // The nesting depth, and the depths of the arrays of matrices,
+    // poles and polynomials.  0 means not found yet.
+    size_t depth = 0, matrices_depth = 0, poles_depth = 0,
+           polynomials_depth = 0;
+    std::string key;
+    size_t num_poles = 0, num_polynomials = 0, num_coefficients = 0,
+           degree = 0;
+
+    explicit JSON_Scanner(std::vector<Block_Cost> &Costs) : costs(Costs) {}
+
+    bool Key(const Ch *str, rapidjson::SizeType length, bool)
+    {
+      key.assign(str, length);
+      return true;
+    }
+    bool String(const Ch *, rapidjson::SizeType, bool)
+    {
+      if(poles_depth != 0 && depth == poles_depth)
+        {
+          ++num_poles;
+        }
+      else if(polynomials_depth != 0 && depth == polynomials_depth + 3)
+        {
+          ++num_coefficients;
+        }
+      key.clear();
+      return true;
+    }
+    // The numbers in CBOR input
+    bool Binary(const Binary_Number &) { return String(nullptr, 0, false); }
+    bool StartObject()
+    {
+      ++depth;
+      if(matrices_depth != 0 && depth == matrices_depth + 1)
+        {
+          num_poles = 0;
+          num_polynomials = 0;
+          degree = 0;
+        }
+      key.clear();
+      return true;
+    }
+    bool EndObject(rapidjson::SizeType)
+    {
+      if(matrices_depth != 0 && depth == matrices_depth + 1)
+        {
+          costs.emplace_back(
+            block_conversion_cost(num_polynomials, degree, num_poles),
+            costs.size());
+        }
+      --depth;
+      return true;
+    }
+    bool StartArray()
+    {
+      ++depth;
+      if(key == "PositiveMatrixWithPrefactorArray" && depth == 2)
+        {
+          matrices_depth = depth;
+        }
+      else if(key == "poles")
+        {
+          poles_depth = depth;
+        }
+      else if(key == "polynomials")
+        {
+          polynomials_depth = depth;
+        }
+      else if(polynomials_depth != 0 && depth == polynomials_depth + 3)
+        {
+          ++num_polynomials;
+          num_coefficients = 0;
+        }
+      key.clear();
+      return true;
+    }
+    bool EndArray(rapidjson::SizeType)
+    {
+      if(depth == matrices_depth)
+        {
+          matrices_depth = 0;
+        }
+      else if(depth == poles_depth)
+        {
+          poles_depth = 0;
+        }
+      else if(depth == polynomials_depth)
+        {
+          polynomials_depth = 0;
+        }
+      else if(polynomials_depth != 0 && depth == polynomials_depth + 3)
+        {
+          degree = std::max(degree, std::max(num_coefficients, size_t(1)) - 1);
+        }
+      --depth;
+      return true;
+    }
+  };
+}
+
+// Append the estimated cost of each PositiveMatrixWithPrefactor in
+// input_path to costs.
+void scan_json(const boost::filesystem::path &input_path,
+               std::vector<Block_Cost> &costs)
+{
+  boost::filesystem::ifstream input_file(input_path);
+  rapidjson::IStreamWrapper wrapper(input_file);
+  JSON_Scanner scanner(costs);
+  rapidjson::Reader reader;
+  reader.Parse(wrapper, scanner);
+}
+
+void scan_cbor(const boost::filesystem::path &input_path,
+               std::vector<Block_Cost> &costs)
+{
+  boost::interprocess::file_mapping mapped_file(
+    input_path.c_str(), boost::interprocess::read_only);
+  boost::interprocess::mapped_region mapped_region(
+    mapped_file, boost::interprocess::read_only);
+  const char *begin(static_cast<const char *>(mapped_region.get_address())),
+    *end(begin + mapped_region.get_size());
+  JSON_Scanner scanner(costs);
+  parse_cbor(begin, end, input_path.string(), scanner);
+}
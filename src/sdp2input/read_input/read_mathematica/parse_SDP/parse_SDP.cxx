@@ -7,14 +7,17 @@
 #include <string>
 
 const char *
-parse_matrices(const char *begin, const char *end, const int &rank,
-               const int &num_procs, const size_t &num_matrices,
+parse_matrices(const char *begin, const char *end,
+               const std::vector<int> &block_owners,
+               const size_t &num_matrices, const size_t &num_threads,
                std::vector<Positive_Matrix_With_Prefactor> &matrices);
 
 const char *parse_SDP(const char *begin, const char *end,
+                      const std::vector<int> &block_owners,
                       std::vector<El::BigFloat> &objectives,
                       std::vector<El::BigFloat> &normalization,
-                      std::vector<Positive_Matrix_With_Prefactor> &matrices)
+                      std::vector<Positive_Matrix_With_Prefactor> &matrices,
+                      const size_t &num_threads)
 {
   const std::string SDP_literal("SDP[");
   auto SDP_start(
@@ -62,9 +65,9 @@ const char *parse_SDP(const char *begin, const char *end,
     }
 
   std::vector<Positive_Matrix_With_Prefactor> temp_matrices;
-  const int rank(El::mpi::Rank()), num_procs(El::mpi::Size());
-  const char *end_matrices(parse_matrices(
-    std::next(comma), end, rank, num_procs, matrices.size(), temp_matrices));
+  const char *end_matrices(parse_matrices(std::next(comma), end,
+                                          block_owners, matrices.size(),
+                                          num_threads, temp_matrices));
   {
     size_t offset(matrices.size());
     matrices.resize(matrices.size() + temp_matrices.size());
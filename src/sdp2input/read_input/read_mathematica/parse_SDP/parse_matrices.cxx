@@ -1,14 +1,23 @@
 #include "parse_vector.hxx"
 #include "parse_generic.hxx"
+#include "../../../Boost_Float.hxx"
 #include "../../../Positive_Matrix_With_Prefactor.hxx"
+#include "../../../../parallel_for.hxx"
 
 #include <algorithm>
 #include <iterator>
 #include <string>
 
+const char *scan_matrix(const char *begin, const char *end, size_t &cost);
+
+// The matrices are parsed in two passes.  The first only finds where
+// each matrix begins and ends.  The second parses the matrices that
+// block_owners assigns to this rank, with num_threads threads.  The
+// other matrices are left empty.
 const char *
-parse_matrices(const char *begin, const char *end, const int &rank,
-               const int &num_procs, const size_t &num_matrices,
+parse_matrices(const char *begin, const char *end,
+               const std::vector<int> &block_owners,
+               const size_t &num_matrices, const size_t &num_threads,
                std::vector<Positive_Matrix_With_Prefactor> &matrices)
 {
   const auto open_brace(std::find(begin, end, '{'));
@@ -19,16 +28,23 @@ parse_matrices(const char *begin, const char *end, const int &rank,
 
   auto delimiter(open_brace);
   const std::vector<char> delimiters({',', '}'});
-  int matrix_index(num_matrices);
+  const int rank(El::mpi::Rank());
+  size_t matrix_index(num_matrices);
+  struct Extent
+  {
+    size_t index;
+    const char *begin, *end;
+  };
+  std::vector<Extent> extents;
   do
     {
       auto start_matrix(std::next(delimiter));
-      Positive_Matrix_With_Prefactor matrix;
-      auto end_matrix(parse_generic(start_matrix, end, matrix));
-      matrices.emplace_back();
-      if(matrix_index % num_procs == rank)
+      size_t cost;
+      auto end_matrix(scan_matrix(start_matrix, end, cost));
+      if(block_owners.at(matrix_index) == rank)
         {
-          swap(matrices.back(), matrix);
+          extents.push_back(
+            {matrix_index - num_matrices, start_matrix, end_matrix});
         }
       ++matrix_index;
 
@@ -41,5 +57,14 @@ parse_matrices(const char *begin, const char *end, const int &rank,
         }
     }
   while(*delimiter != '}');
+
+  matrices.resize(matrix_index - num_matrices);
+  // The default precision of Boost_Float is per thread.
+  const unsigned boost_precision(Boost_Float::default_precision());
+  parallel_for(num_threads, extents.size(), [&](const size_t &item) {
+    Boost_Float::default_precision(boost_precision);
+    const Extent &extent(extents[item]);
+    parse_matrix(extent.begin, extent.end, matrices[extent.index]);
+  });
   return std::next(delimiter);
 }
@@ -32,7 +32,7 @@ const char *parse_damped_rational(const char *begin, const char *end,
                 " The parsed string is\n\t'"
                 + std::string(current, end) + "'");
             }
-          damped_rational.constant = Boost_Float(parse_number(current, comma));
+          parse_number(current, comma, damped_rational.constant);
           return comma;
         }
     }
@@ -50,7 +50,7 @@ const char *parse_damped_rational(const char *begin, const char *end,
       throw std::runtime_error("Missing comma after DampedRational.constant");
     }
   auto constant_start(std::next(damped_start, damped_literal.size()));
-  damped_rational.constant = Boost_Float(parse_number(constant_start, comma));
+  parse_number(constant_start, comma, damped_rational.constant);
 
   auto start_poles(std::next(comma));
   auto end_poles(parse_vector(start_poles, end, damped_rational.poles));
@@ -67,7 +67,7 @@ const char *parse_damped_rational(const char *begin, const char *end,
     {
       throw std::runtime_error("Missing comma after DampedRational.base");
     }
-  damped_rational.base = Boost_Float(parse_number(start_base, comma));
+  parse_number(start_base, comma, damped_rational.base);
 
   auto start_variable(std::next(comma));
   const auto close_bracket(std::find(start_variable, end, ']'));
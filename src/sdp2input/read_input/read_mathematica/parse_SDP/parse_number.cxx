@@ -1,32 +1,49 @@
+#include "parse_number.hxx"
 #include "is_valid_char.hxx"
+#include "../../../../set_number.hxx"
 
 #include <algorithm>
-#include <vector>
 #include <string>
 
-std::string parse_number(const char *begin, const char *end)
+namespace
 {
-  std::string cleaned_string;
-  cleaned_string.reserve(end - begin);
-  auto c(begin);
-  for(; c != end && *c != '`'; ++c)
-    {
-      if(is_valid_char(*c))
-        {
-          cleaned_string.push_back(*c);
-        }
-    }
-  auto carat(std::find(c, end, '^'));
-  if(carat != end)
-    {
-      cleaned_string.push_back('e');
-      for(auto c(std::next(carat)); c != end; ++c)
-        {
-          if(is_valid_char(*c))
-            {
-              cleaned_string.push_back(*c);
-            }
-        }
-    }
-  return cleaned_string;
+  // The number in [begin, end) in a form that GMP and MPFR accept.
+  // The buffer is reused for every number parsed on a thread, so this
+  // does not allocate once it is large enough.
+  const char *clean_number(const char *begin, const char *end)
+  {
+    thread_local std::string cleaned_string;
+    cleaned_string.clear();
+    auto c(begin);
+    for(; c != end && *c != '`'; ++c)
+      {
+        if(is_valid_char(*c))
+          {
+            cleaned_string.push_back(*c);
+          }
+      }
+    auto carat(std::find(c, end, '^'));
+    if(carat != end)
+      {
+        cleaned_string.push_back('e');
+        for(auto c(std::next(carat)); c != end; ++c)
+          {
+            if(is_valid_char(*c))
+              {
+                cleaned_string.push_back(*c);
+              }
+          }
+      }
+    return cleaned_string.c_str();
+  }
+}
+
+void parse_number(const char *begin, const char *end, El::BigFloat &x)
+{
+  set_number(clean_number(begin, end), x);
+}
+
+void parse_number(const char *begin, const char *end, Boost_Float &x)
+{
+  set_number(clean_number(begin, end), x);
 }
@@ -1,6 +1,11 @@
 #pragma once
 
-#include <string>
-#include <vector>
+#include "../../../Boost_Float.hxx"
 
-std::string parse_number(const char *begin, const char *end);
+#include <El.hpp>
+
+// x = the Mathematica number in [begin, end).  Whitespace and
+// backslashes are ignored, a precision marker "`..." is dropped, and
+// "*^" introduces the exponent.
+void parse_number(const char *begin, const char *end, El::BigFloat &x);
+void parse_number(const char *begin, const char *end, Boost_Float &x);
@@ -1,5 +1,6 @@
 #include "is_valid_char.hxx"
 #include "../../../Positive_Matrix_With_Prefactor.hxx"
+#include "../../../../set_number.hxx"
 
 #include <algorithm>
 #include <iterator>
@@ -108,8 +109,8 @@ parse_polynomial(const char *begin, const char *end, Polynomial &polynomial)
             {
               polynomial.coefficients.resize(degree + 1);
             }
-          polynomial.coefficients.at(degree)
-            = El::BigFloat(mantissa + exponent);
+          mantissa += exponent;
+          set_number(mantissa.c_str(), polynomial.coefficients.at(degree));
           mantissa.clear();
         }
       else if(!mantissa.empty() && (*c == '-' || *c == '+' || c == delimiter))
@@ -118,7 +119,7 @@ parse_polynomial(const char *begin, const char *end, Polynomial &polynomial)
             {
               polynomial.coefficients.resize(1);
             }
-          polynomial.coefficients.at(0) = El::BigFloat(mantissa);
+          set_number(mantissa.c_str(), polynomial.coefficients.at(0));
           mantissa.clear();
         }
       if(c!=delimiter && is_valid_char(*c) && *c != '+')
@@ -132,7 +133,7 @@ parse_polynomial(const char *begin, const char *end, Polynomial &polynomial)
         {
           polynomial.coefficients.resize(1);
         }
-      polynomial.coefficients.at(0) = El::BigFloat(mantissa);
+      set_number(mantissa.c_str(), polynomial.coefficients.at(0));
     }
   return delimiter;
 }
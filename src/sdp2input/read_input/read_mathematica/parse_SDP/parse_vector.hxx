@@ -27,7 +27,8 @@ parse_vector(const char *begin, const char *end, std::vector<T> &result_vector)
   comma = std::find(start_element, close_brace, ',');
   while(start_element < close_brace)
     {
-      result_vector.emplace_back(parse_number(start_element, comma));
+      result_vector.emplace_back();
+      parse_number(start_element, comma, result_vector.back());
       start_element = std::next(comma);
       comma = std::find(start_element, close_brace, ',');
     }
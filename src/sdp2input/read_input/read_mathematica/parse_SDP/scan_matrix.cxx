@@ -0,0 +1,97 @@
+#include "is_valid_char.hxx"
+#include "../../../../sdp_convert.hxx"
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <string>
+
+// Find the end of the PositiveMatrixWithPrefactor starting at begin,
+// just after its matching ']', and estimate the cost of converting it.
+// This only looks at the brackets, braces, commas and powers of x, so
+// it is much faster than parsing the matrix.
+//
+// The poles are the items of the list inside DampedRational[], and
+// the polynomials are the items at brace depth 3 outside of it.  The
+// degree is the largest power of x in the polynomials.
+const char *scan_matrix(const char *begin, const char *end, size_t &cost)
+{
+  const std::string matrix_literal("PositiveMatrixWithPrefactor[");
+  auto matrix_start(
+    std::search(begin, end, matrix_literal.begin(), matrix_literal.end()));
+  if(matrix_start == end)
+    {
+      throw std::runtime_error("Could not find '" + matrix_literal + "'");
+    }
+  size_t bracket_depth(1), brace_depth(0), num_poles(0), num_polynomials(0),
+    degree(0);
+  bool has_pole(false);
+  for(auto c(std::next(matrix_start, matrix_literal.size())); c != end; ++c)
+    {
+      switch(*c)
+        {
+        case '[': ++bracket_depth; break;
+        case ']':
+          --bracket_depth;
+          if(bracket_depth == 0)
+            {
+              num_poles += (has_pole ? 1 : 0);
+              cost = block_conversion_cost(num_polynomials, degree, num_poles);
+              return std::next(c);
+            }
+          break;
+        case '{':
+          ++brace_depth;
+          if(bracket_depth == 1 && brace_depth == 3)
+            {
+              ++num_polynomials;
+            }
+          break;
+        case '}': --brace_depth; break;
+        case ',':
+          if(bracket_depth == 1 && brace_depth == 3)
+            {
+              ++num_polynomials;
+            }
+          else if(bracket_depth == 2 && brace_depth == 1)
+            {
+              ++num_poles;
+            }
+          break;
+        case 'x':
+          if(bracket_depth == 1 && brace_depth == 3)
+            {
+              auto power(std::next(c));
+              while(power != end && !is_valid_char(*power))
+                {
+                  ++power;
+                }
+              size_t exponent(1);
+              if(power != end && *power == '^')
+                {
+                  exponent = 0;
+                  for(++power; power != end; ++power)
+                    {
+                      if(std::isdigit(*power))
+                        {
+                          exponent = 10 * exponent + (*power - '0');
+                        }
+                      else if(is_valid_char(*power))
+                        {
+                          break;
+                        }
+                    }
+                }
+              degree = std::max(degree, exponent);
+            }
+          break;
+        default:
+          if(bracket_depth == 2 && brace_depth == 1 && is_valid_char(*c))
+            {
+              has_pole = true;
+            }
+          break;
+        }
+    }
+  throw std::runtime_error("Missing ']' at end of " + matrix_literal);
+}
@@ -6,17 +6,19 @@
 #include <boost/filesystem/fstream.hpp>
 #include <boost/filesystem.hpp>
 
-std::vector<char>::const_iterator
-parse_SDP(const char *begin, const char *end,
-          std::vector<El::BigFloat> &objectives,
-          std::vector<El::BigFloat> &normalization,
-          std::vector<Positive_Matrix_With_Prefactor> &matrices);
+const char *parse_SDP(const char *begin, const char *end,
+                      const std::vector<int> &block_owners,
+                      std::vector<El::BigFloat> &objectives,
+                      std::vector<El::BigFloat> &normalization,
+                      std::vector<Positive_Matrix_With_Prefactor> &matrices,
+                      const size_t &num_threads);
 
 void read_mathematica(const boost::filesystem::path &input_path,
+                      const std::vector<int> &block_owners,
                       std::vector<El::BigFloat> &objectives,
                       std::vector<El::BigFloat> &normalization,
-                      std::vector<Positive_Matrix_With_Prefactor> &matrices)
-
+                      std::vector<Positive_Matrix_With_Prefactor> &matrices,
+                      const size_t &num_threads)
 {
   boost::filesystem::ifstream input_stream(input_path);
   if(!input_stream.good())
@@ -33,7 +35,8 @@ void read_mathematica(const boost::filesystem::path &input_path,
     {
       const char *begin(static_cast<const char *>(mapped_region.get_address())),
         *end(begin + mapped_region.get_size());
-      parse_SDP(begin, end, objectives, normalization, matrices);
+      parse_SDP(begin, end, block_owners, objectives, normalization, matrices,
+                num_threads);
     }
   catch(std::exception &e)
     {
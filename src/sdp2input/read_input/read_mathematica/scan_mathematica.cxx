@@ -0,0 +1,45 @@
+#include "../../../Block_Cost.hxx"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+const char *scan_matrix(const char *begin, const char *end, size_t &cost);
+
+// Append the estimated cost of each PositiveMatrixWithPrefactor in
+// input_path to costs.  This only matches brackets, so errors in the
+// input are reported by read_mathematica().
+void scan_mathematica(const boost::filesystem::path &input_path,
+                      std::vector<Block_Cost> &costs)
+{
+  boost::interprocess::file_mapping mapped_file(
+    input_path.c_str(), boost::interprocess::read_only);
+  boost::interprocess::mapped_region mapped_region(
+    mapped_file, boost::interprocess::read_only);
+
+  const char *begin(static_cast<const char *>(mapped_region.get_address())),
+    *end(begin + mapped_region.get_size());
+  const std::string matrix_literal("PositiveMatrixWithPrefactor[");
+  try
+    {
+      for(auto matrix(std::search(begin, end, matrix_literal.begin(),
+                                  matrix_literal.end()));
+          matrix != end;
+          matrix = std::search(matrix, end, matrix_literal.begin(),
+                               matrix_literal.end()))
+        {
+          size_t cost;
+          matrix = scan_matrix(matrix, end, cost);
+          costs.emplace_back(cost, costs.size());
+        }
+    }
+  catch(std::exception &e)
+    {
+      throw std::runtime_error("Error when parsing " + input_path.string()
+                               + ": " + e.what());
+    }
+}
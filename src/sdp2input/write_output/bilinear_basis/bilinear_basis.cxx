@@ -7,9 +7,10 @@ void precompute(
                         std::vector<Boost_Float>::const_iterator>>
     &equal_ranges,
   std::vector<int64_t> &lengths, std::vector<Boost_Float> &products,
-  std::vector<std::vector<Boost_Float>> &integral_matrix);
+  std::vector<std::vector<Boost_Float>> &integral_matrix,
+  const size_t &num_threads);
 
-Boost_Float bilinear_form(
+std::vector<Boost_Float> bilinear_form(
   const Damped_Rational &damped_rational,
   const std::vector<Boost_Float> &sorted_poles,
   const std::vector<std::pair<std::vector<Boost_Float>::const_iterator,
@@ -18,17 +19,20 @@ Boost_Float bilinear_form(
   const std::vector<int64_t> &lengths,
   const std::vector<Boost_Float> &products,
   const std::vector<std::vector<Boost_Float>> &integral_matrix,
-  const int64_t &m);
+  const int64_t &max_m, const size_t &num_threads);
 
+// The entries of the bilinear table, and the integrals over each
+// distinct pole, are computed with num_threads threads.
 std::vector<Polynomial> bilinear_basis(const Damped_Rational &damped_rational,
-                                       const size_t &half_max_degree)
+                                       const size_t &half_max_degree,
+                                       const size_t &num_threads)
 {
   // Exit early if damped_rational is a constant
   if(damped_rational.is_constant())
     {
       std::vector<Polynomial> result;
       result.emplace_back(
-        1, El::BigFloat(to_string(1 / sqrt(damped_rational.constant))));
+        1, to_BigFloat(1 / sqrt(damped_rational.constant)));
       return result;
     }
 
@@ -42,50 +46,85 @@ std::vector<Polynomial> bilinear_basis(const Damped_Rational &damped_rational,
   std::vector<Boost_Float> products;
   std::vector<std::vector<Boost_Float>> integral_matrix;
   precompute(damped_rational.base, sorted_poles, equal_ranges, lengths,
-             products, integral_matrix);
+             products, integral_matrix, num_threads);
 
   std::vector<El::BigFloat> bilinear_table;
-  for(int64_t m = 0; m <= int64_t(2 * half_max_degree); ++m)
+  for(auto &form :
+      bilinear_form(damped_rational, sorted_poles, equal_ranges, lengths,
+                    products, integral_matrix, 2 * half_max_degree,
+                    num_threads))
     {
-      bilinear_table.emplace_back(
-        to_string(bilinear_form(damped_rational, sorted_poles, equal_ranges,
-                                lengths, products, integral_matrix, m)));
+      bilinear_table.push_back(to_BigFloat(form));
     }
 
-  El::Matrix<El::BigFloat> anti_band_matrix(half_max_degree + 1,
-                                            half_max_degree + 1);
-  for(size_t i = 0; i < half_max_degree + 1; ++i)
-    for(size_t j = i; j < half_max_degree + 1; ++j)
-      {
-        anti_band_matrix.Set(half_max_degree - j, j - i,
-                             bilinear_table[half_max_degree - i]);
-        if(i > 0)
-          {
-            anti_band_matrix.Set(half_max_degree - (j - i), j,
-                                 bilinear_table[half_max_degree + i]);
-          }
-      }
-
-  Cholesky(El::UpperOrLowerNS::UPPER, anti_band_matrix);
-
-  El::Matrix<El::BigFloat> basis(half_max_degree + 1, half_max_degree + 1);
-
-  El::Fill(basis, El::BigFloat(0));
-  El::FillDiagonal(basis, El::BigFloat(1));
-
-  El::Trsm(El::LeftOrRight::LEFT, El::UpperOrLowerNS::UPPER,
-           El::OrientationNS::NORMAL, El::UnitOrNonUnit::NON_UNIT,
-           El::BigFloat(1), anti_band_matrix, basis);
+  // The basis is orthonormal with respect to the bilinear form, so it
+  // satisfies the three term recurrence
+  //
+  //   sqrt(b_{k+1}) q_{k+1} = (x - a_k) q_k - sqrt(b_k) q_{k-1}
+  //
+  // with q_0 = 1/sqrt(b_0).  The coefficients a_k and b_k come straight
+  // from the moments in bilinear_table with the Chebyshev algorithm,
+  // where sigma(k,l) = <pi_k x^l> for the monic orthogonal polynomials
+  // pi_k.  This is O(d^2), instead of O(d^3) for a Cholesky
+  // decomposition of the Hankel matrix of moments, and gives the same
+  // polynomials, each with a positive leading coefficient.
+  const size_t num_moments(bilinear_table.size());
+  std::vector<El::BigFloat> a(half_max_degree + 1), b(half_max_degree + 1);
+  std::vector<El::BigFloat> sigma_previous(num_moments, El::BigFloat(0)),
+    sigma(bilinear_table), sigma_next(num_moments);
+  for(size_t k = 0; k <= half_max_degree; ++k)
+    {
+      if(k > 0)
+        {
+          for(size_t l = k; l < num_moments - k; ++l)
+            {
+              sigma_next[l] = sigma[l + 1] - a[k - 1] * sigma[l]
+                              - b[k - 1] * sigma_previous[l];
+            }
+          std::swap(sigma_previous, sigma);
+          std::swap(sigma, sigma_next);
+        }
+      if(sigma[k] <= El::BigFloat(0))
+        {
+          throw std::runtime_error(
+            "The bilinear form is not positive definite at degree "
+            + std::to_string(k));
+        }
+      b[k] = k == 0 ? sigma[0] : sigma[k] / sigma_previous[k - 1];
+      if(k < half_max_degree)
+        {
+          a[k] = sigma[k + 1] / sigma[k]
+                 - (k == 0 ? El::BigFloat(0)
+                           : sigma_previous[k] / sigma_previous[k - 1]);
+        }
+    }
 
-  std::vector<Polynomial> result(basis.Height());
-  for(int64_t row = 0; row < basis.Height(); ++row)
-    for(int64_t column = 0; column < basis.Width(); ++column)
-      {
-        if(basis(column, row) != El::BigFloat(0))
-          {
-            result[row].coefficients.resize(column + 1, 0);
-            result[row].coefficients[column] = basis(column, row);
-          }
-      }
+  std::vector<Polynomial> result(half_max_degree + 1);
+  result[0].coefficients.assign(1, El::BigFloat(1) / El::Sqrt(b[0]));
+  for(size_t k = 0; k < half_max_degree; ++k)
+    {
+      std::vector<El::BigFloat> &next(result[k + 1].coefficients);
+      const std::vector<El::BigFloat> &current(result[k].coefficients);
+      next.assign(k + 2, El::BigFloat(0));
+      for(size_t n = 0; n <= k; ++n)
+        {
+          next[n + 1] += current[n];
+          next[n] -= a[k] * current[n];
+        }
+      if(k > 0)
+        {
+          const El::BigFloat sqrt_b(El::Sqrt(b[k]));
+          for(size_t n = 0; n < k; ++n)
+            {
+              next[n] -= sqrt_b * result[k - 1].coefficients[n];
+            }
+        }
+      const El::BigFloat inverse_sqrt_b(El::BigFloat(1)
+                                        / El::Sqrt(b[k + 1]));
+      for(auto &coefficient : next)
+        {
+          coefficient *= inverse_sqrt_b;
+        }
+    }
   return result;
 }
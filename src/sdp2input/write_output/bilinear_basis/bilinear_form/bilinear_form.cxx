@@ -1,21 +1,44 @@
-#include "../factorial.hxx"
+#include "Derivative_Term.hxx"
 #include "../../../Damped_Rational.hxx"
-#include "../../../../Polynomial.hxx"
-#include "../../../../Timers.hxx"
+#include "../../../../parallel_for.hxx"
 
-#include <boost/math/tools/polynomial.hpp>
+#include <algorithm>
+#include <set>
 
-Boost_Float integral(const Boost_Float &prefactor, const Boost_Float &b,
-                     const Boost_Float &x, const int64_t &k);
+std::set<Derivative_Term> dExp(const int64_t &k);
 
-Boost_Float
-rest(const int64_t &m, const Boost_Float &p,
-     const std::vector<Boost_Float> &sorted_poles,
-     const std::pair<std::vector<Boost_Float>::const_iterator,
-                     std::vector<Boost_Float>::const_iterator> &equal_range,
-     const int64_t &k);
+void log_rest_coefficients(
+  const Boost_Float &p, const std::vector<Boost_Float> &sorted_poles,
+  const std::pair<std::vector<Boost_Float>::const_iterator,
+                  std::vector<Boost_Float>::const_iterator> &equal_range,
+  const int64_t &max_order, std::vector<Boost_Float> &slopes,
+  std::vector<Boost_Float> &offsets);
 
-Boost_Float bilinear_form(
+Boost_Float rest(const int64_t &m, const std::set<Derivative_Term> &dExp_k,
+                 const std::vector<Boost_Float> &slopes,
+                 const std::vector<Boost_Float> &offsets, const int64_t &k);
+
+// The bilinear form <x^m> for every 0 <= m <= max_m, in one sweep over
+// m.  Everything that does not depend on m is computed once, and the
+// rest is carried from one m to the next:
+//
+// - p^m for each pole p.
+//
+// - The quotient Q_m and remainder R_m of x^m divided by the product
+//   D(x) of (x - p) over the poles.  If r is the coefficient of x^(P-1)
+//   in R_m, where P is the number of poles, then
+//
+//     Q_{m+1} = x Q_m + r,  R_{m+1} = x R_m - r D
+//
+//   so each step is a single synthetic division step.
+//
+// - The weights n! (-log(base))^(-1-n) of the coefficients of Q_m.
+//
+// The sums over the poles are the expensive part, and they only
+// depend on m through p^m and rest(), so they are computed for blocks
+// of m in parallel using num_threads threads.  The quotient sweep is
+// cheap and stays serial.
+std::vector<Boost_Float> bilinear_form(
   const Damped_Rational &damped_rational,
   const std::vector<Boost_Float> &sorted_poles,
   const std::vector<std::pair<std::vector<Boost_Float>::const_iterator,
@@ -24,45 +47,113 @@ Boost_Float bilinear_form(
   const std::vector<int64_t> &lengths,
   const std::vector<Boost_Float> &products,
   const std::vector<std::vector<Boost_Float>> &integral_matrix,
-  const int64_t &m)
+  const int64_t &max_m, const size_t &num_threads)
 {
-  Boost_Float result(0);
+  std::vector<Boost_Float> result(max_m + 1, Boost_Float(0));
 
-  size_t index(0);
-  for(auto pole(sorted_poles.begin()); pole != sorted_poles.end();)
+  const size_t num_groups(lengths.size());
+  const int64_t max_length(
+    lengths.empty() ? 0 : *std::max_element(lengths.begin(), lengths.end()));
+  std::vector<std::set<Derivative_Term>> dExps;
+  for(int64_t k = 0; k < max_length; ++k)
     {
-      const Boost_Float &p(*pole);
-      auto &equal_range(equal_ranges.at(index));
-      auto &l(lengths.at(index));
-      auto &product(products.at(index));
+      dExps.push_back(dExp(k));
+    }
+
+  std::vector<std::vector<Boost_Float>> slopes(num_groups),
+    offsets(num_groups);
+  {
+    auto pole(sorted_poles.begin());
+    for(size_t index = 0; index < num_groups; ++index)
+      {
+        log_rest_coefficients(*pole, sorted_poles, equal_ranges.at(index),
+                              lengths[index], slopes[index],
+                              offsets[index]);
+        std::advance(pole, lengths[index]);
+      }
+  }
 
-      Boost_Float integral_sum(0);
-      auto &integrals(integral_matrix.at(index));
-      for(int64_t k = 0; k < l; ++k)
+  // divisor = D(x), which is monic, lowest order first.
+  const size_t num_poles(sorted_poles.size());
+  std::vector<Boost_Float> divisor(1, Boost_Float(1));
+  for(auto &pole : sorted_poles)
+    {
+      divisor.push_back(Boost_Float(0));
+      for(size_t n = divisor.size() - 1; n > 0; --n)
         {
-          integral_sum
-            += integrals.at(k) * rest(m, p, sorted_poles, equal_range, k);
+          divisor[n] = divisor[n - 1] - pole * divisor[n];
         }
-      result += (pow(p, m) * product) * integral_sum;
-
-      std::advance(pole, l);
-      ++index;
+      divisor[0] *= -pole;
     }
-
-  boost::math::tools::polynomial<Boost_Float> numerator(
-    pow(boost::math::tools::polynomial<Boost_Float>({0, 1}), m)),
-    divisor({1});
-  for(auto &pole : sorted_poles)
+  // x^0 = 1 is all remainder, unless there are no poles.
+  std::vector<Boost_Float> quotient, remainder(num_poles, Boost_Float(0));
+  if(num_poles == 0)
     {
-      divisor *= boost::math::tools::polynomial<Boost_Float>({-pole, 1});
+      quotient.emplace_back(1);
     }
-  boost::math::tools::polynomial<Boost_Float> quotient(
-    boost::math::tools::quotient_remainder(numerator, divisor).first);
+  else
+    {
+      remainder[0] = 1;
+    }
+
+  const Boost_Float minus_log_base(-log(damped_rational.base));
+  std::vector<Boost_Float> weights(1, 1 / minus_log_base);
 
-  for(int64_t n = 0; n < int64_t(quotient.size()); ++n)
+  // The default precision of Boost_Float is per thread.
+  const unsigned boost_precision(Boost_Float::default_precision());
+  const size_t num_blocks(std::min(num_threads, size_t(max_m + 1))),
+    block_size((max_m + num_blocks) / num_blocks);
+  parallel_for(num_threads, num_blocks, [&](const size_t &block) {
+    Boost_Float::default_precision(boost_precision);
+    const int64_t begin_m(block * block_size),
+      end_m(std::min(int64_t((block + 1) * block_size), max_m + 1));
+    auto pole(sorted_poles.begin());
+    for(size_t index = 0; index < num_groups; ++index)
+      {
+        const Boost_Float &p(*pole);
+        auto &integrals(integral_matrix.at(index));
+        Boost_Float pole_power(pow(p, begin_m));
+        for(int64_t m = begin_m; m < end_m; ++m)
+          {
+            Boost_Float integral_sum(0);
+            for(int64_t k = 0; k < lengths[index]; ++k)
+              {
+                integral_sum += integrals.at(k)
+                                * rest(m, dExps[k], slopes[index],
+                                       offsets[index], k);
+              }
+            result[m] += (pole_power * products.at(index)) * integral_sum;
+            pole_power *= p;
+          }
+        std::advance(pole, lengths[index]);
+      }
+  });
+
+  for(int64_t m = 0; m <= max_m; ++m)
     {
-      result += quotient[n] * factorial(n)
-                * pow(-log(damped_rational.base), -1 - n);
+      while(weights.size() < quotient.size())
+        {
+          weights.push_back(weights.back() * int64_t(weights.size())
+                            / minus_log_base);
+        }
+      for(size_t n = 0; n < quotient.size(); ++n)
+        {
+          result[m] += quotient[n] * weights[n];
+        }
+      result[m] *= damped_rational.constant;
+
+      // Step from x^m to x^(m+1)
+      const Boost_Float r(num_poles == 0 ? Boost_Float(0)
+                                         : remainder.back());
+      if(!quotient.empty() || r != 0)
+        {
+          quotient.insert(quotient.begin(), r);
+        }
+      for(size_t n = num_poles; n > 0; --n)
+        {
+          remainder[n - 1]
+            = (n > 1 ? remainder[n - 2] : Boost_Float(0)) - r * divisor[n - 1];
+        }
     }
-  return result * damped_rational.constant;
+  return result;
 }
@@ -4,43 +4,49 @@
 
 #include <set>
 
-std::set<Derivative_Term> dExp(const int64_t &k);
-
-namespace
+// log_rest(m, order) is linear in m, so it is stored as
+//
+//   log_rest(m, order) = slopes[order] * m + offsets[order]
+//
+// for 1 <= order <= max_order, and only the m dependence is left for
+// rest().
+void log_rest_coefficients(
+  const Boost_Float &p, const std::vector<Boost_Float> &sorted_poles,
+  const std::pair<std::vector<Boost_Float>::const_iterator,
+                  std::vector<Boost_Float>::const_iterator> &equal_range,
+  const int64_t &max_order, std::vector<Boost_Float> &slopes,
+  std::vector<Boost_Float> &offsets)
 {
-  Boost_Float
-  log_rest(const int64_t &m, const Boost_Float &p,
-           const std::vector<Boost_Float> &sorted_poles,
-           const std::pair<std::vector<Boost_Float>::const_iterator,
-                           std::vector<Boost_Float>::const_iterator> &equal_range,
-           const int64_t &order)
-  {
-    return factorial(order - 1) * (order % 2 == 0 ? -1 : 1)
-           * (m * pow(p, -order)
-              - accumulate_over_others(
-                  sorted_poles, equal_range, Boost_Float(0),
-                  [&](const Boost_Float &sum, const Boost_Float &q) {
-                    return sum + pow(p - q, -order);
-                  }));
-  }
+  slopes.assign(max_order + 1, Boost_Float(0));
+  offsets.assign(max_order + 1, Boost_Float(0));
+  for(int64_t order = 1; order <= max_order; ++order)
+    {
+      const Boost_Float scale(factorial(order - 1)
+                              * (order % 2 == 0 ? -1 : 1));
+      slopes[order] = scale * pow(p, -order);
+      offsets[order]
+        = -scale
+          * accumulate_over_others(
+            sorted_poles, equal_range, Boost_Float(0),
+            [&](const Boost_Float &sum, const Boost_Float &q) {
+              return sum + pow(p - q, -order);
+            });
+    }
 }
 
-Boost_Float
-rest(const int64_t &m, const Boost_Float &p,
-     const std::vector<Boost_Float> &sorted_poles,
-     const std::pair<std::vector<Boost_Float>::const_iterator,
-                     std::vector<Boost_Float>::const_iterator> &equal_range,
-     const int64_t &k)
+// dExp_k = dExp(k), computed once for each k by the caller.
+Boost_Float rest(const int64_t &m, const std::set<Derivative_Term> &dExp_k,
+                 const std::vector<Boost_Float> &slopes,
+                 const std::vector<Boost_Float> &offsets, const int64_t &k)
 {
   Boost_Float result(0);
-  for(auto &term : dExp(k))
+  for(auto &term : dExp_k)
     {
       Boost_Float product(term.constant);
       for(auto &power : term.powers)
         {
-          product
-            *= pow(log_rest(m, p, sorted_poles, equal_range, power.first),
-                   power.second);
+          product *= pow(slopes.at(power.first) * m + offsets[power.first],
+                         power.second);
         }
       result += product;
     }
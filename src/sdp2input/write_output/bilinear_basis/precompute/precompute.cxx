@@ -1,4 +1,5 @@
 #include "../accumulate_over_others.hxx"
+#include "../../../../parallel_for.hxx"
 
 #include <boost/math/special_functions/expint.hpp>
 
@@ -13,7 +14,8 @@ void precompute(
                         std::vector<Boost_Float>::const_iterator>>
     &equal_ranges,
   std::vector<int64_t> &lengths, std::vector<Boost_Float> &products,
-  std::vector<std::vector<Boost_Float>> &integral_matrix)
+  std::vector<std::vector<Boost_Float>> &integral_matrix,
+  const size_t &num_threads)
 {
   sorted_poles.erase(
     std::remove_if(sorted_poles.begin(), sorted_poles.end(),
@@ -41,18 +43,25 @@ void precompute(
               return product * (p - q);
             }));
 
-      Boost_Float integral_sum(0);
-      Boost_Float integral_prefactor(-boost::math::expint(-p * log(base))
-                                     * pow(base, p));
-
-      integral_matrix.emplace_back();
-      auto &integrals(integral_matrix.back());
-      for(int64_t k = 0; k < l; ++k)
-        {
-          integrals.push_back(
-            integral(integral_prefactor, base, p, l - k - 1));
-        }
-
       std::advance(pole, l);
     }
+
+  // The integrals over each distinct pole are independent, and expint
+  // is the most expensive part, so the poles are handled in parallel.
+  // The default precision of Boost_Float is per thread.
+  const unsigned boost_precision(Boost_Float::default_precision());
+  integral_matrix.resize(equal_ranges.size());
+  parallel_for(num_threads, equal_ranges.size(), [&](const size_t &index) {
+    Boost_Float::default_precision(boost_precision);
+    const Boost_Float &p(*equal_ranges[index].first);
+    const int64_t l(lengths[index]);
+    Boost_Float integral_prefactor(-boost::math::expint(-p * log(base))
+                                   * pow(base, p));
+
+    auto &integrals(integral_matrix[index]);
+    for(int64_t k = 0; k < l; ++k)
+      {
+        integrals.push_back(integral(integral_prefactor, base, p, l - k - 1));
+      }
+  });
 }
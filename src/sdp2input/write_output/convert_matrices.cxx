@@ -0,0 +1,264 @@
+#include "../Positive_Matrix_With_Prefactor.hxx"
+#include "../Boost_Float.hxx"
+#include "../../Timers.hxx"
+#include "../../sdp_convert.hxx"
+#include "../../sdp_convert/Block_Hash.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <tuple>
+
+std::vector<Polynomial> bilinear_basis(const Damped_Rational &damped_rational,
+                                       const size_t &half_max_degree,
+                                       const size_t &num_threads);
+
+std::vector<Boost_Float> sample_points(const size_t &num_points);
+
+namespace
+{
+  // Exact, since mpfr_get_str with no digit count gives enough digits
+  // to read back the same number.
+  void add(Block_Hash &hash, const Boost_Float &x)
+  {
+    mpfr_exp_t exponent;
+    char *digits(
+      mpfr_get_str(nullptr, &exponent, 16, 0, x.backend().data(), MPFR_RNDN));
+    hash.add(digits, std::strlen(digits));
+    hash.add(uint64_t(exponent));
+    mpfr_free_str(digits);
+  }
+
+  // Everything that goes into the Dual_Constraint_Group of a matrix.
+  // The sample points, scalings and bilinear basis only depend on the
+  // DampedRational and max_degree, so the hash can be computed before
+  // they are.
+  uint64_t
+  hash_input(const Polynomial_Vector_Matrix &pvm,
+             const Damped_Rational &damped_rational, const size_t &max_degree,
+             const size_t &low_precision,
+             const size_t &low_precision_max_degree)
+  {
+    Block_Hash hash;
+    hash.add(uint64_t(pvm.rows));
+    hash.add(uint64_t(pvm.cols));
+    for(auto &element : pvm.elements)
+      {
+        hash.add(uint64_t(element.size()));
+        for(auto &polynomial : element)
+          {
+            hash.add(uint64_t(polynomial.coefficients.size()));
+            for(auto &coefficient : polynomial.coefficients)
+              {
+                hash.add(coefficient);
+              }
+          }
+      }
+    add(hash, damped_rational.constant);
+    add(hash, damped_rational.base);
+    hash.add(uint64_t(damped_rational.poles.size()));
+    for(auto &pole : damped_rational.poles)
+      {
+        add(hash, pole);
+      }
+    hash.add(uint64_t(max_degree));
+    hash.add(uint64_t(low_precision));
+    hash.add(uint64_t(low_precision_max_degree));
+    return hash.value();
+  }
+}
+
+// Convert the matrices for indices into Dual_Constraint_Groups and
+// move each one into write().  If write_unchanged is set, each matrix is
+// hashed first, and the conversion is skipped if write_unchanged
+// returns true for it.  objective_const and dual_objective_b are set
+// before any matrix is converted.
+void convert_matrices(
+  const std::vector<El::BigFloat> &objectives,
+  const std::vector<El::BigFloat> &normalization,
+  const std::vector<Positive_Matrix_With_Prefactor> &matrices,
+  const std::vector<size_t> &indices, const size_t &low_precision,
+  const size_t &low_precision_max_degree, const size_t &num_threads,
+  const std::function<bool(const size_t &, const uint64_t &)>
+    &write_unchanged,
+  const std::function<void(const size_t &, Dual_Constraint_Group &&,
+                           const uint64_t &)> &write,
+  El::BigFloat &objective_const, std::vector<El::BigFloat> &dual_objective_b,
+  Timers &timers)
+{
+  auto &objectives_timer(timers.add_and_start("write_output.objectives"));
+
+  auto max_normalization(normalization.begin());
+  for(auto n(normalization.begin()); n!=normalization.end(); ++n)
+    {
+      if(Abs(*n)>Abs(*max_normalization))
+        {
+          max_normalization=n;
+        }
+    }
+  size_t max_index(std::distance(normalization.begin(), max_normalization));
+
+  objective_const = objectives.at(max_index) / normalization.at(max_index);
+  dual_objective_b.clear();
+  dual_objective_b.reserve(normalization.size() - 1);
+  for(size_t index = 0; index < normalization.size(); ++index)
+    {
+      if(index != max_index)
+        {
+          dual_objective_b.push_back(
+            objectives.at(index) - normalization.at(index) * objective_const);
+        }
+    }
+
+  objectives_timer.stop();
+
+  auto &matrices_timer(timers.add_and_start("write_output.matrices"));
+  // Only the matrices for indices are filled in.
+
+  // The sample points, sample scalings and bilinear basis depend only
+  // on the DampedRational and the degree, and many matrices share
+  // them, so they are computed once on each rank for each (constant,
+  // base, poles, max_degree).  The table holds them already converted
+  // to BigFloat.
+  struct Prefactor_Table
+  {
+    std::vector<El::BigFloat> sample_points, sample_scalings;
+    std::vector<Polynomial> bilinear_basis;
+  };
+  std::map<std::tuple<Boost_Float, Boost_Float, std::vector<Boost_Float>,
+                      size_t>,
+           Prefactor_Table>
+    prefactor_tables;
+  for(auto &index : indices)
+    {
+      const size_t max_degree([&]() {
+        int64_t result(0);
+        for(auto &pvv : matrices[index].polynomials)
+          for(auto &pv : pvv)
+            for(auto &polynomial : pv)
+              {
+                result = std::max(result, polynomial.degree());
+              }
+        return result;
+      }());
+
+      Polynomial_Vector_Matrix pvm;
+      pvm.rows = matrices[index].polynomials.size();
+      pvm.cols = matrices[index].polynomials.front().size();
+
+      auto &pvm_timer(timers.add_and_start("write_output.matrices.pvm_"
+                                           + std::to_string(index)));
+      pvm.elements.reserve(pvm.rows * pvm.cols);
+      for(auto &pvv : matrices[index].polynomials)
+        for(auto &pv : pvv)
+          {
+            pvm.elements.emplace_back();
+            auto &pvm_polynomials(pvm.elements.back());
+            pvm_polynomials.reserve(pv.size());
+            pvm_polynomials.push_back(pv.at(max_index)
+                                      / normalization.at(max_index));
+            auto &pvm_constant(pvm_polynomials.back());
+
+            for(size_t index = 0; index < normalization.size(); ++index)
+              {
+                if(index != max_index)
+                  {
+                    pvm_polynomials.emplace_back(0, 0);
+                    auto &pvm_poly(pvm_polynomials.back());
+                    pvm_poly.coefficients.reserve(pv.at(index).degree() + 1);
+                    size_t coefficient(0);
+                    for(; coefficient < pv.at(index).coefficients.size()
+                          && coefficient < pvm_constant.coefficients.size();
+                        ++coefficient)
+                      {
+                        pvm_poly.coefficients.push_back(
+                          pv.at(index).coefficients[coefficient]
+                          - normalization.at(index)
+                              * pvm_constant.coefficients[coefficient]);
+                      }
+                    for(; coefficient < pv.at(index).coefficients.size();
+                        ++coefficient)
+                      {
+                        pvm_poly.coefficients.push_back(
+                          pv.at(index).coefficients[coefficient]);
+                      }
+                    for(; coefficient < pvm_constant.coefficients.size();
+                        ++coefficient)
+                      {
+                        pvm_poly.coefficients.push_back(
+                          -normalization.at(index)
+                          * pvm_polynomials.at(0).coefficients[coefficient]);
+                      }
+                  }
+              }
+          }
+      pvm_timer.stop();
+
+      const Damped_Rational &damped_rational(matrices[index].damped_rational);
+      uint64_t input_hash(0);
+      if(write_unchanged)
+        {
+          input_hash = hash_input(pvm, damped_rational, max_degree,
+                                  low_precision, low_precision_max_degree);
+          if(write_unchanged(index, input_hash))
+            {
+              continue;
+            }
+        }
+
+      const auto key(std::make_tuple(damped_rational.constant,
+                                     damped_rational.base,
+                                     damped_rational.poles, max_degree));
+      auto table(prefactor_tables.find(key));
+      if(table == prefactor_tables.end())
+        {
+          table = prefactor_tables.emplace(key, Prefactor_Table()).first;
+          auto &scalings_timer(timers.add_and_start(
+            "write_output.matrices.scalings_" + std::to_string(index)));
+          const std::vector<Boost_Float> points(
+            sample_points(max_degree + 1));
+          table->second.sample_points.reserve(points.size());
+          table->second.sample_scalings.reserve(points.size());
+          for(auto &point : points)
+            {
+              Boost_Float numerator(damped_rational.constant
+                                    * pow(damped_rational.base, point));
+              Boost_Float denominator(1);
+              for(auto &pole : damped_rational.poles)
+                {
+                  denominator *= (point - pole);
+                }
+              table->second.sample_points.emplace_back(to_BigFloat(point));
+              table->second.sample_scalings.emplace_back(
+                to_BigFloat(numerator / denominator));
+            }
+          scalings_timer.stop();
+
+          auto &bilinear_basis_timer(timers.add_and_start(
+            "write_output.matrices.bilinear_basis_" + std::to_string(index)));
+          table->second.bilinear_basis
+            = bilinear_basis(damped_rational, max_degree / 2, num_threads);
+          bilinear_basis_timer.stop();
+        }
+
+      pvm.sample_points = table->second.sample_points;
+      pvm.sample_scalings = table->second.sample_scalings;
+      pvm.bilinear_basis = table->second.bilinear_basis;
+
+      auto &dual_constraint_timer(timers.add_and_start(
+        "write_output.matrices.dual_constraint_" + std::to_string(index)));
+      Dual_Constraint_Group group(pvm);
+      if(group.degree <= low_precision_max_degree)
+        {
+          group.precision = low_precision;
+        }
+      dual_constraint_timer.stop();
+
+      auto &write_timer(timers.add_and_start("write_output.write_"
+                                             + std::to_string(index)));
+      write(index, std::move(group), input_hash);
+      write_timer.stop();
+    }
+  matrices_timer.stop();
+}
@@ -0,0 +1,163 @@
+// Convert an SDP with sdp2input's conversion and solve it with sdpb in
+// the same run.  The converted blocks stay in memory and are sent
+// straight to the ranks that own them, instead of being written to an
+// sdp directory as text and parsed back.  This saves the round trip
+// through the file system, which can take longer than the solve for
+// small SDPs.
+//
+// The conversion options are taken out of the command line, and
+// everything else is passed on to sdpb.  --sdpDir is still required.
+// It only has to exist, and is used for block_timings and the default
+// output and checkpoint directories.
+
+#include "../sdp2input/Boost_Float.hxx"
+#include "../sdp2input/Positive_Matrix_With_Prefactor.hxx"
+#include "../sdpb/SDP_Solver_Parameters.hxx"
+#include "../sdpb/limb_pool.hxx"
+#include "../sdp_convert.hxx"
+#include "../Timers.hxx"
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+namespace po = boost::program_options;
+
+void read_input(const boost::filesystem::path &input_file,
+                std::vector<El::BigFloat> &objectives,
+                std::vector<El::BigFloat> &normalization,
+                std::vector<Positive_Matrix_With_Prefactor> &matrices,
+                std::vector<size_t> &indices, const size_t &num_threads);
+
+void convert_matrices(
+  const std::vector<El::BigFloat> &objectives,
+  const std::vector<El::BigFloat> &normalization,
+  const std::vector<Positive_Matrix_With_Prefactor> &matrices,
+  const std::vector<size_t> &indices, const size_t &low_precision,
+  const size_t &low_precision_max_degree, const size_t &num_threads,
+  const std::function<bool(const size_t &, const uint64_t &)>
+    &write_unchanged,
+  const std::function<void(const size_t &, Dual_Constraint_Group &&,
+                           const uint64_t &)> &write,
+  El::BigFloat &objective_const, std::vector<El::BigFloat> &dual_objective_b,
+  Timers &timers);
+
+void run_sdpb(SDP_Solver_Parameters &parameters);
+
+int main(int argc, char **argv)
+{
+  // This has to come before anything, including MPI and Elemental,
+  // allocates GMP limbs.
+  install_limb_pool();
+  El::Environment env(argc, argv);
+
+  try
+    {
+      boost::filesystem::path input_file;
+      size_t low_precision, low_precision_max_degree;
+
+      po::options_description options("Conversion options");
+      options.add_options()(
+        "input", po::value<boost::filesystem::path>(&input_file),
+        "Mathematica, JSON, or NSV file with SDP definition.  Required.");
+      options.add_options()(
+        "lowPrecision",
+        po::value<size_t>(&low_precision)->default_value(0),
+        "Precision in bits for the block-local kernels of the blocks "
+        "with degree at most lowPrecisionMaxDegree.  0 means the "
+        "solver's precision for every block.");
+      options.add_options()(
+        "lowPrecisionMaxDegree",
+        po::value<size_t>(&low_precision_max_degree)->default_value(0),
+        "The largest degree of a block that uses lowPrecision.");
+
+      const po::parsed_options parsed(po::command_line_parser(argc, argv)
+                                        .options(options)
+                                        .allow_unregistered()
+                                        .run());
+      po::variables_map variables_map;
+      po::store(parsed, variables_map);
+      po::notify(variables_map);
+
+      std::vector<std::string> solver_arguments(
+        po::collect_unrecognized(parsed.options, po::include_positional));
+      solver_arguments.insert(solver_arguments.begin(), argv[0]);
+      std::vector<char *> solver_argv;
+      for(auto &argument : solver_arguments)
+        {
+          solver_argv.push_back(&argument[0]);
+        }
+      const bool is_help(
+        std::find(solver_arguments.begin(), solver_arguments.end(),
+                  std::string("--help"))
+          != solver_arguments.end()
+        || std::find(solver_arguments.begin(), solver_arguments.end(),
+                     std::string("-h"))
+             != solver_arguments.end());
+      if(is_help && El::mpi::Rank() == 0)
+        {
+          std::cout << options << '\n';
+        }
+
+      SDP_Solver_Parameters parameters(solver_argv.size(),
+                                       solver_argv.data());
+      if(!parameters.is_valid())
+        {
+          return 0;
+        }
+      Limb_Placement placement;
+      placement.numa_local = parameters.numa_local_limbs;
+      placement.pages = parameters.limb_pages;
+      set_limb_placement(placement);
+      if(input_file.empty())
+        {
+          throw std::runtime_error("The option '--input' is required");
+        }
+      if(!boost::filesystem::exists(input_file)
+         || boost::filesystem::is_directory(input_file))
+        {
+          throw std::runtime_error("Input file '" + input_file.string()
+                                   + "' does not exist or is a directory");
+        }
+
+      // Convert at the full precision.  run_sdpb() sets the working
+      // precision, and the solver reads the blocks at that precision.
+      El::gmp::SetPrecision(parameters.precision);
+      Boost_Float::default_precision(parameters.precision * log(2)
+                                     / log(10));
+
+      std::shared_ptr<In_Memory_SDP> in_memory_sdp(new In_Memory_SDP());
+      {
+        std::vector<El::BigFloat> objectives, normalization;
+        std::vector<Positive_Matrix_With_Prefactor> matrices;
+        std::vector<size_t> indices;
+        Timers timers(parameters.verbosity >= Verbosity::debug);
+        read_input(input_file, objectives, normalization, matrices, indices,
+                   parameters.threads_per_proc);
+        in_memory_sdp->blocks.reserve(indices.size());
+        convert_matrices(
+          objectives, normalization, matrices, indices, low_precision,
+          low_precision_max_degree, parameters.threads_per_proc, {},
+          [&](const size_t &index, Dual_Constraint_Group &&group,
+              const uint64_t &) {
+            in_memory_sdp->blocks.push_back(to_in_memory_block(index, group));
+          },
+          in_memory_sdp->objective_const, in_memory_sdp->dual_objective_b,
+          timers);
+      }
+      parameters.in_memory_sdp = in_memory_sdp;
+      run_sdpb(parameters);
+    }
+  catch(std::exception &e)
+    {
+      El::ReportException(e);
+      El::mpi::Abort(El::mpi::COMM_WORLD, 1);
+    }
+  catch(...)
+    {
+      El::mpi::Abort(El::mpi::COMM_WORLD, 1);
+    }
+}
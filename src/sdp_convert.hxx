@@ -1,6 +1,10 @@
 #pragma once
 
 #include "sdp_convert/Dual_Constraint_Group.hxx"
+#include "sdp_convert/SDPB_Input_Writer.hxx"
+#include "sdp_convert/Input_File_Plan.hxx"
+#include "Block_Cost.hxx"
+#include "In_Memory_SDP.hxx"
 
 #include <boost/filesystem.hpp>
 
@@ -11,7 +15,32 @@ void write_sdpb_input_files(
   const int &num_procs, const std::vector<size_t> &indices,
   const El::BigFloat &objective_const,
   const std::vector<El::BigFloat> &dual_objective_b,
-  const std::vector<Dual_Constraint_Group> &dual_constraint_groups);
+  const std::vector<Dual_Constraint_Group> &dual_constraint_groups,
+  const bool &binary);
+
+// A Block_Hash of the input of m, for SDPB_Input_Writer's incremental
+// mode.
+uint64_t hash_polynomial_vector_matrix(const Polynomial_Vector_Matrix &m);
+
+// group as a block of an In_Memory_SDP, for converters that hand the
+// SDP straight to the solver.
+In_Memory_Block
+to_in_memory_block(const size_t &index, const Dual_Constraint_Group &group);
 
 std::vector<boost::filesystem::path>
 read_file_list(const boost::filesystem::path &input_file);
+
+// Replace each .nsv list in input_files, recursively, with the files
+// that it lists, skipping empty names.
+std::vector<boost::filesystem::path>
+flatten_input_files(const std::vector<boost::filesystem::path> &input_files);
+
+// An estimate of the cost of converting a block with num_polynomials
+// polynomials of at most degree, and num_poles poles.
+size_t block_conversion_cost(const size_t &num_polynomials,
+                             const size_t &degree, const size_t &num_poles);
+
+// The rank that converts each block, balancing the costs.  costs[i]
+// must have index i.
+std::vector<int> assign_block_owners(const std::vector<Block_Cost> &costs,
+                                     const int &num_procs);
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <El.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// A 64 bit FNV-1a hash of everything that goes into a block, used to
+// tell whether a block has changed since the output was last written.
+// 0 is never the result, so that it can mean "unknown".
+class Block_Hash
+{
+public:
+  void add(const void *data, const size_t &size)
+  {
+    const unsigned char *bytes(static_cast<const unsigned char *>(data));
+    for(size_t index = 0; index < size; ++index)
+      {
+        hash = (hash ^ bytes[index]) * 1099511628211ULL;
+      }
+  }
+  void add(const uint64_t &value) { add(&value, sizeof(value)); }
+  // Exact at the BigFloat's precision
+  void add(const El::BigFloat &value)
+  {
+    buffer.resize(value.SerializedSize());
+    value.Serialize(buffer.data());
+    add(buffer.data(), buffer.size());
+  }
+
+  uint64_t value() const { return hash == 0 ? 1 : hash; }
+
+private:
+  uint64_t hash = 14695981039346656037ULL;
+  std::vector<El::byte> buffer;
+};
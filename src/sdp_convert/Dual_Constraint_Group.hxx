@@ -44,5 +44,9 @@ public:
   // `bilinear_bases[j]' above for some fixed j.
   std::array<El::Matrix<El::BigFloat>,2> bilinear_bases;
 
+  // The precision in bits that sdpb uses for the block-local kernels
+  // of this group, or 0 for sdpb's precision.
+  size_t precision = 0;
+
   explicit Dual_Constraint_Group(const Polynomial_Vector_Matrix &m);
 };
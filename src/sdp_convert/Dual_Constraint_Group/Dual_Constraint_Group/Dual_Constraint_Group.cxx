@@ -7,12 +7,19 @@
 
 #include "../../Dual_Constraint_Group.hxx"
 
+#include <algorithm>
+
 El::Matrix<El::BigFloat>
 sample_bilinear_basis(const int maxDegree, const int numSamples,
                       const std::vector<Polynomial> &bilinearBasis,
                       const std::vector<El::BigFloat> &samplePoints,
                       const std::vector<El::BigFloat> &sampleScalings);
 
+El::Matrix<El::BigFloat>
+sample_polynomials(const std::vector<const Polynomial *> &polynomials,
+                   const std::vector<El::BigFloat> &samplePoints,
+                   const std::vector<El::BigFloat> &sampleScalings);
+
 // Construct a Dual_Constraint_Group from a Polynomial_Vector_Matrix by
 // sampling the matrix at the appropriate number of points, as
 // described in SDP.h:
@@ -42,23 +49,36 @@ Dual_Constraint_Group::Dual_Constraint_Group(const Polynomial_Vector_Matrix &m)
   // The rest multiply decision variables y
   constraint_matrix.Resize(numConstraints, vectorDim - 1);
 
-  // Populate B and c by sampling the polynomial matrix
+  // Populate B and c by sampling the polynomial matrix.  All of the
+  // polynomials in the upper triangle are sampled together.  The
+  // vectorDim rows of samples for each (r,c) follow those of the
+  // previous (r,c), in the same order as the loop below.
+  std::vector<const Polynomial *> polynomials;
+  for(size_t c = 0; c < dim; c++)
+    for(size_t r = 0; r <= c; r++)
+      for(size_t n = 0; n < vectorDim; ++n)
+        {
+          polynomials.push_back(&m.elt(r, c)[n]);
+        }
+  const El::Matrix<El::BigFloat> samples(
+    sample_polynomials(polynomials, m.sample_points, m.sample_scalings));
+
   int p = 0;
+  size_t row = 0;
   for(size_t c = 0; c < dim; c++)
     {
       for(size_t r = 0; r <= c; r++)
         {
           for(size_t k = 0; k < numSamples; k++)
             {
-              El::BigFloat x(m.sample_points.at(k));
-              El::BigFloat scale(m.sample_scalings.at(k));
-              constraint_constants[p] = scale * m.elt(r, c)[0](x);
+              constraint_constants[p] = samples.Get(row, k);
               for(size_t n = 1; n < vectorDim; ++n)
                 {
-                  constraint_matrix.Set(p, n - 1, -scale * m.elt(r, c)[n](x));
+                  constraint_matrix.Set(p, n - 1, -samples.Get(row + n, k));
                 }
               ++p;
             }
+          row += vectorDim;
         }
     }
 
@@ -74,14 +94,43 @@ Dual_Constraint_Group::Dual_Constraint_Group(const Polynomial_Vector_Matrix &m)
     delta1, numSamples, m.bilinear_basis, m.sample_points, m.sample_scalings);
 
   // For degree==0, the second block will have zero size.
-  const size_t delta2((degree + 1) / 2 - 1);
+  const size_t delta2((degree + 1) / 2 - 1), height2((degree + 1) / 2);
   // The \sqrt(x) factors can be accounted for by replacing the
-  // scale factors s_k with x_k s_k.
-  std::vector<El::BigFloat> scaled_samples;
-  for(size_t ii = 0; ii < m.sample_points.size(); ++ii)
+  // scale factors s_k with x_k s_k.  When the points and scalings are
+  // non-negative, \sqrt(x_k s_k) q_m(x_k) is just \sqrt(x_k) times
+  // the entries of the first block, since delta2 <= delta1.  That
+  // avoids evaluating the basis and taking the square roots of the
+  // scalings a second time.
+  const bool is_non_negative(
+    std::all_of(m.sample_points.begin(), m.sample_points.end(),
+                [](const El::BigFloat &x) { return x >= El::BigFloat(0); })
+    && std::all_of(m.sample_scalings.begin(), m.sample_scalings.end(),
+                   [](const El::BigFloat &s) {
+                     return s >= El::BigFloat(0);
+                   }));
+  if(is_non_negative)
     {
-      scaled_samples.emplace_back(m.sample_points[ii] * m.sample_scalings[ii]);
+      bilinear_bases[1].Resize(height2, numSamples);
+      for(size_t k = 0; k < numSamples; ++k)
+        {
+          const El::BigFloat sqrt_x(El::Sqrt(m.sample_points[k]));
+          for(size_t i = 0; i < height2; ++i)
+            {
+              bilinear_bases[1].Set(i, k,
+                                    sqrt_x * bilinear_bases[0].Get(i, k));
+            }
+        }
+    }
+  else
+    {
+      std::vector<El::BigFloat> scaled_samples;
+      for(size_t ii = 0; ii < m.sample_points.size(); ++ii)
+        {
+          scaled_samples.emplace_back(m.sample_points[ii]
+                                      * m.sample_scalings[ii]);
+        }
+      bilinear_bases[1]
+        = sample_bilinear_basis(delta2, numSamples, m.bilinear_basis,
+                                m.sample_points, scaled_samples);
     }
-  bilinear_bases[1] = sample_bilinear_basis(
-    delta2, numSamples, m.bilinear_basis, m.sample_points, scaled_samples);
 }
@@ -19,20 +19,28 @@
 
 #include "../../../Polynomial.hxx"
 
+El::Matrix<El::BigFloat>
+sample_polynomials(const std::vector<const Polynomial *> &polynomials,
+                   const std::vector<El::BigFloat> &samplePoints,
+                   const std::vector<El::BigFloat> &sampleScalings);
+
 El::Matrix<El::BigFloat>
 sample_bilinear_basis(const int maxDegree, const int numSamples,
                       const std::vector<Polynomial> &bilinearBasis,
                       const std::vector<El::BigFloat> &samplePoints,
                       const std::vector<El::BigFloat> &sampleScalings)
 {
-  El::Matrix<El::BigFloat> b(maxDegree + 1, numSamples);
+  std::vector<const Polynomial *> polynomials;
+  for(int i = 0; i <= maxDegree; i++)
+    {
+      polynomials.push_back(&bilinearBasis[i]);
+    }
+  std::vector<El::BigFloat> points(samplePoints.begin(),
+                                   samplePoints.begin() + numSamples),
+    scales;
   for(int k = 0; k < numSamples; k++)
     {
-      El::BigFloat x(samplePoints[k]), scale(Sqrt(sampleScalings[k]));
-      for(int i = 0; i <= maxDegree; i++)
-        {
-          b.Set(i, k, scale * bilinearBasis[i](x));
-        }
+      scales.push_back(Sqrt(sampleScalings[k]));
     }
-  return b;
+  return sample_polynomials(polynomials, points, scales);
 }
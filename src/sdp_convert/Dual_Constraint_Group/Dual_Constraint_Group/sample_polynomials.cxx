@@ -0,0 +1,60 @@
+// Given polynomials {p_0(x), ..., p_N(x)}, a list of points x_k and
+// scaling factors s_k, form the (N+1) x numSamples Matrix
+//
+//   result(i,k) = s_k p_i(x_k)
+//
+// All of the polynomials are evaluated at once as the product of the
+// matrix of coefficients with the scaled Vandermonde matrix
+//
+//   V(d,k) = s_k x_k^d
+//
+// so each power of each point is only computed once, and the
+// evaluation runs through a single Gemm instead of a separate Horner
+// loop for every polynomial and point.
+
+#include "../../../Polynomial.hxx"
+
+El::Matrix<El::BigFloat>
+sample_polynomials(const std::vector<const Polynomial *> &polynomials,
+                   const std::vector<El::BigFloat> &samplePoints,
+                   const std::vector<El::BigFloat> &sampleScalings)
+{
+  const int64_t numSamples(samplePoints.size());
+  El::Matrix<El::BigFloat> result(polynomials.size(), numSamples);
+  if(polynomials.empty() || numSamples == 0)
+    {
+      return result;
+    }
+
+  int64_t maxDegree(0);
+  for(auto &polynomial : polynomials)
+    {
+      maxDegree = std::max(maxDegree, polynomial->degree());
+    }
+
+  El::Matrix<El::BigFloat> coefficients;
+  El::Zeros(coefficients, polynomials.size(), maxDegree + 1);
+  for(size_t i = 0; i < polynomials.size(); ++i)
+    {
+      for(int64_t d = 0; d <= polynomials[i]->degree(); ++d)
+        {
+          coefficients.Set(i, d, polynomials[i]->coefficients[d]);
+        }
+    }
+
+  El::Matrix<El::BigFloat> vandermonde(maxDegree + 1, numSamples);
+  for(int64_t k = 0; k < numSamples; ++k)
+    {
+      El::BigFloat power(sampleScalings[k]);
+      vandermonde.Set(0, k, power);
+      for(int64_t d = 1; d <= maxDegree; ++d)
+        {
+          power *= samplePoints[k];
+          vandermonde.Set(d, k, power);
+        }
+    }
+
+  El::Gemm(El::NORMAL, El::NORMAL, El::BigFloat(1), coefficients,
+           vandermonde, El::BigFloat(0), result);
+  return result;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../Block_Cost.hxx"
+
+#include <El.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <functional>
+#include <vector>
+
+// Which ranks read each input file, and which rank converts each
+// matrix.  Every rank reads every file only to find the matrices that
+// it converts, so when there are at least as many files as ranks,
+// whole files are handed to ranks instead, balancing the total cost
+// of the matrices in each file.  Each file is then parsed by a single
+// rank.
+//
+// The quick first pass that estimates the costs is split across the
+// ranks by file, and the results are shared, so that every rank
+// agrees on the global numbering of the matrices.
+class Input_File_Plan
+{
+public:
+  using Scan_Function = std::function<void(const boost::filesystem::path &,
+                                           std::vector<Block_Cost> &)>;
+
+  // Collective.  input_files must not contain a .nsv list.  scan
+  // appends the costs of the matrices in a file.
+  Input_File_Plan(const std::vector<boost::filesystem::path> &input_files,
+                  const Scan_Function &scan);
+
+  // The index of the first matrix of each file, followed by the total
+  // number of matrices.
+  std::vector<size_t> file_offsets;
+  // The rank that converts each matrix
+  std::vector<int> block_owners;
+
+  bool is_read(const size_t &file) const
+  {
+    return file_owners.empty() || file_owners.at(file) == El::mpi::Rank();
+  }
+
+  // Collective.  values is from the file with the highest index (or
+  // -1 for none) that this rank read that had values.  Afterwards,
+  // every rank has the values from the last file that had any, which
+  // is what reading every file in order on every rank would give.
+  void share_last(const int64_t &file,
+                  std::vector<El::BigFloat> &values) const;
+
+private:
+  // Empty if every rank reads every file.
+  std::vector<int> file_owners;
+};
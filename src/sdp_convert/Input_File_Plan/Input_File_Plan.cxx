@@ -0,0 +1,79 @@
+#include "../Input_File_Plan.hxx"
+
+#include <numeric>
+
+std::vector<int> assign_block_owners(const std::vector<Block_Cost> &costs,
+                                     const int &num_procs);
+
+namespace
+{
+  void all_reduce_sum(std::vector<uint64_t> &values)
+  {
+    MPI_Allreduce(MPI_IN_PLACE, values.data(), values.size(), MPI_UINT64_T,
+                  MPI_SUM, El::mpi::COMM_WORLD.comm);
+  }
+}
+
+Input_File_Plan::Input_File_Plan(
+  const std::vector<boost::filesystem::path> &input_files,
+  const Scan_Function &scan)
+{
+  const int rank(El::mpi::Rank()),
+    num_procs(El::mpi::Size(El::mpi::COMM_WORLD));
+  const size_t num_files(input_files.size());
+
+  // Each rank scans every num_procs'th file.
+  std::vector<std::vector<Block_Cost>> file_costs(num_files);
+  std::vector<uint64_t> num_matrices(num_files, 0);
+  for(size_t file = rank; file < num_files; file += num_procs)
+    {
+      scan(input_files[file], file_costs[file]);
+      num_matrices[file] = file_costs[file].size();
+    }
+  all_reduce_sum(num_matrices);
+
+  file_offsets.resize(num_files + 1, 0);
+  for(size_t file = 0; file < num_files; ++file)
+    {
+      file_offsets[file + 1] = file_offsets[file] + num_matrices[file];
+    }
+
+  std::vector<uint64_t> costs(file_offsets.back(), 0);
+  for(size_t file = rank; file < num_files; file += num_procs)
+    {
+      for(size_t matrix = 0; matrix < file_costs[file].size(); ++matrix)
+        {
+          costs[file_offsets[file] + matrix] = file_costs[file][matrix].cost;
+        }
+    }
+  all_reduce_sum(costs);
+
+  if(num_procs > 1 && num_files >= size_t(num_procs))
+    {
+      std::vector<Block_Cost> file_totals;
+      for(size_t file = 0; file < num_files; ++file)
+        {
+          file_totals.emplace_back(
+            std::accumulate(costs.begin() + file_offsets[file],
+                            costs.begin() + file_offsets[file + 1],
+                            uint64_t(0)),
+            file);
+        }
+      file_owners = assign_block_owners(file_totals, num_procs);
+      block_owners.reserve(costs.size());
+      for(size_t file = 0; file < num_files; ++file)
+        {
+          block_owners.insert(block_owners.end(), num_matrices[file],
+                              file_owners[file]);
+        }
+    }
+  else
+    {
+      std::vector<Block_Cost> block_costs;
+      for(size_t index = 0; index < costs.size(); ++index)
+        {
+          block_costs.emplace_back(costs[index], index);
+        }
+      block_owners = assign_block_owners(block_costs, num_procs);
+    }
+}
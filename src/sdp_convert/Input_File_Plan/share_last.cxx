@@ -0,0 +1,33 @@
+#include "../Input_File_Plan.hxx"
+
+void Input_File_Plan::share_last(const int64_t &file,
+                                 std::vector<El::BigFloat> &values) const
+{
+  int64_t last_file(file);
+  MPI_Allreduce(MPI_IN_PLACE, &last_file, 1, MPI_INT64_T, MPI_MAX,
+                El::mpi::COMM_WORLD.comm);
+  if(last_file < 0 || file_owners.empty())
+    {
+      return;
+    }
+
+  // Send the values as serialized BigFloats.
+  const int root(file_owners.at(last_file));
+  const size_t serialized_size(El::BigFloat(0).SerializedSize());
+  int num_values(values.size());
+  El::mpi::Broadcast(num_values, root, El::mpi::COMM_WORLD);
+  std::vector<El::byte> buffer(num_values * serialized_size);
+  if(El::mpi::Rank() == root)
+    {
+      for(int index = 0; index < num_values; ++index)
+        {
+          values[index].Serialize(buffer.data() + index * serialized_size);
+        }
+    }
+  El::mpi::Broadcast(buffer.data(), buffer.size(), root, El::mpi::COMM_WORLD);
+  values.resize(num_values);
+  for(int index = 0; index < num_values; ++index)
+    {
+      values[index].Deserialize(buffer.data() + index * serialized_size);
+    }
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "Dual_Constraint_Group.hxx"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Writes the sdpb input files for the blocks of one rank, one block
+// at a time, so that a converter only has to hold a single
+// Dual_Constraint_Group in memory.  Only the sizes that go into
+// blocks.<rank> and the offsets for bilinear_bases_index.<rank> are
+// kept until finish().
+//
+// Every run also writes manifest.<rank>, with a hash of the input of
+// each block.  In incremental mode, a block whose hash matches the
+// manifest from the previous run in output_dir keeps its existing
+// files, and its bilinear bases are copied from the old
+// bilinear_bases.<rank>, so that only the blocks that changed are
+// converted again.
+//
+// Blocks often have the same bilinear bases.  Those are only stored
+// once in bilinear_bases.<rank>, and bilinear_bases_index.<rank>
+// points every block that uses them at the same place.
+//
+// Formatting a block as text takes about as long as converting it.
+// With max_queued_blocks > 0, a group that is moved into write() is
+// formatted and written on a background thread, while the converter
+// works on the next block.  write() waits while max_queued_blocks
+// groups are queued, which bounds the memory.
+//
+// With compress, the text files with numbers (free_var_matrix.*,
+// primal_objective_c.* and objectives) are written in the compressed
+// format of compressed_sdp_format.hxx.  The bilinear bases are small,
+// and stay plain text so that sdpb can seek to the offsets in
+// bilinear_bases_index.<rank>.
+class SDPB_Input_Writer
+{
+public:
+  // Enough to keep the background thread busy when the blocks take
+  // different amounts of time to convert
+  static constexpr size_t default_max_queued_blocks = 4;
+
+  // Collective in incremental mode.  num_blocks is the number of
+  // blocks that this rank will write.  compress only applies to the
+  // text format.
+  SDPB_Input_Writer(const boost::filesystem::path &output_dir,
+                    const int &rank, const size_t &num_blocks,
+                    const bool &binary, const bool &incremental = false,
+                    const size_t &max_queued_blocks = 0,
+                    const bool &compress = false);
+  ~SDPB_Input_Writer();
+  SDPB_Input_Writer(const SDPB_Input_Writer &) = delete;
+  SDPB_Input_Writer &operator=(const SDPB_Input_Writer &) = delete;
+
+  bool is_incremental() const { return incremental; }
+
+  // Write primal_objective_c.<index> and free_var_matrix.<index>, and
+  // append the bilinear bases of group to bilinear_bases.<rank>.
+  // input_hash is a Block_Hash of everything that the converter used
+  // to build group, or 0 if unknown.
+  void write(const size_t &index, const Dual_Constraint_Group &group,
+             const uint64_t &input_hash = 0);
+  // The same, but on the background thread if there is one.  Errors
+  // from the background thread are thrown by the next call to write(),
+  // write_unchanged() or finish().
+  void write(const size_t &index, Dual_Constraint_Group &&group,
+             const uint64_t &input_hash = 0);
+
+  // In incremental mode, if block index had input_hash in the
+  // previous run and its files are still there, reuse them and return
+  // true.  Otherwise the caller must write() the block.
+  bool write_unchanged(const size_t &index, const uint64_t &input_hash);
+
+  // Collective in incremental mode.  Write blocks.<rank>,
+  // bilinear_bases_index.<rank>, manifest.<rank> and, on rank 0,
+  // objectives.  Throws if the number of blocks written or their
+  // number of free variables do not match.
+  void finish(const int &num_procs, const El::BigFloat &objective_const,
+              const std::vector<El::BigFloat> &dual_objective_b);
+
+private:
+  boost::filesystem::path output_dir;
+  int rank;
+  size_t num_blocks;
+  bool binary, incremental, compress;
+
+  // In incremental mode, the bilinear bases are written to a
+  // temporary file and renamed in finish(), since other ranks may
+  // still be copying from the old one.
+  boost::filesystem::path bilinear_bases_path, bilinear_bases_temp_path;
+  boost::filesystem::ofstream bilinear_bases_stream;
+
+  // What blocks.<rank> and the manifest record about each block
+  struct Block_Entry
+  {
+    size_t index;
+    uint64_t hash;
+    size_t dimension, degree, schur_block_size, precision, num_free_vars;
+    std::array<size_t, 2> psd_matrix_block_sizes,
+      bilinear_pairing_block_sizes;
+    // Where the bilinear bases are in bilinear_bases.<rank>
+    int rank;
+    size_t begin, end;
+  };
+  std::vector<Block_Entry> blocks;
+  // The blocks from the previous run's manifest, by index
+  std::map<size_t, Block_Entry> previous_blocks;
+  // [begin, end) of the bilinear bases already in
+  // bilinear_bases.<rank>, by a Block_Hash of their text
+  std::multimap<uint64_t, std::array<size_t, 2>> stored_bilinear_bases;
+
+  // The background writer
+  struct Queued_Block
+  {
+    size_t index;
+    Dual_Constraint_Group group;
+    uint64_t input_hash;
+  };
+  size_t max_queued_blocks;
+  std::deque<Queued_Block> queue;
+  // Blocks that have been written, so that the caller can free them.
+  // With the limb pool, memory freed on the background thread would
+  // go to that thread's free lists, where the converter can not
+  // reuse it until the thread exits.
+  std::deque<Queued_Block> written;
+  // Whether the background thread is writing a block that is no
+  // longer in the queue, and whether it should exit
+  bool is_writing = false, is_stopping = false;
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::thread thread;
+  // Set by the background thread, checked by wait_until_written()
+  std::string error;
+
+  void write_block(const size_t &index, const Dual_Constraint_Group &group,
+                   const uint64_t &input_hash);
+  void write_queued_blocks();
+  void wait_until_written();
+  void stop_thread();
+
+  uint64_t full_hash(const uint64_t &input_hash) const;
+  void read_previous_manifest();
+  void write_manifest(const int &num_procs) const;
+  void append_bilinear_bases(const std::string &bases, Block_Entry &block);
+};
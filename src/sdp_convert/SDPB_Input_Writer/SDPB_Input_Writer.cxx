@@ -0,0 +1,59 @@
+#include "../SDPB_Input_Writer.hxx"
+#include "../Block_Hash.hxx"
+#include "../../set_stream_precision.hxx"
+
+SDPB_Input_Writer::SDPB_Input_Writer(
+  const boost::filesystem::path &Output_dir, const int &Rank,
+  const size_t &Num_blocks, const bool &Binary, const bool &Incremental,
+  const size_t &Max_queued_blocks, const bool &Compress)
+    : output_dir(Output_dir), rank(Rank), num_blocks(Num_blocks),
+      binary(Binary), incremental(Incremental), compress(Compress),
+      bilinear_bases_path(output_dir
+                          / ("bilinear_bases." + std::to_string(rank))),
+      bilinear_bases_temp_path(
+        incremental ? bilinear_bases_path.string() + ".new"
+                    : bilinear_bases_path),
+      max_queued_blocks(Max_queued_blocks)
+{
+  if(binary && compress)
+    {
+      throw std::runtime_error(
+        "Compressed output is only available for the text format");
+    }
+  boost::filesystem::create_directories(output_dir);
+  if(incremental)
+    {
+      read_previous_manifest();
+      // Every rank has to read the old manifests before any are
+      // removed.
+      El::mpi::Barrier(El::mpi::COMM_WORLD);
+    }
+  // The old manifest no longer describes the output once this run
+  // starts overwriting it, and a new one is only written by finish().
+  boost::filesystem::remove(output_dir
+                            / ("manifest." + std::to_string(rank)));
+
+  bilinear_bases_stream.open(bilinear_bases_temp_path);
+  set_stream_precision(bilinear_bases_stream);
+  bilinear_bases_stream << num_blocks << "\n";
+  blocks.reserve(num_blocks);
+  if(max_queued_blocks > 0)
+    {
+      thread = std::thread([this]() { write_queued_blocks(); });
+    }
+}
+
+// The hash of a block also covers the output settings.
+uint64_t SDPB_Input_Writer::full_hash(const uint64_t &input_hash) const
+{
+  Block_Hash hash;
+  hash.add(input_hash);
+  hash.add(uint64_t(binary));
+  // Only when set, so that the hashes of existing output stay the same.
+  if(compress)
+    {
+      hash.add(uint64_t(compress));
+    }
+  hash.add(uint64_t(El::gmp::Precision()));
+  return hash.value();
+}
@@ -0,0 +1,55 @@
+#include "../SDPB_Input_Writer.hxx"
+#include "../Block_Hash.hxx"
+
+// Set [block.begin, block.end) to where the text of a block's bilinear
+// bases is in bilinear_bases.<rank>, appending it only if the same
+// text is not already there.  Equal hashes are checked against the
+// bytes in the file, so a collision can never mix up two blocks.
+void SDPB_Input_Writer::append_bilinear_bases(const std::string &bases,
+                                              Block_Entry &block)
+{
+  Block_Hash hash;
+  hash.add(bases.data(), bases.size());
+  auto candidates(stored_bilinear_bases.equal_range(hash.value()));
+  if(candidates.first != candidates.second)
+    {
+      bilinear_bases_stream.flush();
+      boost::filesystem::ifstream input(bilinear_bases_temp_path,
+                                        std::ios::binary);
+      std::string stored;
+      for(auto candidate(candidates.first); candidate != candidates.second;
+          ++candidate)
+        {
+          const std::array<size_t, 2> &extent(candidate->second);
+          if(extent[1] - extent[0] != bases.size())
+            {
+              continue;
+            }
+          stored.resize(bases.size());
+          input.seekg(extent[0]);
+          input.read(&stored[0], stored.size());
+          if(!input.good())
+            {
+              throw std::runtime_error("Error when reading from: "
+                                       + bilinear_bases_temp_path.string());
+            }
+          if(stored == bases)
+            {
+              block.begin = extent[0];
+              block.end = extent[1];
+              return;
+            }
+        }
+    }
+
+  block.begin = bilinear_bases_stream.tellp();
+  bilinear_bases_stream.write(bases.data(), bases.size());
+  block.end = bilinear_bases_stream.tellp();
+  if(!bilinear_bases_stream.good())
+    {
+      throw std::runtime_error("Error when writing to: "
+                               + bilinear_bases_temp_path.string());
+    }
+  stored_bilinear_bases.emplace(hash.value(),
+                                std::array<size_t, 2>{block.begin, block.end});
+}
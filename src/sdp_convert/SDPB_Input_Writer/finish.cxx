@@ -0,0 +1,113 @@
+#include "../SDPB_Input_Writer.hxx"
+#include "../write_vector.hxx"
+
+#include <algorithm>
+
+void write_objectives(const boost::filesystem::path &output_dir,
+                      const El::BigFloat &objective_const,
+                      const std::vector<El::BigFloat> &dual_objective_b,
+                      const bool &compress);
+
+void SDPB_Input_Writer::finish(
+  const int &num_procs, const El::BigFloat &objective_const,
+  const std::vector<El::BigFloat> &dual_objective_b)
+{
+  wait_until_written();
+  stop_thread();
+  if(blocks.size() != num_blocks)
+    {
+      throw std::runtime_error(
+        "Expected to write " + std::to_string(num_blocks)
+        + " blocks on rank " + std::to_string(rank) + ", but wrote "
+        + std::to_string(blocks.size()));
+    }
+  for(auto &block : blocks)
+    {
+      if(block.num_free_vars != dual_objective_b.size())
+        {
+          throw std::runtime_error(
+            "Block " + std::to_string(block.index) + " has "
+            + std::to_string(block.num_free_vars)
+            + " free variables, but the objective has "
+            + std::to_string(dual_objective_b.size()));
+        }
+    }
+
+  if(rank == 0)
+    {
+      write_objectives(output_dir, objective_const, dual_objective_b,
+                       compress);
+    }
+
+  std::vector<size_t> bilinear_bases_offsets;
+  for(auto &block : blocks)
+    {
+      bilinear_bases_offsets.push_back(block.begin);
+    }
+  bilinear_bases_offsets.push_back(bilinear_bases_stream.tellp());
+  bilinear_bases_stream.close();
+  if(!bilinear_bases_stream.good())
+    {
+      throw std::runtime_error("Error when writing to: "
+                               + bilinear_bases_temp_path.string());
+    }
+  if(incremental)
+    {
+      // Wait until every rank has copied what it needs from the old
+      // bilinear_bases files.
+      El::mpi::Barrier(El::mpi::COMM_WORLD);
+      boost::filesystem::rename(bilinear_bases_temp_path,
+                                bilinear_bases_path);
+    }
+  const boost::filesystem::path index_path(
+    output_dir / ("bilinear_bases_index." + std::to_string(rank)));
+  boost::filesystem::ofstream index_stream(index_path);
+  write_vector(index_stream, bilinear_bases_offsets);
+  if(!index_stream.good())
+    {
+      throw std::runtime_error("Error when writing to: "
+                               + index_path.string());
+    }
+
+  std::vector<size_t> indices, dimensions, degrees, schur_block_sizes,
+    psd_matrix_block_sizes, bilinear_pairing_block_sizes, precisions;
+  for(auto &block : blocks)
+    {
+      indices.push_back(block.index);
+      dimensions.push_back(block.dimension);
+      degrees.push_back(block.degree);
+      schur_block_sizes.push_back(block.schur_block_size);
+      precisions.push_back(block.precision);
+      for(size_t parity = 0; parity < 2; ++parity)
+        {
+          psd_matrix_block_sizes.push_back(
+            block.psd_matrix_block_sizes[parity]);
+          bilinear_pairing_block_sizes.push_back(
+            block.bilinear_pairing_block_sizes[parity]);
+        }
+    }
+  const boost::filesystem::path output_path(
+    output_dir / ("blocks." + std::to_string(rank)));
+  boost::filesystem::ofstream output_stream(output_path);
+  output_stream << num_procs << "\n";
+  write_vector(output_stream, indices);
+  write_vector(output_stream, dimensions);
+  write_vector(output_stream, degrees);
+  write_vector(output_stream, schur_block_sizes);
+  write_vector(output_stream, psd_matrix_block_sizes);
+  write_vector(output_stream, bilinear_pairing_block_sizes);
+  // Optional, so that files without per-block precisions stay the same.
+  if(std::any_of(precisions.begin(), precisions.end(),
+                 [](const size_t &precision) { return precision != 0; }))
+    {
+      write_vector(output_stream, precisions);
+    }
+  if(!output_stream.good())
+    {
+      throw std::runtime_error("Error when writing to: "
+                               + output_path.string());
+    }
+
+  // Last, so that the manifest only describes complete output.
+  write_manifest(num_procs);
+}
@@ -0,0 +1,79 @@
+#include "../SDPB_Input_Writer.hxx"
+
+#include <algorithm>
+
+// manifest.<rank> is a text file with the number of ranks, the number
+// of blocks, and then one line for each block:
+//
+//   index hash dimension degree schur_block_size precision
+//   num_free_vars psd_block_size_0 psd_block_size_1
+//   bilinear_pairing_block_size_0 bilinear_pairing_block_size_1
+//   begin end
+//
+// where [begin, end) is where its bilinear bases are in
+// bilinear_bases.<rank>.  A hash of 0 is never reused.
+
+void SDPB_Input_Writer::read_previous_manifest()
+{
+  // If any manifest is missing or unreadable, nothing is reused.
+  int num_procs(0);
+  for(int manifest_rank = 0; manifest_rank < std::max(num_procs, 1);
+      ++manifest_rank)
+    {
+      boost::filesystem::ifstream input(
+        output_dir / ("manifest." + std::to_string(manifest_rank)));
+      int manifest_num_procs;
+      size_t num_entries;
+      input >> manifest_num_procs >> num_entries;
+      if(!input.good()
+         || (manifest_rank > 0 && manifest_num_procs != num_procs))
+        {
+          previous_blocks.clear();
+          return;
+        }
+      num_procs = manifest_num_procs;
+      for(size_t entry = 0; entry < num_entries; ++entry)
+        {
+          Block_Entry block;
+          input >> block.index >> block.hash >> block.dimension
+            >> block.degree >> block.schur_block_size >> block.precision
+            >> block.num_free_vars >> block.psd_matrix_block_sizes[0]
+            >> block.psd_matrix_block_sizes[1]
+            >> block.bilinear_pairing_block_sizes[0]
+            >> block.bilinear_pairing_block_sizes[1] >> block.begin
+            >> block.end;
+          if(input.fail())
+            {
+              previous_blocks.clear();
+              return;
+            }
+          block.rank = manifest_rank;
+          previous_blocks.emplace(block.index, block);
+        }
+    }
+}
+
+void SDPB_Input_Writer::write_manifest(const int &num_procs) const
+{
+  const boost::filesystem::path output_path(
+    output_dir / ("manifest." + std::to_string(rank)));
+  boost::filesystem::ofstream output_stream(output_path);
+  output_stream << num_procs << "\n" << blocks.size() << "\n";
+  for(auto &block : blocks)
+    {
+      output_stream << block.index << " " << block.hash << " "
+                    << block.dimension << " " << block.degree << " "
+                    << block.schur_block_size << " " << block.precision
+                    << " " << block.num_free_vars << " "
+                    << block.psd_matrix_block_sizes[0] << " "
+                    << block.psd_matrix_block_sizes[1] << " "
+                    << block.bilinear_pairing_block_sizes[0] << " "
+                    << block.bilinear_pairing_block_sizes[1] << " "
+                    << block.begin << " " << block.end << "\n";
+    }
+  if(!output_stream.good())
+    {
+      throw std::runtime_error("Error when writing to: "
+                               + output_path.string());
+    }
+}
@@ -0,0 +1,74 @@
+#include "../SDPB_Input_Writer.hxx"
+
+#include <sstream>
+
+void write_primal_objective_c(const boost::filesystem::path &output_dir,
+                              const size_t &index,
+                              const Dual_Constraint_Group &group,
+                              const bool &binary, const bool &compress);
+
+void write_free_var_matrix(const boost::filesystem::path &output_dir,
+                           const size_t &index,
+                           const Dual_Constraint_Group &group,
+                           const bool &binary, const bool &compress);
+
+void SDPB_Input_Writer::write(const size_t &index,
+                              const Dual_Constraint_Group &group,
+                              const uint64_t &input_hash)
+{
+  // Keep the blocks in order
+  wait_until_written();
+  write_block(index, group, input_hash);
+}
+
+void SDPB_Input_Writer::write_block(const size_t &index,
+                                    const Dual_Constraint_Group &group,
+                                    const uint64_t &input_hash)
+{
+  write_primal_objective_c(output_dir, index, group, binary, compress);
+  write_free_var_matrix(output_dir, index, group, binary, compress);
+
+  // bilinear_bases.<rank> holds the bases of every block on this rank.
+  // The offset of each block is saved for bilinear_bases_index.<rank>,
+  // so that sdpb can seek straight to the blocks that it needs.
+  std::ostringstream bases;
+  bases.precision(bilinear_bases_stream.precision());
+  for(auto &basis : group.bilinear_bases)
+    {
+      // Ensure that each bilinearBasis is sampled the correct number
+      // of times
+      assert(static_cast<size_t>(basis.Width()) == group.degree + 1);
+      bases << basis.Height() << " " << basis.Width() << "\n";
+      for(int64_t row = 0; row < basis.Height(); ++row)
+        for(int64_t column = 0; column < basis.Width(); ++column)
+          {
+            bases << basis(row, column) << "\n";
+          }
+    }
+  Block_Entry block;
+  append_bilinear_bases(bases.str(), block);
+
+  block.index = index;
+  block.hash = input_hash == 0 ? 0 : full_hash(input_hash);
+  block.dimension = group.dim;
+  block.degree = group.degree;
+  block.precision = group.precision;
+  block.num_free_vars = group.constraint_matrix.Width();
+  block.schur_block_size
+    = (group.dim * (group.dim + 1) / 2) * (group.degree + 1);
+
+  // sdp.bilinear_bases is the concatenation of the g.bilinear_bases.
+  // The matrix Y is a BlockDiagonalMatrix built from the
+  // concatenation of the blocks for each individual
+  // Dual_Constraint_Group.  sdp.blocks[j] = {b1, b2, ... } contains
+  // the indices for the blocks of Y corresponding to the j-th
+  // group.
+  for(size_t parity = 0; parity < group.bilinear_bases.size(); ++parity)
+    {
+      auto &basis(group.bilinear_bases[parity]);
+      block.psd_matrix_block_sizes[parity] = basis.Height() * group.dim;
+      block.bilinear_pairing_block_sizes[parity] = basis.Width() * group.dim;
+    }
+  block.rank = rank;
+  blocks.push_back(block);
+}
@@ -0,0 +1,106 @@
+#include "../SDPB_Input_Writer.hxx"
+
+// The background writer.  The queue, written, is_writing, is_stopping
+// and error are guarded by mutex.  The background thread only touches
+// the rest of the writer's state in write_block(), and the caller
+// waits for it with wait_until_written() before touching that state
+// itself.
+
+SDPB_Input_Writer::~SDPB_Input_Writer() { stop_thread(); }
+
+void SDPB_Input_Writer::write(const size_t &index,
+                              Dual_Constraint_Group &&group,
+                              const uint64_t &input_hash)
+{
+  if(!thread.joinable())
+    {
+      write_block(index, group, input_hash);
+      return;
+    }
+  std::deque<Queued_Block> finished;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [this]() {
+      return queue.size() < max_queued_blocks || !error.empty();
+    });
+    if(!error.empty())
+      {
+        throw std::runtime_error(error);
+      }
+    queue.push_back({index, std::move(group), input_hash});
+    std::swap(finished, written);
+  }
+  condition.notify_all();
+  // finished is freed here, on the converter's thread
+}
+
+void SDPB_Input_Writer::write_queued_blocks()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  while(true)
+    {
+      condition.wait(lock,
+                     [this]() { return is_stopping || !queue.empty(); });
+      if(is_stopping)
+        {
+          return;
+        }
+      Queued_Block &block(queue.front());
+      is_writing = true;
+      lock.unlock();
+      std::string block_error;
+      try
+        {
+          write_block(block.index, block.group, block.input_hash);
+        }
+      catch(std::exception &e)
+        {
+          block_error = e.what();
+        }
+      lock.lock();
+      // Only this thread removes blocks from the queue, so block is
+      // still at the front.
+      written.push_back(std::move(queue.front()));
+      queue.pop_front();
+      is_writing = false;
+      if(!block_error.empty())
+        {
+          error = block_error;
+          queue.clear();
+        }
+      condition.notify_all();
+      if(!error.empty())
+        {
+          return;
+        }
+    }
+}
+
+void SDPB_Input_Writer::wait_until_written()
+{
+  if(!thread.joinable())
+    {
+      return;
+    }
+  std::unique_lock<std::mutex> lock(mutex);
+  condition.wait(lock, [this]() { return queue.empty() && !is_writing; });
+  written.clear();
+  if(!error.empty())
+    {
+      throw std::runtime_error(error);
+    }
+}
+
+void SDPB_Input_Writer::stop_thread()
+{
+  if(!thread.joinable())
+    {
+      return;
+    }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    is_stopping = true;
+  }
+  condition.notify_all();
+  thread.join();
+}
@@ -0,0 +1,48 @@
+#include "../SDPB_Input_Writer.hxx"
+
+bool SDPB_Input_Writer::write_unchanged(const size_t &index,
+                                        const uint64_t &input_hash)
+{
+  if(!incremental || input_hash == 0)
+    {
+      return false;
+    }
+  auto previous(previous_blocks.find(index));
+  if(previous == previous_blocks.end()
+     || previous->second.hash != full_hash(input_hash))
+    {
+      return false;
+    }
+  const boost::filesystem::path previous_bilinear_bases_path(
+    output_dir
+    / ("bilinear_bases." + std::to_string(previous->second.rank)));
+  const std::string suffix("." + std::to_string(index));
+  if(!boost::filesystem::exists(output_dir / ("primal_objective_c" + suffix))
+     || !boost::filesystem::exists(output_dir / ("free_var_matrix" + suffix))
+     || !boost::filesystem::exists(previous_bilinear_bases_path))
+    {
+      return false;
+    }
+
+  // Keep the blocks in order
+  wait_until_written();
+
+  // primal_objective_c.<index> and free_var_matrix.<index> are left as
+  // they are, and the bilinear bases are copied verbatim.
+  Block_Entry block(previous->second);
+  const size_t size(block.end - block.begin);
+  std::string bytes(size, '\0');
+  boost::filesystem::ifstream input(previous_bilinear_bases_path,
+                                    std::ios::binary);
+  input.seekg(block.begin);
+  input.read(&bytes[0], size);
+  if(!input.good())
+    {
+      throw std::runtime_error("Error when reading from: "
+                               + previous_bilinear_bases_path.string());
+    }
+  append_bilinear_bases(bytes, block);
+  block.rank = rank;
+  blocks.push_back(block);
+  return true;
+}
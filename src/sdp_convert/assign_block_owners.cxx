@@ -0,0 +1,51 @@
+#include "../Block_Cost.hxx"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+// Converting a block samples each of its polynomials at degree+1
+// points, and computes its bilinear bases from integrals over its
+// poles, so the cost grows as (degree+1)^2 times the number of
+// polynomials and poles.
+size_t block_conversion_cost(const size_t &num_polynomials,
+                             const size_t &degree, const size_t &num_poles)
+{
+  return (degree + 1) * (degree + 1) * (num_polynomials + num_poles + 1);
+}
+
+// The rank that converts each block.  Blocks are handed out largest
+// first, each to the rank with the least total cost so far (the
+// longest processing time heuristic).  Ties are broken by block index
+// and rank, so every rank computes the same assignment.
+std::vector<int> assign_block_owners(const std::vector<Block_Cost> &costs,
+                                     const int &num_procs)
+{
+  std::vector<Block_Cost> sorted_costs(costs);
+  std::stable_sort(sorted_costs.begin(), sorted_costs.end(),
+                   [](const Block_Cost &a, const Block_Cost &b) {
+                     return b < a;
+                   });
+
+  // (total cost, rank), smallest first
+  std::priority_queue<std::pair<size_t, int>,
+                      std::vector<std::pair<size_t, int>>,
+                      std::greater<std::pair<size_t, int>>>
+    loads;
+  for(int rank = 0; rank < num_procs; ++rank)
+    {
+      loads.emplace(0, rank);
+    }
+
+  std::vector<int> result(costs.size());
+  for(auto &block_cost : sorted_costs)
+    {
+      auto load(loads.top());
+      loads.pop();
+      result.at(block_cost.index) = load.second;
+      load.first += block_cost.cost;
+      loads.push(load);
+    }
+  return result;
+}
@@ -0,0 +1,31 @@
+#include <boost/filesystem.hpp>
+
+#include <vector>
+
+std::vector<boost::filesystem::path>
+read_file_list(const boost::filesystem::path &filename);
+
+std::vector<boost::filesystem::path>
+flatten_input_files(const std::vector<boost::filesystem::path> &input_files)
+{
+  std::vector<boost::filesystem::path> result;
+  for(auto &input_file : input_files)
+    {
+      if(input_file.empty())
+        {
+          continue;
+        }
+      if(input_file.extension() == ".nsv")
+        {
+          for(auto &file : flatten_input_files(read_file_list(input_file)))
+            {
+              result.push_back(file);
+            }
+        }
+      else
+        {
+          result.push_back(input_file);
+        }
+    }
+  return result;
+}
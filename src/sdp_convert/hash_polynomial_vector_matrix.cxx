@@ -0,0 +1,38 @@
+#include "Polynomial_Vector_Matrix.hxx"
+#include "Block_Hash.hxx"
+
+// A Block_Hash of everything that goes into the Dual_Constraint_Group
+// of m, including the shapes, so that reshaping m changes the hash.
+uint64_t hash_polynomial_vector_matrix(const Polynomial_Vector_Matrix &m)
+{
+  Block_Hash hash;
+  auto add_polynomials([&](const std::vector<Polynomial> &polynomials) {
+    hash.add(uint64_t(polynomials.size()));
+    for(auto &polynomial : polynomials)
+      {
+        hash.add(uint64_t(polynomial.coefficients.size()));
+        for(auto &coefficient : polynomial.coefficients)
+          {
+            hash.add(coefficient);
+          }
+      }
+  });
+  auto add_vector([&](const std::vector<El::BigFloat> &vector) {
+    hash.add(uint64_t(vector.size()));
+    for(auto &element : vector)
+      {
+        hash.add(element);
+      }
+  });
+
+  hash.add(uint64_t(m.rows));
+  hash.add(uint64_t(m.cols));
+  for(auto &element : m.elements)
+    {
+      add_polynomials(element);
+    }
+  add_vector(m.sample_points);
+  add_vector(m.sample_scalings);
+  add_polynomials(m.bilinear_basis);
+  return hash.value();
+}
@@ -0,0 +1,48 @@
+#include "Dual_Constraint_Group.hxx"
+#include "../In_Memory_SDP.hxx"
+#include "../binary_sdp_format.hxx"
+
+#include <sstream>
+
+// The same sizes as SDPB_Input_Writer::write() puts in blocks.<rank>,
+// and the same bytes as the binary primal_objective_c.<index>,
+// free_var_matrix.<index> and the two bilinear bases.
+In_Memory_Block
+to_in_memory_block(const size_t &index, const Dual_Constraint_Group &group)
+{
+  In_Memory_Block block;
+  block.index = index;
+  block.dimension = group.dim;
+  block.degree = group.degree;
+  block.precision = group.precision;
+  block.schur_block_size
+    = (group.dim * (group.dim + 1) / 2) * (group.degree + 1);
+  for(size_t parity = 0; parity < group.bilinear_bases.size(); ++parity)
+    {
+      auto &basis(group.bilinear_bases[parity]);
+      block.psd_matrix_block_sizes[parity] = basis.Height() * group.dim;
+      block.bilinear_pairing_block_sizes[parity] = basis.Width() * group.dim;
+    }
+
+  const uint32_t num_limbs(binary_sdp_num_limbs());
+  std::ostringstream stream(std::ios::out | std::ios::binary);
+  write_binary_sdp_header(stream, group.constraint_constants.size(), 1);
+  for(auto &element : group.constraint_constants)
+    {
+      write_binary_sdp_element(stream, element, num_limbs);
+    }
+  for(auto matrix : {&group.constraint_matrix, &group.bilinear_bases[0],
+                     &group.bilinear_bases[1]})
+    {
+      write_binary_sdp_header(stream, matrix->Height(), matrix->Width());
+      for(int64_t row = 0; row < matrix->Height(); ++row)
+        for(int64_t column = 0; column < matrix->Width(); ++column)
+          {
+            write_binary_sdp_element(stream, (*matrix)(row, column),
+                                     num_limbs);
+          }
+    }
+  const std::string bytes(stream.str());
+  block.data.assign(bytes.begin(), bytes.end());
+  return block;
+}
@@ -1,34 +1,46 @@
 #include "Dual_Constraint_Group.hxx"
 #include "write_vector.hxx"
 #include "../set_stream_precision.hxx"
+#include "../binary_sdp_format.hxx"
+#include "../compressed_sdp_format.hxx"
 
-void write_free_var_matrix(
-  const boost::filesystem::path &output_dir,
-  const std::vector<size_t> &indices, const size_t &dual_objectives_b_size,
-  const std::vector<Dual_Constraint_Group> &dual_constraint_groups)
+void write_free_var_matrix(const boost::filesystem::path &output_dir,
+                           const size_t &index,
+                           const Dual_Constraint_Group &group,
+                           const bool &binary, const bool &compress)
 {
-  auto block_index(indices.begin());
+  const size_t block_size(group.constraint_matrix.Height()),
+    num_free_vars(group.constraint_matrix.Width());
 
-  for(auto &group : dual_constraint_groups)
+  const boost::filesystem::path output_path(
+    output_dir / ("free_var_matrix." + std::to_string(index)));
+  // Never compressed with binary (see SDPB_Input_Writer)
+  SDP_Output_Stream output_stream(output_path, compress);
+  if(binary)
+    {
+      write_binary_sdp_header(output_stream, block_size, num_free_vars);
+      const uint32_t num_limbs(binary_sdp_num_limbs());
+      for(size_t row = 0; row < block_size; ++row)
+        for(size_t column = 0; column < num_free_vars; ++column)
+          {
+            write_binary_sdp_element(
+              output_stream, group.constraint_matrix(row, column), num_limbs);
+          }
+    }
+  else
     {
-      size_t block_size(group.constraint_matrix.Height());
-
-      const boost::filesystem::path output_path(
-        output_dir / ("free_var_matrix." + std::to_string(*block_index)));
-      boost::filesystem::ofstream output_stream(output_path);
       set_stream_precision(output_stream);
-
-      output_stream << block_size << " " << dual_objectives_b_size << "\n";
+      output_stream << block_size << " " << num_free_vars << "\n";
       for(size_t row = 0; row < block_size; ++row)
-        for(size_t column = 0; column < dual_objectives_b_size; ++column)
+        for(size_t column = 0; column < num_free_vars; ++column)
           {
             output_stream << group.constraint_matrix(row, column) << "\n";
           }
-      if(!output_stream.good())
-        {
-          throw std::runtime_error("Error when writing to: "
-                                   + output_path.string());
-        }
-      ++block_index;
+    }
+  output_stream.flush();
+  if(!output_stream.good())
+    {
+      throw std::runtime_error("Error when writing to: "
+                               + output_path.string());
     }
 }
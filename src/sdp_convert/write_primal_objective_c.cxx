@@ -1,29 +1,40 @@
 #include "Dual_Constraint_Group.hxx"
 #include "write_vector.hxx"
 #include "../set_stream_precision.hxx"
+#include "../binary_sdp_format.hxx"
+#include "../compressed_sdp_format.hxx"
 
-void write_primal_objective_c(
-  const boost::filesystem::path &output_dir,
-  const std::vector<size_t> &indices,
-  const std::vector<Dual_Constraint_Group> &dual_constraint_groups)
+void write_primal_objective_c(const boost::filesystem::path &output_dir,
+                              const size_t &index,
+                              const Dual_Constraint_Group &group,
+                              const bool &binary, const bool &compress)
 {
-  auto block_index(indices.begin());
+  assert(static_cast<size_t>(group.constraint_matrix.Height())
+         == group.constraint_constants.size());
 
-  for(auto &group : dual_constraint_groups)
+  const boost::filesystem::path output_path(
+    output_dir / ("primal_objective_c." + std::to_string(index)));
+  // Never compressed with binary (see SDPB_Input_Writer)
+  SDP_Output_Stream output_stream(output_path, compress);
+  if(binary)
     {
-      assert(static_cast<size_t>(group.constraint_matrix.Height())
-             == group.constraint_constants.size());
-
-      const boost::filesystem::path output_path(
-        output_dir / ("primal_objective_c." + std::to_string(*block_index)));
-      boost::filesystem::ofstream output_stream(output_path);
-      set_stream_precision(output_stream);
-      write_vector(output_stream, group.constraint_constants);
-      if(!output_stream.good())
+      write_binary_sdp_header(output_stream,
+                              group.constraint_constants.size(), 1);
+      const uint32_t num_limbs(binary_sdp_num_limbs());
+      for(auto &element : group.constraint_constants)
         {
-          throw std::runtime_error("Error when writing to: "
-                                   + output_path.string());
+          write_binary_sdp_element(output_stream, element, num_limbs);
         }
-      ++block_index;
+    }
+  else
+    {
+      set_stream_precision(output_stream);
+      write_vector(output_stream, group.constraint_constants);
+    }
+  output_stream.flush();
+  if(!output_stream.good())
+    {
+      throw std::runtime_error("Error when writing to: "
+                               + output_path.string());
     }
 }
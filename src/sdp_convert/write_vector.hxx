@@ -2,10 +2,11 @@
 
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
+#include <ostream>
 #include <vector>
 
 template<typename T>
-void write_vector(boost::filesystem::ofstream &output_stream,
+void write_vector(std::ostream &output_stream,
                   const std::vector<T> &v)
 {
   output_stream << v.size() << "\n";
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <boost/filesystem.hpp>
+
+#include <array>
+#include <cstdint>
+#include <map>
+
+// Costs of blocks observed in earlier runs, shared between SDPs with
+// blocks of the same shapes.  The cost of a block depends on little
+// more than its dimension m_j, its degree d_j, the number of free
+// variables N, the precision of the block and the number of
+// processes it is spread over, so costs are kept separately for each
+// of those.  Costs have the units of block_timings, and are the mean
+// of all of the observations of a key.
+//
+// Each line of a database file is
+//
+//   dim degree num_free_variables precision grid_size cost count
+class Block_Cost_Database
+{
+public:
+  // Key: dim, degree, num_free_variables, precision, grid size
+  using Key = std::array<int64_t, 5>;
+  struct Entry
+  {
+    double cost = 0;
+    int64_t count = 0;
+  };
+  std::map<Key, Entry> entries;
+
+  // Add the entries of a file written by write().  A missing file is
+  // not an error.
+  void read(const boost::filesystem::path &path);
+  // Write to a temporary file and rename it, so that other jobs never
+  // read a partial file.  Jobs that add to the same file at the same
+  // time can lose each other's observations, but never corrupt it.
+  void write(const boost::filesystem::path &path) const;
+
+  void add(const Key &key, const double &cost);
+  // The cost of a block with the first four entries of key, for any
+  // grid size.  Costs in block_timings are summed over the processes
+  // of a block, so they depend only weakly on the grid size, and the
+  // grid size with the most observations is used.  Returns nullptr if
+  // there is none.
+  const Entry *find(const int64_t &dim, const int64_t &degree,
+                    const int64_t &num_free_variables,
+                    const int64_t &precision) const;
+};
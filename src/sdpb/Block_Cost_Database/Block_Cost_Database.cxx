@@ -0,0 +1,98 @@
+#include "../Block_Cost_Database.hxx"
+
+#include <boost/filesystem/fstream.hpp>
+
+#include <unistd.h>
+
+#include <limits>
+
+void Block_Cost_Database::read(const boost::filesystem::path &path)
+{
+  if(path.empty() || !boost::filesystem::exists(path))
+    {
+      return;
+    }
+  boost::filesystem::ifstream stream(path);
+  Key key;
+  Entry entry;
+  while(stream >> key[0] >> key[1] >> key[2] >> key[3] >> key[4]
+        >> entry.cost >> entry.count)
+    {
+      if(entry.count <= 0 || entry.cost < 0)
+        {
+          throw std::runtime_error("Invalid entry in block cost database "
+                                   + path.string());
+        }
+      auto existing(entries.find(key));
+      if(existing == entries.end())
+        {
+          entries[key] = entry;
+        }
+      else
+        {
+          const int64_t count(existing->second.count + entry.count);
+          existing->second.cost
+            = (existing->second.cost * existing->second.count
+               + entry.cost * entry.count)
+              / count;
+          existing->second.count = count;
+        }
+    }
+  if(!stream.eof())
+    {
+      throw std::runtime_error("Error when reading block cost database "
+                               + path.string());
+    }
+}
+
+void Block_Cost_Database::write(const boost::filesystem::path &path) const
+{
+  const boost::filesystem::path temp_path(path.string() + ".tmp."
+                                          + std::to_string(getpid()));
+  {
+    boost::filesystem::ofstream stream(temp_path);
+    stream.precision(std::numeric_limits<double>::max_digits10);
+    for(auto &entry : entries)
+      {
+        for(auto &element : entry.first)
+          {
+            stream << element << ' ';
+          }
+        stream << entry.second.cost << ' ' << entry.second.count << '\n';
+      }
+    if(!stream.good())
+      {
+        throw std::runtime_error("Error when writing block cost database "
+                                 + temp_path.string());
+      }
+  }
+  boost::filesystem::rename(temp_path, path);
+}
+
+void Block_Cost_Database::add(const Key &key, const double &cost)
+{
+  Entry &entry(entries[key]);
+  entry.cost = (entry.cost * entry.count + cost) / (entry.count + 1);
+  ++entry.count;
+}
+
+const Block_Cost_Database::Entry *
+Block_Cost_Database::find(const int64_t &dim, const int64_t &degree,
+                          const int64_t &num_free_variables,
+                          const int64_t &precision) const
+{
+  const Entry *result(nullptr);
+  for(auto entry(entries.lower_bound(
+        {dim, degree, num_free_variables, precision, 0}));
+      entry != entries.end() && entry->first[0] == dim
+      && entry->first[1] == degree && entry->first[2] == num_free_variables
+      && entry->first[3] == precision;
+      ++entry)
+    {
+      if(result == nullptr || entry->second.count > result->count)
+        {
+          result = &entry->second;
+        }
+    }
+  return result;
+}
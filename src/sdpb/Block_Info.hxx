@@ -3,6 +3,7 @@
 #include "read_vector.hxx"
 #include "Verbosity.hxx"
 #include "../Block_Cost.hxx"
+#include "../In_Memory_SDP.hxx"
 
 #include <El.hpp>
 #include <boost/filesystem.hpp>
@@ -39,10 +40,10 @@ struct MPI_Group_Wrapper
   }
 };
 
-class Block_Info
+// The block structure of an SDP, as read from its blocks.* and
+// objectives files.
+struct Block_Structure
 {
-public:
-  boost::filesystem::path block_timings_filename;
   size_t file_num_procs;
   std::vector<std::vector<size_t>> file_block_indices;
 
@@ -62,27 +63,89 @@ public:
     // (0 <= b < bMax)
     bilinear_pairing_block_sizes;
 
+  // The precision in bits for the block-local kernels of each block,
+  // or 0 for the precision of the solver.  Optional in blocks.*.
+  std::vector<size_t> block_precisions;
+
+  // N, the length of b
+  size_t num_free_variables;
+
+  Block_Structure() = default;
+  explicit Block_Structure(const boost::filesystem::path &sdp_directory)
+  {
+    read_block_info(sdp_directory);
+  }
+  // Collective.  Rank 0 reads the files and broadcasts them.
+  void read_block_info(const boost::filesystem::path &sdp_directory);
+  // Collective.  The same as read_block_info(), but for an SDP whose
+  // blocks are spread over the ranks in memory.  Each rank stands in
+  // for one blocks.* file.
+  void gather_block_info(const In_Memory_SDP &sdp);
+
+  // The precision for block j, which is never more than the current
+  // precision of the solver.
+  mp_bitcnt_t block_precision(const size_t &block_index) const
+  {
+    const mp_bitcnt_t precision(mpf_get_default_prec());
+    return (block_precisions[block_index] == 0
+              ? precision
+              : std::min(mp_bitcnt_t(block_precisions[block_index]),
+                         precision));
+  }
+
+  // Whether the matrices of the two SDPs have the same sizes, so that
+  // a mapping of blocks to ranks for one also works for the other.
+  // How the blocks are split between files and their precisions do not
+  // matter.
+  bool is_same_structure(const Block_Structure &other) const
+  {
+    return dimensions == other.dimensions && degrees == other.degrees
+           && schur_block_sizes == other.schur_block_sizes
+           && psd_matrix_block_sizes == other.psd_matrix_block_sizes
+           && bilinear_pairing_block_sizes
+                == other.bilinear_pairing_block_sizes
+           && num_free_variables == other.num_free_variables;
+  }
+};
+
+class Block_Info : public Block_Structure
+{
+public:
+  boost::filesystem::path block_timings_filename;
+  // Whether the costs of the blocks came from a Block_Cost_Database
+  bool has_database_costs = false;
+
   std::vector<size_t> block_indices;
   MPI_Group_Wrapper mpi_group;
   MPI_Comm_Wrapper mpi_comm;
 
   Block_Info() = delete;
+  // If in_memory_sdp is set, the block structure comes from it instead
+  // of from sdp_directory.  block_cost_database is used if there is no
+  // block_timings file.
   Block_Info(const boost::filesystem::path &sdp_directory,
              const boost::filesystem::path &checkpoint_in,
              const size_t &procs_per_node, const size_t &proc_granularity,
-             const Verbosity &verbosity);
+             const size_t &memory_per_node, const Verbosity &verbosity,
+             const In_Memory_SDP *in_memory_sdp = nullptr,
+             const boost::filesystem::path &block_cost_database = {});
   Block_Info(const boost::filesystem::path &sdp_directory,
              const El::Matrix<int32_t> &block_timings,
              const size_t &procs_per_node, const size_t &proc_granularity,
-             const Verbosity &verbosity);
-  void read_block_info(const boost::filesystem::path &sdp_directory);
+             const size_t &memory_per_node, const Verbosity &verbosity,
+             const In_Memory_SDP *in_memory_sdp = nullptr);
   std::vector<Block_Cost>
   read_block_costs(const boost::filesystem::path &sdp_directory,
-                   const boost::filesystem::path &checkpoint_in);
+                   const boost::filesystem::path &checkpoint_in,
+                   const boost::filesystem::path &block_cost_database);
+  std::vector<Block_Cost> estimate_block_costs();
+  size_t block_memory(const size_t &block) const;
+  size_t group_memory() const;
+  int grid_height() const;
   void
   allocate_blocks(const std::vector<Block_Cost> &block_costs,
                   const size_t &procs_per_node, const size_t &proc_granularity,
-                  const Verbosity &verbosity);
+                  const size_t &memory_per_node, const Verbosity &verbosity);
 };
 
 namespace std
@@ -99,6 +162,7 @@ namespace std
   inline void swap(Block_Info &a, Block_Info &b)
   {
     swap(a.block_timings_filename, b.block_timings_filename);
+    swap(a.has_database_costs, b.has_database_costs);
     swap(a.file_num_procs, b.file_num_procs);
     swap(a.file_block_indices, b.file_block_indices);
     swap(a.dimensions, b.dimensions);
@@ -106,6 +170,7 @@ namespace std
     swap(a.schur_block_sizes, b.schur_block_sizes);
     swap(a.psd_matrix_block_sizes, b.psd_matrix_block_sizes);
     swap(a.bilinear_pairing_block_sizes, b.bilinear_pairing_block_sizes);
+    swap(a.num_free_variables, b.num_free_variables);
     swap(a.block_indices, b.block_indices);
     swap(a.mpi_group, b.mpi_group);
     swap(a.mpi_comm, b.mpi_comm);
@@ -1,16 +1,57 @@
 #include "../Block_Info.hxx"
 
 #include "../../compute_block_grid_mapping.hxx"
+#include "../solver_comm.hxx"
+
+namespace
+{
+  // The mapping assumes that ranks [n*procs_per_node,
+  // (n+1)*procs_per_node) share a node.  Check that against the
+  // shared memory domains that MPI reports.
+  bool ranks_match_nodes(const size_t &procs_per_node)
+  {
+    const int rank(El::mpi::Rank(solver_comm()));
+    MPI_Comm shared_comm;
+    if(MPI_Comm_split_type(solver_comm().comm, MPI_COMM_TYPE_SHARED,
+                           rank, MPI_INFO_NULL, &shared_comm)
+       != MPI_SUCCESS)
+      {
+        return true;
+      }
+    // Label each physical node by its lowest rank.
+    int node_label(rank);
+    MPI_Allreduce(MPI_IN_PLACE, &node_label, 1, MPI_INT, MPI_MIN,
+                  shared_comm);
+    MPI_Comm_free(&shared_comm);
+
+    El::mpi::Comm assumed_node_comm;
+    El::mpi::Split(solver_comm(), rank / procs_per_node, rank,
+                   assumed_node_comm);
+    const int min_label(
+      El::mpi::AllReduce(node_label, El::mpi::MIN, assumed_node_comm)),
+      max_label(
+        El::mpi::AllReduce(node_label, El::mpi::MAX, assumed_node_comm));
+    El::mpi::Free(assumed_node_comm);
+    return El::mpi::AllReduce(int(min_label == max_label), El::mpi::MIN,
+                              solver_comm())
+           == 1;
+  }
+}
 
 void Block_Info::allocate_blocks(const std::vector<Block_Cost> &block_costs,
                                  const size_t &procs_per_node,
                                  const size_t &proc_granularity,
+                                 const size_t &memory_per_node,
                                  const Verbosity &verbosity)
 {
   // Reverse sort, with largest first
   std::vector<Block_Cost> sorted_costs(block_costs);
   std::sort(sorted_costs.rbegin(), sorted_costs.rend());
-  const size_t num_procs(El::mpi::Size(El::mpi::COMM_WORLD));
+  for(auto &block_cost : sorted_costs)
+    {
+      block_cost.memory = block_memory(block_cost.index);
+    }
+  const size_t num_procs(El::mpi::Size(solver_comm()));
   if(num_procs % procs_per_node != 0)
     {
       throw std::runtime_error(
@@ -28,9 +69,24 @@ void Block_Info::allocate_blocks(const std::vector<Block_Cost> &block_costs,
         + std::to_string(procs_per_node)
         + "\n\tprocGranularity: " + std::to_string(proc_granularity));
     }
+  if(!ranks_match_nodes(procs_per_node)
+     && El::mpi::Rank(solver_comm()) == 0)
+    {
+      std::cerr << "Warning: MPI ranks are not placed in contiguous blocks "
+                   "of procsPerNode="
+                << procs_per_node
+                << " per node, so some block groups will span nodes.  "
+                   "Launch SDPB with ranks filled node by node (e.g. "
+                   "'mpirun --map-by core' or 'srun "
+                   "--distribution=block').\n"
+                << std::flush;
+    }
   const size_t num_nodes(num_procs / procs_per_node);
   std::vector<std::vector<Block_Map>> mapping(compute_block_grid_mapping(
-    procs_per_node / proc_granularity, num_nodes, sorted_costs));
+    procs_per_node / proc_granularity, num_nodes, memory_per_node,
+    group_memory(), sorted_costs));
+  refine_block_grid_mapping(memory_per_node, group_memory(), sorted_costs,
+                            mapping);
 
   for(auto &block_vector : mapping)
     for(auto &block_map : block_vector)
@@ -40,9 +96,16 @@ void Block_Info::allocate_blocks(const std::vector<Block_Cost> &block_costs,
 
   // Create an mpi::Group for each set of processors.
   El::mpi::Group default_mpi_group;
-  El::mpi::CommGroup(El::mpi::COMM_WORLD, default_mpi_group);
+  El::mpi::CommGroup(solver_comm(), default_mpi_group);
+
+  int rank(El::mpi::Rank(solver_comm()));
 
-  int rank(El::mpi::Rank(El::mpi::COMM_WORLD));
+  std::vector<size_t> node_memory(mapping.size(), 0);
+  for(size_t node = 0; node < mapping.size(); ++node)
+    for(auto &block_map : mapping[node])
+      {
+        node_memory[node] += block_map.memory;
+      }
 
   if(verbosity >= Verbosity::regular && rank == 0)
     {
@@ -67,10 +130,28 @@ void Block_Info::allocate_blocks(const std::vector<Block_Cost> &block_costs,
                 }
               ss << "}\n";
             }
-          ss << "\n";
+          ss << "Predicted memory: "
+             << node_memory[node] / (1024.0 * 1024 * 1024) << " GiB\n\n";
         }
       El::Output(ss.str());
     }
+  if(rank == 0)
+    {
+      for(size_t node = 0; node < mapping.size(); ++node)
+        {
+          if(memory_per_node != 0 && node_memory[node] > memory_per_node)
+            {
+              std::stringstream ss;
+              ss << "Warning: The predicted memory on node " << node << ", "
+                 << node_memory[node] / (1024.0 * 1024 * 1024)
+                 << " GiB, is more than memoryPerNode, "
+                 << memory_per_node / (1024.0 * 1024 * 1024)
+                 << " GiB.  Consider using more nodes or a larger "
+                    "procGranularity.\n";
+              std::cerr << ss.str() << std::flush;
+            }
+        }
+    }
 
   int rank_begin(0), rank_end(0);
   for(auto &block_vector : mapping)
@@ -108,5 +189,5 @@ void Block_Info::allocate_blocks(const std::vector<Block_Cost> &block_costs,
     El::mpi::Incl(default_mpi_group, group_ranks.size(), group_ranks.data(),
                   mpi_group.value);
   }
-  El::mpi::Create(El::mpi::COMM_WORLD, mpi_group.value, mpi_comm.value);
+  El::mpi::Create(solver_comm(), mpi_group.value, mpi_comm.value);
 }
@@ -0,0 +1,142 @@
+#include "../Block_Info.hxx"
+#include "../solver_comm.hxx"
+
+#include <array>
+#include <chrono>
+#include <limits>
+#include <map>
+
+// Estimate the cost of each block from the number of operations in
+// the most expensive parts of an iteration:
+//
+//   the Schur complement and the bilinear pairings (like Gemm),
+//   the Cholesky decompositions of the Schur complement, X and Y,
+//   the triangular solve and syrk that build Q (like Gemm),
+//   the eigenvalue computations for the step lengths.
+//
+// The time per operation of each kind of kernel is measured with a
+// short benchmark at the current precision, and averaged over all
+// ranks so that every rank computes the same block mapping.  Costs
+// are in microseconds per iteration, so they can be compared with the
+// timings in a block_timings file.
+//
+// Blocks with a lower precision compute the bilinear pairings, the
+// products in the Schur complement and the Cholesky factors of X and
+// Y at that precision, so those parts of their cost use a benchmark
+// at the block's precision.
+
+namespace
+{
+  template <typename F> double min_seconds(const F &f)
+  {
+    double result(std::numeric_limits<double>::max());
+    for(size_t repeat = 0; repeat < 3; ++repeat)
+      {
+        const auto start(std::chrono::high_resolution_clock::now());
+        f();
+        result = std::min(
+          result, std::chrono::duration<double>(
+                    std::chrono::high_resolution_clock::now() - start)
+                    .count());
+      }
+    return result;
+  }
+
+  // Seconds per multiply-add for Gemm, Cholesky and HermitianEig.
+  std::array<double, 3> benchmark_kernels()
+  {
+    const El::Int n(32);
+    El::Matrix<El::BigFloat> positive(n, n), work, eigenvalues;
+    for(El::Int row = 0; row < n; ++row)
+      for(El::Int column = 0; column < n; ++column)
+        {
+          positive(row, column)
+            = El::BigFloat(1) / El::BigFloat(int(1 + row + column))
+              + (row == column ? El::BigFloat(int(n)) : El::BigFloat(0));
+        }
+    const double cube(double(n) * n * n);
+
+    std::array<double, 3> result;
+    El::Zeros(work, n, n);
+    result[0] = min_seconds([&]() {
+                  El::Gemm(El::NORMAL, El::NORMAL, El::BigFloat(1), positive,
+                           positive, El::BigFloat(0), work);
+                })
+                / cube;
+    result[1] = min_seconds([&]() {
+                  work = positive;
+                  El::Cholesky(El::UpperOrLowerNS::LOWER, work);
+                })
+                / (cube / 3);
+    El::HermitianEigCtrl<El::BigFloat> hermitian_eig_ctrl;
+    // See min_eigenvalue()
+    hermitian_eig_ctrl.tridiagEigCtrl.dcCtrl.cutoff = n / 2 + 1;
+    result[2] = min_seconds([&]() {
+                  work = positive;
+                  El::HermitianEig(El::UpperOrLowerNS::LOWER, work,
+                                   eigenvalues, hermitian_eig_ctrl);
+                })
+                / (4 * cube / 3);
+
+    El::mpi::AllReduce(result.data(), result.size(), El::mpi::SUM,
+                       solver_comm());
+    for(auto &seconds : result)
+      {
+        seconds /= El::mpi::Size(solver_comm());
+      }
+    return result;
+  }
+}
+
+std::vector<Block_Cost>
+Block_Info::estimate_block_costs()
+{
+  // Every rank has the same block precisions, so they all run the
+  // same benchmarks in the same order.
+  const mp_bitcnt_t precision(mpf_get_default_prec());
+  const int solver_precision(El::gmp::Precision());
+  std::map<mp_bitcnt_t, std::array<double, 3>> seconds_per_operation;
+  seconds_per_operation.emplace(precision, benchmark_kernels());
+  for(size_t block = 0; block < schur_block_sizes.size(); ++block)
+    {
+      const mp_bitcnt_t local_precision(block_precision(block));
+      if(seconds_per_operation.find(local_precision)
+         == seconds_per_operation.end())
+        {
+          El::gmp::SetPrecision(local_precision);
+          seconds_per_operation.emplace(local_precision,
+                                        benchmark_kernels());
+          El::gmp::SetPrecision(solver_precision);
+        }
+    }
+  const std::array<double, 3> &full(seconds_per_operation.at(precision));
+  const double N(num_free_variables);
+
+  std::vector<Block_Cost> result;
+  for(size_t block = 0; block < schur_block_sizes.size(); ++block)
+    {
+      const std::array<double, 3> &local(
+        seconds_per_operation.at(block_precision(block)));
+      const double P(schur_block_sizes[block]);
+      // L^{-1} B, the syrk for Q and the Cholesky decomposition of the
+      // Schur complement are at the full precision, and the entries of
+      // the Schur complement at the block's precision.
+      double gemm(P * P * N / 2 + P * N * N / 2), local_gemm(8 * P * P),
+        cholesky(P * P * P / 3), local_cholesky(0), eig(0);
+      for(size_t parity = 0; parity < 2; ++parity)
+        {
+          const double R(psd_matrix_block_sizes[2 * block + parity]),
+            K(bilinear_pairing_block_sizes[2 * block + parity]);
+          // Bilinear pairings with X^{-1} and Y, Cholesky of X and Y,
+          // and the primal and dual step lengths.
+          local_gemm += 2 * R * K * (R + K);
+          local_cholesky += 2 * R * R * R / 3;
+          eig += 2 * 4 * R * R * R / 3;
+        }
+      const double seconds(
+        gemm * full[0] + cholesky * full[1] + eig * full[2]
+        + local_gemm * local[0] + local_cholesky * local[1]);
+      result.emplace_back(size_t(seconds * 1e6), block);
+    }
+  return result;
+}
@@ -0,0 +1,43 @@
+#include "../Block_Info.hxx"
+
+// Rough estimates of the memory used by the solver, in bytes, at the
+// current precision.  They count the largest matrices, with the
+// number of copies that the solver keeps during a step.
+
+namespace
+{
+  size_t bytes_per_element()
+  {
+    return sizeof(El::BigFloat) + El::BigFloat(0).SerializedSize();
+  }
+}
+
+// The memory for a block, summed over all of the ranks that share it:
+//
+//   S and its Cholesky decomposition, which share storage,
+//   the free variable matrix B and L^{-1} B,
+//   about twelve copies of the blocks of X and Y (X, Y, their
+//     Cholesky decompositions, the residues, the search directions,
+//     X Y and PrimalResidues Y, and temporaries),
+//   the bilinear pairings with X^{-1} and Y, and two workspaces of
+//     the size of the bilinear bases,
+//   a few vectors of length P.
+size_t Block_Info::block_memory(const size_t &block) const
+{
+  const size_t P(schur_block_sizes[block]), N(num_free_variables);
+  size_t elements(P * P + 2 * P * N + 4 * P);
+  for(size_t parity = 0; parity < 2; ++parity)
+    {
+      const size_t R(psd_matrix_block_sizes[2 * block + parity]),
+        K(bilinear_pairing_block_sizes[2 * block + parity]);
+      elements += 12 * R * R + 2 * K * K + 2 * R * K;
+    }
+  return elements * bytes_per_element();
+}
+
+// The memory that every group of ranks needs regardless of its
+// blocks: its contribution Q_group to the N x N matrix Q.
+size_t Block_Info::group_memory() const
+{
+  return num_free_variables * num_free_variables * bytes_per_element();
+}
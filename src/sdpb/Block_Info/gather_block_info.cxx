@@ -0,0 +1,74 @@
+#include "../Block_Info.hxx"
+#include "../solver_comm.hxx"
+
+// Every rank sends the sizes of its blocks to every other rank, as
+// if each rank had written a blocks.* file.
+void Block_Structure::gather_block_info(const In_Memory_SDP &sdp)
+{
+  const size_t num_fields(9);
+  std::vector<uint64_t> local;
+  local.reserve(num_fields * sdp.blocks.size());
+  for(auto &block : sdp.blocks)
+    {
+      local.insert(local.end(),
+                   {block.index, block.dimension, block.degree,
+                    block.schur_block_size, block.precision,
+                    block.psd_matrix_block_sizes[0],
+                    block.psd_matrix_block_sizes[1],
+                    block.bilinear_pairing_block_sizes[0],
+                    block.bilinear_pairing_block_sizes[1]});
+    }
+
+  const int num_procs(El::mpi::Size(solver_comm()));
+  int local_size(local.size());
+  std::vector<int> sizes(num_procs), offsets(num_procs, 0);
+  MPI_Allgather(&local_size, 1, MPI_INT, sizes.data(), 1, MPI_INT,
+                solver_comm().comm);
+  for(int rank = 1; rank < num_procs; ++rank)
+    {
+      offsets[rank] = offsets[rank - 1] + sizes[rank - 1];
+    }
+  std::vector<uint64_t> all(offsets.back() + sizes.back());
+  MPI_Allgatherv(local.data(), local_size, MPI_UINT64_T, all.data(),
+                 sizes.data(), offsets.data(), MPI_UINT64_T,
+                 solver_comm().comm);
+
+  const size_t num_blocks(all.size() / num_fields);
+  file_num_procs = num_procs;
+  file_block_indices.assign(num_procs, {});
+  dimensions.assign(num_blocks, 0);
+  degrees.assign(num_blocks, 0);
+  schur_block_sizes.assign(num_blocks, 0);
+  block_precisions.assign(num_blocks, 0);
+  psd_matrix_block_sizes.assign(2 * num_blocks, 0);
+  bilinear_pairing_block_sizes.assign(2 * num_blocks, 0);
+  std::vector<bool> is_found(num_blocks, false);
+  for(int rank = 0; rank < num_procs; ++rank)
+    {
+      for(int field = offsets[rank]; field < offsets[rank] + sizes[rank];
+          field += num_fields)
+        {
+          const uint64_t *entry(all.data() + field);
+          const size_t index(entry[0]);
+          if(index >= num_blocks || is_found[index])
+            {
+              throw std::runtime_error(
+                "Invalid or repeated block index in the SDP: "
+                + std::to_string(index));
+            }
+          is_found[index] = true;
+          file_block_indices[rank].push_back(index);
+          dimensions[index] = entry[1];
+          degrees[index] = entry[2];
+          schur_block_sizes[index] = entry[3];
+          block_precisions[index] = entry[4];
+          for(size_t parity = 0; parity < 2; ++parity)
+            {
+              psd_matrix_block_sizes[2 * index + parity] = entry[5 + parity];
+              bilinear_pairing_block_sizes[2 * index + parity]
+                = entry[7 + parity];
+            }
+        }
+    }
+  num_free_variables = sdp.dual_objective_b.size();
+}
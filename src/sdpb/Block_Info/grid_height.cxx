@@ -0,0 +1,52 @@
+#include "../Block_Info.hxx"
+
+// Choose the height of the process grid for this group.  Elemental's
+// default is the largest divisor of the group size that is at most
+// its square root, which is the best shape for square matrices.  Each
+// block also has the P x N matrix B, which is solved against the
+// Cholesky factor and then used in Syrk to form Q.  For a r x c grid,
+// the communication volume per process is roughly
+//
+//   Cholesky of the Schur complement: P^2 (1/r + 1/c)
+//   Trsm of B:                        P^2/r + P N/c
+//   Syrk of B:                        P N (1/r + 1/c)
+//
+// where P is the size of the Schur complement block.  We pick the
+// divisor with the smallest total over the blocks in the group, and
+// keep the default if nothing is better.
+
+int Block_Info::grid_height() const
+{
+  const int num_procs(El::mpi::Size(mpi_comm.value));
+  int default_height(std::sqrt(num_procs));
+  while(num_procs % default_height != 0)
+    {
+      --default_height;
+    }
+  if(num_procs == 1)
+    {
+      return default_height;
+    }
+
+  double square(0), rectangular(0);
+  for(auto &block_index : block_indices)
+    {
+      const double P(schur_block_sizes.at(block_index));
+      square += P * P;
+      rectangular += P * num_free_variables;
+    }
+  auto volume = [&](const int &height) {
+    const double r(height), c(num_procs / height);
+    return square * (2 / r + 1 / c) + rectangular * (1 / r + 2 / c);
+  };
+
+  int result(default_height);
+  for(int height = 1; height <= num_procs; ++height)
+    {
+      if(num_procs % height == 0 && volume(height) < volume(result))
+        {
+          result = height;
+        }
+    }
+  return result;
+}
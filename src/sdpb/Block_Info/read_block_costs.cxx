@@ -1,16 +1,23 @@
 #include "../Block_Info.hxx"
+#include "../Block_Cost_Database.hxx"
+#include "../solver_comm.hxx"
 
 #include <boost/filesystem/fstream.hpp>
 
-std::vector<Block_Cost>
-Block_Info::read_block_costs(const boost::filesystem::path &sdp_directory,
-                             const boost::filesystem::path &checkpoint_in)
+#include <cmath>
+
+std::vector<Block_Cost> Block_Info::read_block_costs(
+  const boost::filesystem::path &sdp_directory,
+  const boost::filesystem::path &checkpoint_in,
+  const boost::filesystem::path &block_cost_database)
 {
   const boost::filesystem::path sdp_block_timings_path(sdp_directory
                                                        / "block_timings"),
     checkpoint_block_timings_path(checkpoint_in / "block_timings");
 
-  if(exists(checkpoint_in / ("checkpoint." + std::to_string(El::mpi::Rank()))))
+  if(exists(checkpoint_in
+            / ("checkpoint."
+               + std::to_string(El::mpi::Rank(solver_comm())))))
     {
       if(exists(checkpoint_block_timings_path))
         {
@@ -48,13 +55,58 @@ Block_Info::read_block_costs(const boost::filesystem::path &sdp_directory,
     }
   else
     {
-      // If no information, assign a cost proportional to the matrix
-      // size.  This should balance out memory use when doing a timing
-      // run.
-      for(size_t block = 0; block < schur_block_sizes.size(); ++block)
+      // Costs measured for blocks of the same shapes in earlier runs,
+      // if there are costs for every block.  Other jobs may replace
+      // the database at any time, so only the root reads it, and
+      // every rank gets the same costs.
+      if(!block_cost_database.empty())
+        {
+          std::vector<int64_t> costs;
+          if(El::mpi::Rank(solver_comm()) == 0)
+            {
+              try
+                {
+                  Block_Cost_Database database;
+                  database.read(block_cost_database);
+                  for(size_t index = 0; index < dimensions.size(); ++index)
+                    {
+                      const Block_Cost_Database::Entry *entry(
+                        database.find(dimensions[index], degrees[index],
+                                      num_free_variables,
+                                      block_precision(index)));
+                      if(entry == nullptr)
+                        {
+                          costs.clear();
+                          break;
+                        }
+                      costs.push_back(std::lround(entry->cost));
+                    }
+                }
+              catch(std::exception &e)
+                {
+                  std::cerr << "Ignoring the block cost database: "
+                            << e.what() << "\n"
+                            << std::flush;
+                  costs.clear();
+                }
+            }
+          int64_t num_costs(costs.size());
+          MPI_Bcast(&num_costs, 1, MPI_INT64_T, 0, solver_comm().comm);
+          costs.resize(num_costs);
+          MPI_Bcast(costs.data(), num_costs, MPI_INT64_T, 0,
+                    solver_comm().comm);
+          for(size_t index = 0; index < costs.size(); ++index)
+            {
+              result.emplace_back(costs[index], index);
+            }
+        }
+      has_database_costs = !result.empty();
+      // If no information, estimate the cost from the sizes of the
+      // blocks.  This is good enough to skip the timing run in many
+      // cases, and otherwise gives the timing run a better mapping.
+      if(!has_database_costs)
         {
-          result.emplace_back(
-            schur_block_sizes[block] * schur_block_sizes[block], block);
+          result = estimate_block_costs();
         }
     }
   return result;
@@ -1,13 +1,15 @@
 #include "../Block_Info.hxx"
 
 #include "../../compute_block_grid_mapping.hxx"
+#include "../solver_comm.hxx"
+#include "../../compressed_sdp_format.hxx"
 
-#include <boost/filesystem/fstream.hpp>
+#include <array>
 
 namespace
 {
   void
-  read_vector_with_index(std::ifstream &input_stream,
+  read_vector_with_index(std::istream &input_stream,
                          const std::vector<size_t> &indices,
                          const size_t &index_scale, std::vector<size_t> &v)
   {
@@ -24,39 +26,143 @@ namespace
         v[mapped_index] = file_v[index];
       }
   }
+
+  // Only called on rank 0
+  void read_block_files(const boost::filesystem::path &sdp_directory,
+                        Block_Structure &structure)
+  {
+    size_t file_rank(0);
+    do
+      {
+        const boost::filesystem::path block_path(
+          sdp_directory / ("blocks." + std::to_string(file_rank)));
+        SDP_Input_Stream block_stream(block_path);
+        if(!block_stream.good())
+          {
+            throw std::runtime_error("Could not open '" + block_path.string()
+                                     + "'");
+          }
+        block_stream >> structure.file_num_procs;
+        if(!block_stream.good())
+          {
+            throw std::runtime_error("Corrupted file: " + block_path.string());
+          }
+        structure.file_block_indices.emplace_back();
+        auto &file_block_index(structure.file_block_indices.back());
+        read_vector(block_stream, file_block_index);
+
+        read_vector_with_index(block_stream, file_block_index, 1,
+                               structure.dimensions);
+        read_vector_with_index(block_stream, file_block_index, 1,
+                               structure.degrees);
+        read_vector_with_index(block_stream, file_block_index, 1,
+                               structure.schur_block_sizes);
+        read_vector_with_index(block_stream, file_block_index, 2,
+                               structure.psd_matrix_block_sizes);
+        read_vector_with_index(block_stream, file_block_index, 2,
+                               structure.bilinear_pairing_block_sizes);
+        block_stream >> std::ws;
+        if(!block_stream.eof())
+          {
+            read_vector_with_index(block_stream, file_block_index, 1,
+                                   structure.block_precisions);
+          }
+        ++file_rank;
+      }
+    while(file_rank < structure.file_num_procs);
+    structure.block_precisions.resize(structure.dimensions.size(), 0);
+
+    // Only the length of b is needed.  The rest of the objectives is
+    // read with the SDP.
+    const boost::filesystem::path objectives_path(sdp_directory
+                                                  / "objectives");
+    SDP_Input_Stream objectives_stream(objectives_path);
+    std::string objective_const;
+    objectives_stream >> objective_const >> structure.num_free_variables;
+    if(!objectives_stream.good())
+      {
+        throw std::runtime_error("Could not read the number of free "
+                                 "variables from '"
+                                 + objectives_path.string() + "'");
+      }
+  }
+
+  void pack_vector(const std::vector<size_t> &v, std::vector<uint64_t> &packed)
+  {
+    packed.push_back(v.size());
+    packed.insert(packed.end(), v.begin(), v.end());
+  }
+
+  void unpack_vector(const uint64_t *&current, std::vector<size_t> &v)
+  {
+    v.assign(current + 1, current + 1 + *current);
+    current += 1 + *current;
+  }
 }
 
-void Block_Info::read_block_info(const boost::filesystem::path &sdp_directory)
+// Collective.  Only rank 0 opens the blocks.* and objectives files,
+// and broadcasts what it read.  With thousands of ranks, every rank
+// opening every file swamps the metadata servers of parallel file
+// systems at startup.
+void Block_Structure::read_block_info(
+  const boost::filesystem::path &sdp_directory)
 {
-  size_t file_rank(0);
-  do
+  std::vector<uint64_t> packed;
+  std::string error;
+  if(El::mpi::Rank(solver_comm()) == 0)
     {
-      const boost::filesystem::path block_path(
-        sdp_directory / ("blocks." + std::to_string(file_rank)));
-      boost::filesystem::ifstream block_stream(block_path);
-      if(!block_stream.good())
+      try
         {
-          throw std::runtime_error("Could not open '" + block_path.string()
-                                   + "'");
+          read_block_files(sdp_directory, *this);
+          packed.insert(packed.end(), {file_num_procs, num_free_variables,
+                                       file_block_indices.size()});
+          for(auto &file_block_index : file_block_indices)
+            {
+              pack_vector(file_block_index, packed);
+            }
+          for(auto v : {&dimensions, &degrees, &schur_block_sizes,
+                        &psd_matrix_block_sizes,
+                        &bilinear_pairing_block_sizes, &block_precisions})
+            {
+              pack_vector(*v, packed);
+            }
         }
-      block_stream >> file_num_procs;
-      if(!block_stream.good())
+      catch(std::exception &e)
         {
-          throw std::runtime_error("Corrupted file: " + block_path.string());
+          error = e.what();
         }
-      file_block_indices.emplace_back();
-      auto &file_block_index(file_block_indices.back());
-      read_vector(block_stream, file_block_index);
-
-      read_vector_with_index(block_stream, file_block_index, 1, dimensions);
-      read_vector_with_index(block_stream, file_block_index, 1, degrees);
-      read_vector_with_index(block_stream, file_block_index, 1,
-                             schur_block_sizes);
-      read_vector_with_index(block_stream, file_block_index, 2,
-                             psd_matrix_block_sizes);
-      read_vector_with_index(block_stream, file_block_index, 2,
-                             bilinear_pairing_block_sizes);
-      ++file_rank;
     }
-  while(file_rank < file_num_procs);
+
+  std::array<uint64_t, 2> sizes({{packed.size(), error.size()}});
+  MPI_Bcast(sizes.data(), sizes.size(), MPI_UINT64_T, 0,
+            solver_comm().comm);
+  if(sizes[1] != 0)
+    {
+      error.resize(sizes[1]);
+      MPI_Bcast(&error[0], sizes[1], MPI_CHAR, 0, solver_comm().comm);
+      throw std::runtime_error(error);
+    }
+  packed.resize(sizes[0]);
+  MPI_Bcast(packed.data(), packed.size(), MPI_UINT64_T, 0,
+            solver_comm().comm);
+  if(El::mpi::Rank(solver_comm()) == 0)
+    {
+      return;
+    }
+
+  const uint64_t *current(packed.data());
+  file_num_procs = current[0];
+  num_free_variables = current[1];
+  file_block_indices.resize(current[2]);
+  current += 3;
+  for(auto &file_block_index : file_block_indices)
+    {
+      unpack_vector(current, file_block_index);
+    }
+  for(auto v : {&dimensions, &degrees, &schur_block_sizes,
+                &psd_matrix_block_sizes, &bilinear_pairing_block_sizes,
+                &block_precisions})
+    {
+      unpack_vector(current, *v);
+    }
 }
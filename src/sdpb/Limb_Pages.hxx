@@ -0,0 +1,55 @@
+#pragma once
+
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+// The pages that the limb pool's arenas are backed by.
+//
+// normal: Ordinary pages.  The limbs are allocated with malloc, unless
+//         numaLocalLimbs asks for arenas.
+//
+// transparent: Arenas that are advised to be backed by transparent
+//              huge pages.
+//
+// huge: Arenas on explicit huge pages (MAP_HUGETLB), which must have
+//       been reserved by the system administrator.  If none are
+//       available, the arenas fall back to transparent huge pages.
+
+enum class Limb_Pages
+{
+  normal,
+  transparent,
+  huge
+};
+
+inline Limb_Pages to_limb_pages(const std::string &name)
+{
+  if(name == "normal")
+    {
+      return Limb_Pages::normal;
+    }
+  else if(name == "transparent")
+    {
+      return Limb_Pages::transparent;
+    }
+  else if(name == "huge")
+    {
+      return Limb_Pages::huge;
+    }
+  throw std::runtime_error("Invalid argument for limbPages.  "
+                           "Expected 'normal', 'transparent' or 'huge', "
+                           "but found: "
+                           + name);
+}
+
+inline std::ostream &operator<<(std::ostream &os, const Limb_Pages &pages)
+{
+  switch(pages)
+    {
+    case Limb_Pages::normal: os << "normal"; break;
+    case Limb_Pages::transparent: os << "transparent"; break;
+    case Limb_Pages::huge: os << "huge"; break;
+    }
+  return os;
+}
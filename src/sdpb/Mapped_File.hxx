@@ -0,0 +1,58 @@
+#pragma once
+
+// A read only memory map of a whole file.  Pages are only read from
+// disk when they are touched, so a process that only needs part of a
+// large file only reads that part.
+
+#include <boost/filesystem.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stdexcept>
+
+struct Mapped_File
+{
+  const char *data = nullptr;
+  size_t size = 0;
+
+  explicit Mapped_File(const boost::filesystem::path &path)
+  {
+    const int file_descriptor(open(path.c_str(), O_RDONLY));
+    if(file_descriptor == -1)
+      {
+        throw std::runtime_error("Could not open '" + path.string() + "'");
+      }
+    struct stat file_stat;
+    if(fstat(file_descriptor, &file_stat) != 0)
+      {
+        close(file_descriptor);
+        throw std::runtime_error("Could not stat '" + path.string() + "'");
+      }
+    size = file_stat.st_size;
+    if(size != 0)
+      {
+        void *mapped(
+          mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file_descriptor, 0));
+        if(mapped == MAP_FAILED)
+          {
+            close(file_descriptor);
+            throw std::runtime_error("Could not map '" + path.string()
+                                     + "'");
+          }
+        data = static_cast<const char *>(mapped);
+      }
+    close(file_descriptor);
+  }
+  ~Mapped_File()
+  {
+    if(data != nullptr)
+      {
+        munmap(const_cast<char *>(data), size);
+      }
+  }
+  Mapped_File(const Mapped_File &) = delete;
+  Mapped_File &operator=(const Mapped_File &) = delete;
+};
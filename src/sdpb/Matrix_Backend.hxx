@@ -0,0 +1,64 @@
+#pragma once
+
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+// Which engine to use for the large BigFloat matrix products.
+//
+// elemental: Elemental's native BigFloat kernels.
+//
+// mpmat: Split each BigFloat matrix into double-precision slices and
+//        multiply the slices with BLAS.  See mpmat.hxx.
+//
+// fixedpoint: Sum the products for each element in a wide fixed point
+//             accumulator, rounding once per element.  See
+//             fixed_point.hxx.
+//
+// simd: Split each BigFloat into integer digits, stored so that the
+//       products vectorize.  See limbs.hxx.
+
+enum class Matrix_Backend
+{
+  elemental,
+  mpmat,
+  fixed_point,
+  simd
+};
+
+inline Matrix_Backend to_matrix_backend(const std::string &name)
+{
+  if(name == "elemental")
+    {
+      return Matrix_Backend::elemental;
+    }
+  else if(name == "mpmat")
+    {
+      return Matrix_Backend::mpmat;
+    }
+  else if(name == "fixedpoint")
+    {
+      return Matrix_Backend::fixed_point;
+    }
+  else if(name == "simd")
+    {
+      return Matrix_Backend::simd;
+    }
+  throw std::runtime_error("Invalid argument for matrixBackend.  Expected "
+                           "'elemental', 'mpmat', 'fixedpoint' or 'simd', "
+                           "but found: "
+                           + name);
+}
+
+inline std::ostream &
+operator<<(std::ostream &os, const Matrix_Backend &matrix_backend)
+{
+  switch(matrix_backend)
+    {
+    case Matrix_Backend::elemental: os << "elemental"; break;
+    case Matrix_Backend::mpmat: os << "mpmat"; break;
+    case Matrix_Backend::fixed_point: os << "fixedpoint"; break;
+    case Matrix_Backend::simd: os << "simd"; break;
+    }
+  return os;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+// How much of the per-iteration data the solver keeps.
+//
+// normal: Keep the bilinear pairings and SchurOffDiagonal for the
+//         whole iteration.
+//
+// low: Free the bilinear pairings as soon as the Schur complement is
+//      computed, and SchurOffDiagonal as soon as Q is computed.  The
+//      Schur complement equation is then solved with extra
+//      triangular solves, using FreeVarMatrix instead.
+
+enum class Memory_Mode
+{
+  normal,
+  low
+};
+
+inline Memory_Mode to_memory_mode(const std::string &name)
+{
+  if(name == "normal")
+    {
+      return Memory_Mode::normal;
+    }
+  else if(name == "low")
+    {
+      return Memory_Mode::low;
+    }
+  throw std::runtime_error("Invalid argument for memoryMode.  "
+                           "Expected 'normal' or 'low', but found: "
+                           + name);
+}
+
+inline std::ostream &operator<<(std::ostream &os, const Memory_Mode &mode)
+{
+  switch(mode)
+    {
+    case Memory_Mode::normal: os << "normal"; break;
+    case Memory_Mode::low: os << "low"; break;
+    }
+  return os;
+}
@@ -4,36 +4,80 @@
 //
 
 #include "Verbosity.hxx"
+#include "Matrix_Backend.hxx"
+#include "Limb_Pages.hxx"
+#include "Memory_Mode.hxx"
+#include "Scalar_Type.hxx"
+#include "Step_Length_Algorithm.hxx"
 #include "Write_Solution.hxx"
+#include "../In_Memory_SDP.hxx"
 
 #include <El.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/property_tree/ptree.hpp>
 
 #include <iostream>
+#include <memory>
 
 struct SDP_Solver_Parameters
 {
-  int64_t max_iterations, max_runtime, checkpoint_interval;
-  bool no_final_checkpoint, find_primal_feasible, find_dual_feasible,
-    detect_primal_feasible_jump, detect_dual_feasible_jump;
+  int64_t max_iterations, max_runtime, checkpoint_interval,
+    rebalance_interval;
+  bool no_final_checkpoint, async_checkpoint, single_file_checkpoint,
+    compress_checkpoint, find_primal_feasible, find_dual_feasible,
+    detect_primal_feasible_jump, detect_dual_feasible_jump,
+    detect_infeasibility, hierarchical_Q_reduction, overlap_Q_synchronization,
+    overlap_Q_cholesky,
+    skip_timing_run, sampled_timing_run, adaptive_step_parameters,
+    tune_blocksizes, numa_local_limbs;
   bool require_initial_checkpoint = false;
-  size_t precision, procs_per_node, proc_granularity;
+  size_t precision, initial_precision, procs_per_node, proc_granularity,
+    memory_per_node, replicate_Q_threshold, Q_grid_size,
+    replicated_panel_threshold, threads_per_proc, max_correctors,
+    schur_refinement_threshold, schur_refinement_precision, spill_threshold,
+    ensemble_size;
+  // The precision that the solver is currently running at.  It is
+  // lower than precision while ramping up from initialPrecision.
+  size_t working_precision;
+  double rebalance_threshold, precision_ramp_fraction,
+    mean_time_between_failures;
   Write_Solution write_solution;
   Verbosity verbosity;
+  Matrix_Backend matrix_backend;
+  Scalar_Type scalar;
+  Step_Length_Algorithm step_length_algorithm;
+  Memory_Mode memory_mode;
+  Limb_Pages limb_pages;
 
   El::BigFloat duality_gap_threshold, primal_error_threshold,
     dual_error_threshold, initial_matrix_scale_primal,
-    initial_matrix_scale_dual, feasible_centering_parameter,
-    infeasible_centering_parameter, step_length_reduction, max_complementarity;
+    initial_matrix_scale_dual, warm_start_shift,
+    feasible_centering_parameter, infeasible_centering_parameter,
+    step_length_reduction, max_complementarity;
 
   boost::filesystem::path sdp_directory, out_directory, checkpoint_in,
-    checkpoint_out, param_file;
+    checkpoint_out, warm_start, param_file, trace_file, metrics_file,
+    queue_file, blocksize_profile, spill_directory, block_cost_database;
+
+  // Set by drivers that convert the SDP themselves and hand it over
+  // in memory.  The blocks, bilinear bases and objectives then come
+  // from here instead of from sdp_directory, which is still used for
+  // block_timings and the default output directories.
+  std::shared_ptr<const In_Memory_SDP> in_memory_sdp;
 
   SDP_Solver_Parameters(int argc, char *argv[]);
-  bool is_valid() const { return !sdp_directory.empty(); }
+  bool is_valid() const
+  {
+    return !sdp_directory.empty() || ensemble_size > 1;
+  }
 };
 
 std::ostream &operator<<(std::ostream &os, const SDP_Solver_Parameters &p);
 
+// The default outDir and checkpointDir are next to sdpDir, with a
+// suffix appended.
+boost::filesystem::path
+sdp_directory_with_suffix(const boost::filesystem::path &sdp_directory,
+                          const std::string &suffix);
+
 boost::property_tree::ptree to_property_tree(const SDP_Solver_Parameters &p);
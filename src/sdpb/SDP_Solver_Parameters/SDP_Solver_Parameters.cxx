@@ -3,18 +3,72 @@
 #include <boost/program_options.hpp>
 #include <boost/filesystem/fstream.hpp>
 
+#include <cctype>
+#include <cmath>
+
 namespace po = boost::program_options;
 
+namespace
+{
+  // Parse a size like "64G" into bytes.  The suffixes K, M, G and T
+  // are powers of 1024.
+  size_t parse_memory_size(const std::string &size)
+  {
+    size_t end;
+    double value;
+    try
+      {
+        value = std::stod(size, &end);
+      }
+    catch(std::exception &)
+      {
+        end = 0;
+      }
+    const std::string suffixes("KMGT");
+    double scale(1);
+    if(end != 0 && end + 1 == size.size())
+      {
+        const size_t power(suffixes.find(std::toupper(size[end])));
+        if(power != std::string::npos)
+          {
+            scale = std::pow(1024.0, power + 1);
+            ++end;
+          }
+      }
+    if(end == 0 || end != size.size() || value < 0)
+      {
+        throw std::runtime_error("Invalid memory size: '" + size + "'");
+      }
+    return value * scale;
+  }
+}
+
+boost::filesystem::path
+sdp_directory_with_suffix(const boost::filesystem::path &sdp_directory,
+                          const std::string &suffix)
+{
+  boost::filesystem::path result(sdp_directory);
+  if(result.filename() == ".")
+    {
+      result = result.parent_path();
+    }
+  result += suffix;
+  return result;
+}
+
 SDP_Solver_Parameters::SDP_Solver_Parameters(int argc, char *argv[])
 {
   int int_verbosity;
-  std::string write_solution_string;
+  std::string write_solution_string, matrix_backend_string,
+    step_length_algorithm_string, memory_per_node_string, memory_mode_string,
+    limb_pages_string, scalar_string;
   using namespace std::string_literals;
 
   po::options_description required_options("Required options");
   required_options.add_options()(
-    "sdpDir,s", po::value<boost::filesystem::path>(&sdp_directory)->required(),
-    "Directory containing preprocessed SDP data files.");
+    "sdpDir,s", po::value<boost::filesystem::path>(&sdp_directory),
+    "Directory containing preprocessed SDP data files.  Not used with "
+    "ensembleSize > 1.");
   required_options.add_options()(
     "procsPerNode", po::value<size_t>(&procs_per_node)->required(),
     "The number of processes that can run on a node.  When running on "
@@ -49,16 +103,75 @@ SDP_Solver_Parameters::SDP_Solver_Parameters(int argc, char *argv[])
     po::value<boost::filesystem::path>(&checkpoint_in),
     "The initial checkpoint directory to load. Defaults to "
     "checkpointDir.");
+  basic_options.add_options()(
+    "warmStart", po::value<boost::filesystem::path>(&warm_start),
+    "If there is no checkpoint in initialCheckpointDir, start from the "
+    "checkpoint in this directory, which is usually the final "
+    "checkpoint of a nearby SDP with the same block structure.  X and Y "
+    "are shifted back into the interior by warmStartShift.");
+  basic_options.add_options()(
+    "traceFile", po::value<boost::filesystem::path>(&trace_file),
+    "Write a timeline of the solver phases, per-block kernels and MPI "
+    "waits on every rank to this file, in the Chrome trace event format.  "
+    "View it with chrome://tracing or https://ui.perfetto.dev.");
+  basic_options.add_options()(
+    "metricsFile", po::value<boost::filesystem::path>(&metrics_file),
+    "Append one JSON record per iteration to this file, with the "
+    "objectives, errors, step lengths, the time of each phase over all "
+    "ranks, peak memory, and the bytes sent when synchronizing Q.");
+  basic_options.add_options()(
+    "queue", po::value<boost::filesystem::path>(&queue_file),
+    "After solving sdpDir, keep running and solve the SDPs listed in this "
+    "file, one per line as 'sdpDir [outDir [checkpointDir]]', until a "
+    "line 'quit'.  The file may be a named pipe, or a file that grows "
+    "while SDPB runs.  The block mapping and process grids are reused "
+    "while the block structure stays the same.");
+  basic_options.add_options()(
+    "ensembleSize", po::value<size_t>(&ensemble_size)->default_value(1),
+    "Split the processes into this many equal, contiguous groups that "
+    "each solve their own queue of SDPs independently.  Group k reads "
+    "the queue 'queue.k', and writes traceFile and metricsFile with '.k' "
+    "appended.  sdpDir must not be given, and the number of processes "
+    "must be a multiple of ensembleSize.");
   basic_options.add_options()(
     "checkpointInterval",
     po::value<int64_t>(&checkpoint_interval)->default_value(3600),
     "Save checkpoints to checkpointDir every checkpointInterval "
     "seconds.");
+  basic_options.add_options()(
+    "meanTimeBetweenFailures",
+    po::value<double>(&mean_time_between_failures)->default_value(0),
+    "The expected time in seconds between failures of the job, such as "
+    "node failures or preemption.  If positive, checkpoint at the "
+    "interval that minimizes the expected lost time, which depends on "
+    "the measured time of the last checkpoint, but at least every "
+    "checkpointInterval seconds.");
   basic_options.add_options()(
     "noFinalCheckpoint",
     po::bool_switch(&no_final_checkpoint)->default_value(false),
     "Don't save a final checkpoint after terminating (useful when "
     "debugging).");
+  basic_options.add_options()(
+    "asyncCheckpoint",
+    po::bool_switch(&async_checkpoint)->default_value(false),
+    "Write the periodic checkpoints on a background thread while the "
+    "solver keeps iterating.  This keeps a copy of the solver state in "
+    "memory until the write finishes.  The checkpoint only replaces the "
+    "previous one once every process has written its file.");
+  basic_options.add_options()(
+    "singleFileCheckpoint",
+    po::bool_switch(&single_file_checkpoint)->default_value(false),
+    "Write each checkpoint as a single file with collective MPI-IO, "
+    "rather than one file per process.  The file is laid out by block, "
+    "so it can be loaded by a run with a different number of processes. "
+    "Cannot be combined with asyncCheckpoint.");
+  basic_options.add_options()(
+    "compressCheckpoint",
+    po::bool_switch(&compress_checkpoint)->default_value(false),
+    "Compress checkpoints.  Trailing zero limbs of each number are "
+    "dropped, and each block is then compressed with a fast LZ77 codec. "
+    "Compressed checkpoints are detected automatically when loading. "
+    "Cannot be combined with singleFileCheckpoint.");
   basic_options.add_options()(
     "writeSolution",
     po::value<std::string>(&write_solution_string)->default_value("x,y"s),
@@ -78,6 +191,99 @@ SDP_Solver_Parameters::SDP_Solver_Parameters(int argc, char *argv[])
     "longer.  "
     "This option is generally useful only when trying to fit a large problem "
     "in a small machine.");
+  basic_options.add_options()(
+    "memoryPerNode",
+    po::value<std::string>(&memory_per_node_string)->default_value("0"),
+    "The memory available to SDPB on each node, in bytes or with a suffix "
+    "K, M, G or T (e.g. 64G).  When distributing blocks, SDPB estimates the "
+    "memory that each block needs and avoids putting more on a node than "
+    "fits, and warns if the predicted memory is still too large.  0 means "
+    "no limit.");
+  basic_options.add_options()(
+    "memoryMode",
+    po::value<std::string>(&memory_mode_string)->default_value("normal"s),
+    "'low' frees the bilinear pairings as soon as the Schur complement is "
+    "computed, and SchurOffDiagonal as soon as Q is computed, and solves "
+    "the Schur complement equation with extra triangular solves instead.  "
+    "This lowers the peak memory of each block at the cost of some time "
+    "per iteration.  'normal' keeps them for the whole iteration.");
+  basic_options.add_options()(
+    "numaLocalLimbs",
+    po::bool_switch(&numa_local_limbs)->default_value(false),
+    "Allocate the limbs of the solver's numbers from arenas that are "
+    "bound to the NUMA node of the allocating thread, and touched by "
+    "it right away.  Only useful with ranks bound to cores or sockets, "
+    "e.g. with 'mpirun --bind-to core'.");
+  basic_options.add_options()(
+    "limbPages",
+    po::value<std::string>(&limb_pages_string)->default_value("normal"s),
+    "'transparent' allocates the limbs of the solver's numbers from "
+    "arenas backed by transparent huge pages, and 'huge' from explicit "
+    "huge pages, falling back to transparent ones if none are "
+    "reserved.  This reduces TLB misses in the large matrix kernels.  "
+    "'normal' uses malloc.");
+  basic_options.add_options()(
+    "spillDirectory",
+    po::value<boost::filesystem::path>(&spill_directory),
+    "A scratch directory, ideally on a fast node-local disk, for the "
+    "large blocks of the factors of the Schur complement.  They are "
+    "written there once Q is computed, and read back for each solve of "
+    "the Schur complement equation, which lowers the peak memory at the "
+    "cost of the I/O.  Each run needs its own directory.  If not set, "
+    "they stay in memory.");
+  basic_options.add_options()(
+    "spillThreshold",
+    po::value<size_t>(&spill_threshold)->default_value(1024),
+    "With spillDirectory, only the blocks of the Schur complement with at "
+    "least this many rows are spilled.");
+  basic_options.add_options()(
+    "skipTimingRun", po::bool_switch(&skip_timing_run)->default_value(false),
+    "Do not perform a timing run when there is no block_timings file.  "
+    "Instead, distribute the blocks using costs estimated from their sizes "
+    "and a short benchmark of the linear algebra kernels.");
+  basic_options.add_options()(
+    "sampledTimingRun",
+    po::bool_switch(&sampled_timing_run)->default_value(false),
+    "Instead of the timing run, time the linear algebra of one iteration "
+    "on one block of each dimension, degree and precision, and give the "
+    "other blocks of the same shape the same cost.  Large matrices are "
+    "timed at a smaller size, and the time is scaled by the number of "
+    "operations.  Much faster than the timing run for large SDPs, but "
+    "less accurate.");
+  basic_options.add_options()(
+    "blockCostDatabase",
+    po::value<boost::filesystem::path>(&block_cost_database),
+    "File of block costs shared between runs.  The costs measured by "
+    "the timing run and by rebalancing are added to it, by the dimension, "
+    "degree, number of free variables, precision and number of processes "
+    "of each block.  If there is no block_timings file and the database "
+    "has costs for every block, they are used, and there is no timing "
+    "run.");
+  basic_options.add_options()(
+    "tuneBlocksizes", po::bool_switch(&tune_blocksizes)->default_value(false),
+    "Before solving, time the distributed Gemm, Syrk, Trsm, Cholesky and "
+    "eigenvalue kernels with several algorithmic blocksizes, on each grid "
+    "with more than one process, and use the fastest.  The choices are "
+    "kept in blocksizeProfile, so that later runs at the same precision "
+    "and with the same grid and matrix sizes do not tune them again.");
+  basic_options.add_options()(
+    "blocksizeProfile",
+    po::value<boost::filesystem::path>(&blocksize_profile),
+    "File with the blocksizes chosen by tuneBlocksizes.  If it exists, "
+    "the blocksizes in it are used, with or without tuneBlocksizes.");
+  basic_options.add_options()(
+    "rebalanceInterval",
+    po::value<int64_t>(&rebalance_interval)->default_value(0),
+    "Every rebalanceInterval iterations, measure the time spent on each "
+    "block.  If the load is too uneven (see rebalanceThreshold), compute a "
+    "new mapping of blocks to processes, and move the blocks by saving and "
+    "loading a checkpoint.  0 disables rebalancing.  Otherwise it must be at "
+    "least 2.");
+  basic_options.add_options()(
+    "rebalanceThreshold",
+    po::value<double>(&rebalance_threshold)->default_value(1.2),
+    "Rebalance when the load of the busiest process is more than "
+    "rebalanceThreshold times the average load.");
   basic_options.add_options()("verbosity",
                               po::value<int>(&int_verbosity)->default_value(1),
                               "Verbosity.  0 -> no output, 1 -> regular "
@@ -96,6 +302,20 @@ SDP_Solver_Parameters::SDP_Solver_Parameters(int argc, char *argv[])
     " This should be less than or equal to the precision used when "
     "preprocessing the XML input files with 'pvm2sdp'.  GMP will round "
     "this up to a multiple of 32 or 64, depending on the system.");
+  solver_options.add_options()(
+    "initialPrecision",
+    po::value<size_t>(&initial_precision)->default_value(0),
+    "Start at this precision, in bits, and double it whenever the "
+    "dualityGap, primalError and dualError are all small enough, until "
+    "it reaches precision.  When the precision is raised, the SDP is "
+    "read again and the current point is kept.  0 runs at precision "
+    "from the start.");
+  solver_options.add_options()(
+    "precisionRampFraction",
+    po::value<double>(&precision_ramp_fraction)->default_value(0.25),
+    "With initialPrecision, raise the precision from p bits once the "
+    "dualityGap, primalError and dualError are all below "
+    "2^(-precisionRampFraction * p).");
   solver_options.add_options()(
     "findPrimalFeasible",
     po::bool_switch(&find_primal_feasible)->default_value(false),
@@ -119,6 +339,14 @@ SDP_Solver_Parameters::SDP_Solver_Parameters(int argc, char *argv[])
     "dual feasible solution would be found if the precision were high "
     "enough. Try increasing either dualErrorThreshold or precision "
     "and run from the latest checkpoint.");
+  solver_options.add_options()(
+    "detectInfeasibility",
+    po::bool_switch(&detect_infeasibility)->default_value(false),
+    "Terminate if the iterate contains a certificate that the primal or "
+    "dual problem is infeasible: a dual or primal improving ray whose "
+    "residues, relative to the size of the iterate, are below "
+    "dualErrorThreshold or primalErrorThreshold, and whose relative "
+    "improvement of the objective is above dualityGapThreshold.");
   solver_options.add_options()(
     "maxIterations", po::value<int64_t>(&max_iterations)->default_value(500),
     "Maximum number of iterations to run the solver.");
@@ -126,7 +354,9 @@ SDP_Solver_Parameters::SDP_Solver_Parameters(int argc, char *argv[])
     "maxRuntime",
     po::value<int64_t>(&max_runtime)
       ->default_value(std::numeric_limits<int64_t>::max()),
-    "Maximum amount of time to run the solver in seconds.");
+    "Maximum amount of time to run the solver in seconds.  The solver "
+    "stops early if the next iteration and the final checkpoint, "
+    "predicted from the last iteration, would not finish in time.");
   solver_options.add_options()(
     "dualityGapThreshold",
     po::value<El::BigFloat>(&duality_gap_threshold)
@@ -158,6 +388,14 @@ SDP_Solver_Parameters::SDP_Solver_Parameters(int argc, char *argv[])
       ->default_value(El::BigFloat("1e20", 10)),
     "The dual matrix Y begins at initialMatrixScaleDual times the "
     "identity matrix. Corresponds to SDPA's lambdaStar.");
+  solver_options.add_options()(
+    "warmStartShift",
+    po::value<El::BigFloat>(&warm_start_shift)
+      ->default_value(El::BigFloat("1e-3", 10)),
+    "When starting from warmStart, add warmStartShift times the largest "
+    "element of X to the diagonal of X, and likewise for Y.  Larger "
+    "shifts are more robust when the SDP has changed more, but need "
+    "more iterations.");
   solver_options.add_options()(
     "feasibleCenteringParameter",
     po::value<El::BigFloat>(&feasible_centering_parameter)
@@ -177,12 +415,125 @@ SDP_Solver_Parameters::SDP_Solver_Parameters(int argc, char *argv[])
       ->default_value(El::BigFloat("0.7", 10)),
     "Shrink each newton step by this factor (smaller means slower, more "
     "stable convergence). Corresponds to SDPA's gammaStar.");
+  solver_options.add_options()(
+    "stepLengthAlgorithm",
+    po::value<std::string>(&step_length_algorithm_string)
+      ->default_value("eig"s),
+    "How to find the smallest eigenvalue needed for the step length.  "
+    "'eig' computes all eigenvalues.  'lanczos' estimates the smallest "
+    "eigenvalue with a few Lanczos iterations and checks the step with "
+    "a Cholesky decomposition, falling back to 'eig' if the check "
+    "fails.");
+  solver_options.add_options()(
+    "maxCorrectors", po::value<size_t>(&max_correctors)->default_value(0),
+    "Maximum number of additional corrector solves per iteration.  Each "
+    "one reuses the factorization of the Schur complement and Q, and is "
+    "kept only if it increases the step length.  0 uses the single "
+    "Mehrotra corrector.");
+  solver_options.add_options()(
+    "adaptiveStepParameters",
+    po::bool_switch(&adaptive_step_parameters)->default_value(false),
+    "Adjust stepLengthReduction and the centering parameters after every "
+    "iteration, starting from the values given.  Repeated short steps "
+    "increase the centering, and long steps that reduce the "
+    "complementarity let the steps get closer to the boundary.");
   solver_options.add_options()(
     "maxComplementarity",
     po::value<El::BigFloat>(&max_complementarity)
       ->default_value(El::BigFloat("1e100", 10)),
     "Terminate if the complementarity mu = Tr(X Y)/dim(X) "
     "exceeds this value.");
+  solver_options.add_options()(
+    "matrixBackend",
+    po::value<std::string>(&matrix_backend_string)
+      ->default_value("elemental"s),
+    "Engine used for the large matrix products.  'elemental' uses "
+    "Elemental's BigFloat routines.  'mpmat' splits the BigFloat "
+    "matrices into double precision slices and multiplies the slices "
+    "with BLAS, or with cuBLAS on a GPU if SDPB was built with it.  It "
+    "covers the products summed into Q and the bilinear pairings.  The "
+    "triangular solves stay in BigFloat on the CPU.  'fixedpoint' sums "
+    "the products for each element of Q and of the Schur complement in "
+    "a wide fixed point accumulator, and only rounds the sum.  'simd' "
+    "computes the products in "
+    "constraint_matrix_weighted_sum with vectorized integer kernels.");
+  solver_options.add_options()(
+    "scalar",
+    po::value<std::string>(&scalar_string)->default_value("bigfloat"s),
+    "Arithmetic for the dense kernels on the blocks that are on a single "
+    "process.  'double' uses BLAS and LAPACK, and 'doubleDouble' pairs "
+    "of doubles, with about 32 digits.  Both are much faster than "
+    "'bigfloat', and are meant for quick, coarse solves.  They set the "
+    "precision of the rest of the solver to 53 and 106 bits, instead of "
+    "precision, and the values in the SDP must fit in a double.");
+  solver_options.add_options()(
+    "hierarchicalQReduction",
+    po::bool_switch(&hierarchical_Q_reduction)->default_value(false),
+    "Sum the contributions to Q within each node first, and then across "
+    "nodes, instead of in a single ring over all processes.  This "
+    "reduces the latency of synchronizing Q on many nodes.  It uses "
+    "procsPerNode to decide which processes share a node.");
+  solver_options.add_options()(
+    "overlapQSynchronization",
+    po::bool_switch(&overlap_Q_synchronization)->default_value(false),
+    "Compute Q in column panels, and sum each panel across processes "
+    "with a non-blocking reduction while the next panel is computed.  "
+    "Uses more memory per process than the default ring reduction, and "
+    "ignores matrixBackend and hierarchicalQReduction.");
+  solver_options.add_options()(
+    "overlapQCholesky",
+    po::bool_switch(&overlap_Q_cholesky)->default_value(false),
+    "If Q is replicated (see replicateQThreshold), factor it on a "
+    "background thread while the predictor computes the parts of the "
+    "search direction that do not depend on Q.  Uses one thread more "
+    "than threadsPerProc.");
+  solver_options.add_options()(
+    "replicateQThreshold",
+    po::value<size_t>(&replicate_Q_threshold)->default_value(256),
+    "If the dimension of the dual objective is at most this, keep a "
+    "copy of Q on every process.  Q is then summed with a single "
+    "AllReduce and factored redundantly, which avoids the latency of "
+    "distributed operations on a small matrix.  Set to 0 to always "
+    "distribute Q.");
+  solver_options.add_options()(
+    "QGridSize", po::value<size_t>(&Q_grid_size)->default_value(0),
+    "The number of processes that a distributed Q is spread over.  "
+    "The contributions of all processes are summed into those, which "
+    "then factor Q and solve with it, and broadcast the solution.  0 "
+    "chooses it from the size of Q and the precision, so that small Q "
+    "are not spread over the whole job.");
+  solver_options.add_options()(
+    "replicatedPanelThreshold",
+    po::value<size_t>(&replicated_panel_threshold)->default_value(0),
+    "Factor the distributed blocks of the Schur complement with at "
+    "least this many rows with a replicated panel algorithm, which "
+    "copies each panel of the Cholesky factor to every process of the "
+    "block.  It needs far fewer collectives than the default "
+    "algorithm, so the largest blocks can use more processes, at the "
+    "cost of more memory and bandwidth.  Set to 0 to disable.");
+  solver_options.add_options()(
+    "threadsPerProc",
+    po::value<size_t>(&threads_per_proc)->default_value(1),
+    "Number of threads each process uses for the purely local parts of "
+    "the larger kernels, such as computing the Schur complement for "
+    "all of the process's blocks.  Running fewer processes per node "
+    "with more threads reduces the memory that is replicated on every "
+    "process.");
+  solver_options.add_options()(
+    "schurRefinementThreshold",
+    po::value<size_t>(&schur_refinement_threshold)->default_value(0),
+    "Factor the blocks of the Schur complement with at least this many "
+    "rows at schurRefinementPrecision, and refine the solutions of the "
+    "Schur complement equation iteratively at the full precision.  "
+    "This keeps a full precision copy of those blocks.  0 factors every "
+    "block at the full precision.");
+  solver_options.add_options()(
+    "schurRefinementPrecision",
+    po::value<size_t>(&schur_refinement_precision)->default_value(0),
+    "Binary precision of the factors of the blocks selected by "
+    "schurRefinementThreshold.  The refinement only converges if this "
+    "is well above log2 of the condition number of the Schur "
+    "complement.  0 means half of the working precision.");
 
   po::options_description cmd_line_options;
   cmd_line_options.add(required_options).add(basic_options).add(solver_options);
@@ -230,37 +581,55 @@ SDP_Solver_Parameters::SDP_Solver_Parameters(int argc, char *argv[])
 
           po::notify(variables_map);
 
-          if(!boost::filesystem::exists(sdp_directory))
+          if(ensemble_size == 0)
             {
-              throw std::runtime_error("sdp directory '"
-                                       + sdp_directory.string()
-                                       + "' does not exist");
+              throw std::runtime_error("ensembleSize must be at least 1");
             }
-          if(!boost::filesystem::is_directory(sdp_directory))
+          if(ensemble_size > 1)
             {
-              throw std::runtime_error("sdp directory '"
-                                       + sdp_directory.string()
-                                       + "' is not a directory");
+              if(queue_file.empty())
+                {
+                  throw std::runtime_error(
+                    "ensembleSize > 1 requires a queue");
+                }
+              if(!sdp_directory.empty())
+                {
+                  throw std::runtime_error(
+                    "sdpDir can not be used with ensembleSize > 1.  Each "
+                    "member of the ensemble solves its own queue.");
+                }
             }
-
-          if(variables_map.count("outDir") == 0)
+          else
             {
-              out_directory = sdp_directory;
-              if(out_directory.filename() == ".")
+              if(sdp_directory.empty())
                 {
-                  out_directory = out_directory.parent_path();
+                  throw std::runtime_error(
+                    "the option '--sdpDir' is required but missing");
+                }
+              if(!boost::filesystem::exists(sdp_directory))
+                {
+                  throw std::runtime_error("sdp directory '"
+                                           + sdp_directory.string()
+                                           + "' does not exist");
+                }
+              if(!boost::filesystem::is_directory(sdp_directory))
+                {
+                  throw std::runtime_error("sdp directory '"
+                                           + sdp_directory.string()
+                                           + "' is not a directory");
                 }
-              out_directory += "_out";
-            }
 
-          if(variables_map.count("checkpointDir") == 0)
-            {
-              checkpoint_out = sdp_directory;
-              if(checkpoint_out.filename() == ".")
+              if(variables_map.count("outDir") == 0)
+                {
+                  out_directory
+                    = sdp_directory_with_suffix(sdp_directory, "_out");
+                }
+
+              if(variables_map.count("checkpointDir") == 0)
                 {
-                  checkpoint_out = checkpoint_out.parent_path();
+                  checkpoint_out
+                    = sdp_directory_with_suffix(sdp_directory, ".ck");
                 }
-              checkpoint_out += ".ck";
             }
 
           if(variables_map.count("initialCheckpointDir") == 0)
@@ -273,8 +642,73 @@ SDP_Solver_Parameters::SDP_Solver_Parameters(int argc, char *argv[])
             }
 
           write_solution = Write_Solution(write_solution_string);
+          matrix_backend = to_matrix_backend(matrix_backend_string);
+          scalar = to_scalar_type(scalar_string);
+          step_length_algorithm
+            = to_step_length_algorithm(step_length_algorithm_string);
+          memory_per_node = parse_memory_size(memory_per_node_string);
+          memory_mode = to_memory_mode(memory_mode_string);
+          limb_pages = to_limb_pages(limb_pages_string);
+          if(async_checkpoint && single_file_checkpoint)
+            {
+              throw std::runtime_error(
+                "asyncCheckpoint and singleFileCheckpoint cannot be used "
+                "together");
+            }
+          if(compress_checkpoint && single_file_checkpoint)
+            {
+              throw std::runtime_error(
+                "compressCheckpoint and singleFileCheckpoint cannot be used "
+                "together");
+            }
+          if(rebalance_interval < 0 || rebalance_interval == 1)
+            {
+              throw std::runtime_error(
+                "rebalanceInterval must be either 0 or at least 2");
+            }
+          if(initial_precision > precision)
+            {
+              throw std::runtime_error(
+                "initialPrecision must not be larger than precision");
+            }
+          if(precision_ramp_fraction <= 0 || precision_ramp_fraction >= 1)
+            {
+              throw std::runtime_error(
+                "precisionRampFraction must be between 0 and 1");
+            }
+          if(scalar != Scalar_Type::bigfloat)
+            {
+              if(initial_precision != 0)
+                {
+                  throw std::runtime_error(
+                    "initialPrecision can not be used with scalar="
+                    + scalar_string);
+                }
+              precision = scalar_precision(scalar);
+            }
+          working_precision = precision;
+#ifdef SDPB_FIXED_PRECISION
+          if(precision != SDPB_FIXED_PRECISION || initial_precision != 0)
+            {
+              throw std::runtime_error(
+                "This SDPB was built with --fixed-precision="
+                + std::to_string(SDPB_FIXED_PRECISION)
+                + ", so precision must be "
+                + std::to_string(SDPB_FIXED_PRECISION)
+                + " and initialPrecision can not be used");
+            }
+#endif
+          if(warm_start_shift <= 0)
+            {
+              throw std::runtime_error("warmStartShift must be positive");
+            }
+          if(threads_per_proc == 0)
+            {
+              throw std::runtime_error("threadsPerProc must be at least 1");
+            }
 
-          if(El::mpi::Rank() == 0)
+          // The members of an ensemble take outDir from their queues.
+          if(ensemble_size == 1 && El::mpi::Rank() == 0)
             {
               boost::filesystem::create_directories(out_directory);
               boost::filesystem::ofstream ofs(out_directory / "out.txt");
@@ -6,12 +6,25 @@ std::ostream &operator<<(std::ostream &os, const SDP_Solver_Parameters &p)
      << "out directory   : " << p.out_directory << '\n'
      << "checkpoint in   : " << p.checkpoint_in << '\n'
      << "checkpoint out  : " << p.checkpoint_out << '\n'
+     << "warm start      : " << p.warm_start << '\n'
+     << "trace file      : " << p.trace_file << '\n'
+     << "metrics file    : " << p.metrics_file << '\n'
+     << "queue file      : " << p.queue_file << '\n'
+     << "blocksize file  : " << p.blocksize_profile << '\n'
+     << "spill directory : " << p.spill_directory << '\n'
+     << "block cost file : " << p.block_cost_database << '\n'
      << "\nParameters:\n"
      << std::boolalpha << "maxIterations                = " << p.max_iterations
      << '\n'
      << "maxRuntime                   = " << p.max_runtime << '\n'
      << "checkpointInterval           = " << p.checkpoint_interval << '\n'
+     << "meanTimeBetweenFailures      = " << p.mean_time_between_failures
+     << '\n'
      << "noFinalCheckpoint            = " << p.no_final_checkpoint << '\n'
+     << "asyncCheckpoint              = " << p.async_checkpoint << '\n'
+     << "singleFileCheckpoint         = " << p.single_file_checkpoint
+     << '\n'
+     << "compressCheckpoint           = " << p.compress_checkpoint << '\n'
      << "writeSolution                = " << p.write_solution << '\n'
      << "findPrimalFeasible           = " << p.find_primal_feasible << '\n'
      << "findDualFeasible             = " << p.find_dual_feasible << '\n'
@@ -19,8 +32,12 @@ std::ostream &operator<<(std::ostream &os, const SDP_Solver_Parameters &p)
      << '\n'
      << "detectDualFeasibleJump       = " << p.detect_dual_feasible_jump
      << '\n'
+     << "detectInfeasibility          = " << p.detect_infeasibility << '\n'
      << "precision(actual)            = " << p.precision << "("
      << mpf_get_default_prec() << ")" << '\n'
+     << "initialPrecision             = " << p.initial_precision << '\n'
+     << "precisionRampFraction        = " << p.precision_ramp_fraction
+     << '\n'
 
      << "dualityGapThreshold          = " << p.duality_gap_threshold << '\n'
      << "primalErrorThreshold         = " << p.primal_error_threshold << '\n'
@@ -29,14 +46,46 @@ std::ostream &operator<<(std::ostream &os, const SDP_Solver_Parameters &p)
      << '\n'
      << "initialMatrixScaleDual       = " << p.initial_matrix_scale_dual
      << '\n'
+     << "warmStartShift               = " << p.warm_start_shift << '\n'
      << "feasibleCenteringParameter   = " << p.feasible_centering_parameter
      << '\n'
      << "infeasibleCenteringParameter = " << p.infeasible_centering_parameter
      << '\n'
      << "stepLengthReduction          = " << p.step_length_reduction << '\n'
+     << "stepLengthAlgorithm          = " << p.step_length_algorithm << '\n'
+     << "maxCorrectors                = " << p.max_correctors << '\n'
+     << "adaptiveStepParameters       = " << p.adaptive_step_parameters
+     << '\n'
      << "maxComplementarity           = " << p.max_complementarity << '\n'
      << "procsPerNode                 = " << p.procs_per_node << '\n'
      << "procGranularity              = " << p.proc_granularity << '\n'
+     << "ensembleSize                 = " << p.ensemble_size << '\n'
+     << "memoryPerNode                = " << p.memory_per_node << '\n'
+     << "memoryMode                   = " << p.memory_mode << '\n'
+     << "numaLocalLimbs               = " << p.numa_local_limbs << '\n'
+     << "limbPages                    = " << p.limb_pages << '\n'
+     << "spillThreshold               = " << p.spill_threshold << '\n'
+     << "skipTimingRun                = " << p.skip_timing_run << '\n'
+     << "sampledTimingRun             = " << p.sampled_timing_run << '\n'
+     << "tuneBlocksizes               = " << p.tune_blocksizes << '\n'
+     << "rebalanceInterval            = " << p.rebalance_interval << '\n'
+     << "rebalanceThreshold           = " << p.rebalance_threshold << '\n'
+     << "matrixBackend                = " << p.matrix_backend << '\n'
+     << "scalar                       = " << p.scalar << '\n'
+     << "hierarchicalQReduction       = " << p.hierarchical_Q_reduction
+     << '\n'
+     << "overlapQSynchronization      = " << p.overlap_Q_synchronization
+     << '\n'
+     << "overlapQCholesky             = " << p.overlap_Q_cholesky << '\n'
+     << "replicateQThreshold          = " << p.replicate_Q_threshold << '\n'
+     << "QGridSize                    = " << p.Q_grid_size << '\n'
+     << "replicatedPanelThreshold     = " << p.replicated_panel_threshold
+     << '\n'
+     << "threadsPerProc               = " << p.threads_per_proc << '\n'
+     << "schurRefinementThreshold     = " << p.schur_refinement_threshold
+     << '\n'
+     << "schurRefinementPrecision     = " << p.schur_refinement_precision
+     << '\n'
      << "verbosity                    = " << static_cast<int>(p.verbosity)
      << '\n';
   return os;
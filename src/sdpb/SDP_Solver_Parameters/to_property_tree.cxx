@@ -9,28 +9,69 @@ to_property_tree(const SDP_Solver_Parameters &p)
   result.put("outDir", p.out_directory.string());
   result.put("initialCheckpointDir", p.checkpoint_in.string());
   result.put("checkpointDir", p.checkpoint_out.string());
+  result.put("warmStart", p.warm_start.string());
+  result.put("traceFile", p.trace_file.string());
+  result.put("metricsFile", p.metrics_file.string());
+  result.put("queue", p.queue_file.string());
+  result.put("blocksizeProfile", p.blocksize_profile.string());
+  result.put("blockCostDatabase", p.block_cost_database.string());
   result.put("maxIterations", p.max_iterations);
   result.put("maxRuntime", p.max_runtime);
   result.put("checkpointInterval", p.checkpoint_interval);
+  result.put("meanTimeBetweenFailures", p.mean_time_between_failures);
   result.put("noFinalCheckpoint", p.no_final_checkpoint);
+  result.put("asyncCheckpoint", p.async_checkpoint);
+  result.put("singleFileCheckpoint", p.single_file_checkpoint);
+  result.put("compressCheckpoint", p.compress_checkpoint);
   result.put("writeSolution", p.write_solution);
   result.put("findPrimalFeasible", p.find_primal_feasible);
   result.put("findDualFeasible", p.find_dual_feasible);
   result.put("detectPrimalFeasibleJump", p.detect_primal_feasible_jump);
   result.put("detectDualFeasibleJump", p.detect_dual_feasible_jump);
+  result.put("detectInfeasibility", p.detect_infeasibility);
   result.put("precision", p.precision);
   result.put("precision_actual", mpf_get_default_prec());
+  result.put("precision_working", p.working_precision);
+  result.put("initialPrecision", p.initial_precision);
+  result.put("precisionRampFraction", p.precision_ramp_fraction);
   result.put("dualityGapThreshold", p.duality_gap_threshold);
   result.put("primalErrorThreshold", p.primal_error_threshold);
   result.put("dualErrorThreshold", p.dual_error_threshold);
   result.put("initialMatrixScalePrimal", p.initial_matrix_scale_primal);
   result.put("initialMatrixScaleDual", p.initial_matrix_scale_dual);
+  result.put("warmStartShift", p.warm_start_shift);
   result.put("feasibleCenteringParameter", p.feasible_centering_parameter);
   result.put("infeasibleCenteringParameter", p.infeasible_centering_parameter);
   result.put("stepLengthReduction", p.step_length_reduction);
+  result.put("stepLengthAlgorithm", p.step_length_algorithm);
+  result.put("maxCorrectors", p.max_correctors);
+  result.put("adaptiveStepParameters", p.adaptive_step_parameters);
   result.put("maxComplementarity", p.max_complementarity);
   result.put("procsPerNode", p.procs_per_node);
   result.put("procGranularity", p.proc_granularity);
+  result.put("ensembleSize", p.ensemble_size);
+  result.put("memoryPerNode", p.memory_per_node);
+  result.put("memoryMode", p.memory_mode);
+  result.put("numaLocalLimbs", p.numa_local_limbs);
+  result.put("limbPages", p.limb_pages);
+  result.put("spillDirectory", p.spill_directory.string());
+  result.put("spillThreshold", p.spill_threshold);
+  result.put("skipTimingRun", p.skip_timing_run);
+  result.put("sampledTimingRun", p.sampled_timing_run);
+  result.put("tuneBlocksizes", p.tune_blocksizes);
+  result.put("rebalanceInterval", p.rebalance_interval);
+  result.put("rebalanceThreshold", p.rebalance_threshold);
+  result.put("matrixBackend", p.matrix_backend);
+  result.put("scalar", p.scalar);
+  result.put("hierarchicalQReduction", p.hierarchical_Q_reduction);
+  result.put("overlapQSynchronization", p.overlap_Q_synchronization);
+  result.put("overlapQCholesky", p.overlap_Q_cholesky);
+  result.put("replicateQThreshold", p.replicate_Q_threshold);
+  result.put("QGridSize", p.Q_grid_size);
+  result.put("replicatedPanelThreshold", p.replicated_panel_threshold);
+  result.put("threadsPerProc", p.threads_per_proc);
+  result.put("schurRefinementThreshold", p.schur_refinement_threshold);
+  result.put("schurRefinementPrecision", p.schur_refinement_precision);
   result.put("verbosity", static_cast<int>(p.verbosity));
 
   return result;
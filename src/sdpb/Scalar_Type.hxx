@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+// The arithmetic used for the dense kernels on the blocks of the SDP
+// that are on a single process (see block_kernels.hxx).
+//
+// bigfloat: Elemental's BigFloat kernels, at the precision of the
+//           solver.
+//
+// double: Convert the blocks to double, and use Elemental's BLAS and
+//         LAPACK kernels.
+//
+// double_double: Convert the blocks to pairs of doubles, which carry
+//                about 32 digits, and use the kernels in
+//                Double_Double.hxx.
+//
+// With double or double_double, the rest of the solver runs with
+// BigFloats at the matching precision, from scalar_precision().  The
+// values must fit in the exponent range of a double.
+
+enum class Scalar_Type
+{
+  bigfloat,
+  native_double,
+  double_double
+};
+
+inline Scalar_Type to_scalar_type(const std::string &name)
+{
+  if(name == "bigfloat")
+    {
+      return Scalar_Type::bigfloat;
+    }
+  else if(name == "double")
+    {
+      return Scalar_Type::native_double;
+    }
+  else if(name == "doubleDouble")
+    {
+      return Scalar_Type::double_double;
+    }
+  throw std::runtime_error("Invalid argument for scalar.  Expected "
+                           "'bigfloat', 'double' or 'doubleDouble', but "
+                           "found: "
+                           + name);
+}
+
+// The binary precision of the scalar type.  0 for a BigFloat, whose
+// precision is set by --precision.
+inline size_t scalar_precision(const Scalar_Type &scalar)
+{
+  switch(scalar)
+    {
+    case Scalar_Type::native_double: return 53;
+    case Scalar_Type::double_double: return 106;
+    default: return 0;
+    }
+}
+
+inline std::ostream &operator<<(std::ostream &os, const Scalar_Type &scalar)
+{
+  switch(scalar)
+    {
+    case Scalar_Type::bigfloat: os << "bigfloat"; break;
+    case Scalar_Type::native_double: os << "double"; break;
+    case Scalar_Type::double_double: os << "doubleDouble"; break;
+    }
+  return os;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+// How to find the smallest eigenvalue of L^{-1} dM L^{-T} when
+// computing step lengths.
+//
+// eig: Compute the full spectrum with El::HermitianEig.
+//
+// lanczos: Estimate the smallest eigenvalue with a few Lanczos
+//          iterations and check the resulting step with a Cholesky
+//          decomposition, falling back to eig if the check fails.
+
+enum class Step_Length_Algorithm
+{
+  eig,
+  lanczos
+};
+
+inline Step_Length_Algorithm to_step_length_algorithm(const std::string &name)
+{
+  if(name == "eig")
+    {
+      return Step_Length_Algorithm::eig;
+    }
+  else if(name == "lanczos")
+    {
+      return Step_Length_Algorithm::lanczos;
+    }
+  throw std::runtime_error("Invalid argument for stepLengthAlgorithm.  "
+                           "Expected 'eig' or 'lanczos', but found: "
+                           + name);
+}
+
+inline std::ostream &
+operator<<(std::ostream &os, const Step_Length_Algorithm &algorithm)
+{
+  switch(algorithm)
+    {
+    case Step_Length_Algorithm::eig: os << "eig"; break;
+    case Step_Length_Algorithm::lanczos: os << "lanczos"; break;
+    }
+  return os;
+}
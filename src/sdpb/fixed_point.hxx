@@ -0,0 +1,64 @@
+#pragma once
+
+#include <El.hpp>
+
+#include <vector>
+
+// fixed_point: sums of BigFloat products without rounding.
+//
+// Every += in Elemental's BigFloat kernels rounds and normalizes an
+// mpf.  For a dot product, the products can instead be added into one
+// wide fixed point number, made of GMP limbs, whose window starts at
+// the largest possible product and extends a few guard limbs below
+// the precision of the result.  The additions are then plain limb
+// additions, and the sum is only rounded once, when it is converted
+// back to a BigFloat.  Parts of the products that fall below the
+// window are never computed.
+
+class Fixed_Point_Accumulator
+{
+public:
+  // Start a new sum.  All terms must be less than
+  // 2^(GMP_NUMB_BITS * top_exponent) in magnitude, and the window
+  // keeps precision_limbs limbs below that.
+  void reset(const mp_exp_t &top_exponent, const mp_size_t &precision_limbs);
+
+  // sum += a
+  void add(mpf_srcptr a);
+  // sum += a * b
+  void add_product(mpf_srcptr a, mpf_srcptr b);
+
+  // result = sum, rounded to the precision of result
+  void get(mpf_ptr result);
+
+  // The number of limbs to keep for the precision of x
+  static mp_size_t precision_limbs(mpf_srcptr x)
+  {
+    return (mpf_get_prec(x) + GMP_NUMB_BITS - 1) / GMP_NUMB_BITS + 1;
+  }
+
+private:
+  // Extra limbs below the precision, which absorb the truncation of
+  // the products.
+  static constexpr mp_size_t guard_limbs = 2;
+
+  // The window is limbs [low_exponent, top_exponent] in units of
+  // 2^GMP_NUMB_BITS.  The extra limb on top holds the carries.
+  mp_exp_t top_exponent = 0, low_exponent = 0;
+  std::vector<mp_limb_t> positive, negative, product;
+
+  void add_limbs(const mp_limb_t *limbs, mp_size_t size,
+                 const mp_exp_t &exponent, const bool &is_negative);
+};
+
+// C := A^T A + beta C, only touching the uplo triangle of C.
+void fixed_point_syrk(const El::UpperOrLower &uplo,
+                      const El::DistMatrix<El::BigFloat> &A,
+                      const El::BigFloat &beta,
+                      El::DistMatrix<El::BigFloat> &C);
+
+// C := A^T B + beta C
+void fixed_point_gemm(const El::DistMatrix<El::BigFloat> &A,
+                      const El::DistMatrix<El::BigFloat> &B,
+                      const El::BigFloat &beta,
+                      El::DistMatrix<El::BigFloat> &C);
@@ -0,0 +1,152 @@
+#include "../fixed_point.hxx"
+
+#include <algorithm>
+#include <stdexcept>
+
+// An mpf with size n and exponent e has the value
+//
+//   (d[n-1] ... d[0]) * 2^(GMP_NUMB_BITS * (e - n))
+//
+// where d are its limbs, least significant first.  So the limbs of a
+// product of two mpf's are the mpn product of their limbs, and its
+// lowest limb has exponent (e_a - n_a) + (e_b - n_b).
+
+void Fixed_Point_Accumulator::reset(const mp_exp_t &top,
+                                    const mp_size_t &precision_limbs)
+{
+  top_exponent = top;
+  low_exponent = top - precision_limbs - guard_limbs;
+  positive.assign(top_exponent - low_exponent + 1, 0);
+  negative.assign(positive.size(), 0);
+}
+
+void Fixed_Point_Accumulator::add_limbs(const mp_limb_t *limbs,
+                                        mp_size_t size,
+                                        const mp_exp_t &exponent,
+                                        const bool &is_negative)
+{
+  mp_exp_t offset(exponent - low_exponent);
+  if(offset < 0)
+    {
+      if(size <= -offset)
+        {
+          return;
+        }
+      limbs -= offset;
+      size += offset;
+      offset = 0;
+    }
+  // Skip leading zero limbs, which a product can have.
+  while(size > 0 && limbs[size - 1] == 0)
+    {
+      --size;
+    }
+  if(size == 0)
+    {
+      return;
+    }
+  std::vector<mp_limb_t> &sum(is_negative ? negative : positive);
+  const mp_size_t sum_size(sum.size());
+  if(offset + size >= sum_size)
+    {
+      throw std::runtime_error(
+        "Fixed_Point_Accumulator: term above the top of the window");
+    }
+  if(mpn_add(sum.data() + offset, sum.data() + offset, sum_size - offset,
+             limbs, size)
+     != 0)
+    {
+      throw std::runtime_error("Fixed_Point_Accumulator: overflow");
+    }
+}
+
+void Fixed_Point_Accumulator::add(mpf_srcptr a)
+{
+  const mp_size_t size(std::abs(a->_mp_size));
+  if(size != 0)
+    {
+      add_limbs(a->_mp_d, size, a->_mp_exp - size, a->_mp_size < 0);
+    }
+}
+
+void Fixed_Point_Accumulator::add_product(mpf_srcptr a, mpf_srcptr b)
+{
+  mp_size_t size_a(std::abs(a->_mp_size)), size_b(std::abs(b->_mp_size));
+  if(size_a == 0 || size_b == 0)
+    {
+      return;
+    }
+  // The product is less than 2^(GMP_NUMB_BITS * (e_a + e_b)).
+  const mp_exp_t top(a->_mp_exp + b->_mp_exp);
+  if(top <= low_exponent)
+    {
+      return;
+    }
+  // Limbs of a with exponent below low_exponent - e_b only contribute
+  // below the window, up to a carry into its lowest limb, so drop
+  // them.  Likewise for b.
+  const mp_size_t keep(top - low_exponent + 1);
+  const mp_limb_t *limbs_a(a->_mp_d), *limbs_b(b->_mp_d);
+  if(size_a > keep)
+    {
+      limbs_a += size_a - keep;
+      size_a = keep;
+    }
+  if(size_b > keep)
+    {
+      limbs_b += size_b - keep;
+      size_b = keep;
+    }
+  product.resize(size_a + size_b);
+  if(size_a >= size_b)
+    {
+      mpn_mul(product.data(), limbs_a, size_a, limbs_b, size_b);
+    }
+  else
+    {
+      mpn_mul(product.data(), limbs_b, size_b, limbs_a, size_a);
+    }
+  add_limbs(product.data(), size_a + size_b,
+            (a->_mp_exp - size_a) + (b->_mp_exp - size_b),
+            (a->_mp_size < 0) != (b->_mp_size < 0));
+}
+
+void Fixed_Point_Accumulator::get(mpf_ptr result)
+{
+  const mp_size_t size(positive.size());
+  const bool is_negative(
+    mpn_cmp(positive.data(), negative.data(), size) < 0);
+  if(is_negative)
+    {
+      mpn_sub_n(negative.data(), negative.data(), positive.data(), size);
+    }
+  else
+    {
+      mpn_sub_n(positive.data(), positive.data(), negative.data(), size);
+    }
+  const std::vector<mp_limb_t> &difference(is_negative ? negative
+                                                       : positive);
+  mp_size_t difference_size(size);
+  while(difference_size > 0 && difference[difference_size - 1] == 0)
+    {
+      --difference_size;
+    }
+  if(difference_size == 0)
+    {
+      mpf_set_ui(result, 0);
+      return;
+    }
+  mpz_t integer;
+  mpz_roinit_n(integer, difference.data(),
+               is_negative ? -difference_size : difference_size);
+  mpf_set_z(result, integer);
+  const int64_t shift(int64_t(GMP_NUMB_BITS) * low_exponent);
+  if(shift >= 0)
+    {
+      mpf_mul_2exp(result, result, shift);
+    }
+  else
+    {
+      mpf_div_2exp(result, result, -shift);
+    }
+}
@@ -0,0 +1,111 @@
+#include "../fixed_point.hxx"
+
+#include <functional>
+#include <limits>
+
+namespace
+{
+  const mp_exp_t no_exponent(std::numeric_limits<mp_exp_t>::min());
+
+  // The largest exponent of the nonzero elements in each column
+  std::vector<mp_exp_t>
+  column_exponents(const El::Matrix<El::BigFloat> &A)
+  {
+    std::vector<mp_exp_t> result(A.Width(), no_exponent);
+    for(int64_t column = 0; column < A.Width(); ++column)
+      for(int64_t row = 0; row < A.Height(); ++row)
+        {
+          mpf_srcptr element(A(row, column).gmp_float.get_mpf_t());
+          if(element->_mp_size != 0)
+            {
+              result[column] = std::max(result[column], element->_mp_exp);
+            }
+        }
+    return result;
+  }
+
+  // C(row, column) := (A^T B)(row, column) + beta C(row, column) for
+  // every element where in_range(row, column) is true.
+  void transpose_product(
+    const El::Matrix<El::BigFloat> &A, const El::Matrix<El::BigFloat> &B,
+    const El::BigFloat &beta, El::Matrix<El::BigFloat> &C,
+    const std::function<bool(const int64_t &, const int64_t &)> &in_range)
+  {
+    const std::vector<mp_exp_t> exponents_A(column_exponents(A)),
+      exponents_B(column_exponents(B));
+    Fixed_Point_Accumulator accumulator;
+    El::BigFloat scaled;
+    for(int64_t column = 0; column < C.Width(); ++column)
+      for(int64_t row = 0; row < C.Height(); ++row)
+        {
+          if(!in_range(row, column))
+            {
+              continue;
+            }
+          mpf_ptr element(C(row, column).gmp_float.get_mpf_t());
+          mpf_mul(scaled.gmp_float.get_mpf_t(), element,
+                  beta.gmp_float.get_mpf_t());
+          mpf_srcptr scaled_mpf(scaled.gmp_float.get_mpf_t());
+
+          mp_exp_t top(scaled_mpf->_mp_size == 0 ? no_exponent
+                                                 : scaled_mpf->_mp_exp);
+          if(exponents_A[row] != no_exponent
+             && exponents_B[column] != no_exponent)
+            {
+              top = std::max(top, exponents_A[row] + exponents_B[column]);
+            }
+          if(top == no_exponent)
+            {
+              mpf_set_ui(element, 0);
+              continue;
+            }
+          accumulator.reset(top,
+                            Fixed_Point_Accumulator::precision_limbs(element));
+          accumulator.add(scaled_mpf);
+          for(int64_t k = 0; k < A.Height(); ++k)
+            {
+              accumulator.add_product(A(k, row).gmp_float.get_mpf_t(),
+                                      B(k, column).gmp_float.get_mpf_t());
+            }
+          accumulator.get(element);
+        }
+  }
+}
+
+// This only handles matrices that are all local, and falls back to
+// Elemental otherwise.
+
+void fixed_point_syrk(const El::UpperOrLower &uplo,
+                      const El::DistMatrix<El::BigFloat> &A,
+                      const El::BigFloat &beta,
+                      El::DistMatrix<El::BigFloat> &C)
+{
+  if(A.Grid().Size() != 1 || C.Grid().Size() != 1)
+    {
+      El::Syrk(uplo, El::Orientation::TRANSPOSE, El::BigFloat(1), A, beta, C);
+      return;
+    }
+  // Only the uplo triangle of C is guaranteed to be allocated, so
+  // never touch the other half.
+  transpose_product(A.LockedMatrix(), A.LockedMatrix(), beta, C.Matrix(),
+                    [&](const int64_t &row, const int64_t &column) {
+                      return uplo == El::UpperOrLower::UPPER
+                               ? row <= column
+                               : row >= column;
+                    });
+}
+
+void fixed_point_gemm(const El::DistMatrix<El::BigFloat> &A,
+                      const El::DistMatrix<El::BigFloat> &B,
+                      const El::BigFloat &beta,
+                      El::DistMatrix<El::BigFloat> &C)
+{
+  if(A.Grid().Size() != 1 || C.Grid().Size() != 1)
+    {
+      El::Gemm(El::Orientation::TRANSPOSE, El::Orientation::NORMAL,
+               El::BigFloat(1), A, B, beta, C);
+      return;
+    }
+  transpose_product(A.LockedMatrix(), B.LockedMatrix(), beta, C.Matrix(),
+                    [](const int64_t &, const int64_t &) { return true; });
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Limb_Pages.hxx"
+
+#include <cstdint>
+
+// limb_pool: a size class allocator for GMP limbs.
+//
+// Every El::BigFloat owns its own limb allocation, so the solver's
+// kernels spend a significant amount of time in malloc and free for
+// short lived temporaries.  The limb pool keeps freed blocks on
+// thread local free lists, one list for each power of two size, and
+// hands them back out for later allocations of the same size class.
+// Blocks larger than the largest size class go directly to malloc.
+//
+// When a thread exits, its free lists go to a shared pool, which the
+// threads that start later draw from when their own lists are empty.
+// Without a placement, each thread keeps at most 256 MiB on its free
+// lists, and the shared pool at most as much again.
+//
+// When built with SDPB_FIXED_PRECISION, blocks of exactly the size of
+// a BigFloat at that precision get their own class.  They are carved
+// one after another out of large slabs, so the elements of a matrix,
+// which are allocated in order, end up next to each other in memory,
+// and there is no rounding up to a power of two.  Slab blocks are
+// never returned to malloc.
+//
+// install_limb_pool() must be called before GMP allocates anything,
+// since blocks allocated with plain malloc can not be returned to the
+// pool.
+//
+// set_limb_placement() makes the pool carve all of its blocks,
+// including the slabs, out of large arenas that are allocated with
+// mmap by the thread that asks for them:
+//
+// - With numa_local, each arena is bound to the NUMA node of the CPU
+//   that the thread runs on, and every page is touched right away.
+//   With ranks bound to cores or sockets (e.g. mpirun --bind-to
+//   core), the limbs of a rank's matrices are then on its own node,
+//   instead of wherever the first write to them happens to run.
+// - With transparent or huge pages, the arenas are backed by huge
+//   pages, so that sweeping over a matrix needs far fewer TLB
+//   entries.
+//
+// Arena blocks are never returned to the system, so with a placement
+// the free lists are not capped.  What is left of the arenas and slabs
+// of an exiting thread also goes to the shared pool, so that threads
+// that start later carve from it before they map new arenas.  Blocks
+// larger than the largest size class still go directly to malloc.
+
+struct Limb_Pool_Statistics
+{
+  // Calls to GMP's allocate, reallocate, and free functions.
+  int64_t allocations = 0, reallocations = 0, frees = 0;
+  // Allocations that were satisfied from a free list.
+  int64_t reused = 0;
+  // Bytes currently held on the free lists, and on the shared free
+  // lists of threads that have exited.
+  int64_t pooled_bytes = 0, shared_pooled_bytes = 0;
+  // Bytes carved out of slabs.
+  int64_t slab_bytes = 0;
+  // Bytes of arenas, and how many of them are on huge pages and bound
+  // to the local NUMA node.
+  int64_t arena_bytes = 0, huge_page_bytes = 0, numa_local_bytes = 0;
+  // Arenas mapped by this thread, and by every thread of the process.
+  // The process count should stop growing after the first iterations.
+  int64_t arenas = 0, process_arenas = 0;
+};
+
+struct Limb_Placement
+{
+  bool numa_local = false;
+  Limb_Pages pages = Limb_Pages::normal;
+
+  bool uses_arenas() const
+  {
+    return numa_local || pages != Limb_Pages::normal;
+  }
+};
+
+void install_limb_pool();
+
+// Must be called before any threads other than the calling one
+// allocate limbs.  Only later allocations use the placement.
+void set_limb_placement(const Limb_Placement &placement);
+
+// Statistics for the calling thread, apart from shared_pooled_bytes
+// and process_arenas.
+Limb_Pool_Statistics limb_pool_statistics();
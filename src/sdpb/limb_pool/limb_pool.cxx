@@ -0,0 +1,589 @@
+#include "../limb_pool.hxx"
+
+#include <gmp.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  // Size classes are powers of two from 2^min_class_log2 to
+  // 2^max_class_log2 bytes.  At 1024 bits of precision, a BigFloat
+  // needs 17 limbs = 136 bytes, which lands in the 256 byte class.
+  constexpr size_t min_class_log2(4), max_class_log2(16),
+    num_classes(max_class_log2 - min_class_log2 + 1);
+
+  // Do not keep more than this many bytes on the free lists of any
+  // one thread.  Anything beyond that goes back to malloc.
+  constexpr int64_t max_pooled_bytes(int64_t(1) << 28);
+
+  struct Free_Block
+  {
+    Free_Block *next;
+  };
+
+  // Arenas are whole huge pages, and requests larger than a quarter of
+  // an arena get an arena of their own.
+  constexpr size_t arena_size(size_t(1) << 21);
+
+  // Set once, before other threads allocate.
+  Limb_Placement placement;
+
+#ifdef SDPB_FIXED_PRECISION
+  // mpf_init2 allocates __GMPF_BITS_TO_PREC(bits) + 1 limbs.
+  constexpr size_t slab_block_size(
+    ((SDPB_FIXED_PRECISION + 2 * GMP_NUMB_BITS - 1) / GMP_NUMB_BITS + 1)
+    * sizeof(mp_limb_t));
+  constexpr size_t blocks_per_slab(4096);
+#endif
+
+  // A thread that finds its free list empty takes up to this many
+  // bytes of blocks from the shared pool at once.
+  constexpr int64_t refill_bytes(int64_t(1) << 20);
+
+  // The pool is deliberately trivially destructible.  GMP may still
+  // free limbs during static destruction at exit, after a destructor
+  // would have run.  Instead, the first allocation or free of a
+  // thread registers a Pool_Return, which hands the free lists and
+  // what is left of the arenas and slabs to the shared pool when the
+  // thread exits.  Limbs that are freed after that go to the emptied
+  // free lists, and are lost when the process exits.
+  struct Pool
+  {
+    std::array<Free_Block *, num_classes> free_lists;
+#ifdef SDPB_FIXED_PRECISION
+    Free_Block *slab_free_list;
+    char *slab_next, *slab_end;
+#endif
+    char *arena_next, *arena_end;
+    bool is_return_registered;
+    Limb_Pool_Statistics statistics;
+  };
+
+  thread_local Pool pool = {};
+
+  // The blocks, arena remainders and slab remainders of threads that
+  // have exited, for the threads that start later.  The solver starts
+  // short lived threads for every parallel_for and every background
+  // Cholesky, so without this each of them would keep its blocks and
+  // arenas to itself, and the memory would grow with every iteration.
+  // Like the pools, it is never destroyed.
+  struct Shared_Pool
+  {
+    std::mutex mutex;
+    std::array<Free_Block *, num_classes> free_lists = {};
+    // The bytes on each free list, read without the mutex so that
+    // empty lists cost no locking.
+    std::array<std::atomic<int64_t>, num_classes> bytes = {};
+    std::vector<std::pair<char *, char *>> arena_remainders;
+#ifdef SDPB_FIXED_PRECISION
+    Free_Block *slab_free_list = nullptr;
+    std::atomic<int64_t> slab_blocks = {0};
+    std::vector<std::pair<char *, char *>> slab_remainders;
+#endif
+    std::atomic<int64_t> arenas = {0};
+  };
+
+  Shared_Pool &shared_pool()
+  {
+    static Shared_Pool *result(new Shared_Pool());
+    return *result;
+  }
+
+  // GMP can not handle failed allocations, so do what its default
+  // allocator does.
+  void *checked_malloc(const size_t &size)
+  {
+    void *result(std::malloc(size));
+    if(result == nullptr)
+      {
+        std::fprintf(stderr, "limb_pool: cannot allocate %zu bytes\n", size);
+        std::abort();
+      }
+    return result;
+  }
+
+  // Bind [address, address + size) to the NUMA node of the CPU that
+  // the calling thread runs on.  Returns false if the system does not
+  // support it.
+  bool bind_to_local_node(void *address, const size_t &size)
+  {
+#if defined(__linux__) && defined(SYS_getcpu) && defined(SYS_mbind)
+    unsigned cpu, node;
+    if(syscall(SYS_getcpu, &cpu, &node, nullptr) != 0)
+      {
+        return false;
+      }
+    constexpr size_t word_bits(8 * sizeof(unsigned long)),
+      max_nodes(1024);
+    if(node >= max_nodes)
+      {
+        return false;
+      }
+    std::array<unsigned long, max_nodes / word_bits> mask = {};
+    mask[node / word_bits] |= 1UL << (node % word_bits);
+    // MPOL_PREFERRED in <linux/mempolicy.h>
+    const int mpol_preferred(1);
+    return syscall(SYS_mbind, address, size, mpol_preferred, mask.data(),
+                   max_nodes + 1, 0)
+           == 0;
+#else
+    (void)address;
+    (void)size;
+    return false;
+#endif
+  }
+
+  // Map at least size bytes, aligned to arena_size, with the pages and
+  // NUMA policy of the placement.
+  void *map_arena(const size_t &size)
+  {
+    const size_t mapped_size((size + arena_size - 1) / arena_size
+                             * arena_size);
+    void *result(MAP_FAILED);
+    bool is_huge(false);
+#ifdef MAP_HUGETLB
+    if(placement.pages == Limb_Pages::huge)
+      {
+        result = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        is_huge = (result != MAP_FAILED);
+      }
+#endif
+    if(result == MAP_FAILED)
+      {
+        // Transparent huge pages need the mapping to be aligned, so map
+        // an extra arena_size and trim the ends.
+        void *mapping(mmap(nullptr, mapped_size + arena_size,
+                           PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if(mapping == MAP_FAILED)
+          {
+            std::fprintf(stderr, "limb_pool: cannot map %zu bytes\n",
+                         mapped_size);
+            std::abort();
+          }
+        char *begin(static_cast<char *>(mapping)),
+          *aligned(reinterpret_cast<char *>(
+            (reinterpret_cast<uintptr_t>(begin) + arena_size - 1)
+            / arena_size * arena_size));
+        if(aligned != begin)
+          {
+            munmap(begin, aligned - begin);
+          }
+        munmap(aligned + mapped_size, begin + arena_size - aligned);
+        result = aligned;
+#ifdef MADV_HUGEPAGE
+        if(placement.pages != Limb_Pages::normal)
+          {
+            is_huge = (madvise(result, mapped_size, MADV_HUGEPAGE) == 0);
+          }
+#endif
+      }
+    ++pool.statistics.arenas;
+    ++shared_pool().arenas;
+    pool.statistics.arena_bytes += mapped_size;
+    if(is_huge)
+      {
+        pool.statistics.huge_page_bytes += mapped_size;
+      }
+    if(placement.numa_local)
+      {
+        if(bind_to_local_node(result, mapped_size))
+          {
+            pool.statistics.numa_local_bytes += mapped_size;
+          }
+        // Fault in every page now, from this thread, so that first
+        // touch also puts them on this node where binding is not
+        // supported.
+        std::memset(result, 0, mapped_size);
+      }
+    return result;
+  }
+
+  // Use a remainder of the arena of an exited thread that has room for
+  // size bytes, if there is one.
+  bool take_arena_remainder(const size_t &size)
+  {
+    Shared_Pool &shared(shared_pool());
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    for(auto &remainder : shared.arena_remainders)
+      {
+        if(size_t(remainder.second - remainder.first) >= size)
+          {
+            std::swap(remainder, shared.arena_remainders.back());
+            pool.arena_next = shared.arena_remainders.back().first;
+            pool.arena_end = shared.arena_remainders.back().second;
+            shared.arena_remainders.pop_back();
+            return true;
+          }
+      }
+    return false;
+  }
+
+  // size bytes from the calling thread's current arena.  size is a
+  // multiple of 16 bytes, so blocks stay aligned.  A request larger
+  // than a quarter of an arena gets a mapping of its own, and the
+  // rest of that mapping becomes the current arena if it is larger
+  // than what is left of the current one.
+  void *allocate_from_arena(const size_t &size)
+  {
+    if(size_t(pool.arena_end - pool.arena_next) >= size)
+      {
+        void *result(pool.arena_next);
+        pool.arena_next += size;
+        return result;
+      }
+    if(size <= arena_size / 4 && take_arena_remainder(size))
+      {
+        return allocate_from_arena(size);
+      }
+    const size_t mapped_size(std::max(
+      arena_size, (size + arena_size - 1) / arena_size * arena_size));
+    char *result(static_cast<char *>(map_arena(mapped_size)));
+    if(mapped_size - size > size_t(pool.arena_end - pool.arena_next))
+      {
+        pool.arena_next = result + size;
+        pool.arena_end = result + mapped_size;
+      }
+    return result;
+  }
+
+  // Index of the smallest size class that holds 'size' bytes, or
+  // num_classes if it is too large for the pool.
+  size_t size_class(const size_t &size)
+  {
+    size_t result(0);
+    while(result < num_classes
+          && (size_t(1) << (result + min_class_log2)) < size)
+      {
+        ++result;
+      }
+    return result;
+  }
+
+  // Move up to refill_bytes of the shared free list of a class to the
+  // calling thread.
+  void refill_class(const size_t &size_class_index, const size_t &class_size)
+  {
+    Shared_Pool &shared(shared_pool());
+    if(shared.bytes[size_class_index].load(std::memory_order_relaxed) == 0)
+      {
+        return;
+      }
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    Free_Block *&shared_head(shared.free_lists[size_class_index]);
+    Free_Block *&head(pool.free_lists[size_class_index]);
+    int64_t moved(0);
+    while(shared_head != nullptr && moved < refill_bytes)
+      {
+        Free_Block *block(shared_head);
+        shared_head = block->next;
+        block->next = head;
+        head = block;
+        moved += class_size;
+      }
+    shared.bytes[size_class_index] -= moved;
+    pool.statistics.pooled_bytes += moved;
+  }
+
+  void *allocate_class(const size_t &size_class_index, const size_t &size)
+  {
+    if(size_class_index == num_classes)
+      {
+        return checked_malloc(size);
+      }
+    Free_Block *&head(pool.free_lists[size_class_index]);
+    const size_t class_size(size_t(1) << (size_class_index + min_class_log2));
+    if(head == nullptr)
+      {
+        refill_class(size_class_index, class_size);
+      }
+    if(head != nullptr)
+      {
+        Free_Block *result(head);
+        head = head->next;
+        ++pool.statistics.reused;
+        pool.statistics.pooled_bytes -= class_size;
+        return result;
+      }
+    return placement.uses_arenas() ? allocate_from_arena(class_size)
+                                   : checked_malloc(class_size);
+  }
+
+  void free_class(void *pointer, const size_t &size_class_index)
+  {
+    if(size_class_index == num_classes)
+      {
+        std::free(pointer);
+        return;
+      }
+    const size_t class_size(size_t(1) << (size_class_index + min_class_log2));
+    if(!placement.uses_arenas()
+       && pool.statistics.pooled_bytes + int64_t(class_size)
+            > max_pooled_bytes)
+      {
+        std::free(pointer);
+        return;
+      }
+    Free_Block *block(static_cast<Free_Block *>(pointer));
+    block->next = pool.free_lists[size_class_index];
+    pool.free_lists[size_class_index] = block;
+    pool.statistics.pooled_bytes += class_size;
+  }
+
+#ifdef SDPB_FIXED_PRECISION
+  // Take up to refill_bytes of the shared slab blocks, or a remainder
+  // of a slab of an exited thread.
+  void refill_slab()
+  {
+    Shared_Pool &shared(shared_pool());
+    if(shared.slab_blocks.load(std::memory_order_relaxed) == 0
+       && pool.slab_next != pool.slab_end)
+      {
+        return;
+      }
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    int64_t moved(0);
+    while(shared.slab_free_list != nullptr
+          && moved * int64_t(slab_block_size) < refill_bytes)
+      {
+        Free_Block *block(shared.slab_free_list);
+        shared.slab_free_list = block->next;
+        block->next = pool.slab_free_list;
+        pool.slab_free_list = block;
+        ++moved;
+      }
+    shared.slab_blocks -= moved;
+    if(pool.slab_free_list == nullptr && pool.slab_next == pool.slab_end
+       && !shared.slab_remainders.empty())
+      {
+        pool.slab_next = shared.slab_remainders.back().first;
+        pool.slab_end = shared.slab_remainders.back().second;
+        shared.slab_remainders.pop_back();
+      }
+  }
+
+  void *allocate_slab_block()
+  {
+    if(pool.slab_free_list == nullptr)
+      {
+        refill_slab();
+      }
+    if(pool.slab_free_list != nullptr)
+      {
+        Free_Block *result(pool.slab_free_list);
+        pool.slab_free_list = result->next;
+        ++pool.statistics.reused;
+        return result;
+      }
+    if(pool.slab_next == pool.slab_end)
+      {
+        pool.slab_next = static_cast<char *>(
+          placement.uses_arenas()
+            ? allocate_from_arena(slab_block_size * blocks_per_slab)
+            : checked_malloc(slab_block_size * blocks_per_slab));
+        pool.slab_end = pool.slab_next + slab_block_size * blocks_per_slab;
+        pool.statistics.slab_bytes += slab_block_size * blocks_per_slab;
+      }
+    void *result(pool.slab_next);
+    pool.slab_next += slab_block_size;
+    return result;
+  }
+
+  void free_slab_block(void *pointer)
+  {
+    Free_Block *block(static_cast<Free_Block *>(pointer));
+    block->next = pool.slab_free_list;
+    pool.slab_free_list = block;
+  }
+#endif
+
+  // Hand the calling thread's blocks to the shared pool.  Without
+  // arenas, the blocks beyond max_pooled_bytes in the shared pool go
+  // back to malloc.
+  void return_to_shared_pool()
+  {
+    Shared_Pool &shared(shared_pool());
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    int64_t shared_bytes(0);
+    for(auto &bytes : shared.bytes)
+      {
+        shared_bytes += bytes;
+      }
+    for(size_t index = 0; index < num_classes; ++index)
+      {
+        const int64_t class_size(int64_t(1) << (index + min_class_log2));
+        Free_Block *block(pool.free_lists[index]);
+        while(block != nullptr)
+          {
+            Free_Block *next(block->next);
+            if(!placement.uses_arenas()
+               && shared_bytes + class_size > max_pooled_bytes)
+              {
+                std::free(block);
+              }
+            else
+              {
+                block->next = shared.free_lists[index];
+                shared.free_lists[index] = block;
+                shared.bytes[index] += class_size;
+                shared_bytes += class_size;
+              }
+            block = next;
+          }
+      }
+    if(pool.arena_next != pool.arena_end)
+      {
+        shared.arena_remainders.emplace_back(pool.arena_next, pool.arena_end);
+      }
+#ifdef SDPB_FIXED_PRECISION
+    while(pool.slab_free_list != nullptr)
+      {
+        Free_Block *block(pool.slab_free_list);
+        pool.slab_free_list = block->next;
+        block->next = shared.slab_free_list;
+        shared.slab_free_list = block;
+        ++shared.slab_blocks;
+      }
+    if(pool.slab_next != pool.slab_end)
+      {
+        shared.slab_remainders.emplace_back(pool.slab_next, pool.slab_end);
+      }
+#endif
+    const Limb_Pool_Statistics statistics(pool.statistics);
+    pool = {};
+    pool.statistics = statistics;
+    pool.statistics.pooled_bytes = 0;
+    pool.is_return_registered = true;
+  }
+
+  struct Pool_Return
+  {
+    ~Pool_Return() { return_to_shared_pool(); }
+  };
+
+  void register_return()
+  {
+    if(!pool.is_return_registered)
+      {
+        pool.is_return_registered = true;
+        thread_local Pool_Return pool_return;
+        (void)pool_return;
+      }
+  }
+
+  void *pool_allocate(size_t size)
+  {
+    register_return();
+    ++pool.statistics.allocations;
+#ifdef SDPB_FIXED_PRECISION
+    if(size == slab_block_size)
+      {
+        return allocate_slab_block();
+      }
+#endif
+    return allocate_class(size_class(size), size);
+  }
+
+  void *pool_reallocate(void *pointer, size_t old_size, size_t new_size)
+  {
+    register_return();
+    ++pool.statistics.reallocations;
+#ifdef SDPB_FIXED_PRECISION
+    if(old_size == slab_block_size || new_size == slab_block_size)
+      {
+        if(old_size == new_size)
+          {
+            return pointer;
+          }
+        void *result(new_size == slab_block_size
+                       ? allocate_slab_block()
+                       : allocate_class(size_class(new_size), new_size));
+        std::memcpy(result, pointer, std::min(old_size, new_size));
+        if(old_size == slab_block_size)
+          {
+            free_slab_block(pointer);
+          }
+        else
+          {
+            free_class(pointer, size_class(old_size));
+          }
+        return result;
+      }
+#endif
+    const size_t old_class(size_class(old_size)),
+      new_class(size_class(new_size));
+    if(old_class == new_class && new_class != num_classes)
+      {
+        return pointer;
+      }
+    if(old_class == num_classes && new_class == num_classes)
+      {
+        void *result(std::realloc(pointer, new_size));
+        if(result == nullptr)
+          {
+            std::fprintf(stderr, "limb_pool: cannot allocate %zu bytes\n",
+                         new_size);
+            std::abort();
+          }
+        return result;
+      }
+    void *result(allocate_class(new_class, new_size));
+    std::memcpy(result, pointer, std::min(old_size, new_size));
+    free_class(pointer, old_class);
+    return result;
+  }
+
+  void pool_free(void *pointer, size_t size)
+  {
+    // Like free(), accept null pointers.
+    if(pointer == nullptr)
+      {
+        return;
+      }
+    register_return();
+    ++pool.statistics.frees;
+#ifdef SDPB_FIXED_PRECISION
+    if(size == slab_block_size)
+      {
+        free_slab_block(pointer);
+        return;
+      }
+#endif
+    free_class(pointer, size_class(size));
+  }
+}
+
+void install_limb_pool()
+{
+  mp_set_memory_functions(pool_allocate, pool_reallocate, pool_free);
+}
+
+void set_limb_placement(const Limb_Placement &new_placement)
+{
+  placement = new_placement;
+}
+
+Limb_Pool_Statistics limb_pool_statistics()
+{
+  Limb_Pool_Statistics result(pool.statistics);
+  Shared_Pool &shared(shared_pool());
+  for(auto &bytes : shared.bytes)
+    {
+      result.shared_pooled_bytes += bytes;
+    }
+  result.process_arenas = shared.arenas;
+  return result;
+}
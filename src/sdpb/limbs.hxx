@@ -0,0 +1,66 @@
+#pragma once
+
+#include <El.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// limbs: BigFloat matrix products on vector units.
+//
+// GMP works on one mpf at a time, so Elemental's BigFloat kernels
+// never use SIMD instructions.  A Limb_Matrix instead stores a set of
+// vectors v_0, v_1, ... of the same length n, each as a scale
+// exponent e_v and num_digits signed digits per element,
+//
+//   v(k) = 2^{e_v} \sum_d D_d(v, k) 2^{-bits (d+1)},  |D_d(v, k)| < 2^bits
+//
+// The layout is struct-of-limbs: digit d of all n elements of a
+// vector is contiguous.  The dot product of two vectors is then a sum
+// over pairs of digits of plain integer dot products
+//
+//   v . w = 2^{e_v + e_w} \sum_t 2^{-bits (t+2)}
+//             \sum_{d+d'=t} \sum_k D_d(v, k) D_{d'}(w, k)
+//
+// which vectorize.  Each integer product is less than 2^{2 bits}, so
+// the inner sums are exact in 64 bit integers for up to
+// 2^{63 - 2 bits} elements at a time.  The sum over t is done in GMP
+// integers, and only the final result is rounded.  The only other
+// error comes from dropping the terms with t >= num_digits, which is
+// covered by the guard bits.
+//
+// The integer kernels are compiled for AVX-512, AVX2 and plain x86-64,
+// and the version for the running CPU is picked when the program
+// starts.
+
+class Limb_Matrix
+{
+public:
+  static constexpr size_t bits = 24;
+
+  size_t num_vectors = 0, length = 0, num_digits = 0;
+  std::vector<int64_t> exponents;
+  std::vector<int32_t> digits;
+
+  // The vectors are the columns of A, or the rows of A if
+  // vectors_are_columns is false.  Enough digits are kept for dot
+  // products accurate to 'precision' bits.
+  Limb_Matrix(const El::Matrix<El::BigFloat> &A,
+              const bool &vectors_are_columns, const mp_bitcnt_t &precision);
+
+  const int32_t *digit(const size_t &d, const size_t &vector) const
+  {
+    return digits.data() + (d * num_vectors + vector) * length;
+  }
+};
+
+// result = v . w, rounded to the precision of result
+void limb_dot(const Limb_Matrix &V, const size_t &v, const Limb_Matrix &W,
+              const size_t &w, El::BigFloat &result);
+
+// C := alpha op(A) op(B) + beta C, with the same arguments as
+// block_gemm.  Matrices on more than one process use Elemental.
+void limb_gemm(const El::Orientation &orientation_A,
+               const El::Orientation &orientation_B, const El::BigFloat &alpha,
+               const El::DistMatrix<El::BigFloat> &A,
+               const El::DistMatrix<El::BigFloat> &B,
+               const El::BigFloat &beta, El::DistMatrix<El::BigFloat> &C);
@@ -0,0 +1,170 @@
+#include "../limbs.hxx"
+
+#include <limits>
+
+int64_t digit_dot(const int32_t *a, const int32_t *b, const size_t &length);
+
+namespace
+{
+  size_t ceil_log2(const size_t &n)
+  {
+    size_t result(0);
+    while((size_t(1) << result) < n)
+      {
+        ++result;
+      }
+    return result;
+  }
+
+  // Bits [offset, offset + Limb_Matrix::bits) of the nonnegative r
+  int32_t bits_at(const mpz_t r, const size_t &offset)
+  {
+    const size_t limb(offset / GMP_NUMB_BITS), shift(offset % GMP_NUMB_BITS);
+    mp_limb_t result(mpz_getlimbn(r, limb) >> shift);
+    if(shift + Limb_Matrix::bits > GMP_NUMB_BITS)
+      {
+        result |= mpz_getlimbn(r, limb + 1) << (GMP_NUMB_BITS - shift);
+      }
+    return result & ((mp_limb_t(1) << Limb_Matrix::bits) - 1);
+  }
+
+  // x *= 2^exponent
+  void mul_2exp(mpf_ptr x, const int64_t &exponent)
+  {
+    if(exponent >= 0)
+      {
+        mpf_mul_2exp(x, x, exponent);
+      }
+    else
+      {
+        mpf_div_2exp(x, x, -exponent);
+      }
+  }
+
+  // acc += x
+  void add_int128(mpz_t acc, const __int128 &x, mpz_t temp)
+  {
+    const unsigned __int128 magnitude(x < 0 ? -(unsigned __int128)(x)
+                                            : (unsigned __int128)(x));
+    const uint64_t words[2] = {uint64_t(magnitude),
+                               uint64_t(magnitude >> 64)};
+    mpz_import(temp, 2, -1, sizeof(uint64_t), 0, 0, words);
+    if(x < 0)
+      {
+        mpz_sub(acc, acc, temp);
+      }
+    else
+      {
+        mpz_add(acc, acc, temp);
+      }
+  }
+
+  // The 64 bit digit_dot sums are exact for this many elements.
+  constexpr size_t max_chunk(size_t(1) << (62 - 2 * Limb_Matrix::bits));
+}
+
+Limb_Matrix::Limb_Matrix(const El::Matrix<El::BigFloat> &A,
+                         const bool &vectors_are_columns,
+                         const mp_bitcnt_t &precision)
+    : num_vectors(vectors_are_columns ? A.Width() : A.Height()),
+      length(vectors_are_columns ? A.Height() : A.Width())
+{
+  auto element([&](const size_t &vector, const size_t &k) {
+    return vectors_are_columns ? A(k, vector).gmp_float.get_mpf_t()
+                               : A(vector, k).gmp_float.get_mpf_t();
+  });
+
+  // Guard bits for the truncated digits and terms, as in mpmat.
+  const size_t guard(16 + ceil_log2(std::max(length, size_t(1))));
+  num_digits = (precision + guard + bits - 1) / bits;
+  num_digits = (precision + guard + ceil_log2(num_digits) + bits - 1) / bits;
+
+  exponents.assign(num_vectors, 0);
+  digits.assign(num_digits * num_vectors * length, 0);
+
+  mpf_class scaled;
+  mpz_t integer;
+  mpz_init(integer);
+  for(size_t vector = 0; vector < num_vectors; ++vector)
+    {
+      long max_exponent(std::numeric_limits<long>::min());
+      for(size_t k = 0; k < length; ++k)
+        {
+          if(mpf_sgn(element(vector, k)) != 0)
+            {
+              long exponent;
+              mpf_get_d_2exp(&exponent, element(vector, k));
+              max_exponent = std::max(max_exponent, exponent);
+            }
+        }
+      if(max_exponent == std::numeric_limits<long>::min())
+        {
+          continue;
+        }
+      exponents[vector] = max_exponent;
+
+      for(size_t k = 0; k < length; ++k)
+        {
+          mpf_srcptr x(element(vector, k));
+          const int sign(mpf_sgn(x));
+          if(sign == 0)
+            {
+              continue;
+            }
+          // |x| < 2^max_exponent, so this is less than
+          // 2^(bits num_digits).
+          scaled.set_prec(mpf_get_prec(x));
+          mpf_abs(scaled.get_mpf_t(), x);
+          mul_2exp(scaled.get_mpf_t(),
+                   int64_t(bits * num_digits) - max_exponent);
+          mpz_set_f(integer, scaled.get_mpf_t());
+          for(size_t d = 0; d < num_digits; ++d)
+            {
+              const int32_t value(
+                bits_at(integer, bits * (num_digits - 1 - d)));
+              digits[(d * num_vectors + vector) * length + k]
+                = sign < 0 ? -value : value;
+            }
+        }
+    }
+  mpz_clear(integer);
+}
+
+void limb_dot(const Limb_Matrix &V, const size_t &v, const Limb_Matrix &W,
+              const size_t &w, El::BigFloat &result)
+{
+  if(V.length != W.length)
+    {
+      throw std::runtime_error("limb_dot: vectors have lengths "
+                               + std::to_string(V.length) + " and "
+                               + std::to_string(W.length));
+    }
+  const size_t num_digits(std::min(V.num_digits, W.num_digits));
+
+  mpz_t sum, temp;
+  mpz_init(sum);
+  mpz_init(temp);
+  for(size_t t = 0; t < num_digits; ++t)
+    {
+      // Products with t = d + d'.  There are at most num_digits chunks
+      // of at most max_chunk terms, which fits.
+      __int128 term(0);
+      for(size_t d = 0; d <= t; ++d)
+        {
+          const int32_t *a(V.digit(d, v)), *b(W.digit(t - d, w));
+          for(size_t begin = 0; begin < V.length; begin += max_chunk)
+            {
+              term += digit_dot(a + begin, b + begin,
+                                std::min(max_chunk, V.length - begin));
+            }
+        }
+      mpz_mul_2exp(sum, sum, Limb_Matrix::bits);
+      add_int128(sum, term, temp);
+    }
+  mpf_ptr result_mpf(result.gmp_float.get_mpf_t());
+  mpf_set_z(result_mpf, sum);
+  mul_2exp(result_mpf, V.exponents[v] + W.exponents[w]
+                         - int64_t(Limb_Matrix::bits * (num_digits + 1)));
+  mpz_clear(sum);
+  mpz_clear(temp);
+}
@@ -0,0 +1,28 @@
+#include <cstddef>
+#include <cstdint>
+
+// The integer kernel behind Limb_Matrix.  GCC and clang build a copy
+// of it for each target, and the dynamic loader picks the best one
+// for the CPU.  The plain loop is enough for the compiler to use
+// vpmuldq and wide integer adds.
+
+#if defined(__x86_64__) && defined(__GNUC__)                                  \
+  && (!defined(__clang__) || __clang_major__ >= 14)
+#define SDPB_TARGET_CLONES                                                    \
+  __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define SDPB_TARGET_CLONES
+#endif
+
+// \sum_k a[k] b[k].  The caller guarantees that this does not
+// overflow.
+SDPB_TARGET_CLONES
+int64_t digit_dot(const int32_t *a, const int32_t *b, const size_t &length)
+{
+  int64_t result(0);
+  for(size_t k = 0; k < length; ++k)
+    {
+      result += int64_t(a[k]) * int64_t(b[k]);
+    }
+  return result;
+}
@@ -0,0 +1,41 @@
+#include "../limbs.hxx"
+#include "../solve/block_kernels.hxx"
+
+void limb_gemm(const El::Orientation &orientation_A,
+               const El::Orientation &orientation_B, const El::BigFloat &alpha,
+               const El::DistMatrix<El::BigFloat> &A,
+               const El::DistMatrix<El::BigFloat> &B,
+               const El::BigFloat &beta, El::DistMatrix<El::BigFloat> &C)
+{
+  if(!is_single_process(C))
+    {
+      block_gemm(orientation_A, orientation_B, alpha, A, B, beta, C);
+      return;
+    }
+
+  // The rows of op(A) and the columns of op(B).
+  const Limb_Matrix A_limbs(A.LockedMatrix(),
+                            orientation_A != El::Orientation::NORMAL,
+                            El::gmp::Precision()),
+    B_limbs(B.LockedMatrix(), orientation_B == El::Orientation::NORMAL,
+            El::gmp::Precision());
+
+  El::Matrix<El::BigFloat> &C_local(C.Matrix());
+  El::BigFloat product;
+  for(int64_t column = 0; column < C_local.Width(); ++column)
+    for(int64_t row = 0; row < C_local.Height(); ++row)
+      {
+        El::BigFloat &element(C_local(row, column));
+        limb_dot(A_limbs, row, B_limbs, column, product);
+        product *= alpha;
+        if(beta == El::BigFloat(0))
+          {
+            element = product;
+          }
+        else
+          {
+            element *= beta;
+            element += product;
+          }
+      }
+}
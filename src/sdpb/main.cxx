@@ -6,22 +6,17 @@
 //=======================================================================
 
 #include "SDP_Solver_Parameters.hxx"
-#include "Block_Info.hxx"
-#include "../Timers.hxx"
+#include "limb_pool.hxx"
 
 #include <El.hpp>
 
-#include <boost/date_time/posix_time/posix_time.hpp>
-
-Timers
-solve(const Block_Info &block_info, const SDP_Solver_Parameters &parameters);
-
-void write_timing(const boost::filesystem::path &checkpoint_out,
-                  const Block_Info &block_info, const Timers &timers,
-                  const bool &debug, El::Matrix<int32_t> &block_timings);
+void run_sdpb(SDP_Solver_Parameters &parameters);
 
 int main(int argc, char **argv)
 {
+  // This has to come before anything, including MPI and Elemental,
+  // allocates GMP limbs.
+  install_limb_pool();
   El::Environment env(argc, argv);
 
   try
@@ -31,71 +26,12 @@ int main(int argc, char **argv)
         {
           return 0;
         }
+      Limb_Placement placement;
+      placement.numa_local = parameters.numa_local_limbs;
+      placement.pages = parameters.limb_pages;
+      set_limb_placement(placement);
 
-      El::gmp::SetPrecision(parameters.precision);
-      if(parameters.verbosity >= Verbosity::regular && El::mpi::Rank() == 0)
-        {
-          std::cout << "SDPB started at "
-                    << boost::posix_time::second_clock::local_time() << '\n'
-                    << parameters << '\n';
-        }
-
-      Block_Info block_info(parameters.sdp_directory, parameters.checkpoint_in,
-                            parameters.procs_per_node,
-                            parameters.proc_granularity, parameters.verbosity);
-      // Only generate a block_timings file if
-      // 1) We are running in parallel
-      // 2) We did not load a block_timings file
-      // 3) We are not going to load a checkpoint.
-      if(El::mpi::Size(El::mpi::COMM_WORLD) > 1
-         && block_info.block_timings_filename.empty()
-         && !exists(parameters.checkpoint_in / "checkpoint.0"))
-        {
-          if(parameters.verbosity >= Verbosity::regular
-             && El::mpi::Rank() == 0)
-            {
-              std::cout << "Performing a timing run\n";
-            }
-          SDP_Solver_Parameters timing_parameters(parameters);
-          timing_parameters.max_iterations = 2;
-          timing_parameters.no_final_checkpoint = true;
-          timing_parameters.checkpoint_interval
-            = std::numeric_limits<int64_t>::max();
-          timing_parameters.max_runtime = std::numeric_limits<int64_t>::max();
-          timing_parameters.duality_gap_threshold = 0;
-          timing_parameters.primal_error_threshold = 0;
-          timing_parameters.dual_error_threshold = 0;
-          if(timing_parameters.verbosity != Verbosity::debug)
-            {
-              timing_parameters.verbosity = Verbosity::none;
-            }
-          Timers timers(solve(block_info, timing_parameters));
-
-          El::Matrix<int32_t> block_timings(block_info.dimensions.size(), 1);
-          write_timing(timing_parameters.checkpoint_out, block_info, timers,
-                       timing_parameters.verbosity >= Verbosity::debug,
-                       block_timings);
-          El::mpi::Barrier(El::mpi::COMM_WORLD);
-          Block_Info new_info(
-            parameters.sdp_directory, block_timings, parameters.procs_per_node,
-            parameters.proc_granularity, parameters.verbosity);
-          std::swap(block_info, new_info);
-
-          parameters.max_runtime -= timers.front().second.elapsed_seconds();
-        }
-      else if(!block_info.block_timings_filename.empty()
-              && block_info.block_timings_filename
-                   != (parameters.checkpoint_out / "block_timings"))
-        {
-          if(El::mpi::Rank() == 0)
-            {
-              create_directories(parameters.checkpoint_out);
-              copy_file(block_info.block_timings_filename,
-                        parameters.checkpoint_out / "block_timings",
-                        boost::filesystem::copy_option::overwrite_if_exists);
-            }
-        }
-      solve(block_info, parameters);
+      run_sdpb(parameters);
     }
   catch(std::exception &e)
     {
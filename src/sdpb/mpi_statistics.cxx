@@ -0,0 +1,319 @@
+// Count the MPI traffic of this process through the PMPI profiling
+// interface.  Each wrapper forwards to the PMPI_ version of the call,
+// which every MPI implementation provides for this purpose.  Because
+// the executable defines these symbols, they also intercept the calls
+// made inside Elemental, including its redistributions.
+//
+// Every call counts as one message.  The bytes are the data passed in
+// the send buffers by this process: the outgoing message for
+// point-to-point calls and the local contribution for collectives.
+// The time spent inside blocking calls is added to the blocking total.
+// Timer intervals take the difference of these totals, so the counts
+// show up for each phase in the profile and the metrics.
+//
+// Only the calls that SDPB and Elemental use in the solver are
+// wrapped.  MPI-IO is not counted.
+
+#include "../Timer.hxx"
+
+#include <mpi.h>
+
+#if MPI_VERSION >= 3
+
+namespace
+{
+  int64_t type_size(MPI_Datatype datatype)
+  {
+    int result(0);
+    if(datatype != MPI_DATATYPE_NULL)
+      {
+        PMPI_Type_size(datatype, &result);
+      }
+    return result;
+  }
+
+  int64_t sum(const int counts[], MPI_Comm comm)
+  {
+    int num_procs;
+    PMPI_Comm_size(comm, &num_procs);
+    int64_t result(0);
+    for(int rank = 0; rank < num_procs; ++rank)
+      {
+        result += counts[rank];
+      }
+    return result;
+  }
+
+  int rank(MPI_Comm comm)
+  {
+    int result;
+    PMPI_Comm_rank(comm, &result);
+    return result;
+  }
+
+  void add_message(const int64_t &bytes)
+  {
+    Mpi_Sample::Counters &counters(Mpi_Sample::counters());
+    counters.messages.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  // Count a call and time it as blocking.
+  template <typename Call> int blocking(const int64_t &bytes, Call call)
+  {
+    add_message(bytes);
+    const auto start(std::chrono::high_resolution_clock::now());
+    const int result(call());
+    Mpi_Sample::counters().blocking.fetch_add(
+      (std::chrono::high_resolution_clock::now() - start).count(),
+      std::memory_order_relaxed);
+    return result;
+  }
+
+  // Time a call as blocking without counting a message, for waits on
+  // requests that were already counted when they were posted.
+  template <typename Call> int waiting(Call call)
+  {
+    const auto start(std::chrono::high_resolution_clock::now());
+    const int result(call());
+    Mpi_Sample::counters().blocking.fetch_add(
+      (std::chrono::high_resolution_clock::now() - start).count(),
+      std::memory_order_relaxed);
+    return result;
+  }
+}
+
+extern "C" {
+
+int MPI_Send(const void *buf, int count, MPI_Datatype datatype, int dest,
+             int tag, MPI_Comm comm)
+{
+  return blocking(count * type_size(datatype), [&]() {
+    return PMPI_Send(buf, count, datatype, dest, tag, comm);
+  });
+}
+
+int MPI_Isend(const void *buf, int count, MPI_Datatype datatype, int dest,
+              int tag, MPI_Comm comm, MPI_Request *request)
+{
+  add_message(count * type_size(datatype));
+  return PMPI_Isend(buf, count, datatype, dest, tag, comm, request);
+}
+
+int MPI_Recv(void *buf, int count, MPI_Datatype datatype, int source,
+             int tag, MPI_Comm comm, MPI_Status *status)
+{
+  return blocking(0, [&]() {
+    return PMPI_Recv(buf, count, datatype, source, tag, comm, status);
+  });
+}
+
+int MPI_Irecv(void *buf, int count, MPI_Datatype datatype, int source,
+              int tag, MPI_Comm comm, MPI_Request *request)
+{
+  add_message(0);
+  return PMPI_Irecv(buf, count, datatype, source, tag, comm, request);
+}
+
+int MPI_Sendrecv(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                 int dest, int sendtag, void *recvbuf, int recvcount,
+                 MPI_Datatype recvtype, int source, int recvtag,
+                 MPI_Comm comm, MPI_Status *status)
+{
+  return blocking(sendcount * type_size(sendtype), [&]() {
+    return PMPI_Sendrecv(sendbuf, sendcount, sendtype, dest, sendtag,
+                         recvbuf, recvcount, recvtype, source, recvtag, comm,
+                         status);
+  });
+}
+
+int MPI_Sendrecv_replace(void *buf, int count, MPI_Datatype datatype,
+                         int dest, int sendtag, int source, int recvtag,
+                         MPI_Comm comm, MPI_Status *status)
+{
+  return blocking(count * type_size(datatype), [&]() {
+    return PMPI_Sendrecv_replace(buf, count, datatype, dest, sendtag, source,
+                                 recvtag, comm, status);
+  });
+}
+
+int MPI_Wait(MPI_Request *request, MPI_Status *status)
+{
+  return waiting([&]() { return PMPI_Wait(request, status); });
+}
+
+int MPI_Waitall(int count, MPI_Request array_of_requests[],
+                MPI_Status array_of_statuses[])
+{
+  return waiting([&]() {
+    return PMPI_Waitall(count, array_of_requests, array_of_statuses);
+  });
+}
+
+int MPI_Waitany(int count, MPI_Request array_of_requests[], int *index,
+                MPI_Status *status)
+{
+  return waiting([&]() {
+    return PMPI_Waitany(count, array_of_requests, index, status);
+  });
+}
+
+int MPI_Barrier(MPI_Comm comm)
+{
+  return blocking(0, [&]() { return PMPI_Barrier(comm); });
+}
+
+int MPI_Bcast(void *buffer, int count, MPI_Datatype datatype, int root,
+              MPI_Comm comm)
+{
+  const int64_t bytes(rank(comm) == root ? count * type_size(datatype) : 0);
+  return blocking(bytes, [&]() {
+    return PMPI_Bcast(buffer, count, datatype, root, comm);
+  });
+}
+
+int MPI_Reduce(const void *sendbuf, void *recvbuf, int count,
+               MPI_Datatype datatype, MPI_Op op, int root, MPI_Comm comm)
+{
+  return blocking(count * type_size(datatype), [&]() {
+    return PMPI_Reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+  });
+}
+
+int MPI_Allreduce(const void *sendbuf, void *recvbuf, int count,
+                  MPI_Datatype datatype, MPI_Op op, MPI_Comm comm)
+{
+  return blocking(count * type_size(datatype), [&]() {
+    return PMPI_Allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+  });
+}
+
+int MPI_Reduce_scatter(const void *sendbuf, void *recvbuf,
+                       const int recvcounts[], MPI_Datatype datatype,
+                       MPI_Op op, MPI_Comm comm)
+{
+  return blocking(sum(recvcounts, comm) * type_size(datatype), [&]() {
+    return PMPI_Reduce_scatter(sendbuf, recvbuf, recvcounts, datatype, op,
+                               comm);
+  });
+}
+
+int MPI_Reduce_scatter_block(const void *sendbuf, void *recvbuf,
+                             int recvcount, MPI_Datatype datatype, MPI_Op op,
+                             MPI_Comm comm)
+{
+  int num_procs;
+  PMPI_Comm_size(comm, &num_procs);
+  return blocking(
+    int64_t(recvcount) * num_procs * type_size(datatype), [&]() {
+      return PMPI_Reduce_scatter_block(sendbuf, recvbuf, recvcount, datatype,
+                                       op, comm);
+    });
+}
+
+int MPI_Ireduce_scatter(const void *sendbuf, void *recvbuf,
+                        const int recvcounts[], MPI_Datatype datatype,
+                        MPI_Op op, MPI_Comm comm, MPI_Request *request)
+{
+  add_message(sum(recvcounts, comm) * type_size(datatype));
+  return PMPI_Ireduce_scatter(sendbuf, recvbuf, recvcounts, datatype, op,
+                              comm, request);
+}
+
+int MPI_Gather(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+               void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+               MPI_Comm comm)
+{
+  return blocking(sendcount * type_size(sendtype), [&]() {
+    return PMPI_Gather(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+                       recvtype, root, comm);
+  });
+}
+
+int MPI_Gatherv(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                void *recvbuf, const int recvcounts[], const int displs[],
+                MPI_Datatype recvtype, int root, MPI_Comm comm)
+{
+  return blocking(sendcount * type_size(sendtype), [&]() {
+    return PMPI_Gatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts,
+                        displs, recvtype, root, comm);
+  });
+}
+
+int MPI_Scatter(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+                MPI_Comm comm)
+{
+  int64_t bytes(0);
+  if(rank(comm) == root)
+    {
+      int num_procs;
+      PMPI_Comm_size(comm, &num_procs);
+      bytes = int64_t(sendcount) * num_procs * type_size(sendtype);
+    }
+  return blocking(bytes, [&]() {
+    return PMPI_Scatter(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+                        recvtype, root, comm);
+  });
+}
+
+int MPI_Scatterv(const void *sendbuf, const int sendcounts[],
+                 const int displs[], MPI_Datatype sendtype, void *recvbuf,
+                 int recvcount, MPI_Datatype recvtype, int root,
+                 MPI_Comm comm)
+{
+  const int64_t bytes(
+    rank(comm) == root ? sum(sendcounts, comm) * type_size(sendtype) : 0);
+  return blocking(bytes, [&]() {
+    return PMPI_Scatterv(sendbuf, sendcounts, displs, sendtype, recvbuf,
+                         recvcount, recvtype, root, comm);
+  });
+}
+
+int MPI_Allgather(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                  void *recvbuf, int recvcount, MPI_Datatype recvtype,
+                  MPI_Comm comm)
+{
+  return blocking(sendcount * type_size(sendtype), [&]() {
+    return PMPI_Allgather(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+                          recvtype, comm);
+  });
+}
+
+int MPI_Allgatherv(const void *sendbuf, int sendcount,
+                   MPI_Datatype sendtype, void *recvbuf,
+                   const int recvcounts[], const int displs[],
+                   MPI_Datatype recvtype, MPI_Comm comm)
+{
+  return blocking(sendcount * type_size(sendtype), [&]() {
+    return PMPI_Allgatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts,
+                           displs, recvtype, comm);
+  });
+}
+
+int MPI_Alltoall(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                 void *recvbuf, int recvcount, MPI_Datatype recvtype,
+                 MPI_Comm comm)
+{
+  int num_procs;
+  PMPI_Comm_size(comm, &num_procs);
+  return blocking(
+    int64_t(sendcount) * num_procs * type_size(sendtype), [&]() {
+      return PMPI_Alltoall(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+                           recvtype, comm);
+    });
+}
+
+int MPI_Alltoallv(const void *sendbuf, const int sendcounts[],
+                  const int sdispls[], MPI_Datatype sendtype, void *recvbuf,
+                  const int recvcounts[], const int rdispls[],
+                  MPI_Datatype recvtype, MPI_Comm comm)
+{
+  return blocking(sum(sendcounts, comm) * type_size(sendtype), [&]() {
+    return PMPI_Alltoallv(sendbuf, sendcounts, sdispls, sendtype, recvbuf,
+                          recvcounts, rdispls, recvtype, comm);
+  });
+}
+}
+
+#endif
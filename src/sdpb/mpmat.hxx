@@ -0,0 +1,39 @@
+#pragma once
+
+#include <El.hpp>
+
+// mpmat: multiprecision matrix products built on top of double
+// precision BLAS.
+//
+// Each BigFloat column is scaled by a power of two and split into
+// slices of a few bits each, stored as doubles.  Products of slices
+// are computed with double precision BLAS.  The slices are small
+// enough that the double precision sums are exact, so recombining the
+// slices gives the product to the full BigFloat precision.
+
+// Distributed matrices are sliced one panel of whole columns per rank,
+// so the products are always computed with local double precision
+// BLAS.  A, B and C must be on the same grid.
+
+// C := A^T A + beta C, only touching the uplo triangle of C.
+void mpmat_syrk(const El::UpperOrLower &uplo,
+                const El::DistMatrix<El::BigFloat> &A,
+                const El::BigFloat &beta, El::DistMatrix<El::BigFloat> &C);
+
+// C := A^T B + beta C
+void mpmat_gemm(const El::DistMatrix<El::BigFloat> &A,
+                const El::DistMatrix<El::BigFloat> &B,
+                const El::BigFloat &beta, El::DistMatrix<El::BigFloat> &C);
+
+// When SDPB is built with cuBLAS, the slice products run on the GPU
+// with a cuBLAS handle owned by this object, and the products may only
+// be called while one exists.  run_sdpb() keeps one for the whole run,
+// so that the handle is destroyed before MPI and the CUDA runtime
+// shut down.  Without cuBLAS this does nothing.
+struct Scoped_Mpmat_GPU
+{
+  Scoped_Mpmat_GPU();
+  ~Scoped_Mpmat_GPU();
+  Scoped_Mpmat_GPU(const Scoped_Mpmat_GPU &) = delete;
+  Scoped_Mpmat_GPU &operator=(const Scoped_Mpmat_GPU &) = delete;
+};
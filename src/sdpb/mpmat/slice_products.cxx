@@ -0,0 +1,257 @@
+#include "../mpmat.hxx"
+
+#include <El.hpp>
+
+#ifdef SDPB_USE_CUBLAS
+#include <cublas_v2.h>
+#include <cuda_runtime.h>
+#endif
+
+#include <functional>
+#include <stdexcept>
+
+// Call accumulate(t, product) with
+//
+//   product = \sum_{l+m=t} slices[l]^T slices[m]
+//
+// for each 0 <= t < slices.size(), only setting the uplo triangle, or
+// with
+//
+//   product = \sum_{l+m=t} left_slices[l]^T right_slices[m]
+//
+// for the general version.  Only one product is kept in memory at a
+// time.  These are plain
+// double precision products, so when SDPB is built with cuBLAS, they
+// are computed on the GPU.  The slices are uploaded once and reused
+// for every t.
+
+#ifdef SDPB_USE_CUBLAS
+namespace
+{
+  void check_cuda(const cudaError_t &error, const std::string &where)
+  {
+    if(error != cudaSuccess)
+      {
+        throw std::runtime_error("CUDA error in " + where + ": "
+                                 + cudaGetErrorString(error));
+      }
+  }
+
+  void check_cublas(const cublasStatus_t &status, const std::string &where)
+  {
+    if(status != CUBLAS_STATUS_SUCCESS)
+      {
+        throw std::runtime_error("cuBLAS error in " + where + ": "
+                                 + std::to_string(status));
+      }
+  }
+
+  struct Device_Buffer
+  {
+    double *data = nullptr;
+    explicit Device_Buffer(const size_t &size)
+    {
+      check_cuda(cudaMalloc(&data, std::max(size, size_t(1)) * sizeof(double)),
+                 "cudaMalloc");
+    }
+    ~Device_Buffer() { cudaFree(data); }
+    Device_Buffer(const Device_Buffer &) = delete;
+    Device_Buffer &operator=(const Device_Buffer &) = delete;
+  };
+
+  // Created by Scoped_Mpmat_GPU, because creating one is expensive.
+  cublasHandle_t current_handle;
+  bool has_handle(false);
+
+  cublasHandle_t &cublas_handle()
+  {
+    if(!has_handle)
+      {
+        throw std::runtime_error(
+          "mpmat: The GPU slice products need a Scoped_Mpmat_GPU");
+      }
+    return current_handle;
+  }
+}
+
+Scoped_Mpmat_GPU::Scoped_Mpmat_GPU()
+{
+  if(has_handle)
+    {
+      throw std::runtime_error("mpmat: Only one Scoped_Mpmat_GPU may exist");
+    }
+  check_cublas(cublasCreate(&current_handle), "cublasCreate");
+  has_handle = true;
+}
+
+Scoped_Mpmat_GPU::~Scoped_Mpmat_GPU()
+{
+  cublasDestroy(current_handle);
+  has_handle = false;
+}
+#else
+Scoped_Mpmat_GPU::Scoped_Mpmat_GPU() {}
+
+Scoped_Mpmat_GPU::~Scoped_Mpmat_GPU() {}
+#endif
+
+void slice_products(const El::UpperOrLower &uplo,
+                    const std::vector<El::Matrix<double>> &slices,
+                    const std::function<void(
+                      const size_t &t, const El::Matrix<double> &product)>
+                      &accumulate)
+{
+  const El::Int height(slices.empty() ? 0 : slices.front().Height()),
+    width(slices.empty() ? 0 : slices.front().Width());
+  if(height == 0 || width == 0)
+    {
+      return;
+    }
+  El::Matrix<double> product(width, width);
+
+#ifdef SDPB_USE_CUBLAS
+  cublasHandle_t &handle(cublas_handle());
+  const cublasFillMode_t fill(uplo == El::UpperOrLower::UPPER
+                                ? CUBLAS_FILL_MODE_UPPER
+                                : CUBLAS_FILL_MODE_LOWER);
+  const size_t slice_size(height * width);
+  Device_Buffer device_slices(slices.size() * slice_size),
+    device_product(width * width);
+  for(size_t l = 0; l < slices.size(); ++l)
+    {
+      check_cublas(cublasSetMatrix(height, width, sizeof(double),
+                                   slices[l].LockedBuffer(), slices[l].LDim(),
+                                   device_slices.data + l * slice_size,
+                                   height),
+                   "cublasSetMatrix");
+    }
+
+  const double one(1);
+  for(size_t t = 0; t < slices.size(); ++t)
+    {
+      check_cuda(
+        cudaMemset(device_product.data, 0, width * width * sizeof(double)),
+        "cudaMemset");
+      for(size_t l = 0; 2 * l <= t; ++l)
+        {
+          const size_t m(t - l);
+          const double *S_l(device_slices.data + l * slice_size),
+            *S_m(device_slices.data + m * slice_size);
+          if(l == m)
+            {
+              check_cublas(cublasDsyrk(handle, fill, CUBLAS_OP_T, width,
+                                       height, &one, S_l, height, &one,
+                                       device_product.data, width),
+                           "cublasDsyrk");
+            }
+          else
+            {
+              check_cublas(cublasDsyr2k(handle, fill, CUBLAS_OP_T,
+                                        width, height, &one, S_l, height, S_m,
+                                        height, &one, device_product.data,
+                                        width),
+                           "cublasDsyr2k");
+            }
+        }
+      check_cublas(cublasGetMatrix(width, width, sizeof(double),
+                                   device_product.data, width,
+                                   product.Buffer(), product.LDim()),
+                   "cublasGetMatrix");
+      accumulate(t, product);
+    }
+#else
+  for(size_t t = 0; t < slices.size(); ++t)
+    {
+      El::Zero(product);
+      for(size_t l = 0; 2 * l <= t; ++l)
+        {
+          const size_t m(t - l);
+          if(l == m)
+            {
+              El::Syrk(uplo, El::Orientation::TRANSPOSE, 1.0, slices[l], 1.0,
+                       product);
+            }
+          else
+            {
+              El::Syr2k(uplo, El::Orientation::TRANSPOSE, 1.0, slices[l],
+                        slices[m], 1.0, product);
+            }
+        }
+      accumulate(t, product);
+    }
+#endif
+}
+
+void slice_products(const std::vector<El::Matrix<double>> &left_slices,
+                    const std::vector<El::Matrix<double>> &right_slices,
+                    const std::function<void(
+                      const size_t &t, const El::Matrix<double> &product)>
+                      &accumulate)
+{
+  const El::Int height(left_slices.empty() ? 0
+                                           : left_slices.front().Height()),
+    left_width(left_slices.empty() ? 0 : left_slices.front().Width()),
+    right_width(right_slices.empty() ? 0 : right_slices.front().Width());
+  if(height == 0 || left_width == 0 || right_width == 0)
+    {
+      return;
+    }
+  El::Matrix<double> product(left_width, right_width);
+
+#ifdef SDPB_USE_CUBLAS
+  cublasHandle_t &handle(cublas_handle());
+  const size_t left_size(height * left_width),
+    right_size(height * right_width);
+  Device_Buffer device_left(left_slices.size() * left_size),
+    device_right(right_slices.size() * right_size),
+    device_product(left_width * right_width);
+  for(size_t l = 0; l < left_slices.size(); ++l)
+    {
+      check_cublas(cublasSetMatrix(height, left_width, sizeof(double),
+                                   left_slices[l].LockedBuffer(),
+                                   left_slices[l].LDim(),
+                                   device_left.data + l * left_size, height),
+                   "cublasSetMatrix");
+      check_cublas(cublasSetMatrix(height, right_width, sizeof(double),
+                                   right_slices[l].LockedBuffer(),
+                                   right_slices[l].LDim(),
+                                   device_right.data + l * right_size,
+                                   height),
+                   "cublasSetMatrix");
+    }
+
+  const double one(1);
+  for(size_t t = 0; t < left_slices.size(); ++t)
+    {
+      check_cuda(cudaMemset(device_product.data, 0,
+                            left_width * right_width * sizeof(double)),
+                 "cudaMemset");
+      for(size_t l = 0; l <= t; ++l)
+        {
+          check_cublas(
+            cublasDgemm(handle, CUBLAS_OP_T, CUBLAS_OP_N, left_width,
+                        right_width, height, &one,
+                        device_left.data + l * left_size, height,
+                        device_right.data + (t - l) * right_size, height,
+                        &one, device_product.data, left_width),
+            "cublasDgemm");
+        }
+      check_cublas(cublasGetMatrix(left_width, right_width, sizeof(double),
+                                   device_product.data, left_width,
+                                   product.Buffer(), product.LDim()),
+                   "cublasGetMatrix");
+      accumulate(t, product);
+    }
+#else
+  for(size_t t = 0; t < left_slices.size(); ++t)
+    {
+      El::Zero(product);
+      for(size_t l = 0; l <= t; ++l)
+        {
+          El::Gemm(El::Orientation::TRANSPOSE, El::Orientation::NORMAL, 1.0,
+                   left_slices[l], right_slices[t - l], 1.0, product);
+        }
+      accumulate(t, product);
+    }
+#endif
+}
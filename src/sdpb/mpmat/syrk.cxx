@@ -0,0 +1,232 @@
+#include "../mpmat.hxx"
+
+#include <functional>
+#include <limits>
+
+void slice_products(const El::UpperOrLower &uplo,
+                    const std::vector<El::Matrix<double>> &slices,
+                    const std::function<void(
+                      const size_t &t, const El::Matrix<double> &product)>
+                      &accumulate);
+
+void slice_products(const std::vector<El::Matrix<double>> &left_slices,
+                    const std::vector<El::Matrix<double>> &right_slices,
+                    const std::function<void(
+                      const size_t &t, const El::Matrix<double> &product)>
+                      &accumulate);
+
+// Split A into double precision slices.  With
+//
+//   A(k,i) = 2^{e_i} \sum_l S_l(k,i) 2^{-bits (l+1)}
+//
+// where each S_l(k,i) is an integer with |S_l(k,i)| < 2^bits,
+//
+//   (A^T A)(i,j) = 2^{e_i + e_j} \sum_t 2^{-bits (t+2)}
+//                    \sum_{l+m=t} (S_l^T S_m)(i,j)
+//
+// Every term in the inner double precision sums is an integer less
+// than 2^{2 bits}, and there are at most height*num_slices of them.
+// So if 2 bits + log2(height*num_slices) <= 53, the sums are exact.
+// The only error comes from dropping the terms with t >= num_slices.
+//
+// A^T B is the same with the slices of B on the right.
+//
+// Distributed matrices are handled like El::Syrk and El::Gemm do:
+// each rank gets the full columns of A and B for the rows and the
+// columns of C that it owns, as [STAR,MC] and [STAR,MR] copies, and
+// computes its part of C with local slice products.  Whole columns
+// are on one rank, so their exponents and slices are the same as on
+// a single rank.
+
+namespace
+{
+  // x *= 2^exponent
+  void mul_2exp(mpf_ptr x, const int64_t &exponent)
+  {
+    if(exponent >= 0)
+      {
+        mpf_mul_2exp(x, x, exponent);
+      }
+    else
+      {
+        mpf_div_2exp(x, x, -exponent);
+      }
+  }
+
+  size_t ceil_log2(const size_t &n)
+  {
+    size_t result(0);
+    while((size_t(1) << result) < n)
+      {
+        ++result;
+      }
+    return result;
+  }
+
+  // The widest slices for which the products of columns of this
+  // height are exact.
+  void slicing(const size_t &height, size_t &bits, size_t &num_slices)
+  {
+    // Extra bits to make up for the truncated terms.
+    const size_t precision(El::gmp::Precision() + 16);
+    for(bits = 26;; --bits)
+      {
+        if(bits == 0)
+          {
+            throw std::runtime_error(
+              "mpmat: Matrix too large to split into exact slices: "
+              + std::to_string(height) + " rows");
+          }
+        num_slices = (precision + bits - 1) / bits;
+        if(2 * bits + ceil_log2(std::max(height * num_slices, size_t(1)))
+           <= 53)
+          {
+            return;
+          }
+      }
+  }
+
+  void
+  compute_slices(const El::Matrix<El::BigFloat> &A, const size_t &bits,
+                 const size_t &num_slices, std::vector<int64_t> &exponents,
+                 std::vector<El::Matrix<double>> &slices)
+  {
+    const int64_t height(A.Height()), width(A.Width());
+    exponents.assign(width, 0);
+    slices.assign(num_slices, El::Matrix<double>(height, width));
+
+    mpf_class remainder, slice;
+    for(int64_t column = 0; column < width; ++column)
+      {
+        long max_exponent(std::numeric_limits<long>::min());
+        for(int64_t row = 0; row < height; ++row)
+          {
+            const mpf_class &element(A(row, column).gmp_float);
+            if(mpf_sgn(element.get_mpf_t()) != 0)
+              {
+                long exponent;
+                mpf_get_d_2exp(&exponent, element.get_mpf_t());
+                max_exponent = std::max(max_exponent, exponent);
+              }
+          }
+        if(max_exponent == std::numeric_limits<long>::min())
+          {
+            max_exponent = 0;
+          }
+        exponents[column] = max_exponent;
+
+        for(int64_t row = 0; row < height; ++row)
+          {
+            remainder = A(row, column).gmp_float;
+            mul_2exp(remainder.get_mpf_t(), -max_exponent);
+            for(auto &S : slices)
+              {
+                mpf_mul_2exp(remainder.get_mpf_t(), remainder.get_mpf_t(),
+                             bits);
+                mpf_trunc(slice.get_mpf_t(), remainder.get_mpf_t());
+                S(row, column) = mpf_get_d(slice.get_mpf_t());
+                remainder -= slice;
+              }
+          }
+      }
+  }
+
+  // C := A^T B + beta C for the elements of C for which
+  // is_computed(global_row, global_column).  If is_symmetric, B is A
+  // and only the uplo triangle is computed.
+  void transpose_product(
+    const El::DistMatrix<El::BigFloat> &A,
+    const El::DistMatrix<El::BigFloat> &B, const bool &is_symmetric,
+    const El::UpperOrLower &uplo, const El::BigFloat &beta,
+    El::DistMatrix<El::BigFloat> &C,
+    const std::function<bool(const int64_t &, const int64_t &)>
+      &is_computed)
+  {
+    El::Matrix<El::BigFloat> &C_local(C.Matrix());
+    for(int64_t column = 0; column < C.LocalWidth(); ++column)
+      for(int64_t row = 0; row < C.LocalHeight(); ++row)
+        {
+          if(is_computed(C.GlobalRow(row), C.GlobalCol(column)))
+            {
+              C_local(row, column) *= beta;
+            }
+        }
+
+    size_t bits, num_slices;
+    slicing(A.Height(), bits, num_slices);
+
+    std::vector<int64_t> row_exponents, column_exponents;
+    mpf_class term;
+    const auto accumulate([&](const size_t &t,
+                              const El::Matrix<double> &product) {
+      for(int64_t column = 0; column < C.LocalWidth(); ++column)
+        for(int64_t row = 0; row < C.LocalHeight(); ++row)
+          {
+            if(product(row, column) == 0
+               || !is_computed(C.GlobalRow(row), C.GlobalCol(column)))
+              {
+                continue;
+              }
+            mpf_set_d(term.get_mpf_t(), product(row, column));
+            mul_2exp(term.get_mpf_t(),
+                     row_exponents[row] + column_exponents[column]
+                       - int64_t(bits * (t + 2)));
+            C_local(row, column).gmp_float += term;
+          }
+    });
+
+    if(C.Grid().Size() == 1)
+      {
+        std::vector<El::Matrix<double>> row_slices, column_slices;
+        compute_slices(A.LockedMatrix(), bits, num_slices, row_exponents,
+                       row_slices);
+        if(is_symmetric)
+          {
+            column_exponents = row_exponents;
+            slice_products(uplo, row_slices, accumulate);
+          }
+        else
+          {
+            compute_slices(B.LockedMatrix(), bits, num_slices,
+                           column_exponents, column_slices);
+            slice_products(row_slices, column_slices, accumulate);
+          }
+        return;
+      }
+
+    El::DistMatrix<El::BigFloat, El::STAR, El::MC> A_STAR_MC(C.Grid());
+    El::DistMatrix<El::BigFloat, El::STAR, El::MR> B_STAR_MR(C.Grid());
+    A_STAR_MC.AlignWith(C);
+    B_STAR_MR.AlignWith(C);
+    A_STAR_MC = A;
+    B_STAR_MR = B;
+    std::vector<El::Matrix<double>> row_slices, column_slices;
+    compute_slices(A_STAR_MC.LockedMatrix(), bits, num_slices, row_exponents,
+                   row_slices);
+    compute_slices(B_STAR_MR.LockedMatrix(), bits, num_slices,
+                   column_exponents, column_slices);
+    slice_products(row_slices, column_slices, accumulate);
+  }
+}
+
+void mpmat_syrk(const El::UpperOrLower &uplo,
+                const El::DistMatrix<El::BigFloat> &A,
+                const El::BigFloat &beta, El::DistMatrix<El::BigFloat> &C)
+{
+  // Only the uplo triangle of C is guaranteed to be allocated, so
+  // never touch the other half.
+  transpose_product(A, A, true, uplo, beta, C,
+                    [&](const int64_t &row, const int64_t &column) {
+                      return uplo == El::UpperOrLower::UPPER
+                               ? row <= column
+                               : row >= column;
+                    });
+}
+
+void mpmat_gemm(const El::DistMatrix<El::BigFloat> &A,
+                const El::DistMatrix<El::BigFloat> &B,
+                const El::BigFloat &beta, El::DistMatrix<El::BigFloat> &C)
+{
+  transpose_product(A, B, false, El::UpperOrLower::UPPER, beta, C,
+                    [](const int64_t &, const int64_t &) { return true; });
+}
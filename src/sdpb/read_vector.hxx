@@ -5,7 +5,7 @@
 #include <stdexcept>
 
 template <typename T>
-void read_vector(std::ifstream &input_stream, std::vector<T> &v)
+void read_vector(std::istream &input_stream, std::vector<T> &v)
 {
   size_t size;
   input_stream >> size;
@@ -0,0 +1,97 @@
+// Solve many independent SDPs at once.  The processes are split into
+// ensembleSize equal, contiguous members, and each member solves the
+// SDPs in its own queue, 'queue.k' for member k, with solve_queue().
+// Members never communicate with each other, so a small SDP does not
+// wait for a large one, and many small SDPs can share a job that is
+// too large for any one of them.
+//
+// Each member balances its blocks over its own processes.  A member
+// that is smaller than a node gets a share of the node's memory.  The
+// members share blocksizeProfile, but traceFile and metricsFile get
+// '.k' appended.
+
+#include "SDP_Solver_Parameters.hxx"
+#include "Block_Info.hxx"
+#include "solver_comm.hxx"
+
+#include <El.hpp>
+
+void solve_queue(Block_Info *block_info,
+                 const SDP_Solver_Parameters &parameters);
+
+void install_signal_handlers();
+
+namespace
+{
+  boost::filesystem::path
+  with_member_suffix(const boost::filesystem::path &path,
+                     const size_t &member)
+  {
+    return path.empty() ? path : path.string() + "." + std::to_string(member);
+  }
+}
+
+void run_ensemble(const SDP_Solver_Parameters &parameters)
+{
+  const size_t num_procs(El::mpi::Size(El::mpi::COMM_WORLD)),
+    rank(El::mpi::Rank(El::mpi::COMM_WORLD));
+  if(num_procs % parameters.ensemble_size != 0)
+    {
+      throw std::runtime_error(
+        "The number of MPI processes, " + std::to_string(num_procs)
+        + ", is not a multiple of ensembleSize, "
+        + std::to_string(parameters.ensemble_size));
+    }
+  const size_t member_size(num_procs / parameters.ensemble_size),
+    member(rank / member_size);
+
+  SDP_Solver_Parameters member_parameters(parameters);
+  if(member_size < parameters.procs_per_node)
+    {
+      if(parameters.procs_per_node % member_size != 0)
+        {
+          throw std::runtime_error(
+            "The members of the ensemble, with "
+            + std::to_string(member_size)
+            + " processes each, do not evenly divide a node, with "
+            + std::to_string(parameters.procs_per_node)
+            + " processes.  Choose an ensembleSize so that each member "
+              "either fits evenly into a node or covers whole nodes.");
+        }
+      member_parameters.procs_per_node = member_size;
+      member_parameters.memory_per_node
+        = parameters.memory_per_node / (parameters.procs_per_node
+                                        / member_size);
+    }
+  else if(member_size % parameters.procs_per_node != 0)
+    {
+      throw std::runtime_error(
+        "The members of the ensemble, with " + std::to_string(member_size)
+        + " processes each, do not cover whole nodes, with "
+        + std::to_string(parameters.procs_per_node)
+        + " processes.  Choose an ensembleSize so that each member "
+          "either fits evenly into a node or covers whole nodes.");
+    }
+  member_parameters.queue_file
+    = with_member_suffix(parameters.queue_file, member);
+  member_parameters.trace_file
+    = with_member_suffix(parameters.trace_file, member);
+  member_parameters.metrics_file
+    = with_member_suffix(parameters.metrics_file, member);
+
+  El::mpi::Comm member_comm;
+  El::mpi::Split(El::mpi::COMM_WORLD, member, rank, member_comm);
+  {
+    Scoped_Solver_Comm scoped_comm(member_comm);
+    install_signal_handlers();
+    if(parameters.verbosity >= Verbosity::regular && rank == 0)
+      {
+        std::cout << "SDPB started an ensemble of "
+                  << parameters.ensemble_size << " members with "
+                  << member_size << " processes each\n"
+                  << member_parameters << '\n';
+      }
+    solve_queue(nullptr, member_parameters);
+  }
+  El::mpi::Free(member_comm);
+}
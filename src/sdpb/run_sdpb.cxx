@@ -0,0 +1,122 @@
+#include "SDP_Solver_Parameters.hxx"
+#include "Block_Info.hxx"
+#include "../Timers.hxx"
+#include "solver_comm.hxx"
+#include "solve/native_kernels.hxx"
+#include "mpmat.hxx"
+
+#include <El.hpp>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+Timers
+solve(const Block_Info &block_info, const SDP_Solver_Parameters &parameters);
+
+void solve_with_timing_run(Block_Info &block_info,
+                           SDP_Solver_Parameters &parameters);
+
+El::Matrix<int32_t> sample_block_timings(const Block_Info &block_info);
+
+void write_block_timings(const boost::filesystem::path &checkpoint_out,
+                         const El::Matrix<int32_t> &block_timings);
+
+void solve_queue(Block_Info *block_info,
+                 const SDP_Solver_Parameters &parameters);
+
+void run_ensemble(const SDP_Solver_Parameters &parameters);
+
+size_t starting_precision(const SDP_Solver_Parameters &parameters);
+
+void install_signal_handlers();
+
+// Everything that sdpb does after parsing its options, so that
+// drivers that build their own parameters run the SDP the same way.
+void run_sdpb(SDP_Solver_Parameters &parameters)
+{
+  block_kernel_scalar() = parameters.scalar;
+  std::unique_ptr<Scoped_Mpmat_GPU> mpmat_gpu;
+  if(parameters.matrix_backend == Matrix_Backend::mpmat)
+    {
+      mpmat_gpu.reset(new Scoped_Mpmat_GPU());
+    }
+  if(parameters.ensemble_size > 1)
+    {
+      run_ensemble(parameters);
+      return;
+    }
+  // The timing run changes parameters, so the queue starts from a
+  // copy.
+  const SDP_Solver_Parameters queue_parameters(parameters);
+  install_signal_handlers();
+  parameters.working_precision = starting_precision(parameters);
+  El::gmp::SetPrecision(parameters.working_precision);
+  if(parameters.verbosity >= Verbosity::regular
+     && El::mpi::Rank(solver_comm()) == 0)
+    {
+      std::cout << "SDPB started at "
+                << boost::posix_time::second_clock::local_time() << '\n'
+                << parameters << '\n';
+    }
+
+  Block_Info block_info(parameters.sdp_directory, parameters.checkpoint_in,
+                        parameters.procs_per_node, parameters.proc_granularity,
+                        parameters.memory_per_node, parameters.verbosity,
+                        parameters.in_memory_sdp.get(),
+                        parameters.block_cost_database);
+  // Only generate a block_timings file if
+  // 1) We are running in parallel
+  // 2) We did not load a block_timings file
+  // 3) We are not going to load a checkpoint.
+  // 4) We were not asked to rely on the estimated block costs.
+  // 5) The costs did not come from the block cost database.
+  if(El::mpi::Size(solver_comm()) > 1 && !parameters.skip_timing_run
+     && block_info.block_timings_filename.empty()
+     && !block_info.has_database_costs
+     && !exists(parameters.checkpoint_in / "checkpoint.0"))
+    {
+      if(parameters.verbosity >= Verbosity::regular
+         && El::mpi::Rank(solver_comm()) == 0)
+        {
+          std::cout << (parameters.sampled_timing_run
+                          ? "Performing a sampled timing run\n"
+                          : "Performing a timing run\n");
+        }
+      if(parameters.sampled_timing_run)
+        {
+          El::Matrix<int32_t> block_timings(sample_block_timings(block_info));
+          write_block_timings(parameters.checkpoint_out, block_timings);
+          Block_Info new_info(parameters.sdp_directory, block_timings,
+                              parameters.procs_per_node,
+                              parameters.proc_granularity,
+                              parameters.memory_per_node, parameters.verbosity,
+                              parameters.in_memory_sdp.get());
+          std::swap(block_info, new_info);
+          solve(block_info, parameters);
+        }
+      else
+        {
+          solve_with_timing_run(block_info, parameters);
+        }
+    }
+  else if(!block_info.block_timings_filename.empty()
+          && block_info.block_timings_filename
+               != (parameters.checkpoint_out / "block_timings"))
+    {
+      if(El::mpi::Rank(solver_comm()) == 0)
+        {
+          create_directories(parameters.checkpoint_out);
+          copy_file(block_info.block_timings_filename,
+                    parameters.checkpoint_out / "block_timings",
+                    boost::filesystem::copy_option::overwrite_if_exists);
+        }
+      solve(block_info, parameters);
+    }
+  else
+    {
+      solve(block_info, parameters);
+    }
+  if(!queue_parameters.queue_file.empty())
+    {
+      solve_queue(&block_info, queue_parameters);
+    }
+}
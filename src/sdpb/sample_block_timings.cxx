@@ -0,0 +1,215 @@
+#include "Block_Info.hxx"
+#include "solver_comm.hxx"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <map>
+
+// A much shorter substitute for the timing run.  The dimension, degree
+// and precision of a block fix the sizes of all of its matrices, so
+// the blocks are grouped into classes by those, and only one block of
+// each class is timed.  The parts of an iteration that are timed are
+// the ones that Block_Info::estimate_block_costs() counts:
+//
+//   the Cholesky decomposition of the Schur complement, and the
+//   triangular solve and syrk that build Q,
+//   the entries of the Schur complement,
+//   the bilinear pairings with X^{-1} and Y,
+//   the Cholesky decompositions of X and Y,
+//   the eigenvalue computations for the step lengths.
+//
+// Each rank times its share of the classes on its own, with the
+// sequential kernels, so the time of a block is the sum over all of
+// the ranks that it will be spread over, as in write_timing().
+// Matrices with more than max_sample_height rows or columns are timed
+// at that size instead, and the time is scaled by the number of
+// operations.  The costs are in milliseconds per iteration.
+
+namespace
+{
+  const El::Int max_sample_height(64);
+
+  El::Int sample_height(const double &height)
+  {
+    return std::max(El::Int(1),
+                    std::min(El::Int(height), max_sample_height));
+  }
+
+  // Symmetric and positive definite, with entries that are not exactly
+  // representable, so that every operation works at full precision.
+  void set_positive(El::Matrix<El::BigFloat> &A, const El::Int &height)
+  {
+    A.Resize(height, height);
+    for(El::Int row = 0; row < height; ++row)
+      for(El::Int column = 0; column < height; ++column)
+        {
+          A(row, column)
+            = El::BigFloat(1) / El::BigFloat(int(1 + row + column))
+              + (row == column ? El::BigFloat(int(height))
+                               : El::BigFloat(0));
+        }
+  }
+
+  void set_rectangular(El::Matrix<El::BigFloat> &A, const El::Int &height,
+                       const El::Int &width)
+  {
+    A.Resize(height, width);
+    for(El::Int row = 0; row < height; ++row)
+      for(El::Int column = 0; column < width; ++column)
+        {
+          A(row, column)
+            = El::BigFloat(1) / El::BigFloat(int(1 + row + 2 * column));
+        }
+  }
+
+  template <typename F> double elapsed_seconds(const F &f)
+  {
+    const auto start(std::chrono::high_resolution_clock::now());
+    f();
+    return std::chrono::duration<double>(
+             std::chrono::high_resolution_clock::now() - start)
+      .count();
+  }
+
+  void cholesky(El::Matrix<El::BigFloat> &A)
+  {
+    El::Cholesky(El::UpperOrLowerNS::LOWER, A);
+  }
+
+  // B := L^{-1} B
+  void trsm(const El::Matrix<El::BigFloat> &L, El::Matrix<El::BigFloat> &B)
+  {
+    El::Trsm(El::LeftOrRightNS::LEFT, El::UpperOrLowerNS::LOWER,
+             El::OrientationNS::NORMAL, El::UnitOrNonUnitNS::NON_UNIT,
+             El::BigFloat(1), L, B);
+  }
+
+  // The seconds per iteration of one block
+  double block_seconds(const Block_Info &block_info, const size_t &block)
+  {
+    const double P(block_info.schur_block_sizes[block]),
+      N(block_info.num_free_variables);
+    const El::Int P_sample(sample_height(P)), N_sample(sample_height(N));
+    const double P_scale(P / P_sample), N_scale(N / N_sample);
+
+    El::Matrix<El::BigFloat> positive, L, B, Q, eigenvalues;
+    set_positive(positive, P_sample);
+    L = positive;
+    double result(P_scale * P_scale * P_scale
+                  * elapsed_seconds([&]() { cholesky(L); }));
+    set_rectangular(B, P_sample, N_sample);
+    result += P_scale * P_scale * N_scale
+              * elapsed_seconds([&]() { trsm(L, B); });
+    El::Zeros(Q, N_sample, N_sample);
+    result += P_scale * N_scale * N_scale * elapsed_seconds([&]() {
+                El::Syrk(El::UpperOrLowerNS::UPPER,
+                         El::OrientationNS::TRANSPOSE, El::BigFloat(1), B,
+                         El::BigFloat(0), Q);
+              });
+
+    // The primal and dual step lengths
+    El::HermitianEigCtrl<El::BigFloat> hermitian_eig_ctrl;
+    hermitian_eig_ctrl.tridiagEigCtrl.dcCtrl.secularCtrl.maxIterations
+      = 16384;
+    for(size_t parity = 0; parity < 2; ++parity)
+      {
+        const double R(
+          block_info.psd_matrix_block_sizes[2 * block + parity]);
+        const El::Int R_sample(sample_height(R));
+        const double R_scale(R / R_sample);
+        // See min_eigenvalue()
+        hermitian_eig_ctrl.tridiagEigCtrl.dcCtrl.cutoff = R_sample / 2 + 1;
+        set_positive(positive, R_sample);
+        result += 2 * R_scale * R_scale * R_scale * elapsed_seconds([&]() {
+                    El::HermitianEig(El::UpperOrLowerNS::LOWER, positive,
+                                     eigenvalues, hermitian_eig_ctrl);
+                  });
+      }
+
+    // The rest is at the precision of the block.
+    const int solver_precision(El::gmp::Precision());
+    El::gmp::SetPrecision(block_info.block_precision(block));
+    {
+      // Each entry of the Schur complement is a sum of a few products
+      // of the bilinear pairings, 8 P^2 multiplications in all.
+      El::Matrix<El::BigFloat> A, C;
+      set_rectangular(A, P_sample, P_sample);
+      C = A;
+      result += 8 * P_scale * P_scale
+                * elapsed_seconds([&]() { El::Hadamard(A, A, C); });
+
+      for(size_t parity = 0; parity < 2; ++parity)
+        {
+          const double R(
+            block_info.psd_matrix_block_sizes[2 * block + parity]),
+            K(block_info.bilinear_pairing_block_sizes[2 * block + parity]);
+          const El::Int R_sample(sample_height(R)),
+            K_sample(sample_height(K));
+          const double R_scale(R / R_sample), K_scale(K / K_sample);
+
+          // The Cholesky decompositions of X and Y
+          set_positive(A, R_sample);
+          result += 2 * R_scale * R_scale * R_scale
+                    * elapsed_seconds([&]() { cholesky(A); });
+          // The pairings with X^{-1} and Y: a triangular solve with
+          // the bases and their product.
+          set_rectangular(C, R_sample, K_sample);
+          result += 2 * R_scale * R_scale * K_scale
+                    * elapsed_seconds([&]() { trsm(A, C); });
+          El::Matrix<El::BigFloat> pairing;
+          El::Zeros(pairing, K_sample, K_sample);
+          result += 2 * R_scale * K_scale * K_scale * elapsed_seconds([&]() {
+                      El::Gemm(El::OrientationNS::TRANSPOSE,
+                               El::OrientationNS::NORMAL, El::BigFloat(1), C,
+                               C, El::BigFloat(0), pairing);
+                    });
+        }
+    }
+    El::gmp::SetPrecision(solver_precision);
+    return result;
+  }
+}
+
+// Collective.  Every rank gets the same timings.
+El::Matrix<int32_t> sample_block_timings(const Block_Info &block_info)
+{
+  // Key: dimension, degree, precision
+  std::map<std::array<size_t, 3>, std::vector<size_t>> classes;
+  for(size_t block = 0; block < block_info.dimensions.size(); ++block)
+    {
+      classes[{block_info.dimensions[block], block_info.degrees[block],
+               size_t(block_info.block_precision(block))}]
+        .push_back(block);
+    }
+
+  const size_t rank(El::mpi::Rank(solver_comm())),
+    num_procs(El::mpi::Size(solver_comm()));
+  std::vector<double> milliseconds(classes.size(), 0);
+  size_t class_index(0);
+  for(auto &shape_class : classes)
+    {
+      if(class_index % num_procs == rank)
+        {
+          milliseconds[class_index]
+            = 1000 * block_seconds(block_info, shape_class.second.front());
+        }
+      ++class_index;
+    }
+  El::mpi::AllReduce(milliseconds.data(), milliseconds.size(), El::mpi::SUM,
+                     solver_comm());
+
+  El::Matrix<int32_t> result;
+  El::Zeros(result, block_info.dimensions.size(), 1);
+  class_index = 0;
+  for(auto &shape_class : classes)
+    {
+      for(auto &block : shape_class.second)
+        {
+          result(block, 0) = std::lround(milliseconds[class_index]);
+        }
+      ++class_index;
+    }
+  return result;
+}
@@ -0,0 +1,73 @@
+#include <atomic>
+#include <csignal>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <signal.h>
+
+// Schedulers such as SLURM send SIGTERM when they preempt a job or
+// when it reaches its walltime, and kill it a short time later.
+// SIGTERM and SIGINT ask the solver to save a checkpoint and stop.
+// SIGUSR1 and SIGUSR2 only ask for a checkpoint, e.g. with
+// 'sbatch --signal=USR1@300' ahead of the walltime.
+//
+// The handlers only set flags.  The solver combines the flags of all
+// ranks at the next iteration boundary, so a signal that reaches any
+// rank is acted on by all of them.  The flags are lock free atomics,
+// so that a request that arrives while the solver takes the previous
+// one is kept for the next iteration instead of being cleared.
+
+namespace
+{
+  std::atomic<int> is_checkpoint_requested(0), is_stop_requested(0);
+
+  void handle_checkpoint_signal(int) { is_checkpoint_requested.store(1); }
+
+  void handle_stop_signal(int) { is_stop_requested.store(1); }
+
+  void install(const int &signal_number, void (*handler)(int),
+               const int &flags)
+  {
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = handler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART | flags;
+    if(sigaction(signal_number, &action, nullptr) != 0)
+      {
+        throw std::runtime_error("Could not install the handler for signal "
+                                 + std::to_string(signal_number));
+      }
+  }
+}
+
+void install_signal_handlers()
+{
+  if(!is_checkpoint_requested.is_lock_free())
+    {
+      throw std::runtime_error(
+        "std::atomic<int> is not lock free, so it can not be used in a "
+        "signal handler");
+    }
+  for(auto &signal_number : {SIGUSR1, SIGUSR2})
+    {
+      install(signal_number, handle_checkpoint_signal, 0);
+    }
+  // SA_RESETHAND restores the default action, so a second signal
+  // kills the process as usual.
+  for(auto &signal_number : {SIGTERM, SIGINT})
+    {
+      install(signal_number, handle_stop_signal, SA_RESETHAND);
+    }
+}
+
+// Whether a checkpoint was requested since the last call
+bool take_checkpoint_request()
+{
+  return is_checkpoint_requested.exchange(0) != 0;
+}
+
+// Whether a stop was requested.  This stays set, so that no later
+// solve runs more than one iteration.
+bool stop_requested() { return is_stop_requested.load() != 0; }
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include "Scaled.hxx"
+
 #include <El.hpp>
 
 #include <list>
@@ -84,6 +86,15 @@ public:
       }
   }
 
+  // *this += alpha * A, in one pass
+  void operator+=(const Scaled<Block_Diagonal_Matrix> &A)
+  {
+    for(size_t b = 0; b < blocks.size(); b++)
+      {
+        add_scaled(A.alpha, A.value.blocks[b], blocks[b]);
+      }
+  }
+
   void operator*=(const El::BigFloat &c)
   {
     for(auto &block : blocks)
@@ -94,17 +105,35 @@ public:
 
   void symmetrize()
   {
+    // We can not use El::MakeSymmetric() because that just copies
+    // the lower part to the upper part.  We need to average the upper
+    // and lower parts.
+    El::BigFloat average;
     for(auto &block : blocks)
       {
-        // FIXME: This feels expensive
-
-        // We can not use El::MakeSymmetric() because that just copies
-        // the lower part to the upper part.  We need to average the
-        // upper and lower parts.
-        block *= 0.5;
-        El::DistMatrix<El::BigFloat> transpose(block.Grid());
-        El::Transpose(block, transpose, false);
-        block += transpose;
+        if(block.Grid().Size() == 1)
+          {
+            // Average each pair in place, without a transposed copy.
+            El::Matrix<El::BigFloat> &local(block.Matrix());
+            for(int64_t column = 0; column < local.Width(); ++column)
+              for(int64_t row = 0; row < column; ++row)
+                {
+                  average = local(row, column);
+                  average += local(column, row);
+                  average /= 2;
+                  local(row, column) = average;
+                  local(column, row) = average;
+                }
+          }
+        else
+          {
+            // The transpose of a distributed block lives on other
+            // ranks, so this still needs a copy.
+            block *= 0.5;
+            El::DistMatrix<El::BigFloat> transpose(block.Grid());
+            El::Transpose(block, transpose, false);
+            block += transpose;
+          }
       }
   }
 
@@ -123,3 +152,9 @@ public:
   operator<<(std::ostream &os, const Block_Diagonal_Matrix &A);
 };
 
+inline Scaled<Block_Diagonal_Matrix>
+operator*(const El::BigFloat &alpha, const Block_Diagonal_Matrix &A)
+{
+  return {alpha, A};
+}
+
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <El.hpp>
+#include <boost/filesystem.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+// Keeps the local elements of the large blocks of a matrix in files
+// in a scratch directory instead of in memory.  This is for blocks
+// that are computed once per iteration and then only used a few
+// times, like the factors of the Schur complement.
+//
+// spill() frees the blocks and writes them on a background thread.
+// prefetch() starts reading them back on a background thread, and
+// load() waits for that and restores the elements.  The files stay
+// valid until the blocks are computed again, so release() frees the
+// loaded blocks without writing them again.  allocate() gives the
+// blocks back their sizes and precisions, so that they can be
+// computed again.
+//
+// The background threads only touch the buffers and the files, never
+// the blocks.  The files are per rank, so the directory can be
+// node-local.  With an empty directory, nothing is spilled and every
+// member function does nothing.
+class Block_Spill
+{
+public:
+  // Blocks with fewer than min_height rows stay in memory.
+  Block_Spill(const boost::filesystem::path &directory,
+              const std::string &name, const int64_t &min_height);
+  ~Block_Spill();
+  Block_Spill(const Block_Spill &) = delete;
+  Block_Spill &operator=(const Block_Spill &) = delete;
+
+  void spill(std::vector<El::DistMatrix<El::BigFloat>> &blocks);
+  void prefetch();
+  void load(std::vector<El::DistMatrix<El::BigFloat>> &blocks);
+  void release(std::vector<El::DistMatrix<El::BigFloat>> &blocks);
+  void allocate(std::vector<El::DistMatrix<El::BigFloat>> &blocks);
+
+private:
+  struct Spilled_Block
+  {
+    size_t index;
+    int64_t height, width;
+    mp_bitcnt_t precision;
+    size_t size;
+    std::vector<El::byte> buffer;
+  };
+  enum class State
+  {
+    // The blocks are in memory and the files are not valid.
+    in_memory,
+    // The blocks are freed, and the files are being written or are
+    // valid.
+    on_disk,
+    // The blocks are in memory, and the files are still valid.
+    loaded
+  };
+
+  boost::filesystem::path directory;
+  std::string name;
+  int64_t min_height;
+  std::vector<Spilled_Block> spilled;
+  size_t serialized_size;
+  State state = State::in_memory;
+  bool is_prefetching = false;
+  std::thread thread;
+  // Set by the background thread, checked by join()
+  std::string error;
+
+  boost::filesystem::path filename(const size_t &index) const;
+  void join();
+  void free_blocks(std::vector<El::DistMatrix<El::BigFloat>> &blocks);
+  void resize_blocks(std::vector<El::DistMatrix<El::BigFloat>> &blocks);
+};
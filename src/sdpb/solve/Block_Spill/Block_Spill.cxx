@@ -0,0 +1,205 @@
+#include "../Block_Spill.hxx"
+#include "../serialize_local.hxx"
+
+#include <boost/filesystem/fstream.hpp>
+
+Block_Spill::Block_Spill(const boost::filesystem::path &Directory,
+                         const std::string &Name, const int64_t &Min_height)
+    : directory(Directory), name(Name), min_height(Min_height),
+      serialized_size(El::BigFloat(0).SerializedSize())
+{
+  if(!directory.empty())
+    {
+      boost::filesystem::create_directories(directory);
+    }
+}
+
+Block_Spill::~Block_Spill()
+{
+  if(thread.joinable())
+    {
+      thread.join();
+    }
+  for(auto &block : spilled)
+    {
+      boost::system::error_code error_code;
+      boost::filesystem::remove(filename(block.index), error_code);
+    }
+}
+
+boost::filesystem::path Block_Spill::filename(const size_t &index) const
+{
+  return directory
+         / (name + "." + std::to_string(El::mpi::Rank()) + "."
+            + std::to_string(index));
+}
+
+void Block_Spill::join()
+{
+  if(thread.joinable())
+    {
+      thread.join();
+    }
+  if(!error.empty())
+    {
+      const std::string message(error);
+      error.clear();
+      throw std::runtime_error(message);
+    }
+}
+
+void Block_Spill::spill(std::vector<El::DistMatrix<El::BigFloat>> &blocks)
+{
+  if(directory.empty() || state != State::in_memory)
+    {
+      return;
+    }
+  spilled.clear();
+  for(size_t index = 0; index < blocks.size(); ++index)
+    {
+      El::DistMatrix<El::BigFloat> &block(blocks[index]);
+      if(block.Height() < min_height)
+        {
+          continue;
+        }
+      const El::Matrix<El::BigFloat> &local(block.LockedMatrix());
+      Spilled_Block spilled_block;
+      spilled_block.index = index;
+      spilled_block.height = block.Height();
+      spilled_block.width = block.Width();
+      spilled_block.precision = mpf_get_default_prec();
+      if(local.Height() != 0 && local.Width() != 0)
+        {
+          spilled_block.precision = local(0, 0).gmp_float.get_prec();
+        }
+      spilled_block.size = local.Height() * local.Width() * serialized_size;
+      spilled_block.buffer.resize(spilled_block.size);
+      // Rounding to the default precision is exact for lower
+      // precision blocks.
+      serialize_local(local, serialized_size, spilled_block.buffer.data());
+      spilled.push_back(std::move(spilled_block));
+      block.Empty();
+    }
+  state = State::on_disk;
+
+  thread = std::thread([this]() {
+    for(auto &block : spilled)
+      {
+        const boost::filesystem::path path(filename(block.index));
+        boost::filesystem::ofstream stream(path, std::ios::binary);
+        stream.write(reinterpret_cast<const char *>(block.buffer.data()),
+                     block.size);
+        if(!stream.good())
+          {
+            error = "Error when writing spilled block: " + path.string();
+            return;
+          }
+        std::vector<El::byte>().swap(block.buffer);
+      }
+  });
+}
+
+void Block_Spill::prefetch()
+{
+  if(state != State::on_disk || is_prefetching)
+    {
+      return;
+    }
+  join();
+  is_prefetching = true;
+  thread = std::thread([this]() {
+    for(auto &block : spilled)
+      {
+        const boost::filesystem::path path(filename(block.index));
+        block.buffer.resize(block.size);
+        boost::filesystem::ifstream stream(path, std::ios::binary);
+        stream.read(reinterpret_cast<char *>(block.buffer.data()),
+                    block.size);
+        if(!stream.good())
+          {
+            error = "Error when reading spilled block: " + path.string();
+            return;
+          }
+      }
+  });
+}
+
+void Block_Spill::load(std::vector<El::DistMatrix<El::BigFloat>> &blocks)
+{
+  if(state != State::on_disk)
+    {
+      return;
+    }
+  prefetch();
+  join();
+  is_prefetching = false;
+  resize_blocks(blocks);
+  for(auto &block : spilled)
+    {
+      deserialize_local(block.buffer.data(), serialized_size,
+                        blocks[block.index].Matrix());
+      std::vector<El::byte>().swap(block.buffer);
+    }
+  state = State::loaded;
+}
+
+void Block_Spill::release(std::vector<El::DistMatrix<El::BigFloat>> &blocks)
+{
+  if(state != State::loaded)
+    {
+      return;
+    }
+  free_blocks(blocks);
+  state = State::on_disk;
+}
+
+void Block_Spill::allocate(std::vector<El::DistMatrix<El::BigFloat>> &blocks)
+{
+  if(state == State::in_memory)
+    {
+      return;
+    }
+  join();
+  is_prefetching = false;
+  if(state == State::on_disk)
+    {
+      resize_blocks(blocks);
+    }
+  for(auto &block : spilled)
+    {
+      boost::system::error_code error_code;
+      boost::filesystem::remove(filename(block.index), error_code);
+    }
+  spilled.clear();
+  state = State::in_memory;
+}
+
+void Block_Spill::free_blocks(
+  std::vector<El::DistMatrix<El::BigFloat>> &blocks)
+{
+  for(auto &block : spilled)
+    {
+      blocks[block.index].Empty();
+    }
+}
+
+// Zeroed, at the precision that each block had when it was spilled
+void Block_Spill::resize_blocks(
+  std::vector<El::DistMatrix<El::BigFloat>> &blocks)
+{
+  for(auto &block : spilled)
+    {
+      El::DistMatrix<El::BigFloat> &matrix(blocks[block.index]);
+      El::Zeros(matrix, block.height, block.width);
+      if(block.precision == mpf_get_default_prec())
+        {
+          continue;
+        }
+      El::Matrix<El::BigFloat> &local(matrix.Matrix());
+      for(int64_t column = 0; column < local.Width(); ++column)
+        for(int64_t row = 0; row < local.Height(); ++row)
+          {
+            local(row, column).gmp_float.set_prec(block.precision);
+          }
+    }
+}
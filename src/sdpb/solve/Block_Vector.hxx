@@ -11,6 +11,8 @@
 // This is equivalent to Block_Matrix with width=1.  We use a separate
 // type to enhance type safety.
 
+#include "Scaled.hxx"
+
 #include <El.hpp>
 
 #include <list>
@@ -41,4 +43,19 @@ struct Block_Vector
       }
   }
   Block_Vector() = default;
+
+  // *this += alpha * A, in one pass
+  void operator+=(const Scaled<Block_Vector> &A)
+  {
+    for(size_t b = 0; b < blocks.size(); b++)
+      {
+        add_scaled(A.alpha, A.value.blocks[b], blocks[b]);
+      }
+  }
 };
+
+inline Scaled<Block_Vector>
+operator*(const El::BigFloat &alpha, const Block_Vector &A)
+{
+  return {alpha, A};
+}
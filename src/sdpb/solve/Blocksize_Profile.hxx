@@ -0,0 +1,106 @@
+#pragma once
+
+#include <El.hpp>
+#include <boost/filesystem.hpp>
+
+#include <array>
+#include <map>
+#include <string>
+
+// Algorithmic blocksizes for the distributed Elemental kernels.
+//
+// Elemental uses a single blocksize, tuned for doubles, for all of its
+// blocked algorithms.  BigFloat arithmetic is so much more expensive
+// than communication that the best blocksize is usually different,
+// and depends on the kernel, the precision, the size of the grid and
+// the size of the matrix.  A profile maps those to a blocksize, and
+// for Gemm also to an algorithm.  It is filled in by
+// tune_blocksizes(), and can be cached in a file.
+//
+// El::Blocksize() is global to the process, so there is a single
+// profile, and Scoped_Blocksize sets the blocksize around each call.
+// Every rank of a grid must find the same entry, so the entries only
+// depend on quantities that are the same on the whole grid.  Matrix
+// sizes are rounded down to a power of 2.
+
+enum class Blocksize_Kernel
+{
+  gemm,
+  syrk,
+  trsm,
+  cholesky,
+  eig
+};
+
+const std::array<std::string, 5> blocksize_kernel_names(
+  {"gemm", "syrk", "trsm", "cholesky", "eig"});
+
+struct Blocksize_Choice
+{
+  int64_t blocksize;
+  // An El::GemmAlgorithm for gemm, otherwise 0
+  int64_t variant;
+};
+
+class Blocksize_Profile
+{
+public:
+  // Key: kernel, grid size, log2 of the matrix size, precision
+  using Key = std::array<int64_t, 4>;
+  std::map<Key, Blocksize_Choice> choices;
+
+  static Key key(const Blocksize_Kernel &kernel, const int &grid_size,
+                 const int64_t &height, const size_t &precision);
+
+  // The choice for a kernel on a matrix of height on a grid, at the
+  // current precision.  If that precision was not tuned, the closest
+  // precision is used.  Returns nullptr if there is no choice.
+  const Blocksize_Choice *find(const Blocksize_Kernel &kernel,
+                               const int &grid_size,
+                               const int64_t &height) const;
+
+  // Add the entries of a file written by write().  A missing file is
+  // not an error.
+  void read(const boost::filesystem::path &path);
+  // Collective.  All ranks end up with the choices of every rank, and
+  // rank 0 writes them to path, if it is not empty.
+  void gather_and_write(const boost::filesystem::path &path);
+};
+
+// The profile used by Scoped_Blocksize
+Blocksize_Profile &blocksize_profile();
+
+// Sets El::Blocksize() from the profile for the lifetime of the
+// object, if the profile has an entry for kernel and A.  A must be
+// the output of the kernel.
+class Scoped_Blocksize
+{
+public:
+  Scoped_Blocksize(const Blocksize_Kernel &kernel,
+                   const El::AbstractDistMatrix<El::BigFloat> &A)
+      : choice(blocksize_profile().find(kernel, A.Grid().Size(), A.Height()))
+  {
+    if(choice != nullptr)
+      {
+        El::PushBlocksizeStack(choice->blocksize);
+      }
+  }
+  ~Scoped_Blocksize()
+  {
+    if(choice != nullptr)
+      {
+        El::PopBlocksizeStack();
+      }
+  }
+  Scoped_Blocksize(const Scoped_Blocksize &) = delete;
+  Scoped_Blocksize &operator=(const Scoped_Blocksize &) = delete;
+
+  El::GemmAlgorithm gemm_algorithm() const
+  {
+    return choice == nullptr ? El::GEMM_DEFAULT
+                             : El::GemmAlgorithm(choice->variant);
+  }
+
+private:
+  const Blocksize_Choice *choice;
+};
@@ -0,0 +1,141 @@
+#include "../Blocksize_Profile.hxx"
+#include "../../solver_comm.hxx"
+
+#include <boost/filesystem/fstream.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+
+// Each line of a profile file is
+//
+//   kernel grid_size log2_height precision blocksize variant
+
+Blocksize_Profile &blocksize_profile()
+{
+  static Blocksize_Profile profile;
+  return profile;
+}
+
+Blocksize_Profile::Key
+Blocksize_Profile::key(const Blocksize_Kernel &kernel, const int &grid_size,
+                       const int64_t &height, const size_t &precision)
+{
+  int64_t log2_height(0);
+  while((int64_t(2) << log2_height) <= height)
+    {
+      ++log2_height;
+    }
+  return {int64_t(kernel), grid_size, log2_height, int64_t(precision)};
+}
+
+const Blocksize_Choice *
+Blocksize_Profile::find(const Blocksize_Kernel &kernel, const int &grid_size,
+                        const int64_t &height) const
+{
+  if(choices.empty())
+    {
+      return nullptr;
+    }
+  const Key exact(key(kernel, grid_size, height, El::gmp::Precision()));
+  Key first(exact), last(exact);
+  first[3] = 0;
+  last[3] = std::numeric_limits<int64_t>::max();
+  const Blocksize_Choice *result(nullptr);
+  int64_t distance(std::numeric_limits<int64_t>::max());
+  for(auto choice(choices.lower_bound(first));
+      choice != choices.end() && choice->first <= last; ++choice)
+    {
+      const int64_t choice_distance(std::abs(choice->first[3] - exact[3]));
+      if(choice_distance < distance)
+        {
+          distance = choice_distance;
+          result = &choice->second;
+        }
+    }
+  return result;
+}
+
+void Blocksize_Profile::read(const boost::filesystem::path &path)
+{
+  if(path.empty() || !boost::filesystem::exists(path))
+    {
+      return;
+    }
+  boost::filesystem::ifstream stream(path);
+  Key entry_key;
+  std::string kernel_name;
+  Blocksize_Choice choice;
+  while(stream >> kernel_name >> entry_key[1] >> entry_key[2] >> entry_key[3]
+        >> choice.blocksize >> choice.variant)
+    {
+      auto kernel(std::find(blocksize_kernel_names.begin(),
+                            blocksize_kernel_names.end(), kernel_name));
+      if(kernel == blocksize_kernel_names.end() || choice.blocksize <= 0)
+        {
+          throw std::runtime_error("Invalid entry in blocksize profile "
+                                   + path.string() + ": " + kernel_name);
+        }
+      entry_key[0] = std::distance(blocksize_kernel_names.begin(), kernel);
+      choices[entry_key] = choice;
+    }
+  if(!stream.eof())
+    {
+      throw std::runtime_error("Error when reading blocksize profile "
+                               + path.string());
+    }
+}
+
+void Blocksize_Profile::gather_and_write(const boost::filesystem::path &path)
+{
+  const size_t num_fields(6);
+  std::vector<int64_t> local;
+  local.reserve(num_fields * choices.size());
+  for(auto &choice : choices)
+    {
+      local.insert(local.end(),
+                   {choice.first[0], choice.first[1], choice.first[2],
+                    choice.first[3], choice.second.blocksize,
+                    choice.second.variant});
+    }
+
+  const int num_procs(El::mpi::Size(solver_comm()));
+  int local_size(local.size());
+  std::vector<int> sizes(num_procs), offsets(num_procs, 0);
+  MPI_Allgather(&local_size, 1, MPI_INT, sizes.data(), 1, MPI_INT,
+                solver_comm().comm);
+  for(int rank = 1; rank < num_procs; ++rank)
+    {
+      offsets[rank] = offsets[rank - 1] + sizes[rank - 1];
+    }
+  std::vector<int64_t> all(offsets.back() + sizes.back());
+  MPI_Allgatherv(local.data(), local_size, MPI_INT64_T, all.data(),
+                 sizes.data(), offsets.data(), MPI_INT64_T,
+                 solver_comm().comm);
+
+  for(size_t field = 0; field < all.size(); field += num_fields)
+    {
+      const int64_t *entry(all.data() + field);
+      choices[{entry[0], entry[1], entry[2], entry[3]}] = {entry[4], entry[5]};
+    }
+
+  // The members of an ensemble share the file, so only the first
+  // member writes it.
+  if(El::mpi::Rank(El::mpi::COMM_WORLD) == 0 && !path.empty())
+    {
+      boost::filesystem::ofstream stream(path);
+      for(auto &choice : choices)
+        {
+          stream << blocksize_kernel_names.at(choice.first[0]) << ' '
+                 << choice.first[1] << ' ' << choice.first[2] << ' '
+                 << choice.first[3] << ' ' << choice.second.blocksize << ' '
+                 << choice.second.variant << '\n';
+        }
+      if(!stream.good())
+        {
+          throw std::runtime_error("Error when writing blocksize profile "
+                                   + path.string());
+        }
+    }
+}
@@ -0,0 +1,240 @@
+#include "../Blocksize_Profile.hxx"
+#include "../Q_Grid.hxx"
+#include "../../Block_Info.hxx"
+#include "../../SDP_Solver_Parameters.hxx"
+#include "../../solver_comm.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <vector>
+
+El::BigFloat min_eigenvalue(El::DistMatrix<El::BigFloat> &block);
+
+// Choose the blocksizes for the distributed kernels by timing each of
+// them with every candidate blocksize.  Each grid tunes the kernels
+// on a matrix the size of its largest block of X, rounded down to a
+// power of 2, and the ranks of Q's grid tune its Cholesky
+// decomposition.  The benchmarks are collective over their grid,
+// and the times are maxima over the grid, so that every rank of a
+// grid makes the same choice.
+//
+// Entries that are already in the profile at the current precision
+// are not tuned again.
+
+namespace
+{
+  const std::vector<int64_t> candidate_blocksizes({16, 32, 64, 128, 256});
+  // The Gemm algorithms, other than the default, that work for every
+  // shape and orientation
+  const std::vector<El::GemmAlgorithm> candidate_gemm_algorithms(
+    {El::GEMM_SUMMA_A, El::GEMM_SUMMA_B, El::GEMM_SUMMA_C});
+  // Smaller matrices are dominated by latency, whatever the blocksize
+  const int64_t min_tuning_height(64);
+
+  // A well conditioned symmetric positive definite matrix
+  void set_test_matrix(El::DistMatrix<El::BigFloat> &A, const int64_t &height)
+  {
+    A.Resize(height, height);
+    for(int64_t row = 0; row < A.LocalHeight(); ++row)
+      {
+        const int64_t global_row(A.GlobalRow(row));
+        for(int64_t column = 0; column < A.LocalWidth(); ++column)
+          {
+            const int64_t global_column(A.GlobalCol(column));
+            El::BigFloat element(1);
+            element /= global_row + global_column + 1;
+            if(global_row == global_column)
+              {
+                element += height;
+              }
+            A.SetLocal(row, column, element);
+          }
+      }
+  }
+
+  double max_seconds(const El::Grid &grid, const std::function<void()> &f)
+  {
+    El::mpi::Barrier(grid.Comm());
+    const auto start(std::chrono::high_resolution_clock::now());
+    f();
+    const double seconds(std::chrono::duration<double>(
+                           std::chrono::high_resolution_clock::now() - start)
+                           .count());
+    return El::mpi::AllReduce(seconds, El::mpi::MAX, grid.Comm());
+  }
+
+  // The fastest blocksize for f, with the time that it took
+  int64_t best_blocksize(const El::Grid &grid, const int64_t &height,
+                         const std::function<void()> &f, double &seconds)
+  {
+    int64_t result(El::Blocksize());
+    seconds = std::numeric_limits<double>::max();
+    for(auto &blocksize : candidate_blocksizes)
+      {
+        if(blocksize > height)
+          {
+            break;
+          }
+        El::PushBlocksizeStack(blocksize);
+        const double candidate_seconds(max_seconds(grid, f));
+        El::PopBlocksizeStack();
+        if(candidate_seconds < seconds)
+          {
+            seconds = candidate_seconds;
+            result = blocksize;
+          }
+      }
+    return result;
+  }
+
+  void tune(const Blocksize_Kernel &kernel, const El::Grid &grid,
+            const int64_t &height, const El::UpperOrLower &uplo,
+            const bool &debug, Blocksize_Profile &profile)
+  {
+    const Blocksize_Profile::Key key(Blocksize_Profile::key(
+      kernel, grid.Size(), height, El::gmp::Precision()));
+    if(profile.choices.count(key) != 0)
+      {
+        return;
+      }
+    El::DistMatrix<El::BigFloat> A(grid), B(grid), C(grid);
+    set_test_matrix(A, height);
+    El::Zeros(C, height, height);
+
+    std::function<void()> f;
+    if(kernel == Blocksize_Kernel::gemm)
+      {
+        f = [&]() {
+          El::Gemm(El::OrientationNS::TRANSPOSE, El::OrientationNS::NORMAL,
+                   El::BigFloat(1), A, A, El::BigFloat(0), C);
+        };
+      }
+    else if(kernel == Blocksize_Kernel::syrk)
+      {
+        f = [&]() {
+          El::Syrk(El::UpperOrLowerNS::UPPER, El::OrientationNS::TRANSPOSE,
+                   El::BigFloat(1), A, El::BigFloat(0), C);
+        };
+      }
+    else if(kernel == Blocksize_Kernel::trsm)
+      {
+        El::Cholesky(El::UpperOrLowerNS::LOWER, A);
+        set_test_matrix(B, height);
+        f = [&]() {
+          C = B;
+          El::Trsm(El::LeftOrRightNS::LEFT, El::UpperOrLowerNS::LOWER,
+                   El::OrientationNS::NORMAL, El::UnitOrNonUnitNS::NON_UNIT,
+                   El::BigFloat(1), A, C);
+        };
+      }
+    else if(kernel == Blocksize_Kernel::cholesky)
+      {
+        f = [&]() {
+          C = A;
+          El::Cholesky(uplo, C);
+        };
+      }
+    else
+      {
+        f = [&]() {
+          C = A;
+          min_eigenvalue(C);
+        };
+      }
+
+    double seconds;
+    Blocksize_Choice choice;
+    choice.blocksize = best_blocksize(grid, height, f, seconds);
+    choice.variant = 0;
+    if(kernel == Blocksize_Kernel::gemm)
+      {
+        El::PushBlocksizeStack(choice.blocksize);
+        for(auto &algorithm : candidate_gemm_algorithms)
+          {
+            const double candidate_seconds(max_seconds(grid, [&]() {
+              El::Gemm(El::OrientationNS::TRANSPOSE,
+                       El::OrientationNS::NORMAL, El::BigFloat(1), A, A,
+                       El::BigFloat(0), C, algorithm);
+            }));
+            if(candidate_seconds < seconds)
+              {
+                seconds = candidate_seconds;
+                choice.variant = algorithm;
+              }
+          }
+        El::PopBlocksizeStack();
+      }
+    profile.choices[key] = choice;
+
+    if(debug && grid.Rank() == 0)
+      {
+        El::Output(El::mpi::Rank(solver_comm()), " blocksize ",
+                   blocksize_kernel_names.at(int64_t(kernel)), " grid ",
+                   grid.Size(), " height ", height, ": ", choice.blocksize,
+                   " variant ", choice.variant, " (", seconds, " s)");
+      }
+  }
+
+  int64_t floor_power_of_2(const int64_t &n)
+  {
+    int64_t result(1);
+    while(2 * result <= n)
+      {
+        result *= 2;
+      }
+    return result;
+  }
+}
+
+void tune_blocksizes(const SDP_Solver_Parameters &parameters,
+                     const Block_Info &block_info, const El::Grid &grid,
+                     const int64_t &Q_height)
+{
+  Blocksize_Profile &profile(blocksize_profile());
+  profile.read(parameters.blocksize_profile);
+  if(!parameters.tune_blocksizes)
+    {
+      return;
+    }
+  const bool debug(parameters.verbosity >= Verbosity::debug);
+
+  // Every rank of a grid has the same blocks.
+  int64_t max_height(0);
+  for(auto &block_index : block_info.block_indices)
+    {
+      for(size_t parity = 0; parity < 2; ++parity)
+        {
+          max_height = std::max(
+            max_height,
+            int64_t(block_info.psd_matrix_block_sizes.at(2 * block_index
+                                                         + parity)));
+        }
+    }
+  if(grid.Size() > 1 && max_height >= min_tuning_height)
+    {
+      const int64_t height(floor_power_of_2(max_height));
+      for(auto &kernel :
+          {Blocksize_Kernel::gemm, Blocksize_Kernel::syrk,
+           Blocksize_Kernel::trsm, Blocksize_Kernel::cholesky,
+           Blocksize_Kernel::eig})
+        {
+          tune(kernel, grid, height, El::UpperOrLowerNS::LOWER, debug,
+               profile);
+        }
+    }
+
+  // Q is only distributed above replicateQThreshold, and then only
+  // the ranks of its grid factor it.
+  const Q_Grid Q_grid(parameters, Q_height);
+  if(Q_grid.grid().Size() > 1 && Q_grid.grid().InGrid()
+     && Q_height >= min_tuning_height)
+    {
+      tune(Blocksize_Kernel::cholesky, Q_grid.grid(),
+           floor_power_of_2(Q_height), El::UpperOrLowerNS::UPPER, debug,
+           profile);
+    }
+
+  profile.gather_and_write(parameters.blocksize_profile);
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+// Writes a single checkpoint file from a staging buffer.  The buffer
+// holds a serialized copy of the solver state, so the solver can keep
+// changing x, X, y and Y while the file is written on a background
+// thread.  The write is only considered successful once the file has
+// been fsync'ed, so the caller can safely point checkpoint.json at it
+// and remove older checkpoints.
+
+#include <boost/filesystem.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// Marks a per-rank checkpoint file that records the global position
+// of its blocks.  Files written before that have no header at all.
+const char per_rank_checkpoint_magic[8]
+  = {'S', 'D', 'P', 'B', 'C', 'K', 'P', 'R'},
+  per_rank_compressed_checkpoint_magic[8]
+  = {'S', 'D', 'P', 'B', 'C', 'K', 'P', 'Z'};
+
+struct Checkpoint_Writer
+{
+  boost::filesystem::path filename;
+  std::vector<char> buffer;
+  std::atomic<bool> done;
+  bool succeeded = false;
+
+  Checkpoint_Writer(const boost::filesystem::path &Filename,
+                    std::vector<char> &&Buffer)
+      : filename(Filename), buffer(std::move(Buffer)), done(false)
+  {}
+  Checkpoint_Writer(const Checkpoint_Writer &) = delete;
+  Checkpoint_Writer &operator=(const Checkpoint_Writer &) = delete;
+  ~Checkpoint_Writer() { join(); }
+
+  void write_now()
+  {
+    succeeded = write_with_retries();
+    done = true;
+  }
+  void start()
+  {
+    thread = std::thread([this]() {
+      succeeded = write_with_retries();
+      done = true;
+    });
+  }
+  void join()
+  {
+    if(thread.joinable())
+      {
+        thread.join();
+      }
+  }
+
+private:
+  std::thread thread;
+
+  bool write_with_retries() const
+  {
+    const size_t max_retries(10);
+    for(size_t attempt = 0; attempt < max_retries; ++attempt)
+      {
+        if(write_once())
+          {
+            return true;
+          }
+        if(attempt + 1 < max_retries)
+          {
+            std::stringstream ss;
+            ss << "Error writing checkpoint file '" << filename
+               << "'.  Retrying " << (attempt + 2) << "/" << max_retries
+               << "\n";
+            std::cerr << ss.str() << std::flush;
+          }
+      }
+    return false;
+  }
+
+  bool write_once() const
+  {
+    const int file_descriptor(
+      open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644));
+    if(file_descriptor == -1)
+      {
+        return false;
+      }
+    size_t written(0);
+    while(written < buffer.size())
+      {
+        const ssize_t result(::write(file_descriptor, buffer.data() + written,
+                                     buffer.size() - written));
+        if(result < 0 && errno == EINTR)
+          {
+            continue;
+          }
+        if(result < 0)
+          {
+            close(file_descriptor);
+            return false;
+          }
+        written += result;
+      }
+    const bool synced(fsync(file_descriptor) == 0);
+    return close(file_descriptor) == 0 && synced;
+  }
+};
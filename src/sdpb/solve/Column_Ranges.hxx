@@ -0,0 +1,67 @@
+#pragma once
+
+#include <El.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// The columns of a matrix that may be nonzero, as sorted, disjoint
+// ranges [first, second).  All other columns are zero.
+//
+// In SDPs with many decoupled free variables, such as mixed
+// correlators with many OPE coefficients, most columns of each block
+// of FreeVarMatrix are zero.  The columns of L'^{-1} FreeVarMatrix
+// are zero wherever the columns of FreeVarMatrix are, so the kernels
+// that multiply either of them only have to visit these ranges.  A
+// matrix without zero columns is a single range, and the kernels do
+// the same work as before.
+using Column_Ranges = std::vector<std::pair<int64_t, int64_t>>;
+
+// Collective over the grid of A.
+Column_Ranges nonzero_column_ranges(const El::DistMatrix<El::BigFloat> &A);
+
+// The union of a and b
+Column_Ranges
+merge_column_ranges(const Column_Ranges &a, const Column_Ranges &b);
+
+// y = alpha op(A) x + beta y, like El::Gemv, for an A that is zero
+// outside of columns.
+void column_ranges_gemv(const El::Orientation &orientation,
+                        const El::BigFloat &alpha,
+                        const El::DistMatrix<El::BigFloat> &A,
+                        const Column_Ranges &columns,
+                        const El::DistMatrix<El::BigFloat> &x,
+                        const El::BigFloat &beta,
+                        El::DistMatrix<El::BigFloat> &y);
+
+// Call f(row_begin, row_end, column_begin, column_end) for sub-blocks
+// that cover the nonzero part of the upper triangle of A^T A in
+// columns [panel_begin, panel_end), for an A that is zero outside of
+// columns.  A sub-block either lies entirely above the diagonal, or
+// is a square on the diagonal, with row_begin == column_begin.
+template <typename F>
+void for_each_upper_product(const Column_Ranges &columns,
+                            const int64_t &panel_begin,
+                            const int64_t &panel_end, const F &f)
+{
+  for(auto &column_range : columns)
+    {
+      const int64_t column_begin(std::max(column_range.first, panel_begin)),
+        column_end(std::min(column_range.second, panel_end));
+      if(column_begin >= column_end)
+        {
+          continue;
+        }
+      for(auto &row_range : columns)
+        {
+          if(row_range.first >= column_begin)
+            {
+              break;
+            }
+          f(row_range.first, std::min(row_range.second, column_begin),
+            column_begin, column_end);
+        }
+      f(column_begin, column_end, column_begin, column_end);
+    }
+}
@@ -0,0 +1,39 @@
+#include "../Column_Ranges.hxx"
+
+void column_ranges_gemv(const El::Orientation &orientation,
+                        const El::BigFloat &alpha,
+                        const El::DistMatrix<El::BigFloat> &A,
+                        const Column_Ranges &columns,
+                        const El::DistMatrix<El::BigFloat> &x,
+                        const El::BigFloat &beta,
+                        El::DistMatrix<El::BigFloat> &y)
+{
+  if(beta == El::BigFloat(0))
+    {
+      El::Zero(y);
+    }
+  else if(beta != El::BigFloat(1))
+    {
+      El::Scale(beta, y);
+    }
+  for(auto &range : columns)
+    {
+      const int64_t width(range.second - range.first);
+      const El::DistMatrix<El::BigFloat> A_columns(
+        El::LockedView(A, 0, range.first, A.Height(), width));
+      if(orientation == El::OrientationNS::NORMAL)
+        {
+          const El::DistMatrix<El::BigFloat> x_rows(
+            El::LockedView(x, range.first, 0, width, x.Width()));
+          El::Gemv(orientation, alpha, A_columns, x_rows, El::BigFloat(1),
+                   y);
+        }
+      else
+        {
+          El::DistMatrix<El::BigFloat> y_rows(
+            El::View(y, range.first, 0, width, y.Width()));
+          El::Gemv(orientation, alpha, A_columns, x, El::BigFloat(1),
+                   y_rows);
+        }
+    }
+}
@@ -0,0 +1,84 @@
+#include "../Column_Ranges.hxx"
+
+namespace
+{
+  // Zero columns between nonzero ones are only skipped if there are
+  // at least this many.  Every range costs a separate kernel call.
+  const int64_t min_gap(8);
+  // Past this many ranges, the smallest gaps are filled in.
+  const size_t max_ranges(8);
+}
+
+Column_Ranges nonzero_column_ranges(const El::DistMatrix<El::BigFloat> &A)
+{
+  std::vector<int> is_nonzero(A.Width(), 0);
+  const El::Matrix<El::BigFloat> &local(A.LockedMatrix());
+  const El::BigFloat zero(0);
+  for(int64_t column = 0; column < local.Width(); ++column)
+    for(int64_t row = 0; row < local.Height(); ++row)
+      {
+        if(local(row, column) != zero)
+          {
+            is_nonzero[A.GlobalCol(column)] = 1;
+            break;
+          }
+      }
+  if(A.Grid().Size() > 1 && !is_nonzero.empty())
+    {
+      El::mpi::AllReduce(is_nonzero.data(), is_nonzero.size(), El::mpi::MAX,
+                         A.Grid().Comm());
+    }
+
+  Column_Ranges result;
+  for(int64_t column = 0; column < A.Width(); ++column)
+    {
+      if(is_nonzero[column] == 0)
+        {
+          continue;
+        }
+      if(!result.empty() && column - result.back().second < min_gap)
+        {
+          result.back().second = column + 1;
+        }
+      else
+        {
+          result.emplace_back(column, column + 1);
+        }
+    }
+  while(result.size() > max_ranges)
+    {
+      size_t smallest(1);
+      for(size_t range = 2; range < result.size(); ++range)
+        {
+          if(result[range].first - result[range - 1].second
+             < result[smallest].first - result[smallest - 1].second)
+            {
+              smallest = range;
+            }
+        }
+      result[smallest - 1].second = result[smallest].second;
+      result.erase(result.begin() + smallest);
+    }
+  return result;
+}
+
+Column_Ranges
+merge_column_ranges(const Column_Ranges &a, const Column_Ranges &b)
+{
+  Column_Ranges all(a);
+  all.insert(all.end(), b.begin(), b.end());
+  std::sort(all.begin(), all.end());
+  Column_Ranges result;
+  for(auto &range : all)
+    {
+      if(!result.empty() && range.first <= result.back().second)
+        {
+          result.back().second = std::max(result.back().second, range.second);
+        }
+      else
+        {
+          result.push_back(range);
+        }
+    }
+  return result;
+}
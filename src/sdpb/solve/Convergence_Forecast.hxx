@@ -0,0 +1,56 @@
+#pragma once
+
+#include "../SDP_Solver_Parameters.hxx"
+
+#include <El.hpp>
+
+#include <array>
+#include <deque>
+
+// A forecast of the iterations and the time until the solver stops.
+// The logarithms of the duality gap and the errors fall roughly
+// linearly with the iteration count once the solver settles down, so
+// each of them is fitted by least squares over the last few
+// iterations, and extrapolated to its threshold.  The time per
+// iteration is the mean over the same iterations.
+//
+// The solver stops when the gap and both errors are below their
+// thresholds, or earlier with findPrimalFeasible or findDualFeasible,
+// so the forecast is the latest of the three, or the earliest of the
+// feasibility conditions that stop the run.  A quantity that is not
+// decreasing has no forecast, and the forecast is infinite when that
+// decides it.  It ignores maxIterations, maxRuntime and the other
+// stopping conditions.
+class Convergence_Forecast
+{
+public:
+  explicit Convergence_Forecast(const SDP_Solver_Parameters &parameters);
+
+  // The duality gap and the errors at the start of an iteration, and
+  // the seconds since the solver started, at its end.
+  void add(const El::BigFloat &duality_gap, const El::BigFloat &primal_error,
+           const El::BigFloat &dual_error, const double &elapsed_seconds);
+
+  // The iterations after the last one that was added.  Infinite when
+  // there is no forecast yet.
+  double remaining_iterations() const;
+  double remaining_seconds() const;
+  // The mean over the fitted iterations, or 0 with fewer than 2.
+  double seconds_per_iteration() const;
+
+private:
+  enum Quantity
+  {
+    duality_gap,
+    primal_error,
+    dual_error
+  };
+
+  bool find_primal_feasible, find_dual_feasible;
+  std::array<double, 3> log_thresholds;
+  // Each entry holds the logarithms of the quantities, and the elapsed
+  // seconds.
+  std::deque<std::array<double, 4>> history;
+
+  double remaining_iterations(const Quantity &quantity) const;
+};
@@ -0,0 +1,125 @@
+#include "../Convergence_Forecast.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+  // The number of iterations that are fitted.  Short enough to follow
+  // the changes of rate as the solver moves from the infeasible to
+  // the feasible phase.
+  constexpr size_t window(8);
+  // Fewer iterations than this give no forecast.
+  constexpr size_t min_iterations(3);
+  constexpr double infinity(std::numeric_limits<double>::infinity());
+
+  // The BigFloats can be far outside the range of a double, but their
+  // logarithms are not.  Zero is -infinity.
+  double log_of(const El::BigFloat &x)
+  {
+    return x > El::BigFloat(0) ? static_cast<double>(El::Log(x)) : -infinity;
+  }
+}
+
+Convergence_Forecast::Convergence_Forecast(
+  const SDP_Solver_Parameters &parameters)
+    : find_primal_feasible(parameters.find_primal_feasible),
+      find_dual_feasible(parameters.find_dual_feasible),
+      log_thresholds({log_of(parameters.duality_gap_threshold),
+                      log_of(parameters.primal_error_threshold),
+                      log_of(parameters.dual_error_threshold)})
+{}
+
+void Convergence_Forecast::add(const El::BigFloat &duality_gap,
+                               const El::BigFloat &primal_error,
+                               const El::BigFloat &dual_error,
+                               const double &elapsed_seconds)
+{
+  history.push_back({log_of(duality_gap), log_of(primal_error),
+                     log_of(dual_error), elapsed_seconds});
+  if(history.size() > window)
+    {
+      history.pop_front();
+    }
+}
+
+// The values at the start of the next iteration are not known yet, so
+// a quantity that the fit puts below its threshold r iterations after
+// the last one needs ceil(r) - 1 more iterations.
+double
+Convergence_Forecast::remaining_iterations(const Quantity &quantity) const
+{
+  const double current(history.back()[quantity]),
+    threshold(log_thresholds[quantity]);
+  if(current < threshold)
+    {
+      return 0;
+    }
+
+  // Least squares slope of the logarithm against the iteration.  The
+  // points are the ones with finite logarithms.
+  double n(0), sum_k(0), sum_v(0), sum_kk(0), sum_kv(0);
+  for(size_t k = 0; k < history.size(); ++k)
+    {
+      const double v(history[k][quantity]);
+      if(std::isfinite(v))
+        {
+          n += 1;
+          sum_k += k;
+          sum_v += v;
+          sum_kk += double(k) * k;
+          sum_kv += k * v;
+        }
+    }
+  const double denominator(n * sum_kk - sum_k * sum_k);
+  if(n < min_iterations || denominator <= 0)
+    {
+      return infinity;
+    }
+  const double slope((n * sum_kv - sum_k * sum_v) / denominator);
+  if(!(slope < 0))
+    {
+      return infinity;
+    }
+  return std::max(0.0, std::ceil((threshold - current) / slope) - 1);
+}
+
+double Convergence_Forecast::remaining_iterations() const
+{
+  if(history.size() < min_iterations)
+    {
+      return infinity;
+    }
+  const double primal(remaining_iterations(primal_error)),
+    dual(remaining_iterations(dual_error));
+  double result(std::max({remaining_iterations(duality_gap), primal, dual}));
+  if(find_primal_feasible)
+    {
+      result = std::min(result, primal);
+    }
+  if(find_dual_feasible)
+    {
+      result = std::min(result, dual);
+    }
+  return result;
+}
+
+double Convergence_Forecast::remaining_seconds() const
+{
+  const double iterations(remaining_iterations());
+  if(!std::isfinite(iterations) || iterations == 0)
+    {
+      return iterations;
+    }
+  return iterations * seconds_per_iteration();
+}
+
+double Convergence_Forecast::seconds_per_iteration() const
+{
+  if(history.size() < 2)
+    {
+      return 0;
+    }
+  return (history.back()[3] - history.front()[3]) / (history.size() - 1);
+}
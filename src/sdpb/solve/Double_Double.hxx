@@ -0,0 +1,138 @@
+#pragma once
+
+#include <El.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Double_Double: a number represented as the unevaluated sum hi + lo
+// of two doubles, with |lo| <= ulp(hi) / 2, which carries 106 bits.
+// Additions and products take a few floating point operations each,
+// using std::fma for the exact products, instead of the allocations
+// and limb loops of an mpf.  The formulas are the "sloppy" ones of
+// Dekker and of QD, which lose a few bits to cancellation that the
+// accurate ones would keep.
+
+struct Double_Double
+{
+  double hi = 0, lo = 0;
+
+  Double_Double() = default;
+  Double_Double(const double &Hi, const double &Lo = 0) : hi(Hi), lo(Lo) {}
+};
+
+namespace double_double
+{
+  // s + e = a + b exactly, for |a| >= |b|
+  inline Double_Double fast_two_sum(const double &a, const double &b)
+  {
+    const double s(a + b);
+    return {s, b - (s - a)};
+  }
+
+  inline Double_Double two_sum(const double &a, const double &b)
+  {
+    const double s(a + b), bb(s - a);
+    return {s, (a - (s - bb)) + (b - bb)};
+  }
+}
+
+inline Double_Double operator+(const Double_Double &a, const Double_Double &b)
+{
+  const Double_Double s(double_double::two_sum(a.hi, b.hi));
+  return double_double::fast_two_sum(s.hi, s.lo + a.lo + b.lo);
+}
+
+inline Double_Double operator-(const Double_Double &a)
+{
+  return {-a.hi, -a.lo};
+}
+
+inline Double_Double operator-(const Double_Double &a, const Double_Double &b)
+{
+  return a + (-b);
+}
+
+inline Double_Double operator*(const Double_Double &a, const Double_Double &b)
+{
+  const double p(a.hi * b.hi), e(std::fma(a.hi, b.hi, -p));
+  return double_double::fast_two_sum(p, e + a.hi * b.lo + a.lo * b.hi);
+}
+
+inline Double_Double operator/(const Double_Double &a, const Double_Double &b)
+{
+  const double q1(a.hi / b.hi);
+  const Double_Double r(a - b * Double_Double(q1));
+  return double_double::fast_two_sum(q1, r.hi / b.hi);
+}
+
+inline Double_Double &operator+=(Double_Double &a, const Double_Double &b)
+{
+  return a = a + b;
+}
+
+inline Double_Double &operator-=(Double_Double &a, const Double_Double &b)
+{
+  return a = a - b;
+}
+
+inline Double_Double sqrt(const Double_Double &a)
+{
+  if(a.hi <= 0)
+    {
+      return {};
+    }
+  const double s(std::sqrt(a.hi));
+  const Double_Double r(a - Double_Double(s) * Double_Double(s));
+  return double_double::fast_two_sum(s, r.hi / (2 * s));
+}
+
+// A column major matrix of Double_Doubles
+struct Double_Double_Matrix
+{
+  int64_t height = 0, width = 0;
+  std::vector<Double_Double> elements;
+
+  void resize(const int64_t &Height, const int64_t &Width)
+  {
+    height = Height;
+    width = Width;
+    elements.assign(height * width, Double_Double());
+  }
+  Double_Double &operator()(const int64_t &row, const int64_t &column)
+  {
+    return elements[row + column * height];
+  }
+  const Double_Double &
+  operator()(const int64_t &row, const int64_t &column) const
+  {
+    return elements[row + column * height];
+  }
+};
+
+// The kernels of block_kernels.hxx, with the same meaning as the
+// Elemental kernels, on Double_Double_Matrix.
+
+// C := alpha op(A) op(B) + beta C
+void double_double_gemm(const El::Orientation &orientation_A,
+                        const El::Orientation &orientation_B,
+                        const Double_Double &alpha,
+                        const Double_Double_Matrix &A,
+                        const Double_Double_Matrix &B,
+                        const Double_Double &beta, Double_Double_Matrix &C);
+
+// C := alpha op(A) op(A)^T + beta C, only in the uplo triangle of C
+void double_double_syrk(const El::UpperOrLower &uplo,
+                        const El::Orientation &orientation,
+                        const Double_Double &alpha,
+                        const Double_Double_Matrix &A,
+                        const Double_Double &beta, Double_Double_Matrix &C);
+
+// B := op(L)^{-1} B, where L is lower triangular and non-unit
+void double_double_trsm_lower(const El::Orientation &orientation,
+                              const Double_Double_Matrix &L,
+                              Double_Double_Matrix &B);
+
+// A := L, where A = L L^T, only touching the lower triangle
+void double_double_cholesky_lower(Double_Double_Matrix &A);
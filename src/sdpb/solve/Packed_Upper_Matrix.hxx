@@ -0,0 +1,105 @@
+#pragma once
+
+// The upper triangle of a square matrix, distributed like an
+// El::DistMatrix<El::BigFloat> (i.e. [MC,MR] with zero alignment) on
+// the same Grid.  Element (row, column) with row <= column lives on
+// the same rank as in the DistMatrix, but each rank only stores the
+// elements of the upper triangle, packed column by column.  This
+// halves the memory compared to a dense DistMatrix.
+//
+// Elements in the lower triangle do not exist, so IsLocal() is false
+// for them on every rank.
+
+#include <El.hpp>
+
+#include <vector>
+
+struct Packed_Upper_Matrix
+{
+  const El::Grid *grid;
+  int64_t height;
+  // offsets[local_column] is the index in 'elements' of the first
+  // element in that column.  offsets.back() == elements.size().
+  std::vector<size_t> offsets;
+  std::vector<El::BigFloat> elements;
+
+  Packed_Upper_Matrix(const int64_t &Height, const El::Grid &Grid)
+      : grid(&Grid), height(Height)
+  {
+    offsets.push_back(0);
+    for(int64_t column = grid->MRRank(); column < height;
+        column += grid->Width())
+      {
+        offsets.push_back(offsets.back() + rows_in_column(column));
+      }
+    elements.resize(offsets.back());
+  }
+
+  int64_t Height() const { return height; }
+  int64_t Width() const { return height; }
+  const El::Grid &Grid() const { return *grid; }
+
+  bool IsLocal(const int64_t &row, const int64_t &column) const
+  {
+    return row <= column && row % grid->Height() == grid->MCRank()
+           && column % grid->Width() == grid->MRRank();
+  }
+
+  // Only valid if IsLocal(row, column)
+  El::BigFloat &operator()(const int64_t &row, const int64_t &column)
+  {
+    return elements[index(row, column)];
+  }
+  const El::BigFloat &
+  operator()(const int64_t &row, const int64_t &column) const
+  {
+    return elements[index(row, column)];
+  }
+
+  void Zero()
+  {
+    for(auto &element : elements)
+      {
+        element = 0;
+      }
+  }
+
+  // Add the upper triangle of a dense panel to this matrix.  The
+  // panel holds rows [0, panel.Height()) and columns [column_offset,
+  // column_offset + panel.Width()).  The panel must be on the same
+  // Grid, with zero alignment, and column_offset must be a multiple
+  // of the Grid width, so that the panel's local elements are all
+  // local here as well.
+  void add_upper(const El::DistMatrix<El::BigFloat> &panel,
+                 const int64_t &column_offset)
+  {
+    const El::Matrix<El::BigFloat> &local(panel.LockedMatrix());
+    for(int64_t local_column = 0; local_column < panel.LocalWidth();
+        ++local_column)
+      {
+        const int64_t column(column_offset + panel.GlobalCol(local_column));
+        for(int64_t local_row = 0; local_row < panel.LocalHeight();
+            ++local_row)
+          {
+            const int64_t row(panel.GlobalRow(local_row));
+            if(row > column)
+              {
+                break;
+              }
+            (*this)(row, column) += local(local_row, local_column);
+          }
+      }
+  }
+
+private:
+  int64_t rows_in_column(const int64_t &column) const
+  {
+    return column < grid->MCRank()
+             ? 0
+             : (column - grid->MCRank()) / grid->Height() + 1;
+  }
+  size_t index(const int64_t &row, const int64_t &column) const
+  {
+    return offsets[column / grid->Width()] + row / grid->Height();
+  }
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <El.hpp>
+
+#include <vector>
+
+// Sums a vector over all ranks into a column vector distributed like
+// Q, with a single MPI_Reduce_scatter.  Every rank only receives the
+// sums for the elements it owns, instead of queueing an update for
+// each element.  The ownership, the MPI type and op, and the buffers
+// are set up once, when the solver starts, and reused for every
+// solve.
+//
+// Only for a distributed Q.  A Q that is replicated on every rank is
+// summed with an AllReduce instead.
+class Q_Column_Reduction
+{
+public:
+  // Collective over all ranks if Q is distributed
+  explicit Q_Column_Reduction(const El::DistMatrix<El::BigFloat> &Q);
+  ~Q_Column_Reduction();
+  Q_Column_Reduction(const Q_Column_Reduction &) = delete;
+  Q_Column_Reduction &operator=(const Q_Column_Reduction &) = delete;
+
+  // A Q.Height() x 1 vector for the local contributions, set to zero
+  El::Matrix<El::BigFloat> &zeroed_sum();
+
+  // result = the sum of zeroed_sum() over all ranks.  result must be
+  // a Q.Height() x 1 matrix on Q's grid.  Collective over all ranks.
+  void reduce_scatter(El::DistMatrix<El::BigFloat> &result);
+
+private:
+  bool is_distributed;
+  size_t serialized_size;
+  // The rows of the vector in the order that they are sent, grouped
+  // by the rank that owns them.
+  std::vector<int64_t> send_rows;
+  std::vector<int> receive_counts;
+  std::vector<El::byte> send_buffer, receive_buffer;
+  El::Matrix<El::BigFloat> sum;
+  MPI_Datatype serialized_type;
+  MPI_Op sum_op;
+};
@@ -0,0 +1,120 @@
+#include "../Q_Column_Reduction.hxx"
+#include "../../solver_comm.hxx"
+
+namespace
+{
+  void check_mpi_error(const int &mpi_error)
+  {
+    if(mpi_error != MPI_SUCCESS)
+      {
+        std::vector<char> error_string(MPI_MAX_ERROR_STRING);
+        int lengthOfErrorString;
+        MPI_Error_string(mpi_error, error_string.data(), &lengthOfErrorString);
+        El::RuntimeError(std::string(error_string.data()));
+      }
+  }
+
+  // MPI_User_function for serialized BigFloats: inout += in
+  void add_serialized(void *in, void *inout, int *len, MPI_Datatype *datatype)
+  {
+    int serialized_size;
+    MPI_Type_size(*datatype, &serialized_size);
+    const El::byte *in_bytes(static_cast<const El::byte *>(in));
+    El::byte *inout_bytes(static_cast<El::byte *>(inout));
+    El::BigFloat a, b;
+    for(int index = 0; index < *len; ++index)
+      {
+        a.Deserialize(in_bytes + index * serialized_size);
+        b.Deserialize(inout_bytes + index * serialized_size);
+        b += a;
+        b.Serialize(inout_bytes + index * serialized_size);
+      }
+  }
+}
+
+Q_Column_Reduction::Q_Column_Reduction(const El::DistMatrix<El::BigFloat> &Q)
+    : is_distributed(Q.Grid().Size() != 1),
+      serialized_size(El::BigFloat(0).SerializedSize())
+{
+  El::Zeros(sum, Q.Height(), 1);
+  if(!is_distributed)
+    {
+      return;
+    }
+
+  // Same distribution as dy_dist in solve_schur_complement_equation()
+  El::DistMatrix<El::BigFloat> column(Q.Grid());
+  El::Zeros(column, Q.Height(), 1);
+
+  const int total_ranks(El::mpi::Size(solver_comm()));
+  std::vector<std::vector<int64_t>> rank_rows(total_ranks);
+  for(int64_t row = 0; row < column.Height(); ++row)
+    {
+      rank_rows.at(column.Owner(row, 0)).push_back(row);
+    }
+  receive_counts.reserve(total_ranks);
+  send_rows.reserve(column.Height());
+  for(auto &rows : rank_rows)
+    {
+      receive_counts.push_back(rows.size());
+      send_rows.insert(send_rows.end(), rows.begin(), rows.end());
+    }
+
+  const int rank(El::mpi::Rank(solver_comm()));
+  if(receive_counts[rank] != column.LocalHeight() * column.LocalWidth())
+    {
+      throw std::runtime_error(
+        "Q_Column_Reduction: rank " + std::to_string(rank) + " owns "
+        + std::to_string(column.LocalHeight() * column.LocalWidth())
+        + " elements, but expected " + std::to_string(receive_counts[rank]));
+    }
+  send_buffer.resize(send_rows.size() * serialized_size);
+  receive_buffer.resize(std::max(receive_counts[rank], 1) * serialized_size);
+
+  check_mpi_error(
+    MPI_Type_contiguous(serialized_size, MPI_BYTE, &serialized_type));
+  check_mpi_error(MPI_Type_commit(&serialized_type));
+  check_mpi_error(MPI_Op_create(add_serialized, 1, &sum_op));
+}
+
+Q_Column_Reduction::~Q_Column_Reduction()
+{
+  if(is_distributed)
+    {
+      MPI_Op_free(&sum_op);
+      MPI_Type_free(&serialized_type);
+    }
+}
+
+El::Matrix<El::BigFloat> &Q_Column_Reduction::zeroed_sum()
+{
+  El::Zero(sum);
+  return sum;
+}
+
+void Q_Column_Reduction::reduce_scatter(El::DistMatrix<El::BigFloat> &result)
+{
+  if(!is_distributed)
+    {
+      throw std::runtime_error(
+        "Q_Column_Reduction: reduce_scatter needs a distributed Q");
+    }
+  for(size_t index = 0; index < send_rows.size(); ++index)
+    {
+      sum(send_rows[index], 0)
+        .Serialize(send_buffer.data() + index * serialized_size);
+    }
+  check_mpi_error(MPI_Reduce_scatter(
+    send_buffer.data(), receive_buffer.data(), receive_counts.data(),
+    serialized_type, sum_op, solver_comm().comm));
+
+  // The owned rows arrive in increasing order, which is the order of
+  // the local rows.
+  El::Matrix<El::BigFloat> &local(result.Matrix());
+  El::BigFloat element;
+  for(int64_t row = 0; row < local.Height() * local.Width(); ++row)
+    {
+      element.Deserialize(receive_buffer.data() + row * serialized_size);
+      local(row, 0) = element;
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../SDP_Solver_Parameters.hxx"
+
+#include <El.hpp>
+
+#include <memory>
+
+// The grid that Q is distributed over.
+//
+// - If Q has at most replicateQThreshold rows, a grid of size 1 on
+//   every rank, so that Q is replicated.
+// - Otherwise, a grid over the first size() ranks of solver_comm(),
+//   viewed by all of them, so that Q_Column_Reduction and
+//   Q_Synchronization_Plan can sum into it from every rank.  Only the
+//   ranks in the grid (grid().InGrid()) factor and solve with Q.
+//
+// The number of ranks is QGridSize, or else chosen from the size of
+// Q and the precision, so that the time of the distributed Cholesky
+// decomposition of Q is not dominated by the latency of spreading a
+// small matrix over the whole job.
+class Q_Grid
+{
+public:
+  // Collective over solver_comm()
+  Q_Grid(const SDP_Solver_Parameters &parameters, const int64_t &Q_height);
+  ~Q_Grid();
+  Q_Grid(const Q_Grid &) = delete;
+  Q_Grid &operator=(const Q_Grid &) = delete;
+
+  const El::Grid &grid() const;
+
+private:
+  // Empty if Q is on solver_grid()
+  std::unique_ptr<El::Grid> owned_grid;
+  El::mpi::Group owners;
+  bool has_owners = false;
+};
+
+// The number of ranks that Q is distributed over.  1 means that Q is
+// replicated.
+int Q_grid_size(const SDP_Solver_Parameters &parameters,
+                const int64_t &Q_height);
@@ -0,0 +1,73 @@
+#include "../Q_Grid.hxx"
+#include "../../solver_comm.hxx"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+  // Each rank of Q's grid owns at least this many elements of Q,
+  // scaled by 1024 / precision.  The cost of the arithmetic on those
+  // elements should then outweigh the latency of the collectives for
+  // each panel of the Cholesky decomposition.
+  const double min_Q_elements_per_rank(4096);
+}
+
+int Q_grid_size(const SDP_Solver_Parameters &parameters,
+                const int64_t &Q_height)
+{
+  const int num_procs(El::mpi::Size(solver_comm()));
+  if(num_procs == 1 || Q_height <= int64_t(parameters.replicate_Q_threshold))
+    {
+      return 1;
+    }
+  double result(parameters.Q_grid_size);
+  if(result == 0)
+    {
+      const double precision(std::max(parameters.working_precision,
+                                      size_t(El::gmp::Precision())));
+      result = double(Q_height) * Q_height * precision
+               / (min_Q_elements_per_rank * 1024);
+    }
+  // A grid of size 1 would mean a replicated Q.
+  return int(std::min(double(num_procs), std::max(2.0, result)));
+}
+
+Q_Grid::Q_Grid(const SDP_Solver_Parameters &parameters,
+               const int64_t &Q_height)
+{
+  const int size(Q_grid_size(parameters, Q_height));
+  if(size == 1)
+    {
+      owned_grid.reset(new El::Grid(El::mpi::COMM_SELF));
+    }
+  else if(size < El::mpi::Size(solver_comm()))
+    {
+      El::mpi::Group solver_group;
+      El::mpi::CommGroup(solver_comm(), solver_group);
+      std::vector<int> ranks(size);
+      std::iota(ranks.begin(), ranks.end(), 0);
+      El::mpi::Incl(solver_group, size, ranks.data(), owners);
+      El::mpi::Free(solver_group);
+      has_owners = true;
+      // The ranks of the grid are the first ranks of solver_comm(), so
+      // Q.Owner() is also the rank in solver_comm().
+      owned_grid.reset(new El::Grid(solver_comm(), owners,
+                                    El::Grid::DefaultHeight(size)));
+    }
+}
+
+Q_Grid::~Q_Grid()
+{
+  owned_grid.reset();
+  if(has_owners)
+    {
+      El::mpi::Free(owners);
+    }
+}
+
+const El::Grid &Q_Grid::grid() const
+{
+  return owned_grid ? *owned_grid : solver_grid();
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <El.hpp>
+
+#include <vector>
+
+// The layout used by synchronize_Q() to sum Q_group into Q.  Only Q
+// itself changes between iterations, so the owners of the elements
+// of Q and the communicators for the two level reduction are set up
+// once, when the solver starts, and reused for every iteration.
+//
+// Q is distributed [MC,MR], so every rank owns the elements of the
+// upper triangle in a fixed residue class of rows and columns.  That
+// lets each ring message be assembled by visiting only the elements
+// that go to its destination, instead of scanning all of Q once for
+// every message.
+class Q_Synchronization_Plan
+{
+public:
+  // Collective over all ranks if Q is distributed.  procs_per_node <=
+  // 1 means a single ring over all ranks.
+  Q_Synchronization_Plan(const El::DistMatrix<El::BigFloat> &Q,
+                         const size_t &procs_per_node);
+  ~Q_Synchronization_Plan();
+  Q_Synchronization_Plan(const Q_Synchronization_Plan &) = delete;
+  Q_Synchronization_Plan &operator=(const Q_Synchronization_Plan &)
+    = delete;
+
+  // Whether to use the two level reduction over node_comm and
+  // cross_node_comm.  Node rank l of node n is world rank n node_size
+  // + l.
+  bool is_hierarchical() const { return node_comm != MPI_COMM_NULL; }
+  int node_size;
+  MPI_Comm node_comm = MPI_COMM_NULL, cross_node_comm = MPI_COMM_NULL;
+
+  // The number of elements of the upper triangle of Q that are owned
+  // by the world rank owner.
+  int64_t num_owned(const int &owner) const
+  {
+    return owned_counts.at(owner);
+  }
+
+  // Call f(row, column) for every element of the upper triangle of Q
+  // that is owned by the world rank owner, in row major order.
+  template <typename F> void for_each_owned(const int &owner, const F &f) const
+  {
+    if(owner_rows.at(owner) < 0)
+      {
+        return;
+      }
+    for(int64_t row = owner_rows[owner]; row < height; row += row_stride)
+      for(int64_t column = first_column(owner, row); column < height;
+          column += column_stride)
+        {
+          f(row, column);
+        }
+  }
+
+private:
+  int64_t height, row_stride, column_stride;
+  // The first row and column owned by each rank, or -1 for ranks that
+  // do not own any part of Q.
+  std::vector<int64_t> owner_rows, owner_columns;
+  std::vector<int64_t> owned_counts;
+
+  // The first column >= row owned by owner
+  int64_t first_column(const int &owner, const int64_t &row) const
+  {
+    return row
+           + (owner_columns[owner] - row % column_stride + column_stride)
+               % column_stride;
+  }
+};
@@ -0,0 +1,76 @@
+#include "../Q_Synchronization_Plan.hxx"
+#include "../../solver_comm.hxx"
+
+namespace
+{
+  void check_mpi_error(const int &mpi_error)
+  {
+    if(mpi_error != MPI_SUCCESS)
+      {
+        std::vector<char> error_string(MPI_MAX_ERROR_STRING);
+        int lengthOfErrorString;
+        MPI_Error_string(mpi_error, error_string.data(), &lengthOfErrorString);
+        El::RuntimeError(std::string(error_string.data()));
+      }
+  }
+}
+
+Q_Synchronization_Plan::Q_Synchronization_Plan(
+  const El::DistMatrix<El::BigFloat> &Q, const size_t &procs_per_node)
+    : node_size(procs_per_node), height(Q.Height()),
+      row_stride(Q.ColStride()), column_stride(Q.RowStride())
+{
+  // A replicated Q is summed with a single AllReduce.
+  if(Q.Grid().Size() == 1)
+    {
+      return;
+    }
+
+  const int total_ranks(El::mpi::Size(solver_comm())),
+    rank(El::mpi::Rank(solver_comm()));
+  owner_rows.assign(total_ranks, -1);
+  owner_columns.assign(total_ranks, -1);
+  owned_counts.assign(total_ranks, 0);
+  for(int64_t row = 0; row < std::min(height, row_stride); ++row)
+    for(int64_t column = 0; column < std::min(height, column_stride);
+        ++column)
+      {
+        const int owner(Q.Owner(row, column));
+        owner_rows.at(owner) = row;
+        owner_columns.at(owner) = column;
+      }
+  for(int owner = 0; owner < total_ranks; ++owner)
+    {
+      if(owner_rows[owner] < 0)
+        {
+          continue;
+        }
+      for(int64_t row = owner_rows[owner]; row < height; row += row_stride)
+        {
+          const int64_t column(first_column(owner, row));
+          if(column < height)
+            {
+              owned_counts[owner] += (height - 1 - column) / column_stride + 1;
+            }
+        }
+    }
+
+  if(node_size > 1 && total_ranks > node_size
+     && total_ranks % node_size == 0)
+    {
+      check_mpi_error(MPI_Comm_split(solver_comm().comm,
+                                     rank / node_size, rank, &node_comm));
+      check_mpi_error(MPI_Comm_split(solver_comm().comm,
+                                     rank % node_size, rank,
+                                     &cross_node_comm));
+    }
+}
+
+Q_Synchronization_Plan::~Q_Synchronization_Plan()
+{
+  if(node_comm != MPI_COMM_NULL)
+    {
+      MPI_Comm_free(&node_comm);
+      MPI_Comm_free(&cross_node_comm);
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <El.hpp>
+
+#include <functional>
+#include <vector>
+
+// A batch of scalar reductions that are resolved with a single
+// collective.  On thousands of ranks, each AllReduce or Broadcast of a
+// single BigFloat costs about as much as it would to send dozens, so
+// the kernels of an iteration phase register their local
+// contributions here instead of reducing them one at a time.
+//
+// Every rank must register the same entries in the same order.
+// Nothing is written to the results until reduce() is called.
+
+class Reduction_Batch
+{
+public:
+  // result = sum, max or min of local over all ranks
+  void sum(const El::BigFloat &local, El::BigFloat &result);
+  void max(const El::BigFloat &local, El::BigFloat &result);
+  void min(const El::BigFloat &local, El::BigFloat &result);
+  // result = value on rank 0
+  void broadcast(const El::BigFloat &value, El::BigFloat &result);
+
+  // f is called after the results are written, for values that are
+  // derived from them.
+  void after_reduce(const std::function<void()> &f);
+
+  // Collective over comm.  Writes all of the results and empties the
+  // batch.
+  void reduce(const El::mpi::Comm &comm);
+
+  enum class Operation : El::byte
+  {
+    sum,
+    max,
+    min
+  };
+
+private:
+  struct Entry
+  {
+    Operation operation;
+    El::BigFloat local;
+    El::BigFloat *result;
+  };
+  std::vector<Entry> entries;
+  std::vector<std::function<void()>> callbacks;
+
+  void add(const Operation &operation, const El::BigFloat &local,
+           El::BigFloat &result);
+};
@@ -0,0 +1,125 @@
+#include "../Reduction_Batch.hxx"
+#include "../../solver_comm.hxx"
+
+// Each entry is sent as a record of the serialized BigFloat followed by
+// one byte for the operation, so that a single MPI_Op can apply a
+// different operation to each record.  A broadcast is a sum where
+// every rank except the root contributes zero, which is exact.
+
+namespace
+{
+  void check_mpi_error(const int &mpi_error)
+  {
+    if(mpi_error != MPI_SUCCESS)
+      {
+        std::vector<char> error_string(MPI_MAX_ERROR_STRING);
+        int lengthOfErrorString;
+        MPI_Error_string(mpi_error, error_string.data(), &lengthOfErrorString);
+        El::RuntimeError(std::string(error_string.data()));
+      }
+  }
+
+  // MPI_User_function: inout = operation(in, inout) for each record
+  void reduce_records(void *in, void *inout, int *len, MPI_Datatype *datatype)
+  {
+    int record_size;
+    MPI_Type_size(*datatype, &record_size);
+    const El::byte *in_bytes(static_cast<const El::byte *>(in));
+    El::byte *inout_bytes(static_cast<El::byte *>(inout));
+    El::BigFloat a, b;
+    for(int index = 0; index < *len; ++index)
+      {
+        const El::byte *in_record(in_bytes + index * record_size);
+        El::byte *inout_record(inout_bytes + index * record_size);
+        a.Deserialize(in_record);
+        b.Deserialize(inout_record);
+        switch(static_cast<Reduction_Batch::Operation>(
+          inout_record[record_size - 1]))
+          {
+          case Reduction_Batch::Operation::sum: b += a; break;
+          case Reduction_Batch::Operation::max: b = El::Max(a, b); break;
+          case Reduction_Batch::Operation::min: b = El::Min(a, b); break;
+          }
+        b.Serialize(inout_record);
+      }
+  }
+}
+
+void Reduction_Batch::add(const Operation &operation,
+                          const El::BigFloat &local, El::BigFloat &result)
+{
+  entries.push_back({operation, El::BigFloat(), &result});
+  // Serialize at the default precision, even for values computed at
+  // a block's precision.
+  entries.back().local = local;
+}
+
+void Reduction_Batch::sum(const El::BigFloat &local, El::BigFloat &result)
+{
+  add(Operation::sum, local, result);
+}
+
+void Reduction_Batch::max(const El::BigFloat &local, El::BigFloat &result)
+{
+  add(Operation::max, local, result);
+}
+
+void Reduction_Batch::min(const El::BigFloat &local, El::BigFloat &result)
+{
+  add(Operation::min, local, result);
+}
+
+void Reduction_Batch::broadcast(const El::BigFloat &value,
+                                El::BigFloat &result)
+{
+  add(Operation::sum,
+      El::mpi::Rank(solver_comm()) == 0 ? value : El::BigFloat(0), result);
+}
+
+void Reduction_Batch::after_reduce(const std::function<void()> &f)
+{
+  callbacks.push_back(f);
+}
+
+void Reduction_Batch::reduce(const El::mpi::Comm &comm)
+{
+  if(!entries.empty())
+    {
+      const size_t serialized_size(El::BigFloat(0).SerializedSize()),
+        record_size(serialized_size + 1);
+      std::vector<El::byte> send(entries.size() * record_size),
+        receive(send.size());
+      for(size_t index = 0; index < entries.size(); ++index)
+        {
+          El::byte *record(send.data() + index * record_size);
+          entries[index].local.Serialize(record);
+          record[serialized_size]
+            = static_cast<El::byte>(entries[index].operation);
+        }
+
+      MPI_Datatype record_type;
+      check_mpi_error(
+        MPI_Type_contiguous(record_size, MPI_BYTE, &record_type));
+      check_mpi_error(MPI_Type_commit(&record_type));
+      MPI_Op op;
+      check_mpi_error(MPI_Op_create(reduce_records, 1, &op));
+      check_mpi_error(MPI_Allreduce(send.data(), receive.data(),
+                                    entries.size(), record_type, op,
+                                    comm.comm));
+      check_mpi_error(MPI_Op_free(&op));
+      check_mpi_error(MPI_Type_free(&record_type));
+
+      El::BigFloat value;
+      for(size_t index = 0; index < entries.size(); ++index)
+        {
+          value.Deserialize(receive.data() + index * record_size);
+          *entries[index].result = value;
+        }
+    }
+  entries.clear();
+  for(auto &f : callbacks)
+    {
+      f();
+    }
+  callbacks.clear();
+}
@@ -10,8 +10,10 @@
 #include "../Block_Info.hxx"
 #include "Block_Matrix.hxx"
 #include "Block_Vector.hxx"
+#include "Column_Ranges.hxx"
 #include "Index_Tuple.hxx"
 #include "ostream.hxx"
+#include "../../In_Memory_SDP.hxx"
 
 #include <boost/filesystem.hpp>
 
@@ -82,17 +84,21 @@ public:
   //                                           0 <= k <= d_j,
   //                                           0 <= m <= delta_b)
   //
-  std::vector<El::Matrix<El::BigFloat>> bilinear_bases_local;
+  // Only the copy distributed over each block's grid is kept.  A
+  // replicated copy on every rank would multiply the memory by the
+  // number of ranks per node.
   std::vector<El::DistMatrix<El::BigFloat>> bilinear_bases_dist;
 
   // free_var_matrix = B, a PxN matrix
   Block_Matrix free_var_matrix;
+  // The columns of each block of free_var_matrix that may be nonzero
+  std::vector<Column_Ranges> free_var_columns;
 
   // c, a vector of length P used with primal_objective
   Block_Vector primal_objective_c;
 
   // b, a vector of length N used with dual_objective
-  // It is duplicated amongst all the blocks
+  // It is duplicated amongst all the grids, like y
   El::DistMatrix<El::BigFloat> dual_objective_b;
 
   // objectiveConst = f
@@ -100,4 +106,25 @@ public:
 
   SDP(const boost::filesystem::path &sdp_directory,
       const Block_Info &block_info, const El::Grid &grid);
+  // Collective.  The same SDP for a new mapping of the blocks, reusing
+  // what previous, read with previous_block_info, already holds.
+  // Blocks of c and B that stay on the same group of ranks, with the
+  // same grid shape, are moved out of previous, and the rest are read
+  // from sdp_directory.  previous must have the current precision.
+  SDP(const boost::filesystem::path &sdp_directory,
+      const Block_Info &block_info, const El::Grid &grid, SDP &previous,
+      const Block_Info &previous_block_info);
+  // Collective.  The same SDP from blocks that are spread over the
+  // ranks in memory.  block_info must come from the same
+  // in_memory_sdp.
+  SDP(const In_Memory_SDP &in_memory_sdp, const Block_Info &block_info,
+      const El::Grid &grid);
+
+  // Collective.  Read f, b and c from sdp_directory, and keep the
+  // constraints.  The objectives file and each primal_objective_c.*
+  // file are optional, and parts that are missing stay the same.
+  // Throws if the sizes do not match.
+  void replace_objectives(const boost::filesystem::path &sdp_directory,
+                          const Block_Info &block_info,
+                          const El::Grid &grid);
 };
@@ -2,6 +2,8 @@
 
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+
 void read_blocks(const boost::filesystem::path &sdp_directory, SDP &sdp);
 void compute_block_grid_mapping(const size_t &num_blocks,
                                 std::vector<size_t> &block_indices);
@@ -11,7 +13,6 @@ void read_objectives(const boost::filesystem::path &sdp_directory,
 void read_bilinear_bases(
   const boost::filesystem::path &sdp_directory, const Block_Info &block_info,
   const El::Grid &grid,
-  std::vector<El::Matrix<El::BigFloat>> &bilinear_bases_local,
   std::vector<El::DistMatrix<El::BigFloat>> &bilinear_bases_dist);
 
 void read_primal_objective_c(const boost::filesystem::path &sdp_directory,
@@ -21,15 +22,141 @@ void read_primal_objective_c(const boost::filesystem::path &sdp_directory,
 void read_free_var_matrix(const boost::filesystem::path &sdp_directory,
                           const std::vector<size_t> &block_indices,
                           const El::Grid &grid, Block_Matrix &free_var_matrix);
+void distribute_in_memory_blocks(
+  const In_Memory_SDP &in_memory_sdp, const Block_Info &block_info,
+  const El::Grid &grid,
+  std::vector<El::DistMatrix<El::BigFloat>> &bilinear_bases_dist,
+  Block_Vector &primal_objective_c, Block_Matrix &free_var_matrix);
 
 SDP::SDP(const boost::filesystem::path &sdp_directory,
          const Block_Info &block_info, const El::Grid &grid)
 {
   read_objectives(sdp_directory, grid, objective_const, dual_objective_b);
-  read_bilinear_bases(sdp_directory, block_info, grid,
-                      bilinear_bases_local, bilinear_bases_dist);
+  read_bilinear_bases(sdp_directory, block_info, grid, bilinear_bases_dist);
   read_primal_objective_c(sdp_directory, block_info.block_indices, grid,
                           primal_objective_c);
   read_free_var_matrix(sdp_directory, block_info.block_indices, grid,
                        free_var_matrix);
+  for(auto &block : free_var_matrix.blocks)
+    {
+      free_var_columns.push_back(nonzero_column_ranges(block));
+    }
+}
+
+namespace
+{
+  // The grids have the same ranks in the same order and shape, so
+  // every rank already holds its own elements of the block.
+  void move_block(El::DistMatrix<El::BigFloat> &previous,
+                  const El::Grid &grid,
+                  std::vector<El::DistMatrix<El::BigFloat>> &blocks)
+  {
+    blocks.emplace_back(previous.Height(), previous.Width(), grid);
+    auto &block(blocks.back());
+    if(block.LocalHeight() != previous.LocalHeight()
+       || block.LocalWidth() != previous.LocalWidth())
+      {
+        throw std::runtime_error(
+          "INTERNAL ERROR: a reused SDP block has a different distribution");
+      }
+    block.Matrix() = previous.LockedMatrix();
+    previous.Empty();
+  }
+}
+
+SDP::SDP(const boost::filesystem::path &sdp_directory,
+         const Block_Info &block_info, const El::Grid &grid, SDP &previous,
+         const Block_Info &previous_block_info)
+{
+  read_objectives(sdp_directory, grid, objective_const, dual_objective_b);
+  // The bilinear bases are small, and are shared between blocks, so
+  // they are simply read again.
+  read_bilinear_bases(sdp_directory, block_info, grid, bilinear_bases_dist);
+
+  // Every rank of a group compares the same pair of groups, so the
+  // whole group agrees on which blocks to read.
+  int comparison;
+  MPI_Comm_compare(block_info.mpi_comm.value.comm,
+                   previous_block_info.mpi_comm.value.comm, &comparison);
+  const bool is_same_grid(
+    (comparison == MPI_IDENT || comparison == MPI_CONGRUENT)
+    && block_info.grid_height() == previous_block_info.grid_height());
+
+  const std::vector<size_t> &previous_indices(
+    previous_block_info.block_indices);
+  std::vector<size_t> new_indices;
+  std::vector<int64_t> previous_positions;
+  for(auto &block_index : block_info.block_indices)
+    {
+      auto previous_index(std::find(previous_indices.begin(),
+                                    previous_indices.end(), block_index));
+      if(is_same_grid && previous_index != previous_indices.end())
+        {
+          previous_positions.push_back(
+            std::distance(previous_indices.begin(), previous_index));
+        }
+      else
+        {
+          previous_positions.push_back(-1);
+          new_indices.push_back(block_index);
+        }
+    }
+  Block_Vector new_primal_objective_c;
+  Block_Matrix new_free_var_matrix;
+  read_primal_objective_c(sdp_directory, new_indices, grid,
+                          new_primal_objective_c);
+  read_free_var_matrix(sdp_directory, new_indices, grid,
+                       new_free_var_matrix);
+
+  primal_objective_c.blocks.reserve(previous_positions.size());
+  free_var_matrix.blocks.reserve(previous_positions.size());
+  size_t new_block(0);
+  for(auto &position : previous_positions)
+    {
+      if(position == -1)
+        {
+          primal_objective_c.blocks.push_back(
+            std::move(new_primal_objective_c.blocks.at(new_block)));
+          free_var_matrix.blocks.push_back(
+            std::move(new_free_var_matrix.blocks.at(new_block)));
+          ++new_block;
+        }
+      else
+        {
+          move_block(previous.primal_objective_c.blocks.at(position), grid,
+                     primal_objective_c.blocks);
+          move_block(previous.free_var_matrix.blocks.at(position), grid,
+                     free_var_matrix.blocks);
+        }
+    }
+  for(auto &block : free_var_matrix.blocks)
+    {
+      free_var_columns.push_back(nonzero_column_ranges(block));
+    }
+}
+
+SDP::SDP(const In_Memory_SDP &in_memory_sdp, const Block_Info &block_info,
+         const El::Grid &grid)
+{
+  // Assigned rather than copied, so that objective_const has the
+  // current precision.
+  objective_const = in_memory_sdp.objective_const;
+  dual_objective_b.SetGrid(grid);
+  dual_objective_b.Resize(in_memory_sdp.dual_objective_b.size(), 1);
+  if(dual_objective_b.GlobalCol(0) == 0)
+    {
+      for(int64_t row = 0; row < dual_objective_b.LocalHeight(); ++row)
+        {
+          dual_objective_b.SetLocal(
+            row, 0,
+            in_memory_sdp.dual_objective_b[dual_objective_b.GlobalRow(row)]);
+        }
+    }
+  distribute_in_memory_blocks(in_memory_sdp, block_info, grid,
+                              bilinear_bases_dist, primal_objective_c,
+                              free_var_matrix);
+  for(auto &block : free_var_matrix.blocks)
+    {
+      free_var_columns.push_back(nonzero_column_ranges(block));
+    }
 }
@@ -0,0 +1,214 @@
+#include "../../SDP.hxx"
+#include "../../../../In_Memory_SDP.hxx"
+#include "../../../../binary_sdp_format.hxx"
+#include "../../../solver_comm.hxx"
+
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <numeric>
+
+// Every rank needs the blocks of its group, but they are in the memory
+// of the ranks that converted them.  Each converter sends every block
+// as one message to each rank that needs it, and the receiver decodes
+// the elements that it owns, as if it had mapped the binary files.
+//
+// All of the sends are posted before any receive, so the order of the
+// messages cannot deadlock.  A rank sends the blocks for a given
+// destination in increasing order of the block index, and the
+// destination receives them in that order, so that one tag is enough.
+
+namespace
+{
+  const int block_tag(0);
+
+  // Decode the binary image of one matrix at data into block.
+  // Returns the size of the image.
+  size_t decode_matrix(const char *data, const size_t &size,
+                       const std::string &name,
+                       El::DistMatrix<El::BigFloat> &block)
+  {
+    Binary_SDP_Header header;
+    if(size < sizeof(header) || !is_binary_sdp_header(data, size))
+      {
+        throw std::runtime_error("Corrupted " + name);
+      }
+    std::memcpy(&header, data, sizeof(header));
+    if(header.height < 0 || header.width < 0)
+      {
+        throw std::runtime_error("Corrupted " + name);
+      }
+    const size_t record_size(binary_sdp_record_size(header.num_limbs)),
+      image_size(sizeof(header)
+                 + size_t(header.height) * size_t(header.width)
+                     * record_size);
+    if(image_size > size)
+      {
+        throw std::runtime_error("Truncated " + name);
+      }
+    read_binary_sdp_header(data, image_size, name);
+
+    block.Resize(header.height, header.width);
+    const char *records(data + sizeof(header));
+    El::BigFloat input_num;
+    for(int64_t row = 0; row < block.LocalHeight(); ++row)
+      for(int64_t column = 0; column < block.LocalWidth(); ++column)
+        {
+          read_binary_sdp_element(
+            records
+              + (block.GlobalRow(row) * header.width
+                 + block.GlobalCol(column))
+                  * record_size,
+            input_num);
+          block.SetLocal(row, column, input_num);
+        }
+    return image_size;
+  }
+
+  // Returns the block indices of every rank
+  std::vector<std::vector<size_t>>
+  gather_block_indices(const std::vector<size_t> &block_indices)
+  {
+    const int num_procs(El::mpi::Size(solver_comm()));
+    const std::vector<uint64_t> local(block_indices.begin(),
+                                      block_indices.end());
+    int local_size(local.size());
+    std::vector<int> sizes(num_procs), offsets(num_procs, 0);
+    MPI_Allgather(&local_size, 1, MPI_INT, sizes.data(), 1, MPI_INT,
+                  solver_comm().comm);
+    for(int rank = 1; rank < num_procs; ++rank)
+      {
+        offsets[rank] = offsets[rank - 1] + sizes[rank - 1];
+      }
+    std::vector<uint64_t> all(offsets.back() + sizes.back());
+    MPI_Allgatherv(local.data(), local_size, MPI_UINT64_T, all.data(),
+                   sizes.data(), offsets.data(), MPI_UINT64_T,
+                   solver_comm().comm);
+
+    std::vector<std::vector<size_t>> result(num_procs);
+    for(int rank = 0; rank < num_procs; ++rank)
+      {
+        result[rank].assign(all.begin() + offsets[rank],
+                            all.begin() + offsets[rank] + sizes[rank]);
+      }
+    return result;
+  }
+}
+
+void distribute_in_memory_blocks(
+  const In_Memory_SDP &in_memory_sdp, const Block_Info &block_info,
+  const El::Grid &grid,
+  std::vector<El::DistMatrix<El::BigFloat>> &bilinear_bases_dist,
+  Block_Vector &primal_objective_c, Block_Matrix &free_var_matrix)
+{
+  const int rank(El::mpi::Rank(solver_comm())),
+    num_procs(El::mpi::Size(solver_comm()));
+  std::vector<int> sources(block_info.dimensions.size());
+  for(int source = 0; source < num_procs; ++source)
+    {
+      for(auto &index : block_info.file_block_indices.at(source))
+        {
+          sources.at(index) = source;
+        }
+    }
+  std::map<size_t, const In_Memory_Block *> local_blocks;
+  for(auto &block : in_memory_sdp.blocks)
+    {
+      local_blocks.emplace(block.index, &block);
+    }
+
+  std::vector<MPI_Request> requests;
+  const std::vector<std::vector<size_t>> all_block_indices(
+    gather_block_indices(block_info.block_indices));
+  for(int destination = 0; destination < num_procs; ++destination)
+    {
+      if(destination == rank)
+        {
+          continue;
+        }
+      std::vector<size_t> indices(all_block_indices[destination]);
+      std::sort(indices.begin(), indices.end());
+      for(auto &index : indices)
+        {
+          if(sources.at(index) != rank)
+            {
+              continue;
+            }
+          const std::vector<char> &data(local_blocks.at(index)->data);
+          if(data.size() > size_t(INT_MAX))
+            {
+              throw std::runtime_error(
+                "Block " + std::to_string(index)
+                + " is too large to send in a single message");
+            }
+          requests.emplace_back();
+          MPI_Isend(data.data(), data.size(), MPI_BYTE, destination,
+                    block_tag, solver_comm().comm, &requests.back());
+        }
+    }
+
+  const std::vector<size_t> &block_indices(block_info.block_indices);
+  bilinear_bases_dist.clear();
+  bilinear_bases_dist.reserve(2 * block_indices.size());
+  primal_objective_c.blocks.clear();
+  primal_objective_c.blocks.reserve(block_indices.size());
+  free_var_matrix.blocks.clear();
+  free_var_matrix.blocks.reserve(block_indices.size());
+  for(size_t position = 0; position < block_indices.size(); ++position)
+    {
+      bilinear_bases_dist.emplace_back(grid);
+      bilinear_bases_dist.emplace_back(grid);
+      primal_objective_c.blocks.emplace_back(grid);
+      free_var_matrix.blocks.emplace_back(grid);
+    }
+
+  std::vector<size_t> order(block_indices.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&](const size_t &a, const size_t &b) {
+              return block_indices[a] < block_indices[b];
+            });
+  std::vector<char> buffer;
+  for(auto &position : order)
+    {
+      const size_t index(block_indices[position]);
+      const int source(sources.at(index));
+      const char *data;
+      size_t size;
+      if(source == rank)
+        {
+          data = local_blocks.at(index)->data.data();
+          size = local_blocks.at(index)->data.size();
+        }
+      else
+        {
+          MPI_Status status;
+          MPI_Probe(source, block_tag, solver_comm().comm, &status);
+          int count;
+          MPI_Get_count(&status, MPI_BYTE, &count);
+          buffer.resize(count);
+          MPI_Recv(buffer.data(), count, MPI_BYTE, source, block_tag,
+                   solver_comm().comm, MPI_STATUS_IGNORE);
+          data = buffer.data();
+          size = buffer.size();
+        }
+
+      const std::string name("block " + std::to_string(index)
+                             + " from rank " + std::to_string(source));
+      size_t offset(0);
+      for(auto block :
+          {&primal_objective_c.blocks[position],
+           &free_var_matrix.blocks[position],
+           &bilinear_bases_dist[2 * position],
+           &bilinear_bases_dist[2 * position + 1]})
+        {
+          offset
+            += decode_matrix(data + offset, size - offset, name, *block);
+        }
+      if(offset != size)
+        {
+          throw std::runtime_error("Unexpected data at the end of " + name);
+        }
+    }
+  MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+}
@@ -5,17 +5,144 @@
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 
+#include <map>
+
+// Each basis is read into a temporary local matrix and immediately
+// copied into its distributed matrix, so only one basis is ever
+// replicated on a rank.
+//
+// blocks.<file_rank> says which blocks are in bilinear_bases.<file_rank>,
+// so files without any of our blocks are never opened.  If
+// bilinear_bases_index.<file_rank> exists, we use the offsets in it to
+// seek straight to our blocks.  Otherwise, we fall back to scanning
+// through the whole file.
+//
+// The converters only store identical bases once, pointing the index
+// of every block that uses them at the same offset.  Those files can
+// only be read with the index.  Our blocks that share an offset also
+// share a single copy of the bases: the later ones are locked views
+// of the first.
+
+namespace
+{
+  void read_basis(boost::filesystem::ifstream &bilinear_stream,
+                  const boost::filesystem::path &bilinear_path,
+                  El::Matrix<El::BigFloat> &local,
+                  El::DistMatrix<El::BigFloat> &dist)
+  {
+    size_t height, width;
+    bilinear_stream >> height >> width;
+    if(!bilinear_stream.good())
+      {
+        throw std::runtime_error("Corrupted header in file: "
+                                 + bilinear_path.string());
+      }
+    local.Resize(height, width);
+    for(size_t row = 0; row < height; ++row)
+      for(size_t column = 0; column < width; ++column)
+        {
+          bilinear_stream >> local(row, column);
+        }
+
+    dist.Resize(height, width);
+    for(int64_t row = 0; row < dist.LocalHeight(); ++row)
+      {
+        El::Int global_row(dist.GlobalRow(row));
+        for(int64_t column = 0; column < dist.LocalWidth(); ++column)
+          {
+            El::Int global_column(dist.GlobalCol(column));
+            dist.SetLocal(row, column, local(global_row, global_column));
+          }
+      }
+  }
+
+  void skip_basis(boost::filesystem::ifstream &bilinear_stream,
+                  const boost::filesystem::path &bilinear_path)
+  {
+    size_t height, width;
+    bilinear_stream >> height >> width;
+    if(!bilinear_stream.good())
+      {
+        throw std::runtime_error("Corrupted header in file: "
+                                 + bilinear_path.string());
+      }
+    // Add one to get the initial newline after 'width'.
+    for(size_t line = 0; line < height * width + 1; ++line)
+      {
+        bilinear_stream.ignore(std::numeric_limits<std::streamsize>::max(),
+                               '\n');
+      }
+  }
+
+  // Returns an empty vector if there is no usable index
+  std::vector<size_t>
+  read_bilinear_index(const boost::filesystem::path &index_path,
+                      const size_t &file_num_bases,
+                      const boost::filesystem::path &bilinear_path)
+  {
+    std::vector<size_t> offsets;
+    boost::filesystem::ifstream index_stream(index_path);
+    if(!index_stream.good())
+      {
+        return offsets;
+      }
+    read_vector(index_stream, offsets);
+    // A stale index from a previous conversion would send us to the
+    // wrong places, so check that it at least matches the file.
+    if(offsets.size() != file_num_bases + 1
+       || offsets.back() != boost::filesystem::file_size(bilinear_path))
+      {
+        offsets.clear();
+      }
+    return offsets;
+  }
+}
+
 void read_bilinear_bases(
   const boost::filesystem::path &sdp_directory, const Block_Info &block_info,
   const El::Grid &grid,
-  std::vector<El::Matrix<El::BigFloat>> &bilinear_bases_local,
   std::vector<El::DistMatrix<El::BigFloat>> &bilinear_bases_dist)
 {
   auto &block_indices(block_info.block_indices);
-  bilinear_bases_local.resize(2 * block_indices.size());
+  bilinear_bases_dist.clear();
+  bilinear_bases_dist.reserve(2 * block_indices.size());
+  for(size_t block_index = 0; block_index < 2 * block_indices.size();
+      ++block_index)
+    {
+      bilinear_bases_dist.emplace_back(grid);
+    }
+
+  El::Matrix<El::BigFloat> local;
 
   for(size_t file_rank(0); file_rank < block_info.file_num_procs; ++file_rank)
     {
+      // The index of bilinear_bases in each file is described by
+      // file_block_indices.  However, block_indices is not in
+      // numerical order.  So we have to take care when placing
+      // blocks.  local_positions[block] is the position in
+      // block_indices of the block'th block in the file, or
+      // block_indices.size() if we do not need it.
+      const std::vector<size_t> &file_blocks(
+        block_info.file_block_indices.at(file_rank));
+      std::vector<size_t> local_positions(file_blocks.size(),
+                                          block_indices.size());
+      bool has_local_blocks(false);
+      for(size_t block = 0; block < file_blocks.size(); ++block)
+        {
+          auto block_iter(std::find(block_indices.begin(),
+                                    block_indices.end(), file_blocks[block]));
+          if(block_iter != block_indices.end())
+            {
+              local_positions[block]
+                = std::distance(block_indices.begin(), block_iter);
+              has_local_blocks = true;
+            }
+        }
+      if(!has_local_blocks)
+        {
+          continue;
+        }
+
       const boost::filesystem::path bilinear_path(
         sdp_directory / ("bilinear_bases." + std::to_string(file_rank)));
       boost::filesystem::ifstream bilinear_stream(bilinear_path);
@@ -26,73 +153,64 @@ void read_bilinear_bases(
         }
       size_t file_num_bases;
       bilinear_stream >> file_num_bases;
-      if(!bilinear_stream.good())
+      if(!bilinear_stream.good() || file_num_bases != file_blocks.size())
         {
           throw std::runtime_error("Corrupted or empty file: "
                                    + bilinear_path.string());
         }
 
-      // The index of bilinear_bases in each file is described by
-      // file_block_indices.  However, block_indices is not in
-      // numerical order.  So we have to take care when placing blocks
-      for(size_t block = 0; block < file_num_bases; ++block)
-        for(size_t parity = 0; parity < 2; ++parity)
-          {
-            size_t height, width;
-            bilinear_stream >> height >> width;
-            if(!bilinear_stream.good())
-              {
-                throw std::runtime_error("Corrupted header in file: "
-                                         + bilinear_path.string());
-              }
+      const std::vector<size_t> offsets(read_bilinear_index(
+        sdp_directory
+          / ("bilinear_bases_index." + std::to_string(file_rank)),
+        file_num_bases, bilinear_path));
 
-            auto block_iter(std::find(
-              block_indices.begin(), block_indices.end(),
-              block_info.file_block_indices.at(file_rank).at(block)));
-
-            if(block_iter != block_indices.end())
-              {
-                size_t block_index(
-                  2 * std::distance(block_indices.begin(), block_iter)
-                  + parity);
-                auto &local(bilinear_bases_local.at(block_index));
-                local.Resize(height, width);
-                for(size_t row = 0; row < height; ++row)
-                  for(size_t column = 0; column < width; ++column)
+      // The position in block_indices of the first of our blocks at
+      // each offset
+      std::map<size_t, size_t> read_positions;
+      for(size_t block = 0; block < file_num_bases; ++block)
+        {
+          const bool is_local(local_positions[block] != block_indices.size());
+          if(!offsets.empty())
+            {
+              if(!is_local)
+                {
+                  continue;
+                }
+              auto read_position(
+                read_positions.emplace(offsets[block], local_positions[block])
+                  .first);
+              if(read_position->second != local_positions[block])
+                {
+                  for(size_t parity = 0; parity < 2; ++parity)
                     {
-                      bilinear_stream >> local(row, column);
+                      El::LockedView(
+                        bilinear_bases_dist.at(2 * local_positions[block]
+                                               + parity),
+                        bilinear_bases_dist.at(2 * read_position->second
+                                               + parity));
                     }
-              }
-            else
-              {
-                // Add one to get the initial newline after 'width'.
-                for(size_t line = 0; line < height * width + 1; ++line)
-                  {
-                    bilinear_stream.ignore(
-                      std::numeric_limits<std::streamsize>::max(), '\n');
-                  }
-              }
-          }
+                  continue;
+                }
+              bilinear_stream.seekg(offsets[block]);
+            }
+          for(size_t parity = 0; parity < 2; ++parity)
+            {
+              if(is_local)
+                {
+                  read_basis(bilinear_stream, bilinear_path, local,
+                             bilinear_bases_dist.at(
+                               2 * local_positions[block] + parity));
+                }
+              else
+                {
+                  skip_basis(bilinear_stream, bilinear_path);
+                }
+            }
+        }
       if(!bilinear_stream.good())
         {
           throw std::runtime_error("Corrupted data in file: "
                                    + bilinear_path.string());
         }
     }
-
-  bilinear_bases_dist.reserve(bilinear_bases_local.size());
-  for(auto &local : bilinear_bases_local)
-    {
-      bilinear_bases_dist.emplace_back(local.Height(), local.Width(), grid);
-      auto &dist(bilinear_bases_dist.back());
-      for(int64_t row = 0; row < dist.LocalHeight(); ++row)
-        {
-          El::Int global_row(dist.GlobalRow(row));
-          for(int64_t column = 0; column < dist.LocalWidth(); ++column)
-            {
-              El::Int global_column(dist.GlobalCol(column));
-              dist.SetLocal(row, column, local(global_row, global_column));
-            }
-        }
-    }
 }
@@ -1,7 +1,12 @@
 #include "../../Block_Matrix.hxx"
+#include "../../../Mapped_File.hxx"
+#include "../../../../binary_sdp_format.hxx"
 
 #include <boost/filesystem.hpp>
-#include <boost/filesystem/fstream.hpp>
+
+void read_text_block(const boost::filesystem::path &path,
+                     const bool &is_vector,
+                     El::DistMatrix<El::BigFloat> &block);
 
 void read_free_var_matrix(const boost::filesystem::path &sdp_directory,
                           const std::vector<size_t> &block_indices,
@@ -12,37 +17,39 @@ void read_free_var_matrix(const boost::filesystem::path &sdp_directory,
     {
       const boost::filesystem::path free_var_matrix_path(
         sdp_directory / ("free_var_matrix." + std::to_string(block_index)));
-      boost::filesystem::ifstream free_var_matrix_stream(free_var_matrix_path);
-      if(!free_var_matrix_stream.good())
-        {
-          throw std::runtime_error("Could not open '"
-                                   + free_var_matrix_path.string() + "'");
-        }
 
-      size_t height, width;
-      free_var_matrix_stream >> height >> width;
-      if(!free_var_matrix_stream.good())
-        {
-          throw std::runtime_error("Corrupted header in file: "
-                                   + free_var_matrix_path.string());
-        }
-      free_var_matrix.blocks.emplace_back(height, width, grid);
-      auto &block(free_var_matrix.blocks.back());
-      for(size_t row = 0; row < height; ++row)
-        for(size_t column = 0; column < width; ++column)
+      // Binary files are mapped, and each process only decodes its
+      // own elements.
+      {
+        const Mapped_File mapped(free_var_matrix_path);
+        if(is_binary_sdp_header(mapped.data, mapped.size))
           {
+            const Binary_SDP_Header header(read_binary_sdp_header(
+              mapped.data, mapped.size, free_var_matrix_path.string()));
+            const size_t record_size(
+              binary_sdp_record_size(header.num_limbs));
+            free_var_matrix.blocks.emplace_back(header.height, header.width,
+                                                grid);
+            auto &block(free_var_matrix.blocks.back());
+            const char *records(mapped.data + sizeof(header));
             El::BigFloat input_num;
-            free_var_matrix_stream >> input_num;
-            if(block.IsLocal(row, column))
-              {
-                block.SetLocal(block.LocalRow(row), block.LocalCol(column),
-                               input_num);
-              }
+            for(int64_t row = 0; row < block.LocalHeight(); ++row)
+              for(int64_t column = 0; column < block.LocalWidth(); ++column)
+                {
+                  read_binary_sdp_element(
+                    records
+                      + (block.GlobalRow(row) * header.width
+                         + block.GlobalCol(column))
+                          * record_size,
+                    input_num);
+                  block.SetLocal(row, column, input_num);
+                }
+            continue;
           }
-      if(!free_var_matrix_stream.good())
-        {
-          throw std::runtime_error("Corrupted data in file: "
-                                   + free_var_matrix_path.string());
-        }
+      }
+
+      free_var_matrix.blocks.emplace_back(grid);
+      read_text_block(free_var_matrix_path, false,
+                      free_var_matrix.blocks.back());
     }
 }
@@ -1,8 +1,12 @@
-#include "../../../read_vector.hxx"
 #include "../../Block_Vector.hxx"
+#include "../../../Mapped_File.hxx"
+#include "../../../../binary_sdp_format.hxx"
 
 #include <boost/filesystem.hpp>
-#include <boost/filesystem/fstream.hpp>
+
+void read_text_block(const boost::filesystem::path &path,
+                     const bool &is_vector,
+                     El::DistMatrix<El::BigFloat> &block);
 
 void read_primal_objective_c(const boost::filesystem::path &sdp_directory,
                              const std::vector<size_t> &block_indices,
@@ -14,25 +18,36 @@ void read_primal_objective_c(const boost::filesystem::path &sdp_directory,
     {
       const boost::filesystem::path primal_path(
         sdp_directory / ("primal_objective_c." + std::to_string(block_index)));
-      boost::filesystem::ifstream primal_stream(primal_path);
-      if(!primal_stream.good())
-        {
-          throw std::runtime_error("Could not open '" + primal_path.string()
-                                   + "'");
-        }
 
-      std::vector<El::BigFloat> temp;
-      read_vector(primal_stream, temp);
-      primal_objective_c.blocks.emplace_back(temp.size(), 1, grid);
-      auto &block(primal_objective_c.blocks.back());
-      size_t local_height(block.LocalHeight());
-      if(block.GlobalCol(0) == 0)
-        {
-          for(size_t row = 0; row < local_height; ++row)
-            {
-              size_t global_row(block.GlobalRow(row));
-              block.SetLocal(row, 0, temp.at(global_row));
-            }
-        }
+      {
+        const Mapped_File mapped(primal_path);
+        if(is_binary_sdp_header(mapped.data, mapped.size))
+          {
+            const Binary_SDP_Header header(read_binary_sdp_header(
+              mapped.data, mapped.size, primal_path.string()));
+            if(header.width != 1)
+              {
+                throw std::runtime_error("Expected a vector in: "
+                                         + primal_path.string());
+              }
+            const size_t record_size(
+              binary_sdp_record_size(header.num_limbs));
+            primal_objective_c.blocks.emplace_back(header.height, 1, grid);
+            auto &block(primal_objective_c.blocks.back());
+            const char *records(mapped.data + sizeof(header));
+            El::BigFloat input_num;
+            for(int64_t row = 0; row < block.LocalHeight(); ++row)
+              for(int64_t column = 0; column < block.LocalWidth(); ++column)
+                {
+                  read_binary_sdp_element(
+                    records + block.GlobalRow(row) * record_size, input_num);
+                  block.SetLocal(row, column, input_num);
+                }
+            continue;
+          }
+      }
+
+      primal_objective_c.blocks.emplace_back(grid);
+      read_text_block(primal_path, true, primal_objective_c.blocks.back());
     }
 }
@@ -0,0 +1,84 @@
+#include "../../../../compressed_sdp_format.hxx"
+
+#include <El.hpp>
+#include <boost/filesystem.hpp>
+
+#include <array>
+
+// Read a block from a text file into 'block'.  Only the root of the
+// block's grid opens and parses the file.  It then scatters the
+// elements to their owners, so each file is read once per grid
+// rather than once per rank.
+//
+// Matrices start with "height width", and vectors (is_vector) start
+// with just "height", as written by write_vector().  The file may be
+// compressed (see compressed_sdp_format.hxx).
+//
+// Errors on the root are broadcast, so that every rank in the grid
+// throws instead of waiting forever for the scatter.
+
+void read_text_block(const boost::filesystem::path &path,
+                     const bool &is_vector,
+                     El::DistMatrix<El::BigFloat> &block)
+{
+  El::DistMatrix<El::BigFloat, El::CIRC, El::CIRC> root_block(block.Grid());
+  const bool is_root(root_block.CrossRank() == root_block.Root());
+
+  // {ok, height, width}
+  std::array<int64_t, 3> header({{1, 0, 0}});
+  std::string error_message("Error reading '" + path.string() + "'");
+  if(is_root)
+    {
+      try
+        {
+          SDP_Input_Stream stream(path);
+          if(!stream.good())
+            {
+              throw std::runtime_error("Could not open '" + path.string()
+                                       + "'");
+            }
+          size_t height, width(1);
+          stream >> height;
+          if(!is_vector)
+            {
+              stream >> width;
+            }
+          if(!stream.good())
+            {
+              throw std::runtime_error("Corrupted header in file: "
+                                       + path.string());
+            }
+          root_block.Resize(height, width);
+          El::Matrix<El::BigFloat> &local(root_block.Matrix());
+          for(size_t row = 0; row < height; ++row)
+            for(size_t column = 0; column < width; ++column)
+              {
+                stream >> local(row, column);
+              }
+          if(!stream.good())
+            {
+              throw std::runtime_error("Corrupted data in file: "
+                                       + path.string());
+            }
+          header[1] = height;
+          header[2] = width;
+        }
+      catch(std::exception &e)
+        {
+          header[0] = 0;
+          error_message = e.what();
+        }
+    }
+
+  // See the note in load_binary_checkpoint about Broadcast() and
+  // int64_t.
+  El::mpi::Broadcast(reinterpret_cast<El::byte *>(header.data()),
+                     sizeof(header) / sizeof(El::byte), root_block.Root(),
+                     root_block.CrossComm());
+  if(header[0] == 0)
+    {
+      throw std::runtime_error(error_message);
+    }
+  root_block.Resize(header[1], header[2]);
+  El::Copy(root_block, block);
+}
@@ -0,0 +1,69 @@
+#include "../../SDP.hxx"
+
+#include <boost/filesystem.hpp>
+
+void read_objectives(const boost::filesystem::path &sdp_directory,
+                     const El::Grid &grid, El::BigFloat &objective_const,
+                     El::DistMatrix<El::BigFloat> &dual_objective_b);
+void read_primal_objective_c(const boost::filesystem::path &sdp_directory,
+                             const std::vector<size_t> &block_indices,
+                             const El::Grid &grid,
+                             Block_Vector &primal_objective_c);
+
+// For scans where only the objectives change between SDPs.  The
+// bilinear bases and free_var_matrix are kept, so that the sdp
+// directory only has to hold the objectives.
+void SDP::replace_objectives(const boost::filesystem::path &sdp_directory,
+                             const Block_Info &block_info,
+                             const El::Grid &grid)
+{
+  if(boost::filesystem::exists(sdp_directory / "objectives"))
+    {
+      El::DistMatrix<El::BigFloat> new_dual_objective_b;
+      El::BigFloat new_objective_const;
+      read_objectives(sdp_directory, grid, new_objective_const,
+                      new_dual_objective_b);
+      if(new_dual_objective_b.Height() != dual_objective_b.Height())
+        {
+          throw std::runtime_error(
+            "The objectives in " + sdp_directory.string() + " have "
+            + std::to_string(new_dual_objective_b.Height())
+            + " free variables instead of "
+            + std::to_string(dual_objective_b.Height()));
+        }
+      objective_const = new_objective_const;
+      El::Copy(new_dual_objective_b, dual_objective_b);
+    }
+
+  std::vector<size_t> replaced_indices;
+  std::vector<size_t> replaced_positions;
+  for(size_t position = 0; position < block_info.block_indices.size();
+      ++position)
+    {
+      const size_t block_index(block_info.block_indices[position]);
+      if(boost::filesystem::exists(
+           sdp_directory
+           / ("primal_objective_c." + std::to_string(block_index))))
+        {
+          replaced_indices.push_back(block_index);
+          replaced_positions.push_back(position);
+        }
+    }
+  Block_Vector new_primal_objective_c;
+  read_primal_objective_c(sdp_directory, replaced_indices, grid,
+                          new_primal_objective_c);
+  for(size_t replaced = 0; replaced < replaced_indices.size(); ++replaced)
+    {
+      auto &new_block(new_primal_objective_c.blocks[replaced]);
+      auto &block(primal_objective_c.blocks[replaced_positions[replaced]]);
+      if(new_block.Height() != block.Height())
+        {
+          throw std::runtime_error(
+            "primal_objective_c." + std::to_string(replaced_indices[replaced])
+            + " in " + sdp_directory.string() + " has "
+            + std::to_string(new_block.Height()) + " rows instead of "
+            + std::to_string(block.Height()));
+        }
+      El::Copy(new_block, block);
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+// Reads the primal_objective_c and free_var_matrix files of a rank's
+// blocks on a background thread, in the order that SDP reads them, so
+// that they are in the page cache by the time SDP decodes them.  The
+// reads of later blocks overlap with the decoding of earlier ones,
+// and with whatever the solver does between creating the prefetch and
+// creating the SDP.
+//
+// The data is read into a scratch buffer and dropped.  Errors are
+// ignored, since SDP reports them when it reads the files itself.
+
+#include <boost/filesystem.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+class SDP_Prefetch
+{
+public:
+  SDP_Prefetch(const boost::filesystem::path &sdp_directory,
+               const std::vector<size_t> &block_indices)
+      : is_stopping(false)
+  {
+    for(auto &prefix : {"primal_objective_c.", "free_var_matrix."})
+      {
+        for(auto &block_index : block_indices)
+          {
+            paths.push_back(sdp_directory
+                            / (prefix + std::to_string(block_index)));
+          }
+      }
+    thread = std::thread([this]() { read_files(); });
+  }
+  SDP_Prefetch(const SDP_Prefetch &) = delete;
+  SDP_Prefetch &operator=(const SDP_Prefetch &) = delete;
+  // Stops after the current read
+  ~SDP_Prefetch()
+  {
+    is_stopping = true;
+    thread.join();
+  }
+
+private:
+  std::vector<boost::filesystem::path> paths;
+  std::atomic<bool> is_stopping;
+  std::thread thread;
+
+  void read_files() const
+  {
+    std::vector<char> buffer(1 << 20);
+    for(auto &path : paths)
+      {
+        const int file_descriptor(open(path.c_str(), O_RDONLY));
+        if(file_descriptor == -1)
+          {
+            continue;
+          }
+        while(!is_stopping
+              && ::read(file_descriptor, buffer.data(), buffer.size()) > 0)
+          {}
+        close(file_descriptor);
+        if(is_stopping)
+          {
+            return;
+          }
+      }
+  }
+};
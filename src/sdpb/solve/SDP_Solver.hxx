@@ -12,12 +12,18 @@
 #include "Block_Vector.hxx"
 #include "SDP.hxx"
 #include "SDP_Solver_Terminate_Reason.hxx"
+#include "Checkpoint_Writer.hxx"
 
 #include "../SDP_Solver_Parameters.hxx"
 #include "../../Timers.hxx"
 
 #include <boost/filesystem.hpp>
 
+#include <memory>
+
+struct Step_Workspace;
+class Step_Controller;
+
 // SDPSolver contains the data structures needed during the running of
 // the interior point algorithm.  Each structure is allocated when an
 // SDPSolver is initialized, and reused in each iteration.
@@ -32,8 +38,10 @@ public:
   // sdp.psdMatrixBlockDims()
   Block_Diagonal_Matrix X;
 
-  // a Vector of length N = sdp.dualObjective.size()
-  Block_Vector y;
+  // a Vector of length N = sdp.dualObjective.size().  All of the
+  // blocks on a rank share one grid, so y is stored once, on that
+  // grid, like sdp.dual_objective_b.
+  El::DistMatrix<El::BigFloat> y;
 
   // a Block_Diagonal_Matrix with the same structure as X
   Block_Diagonal_Matrix Y;
@@ -74,11 +82,20 @@ public:
 
   int64_t current_generation;
   boost::optional<int64_t> backup_generation;
+
+  // The checkpoint being written, if any.  See save_checkpoint().
+  std::unique_ptr<Checkpoint_Writer> checkpoint_writer;
   
   SDP_Solver(const SDP_Solver_Parameters &parameters,
              const Block_Info &block_info, const El::Grid &grid,
              const size_t &dual_objective_b_height);
 
+  // Continue from the point of a solver that ran at a lower
+  // precision.  The SDP must be the same, read at the current
+  // precision.
+  SDP_Solver(const SDP_Solver &lower_precision, const Block_Info &block_info,
+             const El::Grid &grid, const size_t &dual_objective_b_height);
+
   SDP_Solver_Terminate_Reason
   run(const SDP_Solver_Parameters &parameters, const Block_Info &block_info,
       const SDP &sdp, const El::Grid &grid, Timers &timers);
@@ -90,21 +107,39 @@ public:
        const SDP &sdp, const El::Grid &grid,
        const Block_Diagonal_Matrix &X_cholesky,
        const Block_Diagonal_Matrix &Y_cholesky,
-       const Block_Diagonal_Matrix &bilinear_pairings_X_inv,
-       const Block_Diagonal_Matrix &bilinear_pairings_Y,
-       const Block_Vector &primal_residue_p, El::BigFloat &mu,
+       Block_Diagonal_Matrix &bilinear_pairings_X_inv,
+       Block_Diagonal_Matrix &bilinear_pairings_Y,
+       const El::DistMatrix<El::BigFloat> &primal_residue_p,
+       El::BigFloat &mu,
        El::BigFloat &beta_corrector, El::BigFloat &primal_step_length,
-       El::BigFloat &dual_step_length, bool &terminate_now, Timers &timers);
+       El::BigFloat &dual_step_length, Step_Workspace &workspace,
+       Step_Controller &step_controller, bool &terminate_now,
+       Timers &timers);
 
   void save_solution(const SDP_Solver_Terminate_Reason,
-                     const std::pair<std::string, Timer> &timer_pair,
+                     const Timer_Statistics &solver_timer,
                      const boost::filesystem::path &out_directory,
                      const Write_Solution &write_solution,
                      const std::vector<size_t> &block_indices,
                      const Verbosity &verbosity) const;
-  void save_checkpoint(const SDP_Solver_Parameters &parameters);
+  void save_checkpoint(const SDP_Solver_Parameters &parameters,
+                       const Block_Info &block_info, const bool &asynchronous);
+  void finish_checkpoint(const SDP_Solver_Parameters &parameters,
+                         const bool &wait);
   bool
   load_checkpoint(const boost::filesystem::path &checkpoint_directory,
                   const Block_Info &block_info, const Verbosity &verbosity,
+                  const size_t &num_threads,
                   const bool &require_initial_checkpoint);
+
+  // The checkpoints store a copy of y with each local block.  These
+  // are views of y, one for each local block, so that y can be read
+  // and written in the same way as x.
+  Block_Vector y_block_views();
+  Block_Vector y_block_views() const;
+
+private:
+  // Allocate x, X, y and Y without setting them.
+  SDP_Solver(const Block_Info &block_info, const El::Grid &grid,
+             const size_t &dual_objective_b_height);
 };
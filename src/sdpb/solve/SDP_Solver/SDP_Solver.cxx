@@ -1,36 +1,75 @@
 #include "../SDP_Solver.hxx"
 
-// Create and initialize an SDPSolver for the given SDP and
-// SDP_Solver_Parameters
-SDP_Solver::SDP_Solver(const SDP_Solver_Parameters &parameters,
-                       const Block_Info &block_info, const El::Grid &grid,
+void shift_to_interior(const El::BigFloat &shift, Block_Diagonal_Matrix &X);
+
+namespace
+{
+  void copy_elements(const El::DistMatrix<El::BigFloat> &from,
+                     El::DistMatrix<El::BigFloat> &to)
+  {
+    for(El::Int row = 0; row < from.LocalHeight(); ++row)
+      for(El::Int column = 0; column < from.LocalWidth(); ++column)
+        {
+          // Assigning to an element keeps its precision.
+          to.SetLocal(row, column, from.GetLocal(row, column));
+        }
+  }
+
+  template <typename T> void copy_elements(const T &from, T &to)
+  {
+    auto to_block(to.blocks.begin());
+    for(auto &block : from.blocks)
+      {
+        copy_elements(block, *to_block);
+        ++to_block;
+      }
+  }
+}
+
+SDP_Solver::SDP_Solver(const Block_Info &block_info, const El::Grid &grid,
                        const size_t &dual_objective_b_height)
     : x(block_info.schur_block_sizes, block_info.block_indices,
         block_info.schur_block_sizes.size(), grid),
       X(block_info.psd_matrix_block_sizes, block_info.block_indices,
         block_info.schur_block_sizes.size(), grid),
-      y(std::vector<size_t>(block_info.schur_block_sizes.size(),
-                            dual_objective_b_height),
-        block_info.block_indices, block_info.schur_block_sizes.size(), grid),
+      y(dual_objective_b_height, 1, grid),
       Y(X), primal_residues(X),
       dual_residues(block_info.schur_block_sizes, block_info.block_indices,
                     block_info.schur_block_sizes.size(), grid),
       current_generation(0)
+{}
+
+// Create and initialize an SDPSolver for the given SDP and
+// SDP_Solver_Parameters
+SDP_Solver::SDP_Solver(const SDP_Solver_Parameters &parameters,
+                       const Block_Info &block_info, const El::Grid &grid,
+                       const size_t &dual_objective_b_height)
+    : SDP_Solver(block_info, grid, dual_objective_b_height)
 {
   if(!load_checkpoint(parameters.checkpoint_in, block_info,
-                      parameters.verbosity,
+                      parameters.verbosity, parameters.threads_per_proc,
                       parameters.require_initial_checkpoint))
     {
+      if(!parameters.warm_start.empty())
+        {
+          load_checkpoint(parameters.warm_start, block_info,
+                          parameters.verbosity, parameters.threads_per_proc,
+                          true);
+          shift_to_interior(parameters.warm_start_shift, X);
+          shift_to_interior(parameters.warm_start_shift, Y);
+          // The generations belong to the other SDP's checkpoints.
+          current_generation = 0;
+          backup_generation = boost::none;
+          return;
+        }
+
       X.set_zero();
       Y.set_zero();
       for(auto &block : x.blocks)
         {
           Zero(block);
         }
-      for(auto &block : y.blocks)
-        {
-          Zero(block);
-        }
+      Zero(y);
 
       // X = \Omega_p I
       X.add_diagonal(parameters.initial_matrix_scale_primal);
@@ -38,3 +77,42 @@ SDP_Solver::SDP_Solver(const SDP_Solver_Parameters &parameters,
       Y.add_diagonal(parameters.initial_matrix_scale_dual);
     }
 }
+
+SDP_Solver::SDP_Solver(const SDP_Solver &lower_precision,
+                       const Block_Info &block_info, const El::Grid &grid,
+                       const size_t &dual_objective_b_height)
+    : SDP_Solver(block_info, grid, dual_objective_b_height)
+{
+  copy_elements(lower_precision.x, x);
+  copy_elements(lower_precision.X, X);
+  copy_elements(lower_precision.y, y);
+  copy_elements(lower_precision.Y, Y);
+  current_generation = lower_precision.current_generation;
+  backup_generation = lower_precision.backup_generation;
+}
+
+// The views are added after reserving, so that they are never copied.
+// Copying a view would copy the elements instead.
+Block_Vector SDP_Solver::y_block_views()
+{
+  Block_Vector result;
+  result.blocks.reserve(x.blocks.size());
+  for(size_t block = 0; block < x.blocks.size(); ++block)
+    {
+      result.blocks.emplace_back(y.Grid());
+      El::View(result.blocks.back(), y);
+    }
+  return result;
+}
+
+Block_Vector SDP_Solver::y_block_views() const
+{
+  Block_Vector result;
+  result.blocks.reserve(x.blocks.size());
+  for(size_t block = 0; block < x.blocks.size(); ++block)
+    {
+      result.blocks.emplace_back(y.Grid());
+      El::LockedView(result.blocks.back(), y);
+    }
+  return result;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+// Compression for per-rank checkpoints (compressCheckpoint).
+//
+// Elements are first written in the compact form of
+// compact_BigFloat.hxx, which drops the trailing zero limbs.  The
+// encoded bytes of each block are then compressed with a small LZ77
+// codec, which mostly removes the repeated sizes and exponents and any
+// repeated limbs.
+//
+// The compressed stream is a sequence of
+//
+//   varint literal_length; literal bytes;
+//   varint (match_length - min_match); varint match_offset;
+//
+// where the last sequence has only the literals.
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace checkpoint_compression
+{
+  const size_t min_match(4), hash_bits(16);
+
+  inline void write_varint(uint64_t value, std::vector<char> &output)
+  {
+    while(value >= 0x80)
+      {
+        output.push_back(char((value & 0x7f) | 0x80));
+        value >>= 7;
+      }
+    output.push_back(char(value));
+  }
+
+  inline uint64_t read_varint(const char *&input, const char *end)
+  {
+    uint64_t result(0);
+    for(size_t shift = 0; shift < 64; shift += 7)
+      {
+        if(input == end)
+          {
+            break;
+          }
+        const uint8_t byte(*input++);
+        result |= uint64_t(byte & 0x7f) << shift;
+        if((byte & 0x80) == 0)
+          {
+            return result;
+          }
+      }
+    throw std::runtime_error("Corrupted compressed checkpoint data");
+  }
+
+  inline void
+  compress(const char *input, const size_t &size, std::vector<char> &output)
+  {
+    std::vector<int64_t> table(size_t(1) << hash_bits, -1);
+    auto hash = [&](const size_t &position) {
+      uint32_t value;
+      std::memcpy(&value, input + position, sizeof(value));
+      return (value * 2654435761u) >> (32 - hash_bits);
+    };
+
+    size_t position(0), anchor(0);
+    while(position + min_match <= size)
+      {
+        const uint32_t h(hash(position));
+        const int64_t candidate(table[h]);
+        table[h] = position;
+        if(candidate < 0
+           || std::memcmp(input + candidate, input + position, min_match) != 0)
+          {
+            ++position;
+            continue;
+          }
+        size_t length(min_match);
+        while(position + length < size
+              && input[candidate + length] == input[position + length])
+          {
+            ++length;
+          }
+        write_varint(position - anchor, output);
+        output.insert(output.end(), input + anchor, input + position);
+        write_varint(length - min_match, output);
+        write_varint(position - candidate, output);
+        position += length;
+        anchor = position;
+      }
+    write_varint(size - anchor, output);
+    output.insert(output.end(), input + anchor, input + size);
+  }
+
+  inline void decompress(const char *input, const size_t &size,
+                         std::vector<char> &output)
+  {
+    const char *end(input + size);
+    while(true)
+      {
+        const uint64_t literal_length(read_varint(input, end));
+        if(literal_length > uint64_t(end - input))
+          {
+            throw std::runtime_error("Corrupted compressed checkpoint data");
+          }
+        output.insert(output.end(), input, input + literal_length);
+        input += literal_length;
+        if(input == end)
+          {
+            break;
+          }
+        const uint64_t length(read_varint(input, end) + min_match),
+          offset(read_varint(input, end));
+        if(offset == 0 || offset > output.size())
+          {
+            throw std::runtime_error("Corrupted compressed checkpoint data");
+          }
+        // The match may overlap the bytes that it produces, so copy
+        // one byte at a time.
+        const size_t source(output.size() - offset);
+        for(uint64_t index = 0; index < length; ++index)
+          {
+            const char byte(output[source + index]);
+            output.push_back(byte);
+          }
+      }
+  }
+}
@@ -0,0 +1,93 @@
+#include "../SDP_Solver.hxx"
+#include "../../solver_comm.hxx"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+// Point checkpoint.json at current_generation.  Collective.
+void write_checkpoint_metadata(const SDP_Solver_Parameters &parameters,
+                               const int64_t &current_generation,
+                               const int64_t &backup_generation)
+{
+  const boost::filesystem::path &checkpoint_directory(
+    parameters.checkpoint_out);
+  if(El::mpi::Rank(solver_comm()) == 0)
+    {
+      boost::filesystem::ofstream metadata(checkpoint_directory
+                                           / "checkpoint_new.json");
+      metadata << "{\n    \"current\": " << current_generation << ",\n"
+               << "    \"backup\": " << backup_generation << ",\n"
+               << "    \"version\": \"" << SDPB_VERSION_STRING << "\",\n";
+      if(parameters.single_file_checkpoint)
+        {
+          metadata << "    \"format\": \"single_file\",\n";
+        }
+      else
+        {
+          metadata << "    \"num_procs\": " << El::mpi::Size(solver_comm())
+                   << ",\n";
+        }
+      metadata << "    \"options\": \n";
+
+      boost::property_tree::write_json(metadata, to_property_tree(parameters));
+      metadata << "}\n";
+    }
+  El::mpi::Barrier(solver_comm());
+  if(El::mpi::Rank(solver_comm()) == 0)
+    {
+      rename(checkpoint_directory / "checkpoint_new.json",
+             checkpoint_directory / "checkpoint.json");
+    }
+}
+
+// Finalize the checkpoint started by save_checkpoint(): once every
+// rank has written and synced its file, point checkpoint.json at the
+// new generation.  Until then, checkpoint.json still points at the
+// previous generation, which is kept on disk.
+//
+// This is collective.  With wait == false, it returns immediately
+// unless every rank's write has finished, so the solver can call it
+// every iteration without stalling.
+
+void SDP_Solver::finish_checkpoint(const SDP_Solver_Parameters &parameters,
+                                   const bool &wait)
+{
+  if(!checkpoint_writer)
+    {
+      return;
+    }
+  if(!wait)
+    {
+      const int local_done(checkpoint_writer->done ? 1 : 0);
+      if(El::mpi::AllReduce(local_done, El::mpi::MIN, solver_comm())
+         == 0)
+        {
+          return;
+        }
+    }
+  checkpoint_writer->join();
+  const int local_succeeded(checkpoint_writer->succeeded ? 1 : 0);
+  const boost::filesystem::path checkpoint_filename(
+    checkpoint_writer->filename);
+  checkpoint_writer.reset();
+  if(El::mpi::AllReduce(local_succeeded, El::mpi::MIN, solver_comm())
+     == 0)
+    {
+      std::stringstream ss;
+      if(local_succeeded == 0)
+        {
+          ss << "Error writing checkpoint file '" << checkpoint_filename
+             << "'.  Exceeded max retries.\n";
+        }
+      else
+        {
+          ss << "Another rank failed to write its checkpoint file in '"
+             << parameters.checkpoint_out << "'.\n";
+        }
+      throw std::runtime_error(ss.str());
+    }
+
+  write_checkpoint_metadata(parameters, current_generation,
+                            backup_generation.value());
+}
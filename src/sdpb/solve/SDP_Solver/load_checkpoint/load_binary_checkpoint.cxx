@@ -1,16 +1,26 @@
 #include "../../SDP_Solver.hxx"
+#include "../../serialize_local.hxx"
+#include "../../../solver_comm.hxx"
 
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
+void read_single_file_checkpoint(const boost::filesystem::path &filename,
+                                 const Block_Info &block_info,
+                                 SDP_Solver &solver);
+void read_redistributed_checkpoint(
+  const boost::filesystem::path &checkpoint_directory,
+  const int64_t &generation, const int64_t &num_procs,
+  const Block_Info &block_info, SDP_Solver &solver);
+
 template <typename T>
 void read_local_binary_blocks(T &t,
                               boost::filesystem::ifstream &checkpoint_stream)
 {
   El::BigFloat zero(0);
   const size_t serialized_size(zero.SerializedSize());
-  std::vector<uint8_t> local_array(serialized_size);
+  std::vector<El::byte> local_array;
 
   for(auto &block : t.blocks)
     {
@@ -43,35 +53,33 @@ void read_local_binary_blocks(T &t,
           throw std::runtime_error(ss.str());
         }
 
-      for(int64_t row = 0; row < local_height; ++row)
-        for(int64_t column = 0; column < local_width; ++column)
-          {
-            El::BigFloat input;
-            checkpoint_stream.read(
-              reinterpret_cast<char *>(local_array.data()),
-              std::streamsize(local_array.size()));
-            if(!checkpoint_stream.good())
-              {
-                std::stringstream ss;
-                ss << "Corrupted binary checkpoint file.  For block with "
-                   << "global size (" << block.Height() << "," << block.Width()
-                   << ") and local dimensions (" << block.LocalHeight() << ","
-                   << block.LocalWidth() << "), error when reading element ("
-                   << row << "," << column << ")";
-                throw std::runtime_error(ss.str());
-              }
-            input.Deserialize(local_array.data());
-
-            block.SetLocal(row, column, input);
-          }
+      // The whole local block at once
+      local_array.resize(local_height * local_width * serialized_size);
+      checkpoint_stream.read(reinterpret_cast<char *>(local_array.data()),
+                             std::streamsize(local_array.size()));
+      if(!checkpoint_stream.good())
+        {
+          std::stringstream ss;
+          ss << "Corrupted binary checkpoint file.  For block with "
+             << "global size (" << block.Height() << "," << block.Width()
+             << ") and local dimensions (" << block.LocalHeight() << ","
+             << block.LocalWidth() << "), error when reading the elements";
+          throw std::runtime_error(ss.str());
+        }
+      deserialize_local(local_array.data(), serialized_size, block.Matrix());
     }
 }
 
 bool load_binary_checkpoint(const boost::filesystem::path &checkpoint_directory,
+                            const Block_Info &block_info,
                             const Verbosity &verbosity, SDP_Solver &solver)
 {
-  int64_t current_generation(-1), backup_generation(-1);
-  if(El::mpi::Rank() == 0)
+  // num_procs is only written for per-rank checkpoints that record
+  // the global positions of their blocks.  Older checkpoints must be
+  // read back with the same layout.
+  int64_t current_generation(-1), backup_generation(-1), num_procs(-1);
+  El::byte is_single_file(0);
+  if(El::mpi::Rank(solver_comm()) == 0)
     {
       boost::filesystem::path metadata(checkpoint_directory
                                        / "checkpoint.json");
@@ -97,6 +105,15 @@ bool load_binary_checkpoint(const boost::filesystem::path &checkpoint_directory,
             {
               backup_generation = backup.value();
             }
+          boost::optional<std::string> format(
+            tree.get_optional<std::string>("format"));
+          is_single_file = (format && format.value() == "single_file");
+          boost::optional<int64_t> procs(
+            tree.get_optional<int64_t>("num_procs"));
+          if(procs)
+            {
+              num_procs = procs.value();
+            }
         }
     }
 
@@ -105,15 +122,66 @@ bool load_binary_checkpoint(const boost::filesystem::path &checkpoint_directory,
   // the Broadcast() with int32_t instead of int64_t?
   El::mpi::Broadcast(reinterpret_cast<El::byte *>(&current_generation),
                      sizeof(current_generation) / sizeof(El::byte), 0,
-                     El::mpi::COMM_WORLD);
+                     solver_comm());
+  El::mpi::Broadcast(reinterpret_cast<El::byte *>(&num_procs),
+                     sizeof(num_procs) / sizeof(El::byte), 0,
+                     solver_comm());
+  El::mpi::Broadcast(is_single_file, 0, solver_comm());
   boost::filesystem::path checkpoint_filename;
-  if(current_generation != -1)
+  if(current_generation != -1 && is_single_file)
+    {
+      checkpoint_filename
+        = checkpoint_directory
+          / ("checkpoint_" + std::to_string(current_generation) + ".bin");
+      if(!exists(checkpoint_filename))
+        {
+          throw std::runtime_error("Missing checkpoint file: "
+                                   + checkpoint_filename.string());
+        }
+      // See note above about Broadcast()
+      El::mpi::Broadcast(reinterpret_cast<El::byte *>(&backup_generation),
+                         sizeof(current_generation) / sizeof(El::byte), 0,
+                         solver_comm());
+      if(verbosity >= Verbosity::regular && El::mpi::Rank(solver_comm()) == 0)
+        {
+          std::cout << "Loading binary checkpoint from : "
+                    << checkpoint_directory << '\n';
+        }
+      read_single_file_checkpoint(checkpoint_filename, block_info, solver);
+      solver.current_generation = current_generation;
+      if(backup_generation != -1)
+        {
+          solver.backup_generation = backup_generation;
+        }
+      return true;
+    }
+  else if(current_generation != -1 && num_procs != -1)
+    {
+      // See note above about Broadcast()
+      El::mpi::Broadcast(reinterpret_cast<El::byte *>(&backup_generation),
+                         sizeof(current_generation) / sizeof(El::byte), 0,
+                         solver_comm());
+      if(verbosity >= Verbosity::regular && El::mpi::Rank(solver_comm()) == 0)
+        {
+          std::cout << "Loading binary checkpoint from : "
+                    << checkpoint_directory << '\n';
+        }
+      read_redistributed_checkpoint(checkpoint_directory, current_generation,
+                                    num_procs, block_info, solver);
+      solver.current_generation = current_generation;
+      if(backup_generation != -1)
+        {
+          solver.backup_generation = backup_generation;
+        }
+      return true;
+    }
+  else if(current_generation != -1)
     {
       solver.current_generation = current_generation;
       checkpoint_filename
         = checkpoint_directory
           / ("checkpoint_" + std::to_string(current_generation) + "_"
-             + std::to_string(El::mpi::Rank()));
+             + std::to_string(El::mpi::Rank(solver_comm())));
       if(!exists(checkpoint_filename))
         {
           throw std::runtime_error("Missing checkpoint file: "
@@ -122,13 +190,13 @@ bool load_binary_checkpoint(const boost::filesystem::path &checkpoint_directory,
       // See note above about Broadcast()
       El::mpi::Broadcast(reinterpret_cast<El::byte *>(&backup_generation),
                          sizeof(current_generation) / sizeof(El::byte), 0,
-                         El::mpi::COMM_WORLD);
+                         solver_comm());
     }
   else
     {
       checkpoint_filename
         = checkpoint_directory
-          / ("checkpoint." + std::to_string(El::mpi::Rank()));
+          / ("checkpoint." + std::to_string(El::mpi::Rank(solver_comm())));
       if(!exists(checkpoint_filename))
         {
           return false;
@@ -137,14 +205,15 @@ bool load_binary_checkpoint(const boost::filesystem::path &checkpoint_directory,
     }
 
   boost::filesystem::ifstream checkpoint_stream(checkpoint_filename);
-  if(verbosity >= Verbosity::regular && El::mpi::Rank() == 0)
+  if(verbosity >= Verbosity::regular && El::mpi::Rank(solver_comm()) == 0)
     {
       std::cout << "Loading binary checkpoint from : " << checkpoint_directory
                 << '\n';
     }
   read_local_binary_blocks(solver.x, checkpoint_stream);
   read_local_binary_blocks(solver.X, checkpoint_stream);
-  read_local_binary_blocks(solver.y, checkpoint_stream);
+  Block_Vector y_views(solver.y_block_views());
+  read_local_binary_blocks(y_views, checkpoint_stream);
   read_local_binary_blocks(solver.Y, checkpoint_stream);
   solver.current_generation = current_generation;
   if(backup_generation != -1)
@@ -1,21 +1,24 @@
 #include "../../SDP_Solver.hxx"
 
 bool load_binary_checkpoint(const boost::filesystem::path &checkpoint_directory,
+                            const Block_Info &block_info,
                             const Verbosity &verbosity, SDP_Solver &solver);
 
 bool load_text_checkpoint(const boost::filesystem::path &checkpoint_directory,
                           const std::vector<size_t> &block_indices,
-                          const Verbosity &verbosity, SDP_Solver &solver);
+                          const Verbosity &verbosity,
+                          const size_t &num_threads, SDP_Solver &solver);
 
 bool SDP_Solver::load_checkpoint(
   const boost::filesystem::path &checkpoint_directory,
   const Block_Info &block_info, const Verbosity &verbosity,
-  const bool &require_initial_checkpoint)
+  const size_t &num_threads, const bool &require_initial_checkpoint)
 {
   bool valid_checkpoint(
-    load_binary_checkpoint(checkpoint_directory, verbosity, *this)
+    load_binary_checkpoint(checkpoint_directory, block_info, verbosity,
+                           *this)
     || load_text_checkpoint(checkpoint_directory, block_info.block_indices,
-                            verbosity, *this));
+                            verbosity, num_threads, *this));
   if(!valid_checkpoint && require_initial_checkpoint)
     {
       throw std::runtime_error("Unable to load checkpoint from directory: "
@@ -1,82 +1,156 @@
 #include "../../SDP_Solver.hxx"
+#include "../../../Mapped_File.hxx"
+#include "../../../../parallel_for.hxx"
+#include "../../../solver_comm.hxx"
 
 #include <boost/filesystem.hpp>
-#include <boost/filesystem/fstream.hpp>
 
-void read_text_block(El::DistMatrix<El::BigFloat> &block,
-                     const boost::filesystem::path &block_path)
+#include <cctype>
+
+// Text checkpoints are the fallback for layouts and versions that
+// the binary checkpoints can not be read with, so they can be large.
+// Only the root of each block's grid maps the file, and
+// threadsPerProc threads convert the numbers.  The elements are then
+// scattered to their owners with one El::Copy() per block.
+//
+// Errors on the root are broadcast, so that every rank in the grid
+// throws instead of waiting forever for the scatter.
+
+namespace
 {
-  boost::filesystem::ifstream block_stream(block_path);
-  if(!block_stream)
-    {
-      throw std::runtime_error("Unable to open checkpoint file: '"
-                               + block_path.string() + "'");
-    }
-  int64_t file_height, file_width;
-  block_stream >> file_height >> file_width;
-  if(!block_stream.good())
-    {
-      throw std::runtime_error("Corrupted header in file: "
-                               + block_path.string());
-    }
-  if(file_height != block.Height() || file_width != block.Width())
-    {
-      std::stringstream ss;
-      ss << "Incompatible checkpoint file: '" << block_path.string()
-         << "'.  Expected dimensions (" << block.Height() << ","
-         << block.Width() << "), but found (" << file_height << ","
-         << file_width << ")";
-      throw std::runtime_error(ss.str());
-    }
+  struct Token
+  {
+    const char *begin;
+    size_t size;
+  };
 
-  std::string element;
-  for(int64_t row = 0; row < file_height; ++row)
-    for(int64_t column = 0; column < file_width; ++column)
+  std::vector<Token> tokenize(const Mapped_File &mapped)
+  {
+    std::vector<Token> result;
+    const char *end(mapped.data + mapped.size);
+    for(const char *c(mapped.data); c != end;)
       {
-        block_stream >> element;
-        if(block.IsLocal(row, column))
+        if(std::isspace(static_cast<unsigned char>(*c)))
+          {
+            ++c;
+            continue;
+          }
+        const char *begin(c);
+        while(c != end && !std::isspace(static_cast<unsigned char>(*c)))
           {
-            block.SetLocal(block.LocalRow(row), block.LocalCol(column),
-                           El::BigFloat(element));
+            ++c;
           }
+        result.push_back({begin, size_t(c - begin)});
       }
-  if(!block_stream.good())
+    return result;
+  }
+}
+
+void read_text_block(El::DistMatrix<El::BigFloat> &block,
+                     const boost::filesystem::path &block_path,
+                     const size_t &num_threads)
+{
+  El::DistMatrix<El::BigFloat, El::CIRC, El::CIRC> root_block(block.Grid());
+  const bool is_root(root_block.CrossRank() == root_block.Root());
+
+  El::byte is_ok(1);
+  std::string error_message("Error reading '" + block_path.string() + "'");
+  if(is_root)
+    {
+      try
+        {
+          const Mapped_File mapped(block_path);
+          const std::vector<Token> tokens(tokenize(mapped));
+          if(tokens.size() < 2)
+            {
+              throw std::runtime_error("Corrupted header in file: "
+                                       + block_path.string());
+            }
+          const int64_t file_height(
+            std::stoll(std::string(tokens[0].begin, tokens[0].size))),
+            file_width(
+              std::stoll(std::string(tokens[1].begin, tokens[1].size)));
+          if(file_height != block.Height() || file_width != block.Width())
+            {
+              std::stringstream ss;
+              ss << "Incompatible checkpoint file: '" << block_path.string()
+                 << "'.  Expected dimensions (" << block.Height() << ","
+                 << block.Width() << "), but found (" << file_height << ","
+                 << file_width << ")";
+              throw std::runtime_error(ss.str());
+            }
+          if(tokens.size() < size_t(2 + file_height * file_width))
+            {
+              throw std::runtime_error("Corrupted data in file: "
+                                       + block_path.string());
+            }
+          root_block.Resize(file_height, file_width);
+          El::Matrix<El::BigFloat> &local(root_block.Matrix());
+          parallel_for(num_threads, file_height, [&](const size_t &row) {
+            // set_str() needs a terminated string.
+            std::string element;
+            for(int64_t column = 0; column < file_width; ++column)
+              {
+                const Token &token(tokens[2 + row * file_width + column]);
+                element.assign(token.begin, token.size);
+                if(local(row, column).gmp_float.set_str(element, 10) != 0)
+                  {
+                    throw std::runtime_error("Corrupted data in file: "
+                                             + block_path.string() + ": '"
+                                             + element + "'");
+                  }
+              }
+          });
+        }
+      catch(std::exception &e)
+        {
+          is_ok = 0;
+          error_message = e.what();
+        }
+    }
+
+  El::mpi::Broadcast(is_ok, root_block.Root(), root_block.CrossComm());
+  if(is_ok == 0)
     {
-      throw std::runtime_error("Corrupted data in file: "
-                               + block_path.string());
+      throw std::runtime_error(error_message);
     }
+  root_block.Resize(block.Height(), block.Width());
+  El::Copy(root_block, block);
 }
 
 void read_text_block(El::DistMatrix<El::BigFloat> &block,
                      const boost::filesystem::path &checkpoint_directory,
-                     const std::string &prefix, const size_t &block_index)
+                     const std::string &prefix, const size_t &block_index,
+                     const size_t &num_threads)
 {
-  read_text_block(block, checkpoint_directory
-                           / (prefix + std::to_string(block_index) + ".txt"));
+  read_text_block(block,
+                  checkpoint_directory
+                    / (prefix + std::to_string(block_index) + ".txt"),
+                  num_threads);
 }
 
 bool load_text_checkpoint(const boost::filesystem::path &checkpoint_directory,
                           const std::vector<size_t> &block_indices,
-                          const Verbosity &verbosity, SDP_Solver &solver)
+                          const Verbosity &verbosity,
+                          const size_t &num_threads, SDP_Solver &solver)
 {
   if(!exists(checkpoint_directory / "x_0.txt"))
     {
       return false;
     }
 
-  if(verbosity >= Verbosity::regular && El::mpi::Rank() == 0)
+  if(verbosity >= Verbosity::regular && El::mpi::Rank(solver_comm()) == 0)
     {
       std::cout << "Loading text checkpoint from : " << checkpoint_directory
                 << '\n';
     }
 
+  read_text_block(solver.y, checkpoint_directory / "y.txt", num_threads);
   for(size_t block = 0; block != block_indices.size(); ++block)
     {
       size_t block_index(block_indices.at(block));
       read_text_block(solver.x.blocks.at(block), checkpoint_directory, "x_",
-                      block_index);
-      read_text_block(solver.y.blocks.at(block),
-                      checkpoint_directory / "y.txt");
+                      block_index, num_threads);
 
       for(size_t psd_block(0); psd_block < 2; ++psd_block)
         {
@@ -86,9 +160,11 @@ bool load_text_checkpoint(const boost::filesystem::path &checkpoint_directory,
             {
               const size_t psd_index(2 * block_index + psd_block);
               read_text_block(solver.X.blocks.at(2 * block + psd_block),
-                              checkpoint_directory, "X_matrix_", psd_index);
+                              checkpoint_directory, "X_matrix_", psd_index,
+                              num_threads);
               read_text_block(solver.Y.blocks.at(2 * block + psd_block),
-                              checkpoint_directory, "Y_matrix_", psd_index);
+                              checkpoint_directory, "Y_matrix_", psd_index,
+                              num_threads);
             }
         }
     }
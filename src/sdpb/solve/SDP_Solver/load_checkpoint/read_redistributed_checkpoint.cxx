@@ -0,0 +1,325 @@
+#include "../checkpoint_compression.hxx"
+#include "../../compact_BigFloat.hxx"
+#include "../../SDP_Solver.hxx"
+#include "../../../solver_comm.hxx"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include <sstream>
+
+// Load a per-rank binary checkpoint that may have been written by a
+// different number of processes, or with a different block mapping.
+//
+// Every file lists the global indices of its blocks, and every block
+// records its shifts and strides in the grid that wrote it.  Rank 0
+// reads the block lists from all of the files and broadcasts them.
+// Each rank then opens only the files that hold parts of its blocks,
+// and keeps the elements that it owns under the current mapping.
+// Rows that it does not own are skipped without being read.
+//
+// Compressed files (compressCheckpoint) have the same layout, except
+// that the elements of each block are compressed.  Blocks that are
+// needed are decompressed in full, and the rest are skipped.
+
+namespace
+{
+  struct Checkpoint_File
+  {
+    bool is_compressed;
+    std::vector<size_t> blocks;
+  };
+
+  boost::filesystem::path
+  checkpoint_filename(const boost::filesystem::path &checkpoint_directory,
+                      const int64_t &generation, const int64_t &file_rank)
+  {
+    return checkpoint_directory
+           / ("checkpoint_" + std::to_string(generation) + "_"
+              + std::to_string(file_rank));
+  }
+
+  std::vector<Checkpoint_File>
+  read_file_blocks(const boost::filesystem::path &checkpoint_directory,
+                   const int64_t &generation, const int64_t &num_procs)
+  {
+    // For each file, whether it is compressed, the number of blocks,
+    // and their indices.
+    std::vector<int64_t> flat;
+    std::string error_message("Error reading checkpoint files in '"
+                              + checkpoint_directory.string() + "'");
+    if(El::mpi::Rank(solver_comm()) == 0)
+      {
+        try
+          {
+            for(int64_t file_rank = 0; file_rank < num_procs; ++file_rank)
+              {
+                const boost::filesystem::path filename(checkpoint_filename(
+                  checkpoint_directory, generation, file_rank));
+                boost::filesystem::ifstream stream(filename,
+                                                   std::ios::binary);
+                if(!stream.good())
+                  {
+                    throw std::runtime_error("Missing checkpoint file: "
+                                             + filename.string());
+                  }
+                char magic[sizeof(per_rank_checkpoint_magic)];
+                int64_t num_blocks;
+                stream.read(magic, sizeof(magic));
+                stream.read(reinterpret_cast<char *>(&num_blocks),
+                            sizeof(num_blocks));
+                const bool is_compressed(
+                  std::memcmp(magic, per_rank_compressed_checkpoint_magic,
+                              sizeof(magic))
+                  == 0);
+                if(!stream.good()
+                   || (!is_compressed
+                       && std::memcmp(magic, per_rank_checkpoint_magic,
+                                      sizeof(magic))
+                            != 0)
+                   || num_blocks < 0)
+                  {
+                    throw std::runtime_error(
+                      "Corrupted binary checkpoint file: "
+                      + filename.string());
+                  }
+                flat.push_back(is_compressed ? 1 : 0);
+                flat.push_back(num_blocks);
+                flat.resize(flat.size() + num_blocks);
+                stream.read(
+                  reinterpret_cast<char *>(flat.data() + flat.size()
+                                           - num_blocks),
+                  num_blocks * sizeof(int64_t));
+                if(!stream.good())
+                  {
+                    throw std::runtime_error(
+                      "Corrupted binary checkpoint file: "
+                      + filename.string());
+                  }
+              }
+          }
+        catch(std::exception &e)
+          {
+            flat.clear();
+            error_message = e.what();
+          }
+      }
+
+    // See the note in load_binary_checkpoint about Broadcast() and
+    // int64_t.
+    int64_t flat_size(flat.size());
+    El::mpi::Broadcast(reinterpret_cast<El::byte *>(&flat_size),
+                       sizeof(flat_size) / sizeof(El::byte), 0,
+                       solver_comm());
+    if(flat_size == 0)
+      {
+        throw std::runtime_error(error_message);
+      }
+    flat.resize(flat_size);
+    El::mpi::Broadcast(reinterpret_cast<El::byte *>(flat.data()),
+                       flat_size * sizeof(int64_t) / sizeof(El::byte), 0,
+                       solver_comm());
+
+    std::vector<Checkpoint_File> result;
+    for(auto current(flat.begin()); current != flat.end();)
+      {
+        const bool is_compressed(*current != 0);
+        const int64_t num_blocks(*(current + 1));
+        current += 2;
+        result.push_back(
+          {is_compressed, std::vector<size_t>(current, current + num_blocks)});
+        current += num_blocks;
+      }
+    return result;
+  }
+}
+
+void read_redistributed_checkpoint(
+  const boost::filesystem::path &checkpoint_directory,
+  const int64_t &generation, const int64_t &num_procs,
+  const Block_Info &block_info, SDP_Solver &solver)
+{
+  const std::vector<Checkpoint_File> files(
+    read_file_blocks(checkpoint_directory, generation, num_procs));
+
+  std::map<size_t, size_t> local_positions;
+  for(size_t block = 0; block < block_info.block_indices.size(); ++block)
+    {
+      local_positions.emplace(block_info.block_indices[block], block);
+    }
+
+  // The order in which save_checkpoint writes the matrices, and the
+  // number of blocks that each has per block index.
+  Block_Vector y_views(solver.y_block_views());
+  const std::array<std::vector<El::DistMatrix<El::BigFloat>> *, 4> matrices(
+    {{&solver.x.blocks, &solver.X.blocks, &y_views.blocks,
+      &solver.Y.blocks}});
+  const std::array<size_t, 4> blocks_per_index({{1, 2, 1, 2}});
+
+  size_t num_local_elements(0), num_read_elements(0);
+  for(auto &matrix : matrices)
+    for(auto &block : *matrix)
+      {
+        num_local_elements += block.LocalHeight() * block.LocalWidth();
+      }
+
+  const size_t serialized_size(El::BigFloat(0).SerializedSize());
+  std::vector<char> row_buffer, compressed, decompressed;
+  El::BigFloat input;
+  for(size_t file_rank = 0; file_rank < files.size(); ++file_rank)
+    {
+      const std::vector<size_t> &blocks(files[file_rank].blocks);
+      const bool &is_compressed(files[file_rank].is_compressed);
+      if(std::none_of(blocks.begin(), blocks.end(), [&](const size_t &b) {
+           return local_positions.find(b) != local_positions.end();
+         }))
+        {
+          continue;
+        }
+
+      const boost::filesystem::path filename(
+        checkpoint_filename(checkpoint_directory, generation, file_rank));
+      boost::filesystem::ifstream stream(filename, std::ios::binary);
+      stream.seekg(sizeof(per_rank_checkpoint_magic)
+                   + (blocks.size() + 1) * sizeof(int64_t));
+      for(size_t matrix = 0; matrix < matrices.size(); ++matrix)
+        for(size_t file_block = 0;
+            file_block < blocks_per_index[matrix] * blocks.size();
+            ++file_block)
+          {
+            // local_height, local_width, col_shift, row_shift,
+            // col_stride, row_stride
+            std::array<int64_t, 6> header;
+            stream.read(reinterpret_cast<char *>(header.data()),
+                        sizeof(header));
+            if(!stream.good())
+              {
+                throw std::runtime_error("Corrupted binary checkpoint file: "
+                                         + filename.string());
+              }
+            const int64_t local_height(header[0]), local_width(header[1]);
+            const size_t row_size(local_width * serialized_size);
+            // decompressed size, compressed size
+            std::array<uint64_t, 2> sizes({{0, local_height * row_size}});
+            if(is_compressed)
+              {
+                stream.read(reinterpret_cast<char *>(sizes.data()),
+                            sizeof(sizes));
+                if(!stream.good())
+                  {
+                    throw std::runtime_error(
+                      "Corrupted binary checkpoint file: "
+                      + filename.string());
+                  }
+              }
+
+            auto position(local_positions.find(
+              blocks[file_block / blocks_per_index[matrix]]));
+            if(position == local_positions.end())
+              {
+                stream.seekg(sizes[1], std::ios::cur);
+                continue;
+              }
+            El::DistMatrix<El::BigFloat> &block(
+              matrices[matrix]->at(blocks_per_index[matrix] * position->second
+                                   + file_block % blocks_per_index[matrix]));
+            if(header[2] + (local_height - 1) * header[4] >= block.Height()
+               || header[3] + (local_width - 1) * header[5] >= block.Width())
+              {
+                std::stringstream ss;
+                ss << "Incompatible binary checkpoint file: " << filename
+                   << ".  A block of global size (" << block.Height() << ","
+                   << block.Width() << ") has local size (" << local_height
+                   << "," << local_width << ") in the checkpoint.";
+                throw std::runtime_error(ss.str());
+              }
+
+            if(is_compressed)
+              {
+                compressed.resize(sizes[1]);
+                stream.read(compressed.data(), compressed.size());
+                decompressed.clear();
+                decompressed.reserve(sizes[0]);
+                if(stream.good())
+                  {
+                    checkpoint_compression::decompress(
+                      compressed.data(), compressed.size(), decompressed);
+                  }
+                if(!stream.good() || decompressed.size() != sizes[0])
+                  {
+                    throw std::runtime_error(
+                      "Corrupted binary checkpoint file: "
+                      + filename.string());
+                  }
+                const El::byte *current(
+                  reinterpret_cast<const El::byte *>(decompressed.data())),
+                  *end(current + decompressed.size());
+                for(int64_t row = 0; row < local_height; ++row)
+                  for(int64_t column = 0; column < local_width; ++column)
+                    {
+                      read_compact(current, end,
+                                   input.gmp_float.get_mpf_t());
+                      const int64_t global_row(header[2] + row * header[4]),
+                        global_column(header[3] + column * header[5]);
+                      if(block.IsLocal(global_row, global_column))
+                        {
+                          block.SetLocal(block.LocalRow(global_row),
+                                         block.LocalCol(global_column),
+                                         input);
+                          ++num_read_elements;
+                        }
+                    }
+                continue;
+              }
+
+            row_buffer.resize(row_size);
+            for(int64_t row = 0; row < local_height; ++row)
+              {
+                const int64_t global_row(header[2] + row * header[4]);
+                if(!block.IsLocalRow(global_row))
+                  {
+                    stream.seekg(row_size, std::ios::cur);
+                    continue;
+                  }
+                stream.read(row_buffer.data(), row_size);
+                if(!stream.good())
+                  {
+                    throw std::runtime_error(
+                      "Corrupted binary checkpoint file: "
+                      + filename.string());
+                  }
+                const int64_t local_row(block.LocalRow(global_row));
+                for(int64_t column = 0; column < local_width; ++column)
+                  {
+                    const int64_t global_column(header[3]
+                                                + column * header[5]);
+                    if(block.IsLocalCol(global_column))
+                      {
+                        input.Deserialize(reinterpret_cast<El::byte *>(
+                          row_buffer.data() + column * serialized_size));
+                        block.SetLocal(local_row,
+                                       block.LocalCol(global_column), input);
+                        ++num_read_elements;
+                      }
+                  }
+              }
+          }
+      if(!stream.good())
+        {
+          throw std::runtime_error("Corrupted binary checkpoint file: "
+                                   + filename.string());
+        }
+    }
+  if(num_read_elements != num_local_elements)
+    {
+      throw std::runtime_error(
+        "Incomplete binary checkpoint in '" + checkpoint_directory.string()
+        + "'.  Expected " + std::to_string(num_local_elements)
+        + " elements on rank " + std::to_string(El::mpi::Rank(solver_comm()))
+        + ", but found " + std::to_string(num_read_elements));
+    }
+}
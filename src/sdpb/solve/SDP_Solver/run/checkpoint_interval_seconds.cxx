@@ -0,0 +1,31 @@
+#include "../../../SDP_Solver_Parameters.hxx"
+
+#include <algorithm>
+#include <cmath>
+
+// The time between checkpoints.  With meanTimeBetweenFailures M, this
+// is Daly's first order approximation of the interval that minimizes
+// the expected time lost to checkpoints and failures,
+//
+//   sqrt(2 C M) - C   if C < M / 2
+//   M                 otherwise,
+//
+// where C is the time that the last checkpoint kept the solver from
+// working.  checkpointInterval is the upper bound, and is also used
+// while no checkpoint has been measured yet.
+
+double checkpoint_interval_seconds(const SDP_Solver_Parameters &parameters,
+                                   const double &checkpoint_seconds)
+{
+  const double upper_bound(parameters.checkpoint_interval);
+  const double &mtbf(parameters.mean_time_between_failures);
+  if(mtbf <= 0 || checkpoint_seconds <= 0)
+    {
+      return upper_bound;
+    }
+  const double optimal(checkpoint_seconds < mtbf / 2
+                         ? std::sqrt(2 * checkpoint_seconds * mtbf)
+                             - checkpoint_seconds
+                         : mtbf);
+  return std::min(optimal, upper_bound);
+}
@@ -1,4 +1,5 @@
 #include "../../Block_Diagonal_Matrix.hxx"
+#include "../../block_kernels.hxx"
 
 // Compute L (lower triangular) such that A = L L^T
 void cholesky_decomposition(const Block_Diagonal_Matrix &A,
@@ -8,6 +9,6 @@ void cholesky_decomposition(const Block_Diagonal_Matrix &A,
     {
       // FIXME: Use pivoting?
       L.blocks[b] = A.blocks[b];
-      Cholesky(El::UpperOrLowerNS::LOWER, L.blocks[b]);
+      block_cholesky_lower(L.blocks[b]);
     }
 }
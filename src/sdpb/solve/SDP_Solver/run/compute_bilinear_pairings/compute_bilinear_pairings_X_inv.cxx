@@ -1,10 +1,92 @@
 #include "../../../Block_Diagonal_Matrix.hxx"
+#include "../../../block_kernels.hxx"
+#include "../../../../Matrix_Backend.hxx"
+#include "../../../../mpmat.hxx"
+#include "../../../../fixed_point.hxx"
 
 // bilinear_pairings_X_inv = bilinear_base^T X^{-1} bilinear_base for each block
+//
+// The bases on the diagonal, Q' = 1_{m_j} \otimes Q, have column
+// block s only in row block s.  L is lower triangular, so L^{-1} Q'
+// keeps the zeros above each copy:
+//
+//   work[:, s] = L[s:, s:]^{-1} Q'[s:, s]
+//
+// where [s:] means the row or column blocks from s on.  Each column
+// block is solved with only the trailing part of L.  The pairings are
+// then
+//
+//   bilinear_pairings_X_inv[r, s] = work[r:, r]^T work[r:, s]
+//
+// for s <= r, skipping the rows where work[:, r] is zero.  Together
+// this saves about a factor of 3 in both the Trsm and the product.
+// The mpmat and fixed point Syrks only work on the whole matrix, so
+// they still get all of work.
+
+namespace
+{
+  // work = Q' = 1_{dim} \otimes basis.  Only the diagonal copies of the
+  // basis are communicated, which is cheap next to the Trsm, and no
+  // dense copy of Q' is kept between iterations.
+  void set_block_diagonal(const El::DistMatrix<El::BigFloat> &basis,
+                          const int64_t &dim,
+                          El::DistMatrix<El::BigFloat> &work)
+  {
+    El::Zero(work);
+    const int64_t basis_height(basis.Height()), basis_width(basis.Width());
+    for(int64_t block = 0; block < dim; ++block)
+      {
+        El::DistMatrix<El::BigFloat> diagonal(
+          El::View(work, block * basis_height, block * basis_width,
+                   basis_height, basis_width));
+        El::Copy(basis, diagonal);
+      }
+  }
+
+  void structured_trsm(const El::DistMatrix<El::BigFloat> &L,
+                       const int64_t &basis_height,
+                       const int64_t &basis_width, const int64_t &dim,
+                       El::DistMatrix<El::BigFloat> &work)
+  {
+    for(int64_t column_block = 0; column_block < dim; ++column_block)
+      {
+        const int64_t offset(column_block * basis_height),
+          height(L.Height() - offset);
+        const El::DistMatrix<El::BigFloat> L_trailing(
+          El::LockedView(L, offset, offset, height, height));
+        El::DistMatrix<El::BigFloat> work_columns(El::View(
+          work, offset, column_block * basis_width, height, basis_width));
+        block_trsm_lower(El::Orientation::NORMAL, L_trailing, work_columns);
+      }
+  }
+
+  void structured_syrk(const El::DistMatrix<El::BigFloat> &work,
+                       const int64_t &basis_height,
+                       const int64_t &basis_width, const int64_t &dim,
+                       El::DistMatrix<El::BigFloat> &pairings)
+  {
+    for(int64_t row_block = 0; row_block < dim; ++row_block)
+      {
+        const int64_t offset(row_block * basis_height),
+          height(work.Height() - offset);
+        const El::DistMatrix<El::BigFloat> work_column(El::LockedView(
+          work, offset, row_block * basis_width, height, basis_width));
+        const El::DistMatrix<El::BigFloat> work_left(El::LockedView(
+          work, offset, 0, height, (row_block + 1) * basis_width));
+        El::DistMatrix<El::BigFloat> pairings_rows(
+          El::View(pairings, row_block * basis_width, 0, basis_width,
+                   (row_block + 1) * basis_width));
+        block_gemm(El::Orientation::TRANSPOSE, El::Orientation::NORMAL,
+                   El::BigFloat(1), work_column, work_left, El::BigFloat(0),
+                   pairings_rows);
+      }
+  }
+}
 
 void compute_bilinear_pairings_X_inv(
   const Block_Diagonal_Matrix &X_cholesky,
-  const std::vector<El::Matrix<El::BigFloat>> &bilinear_bases,
+  const Matrix_Backend &matrix_backend,
+  const std::vector<El::DistMatrix<El::BigFloat>> &bilinear_bases,
   std::vector<El::DistMatrix<El::BigFloat>> &workspace,
   Block_Diagonal_Matrix &bilinear_pairings_X_inv)
 {
@@ -14,39 +96,35 @@ void compute_bilinear_pairings_X_inv(
 
   for(auto &work : workspace)
     {
-      // FIXME: This should be a constant, not computed over and over.
-      // Set up the workspace to have copies of bilinear_bases[b]
-      // along the diagonal
-      for(int64_t row = 0; row < work.LocalHeight(); ++row)
-        {
-          size_t global_row(work.GlobalRow(row));
-          size_t row_block(global_row / bilinear_bases_block->Height());
-
-          for(int64_t column = 0; column < work.LocalWidth(); ++column)
-            {
-              size_t global_column(work.GlobalCol(column));
-              size_t column_block(global_column
-                                  / bilinear_bases_block->Width());
-              work.SetLocal(
-                row, column,
-                row_block != column_block
-                  ? El::BigFloat(0)
-                  : (*bilinear_bases_block)(
-                      global_row % bilinear_bases_block->Height(),
-                      global_column % bilinear_bases_block->Width()));
-            }
-        }
+      const int64_t basis_height(bilinear_bases_block->Height()),
+        basis_width(bilinear_bases_block->Width()),
+        dim(basis_width == 0 ? 0 : work.Width() / basis_width);
 
-      El::Trsm(El::LeftOrRight::LEFT, El::UpperOrLowerNS::LOWER,
-               El::Orientation::NORMAL, El::UnitOrNonUnit::NON_UNIT,
-               El::BigFloat(1), *X_cholesky_block, work);
+      // The Trsm is done in-place, so start from the bases on the
+      // diagonal.
+      set_block_diagonal(*bilinear_bases_block, dim, work);
+
+      structured_trsm(*X_cholesky_block, basis_height, basis_width, dim,
+                      work);
 
       // We have to set this to zero because the values can be NaN.
       // Multiplying 0*NaN = NaN.
       Zero(*bilinear_pairings_X_inv_block);
-      Syrk(El::UpperOrLowerNS::LOWER, El::Orientation::TRANSPOSE,
-           El::BigFloat(1), work, El::BigFloat(0),
-           *bilinear_pairings_X_inv_block);
+      if(matrix_backend == Matrix_Backend::mpmat)
+        {
+          mpmat_syrk(El::UpperOrLowerNS::LOWER, work, El::BigFloat(0),
+                     *bilinear_pairings_X_inv_block);
+        }
+      else if(matrix_backend == Matrix_Backend::fixed_point)
+        {
+          fixed_point_syrk(El::UpperOrLowerNS::LOWER, work, El::BigFloat(0),
+                           *bilinear_pairings_X_inv_block);
+        }
+      else
+        {
+          structured_syrk(work, basis_height, basis_width, dim,
+                          *bilinear_pairings_X_inv_block);
+        }
       El::MakeSymmetric(El::UpperOrLower::LOWER,
                         *bilinear_pairings_X_inv_block);
       ++X_cholesky_block;
@@ -1,17 +1,28 @@
 #include "../../../Block_Diagonal_Matrix.hxx"
+#include "../../../block_kernels.hxx"
 
 // bilinear_pairings_Y[b] = Q[b]'^T A[b] Q[b]' for each block 0 <= b < Q.size()
 // bilinear_pairings_Y[b], A[b] denote the b-th blocks of bilinear_pairings_Y,
 // A, resp.
 
-// Q[b]' = Q[b] \otimes 1, where \otimes denotes tensor product
+// Q[b]' = 1_{m_j} \otimes Q[b], where \otimes denotes tensor product
 
-// for each b, L.blocks[b], Q[b], Work[b], and bilinear_pairings_Y.blocks[b]
-// must have the structure described above for `tensorTransposeCongruence'
+// Q[b]' is zero outside its m_j diagonal copies of Q[b], so instead of
+// multiplying by it as a dense matrix, both products work one
+// m_j x m_j sub-block at a time with the compact Q[b]:
+//
+//   work[:, s] = A[b][:, s] Q[b]
+//   bilinear_pairings_Y[b][r, s] = Q[b]^T work[r, s]
+//
+// This skips the multiplications by the zeros, a factor of m_j in
+// both products.  Only the sub-blocks with s <= r are computed, and
+// the upper triangle is filled in by symmetry.
+//
+// work[b] has the same shape as A[b] Q[b]'.
 
 void compute_bilinear_pairings_Y(
   const Block_Diagonal_Matrix &Y,
-  const std::vector<El::Matrix<El::BigFloat>> &bilinear_bases,
+  const std::vector<El::DistMatrix<El::BigFloat>> &bilinear_bases,
   std::vector<El::DistMatrix<El::BigFloat>> &workspace,
   Block_Diagonal_Matrix &bilinear_pairings_Y)
 {
@@ -21,33 +32,37 @@ void compute_bilinear_pairings_Y(
 
   for(auto &work : workspace)
     {
-      // FIXME: This should be a constant, not computed over and over.
-      // Set up the workspace to have copies of bilinear_bases
-      // along the diagonal
-      for(int64_t row = 0; row < work.LocalHeight(); ++row)
+      const int64_t basis_height(bilinear_bases_block->Height()),
+        basis_width(bilinear_bases_block->Width()),
+        dim(basis_width == 0
+              ? 0
+              : bilinear_pairings_Y_block->Height() / basis_width);
+
+      for(int64_t column_block = 0; column_block < dim; ++column_block)
         {
-          size_t global_row(work.GlobalRow(row)),
-            row_block(global_row / bilinear_bases_block->Height());
+          const El::DistMatrix<El::BigFloat> Y_columns(
+            El::LockedView(*Y_block, 0, column_block * basis_height,
+                           Y_block->Height(), basis_height));
+          El::DistMatrix<El::BigFloat> work_columns(
+            El::View(work, 0, column_block * basis_width, work.Height(),
+                     basis_width));
+          block_gemm(El::Orientation::NORMAL, El::Orientation::NORMAL,
+                     El::BigFloat(1), Y_columns, *bilinear_bases_block,
+                     El::BigFloat(0), work_columns);
+        }
 
-          for(int64_t column = 0; column < work.LocalWidth(); ++column)
-            {
-              size_t global_column(work.GlobalCol(column)),
-                column_block(global_column / bilinear_bases_block->Width());
-              work.SetLocal(
-                row, column,
-                row_block != column_block
-                  ? El::BigFloat(0)
-                  : (*bilinear_bases_block)(
-                      global_row % bilinear_bases_block->Height(),
-                      global_column % bilinear_bases_block->Width()));
-            }
+      for(int64_t row_block = 0; row_block < dim; ++row_block)
+        {
+          const El::DistMatrix<El::BigFloat> work_rows(El::LockedView(
+            work, row_block * basis_height, 0, basis_height,
+            (row_block + 1) * basis_width));
+          El::DistMatrix<El::BigFloat> pairings_rows(El::View(
+            *bilinear_pairings_Y_block, row_block * basis_width, 0,
+            basis_width, (row_block + 1) * basis_width));
+          block_gemm(El::Orientation::TRANSPOSE, El::Orientation::NORMAL,
+                     El::BigFloat(1), *bilinear_bases_block, work_rows,
+                     El::BigFloat(0), pairings_rows);
         }
-      auto temp_space(work);
-      Gemm(El::Orientation::NORMAL, El::Orientation::NORMAL, El::BigFloat(1),
-           *Y_block, work, El::BigFloat(0), temp_space);
-      Gemm(El::Orientation::TRANSPOSE, El::Orientation::NORMAL,
-           El::BigFloat(1), work, temp_space, El::BigFloat(0),
-           *bilinear_pairings_Y_block);
       El::MakeSymmetric(El::UpperOrLower::LOWER, *bilinear_pairings_Y_block);
       ++Y_block;
       ++bilinear_pairings_Y_block;
@@ -1,4 +1,5 @@
 #include "../../SDP_Solver.hxx"
+#include "../../Reduction_Batch.hxx"
 
 // dualResidues[p] = primalObjective[p] - Tr(A_p Y) - (FreeVarMatrix y)_p,
 // for 0 <= p < primalObjective.size()
@@ -9,86 +10,106 @@
 //                       (1/2) (BilinearPairingsY_{ej r + k, ej s + k} +
 //                              swap (r <-> s))
 // where ej = d_j + 1.
+//
+// BilinearPairingsY is symmetric, so the two terms are the same, and
+// only the sub-blocks with r <= s are needed.
+//
+// The diagonals of those sub-blocks of BilinearPairingsY are read
+// straight from local storage into the pairings for the whole block,
+// which are summed over the block's grid if it has more than one
+// rank.  Then one pass over the local residues adds
+// primalObjective - pairings to -FreeVarMatrix y and finds the
+// maximum.
+//
+// dual_error is set by batch.reduce().
 
 void compute_dual_residues_and_error(
-  const Block_Info &block_info, const SDP &sdp, const Block_Vector &y,
+  const Block_Info &block_info, const SDP &sdp,
+  const El::DistMatrix<El::BigFloat> &y,
   const Block_Diagonal_Matrix &bilinear_pairings_Y,
-  Block_Vector &dual_residues, El::BigFloat &dual_error, Timers &timers)
+  Block_Vector &dual_residues, El::BigFloat &dual_error,
+  Reduction_Batch &batch, Timers &timers)
 {
   auto &dual_residues_timer(timers.add_and_start("run.computeDualResidues"));
 
   auto dual_residues_block(dual_residues.blocks.begin());
   auto primal_objective_c_block(sdp.primal_objective_c.blocks.begin());
-  auto y_block(y.blocks.begin());
   auto free_var_matrix_block(sdp.free_var_matrix.blocks.begin());
+  auto free_var_columns_block(sdp.free_var_columns.begin());
   auto bilinear_pairings_Y_block(bilinear_pairings_Y.blocks.begin());
 
-  El::BigFloat local_max(0);
+  // Tr(A_p Y) for each p in the block, reused for every block
+  El::Matrix<El::BigFloat> pairings;
+  El::BigFloat local_max(0), element_abs;
   for(auto &block_index : block_info.block_indices)
     {
-      Zero(*dual_residues_block);
-      const size_t block_size(block_info.degrees[block_index] + 1);
+      auto &block_timer(timers.add_and_start("run.computeDualResidues_"
+                                             + std::to_string(block_index)));
+      const size_t block_size(block_info.degrees[block_index] + 1),
+        dimension(block_info.dimensions[block_index]);
+      El::Zeros(pairings, dual_residues_block->Height(), 1);
 
-      // Not sure whether it is better to first loop over blocks in
-      // the result or over sub-blocks in bilinear_pairings_Y
-      for(size_t bb = 2 * block_index; bb < 2 * block_index + 2; ++bb)
+      for(size_t parity = 0; parity < 2; ++parity)
         {
-          for(size_t column_block = 0;
-              column_block < block_info.dimensions[block_index];
+          const El::DistMatrix<El::BigFloat> &pairings_Y(
+            *bilinear_pairings_Y_block);
+          const El::Matrix<El::BigFloat> &pairings_Y_local(
+            pairings_Y.LockedMatrix());
+          for(size_t column_block = 0; column_block < dimension;
               ++column_block)
             for(size_t row_block = 0; row_block <= column_block; ++row_block)
               {
-                size_t column_offset(column_block * block_size),
-                  row_offset(row_block * block_size);
-
-                El::DistMatrix<El::BigFloat> lower_diagonal(El::GetDiagonal(
-                  El::LockedView(*bilinear_pairings_Y_block, row_offset,
-                                 column_offset, block_size, block_size)));
-
-                size_t residue_row_offset(
-                  ((column_block * (column_block + 1)) / 2 + row_block)
-                  * block_size);
-
-                El::DistMatrix<El::BigFloat> residue_sub_block(El::View(
-                  *dual_residues_block, residue_row_offset, 0, block_size, 1));
-
-                // Do a little less work when on a diagonal block.
-                if(column_offset == row_offset)
+                const size_t column_offset(column_block * block_size),
+                  row_offset(row_block * block_size),
+                  residue_row_offset(
+                    ((column_block * (column_block + 1)) / 2 + row_block)
+                    * block_size);
+                for(size_t k = 0; k < block_size; ++k)
                   {
-                    El::Axpy(El::BigFloat(-1.0), lower_diagonal,
-                             residue_sub_block);
-                  }
-                else
-                  {
-                    El::Axpy(El::BigFloat(-0.5), lower_diagonal,
-                             residue_sub_block);
-
-                    El::DistMatrix<El::BigFloat> upper_diagonal(
-                      El::GetDiagonal(El::LockedView(
-                        *bilinear_pairings_Y_block, column_offset, row_offset,
-                        block_size, block_size)));
-
-                    El::Axpy(El::BigFloat(-0.5), upper_diagonal,
-                             residue_sub_block);
+                    const int64_t row(row_offset + k),
+                      column(column_offset + k);
+                    if(pairings_Y.IsLocal(row, column))
+                      {
+                        pairings(residue_row_offset + k, 0)
+                          += pairings_Y_local(pairings_Y.LocalRow(row),
+                                              pairings_Y.LocalCol(column));
+                      }
                   }
               }
           ++bilinear_pairings_Y_block;
         }
-      // dualResidues -= FreeVarMatrix * y
-      Gemm(El::Orientation::NORMAL, El::Orientation::NORMAL, El::BigFloat(-1),
-           *free_var_matrix_block, *y_block, El::BigFloat(1),
-           *dual_residues_block);
-      // dualResidues += primalObjective
-      Axpy(El::BigFloat(1), *primal_objective_c_block, *dual_residues_block);
+      const El::Grid &grid(dual_residues_block->Grid());
+      if(grid.Size() > 1)
+        {
+          El::AllReduce(pairings, grid.Comm());
+        }
 
-      local_max = Max(local_max, El::MaxAbs(*dual_residues_block));
+      // dualResidues = primalObjective - pairings - FreeVarMatrix * y
+      column_ranges_gemv(El::Orientation::NORMAL, El::BigFloat(-1),
+                         *free_var_matrix_block, *free_var_columns_block, y,
+                         El::BigFloat(0), *dual_residues_block);
+      El::Matrix<El::BigFloat> &residues_local(dual_residues_block->Matrix());
+      const El::Matrix<El::BigFloat> &primal_objective_c_local(
+        primal_objective_c_block->LockedMatrix());
+      for(int64_t row = 0; row < residues_local.Height(); ++row)
+        for(int64_t column = 0; column < residues_local.Width(); ++column)
+          {
+            El::BigFloat &element(residues_local(row, column));
+            element += primal_objective_c_local(row, column);
+            element -= pairings(dual_residues_block->GlobalRow(row), 0);
+            element_abs = El::Abs(element);
+            if(element_abs > local_max)
+              {
+                local_max = element_abs;
+              }
+          }
+      block_timer.stop();
 
       ++primal_objective_c_block;
-      ++y_block;
       ++free_var_matrix_block;
+      ++free_var_columns_block;
       ++dual_residues_block;
     }
-  dual_error
-    = El::mpi::AllReduce(local_max, El::mpi::MAX, El::mpi::COMM_WORLD);
+  batch.max(local_max, dual_error);
   dual_residues_timer.stop();
 }
@@ -1,13 +1,22 @@
 #include "../../SDP_Solver_Terminate_Reason.hxx"
 #include "../../../SDP_Solver_Parameters.hxx"
 
+// All of the inputs, including the runtime, must be the same on every
+// rank, so that every rank comes to the same decision.
+// next_iteration_seconds is a prediction of how long the next
+// iteration and the final checkpoint will take.  The solver stops
+// before it would exceed maxRuntime, rather than after.
+// is_primal_infeasible and is_dual_infeasible come from
+// detect_infeasibility(), and are only acted on with
+// detectInfeasibility.
+
 void compute_feasible_and_termination(
   const SDP_Solver_Parameters &parameters, const El::BigFloat &primal_error,
   const El::BigFloat &dual_error, const El::BigFloat &duality_gap,
   const El::BigFloat &primal_step_length, const El::BigFloat &dual_step_length,
-  const int &iteration,
-  const std::chrono::time_point<std::chrono::high_resolution_clock>
-    &solver_start_time,
+  const int &iteration, const El::BigFloat &runtime_seconds,
+  const El::BigFloat &next_iteration_seconds,
+  const bool &is_primal_infeasible, const bool &is_dual_infeasible,
   bool &is_primal_and_dual_feasible,
   SDP_Solver_Terminate_Reason &terminate_reason, bool &terminate_now)
 {
@@ -41,14 +50,20 @@ void compute_feasible_and_termination(
       terminate_reason
         = SDP_Solver_Terminate_Reason::PrimalFeasibleJumpDetected;
     }
+  else if(is_primal_infeasible && parameters.detect_infeasibility)
+    {
+      terminate_reason = SDP_Solver_Terminate_Reason::PrimalInfeasible;
+    }
+  else if(is_dual_infeasible && parameters.detect_infeasibility)
+    {
+      terminate_reason = SDP_Solver_Terminate_Reason::DualInfeasible;
+    }
   else if(iteration > parameters.max_iterations)
     {
       terminate_reason = SDP_Solver_Terminate_Reason::MaxIterationsExceeded;
     }
-  else if(std::chrono::duration_cast<std::chrono::seconds>(
-            std::chrono::high_resolution_clock::now() - solver_start_time)
-            .count()
-          >= parameters.max_runtime)
+  else if(runtime_seconds + next_iteration_seconds
+          >= El::BigFloat(static_cast<double>(parameters.max_runtime)))
     {
       terminate_reason = SDP_Solver_Terminate_Reason::MaxRuntimeExceeded;
     }
@@ -56,8 +71,4 @@ void compute_feasible_and_termination(
     {
       terminate_now = false;
     }
-  El::byte terminate_byte(terminate_now);
-  // Time varies between cores, so follow the decision of the root.
-  El::mpi::Broadcast(terminate_byte, 0, El::mpi::COMM_WORLD);
-  terminate_now = static_cast<bool>(terminate_byte);
 }
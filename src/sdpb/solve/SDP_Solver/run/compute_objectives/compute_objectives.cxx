@@ -1,31 +1,34 @@
 #include "../../../SDP.hxx"
+#include "../../../Reduction_Batch.hxx"
 #include "../../../../../Timers.hxx"
 
-El::BigFloat dot(const Block_Vector &a, const Block_Vector &b);
+El::BigFloat local_dot(const Block_Vector &a, const Block_Vector &b);
+
+// The objectives and the duality gap are set by batch.reduce().
 
 void compute_objectives(const SDP &sdp, const Block_Vector &x,
-                        const Block_Vector &y, El::BigFloat &primal_objective,
+                        const El::DistMatrix<El::BigFloat> &y,
+                        El::BigFloat &primal_objective,
                         El::BigFloat &dual_objective,
-                        El::BigFloat &duality_gap, Timers &timers)
+                        El::BigFloat &duality_gap, Reduction_Batch &batch,
+                        Timers &timers)
 {
   auto &objectives_timer(timers.add_and_start("run.objectives"));
-  primal_objective = sdp.objective_const + dot(sdp.primal_objective_c, x);
-  // dual_objective_b is duplicated amongst the processors.  y is
-  // duplicated amongst the blocks, but it is possible for some
-  // processors to have no blocks.  In principle, we only need to
-  // compute the dot product on the first block, but then we would
-  // have to make sure that we compute that product over all
-  // processors that own that block.
-  if(!y.blocks.empty())
-    {
-      dual_objective = sdp.objective_const
-                       + El::Dotu(sdp.dual_objective_b, y.blocks.front());
-    }
-  El::mpi::Broadcast(dual_objective, 0, El::mpi::COMM_WORLD);
+  batch.sum(local_dot(sdp.primal_objective_c, x), primal_objective);
+  // dual_objective_b and y are duplicated amongst the grids, so
+  // every grid computes the same product.  Broadcasting the root's
+  // value keeps rounding differences between grids out of the
+  // result.
+  const El::BigFloat local_dual_objective(
+    sdp.objective_const + El::Dotu(sdp.dual_objective_b, y));
+  batch.broadcast(local_dual_objective, dual_objective);
 
-  duality_gap
-    = Abs(primal_objective - dual_objective)
-      / Max(Abs(primal_objective) + Abs(dual_objective), El::BigFloat(1));
+  batch.after_reduce([&]() {
+    primal_objective += sdp.objective_const;
+    duality_gap
+      = Abs(primal_objective - dual_objective)
+        / Max(Abs(primal_objective) + Abs(dual_objective), El::BigFloat(1));
+  });
 
   objectives_timer.stop();
 }
@@ -1,7 +1,8 @@
 #include "../../../Block_Vector.hxx"
 #include <cassert>
 
-El::BigFloat dot(const Block_Vector &A, const Block_Vector &B)
+// This rank's part of A . B.  Summing it over all ranks gives A . B.
+El::BigFloat local_dot(const Block_Vector &A, const Block_Vector &B)
 {
   assert(A.blocks.size() == B.blocks.size());
   El::BigFloat local_sum(0);
@@ -18,5 +19,5 @@ El::BigFloat dot(const Block_Vector &A, const Block_Vector &B)
     {
       local_sum = 0;
     }
-  return El::mpi::AllReduce(local_sum, El::mpi::COMM_WORLD);
+  return local_sum;
 }
@@ -1,16 +1,23 @@
 #include "constraint_matrix_weighted_sum.hxx"
+#include "../../Reduction_Batch.hxx"
 
 // PrimalResidues = \sum_p A_p x[p] - X
+//
+// The subtraction and the maximum are fused into the weighted sum.
+//
+// primal_error is set by batch.reduce().
 
 void compute_primal_residues_and_error_P_Ax_X(
-  const Block_Info &block_info, const SDP &sdp, const Block_Vector &x,
+  const Block_Info &block_info, const Matrix_Backend &matrix_backend,
+  const SDP &sdp, const Block_Vector &x,
   const Block_Diagonal_Matrix &X, Block_Diagonal_Matrix &primal_residues,
-  El::BigFloat &primal_error, Timers &timers)
+  El::BigFloat &primal_error, Reduction_Batch &batch, Timers &timers)
 {
   auto &primal_residues_timer(
     timers.add_and_start("run.computePrimalResidues"));
-  constraint_matrix_weighted_sum(block_info, sdp, x, primal_residues);
-  primal_residues -= X;
-  primal_error = primal_residues.max_abs();
+  El::BigFloat local_max_abs;
+  constraint_matrix_weighted_sum(block_info, matrix_backend, sdp, x,
+                                 primal_residues, &X, &local_max_abs);
+  batch.max(local_max_abs, primal_error);
   primal_residues_timer.stop();
 }
@@ -1,60 +1,66 @@
 #include "../../SDP_Solver.hxx"
+#include "../../Reduction_Batch.hxx"
+#include "../../../solver_comm.hxx"
 
 // Compute the residue
 //
 // p[n] = dualObjective[n] - (FreeVarMatrix^T x)_n  for 0 <= n < N
 //
-// and the corresponding primal error max(|p_i|)
+// and the corresponding primal error max(|p_i|), which is set by
+// batch.reduce().
+//
+// primal_residue_p is set to the contribution of this rank's blocks
+// to p.  It is on the grid of the blocks, and p is the sum of the
+// contributions over all ranks.
 
-void compute_primal_residues_and_error_p_b_Bx(const Block_Info &block_info,
-                                              const SDP &sdp,
-                                              const Block_Vector &x,
-                                              Block_Vector &primal_residue_p,
-                                              El::BigFloat &primal_error)
+void compute_primal_residues_and_error_p_b_Bx(
+  const Block_Info &block_info, const SDP &sdp, const Block_Vector &x,
+  El::DistMatrix<El::BigFloat> &primal_residue_p, El::BigFloat &primal_error,
+  Reduction_Batch &batch)
 {
   auto free_var_matrix_block(sdp.free_var_matrix.blocks.begin());
+  auto free_var_columns_block(sdp.free_var_columns.begin());
   auto x_block(x.blocks.begin());
-  auto primal_residue_p_block(primal_residue_p.blocks.begin());
-
-  El::Matrix<El::BigFloat> primal_residue_local;
-  Zeros(primal_residue_local, sdp.dual_objective_b.Height(),
-        sdp.dual_objective_b.Width());
 
+  El::Zeros(primal_residue_p, sdp.dual_objective_b.Height(),
+            sdp.dual_objective_b.Width());
   for(auto &block_index : block_info.block_indices)
     {
-      El::Gemv(El::OrientationNS::TRANSPOSE, El::BigFloat(-1),
-               *free_var_matrix_block, *x_block, El::BigFloat(0),
-               *primal_residue_p_block);
+      column_ranges_gemv(El::OrientationNS::TRANSPOSE, El::BigFloat(-1),
+                         *free_var_matrix_block, *free_var_columns_block,
+                         *x_block, El::BigFloat(1), primal_residue_p);
 
       // The total primal error is the sum of all of the different
       // blocks.  So to prevent double counting, only add
-      // dual_objective_b to one of the residue blocks.
+      // dual_objective_b for one of the blocks.
       if(block_index == 0)
         {
-          El::Axpy(El::BigFloat(1), sdp.dual_objective_b,
-                   *primal_residue_p_block);
-        }
-
-      // Locally sum contributions to the primal errror
-      for(int64_t row = 0; row < sdp.dual_objective_b.LocalHeight(); ++row)
-        {
-          int64_t global_row(sdp.dual_objective_b.GlobalRow(row));
-          for(int64_t column = 0; column < sdp.dual_objective_b.LocalWidth();
-              ++column)
-            {
-              int64_t global_column(sdp.dual_objective_b.GlobalCol(column));
-              primal_residue_local(global_row, global_column)
-                += primal_residue_p_block->GetLocal(row, column);
-            }
+          El::Axpy(El::BigFloat(1), sdp.dual_objective_b, primal_residue_p);
         }
 
       ++free_var_matrix_block;
+      ++free_var_columns_block;
       ++x_block;
-      ++primal_residue_p_block;
+    }
+
+  // Locally sum contributions to the primal errror
+  El::Matrix<El::BigFloat> primal_residue_local;
+  Zeros(primal_residue_local, primal_residue_p.Height(),
+        primal_residue_p.Width());
+  for(int64_t row = 0; row < primal_residue_p.LocalHeight(); ++row)
+    {
+      int64_t global_row(primal_residue_p.GlobalRow(row));
+      for(int64_t column = 0; column < primal_residue_p.LocalWidth();
+          ++column)
+        {
+          int64_t global_column(primal_residue_p.GlobalCol(column));
+          primal_residue_local(global_row, global_column)
+            = primal_residue_p.GetLocal(row, column);
+        }
     }
 
   // Send out updates for the primal residue
-  El::DistMatrix<El::BigFloat> primal_residue_dist;
+  El::DistMatrix<El::BigFloat> primal_residue_dist(solver_grid());
   Zeros(primal_residue_dist, primal_residue_local.Height(),
         primal_residue_local.Width());
 
@@ -81,6 +87,5 @@ void compute_primal_residues_and_error_p_b_Bx(const Block_Info &block_info,
                      El::Abs(primal_residue_dist.GetLocal(row, column)));
       }
 
-  primal_error = El::mpi::AllReduce(local_primal_error, El::mpi::MAX,
-                                    El::mpi::COMM_WORLD);
+  batch.max(local_primal_error, primal_error);
 }
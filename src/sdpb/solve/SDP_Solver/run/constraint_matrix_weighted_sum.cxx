@@ -1,4 +1,7 @@
 #include "../../SDP_Solver.hxx"
+#include "../../block_kernels.hxx"
+#include "../../../Matrix_Backend.hxx"
+#include "../../../limbs.hxx"
 
 // result = \sum_p a[p] A_p,
 //
@@ -10,22 +13,53 @@
 //
 // where v_{b,k} is the k-th column of bilinear_bases[b], as described
 // in SDP.h.
+//
+// With a subtrahend S, result = \sum_p a[p] A_p - S instead, and
+// local_max_abs is set to the largest absolute value of the elements
+// of result on this rank.  Both are done on each sub-block right
+// after its Gemm, while it is still in cache, instead of in separate
+// passes over the whole result.  Only the sub-blocks on and above the
+// diagonal are computed, and MakeSymmetric copies them below, so S
+// must be symmetric.
 
 void constraint_matrix_weighted_sum(const Block_Info &block_info,
+                                    const Matrix_Backend &matrix_backend,
                                     const SDP &sdp, const Block_Vector &a,
-                                    Block_Diagonal_Matrix &result)
+                                    Block_Diagonal_Matrix &result,
+                                    const Block_Diagonal_Matrix *subtrahend,
+                                    El::BigFloat *local_max_abs)
 {
   auto a_block(a.blocks.begin());
   auto result_block(result.blocks.begin());
   auto bilinear_bases_block(sdp.bilinear_bases_dist.begin());
+  // The position of result_block in result.blocks
+  size_t result_position(0);
+  if(local_max_abs != nullptr)
+    {
+      *local_max_abs = 0;
+    }
+  El::BigFloat element_abs;
 
   for(auto &block_index : block_info.block_indices)
     {
       const size_t block_size(block_info.degrees[block_index] + 1);
+
+      // The weights are needed by every rank that holds a column of
+      // the bases, so replicate them once for the whole block.
+      const El::DistMatrix<El::BigFloat, El::STAR, El::STAR> a_star(*a_block);
+      const El::Matrix<El::BigFloat> &a_local(a_star.LockedMatrix());
       for(size_t parity = 0; parity < 2; ++parity)
         {
-          // TODO: Remove this because it gets zero'd out in Gemm?
-          El::Zero(*result_block);
+          // scaled_bases = bilinear_bases * diag(sub_vector).  This
+          // is allocated once per block and overwritten for every
+          // (row_block, column_block) pair.
+          const El::Matrix<El::BigFloat> &bases_local(
+            bilinear_bases_block->LockedMatrix());
+          El::DistMatrix<El::BigFloat> scaled_bases(*bilinear_bases_block);
+          El::Matrix<El::BigFloat> &scaled_local(scaled_bases.Matrix());
+
+          // Every element in the result is written by either Gemm or
+          // MakeSymmetric, so there is no need to zero it first.
           for(size_t column_block = 0;
               column_block < block_info.dimensions[block_index];
               ++column_block)
@@ -37,28 +71,70 @@ void constraint_matrix_weighted_sum(const Block_Info &block_info,
                 size_t vector_offset(
                   ((column_block * (column_block + 1)) / 2 + row_block)
                   * block_size);
-                El::DistMatrix<El::BigFloat> sub_vector(
-                  El::LockedView(*a_block, vector_offset, 0, block_size, 1));
-                El::DistMatrix<El::BigFloat> scaled_bases(
-                  *bilinear_bases_block);
 
-                El::DiagonalScale(El::LeftOrRight::RIGHT,
-                                  El::Orientation::NORMAL, sub_vector,
-                                  scaled_bases);
+                for(int64_t column = 0; column < scaled_bases.LocalWidth();
+                    ++column)
+                  {
+                    const El::BigFloat &weight(a_local(
+                      vector_offset + scaled_bases.GlobalCol(column), 0));
+                    for(int64_t row = 0; row < scaled_bases.LocalHeight();
+                        ++row)
+                      {
+                        El::BigFloat &element(scaled_local(row, column));
+                        element = bases_local(row, column);
+                        element *= weight;
+                      }
+                  }
 
                 El::DistMatrix<El::BigFloat> result_sub_block(
                   El::View(*result_block, row_offset, column_offset,
                            result_block_size, result_block_size));
-                El::Gemm(El::Orientation::NORMAL, El::Orientation::TRANSPOSE,
-                         El::BigFloat(column_block == row_block ? 1 : 0.5),
-                         *bilinear_bases_block, scaled_bases, El::BigFloat(0),
-                         result_sub_block);
+                const El::BigFloat alpha(column_block == row_block ? 1 : 0.5);
+                if(matrix_backend == Matrix_Backend::simd)
+                  {
+                    limb_gemm(El::Orientation::NORMAL,
+                              El::Orientation::TRANSPOSE, alpha,
+                              *bilinear_bases_block, scaled_bases,
+                              El::BigFloat(0), result_sub_block);
+                  }
+                else
+                  {
+                    block_gemm(El::Orientation::NORMAL,
+                               El::Orientation::TRANSPOSE, alpha,
+                               *bilinear_bases_block, scaled_bases,
+                               El::BigFloat(0), result_sub_block);
+                  }
+                if(subtrahend != nullptr)
+                  {
+                    const El::DistMatrix<El::BigFloat> subtrahend_sub_block(
+                      El::LockedView(subtrahend->blocks[result_position],
+                                     row_offset, column_offset,
+                                     result_block_size, result_block_size));
+                    const El::Matrix<El::BigFloat> &subtrahend_local(
+                      subtrahend_sub_block.LockedMatrix());
+                    El::Matrix<El::BigFloat> &result_local(
+                      result_sub_block.Matrix());
+                    for(int64_t column = 0; column < result_local.Width();
+                        ++column)
+                      for(int64_t row = 0; row < result_local.Height(); ++row)
+                        {
+                          El::BigFloat &element(result_local(row, column));
+                          element -= subtrahend_local(row, column);
+                          element_abs = El::Abs(element);
+                          if(local_max_abs != nullptr
+                             && element_abs > *local_max_abs)
+                            {
+                              *local_max_abs = element_abs;
+                            }
+                        }
+                  }
               }
           if(block_info.dimensions[block_index] > 1)
             {
               El::MakeSymmetric(El::UpperOrLowerNS::UPPER, *result_block);
             }
           ++result_block;
+          ++result_position;
           ++bilinear_bases_block;
         }
       ++a_block;
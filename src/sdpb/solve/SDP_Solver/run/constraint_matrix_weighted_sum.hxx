@@ -1,7 +1,12 @@
 #pragma once
 
 #include "../../SDP_Solver.hxx"
+#include "../../../Matrix_Backend.hxx"
 
 void constraint_matrix_weighted_sum(const Block_Info &block_info,
+                                    const Matrix_Backend &matrix_backend,
                                     const SDP &sdp, const Block_Vector &a,
-                                    Block_Diagonal_Matrix &Result);
+                                    Block_Diagonal_Matrix &Result,
+                                    const Block_Diagonal_Matrix *subtrahend
+                                    = nullptr,
+                                    El::BigFloat *local_max_abs = nullptr);
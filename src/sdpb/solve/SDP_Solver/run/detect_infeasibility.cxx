@@ -0,0 +1,97 @@
+#include "../../SDP_Solver.hxx"
+#include "../../Reduction_Batch.hxx"
+
+// Certificates of infeasibility, read off from the current iterate.
+//
+// When the primal problem is infeasible, the dual iterate (y, Y)
+// grows without bound along a dual improving ray, a point with
+//
+//   Tr(A_p Y) + (B y)_p = 0,  Y >= 0,  b . y > 0,
+//
+// which proves by Farkas' lemma that no feasible x exists.  Since
+// Tr(A_p Y) + (B y)_p = c_p - d_p, the iterate, scaled down by
+// s = max(|y|, |Y|), is such a ray up to a residue of
+// (|c| + dualError) / s.  The same works for a primal improving ray,
+//
+//   \sum_p A_p x_p = X >= 0,  B^T x = 0,  c . x < 0,
+//
+// which proves that the dual problem is infeasible, with a residue of
+// max(primalError_P, |b| + primalError_p) / max(|x|, |X|).
+//
+// A ray is detected once its residue is below the corresponding
+// error threshold and its scaled improvement, b . y / s or
+// -c . x / s, is above the duality gap threshold.  X and Y are
+// always positive definite, so no other check is needed.
+
+namespace
+{
+  El::BigFloat local_max_abs(const El::DistMatrix<El::BigFloat> &A)
+  {
+    El::BigFloat result(0);
+    for(int64_t row = 0; row < A.LocalHeight(); ++row)
+      for(int64_t column = 0; column < A.LocalWidth(); ++column)
+        {
+          result = El::Max(result, El::Abs(A.GetLocal(row, column)));
+        }
+    return result;
+  }
+
+  El::BigFloat
+  local_max_abs(const std::vector<El::DistMatrix<El::BigFloat>> &blocks)
+  {
+    El::BigFloat result(0);
+    for(auto &block : blocks)
+      {
+        result = El::Max(result, local_max_abs(block));
+      }
+    return result;
+  }
+}
+
+// The largest elements of c and b, which do not change during a run.
+// Set by batch.reduce().
+void compute_objective_scales(const SDP &sdp, El::BigFloat &max_abs_c,
+                              El::BigFloat &max_abs_b, Reduction_Batch &batch)
+{
+  batch.max(local_max_abs(sdp.primal_objective_c.blocks), max_abs_c);
+  batch.max(local_max_abs(sdp.dual_objective_b), max_abs_b);
+}
+
+// The sizes of the primal and dual iterates.  Set by batch.reduce().
+void compute_iterate_scales(const Block_Vector &x,
+                            const Block_Diagonal_Matrix &X,
+                            const El::DistMatrix<El::BigFloat> &y,
+                            const Block_Diagonal_Matrix &Y,
+                            El::BigFloat &primal_scale,
+                            El::BigFloat &dual_scale, Reduction_Batch &batch)
+{
+  batch.max(El::Max(local_max_abs(x.blocks), local_max_abs(X.blocks)),
+            primal_scale);
+  batch.max(El::Max(local_max_abs(y), local_max_abs(Y.blocks)), dual_scale);
+}
+
+// All of the inputs must be the same on every rank.
+void detect_infeasibility(
+  const SDP_Solver_Parameters &parameters, const SDP &sdp,
+  const El::BigFloat &primal_objective, const El::BigFloat &dual_objective,
+  const El::BigFloat &primal_error_P, const El::BigFloat &primal_error_p,
+  const El::BigFloat &dual_error, const El::BigFloat &max_abs_c,
+  const El::BigFloat &max_abs_b, const El::BigFloat &primal_scale,
+  const El::BigFloat &dual_scale, bool &is_primal_infeasible,
+  bool &is_dual_infeasible)
+{
+  const El::BigFloat zero(0);
+  is_primal_infeasible
+    = dual_scale > zero
+      && max_abs_c + dual_error
+           < parameters.dual_error_threshold * dual_scale
+      && dual_objective - sdp.objective_const
+           > parameters.duality_gap_threshold * dual_scale;
+
+  is_dual_infeasible
+    = primal_scale > zero
+      && El::Max(primal_error_P, max_abs_b + primal_error_p)
+           < parameters.primal_error_threshold * primal_scale
+      && sdp.objective_const - primal_objective
+           > parameters.duality_gap_threshold * primal_scale;
+}
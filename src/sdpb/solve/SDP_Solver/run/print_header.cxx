@@ -1,15 +1,16 @@
 #include "../../SDP_Solver.hxx"
+#include "../../../solver_comm.hxx"
 
 #include <iostream>
 
 void print_header(const Verbosity &verbosity)
 {
-  if(verbosity >= Verbosity::regular && El::mpi::Rank() == 0)
+  if(verbosity >= Verbosity::regular && El::mpi::Rank(solver_comm()) == 0)
     {
       std::cout << "\n"
                 << "          time    mu     P-obj       D-obj      gap     "
-                   "    P-err       p-err       D-err      P-step   D-step   beta\n"
+                   "    P-err       p-err       D-err      P-step   D-step   beta      ETA\n"
                 << "--------------------------------------------------------"
-                   "-------------------------------------------------------------\n";
+                   "----------------------------------------------------------------------\n";
     }
 }
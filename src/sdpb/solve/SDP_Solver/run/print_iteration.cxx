@@ -1,19 +1,25 @@
 #include "../../SDP_Solver.hxx"
+#include "../../Convergence_Forecast.hxx"
 #include "../../../../Timers.hxx"
+#include "../../../solver_comm.hxx"
 
 #include <chrono>
+#include <cmath>
 #include <iostream>
 #include <iomanip>
 
+// The last column is the forecast of the remaining seconds, or "-"
+// while there is none.
+
 void print_iteration(
   const int &iteration, const El::BigFloat &mu,
   const El::BigFloat &primal_step_length, const El::BigFloat &dual_step_length,
   const El::BigFloat &beta_corrector, const SDP_Solver &sdp_solver,
   const std::chrono::time_point<std::chrono::high_resolution_clock>
   &solver_start_time,
-                     const Verbosity &verbosity)
+  const Convergence_Forecast &forecast, const Verbosity &verbosity)
 {
-  if(verbosity >= Verbosity::regular && El::mpi::Rank() == 0)
+  if(verbosity >= Verbosity::regular && El::mpi::Rank(solver_comm()) == 0)
     {
       std::cout << std::left << std::setw(4) << iteration << "  "
 
@@ -51,8 +57,18 @@ void print_iteration(
                 << static_cast<double>(dual_step_length) << " "
 
                 << std::setw(4) << std::setprecision(3)
-                << static_cast<double>(beta_corrector) << "\n"
+                << static_cast<double>(beta_corrector) << " ";
 
-                << std::flush;
+      const double remaining_seconds(forecast.remaining_seconds());
+      std::cout << std::right << std::setw(8);
+      if(std::isfinite(remaining_seconds))
+        {
+          std::cout << std::llround(remaining_seconds);
+        }
+      else
+        {
+          std::cout << "-";
+        }
+      std::cout << std::left << "\n" << std::flush;
     }
 }
@@ -1,28 +1,61 @@
 #include "../../SDP_Solver.hxx"
+#include "../../Step_Workspace.hxx"
+#include "../../Step_Controller.hxx"
+#include "../../Convergence_Forecast.hxx"
+#include "../../set_block_precisions.hxx"
+#include "../../Reduction_Batch.hxx"
 #include "../../../../Timers.hxx"
+#include "../../../solver_comm.hxx"
 
 // The main solver loop
+//
+// The scalars that each iteration needs before it can decide whether
+// to stop (the objectives, the errors, and the runtime and checkpoint
+// decision of the root) are all combined in a single Reduction_Batch.
+// The decision to checkpoint is made there, and acted on at the start
+// of the next iteration.
+//
+// A checkpoint or stop requested by a signal on any rank (see
+// signal_handlers.cxx) is also combined in the batch.  The root
+// predicts the time of the next iteration from the last one and from
+// the mean of Convergence_Forecast, whichever is longer, so that the
+// solver stops before it would overrun maxRuntime.  The root also
+// skips a periodic checkpoint when the forecast says the solver will
+// stop in less time than the last checkpoint took.  Both decisions
+// are broadcast, so every rank follows the root.
 
 void cholesky_decomposition(const Block_Diagonal_Matrix &A,
                             Block_Diagonal_Matrix &L);
 
 void print_header(const Verbosity &verbosity);
+void write_iteration_metrics(
+  const boost::filesystem::path &metrics_file, const int &iteration,
+  const El::BigFloat &mu, const El::BigFloat &primal_step_length,
+  const El::BigFloat &dual_step_length, const El::BigFloat &beta_corrector,
+  const SDP_Solver &sdp_solver,
+  const std::chrono::time_point<std::chrono::high_resolution_clock>
+    &solver_start_time,
+  const Convergence_Forecast &forecast, const Timers &timers);
+
 void print_iteration(
   const int &iteration, const El::BigFloat &mu,
   const El::BigFloat &primal_step_length, const El::BigFloat &dual_step_length,
   const El::BigFloat &beta_corrector, const SDP_Solver &sdp_solver,
   const std::chrono::time_point<std::chrono::high_resolution_clock>
     &solver_start_time,
-  const Verbosity &verbosity);
+  const Convergence_Forecast &forecast, const Verbosity &verbosity);
 
 void compute_objectives(const SDP &sdp, const Block_Vector &x,
-                        const Block_Vector &y, El::BigFloat &primal_objective,
+                        const El::DistMatrix<El::BigFloat> &y,
+                        El::BigFloat &primal_objective,
                         El::BigFloat &dual_objective,
-                        El::BigFloat &duality_gap, Timers &timers);
+                        El::BigFloat &duality_gap, Reduction_Batch &batch,
+                        Timers &timers);
 
 void compute_bilinear_pairings(
+  const Matrix_Backend &matrix_backend,
   const Block_Diagonal_Matrix &X_cholesky, const Block_Diagonal_Matrix &Y,
-  const std::vector<El::Matrix<El::BigFloat>> &bilinear_bases,
+  const std::vector<El::DistMatrix<El::BigFloat>> &bilinear_bases,
   std::vector<El::DistMatrix<El::BigFloat>> &workspace,
   Block_Diagonal_Matrix &bilinear_pairings_X_inv,
   Block_Diagonal_Matrix &bilinear_pairings_Y, Timers &timers);
@@ -31,27 +64,54 @@ void compute_feasible_and_termination(
   const SDP_Solver_Parameters &parameters, const El::BigFloat &primal_error,
   const El::BigFloat &dual_error, const El::BigFloat &duality_gap,
   const El::BigFloat &primal_step_length, const El::BigFloat &dual_step_length,
-  const int &iteration,
-  const std::chrono::time_point<std::chrono::high_resolution_clock>
-    &solver_start_time,
+  const int &iteration, const El::BigFloat &runtime_seconds,
+  const El::BigFloat &next_iteration_seconds,
+  const bool &is_primal_infeasible, const bool &is_dual_infeasible,
   bool &is_primal_and_dual_feasible,
   SDP_Solver_Terminate_Reason &terminate_reason, bool &terminate_now);
 
+double checkpoint_interval_seconds(const SDP_Solver_Parameters &parameters,
+                                   const double &checkpoint_seconds);
+
+bool take_checkpoint_request();
+bool stop_requested();
+
+void compute_objective_scales(const SDP &sdp, El::BigFloat &max_abs_c,
+                              El::BigFloat &max_abs_b, Reduction_Batch &batch);
+
+void compute_iterate_scales(const Block_Vector &x,
+                            const Block_Diagonal_Matrix &X,
+                            const El::DistMatrix<El::BigFloat> &y,
+                            const Block_Diagonal_Matrix &Y,
+                            El::BigFloat &primal_scale,
+                            El::BigFloat &dual_scale, Reduction_Batch &batch);
+
+void detect_infeasibility(
+  const SDP_Solver_Parameters &parameters, const SDP &sdp,
+  const El::BigFloat &primal_objective, const El::BigFloat &dual_objective,
+  const El::BigFloat &primal_error_P, const El::BigFloat &primal_error_p,
+  const El::BigFloat &dual_error, const El::BigFloat &max_abs_c,
+  const El::BigFloat &max_abs_b, const El::BigFloat &primal_scale,
+  const El::BigFloat &dual_scale, bool &is_primal_infeasible,
+  bool &is_dual_infeasible);
+
 void compute_dual_residues_and_error(
-  const Block_Info &block_info, const SDP &sdp, const Block_Vector &y,
+  const Block_Info &block_info, const SDP &sdp,
+  const El::DistMatrix<El::BigFloat> &y,
   const Block_Diagonal_Matrix &bilinear_pairings_Y,
-  Block_Vector &dual_residues, El::BigFloat &dual_error, Timers &timers);
+  Block_Vector &dual_residues, El::BigFloat &dual_error,
+  Reduction_Batch &batch, Timers &timers);
 
 void compute_primal_residues_and_error_P_Ax_X(
-  const Block_Info &block_info, const SDP &sdp, const Block_Vector &x,
+  const Block_Info &block_info, const Matrix_Backend &matrix_backend,
+  const SDP &sdp, const Block_Vector &x,
   const Block_Diagonal_Matrix &X, Block_Diagonal_Matrix &primal_residues,
-  El::BigFloat &primal_error_P, Timers &timers);
+  El::BigFloat &primal_error_P, Reduction_Batch &batch, Timers &timers);
 
-void compute_primal_residues_and_error_p_b_Bx(const Block_Info &block_info,
-                                              const SDP &sdp,
-                                              const Block_Vector &x,
-                                              Block_Vector &primal_residue_p,
-                                              El::BigFloat &primal_error_p);
+void compute_primal_residues_and_error_p_b_Bx(
+  const Block_Info &block_info, const SDP &sdp, const Block_Vector &x,
+  El::DistMatrix<El::BigFloat> &primal_residue_p, El::BigFloat &primal_error_p,
+  Reduction_Batch &batch);
 
 SDP_Solver_Terminate_Reason
 SDP_Solver::run(const SDP_Solver_Parameters &parameters,
@@ -65,7 +125,13 @@ SDP_Solver::run(const SDP_Solver_Parameters &parameters,
 
   El::BigFloat primal_step_length(0), dual_step_length(0);
 
+  // The Cholesky factors and the workspace for the bilinear pairings
+  // are only used within each block, so they are kept at the block's
+  // precision.  Everything that is summed over blocks, into Q and the
+  // residues, stays at the full precision.
   Block_Diagonal_Matrix X_cholesky(X), Y_cholesky(X);
+  set_block_precisions(block_info, X_cholesky.blocks);
+  set_block_precisions(block_info, Y_cholesky.blocks);
 
   // Bilinear pairings needed for computing the Schur complement
   // matrix.  For example,
@@ -96,8 +162,8 @@ SDP_Solver::run(const SDP_Solver_Parameters &parameters,
 
   // Additional workspace variables used in step_length()
   std::vector<El::DistMatrix<El::BigFloat>> bilinear_pairings_workspace;
-  bilinear_pairings_workspace.reserve(X.blocks.size());
-  {
+  auto allocate_bilinear_pairings_workspace([&]() {
+    bilinear_pairings_workspace.reserve(X.blocks.size());
     auto bilinear_pairings_X_inv_block(bilinear_pairings_X_inv.blocks.begin());
     for(auto &X_block : X.blocks)
       {
@@ -105,7 +171,14 @@ SDP_Solver::run(const SDP_Solver_Parameters &parameters,
           X_block.Height(), bilinear_pairings_X_inv_block->Width(), grid);
         ++bilinear_pairings_X_inv_block;
       }
-  }
+    set_block_precisions(block_info, bilinear_pairings_workspace);
+  });
+  allocate_bilinear_pairings_workspace();
+
+  // Workspace for step(), reused in every iteration.
+  Step_Workspace step_workspace(parameters, block_info, sdp, grid, x, X, y);
+  Step_Controller step_controller(parameters);
+  Convergence_Forecast forecast(parameters);
   print_header(parameters.verbosity);
 
   std::size_t total_psd_rows(
@@ -114,73 +187,209 @@ SDP_Solver::run(const SDP_Solver_Parameters &parameters,
 
   initialize_timer.stop();
   auto last_checkpoint_time(std::chrono::high_resolution_clock::now());
+  // No time has passed yet, so this is the same on every rank.
+  El::BigFloat checkpoint_now(parameters.checkpoint_interval <= 0 ? 1 : 0),
+    runtime_seconds, next_iteration_seconds, checkpoint_requested,
+    stop_now;
+  // Only used on the root
+  double previous_runtime(0), checkpoint_seconds(0);
+  Reduction_Batch batch;
+  // Only needed with detectInfeasibility
+  El::BigFloat max_abs_c, max_abs_b, primal_scale, dual_scale;
+  if(parameters.detect_infeasibility)
+    {
+      compute_objective_scales(sdp, max_abs_c, max_abs_b, batch);
+      batch.reduce(solver_comm());
+    }
   for(size_t iteration = 1;; ++iteration)
     {
-      El::byte checkpoint_now(
-        std::chrono::duration_cast<std::chrono::seconds>(
-          std::chrono::high_resolution_clock::now() - last_checkpoint_time)
-          .count()
-        >= parameters.checkpoint_interval);
-      // Time varies between cores, so follow the decision of the root.
-      El::mpi::Broadcast(checkpoint_now, 0, El::mpi::COMM_WORLD);
-      if(checkpoint_now == true)
-        {
-          save_checkpoint(parameters);
+      timers.start_iteration();
+      auto &checkpoint_timer(timers.add_and_start("run.checkpoint"));
+      if(checkpoint_now != El::BigFloat(0))
+        {
+          const auto checkpoint_start(
+            std::chrono::high_resolution_clock::now());
+          save_checkpoint(parameters, block_info,
+                          parameters.async_checkpoint);
           last_checkpoint_time = std::chrono::high_resolution_clock::now();
+          checkpoint_seconds = std::chrono::duration<double>(
+                                 last_checkpoint_time - checkpoint_start)
+                                 .count();
+        }
+      else
+        {
+          finish_checkpoint(parameters, false);
         }
+      checkpoint_timer.stop();
 
       compute_objectives(sdp, x, y, primal_objective, dual_objective,
-                         duality_gap, timers);
+                         duality_gap, batch, timers);
 
       auto &cholesky_decomposition_timer(
         timers.add_and_start("run.choleskyDecomposition"));
-      cholesky_decomposition(X, X_cholesky);
-      cholesky_decomposition(Y, Y_cholesky);
+      // The last step may already have factored X and Y.
+      Step_Workspace::Next_Cholesky *next_cholesky(
+        step_workspace.next_cholesky.get_ptr());
+      if(next_cholesky && next_cholesky->is_X_valid)
+        {
+          std::swap(X_cholesky.blocks, next_cholesky->X.blocks);
+        }
+      else
+        {
+          cholesky_decomposition(X, X_cholesky);
+        }
+      if(next_cholesky && next_cholesky->is_Y_valid)
+        {
+          std::swap(Y_cholesky.blocks, next_cholesky->Y.blocks);
+        }
+      else
+        {
+          cholesky_decomposition(Y, Y_cholesky);
+        }
+      if(next_cholesky)
+        {
+          next_cholesky->is_X_valid = false;
+          next_cholesky->is_Y_valid = false;
+        }
       cholesky_decomposition_timer.stop();
 
+      // With memoryMode=low, step() frees the pairings once the
+      // Schur complement is computed, and the workspace is freed
+      // below, so they are allocated again for each iteration.
+      if(bilinear_pairings_X_inv.blocks.size() != X.blocks.size())
+        {
+          bilinear_pairings_X_inv = Block_Diagonal_Matrix(
+            block_info.bilinear_pairing_block_sizes, block_info.block_indices,
+            block_info.schur_block_sizes.size(), grid);
+          bilinear_pairings_Y = bilinear_pairings_X_inv;
+        }
+      if(bilinear_pairings_workspace.size() != X.blocks.size())
+        {
+          allocate_bilinear_pairings_workspace();
+        }
       compute_bilinear_pairings(
-        X_cholesky, Y, sdp.bilinear_bases_local, bilinear_pairings_workspace,
-        bilinear_pairings_X_inv, bilinear_pairings_Y, timers);
+        parameters.matrix_backend, X_cholesky, Y, sdp.bilinear_bases_dist,
+        bilinear_pairings_workspace, bilinear_pairings_X_inv,
+        bilinear_pairings_Y, timers);
+      if(parameters.memory_mode == Memory_Mode::low)
+        {
+          std::vector<El::DistMatrix<El::BigFloat>>().swap(
+            bilinear_pairings_workspace);
+        }
 
       compute_dual_residues_and_error(block_info, sdp, y, bilinear_pairings_Y,
-                                      dual_residues, dual_error, timers);
+                                      dual_residues, dual_error, batch,
+                                      timers);
       compute_primal_residues_and_error_P_Ax_X(
-        block_info, sdp, x, X, primal_residues, primal_error_P, timers);
+        block_info, parameters.matrix_backend, sdp, x, X, primal_residues,
+        primal_error_P, batch, timers);
 
-      // use y to set the sizes of primal_residue_p.  The data is
-      // overwritten in compute_primal_residues_and_error_p.
-      Block_Vector primal_residue_p(y);
+      // The sizes of primal_residue_p are set in
+      // compute_primal_residues_and_error_p_b_Bx.
+      El::DistMatrix<El::BigFloat> primal_residue_p(grid);
       compute_primal_residues_and_error_p_b_Bx(
-        block_info, sdp, x, primal_residue_p, primal_error_p);
+        block_info, sdp, x, primal_residue_p, primal_error_p, batch);
+      if(parameters.detect_infeasibility)
+        {
+          compute_iterate_scales(x, X, y, Y, primal_scale, dual_scale,
+                                 batch);
+        }
+
+      // Time varies between cores, so follow the root.
+      const auto now(std::chrono::high_resolution_clock::now());
+      const int64_t since_checkpoint(
+        std::chrono::duration_cast<std::chrono::seconds>(
+          now - last_checkpoint_time)
+          .count()),
+        runtime(std::chrono::duration_cast<std::chrono::seconds>(
+                  now - solver_timer.start_time)
+                  .count());
+      batch.broadcast(
+        El::BigFloat(since_checkpoint >= checkpoint_interval_seconds(
+                       parameters, checkpoint_seconds)
+                           && !(forecast.remaining_seconds()
+                                < checkpoint_seconds)
+                       ? 1
+                       : 0),
+        checkpoint_now);
+      batch.broadcast(El::BigFloat(static_cast<double>(runtime)),
+                      runtime_seconds);
+      // The last iteration, including any checkpoint at its start,
+      // and one more checkpoint in case the solver stops.
+      const double exact_runtime(
+        std::chrono::duration<double>(now - solver_timer.start_time)
+          .count());
+      batch.broadcast(
+        El::BigFloat(std::max(exact_runtime - previous_runtime,
+                              forecast.seconds_per_iteration())
+                     + checkpoint_seconds),
+        next_iteration_seconds);
+      previous_runtime = exact_runtime;
+      batch.max(El::BigFloat(take_checkpoint_request() ? 1 : 0),
+                checkpoint_requested);
+      batch.max(El::BigFloat(stop_requested() ? 1 : 0), stop_now);
+      auto &reduce_timer(timers.add_and_start("run.reduce"));
+      batch.reduce(solver_comm());
+      reduce_timer.stop();
+      if(checkpoint_requested != El::BigFloat(0))
+        {
+          checkpoint_now = 1;
+        }
+
+      bool is_primal_infeasible(false), is_dual_infeasible(false);
+      if(parameters.detect_infeasibility)
+        {
+          detect_infeasibility(parameters, sdp, primal_objective,
+                               dual_objective, primal_error_P,
+                               primal_error_p, dual_error, max_abs_c,
+                               max_abs_b, primal_scale, dual_scale,
+                               is_primal_infeasible, is_dual_infeasible);
+        }
 
       bool terminate_now, is_primal_and_dual_feasible;
       compute_feasible_and_termination(
         parameters, primal_error(), dual_error, duality_gap,
-        primal_step_length, dual_step_length, iteration,
-        solver_timer.start_time, is_primal_and_dual_feasible, terminate_reason,
-        terminate_now);
+        primal_step_length, dual_step_length, iteration, runtime_seconds,
+        next_iteration_seconds, is_primal_infeasible, is_dual_infeasible,
+        is_primal_and_dual_feasible, terminate_reason, terminate_now);
       if(terminate_now)
         {
           break;
         }
+      if(stop_now != El::BigFloat(0))
+        {
+          terminate_reason = SDP_Solver_Terminate_Reason::SignalReceived;
+          break;
+        }
 
       El::BigFloat mu, beta_corrector;
       step(parameters, total_psd_rows, is_primal_and_dual_feasible, block_info,
            sdp, grid, X_cholesky, Y_cholesky, bilinear_pairings_X_inv,
            bilinear_pairings_Y, primal_residue_p, mu, beta_corrector,
-           primal_step_length, dual_step_length, terminate_now, timers);
+           primal_step_length, dual_step_length, step_workspace,
+           step_controller, terminate_now, timers);
       if(terminate_now)
         {
           terminate_reason
             = SDP_Solver_Terminate_Reason::MaxComplementarityExceeded;
           break;
         }
+      forecast.add(duality_gap, primal_error(), dual_error,
+                   std::chrono::duration<double>(
+                     std::chrono::high_resolution_clock::now()
+                     - solver_timer.start_time)
+                     .count());
       print_iteration(iteration, mu, primal_step_length, dual_step_length,
                       beta_corrector, *this, solver_timer.start_time,
-                      parameters.verbosity);
+                      forecast, parameters.verbosity);
+      write_iteration_metrics(parameters.metrics_file, iteration, mu,
+                              primal_step_length, dual_step_length,
+                              beta_corrector, *this, solver_timer.start_time,
+                              forecast, timers);
     }
 
   // Never reached
+  finish_checkpoint(parameters, true);
   solver_timer.stop();
   return terminate_reason;
 }
@@ -1,4 +1,5 @@
 #include "../../../../SDP_Solver.hxx"
+#include "../../../../block_kernels.hxx"
 
 // Compute the vector r_x on the right-hand side of the Schur
 // complement equation:
@@ -17,6 +18,13 @@
 // - Z = X^{-1} (PrimalResidues Y - R)
 // Outputs:
 // - r_x, a Vector of length P
+//
+// For each sub-block Z_{rs} of Z, Tr(A_p Z) is the diagonal of
+// q^T Z_{rs} q, where q is the bilinear basis.  We compute Z_{rs} q
+// with Gemm into a reused buffer, and then accumulate the local part
+// of the column sums of q .* (Z_{rs} q) directly.  The partial sums
+// for both parities and all sub-blocks are summed with a single
+// AllReduce per block.
 
 void compute_schur_RHS(const Block_Info &block_info, const SDP &sdp,
                        const Block_Vector &dual_residues,
@@ -29,6 +37,7 @@ void compute_schur_RHS(const Block_Info &block_info, const SDP &sdp,
   auto Z_block(Z.blocks.begin());
   auto bilinear_bases_block(sdp.bilinear_bases_dist.begin());
 
+  El::BigFloat product;
   for(auto &block_index : block_info.block_indices)
     {
       // dx = -dual_residues
@@ -36,14 +45,19 @@ void compute_schur_RHS(const Block_Info &block_info, const SDP &sdp,
       *dx_block *= -1;
       const size_t dx_block_size(block_info.degrees[block_index] + 1);
 
-      // dx[p] -= Tr(A_p Z)
-      // Not sure whether it is better to first loop over blocks in
-      // the result or over sub-blocks in Z
+      // This rank's part of Tr(A_p Z) for every p in the block
+      El::Matrix<El::BigFloat> traces(dx_block->Height(), 1);
+      El::Zero(traces);
+
       for(size_t parity = 0; parity < 2; ++parity)
         {
           const size_t Z_block_size(bilinear_bases_block->Height());
-          El::DistMatrix<El::BigFloat> ones(Z_block->Grid());
-          El::Ones(ones, Z_block_size, 1);
+          const El::Matrix<El::BigFloat> &q_local(
+            bilinear_bases_block->LockedMatrix());
+          El::DistMatrix<El::BigFloat> Z_times_q(Z_block_size, dx_block_size,
+                                                 Z_block->Grid());
+          const El::Matrix<El::BigFloat> &Z_times_q_local(
+            Z_times_q.LockedMatrix());
 
           for(size_t column_block = 0;
               column_block < block_info.dimensions[block_index];
@@ -53,33 +67,42 @@ void compute_schur_RHS(const Block_Info &block_info, const SDP &sdp,
                 size_t column_offset(column_block * Z_block_size),
                   row_offset(row_block * Z_block_size);
 
-                El::DistMatrix<El::BigFloat> Z_sub_block(
-                  El::LockedView(*Z_block, row_offset, column_offset,
-                                 Z_block_size, Z_block_size)),
-                  Z_times_q(Z_block_size, dx_block_size, Z_block->Grid());
-                El::Zero(Z_times_q);
-                El::DistMatrix<El::BigFloat> q_Z_q(Z_times_q);
-                El::Zero(q_Z_q);
-
-                El::Gemm(El::Orientation::NORMAL, El::Orientation::NORMAL,
-                         El::BigFloat(1), Z_sub_block, *bilinear_bases_block,
-                         El::BigFloat(0), Z_times_q);
-
-                El::Hadamard(Z_times_q, *bilinear_bases_block, q_Z_q);
+                El::DistMatrix<El::BigFloat> Z_sub_block(El::LockedView(
+                  *Z_block, row_offset, column_offset, Z_block_size,
+                  Z_block_size));
+                block_gemm(El::Orientation::NORMAL, El::Orientation::NORMAL,
+                           El::BigFloat(1), Z_sub_block, *bilinear_bases_block,
+                           El::BigFloat(0), Z_times_q);
 
                 const size_t dx_row_offset(
                   ((column_block * (column_block + 1)) / 2 + row_block)
                   * dx_block_size);
-                El::DistMatrix<El::BigFloat> dx_sub_block(
-                  El::View(*dx_block, dx_row_offset, 0, dx_block_size, 1));
-
-                El::Gemv(El::Orientation::TRANSPOSE, El::BigFloat(-1), q_Z_q,
-                         ones, El::BigFloat(1), dx_sub_block);
+                for(int64_t column = 0; column < Z_times_q.LocalWidth();
+                    ++column)
+                  {
+                    El::BigFloat &trace(
+                      traces(dx_row_offset + Z_times_q.GlobalCol(column), 0));
+                    for(int64_t row = 0; row < Z_times_q.LocalHeight(); ++row)
+                      {
+                        product = Z_times_q_local(row, column);
+                        product *= q_local(row, column);
+                        trace += product;
+                      }
+                  }
               }
           ++Z_block;
           ++bilinear_bases_block;
         }
 
+      // dx[p] -= Tr(A_p Z)
+      El::AllReduce(traces, dx_block->Grid().Comm());
+      for(int64_t row = 0; row < dx_block->LocalHeight(); ++row)
+        for(int64_t column = 0; column < dx_block->LocalWidth(); ++column)
+          {
+            dx_block->Matrix()(row, column)
+              -= traces(dx_block->GlobalRow(row), 0);
+          }
+
       ++dual_residues_block;
       ++dx_block;
     }
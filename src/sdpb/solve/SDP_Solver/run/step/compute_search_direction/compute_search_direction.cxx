@@ -1,4 +1,5 @@
 #include "../../constraint_matrix_weighted_sum.hxx"
+#include "../../../../Step_Workspace.hxx"
 #include "../../../../../../Timers.hxx"
 
 // Compute the search direction (dx, dX, dy, dY) for the predictor and
@@ -9,6 +10,8 @@
 // - mu = Tr(X Y) / X.cols
 // - correctorPhase: boolean indicating whether we're in the corrector
 //   phase or predictor phase.
+// - X_Y, primal_residues_Y: X Y and PrimalResidues Y, which are the
+//   same for every direction of an iteration.
 // Workspace (members of SDPSolver which are modified in-place but not
 // used elsewhere):
 // - Z, R
@@ -40,24 +43,46 @@ void compute_schur_RHS(const Block_Info &block_info, const SDP &sdp,
 
 void solve_schur_complement_equation(
   const Block_Diagonal_Matrix &schur_complement_cholesky,
+  const Block_Matrix &schur_off_diagonal, const Block_Matrix &free_var_matrix,
+  const std::vector<Column_Ranges> &free_var_columns,
+  const El::DistMatrix<El::BigFloat> &Q, Q_Column_Reduction &dy_reduction,
+  Block_Vector &dx, El::DistMatrix<El::BigFloat> &dy);
+
+void refine_schur_complement_solution(
+  const SDP &sdp, const Block_Diagonal_Matrix &schur_complement_cholesky,
+  const Step_Workspace::Schur_Refinement &schur_refinement,
   const Block_Matrix &schur_off_diagonal,
-  const El::DistMatrix<El::BigFloat> &Q, Block_Vector &dx, Block_Vector &dy);
+  const El::DistMatrix<El::BigFloat> &Q, Q_Column_Reduction &dy_reduction,
+  const Block_Vector &rhs_x, const El::DistMatrix<El::BigFloat> &rhs_y,
+  Block_Vector &dx, El::DistMatrix<El::BigFloat> &dy);
 
 void compute_search_direction(
-  const Block_Info &block_info, const SDP &sdp, const SDP_Solver &solver,
-  const Block_Diagonal_Matrix &schur_complement_cholesky,
-  const Block_Matrix &schur_off_diagonal,
-  const Block_Diagonal_Matrix &X_cholesky, const El::BigFloat beta,
-  const El::BigFloat &mu, const Block_Vector &primal_residue_p,
-  const bool &is_corrector_phase,
-  const El::DistMatrix<El::BigFloat> &Q, Block_Vector &dx,
-  Block_Diagonal_Matrix &dX, Block_Vector &dy, Block_Diagonal_Matrix &dY)
+  const Block_Info &block_info, const Matrix_Backend &matrix_backend,
+  const SDP &sdp, const SDP_Solver &solver,
+  Block_Diagonal_Matrix &schur_complement_cholesky,
+  const Step_Workspace::Schur_Refinement &schur_refinement,
+  Block_Matrix &schur_off_diagonal, Block_Spill &schur_complement_spill,
+  Block_Spill &schur_off_diagonal_spill,
+  const Block_Diagonal_Matrix &X_cholesky,
+  const Block_Diagonal_Matrix &X_Y,
+  const Block_Diagonal_Matrix &primal_residues_Y, const El::BigFloat beta,
+  const El::BigFloat &mu,
+  const El::DistMatrix<El::BigFloat> &primal_residue_p,
+  const bool &is_corrector_phase, const El::DistMatrix<El::BigFloat> &Q,
+  std::future<void> &Q_cholesky, Q_Column_Reduction &dy_reduction,
+  Block_Vector &dx,
+  Block_Diagonal_Matrix &dX, El::DistMatrix<El::BigFloat> &dy,
+  Block_Diagonal_Matrix &dY)
 {
+  // Read the spilled blocks of the Schur factors while R and Z are
+  // computed.
+  schur_complement_spill.prefetch();
+  schur_off_diagonal_spill.prefetch();
+
   // R = beta mu I - X Y (predictor phase)
   // R = beta mu I - X Y - dX dY (corrector phase)
-  Block_Diagonal_Matrix R(solver.X);
-
-  scale_multiply_add(El::BigFloat(-1), solver.X, solver.Y, El::BigFloat(0), R);
+  Block_Diagonal_Matrix R(X_Y);
+  R *= El::BigFloat(-1);
   if(is_corrector_phase)
     {
       scale_multiply_add(El::BigFloat(-1), dX, dY, El::BigFloat(1), R);
@@ -65,8 +90,7 @@ void compute_search_direction(
   R.add_diagonal(beta * mu);
 
   // Z = Symmetrize(X^{-1} (PrimalResidues Y - R))
-  Block_Diagonal_Matrix Z(solver.X);
-  multiply(solver.primal_residues, solver.Y, Z);
+  Block_Diagonal_Matrix Z(primal_residues_Y);
   Z -= R;
   cholesky_solve(X_cholesky, Z);
   Z.symmetrize();
@@ -74,14 +98,41 @@ void compute_search_direction(
   // dx[p] = -dual_residues[p] - Tr(A_p Z)
   // dy[n] = dualObjective[n] - (FreeVarMatrix^T x)_n
   compute_schur_RHS(block_info, sdp, solver.dual_residues, Z, dx);
-  dy=primal_residue_p;
+  dy = primal_residue_p;
+
+  // With overlapQCholesky, Q is factored on a background thread
+  // while everything above runs.
+  if(Q_cholesky.valid())
+    {
+      Q_cholesky.get();
+    }
 
   // Solve for dx, dy in-place
-  solve_schur_complement_equation(schur_complement_cholesky,
-                                  schur_off_diagonal, Q, dx, dy);
+  schur_complement_spill.load(schur_complement_cholesky.blocks);
+  schur_off_diagonal_spill.load(schur_off_diagonal.blocks);
+  if(schur_refinement.is_enabled)
+    {
+      const Block_Vector rhs_x(dx);
+      const El::DistMatrix<El::BigFloat> rhs_y(dy);
+      solve_schur_complement_equation(
+        schur_complement_cholesky, schur_off_diagonal, sdp.free_var_matrix,
+        sdp.free_var_columns, Q, dy_reduction, dx, dy);
+      refine_schur_complement_solution(
+        sdp, schur_complement_cholesky, schur_refinement, schur_off_diagonal,
+        Q, dy_reduction, rhs_x, rhs_y, dx, dy);
+    }
+  else
+    {
+      solve_schur_complement_equation(
+        schur_complement_cholesky, schur_off_diagonal, sdp.free_var_matrix,
+        sdp.free_var_columns, Q, dy_reduction, dx, dy);
+    }
+  // The files are still valid, so these are only freed.
+  schur_complement_spill.release(schur_complement_cholesky.blocks);
+  schur_off_diagonal_spill.release(schur_off_diagonal.blocks);
 
   // dX = PrimalResidues + \sum_p A_p dx[p]
-  constraint_matrix_weighted_sum(block_info, sdp, dx, dX);
+  constraint_matrix_weighted_sum(block_info, matrix_backend, sdp, dx, dX);
   dX += solver.primal_residues;
 
   // dY = Symmetrize(X^{-1} (R - dX Y))
@@ -0,0 +1,142 @@
+#include "../../../../SDP.hxx"
+#include "../../../../Step_Workspace.hxx"
+#include "../../../../../solver_comm.hxx"
+
+// Iterative refinement of the solution of the Schur complement
+// equation
+//
+//   {{S, -B}, {B^T, 0}} . {dx, dy} = {r, s}
+//
+// when some blocks of S were factored at a lower precision.  The
+// factors, and Q and SchurOffDiagonal computed from them, are then
+// only a preconditioner: each step computes the residual at the full
+// precision, using the unfactored S of those blocks and L L^T for the
+// others, and adds the preconditioned correction.  The refinement
+// stops when the residual is at the level of rounding, or when it
+// stops shrinking.  That only converges if the lower precision is
+// well above log2 of the condition number of S.
+//
+// As in solve_schur_complement_equation(), s is the sum of rhs_y over
+// the ranks, and every rank holds all of dy.
+
+void solve_schur_complement_equation(
+  const Block_Diagonal_Matrix &schur_complement_cholesky,
+  const Block_Matrix &schur_off_diagonal, const Block_Matrix &free_var_matrix,
+  const std::vector<Column_Ranges> &free_var_columns,
+  const El::DistMatrix<El::BigFloat> &Q, Q_Column_Reduction &dy_reduction,
+  Block_Vector &dx, El::DistMatrix<El::BigFloat> &dy);
+
+namespace
+{
+  constexpr size_t max_refinement_steps(16);
+
+  El::BigFloat local_max_abs(const El::DistMatrix<El::BigFloat> &A)
+  {
+    El::BigFloat result(0);
+    const El::Matrix<El::BigFloat> &local(A.LockedMatrix());
+    for(int64_t column = 0; column < local.Width(); ++column)
+      for(int64_t row = 0; row < local.Height(); ++row)
+        {
+          result = El::Max(result, El::Abs(local(row, column)));
+        }
+    return result;
+  }
+
+  // The largest element of the x part and of the sum of the y parts
+  // over all ranks.
+  El::BigFloat
+  max_abs(const Block_Vector &x, const El::DistMatrix<El::BigFloat> &y)
+  {
+    El::BigFloat result(0);
+    for(auto &block : x.blocks)
+      {
+        result = El::Max(result, local_max_abs(block));
+      }
+    El::Matrix<El::BigFloat> y_sum;
+    El::Zeros(y_sum, y.Height(), 1);
+    for(int64_t row = 0; row < y.LocalHeight(); ++row)
+      for(int64_t column = 0; column < y.LocalWidth(); ++column)
+        {
+          y_sum(y.GlobalRow(row), y.GlobalCol(column))
+            = y.GetLocal(row, column);
+        }
+    El::AllReduce(y_sum, solver_comm());
+    for(int64_t row = 0; row < y_sum.Height(); ++row)
+      {
+        result = El::Max(result, El::Abs(y_sum(row, 0)));
+      }
+    return El::mpi::AllReduce(result, El::mpi::MAX, solver_comm());
+  }
+}
+
+void refine_schur_complement_solution(
+  const SDP &sdp, const Block_Diagonal_Matrix &schur_complement_cholesky,
+  const Step_Workspace::Schur_Refinement &schur_refinement,
+  const Block_Matrix &schur_off_diagonal,
+  const El::DistMatrix<El::BigFloat> &Q, Q_Column_Reduction &dy_reduction,
+  const Block_Vector &rhs_x, const El::DistMatrix<El::BigFloat> &rhs_y,
+  Block_Vector &dx, El::DistMatrix<El::BigFloat> &dy)
+{
+  const El::BigFloat tolerance(El::limits::Epsilon<El::BigFloat>()
+                               * max_abs(rhs_x, rhs_y));
+  Block_Vector residual_x(rhs_x);
+  El::DistMatrix<El::BigFloat> residual_y(rhs_y);
+  El::DistMatrix<El::BigFloat> product;
+  El::BigFloat previous_norm(El::limits::Max<El::BigFloat>());
+  for(size_t step = 0; step < max_refinement_steps; ++step)
+    {
+      // residual_x = r - S dx + B dy
+      // residual_y = s - B^T dx
+      residual_y = rhs_y;
+      for(size_t block = 0; block < dx.blocks.size(); ++block)
+        {
+          const El::DistMatrix<El::BigFloat> &S(
+            schur_refinement.schur_complement[block]),
+            &L(schur_complement_cholesky.blocks[block]),
+            &B(sdp.free_var_matrix.blocks[block]);
+          residual_x.blocks[block] = rhs_x.blocks[block];
+          if(S.Height() != 0)
+            {
+              // Only the lower triangle of S is computed.
+              El::Symv(El::UpperOrLowerNS::LOWER, El::BigFloat(-1), S,
+                       dx.blocks[block], El::BigFloat(1),
+                       residual_x.blocks[block]);
+            }
+          else
+            {
+              product = dx.blocks[block];
+              El::Trmm(El::LeftOrRight::LEFT, El::UpperOrLowerNS::LOWER,
+                       El::Orientation::TRANSPOSE, El::UnitOrNonUnit::NON_UNIT,
+                       El::BigFloat(1), L, product);
+              El::Trmm(El::LeftOrRight::LEFT, El::UpperOrLowerNS::LOWER,
+                       El::Orientation::NORMAL, El::UnitOrNonUnit::NON_UNIT,
+                       El::BigFloat(1), L, product);
+              El::Axpy(El::BigFloat(-1), product, residual_x.blocks[block]);
+            }
+          const Column_Ranges &B_columns(sdp.free_var_columns[block]);
+          column_ranges_gemv(El::Orientation::NORMAL, El::BigFloat(1), B,
+                             B_columns, dy, El::BigFloat(1),
+                             residual_x.blocks[block]);
+          column_ranges_gemv(El::Orientation::TRANSPOSE, El::BigFloat(-1), B,
+                             B_columns, dx.blocks[block], El::BigFloat(1),
+                             residual_y);
+        }
+
+      const El::BigFloat norm(max_abs(residual_x, residual_y));
+      if(norm <= tolerance || norm * 2 > previous_norm)
+        {
+          break;
+        }
+      previous_norm = norm;
+
+      solve_schur_complement_equation(schur_complement_cholesky,
+                                      schur_off_diagonal, sdp.free_var_matrix,
+                                      sdp.free_var_columns, Q, dy_reduction,
+                                      residual_x, residual_y);
+      for(size_t block = 0; block < dx.blocks.size(); ++block)
+        {
+          dx.blocks[block] += residual_x.blocks[block];
+        }
+      dy += residual_y;
+    }
+}
@@ -1,87 +1,150 @@
 #include "lower_triangular_solve.hxx"
 #include "../../../../SDP_Solver.hxx"
 #include "../../../../lower_triangular_transpose_solve.hxx"
+#include "../../../../Q_Column_Reduction.hxx"
+#include "../../../../Column_Ranges.hxx"
+#include "../../../../../solver_comm.hxx"
 
 // Solve the Schur complement equation for dx, dy.
 //
 // - As inputs, dx and dy are the residues r_x and r_y on the
-//   right-hand side of the Schur complement equation.
+//   right-hand side of the Schur complement equation.  dy is this
+//   rank's contribution to r_y.
 // - As outputs, dx and dy are overwritten with the solutions of the
-//   Schur complement equation.
+//   Schur complement equation.  Every rank gets all of dy.
 //
 // The equation is solved using the block-decomposition described in
-// the manual.
+// the manual.  The contributions of the ranks to dy are summed into
+// Q's distribution with dy_reduction.
+//
+// With memoryMode=low, SchurOffDiagonal = L'^{-1} FreeVarMatrix has
+// been freed.  Its products are then computed from FreeVarMatrix
+// with an extra triangular solve each.
+//
+// Both only have nonzero elements in free_var_columns, so the
+// products skip the other columns.
 //
 void solve_schur_complement_equation(
   const Block_Diagonal_Matrix &schur_complement_cholesky,
-  const Block_Matrix &schur_off_diagonal,
-  const El::DistMatrix<El::BigFloat> &Q, Block_Vector &dx, Block_Vector &dy)
+  const Block_Matrix &schur_off_diagonal, const Block_Matrix &free_var_matrix,
+  const std::vector<Column_Ranges> &free_var_columns,
+  const El::DistMatrix<El::BigFloat> &Q, Q_Column_Reduction &dy_reduction,
+  Block_Vector &dx, El::DistMatrix<El::BigFloat> &dy)
 {
+  const bool is_off_diagonal_released(schur_off_diagonal.blocks.size()
+                                      != dx.blocks.size());
+
   // Set dx to SchurComplementCholesky^{-1} dx
   lower_triangular_solve(schur_complement_cholesky, dx);
+  // SchurOffDiagonal^T dx = FreeVarMatrix^T L'^{-T} dx
+  Block_Vector product;
+  if(is_off_diagonal_released)
+    {
+      product = dx;
+      lower_triangular_transpose_solve(schur_complement_cholesky, product);
+    }
 
-  El::DistMatrix<El::BigFloat> dy_dist;
+  // If Q is replicated on every rank (a Grid of size 1), dy_dist is
+  // replicated as well.
+  El::DistMatrix<El::BigFloat> dy_dist(Q.Grid());
   Zeros(dy_dist, Q.Height(), 1);
   {
-    El::Matrix<El::BigFloat> dy_sum;
-    Zeros(dy_sum, Q.Height(), 1);
+    El::Matrix<El::BigFloat> &dy_sum(dy_reduction.zeroed_sum());
 
-    for(size_t block = 0; block < schur_off_diagonal.blocks.size(); ++block)
+    for(size_t block = 0; block < dx.blocks.size(); ++block)
       {
-        Gemv(El::OrientationNS::TRANSPOSE, El::BigFloat(-1),
-             schur_off_diagonal.blocks[block], dx.blocks[block],
-             El::BigFloat(1), dy.blocks[block]);
+        if(is_off_diagonal_released)
+          {
+            column_ranges_gemv(El::OrientationNS::TRANSPOSE,
+                               El::BigFloat(-1), free_var_matrix.blocks[block],
+                               free_var_columns[block], product.blocks[block],
+                               El::BigFloat(1), dy);
+          }
+        else
+          {
+            column_ranges_gemv(
+              El::OrientationNS::TRANSPOSE, El::BigFloat(-1),
+              schur_off_diagonal.blocks[block], free_var_columns[block],
+              dx.blocks[block], El::BigFloat(1), dy);
+          }
+      }
 
-        // Locally sum contributions to dy
-        for(int64_t row = 0; row < dy.blocks[block].LocalHeight(); ++row)
+    // Locally sum contributions to dy
+    for(int64_t row = 0; row < dy.LocalHeight(); ++row)
+      {
+        int64_t global_row(dy.GlobalRow(row));
+        for(int64_t column = 0; column < dy.LocalWidth(); ++column)
           {
-            int64_t global_row(dy.blocks[block].GlobalRow(row));
-            for(int64_t column = 0; column < dy.blocks[block].LocalWidth();
-                ++column)
-              {
-                int64_t global_column(dy.blocks[block].GlobalCol(column));
-                dy_sum(global_row, global_column)
-                  += dy.blocks[block].GetLocal(row, column);
-              }
+            int64_t global_column(dy.GlobalCol(column));
+            dy_sum(global_row, global_column) += dy.GetLocal(row, column);
           }
       }
 
-    // Send out updates for dy
-    El::BigFloat zero(0);
-    for(int64_t row = 0; row < dy_sum.Height(); ++row)
-      for(int64_t column = 0; column < dy_sum.Width(); ++column)
-        {
-          if(dy_sum(row, column)!=zero)
-            {
-              dy_dist.QueueUpdate(row, column, dy_sum(row, column));
-            }
-        }
+    if(Q.Grid().Size() == 1)
+      {
+        El::AllReduce(dy_sum, solver_comm());
+        dy_dist.Matrix() = dy_sum;
+      }
+    else
+      {
+        dy_reduction.reduce_scatter(dy_dist);
+      }
   }
-  dy_dist.ProcessQueues();
 
-  // Set dy_dist to Q^{-1} dy_dist
-  El::cholesky::SolveAfter(El::UpperOrLowerNS::UPPER,
-                           El::OrientationNS::NORMAL, Q, dy_dist);
-  El::DistMatrix<El::BigFloat, El::STAR, El::STAR> dy_local(dy_dist);
+  // Set dy_dist to Q^{-1} dy_dist.  If Q's grid is smaller than
+  // solver_comm(), only its ranks solve, and rank 0, which is always
+  // one of them, broadcasts the solution to the others.
+  El::Matrix<El::BigFloat> dy_local;
+  El::Zeros(dy_local, Q.Height(), 1);
+  if(Q.Grid().InGrid())
+    {
+      El::cholesky::SolveAfter(El::UpperOrLowerNS::UPPER,
+                               El::OrientationNS::NORMAL, Q, dy_dist);
+      // A single AllGather of the solution
+      El::DistMatrix<El::BigFloat, El::STAR, El::STAR> dy_star(dy_dist);
+      dy_local = dy_star.LockedMatrix();
+    }
+  if(Q.Grid().Size() != 1
+     && Q.Grid().Size() != El::mpi::Size(solver_comm()))
+    {
+      El::Broadcast(dy_local, solver_comm(), 0);
+    }
 
-  // dx += SchurOffDiagonal dy
-  for(size_t block = 0; block < schur_off_diagonal.blocks.size(); ++block)
+  for(int64_t row = 0; row < dy.LocalHeight(); ++row)
     {
-      for(int64_t row = 0; row < dy.blocks[block].LocalHeight(); ++row)
+      int64_t global_row(dy.GlobalRow(row));
+      for(int64_t column = 0; column < dy.LocalWidth(); ++column)
         {
-          int64_t global_row(dy.blocks[block].GlobalRow(row));
+          int64_t global_column(dy.GlobalCol(column));
+          dy.SetLocal(row, column, dy_local(global_row, global_column));
+        }
+    }
 
-          for(int64_t column = 0; column < dy.blocks[block].LocalWidth();
-              ++column)
-            {
-              int64_t global_column(dy.blocks[block].GlobalCol(column));
-              dy.blocks[block].SetLocal(
-                row, column, dy_local.GetLocal(global_row, global_column));
-            }
+  // dx += SchurOffDiagonal dy
+  if(is_off_diagonal_released)
+    {
+      for(size_t block = 0; block < dx.blocks.size(); ++block)
+        {
+          column_ranges_gemv(El::OrientationNS::NORMAL, El::BigFloat(1),
+                             free_var_matrix.blocks[block],
+                             free_var_columns[block], dy, El::BigFloat(0),
+                             product.blocks[block]);
+        }
+      lower_triangular_solve(schur_complement_cholesky, product);
+      for(size_t block = 0; block < dx.blocks.size(); ++block)
+        {
+          dx.blocks[block] += product.blocks[block];
+        }
+    }
+  else
+    {
+      for(size_t block = 0; block < dx.blocks.size(); ++block)
+        {
+          column_ranges_gemv(El::OrientationNS::NORMAL, El::BigFloat(1),
+                             schur_off_diagonal.blocks[block],
+                             free_var_columns[block], dy, El::BigFloat(1),
+                             dx.blocks[block]);
         }
-      Gemv(El::OrientationNS::NORMAL, El::BigFloat(1),
-           schur_off_diagonal.blocks[block], dy.blocks[block], El::BigFloat(1),
-           dx.blocks[block]);
     }
 
   // dx = SchurComplementCholesky^{-T} dx
@@ -1,4 +1,5 @@
 #include "../../../../SDP_Solver.hxx"
+#include "../../../../Step_Controller.hxx"
 #include "../../../../../../Timers.hxx"
 
 // (X + dX) . (Y + dY), where X, dX, Y, dY are symmetric
@@ -11,7 +12,7 @@ El::BigFloat frobenius_product_of_sums(const Block_Diagonal_Matrix &X,
 
 // Centering parameter \beta_c for the corrector step
 El::BigFloat corrector_centering_parameter(
-  const SDP_Solver_Parameters &parameters, const Block_Diagonal_Matrix &X,
+  const Step_Controller &step_controller, const Block_Diagonal_Matrix &X,
   const Block_Diagonal_Matrix &dX, const Block_Diagonal_Matrix &Y,
   const Block_Diagonal_Matrix &dY, const El::BigFloat &mu,
   const bool is_primal_dual_feasible, const size_t &total_psd_rows)
@@ -22,11 +23,11 @@ El::BigFloat corrector_centering_parameter(
 
   if(is_primal_dual_feasible)
     {
-      return Min(Max(parameters.feasible_centering_parameter, beta),
+      return Min(Max(step_controller.feasible_centering_parameter, beta),
                  El::BigFloat(1));
     }
   else
     {
-      return Max(parameters.infeasible_centering_parameter, beta);
+      return Max(step_controller.infeasible_centering_parameter, beta);
     }
 }
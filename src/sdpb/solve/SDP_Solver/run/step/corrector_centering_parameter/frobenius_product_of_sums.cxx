@@ -1,31 +1,36 @@
 #include "../../../../Block_Diagonal_Matrix.hxx"
+#include "../../../../../solver_comm.hxx"
 
 // (X + dX) . (Y + dY), where X, dX, Y, dY are symmetric
 // BlockDiagonalMatrices and '.' is the Frobenius product.
 //
+// All four matrices have the same block sizes and grids, so the local
+// pieces of each block line up element by element.  Summing the
+// products of the local sums directly avoids building X + dX and Y +
+// dY for every block.  Every element lives on exactly one rank, so a
+// single sum over all ranks gives the result.
 El::BigFloat frobenius_product_of_sums(const Block_Diagonal_Matrix &X,
                                        const Block_Diagonal_Matrix &dX,
                                        const Block_Diagonal_Matrix &Y,
                                        const Block_Diagonal_Matrix &dY)
 {
-  El::BigFloat local_sum(0);
+  El::BigFloat local_sum(0), X_dX, Y_dY;
   for(size_t b = 0; b < X.blocks.size(); b++)
     {
-      // FIXME: This can be sped up by not have intermediate results.
-      // It may require looking into the implementation of Dotu.
-      El::DistMatrix<El::BigFloat> X_dX(X.blocks[b]);
-      X_dX += dX.blocks[b];
-      El::DistMatrix<El::BigFloat> Y_dY(Y.blocks[b]);
-      Y_dY += dY.blocks[b];
-      local_sum += Dotu(X_dX, Y_dY);
+      const El::Matrix<El::BigFloat> &X_local(X.blocks[b].LockedMatrix()),
+        &dX_local(dX.blocks[b].LockedMatrix()),
+        &Y_local(Y.blocks[b].LockedMatrix()),
+        &dY_local(dY.blocks[b].LockedMatrix());
+      for(int64_t column = 0; column < X_local.Width(); ++column)
+        for(int64_t row = 0; row < X_local.Height(); ++row)
+          {
+            X_dX = X_local(row, column);
+            X_dX += dX_local(row, column);
+            Y_dY = Y_local(row, column);
+            Y_dY += dY_local(row, column);
+            X_dX *= Y_dY;
+            local_sum += X_dX;
+          }
     }
-
-  // Make sure not to double count if blocks are distributed over more
-  // than one processor.  We could also divide the sum by
-  // X.blocks.front().Size().
-  if(!X.blocks.empty() && X.blocks.front().Grid().Rank() != 0)
-    {
-      local_sum = 0;
-    }
-  return El::mpi::AllReduce(local_sum, El::mpi::COMM_WORLD);
+  return El::mpi::AllReduce(local_sum, solver_comm());
 }
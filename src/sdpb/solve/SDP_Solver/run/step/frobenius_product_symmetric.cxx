@@ -1,20 +1,26 @@
 #include "../../../Block_Diagonal_Matrix.hxx"
+#include "../../../../solver_comm.hxx"
 
 // Tr(A B), where A and B are symmetric
+//
+// As in frobenius_product_of_sums(), the local pieces of A and B line
+// up, so this sums over the local elements and reduces once over all
+// ranks instead of once per block.
 El::BigFloat frobenius_product_symmetric(const Block_Diagonal_Matrix &A,
                                          const Block_Diagonal_Matrix &B)
 {
-  El::BigFloat local_sum(0);
+  El::BigFloat local_sum(0), product;
   for(size_t b = 0; b < A.blocks.size(); b++)
     {
-      local_sum += El::Dotu(A.blocks[b], B.blocks[b]);
+      const El::Matrix<El::BigFloat> &A_local(A.blocks[b].LockedMatrix()),
+        &B_local(B.blocks[b].LockedMatrix());
+      for(int64_t column = 0; column < A_local.Width(); ++column)
+        for(int64_t row = 0; row < A_local.Height(); ++row)
+          {
+            product = A_local(row, column);
+            product *= B_local(row, column);
+            local_sum += product;
+          }
     }
-  // Make sure not to double count if blocks are distributed over more
-  // than one processor.  We could also divide the sum by
-  // X.blocks.front().Size().
-  if(!A.blocks.empty() && A.blocks.front().Grid().Rank() != 0)
-    {
-      local_sum = 0;
-    }
-  return El::mpi::AllReduce(local_sum, El::mpi::COMM_WORLD);
+  return El::mpi::AllReduce(local_sum, solver_comm());
 }
@@ -1,6 +1,12 @@
 #include "../../../../Block_Diagonal_Matrix.hxx"
 #include "../../../../../Block_Info.hxx"
 #include "../../../../../../Timers.hxx"
+#include "../../../../../../parallel_for.hxx"
+#include "../../../../../Matrix_Backend.hxx"
+#include "../../../../../fixed_point.hxx"
+
+#include <atomic>
+#include <chrono>
 
 // Compute the SchurComplement matrix using BilinearPairingsXInv and
 // BilinearPairingsY and the formula
@@ -11,50 +17,200 @@
 //                 swaps (r1 <-> s1) and (r2 <-> s2))
 //
 // where ej = d_j + 1.
+//
+// S is symmetric, so we only compute the lower triangle.  S is
+// written directly into the storage for its Cholesky decomposition,
+// which only reads and writes the lower triangle, so the upper
+// triangle is left as zero.  The bilinear pairings are much
+// smaller than S, so we replicate them on every rank of the block's
+// grid.  Then each rank computes its own local elements of S directly,
+// without any intermediate transposes or temporary matrices.  With
+// threadsPerProc > 1, the local columns of all of the blocks are
+// shared among threads.
+//
+// Most blocks have m_j = 1.  Then r1 = s1 = r2 = s2 = 0, and the four
+// terms above are equal, so
+//
+//   S_{k1, k2} = \sum_{b \in blocks[j]}
+//          BilinearPairingsXInv_{k1, k2} * BilinearPairingsY_{k2, k1}
+//
+// That case is handled by a separate instantiation of the column
+// kernel, without the pair offsets or the extra products.
+//
+// With the fixedpoint backend, the (at most 8) products for an element
+// are summed in a Fixed_Point_Accumulator at the precision of S, and
+// only the sum is rounded.
 
 namespace
 {
-  // Elementwise multiplication of two submatrices.
-  //
-  // result(i,j)=(bilinear_X_inv(column_offset_X+i,row_offset_X+j)
-  //              * bilinear_Y_inv(column_offset_Y+i,row_offset_Y+j))/4
+  // Offsets (row_block*ej, column_block*ej) of the
+  // (column_block*(column_block+1))/2 + row_block'th pair
+  // 0 <= row_block <= column_block < m_j
+  std::vector<std::pair<size_t, size_t>>
+  pair_offsets(const size_t &dimension, const size_t &block_size)
+  {
+    std::vector<std::pair<size_t, size_t>> result;
+    result.reserve((dimension * (dimension + 1)) / 2);
+    for(size_t column_block = 0; column_block < dimension; ++column_block)
+      for(size_t row_block = 0; row_block <= column_block; ++row_block)
+        {
+          result.emplace_back(row_block * block_size,
+                              column_block * block_size);
+        }
+    return result;
+  }
 
-  void
-  multiply_submatrices(const El::DistMatrix<El::BigFloat> &bilinear_X_inv,
-                       const El::DistMatrix<El::BigFloat> &bilinear_Y,
-                       const size_t &block_size, const size_t &column_offset_X,
-                       const size_t &row_offset_X,
-                       const size_t &column_offset_Y,
-                       const size_t &row_offset_Y,
-                       El::DistMatrix<El::BigFloat> &temp,
-                       El::DistMatrix<El::BigFloat> &result_submatrix)
+  // element += X(row_X, column_X) * Y(row_Y, column_Y)
+  inline void
+  add_product(const El::Matrix<El::BigFloat> &X, const size_t &row_X,
+              const size_t &column_X, const El::Matrix<El::BigFloat> &Y,
+              const size_t &row_Y, const size_t &column_Y,
+              El::BigFloat &product, El::BigFloat &element)
   {
-    El::DistMatrix<El::BigFloat> X_submatrix(El::LockedView(
-      bilinear_X_inv, column_offset_X, row_offset_X, block_size, block_size)),
-      Y_submatrix(El::LockedView(bilinear_Y, column_offset_Y, row_offset_Y,
-                                 block_size, block_size)),
-      Y_transpose(block_size, block_size, bilinear_Y.Grid());
+    product = X(row_X, column_X);
+    product *= Y(row_Y, column_Y);
+    element += product;
+  }
 
-    // The overall result is symmetric, but this particular block may
-    // not be because it is offset from the diagonal.
+  // The factors of the products for one element of S
+  struct Schur_Terms
+  {
+    std::array<std::pair<mpf_srcptr, mpf_srcptr>, 8> factors;
+    size_t size = 0;
 
-    // It does not help to use TransposeAxpy().  Hadamard() sets the
-    // result, it does not add it in.
-    El::Transpose(Y_submatrix, Y_transpose);
-    if(X_submatrix.ColAlign() == Y_transpose.ColAlign()
-       && X_submatrix.RowAlign() == Y_transpose.RowAlign())
-      {
-        El::Hadamard(X_submatrix, Y_transpose, temp);
-      }
-    else
+    void add(const El::Matrix<El::BigFloat> &X, const size_t &row_X,
+             const size_t &column_X, const El::Matrix<El::BigFloat> &Y,
+             const size_t &row_Y, const size_t &column_Y)
+    {
+      factors[size].first = X(row_X, column_X).gmp_float.get_mpf_t();
+      factors[size].second = Y(row_Y, column_Y).gmp_float.get_mpf_t();
+      ++size;
+    }
+
+    // element = sum of the products, rounded once
+    void sum(Fixed_Point_Accumulator &accumulator, El::BigFloat &element)
+    {
+      mpf_ptr result(element.gmp_float.get_mpf_t());
+      bool is_zero(true);
+      mp_exp_t top(0);
+      for(size_t term = 0; term < size; ++term)
+        {
+          if(factors[term].first->_mp_size != 0
+             && factors[term].second->_mp_size != 0)
+            {
+              const mp_exp_t exponent(factors[term].first->_mp_exp
+                                      + factors[term].second->_mp_exp);
+              top = is_zero ? exponent : std::max(top, exponent);
+              is_zero = false;
+            }
+        }
+      if(is_zero)
+        {
+          mpf_set_ui(result, 0);
+        }
+      else
+        {
+          accumulator.reset(
+            top, Fixed_Point_Accumulator::precision_limbs(result));
+          for(size_t term = 0; term < size; ++term)
+            {
+              accumulator.add_product(factors[term].first,
+                                      factors[term].second);
+            }
+          accumulator.get(result);
+        }
+      size = 0;
+    }
+  };
+
+  // Compute local column 'column' of a block of S.  X_inv and Y hold
+  // the replicated bilinear pairings for both parities.  The products
+  // are computed at the block's precision and summed at the precision
+  // of S.  If accumulator is not null, the products are instead summed
+  // exactly at the precision of S.
+  template <bool is_scalar_block>
+  void compute_schur_column(
+    const int64_t &column, const size_t &block_size,
+    const mp_bitcnt_t &precision, Fixed_Point_Accumulator *accumulator,
+    const std::vector<std::pair<size_t, size_t>> &offsets,
+    const std::array<const El::Matrix<El::BigFloat> *, 2> &X_inv,
+    const std::array<const El::Matrix<El::BigFloat> *, 2> &Y,
+    El::DistMatrix<El::BigFloat> &schur_complement_block)
+  {
+    const El::BigFloat quarter(0.25);
+    El::BigFloat product;
+    product.gmp_float.set_prec(precision);
+    El::Matrix<El::BigFloat> &result(schur_complement_block.Matrix());
+    Schur_Terms terms;
+    El::BigFloat *current(nullptr);
+    auto add = [&](const El::Matrix<El::BigFloat> &X, const size_t &row_X,
+                   const size_t &column_X, const El::Matrix<El::BigFloat> &Y,
+                   const size_t &row_Y, const size_t &column_Y) {
+      if(accumulator != nullptr)
+        {
+          terms.add(X, row_X, column_X, Y, row_Y, column_Y);
+        }
+      else
+        {
+          add_product(X, row_X, column_X, Y, row_Y, column_Y, product,
+                      *current);
+        }
+    };
+
+    const size_t global_column(schur_complement_block.GlobalCol(column));
+    const size_t k2(global_column % block_size);
+    const size_t row_offset_1(
+      is_scalar_block ? k2 : offsets[global_column / block_size].first + k2),
+      column_offset_1(is_scalar_block
+                        ? k2
+                        : offsets[global_column / block_size].second + k2);
+
+    for(int64_t row = 0; row < schur_complement_block.LocalHeight(); ++row)
       {
-        El::DistMatrix<El::BigFloat> Y_transpose_aligned(
-          block_size, block_size, Y_transpose.Grid());
-        Y_transpose_aligned.AlignWith(X_submatrix);
-        El::Copy(Y_transpose, Y_transpose_aligned);
-        El::Hadamard(X_submatrix, Y_transpose_aligned, temp);
+        El::BigFloat &element(result(row, column));
+        element = 0;
+        current = &element;
+        const size_t global_row(schur_complement_block.GlobalRow(row));
+        if(global_row < global_column)
+          {
+            continue;
+          }
+        if(is_scalar_block)
+          {
+            for(size_t parity = 0; parity < 2; ++parity)
+              {
+                add(*X_inv[parity], global_row, global_column, *Y[parity],
+                    global_column, global_row);
+              }
+            if(accumulator != nullptr)
+              {
+                terms.sum(*accumulator, element);
+              }
+            continue;
+          }
+        const size_t k1(global_row % block_size);
+        const size_t row_offset_0(offsets[global_row / block_size].first + k1),
+          column_offset_0(offsets[global_row / block_size].second + k1);
+
+        for(size_t parity = 0; parity < 2; ++parity)
+          {
+            const El::Matrix<El::BigFloat> &X(*X_inv[parity]),
+              &Y_parity(*Y[parity]);
+            add(X, column_offset_0, row_offset_1, Y_parity, column_offset_1,
+                row_offset_0);
+            add(X, row_offset_0, row_offset_1, Y_parity, column_offset_1,
+                column_offset_0);
+            add(X, column_offset_0, column_offset_1, Y_parity, row_offset_1,
+                row_offset_0);
+            add(X, row_offset_0, column_offset_1, Y_parity, row_offset_1,
+                column_offset_0);
+          }
+        if(accumulator != nullptr)
+          {
+            terms.sum(*accumulator, element);
+          }
+        element *= quarter;
       }
-    Axpy(El::BigFloat(0.25), temp, result_submatrix);
   }
 }
 
@@ -62,88 +218,88 @@ void compute_schur_complement(
   const Block_Info &block_info,
   const Block_Diagonal_Matrix &bilinear_pairings_X_inv,
   const Block_Diagonal_Matrix &bilinear_pairings_Y,
+  const Matrix_Backend &matrix_backend, const size_t &num_threads,
   Block_Diagonal_Matrix &schur_complement, Timers &timers)
 {
   auto &schur_complement_timer(timers.add_and_start(
     "run.step.initializeSchurComplementSolver.schur_complement"));
 
-  auto schur_complement_block(schur_complement.blocks.begin());
-  auto bilinear_pairings_X_inv_block(bilinear_pairings_X_inv.blocks.begin());
-  auto bilinear_pairings_Y_block(bilinear_pairings_Y.blocks.begin());
-  for(auto &block_index : block_info.block_indices)
+  // Replicating the bilinear pairings communicates, so do that for
+  // all of the blocks first.  The rest is purely local, and is split
+  // among threads by local column of S over all of the blocks.
+  const size_t num_blocks(block_info.block_indices.size());
+  std::vector<std::vector<std::pair<size_t, size_t>>> block_offsets;
+  std::vector<El::DistMatrix<El::BigFloat, El::STAR, El::STAR>> X_inv_star,
+    Y_star;
+  block_offsets.reserve(num_blocks);
+  X_inv_star.reserve(2 * num_blocks);
+  Y_star.reserve(2 * num_blocks);
+  std::vector<std::pair<size_t, int64_t>> work_items;
+  for(size_t block = 0; block < num_blocks; ++block)
     {
-      const size_t block_size(block_info.degrees[block_index] + 1);
-
-      for(size_t column_block_0 = 0;
-          column_block_0 < block_info.dimensions[block_index];
-          ++column_block_0)
+      const size_t block_index(block_info.block_indices[block]);
+      block_offsets.emplace_back(
+        pair_offsets(block_info.dimensions[block_index],
+                     block_info.degrees[block_index] + 1));
+      for(size_t parity = 0; parity < 2; ++parity)
         {
-          const size_t column_offset_0(column_block_0 * block_size);
-          for(size_t row_block_0 = 0; row_block_0 <= column_block_0;
-              ++row_block_0)
-            {
-              const size_t row_offset_0(row_block_0 * block_size);
-              size_t result_row_offset(
-                ((column_block_0 * (column_block_0 + 1)) / 2 + row_block_0)
-                * block_size);
-
-              for(size_t column_block_1 = 0;
-                  column_block_1 < block_info.dimensions[block_index];
-                  ++column_block_1)
-                {
-                  const size_t column_offset_1(column_block_1 * block_size);
-                  for(size_t row_block_1 = 0; row_block_1 <= column_block_1;
-                      ++row_block_1)
-                    {
-                      const size_t row_offset_1(row_block_1 * block_size);
-                      size_t result_column_offset(
-                        ((column_block_1 * (column_block_1 + 1)) / 2
-                         + row_block_1)
-                        * block_size);
-
-                      El::DistMatrix<El::BigFloat> result_sub_matrix(El::View(
-                        *schur_complement_block, result_row_offset,
-                        result_column_offset, block_size, block_size));
-                      Zero(result_sub_matrix);
-
-                      El::DistMatrix<El::BigFloat> temp(
-                        block_size, block_size, result_sub_matrix.Grid());
-
-                      auto bilinear_X_inv(bilinear_pairings_X_inv_block);
-                      auto bilinear_Y(bilinear_pairings_Y_block);
-                      for(size_t bb(2 * block_index); bb < 2 * block_index + 2;
-                          ++bb)
-                        {
-                          multiply_submatrices(
-                            *bilinear_X_inv, *bilinear_Y, block_size,
-                            column_offset_0, row_offset_1, column_offset_1,
-                            row_offset_0, temp, result_sub_matrix);
-                          multiply_submatrices(
-                            *bilinear_X_inv, *bilinear_Y, block_size,
-                            row_offset_0, row_offset_1, column_offset_1,
-                            column_offset_0, temp, result_sub_matrix);
-                          multiply_submatrices(
-                            *bilinear_X_inv, *bilinear_Y, block_size,
-                            column_offset_0, column_offset_1, row_offset_1,
-                            row_offset_0, temp, result_sub_matrix);
-                          multiply_submatrices(
-                            *bilinear_X_inv, *bilinear_Y, block_size,
-                            row_offset_0, column_offset_1, row_offset_1,
-                            column_offset_0, temp, result_sub_matrix);
-                          ++bilinear_X_inv;
-                          ++bilinear_Y;
-                        }
-                    }
-                }
-            }
+          X_inv_star.emplace_back(
+            bilinear_pairings_X_inv.blocks[2 * block + parity]);
+          Y_star.emplace_back(bilinear_pairings_Y.blocks[2 * block + parity]);
         }
+      for(int64_t column = 0;
+          column < schur_complement.blocks[block].LocalWidth(); ++column)
+        {
+          work_items.emplace_back(block, column);
+        }
+    }
 
-      El::MakeSymmetric(El::UpperOrLower::LOWER, *schur_complement_block);
-      ++schur_complement_block;
-      ++bilinear_pairings_X_inv_block;
-      ++bilinear_pairings_X_inv_block;
-      ++bilinear_pairings_Y_block;
-      ++bilinear_pairings_Y_block;
+  // The time spent on each block, for block_timings.
+  std::vector<std::atomic<int64_t>> block_nanoseconds(num_blocks);
+  for(auto &nanoseconds : block_nanoseconds)
+    {
+      nanoseconds = 0;
+    }
+  parallel_for(num_threads, work_items.size(), [&](const size_t &item) {
+    const auto item_start(std::chrono::high_resolution_clock::now());
+    const size_t block(work_items[item].first);
+    const size_t block_index(block_info.block_indices[block]);
+    Fixed_Point_Accumulator fixed_point_accumulator;
+    Fixed_Point_Accumulator *accumulator(
+      matrix_backend == Matrix_Backend::fixed_point ? &fixed_point_accumulator
+                                                    : nullptr);
+    const std::array<const El::Matrix<El::BigFloat> *, 2> X_inv_local(
+      {&X_inv_star[2 * block].LockedMatrix(),
+       &X_inv_star[2 * block + 1].LockedMatrix()}),
+      Y_local({&Y_star[2 * block].LockedMatrix(),
+               &Y_star[2 * block + 1].LockedMatrix()});
+    if(block_info.dimensions[block_index] == 1)
+      {
+        compute_schur_column<true>(
+          work_items[item].second, block_info.degrees[block_index] + 1,
+          block_info.block_precision(block_index), accumulator,
+          block_offsets[block],
+          X_inv_local, Y_local, schur_complement.blocks[block]);
+      }
+    else
+      {
+        compute_schur_column<false>(
+          work_items[item].second, block_info.degrees[block_index] + 1,
+          block_info.block_precision(block_index), accumulator,
+          block_offsets[block],
+          X_inv_local, Y_local, schur_complement.blocks[block]);
+      }
+    block_nanoseconds[block]
+      += std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::high_resolution_clock::now() - item_start)
+           .count();
+  });
+  for(size_t block = 0; block < num_blocks; ++block)
+    {
+      timers.add_elapsed(
+        "run.step.initializeSchurComplementSolver.schur_complement_"
+          + std::to_string(block_info.block_indices[block]),
+        std::chrono::nanoseconds(block_nanoseconds[block]));
     }
   schur_complement_timer.stop();
 }
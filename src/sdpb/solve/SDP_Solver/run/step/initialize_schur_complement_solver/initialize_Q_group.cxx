@@ -1,73 +1,232 @@
-#include "../../../../SDP.hxx"
-#include "../../../../Block_Diagonal_Matrix.hxx"
+#include "../../../../Block_Matrix.hxx"
+#include "../../../../Column_Ranges.hxx"
+#include "../../../../Packed_Upper_Matrix.hxx"
+#include "../../../../block_kernels.hxx"
+#include "../../../../../Block_Info.hxx"
 #include "../../../../../../Timers.hxx"
+#include "../../../../../Matrix_Backend.hxx"
+#include "../../../../../mpmat.hxx"
+#include "../../../../../fixed_point.hxx"
 
-void initialize_Q_group(const SDP &sdp, const Block_Info &block_info,
-                        const Block_Diagonal_Matrix &schur_complement,
-                        Block_Matrix &schur_off_diagonal,
-                        Block_Diagonal_Matrix &schur_complement_cholesky,
-                        El::DistMatrix<El::BigFloat> &Q_group, Timers &timers)
+#include <cmath>
+
+// Compute this group's contribution to
+//
+//   Q = (L'^{-1} B')^T (L'^{-1} B') - {{0, 0}, {0, 1}}
+//
+// Where B' = (B U).  We think of Q as containing four blocks
+// called Upper/Lower-Left/Right.  Only the upper triangle is
+// computed, and Q_group only stores the upper triangle.
+//
+// To avoid a dense N x N temporary, the columns are split into panels
+// with roughly the same number of elements in the upper triangle.
+// For the columns [column_begin, column_end) in a panel, the rows
+// above the diagonal square come from a Gemm and the diagonal square
+// comes from a Syrk.  The panel is then added into Q_group.
+//
+// Every block is visited once per panel.  The time for each block is
+// summed over the panels and recorded as a single syrk timer, which
+// is what the load balancer reads.
+//
+// On a single process grid, consecutive small blocks are batched.
+// Since
+//
+//   \sum_b B_b^T B_b = (B_0; B_1; ...)^T (B_0; B_1; ...)
+//
+// the blocks in a batch are stacked vertically in a reused buffer and
+// multiplied with one Gemm and one Syrk, so the setup cost of those
+// calls is paid once per batch instead of once per block.  The time
+// for a batch is split among its blocks in proportion to their
+// heights, which is how the cost of the products scales.
+//
+// The columns of a block that are zero contribute nothing, so the
+// products are split into the sub-blocks that for_each_upper_product()
+// finds for the nonzero columns of the batch.
+
+namespace
 {
-  // Explicitly deallocate the lower half of Q_group.  This
-  // significantly reduces the total amount of memory required.
-  El::Matrix<El::BigFloat> &local(Q_group.Matrix());
-  for(int64_t row = 0; row < Q_group.Height(); ++row)
-    for(int64_t column = 0; column < row; ++column)
+  // Stack blocks until the batch has this many rows.
+  const int64_t max_batch_height(256);
+
+  struct Batch
+  {
+    size_t block_begin, block_end;
+    int64_t height;
+    Column_Ranges columns;
+  };
+
+  std::vector<Batch> make_batches(const Block_Matrix &schur_off_diagonal,
+                                  const std::vector<Column_Ranges> &columns,
+                                  const bool &is_single_process_grid)
+  {
+    std::vector<Batch> result;
+    for(size_t block = 0; block < schur_off_diagonal.blocks.size(); ++block)
       {
-        if(Q_group.IsLocal(row, column))
+        const int64_t height(schur_off_diagonal.blocks[block].Height());
+        if(is_single_process_grid && !result.empty()
+           && result.back().height + height <= max_batch_height)
           {
-            mpf_clear(local(Q_group.LocalRow(row), Q_group.LocalCol(column))
-                        .gmp_float.get_mpf_t());
-            local(Q_group.LocalRow(row), Q_group.LocalCol(column))
-              .gmp_float.get_mpf_t()[0]
-              ._mp_d
-              = nullptr;
+            result.back().block_end = block + 1;
+            result.back().height += height;
+            result.back().columns
+              = merge_column_ranges(result.back().columns, columns[block]);
+          }
+        else
+          {
+            result.push_back({block, block + 1, height, columns[block]});
           }
       }
+    return result;
+  }
+}
 
-  schur_off_diagonal.blocks.clear();
-  schur_off_diagonal.blocks.reserve(schur_complement_cholesky.blocks.size());
-
-  for(size_t block = 0; block < schur_complement_cholesky.blocks.size();
-      block++)
-    {
-      auto &cholesky_timer(timers.add_and_start(
-        "run.step.initializeSchurComplementSolver.Q.cholesky_"
-        + std::to_string(block_info.block_indices[block])));
-      schur_complement_cholesky.blocks[block] = schur_complement.blocks[block];
-      Cholesky(El::UpperOrLowerNS::LOWER,
-               schur_complement_cholesky.blocks[block]);
-      cholesky_timer.stop();
+void initialize_Q_group(const Block_Info &block_info,
+                        const Matrix_Backend &matrix_backend,
+                        const Block_Matrix &schur_off_diagonal,
+                        const std::vector<Column_Ranges> &columns,
+                        Packed_Upper_Matrix &Q_group, Timers &timers)
+{
+  Q_group.Zero();
 
-      // SchurOffDiagonal = L'^{-1} FreeVarMatrix
-      auto &solve_timer(timers.add_and_start(
-        "run.step.initializeSchurComplementSolver.Q.solve_"
-        + std::to_string(block_info.block_indices[block])));
+  const int64_t N(Q_group.Width()), grid_width(Q_group.Grid().Width());
+  const int64_t num_panels(std::max(std::min(N / grid_width, int64_t(8)),
+                                    int64_t(1)));
 
-      schur_off_diagonal.blocks.push_back(sdp.free_var_matrix.blocks[block]);
-      El::Trsm(El::LeftOrRightNS::LEFT, El::UpperOrLowerNS::LOWER,
-               El::OrientationNS::NORMAL, El::UnitOrNonUnitNS::NON_UNIT,
-               El::BigFloat(1), schur_complement_cholesky.blocks[block],
-               schur_off_diagonal.blocks[block]);
+  // Panel boundaries must be multiples of the grid width, so that the
+  // panels line up with the distribution of Q_group.
+  std::vector<int64_t> panel_boundaries(num_panels + 1, N);
+  panel_boundaries[0] = 0;
+  for(int64_t panel = 1; panel < num_panels; ++panel)
+    {
+      const int64_t boundary(N * std::sqrt(double(panel) / num_panels));
+      panel_boundaries[panel] = std::max(
+        panel_boundaries[panel - 1], boundary - boundary % grid_width);
+    }
 
-      solve_timer.stop();
+  const bool is_single_process_grid(Q_group.Grid().Size() == 1);
+  const std::vector<Batch> batches(
+    make_batches(schur_off_diagonal, columns, is_single_process_grid));
+  // Only allocate the stacking buffer if some batch has more than one
+  // block.
+  int64_t buffer_height(0);
+  for(auto &batch : batches)
+    {
+      if(batch.block_end - batch.block_begin > 1)
+        {
+          buffer_height = std::max(buffer_height, batch.height);
+        }
+    }
+  El::DistMatrix<El::BigFloat> stacked(buffer_height, N, Q_group.Grid());
 
-      // Next, we compute
-      //
-      //   Q = (L'^{-1} B')^T (L'^{-1} B') - {{0, 0}, {0, 1}}
-      //
-      // Where B' = (B U).  We think of Q as containing four blocks
-      // called Upper/Lower-Left/Right.
+  std::vector<std::chrono::high_resolution_clock::duration> block_times(
+    schur_off_diagonal.blocks.size(),
+    std::chrono::high_resolution_clock::duration::zero());
+  for(int64_t panel = 0; panel < num_panels; ++panel)
+    {
+      const int64_t column_begin(panel_boundaries[panel]),
+        column_end(panel_boundaries[panel + 1]);
+      if(column_begin == column_end)
+        {
+          continue;
+        }
+      El::DistMatrix<El::BigFloat> Q_panel(column_end,
+                                           column_end - column_begin,
+                                           Q_group.Grid());
+      El::Zero(Q_panel);
 
-      auto &syrk_timer(timers.add_and_start(
-        "run.step.initializeSchurComplementSolver.Q.syrk_"
-        + std::to_string(block_info.block_indices[block])));
-      El::DistMatrix<El::BigFloat> Q_group_view(
-        El::View(Q_group, 0, 0, schur_off_diagonal.blocks[block].Width(),
-                 schur_off_diagonal.blocks[block].Width()));
-      El::Syrk(El::UpperOrLowerNS::UPPER, El::OrientationNS::TRANSPOSE,
-               El::BigFloat(1), schur_off_diagonal.blocks[block],
-               El::BigFloat(1), Q_group_view);
-      syrk_timer.stop();
+      for(auto &batch : batches)
+        {
+          const auto batch_start(std::chrono::high_resolution_clock::now());
+          const bool is_stacked(batch.block_end - batch.block_begin > 1);
+          if(is_stacked)
+            {
+              // Only columns [0, column_end) are used by this panel.
+              El::Matrix<El::BigFloat> &stacked_local(stacked.Matrix());
+              int64_t row_offset(0);
+              for(size_t block = batch.block_begin; block < batch.block_end;
+                  ++block)
+                {
+                  const El::Matrix<El::BigFloat> &block_local(
+                    schur_off_diagonal.blocks[block].LockedMatrix());
+                  for(int64_t column = 0; column < column_end; ++column)
+                    for(int64_t row = 0; row < block_local.Height(); ++row)
+                      {
+                        stacked_local(row_offset + row, column)
+                          = block_local(row, column);
+                      }
+                  row_offset += block_local.Height();
+                }
+            }
+          const El::DistMatrix<El::BigFloat> B(
+            is_stacked
+              ? El::LockedView(stacked, 0, 0, batch.height, column_end)
+              : El::LockedView(schur_off_diagonal.blocks[batch.block_begin],
+                               0, 0, batch.height, column_end));
+          for_each_upper_product(
+            batch.columns, column_begin, column_end,
+            [&](const int64_t &row_begin, const int64_t &row_end,
+                const int64_t &sub_column_begin,
+                const int64_t &sub_column_end) {
+              const El::DistMatrix<El::BigFloat> B_columns(El::LockedView(
+                B, 0, sub_column_begin, B.Height(),
+                sub_column_end - sub_column_begin));
+              El::DistMatrix<El::BigFloat> Q_sub(El::View(
+                Q_panel, row_begin, sub_column_begin - column_begin,
+                row_end - row_begin, sub_column_end - sub_column_begin));
+              if(row_begin != sub_column_begin)
+                {
+                  const El::DistMatrix<El::BigFloat> B_rows(El::LockedView(
+                    B, 0, row_begin, B.Height(), row_end - row_begin));
+                  if(matrix_backend == Matrix_Backend::mpmat)
+                    {
+                      mpmat_gemm(B_rows, B_columns, El::BigFloat(1), Q_sub);
+                    }
+                  else if(matrix_backend == Matrix_Backend::fixed_point)
+                    {
+                      fixed_point_gemm(B_rows, B_columns, El::BigFloat(1),
+                                       Q_sub);
+                    }
+                  else
+                    {
+                      block_gemm(El::OrientationNS::TRANSPOSE,
+                                 El::OrientationNS::NORMAL, El::BigFloat(1),
+                                 B_rows, B_columns, El::BigFloat(1), Q_sub);
+                    }
+                }
+              else if(matrix_backend == Matrix_Backend::mpmat)
+                {
+                  mpmat_syrk(El::UpperOrLowerNS::UPPER, B_columns,
+                             El::BigFloat(1), Q_sub);
+                }
+              else if(matrix_backend == Matrix_Backend::fixed_point)
+                {
+                  fixed_point_syrk(El::UpperOrLowerNS::UPPER, B_columns,
+                                   El::BigFloat(1), Q_sub);
+                }
+              else
+                {
+                  block_syrk(El::UpperOrLowerNS::UPPER,
+                             El::OrientationNS::TRANSPOSE, El::BigFloat(1),
+                             B_columns, El::BigFloat(1), Q_sub);
+                }
+            });
+          const auto batch_time(std::chrono::high_resolution_clock::now()
+                                - batch_start);
+          for(size_t block = batch.block_begin; block < batch.block_end;
+              ++block)
+            {
+              const int64_t height(schur_off_diagonal.blocks[block].Height());
+              block_times[block]
+                += batch.height == 0 ? batch_time
+                                     : (batch_time * height) / batch.height;
+            }
+        }
+      Q_group.add_upper(Q_panel, column_begin);
+    }
+  for(size_t block = 0; block < schur_off_diagonal.blocks.size(); block++)
+    {
+      timers.add_elapsed("run.step.initializeSchurComplementSolver.Q.syrk_"
+                           + std::to_string(block_info.block_indices[block]),
+                         block_times[block]);
     }
 }
@@ -0,0 +1,255 @@
+#include "../../../../Block_Matrix.hxx"
+#include "../../../../Column_Ranges.hxx"
+#include "../../../../../Block_Info.hxx"
+#include "../../../../../../Timers.hxx"
+#include "../../../../../solver_comm.hxx"
+
+#include <cmath>
+
+// Compute the upper triangle of
+//
+//   Q = (L'^{-1} B')^T (L'^{-1} B') - {{0, 0}, {0, 1}}
+//
+// summed over all groups, overlapping the communication with the
+// computation.  Every block contributes to every element of Q, so we
+// split the columns of Q into panels.  Each panel is computed from all
+// of the blocks and then summed with a non-blocking
+// MPI_Ireduce_scatter, and that reduction runs while the next panel
+// is computed.
+//
+// The panel boundaries are chosen so that every panel has roughly the
+// same number of elements in the upper triangle.
+//
+// As in initialize_Q_group, the time for each block is summed over
+// the panels and recorded as a single syrk timer for the load
+// balancer.
+//
+// Each block only contributes to the sub-blocks of Q that
+// for_each_upper_product() finds for its nonzero columns.
+
+namespace
+{
+  void check_mpi_error(const int &mpi_error)
+  {
+    if(mpi_error != MPI_SUCCESS)
+      {
+        std::vector<char> error_string(MPI_MAX_ERROR_STRING);
+        int lengthOfErrorString;
+        MPI_Error_string(mpi_error, error_string.data(), &lengthOfErrorString);
+        El::RuntimeError(std::string(error_string.data()));
+      }
+  }
+
+  // MPI_User_function for serialized BigFloats: inout += in
+  void add_serialized(void *in, void *inout, int *len, MPI_Datatype *datatype)
+  {
+    int serialized_size;
+    MPI_Type_size(*datatype, &serialized_size);
+    const El::byte *in_bytes(static_cast<const El::byte *>(in));
+    El::byte *inout_bytes(static_cast<El::byte *>(inout));
+    El::BigFloat a, b;
+    for(int index = 0; index < *len; ++index)
+      {
+        a.Deserialize(in_bytes + index * serialized_size);
+        b.Deserialize(inout_bytes + index * serialized_size);
+        b += a;
+        b.Serialize(inout_bytes + index * serialized_size);
+      }
+  }
+
+  struct Panel_Reduction
+  {
+    int64_t column_begin, column_end;
+    std::vector<El::byte> send, receive;
+    MPI_Request request = MPI_REQUEST_NULL;
+  };
+
+  // Call f(row, column) for every element of the upper triangle of Q
+  // in columns [column_begin, column_end), in a fixed order.
+  template <typename F>
+  void for_each_in_panel(const int64_t &column_begin,
+                         const int64_t &column_end, const F &f)
+  {
+    for(int64_t column = column_begin; column < column_end; ++column)
+      for(int64_t row = 0; row <= column; ++row)
+        {
+          f(row, column);
+        }
+  }
+
+  // Unpack the sums for the elements this rank owns into Q
+  void finish_reduction(Panel_Reduction &reduction,
+                        const size_t &serialized_size,
+                        El::DistMatrix<El::BigFloat> &Q)
+  {
+    check_mpi_error(MPI_Wait(&reduction.request, MPI_STATUS_IGNORE));
+    const int rank(El::mpi::Rank(solver_comm()));
+    const El::byte *current(reduction.receive.data());
+    El::BigFloat element;
+    for_each_in_panel(reduction.column_begin, reduction.column_end,
+                      [&](const int64_t &row, const int64_t &column) {
+                        if(Q.Owner(row, column) == rank)
+                          {
+                            element.Deserialize(current);
+                            Q.SetLocal(Q.LocalRow(row), Q.LocalCol(column),
+                                       element);
+                            current += serialized_size;
+                          }
+                      });
+    reduction.send.clear();
+    reduction.send.shrink_to_fit();
+    reduction.receive.clear();
+    reduction.receive.shrink_to_fit();
+  }
+}
+
+void initialize_Q_overlapped(const Block_Info &block_info,
+                             const Block_Matrix &schur_off_diagonal,
+                             const std::vector<Column_Ranges> &columns,
+                             const El::Grid &group_grid,
+                             El::DistMatrix<El::BigFloat> &Q, Timers &timers)
+{
+  auto &overlapped_timer(timers.add_and_start(
+    "run.step.initializeSchurComplementSolver.Q.overlapped"));
+
+  const int64_t N(Q.Width());
+  const int total_ranks(El::mpi::Size(solver_comm()));
+  const int64_t num_panels(std::min(N, int64_t(8)));
+
+  std::vector<int64_t> panel_boundaries(num_panels + 1, N);
+  panel_boundaries[0] = 0;
+  for(int64_t panel = 1; panel < num_panels; ++panel)
+    {
+      panel_boundaries[panel]
+        = std::max(panel_boundaries[panel - 1],
+                   int64_t(N * std::sqrt(double(panel) / num_panels)));
+    }
+
+  El::BigFloat zero(0);
+  const size_t serialized_size(zero.SerializedSize());
+  MPI_Datatype serialized_type;
+  check_mpi_error(
+    MPI_Type_contiguous(serialized_size, MPI_BYTE, &serialized_type));
+  check_mpi_error(MPI_Type_commit(&serialized_type));
+  MPI_Op sum_op;
+  check_mpi_error(MPI_Op_create(add_serialized, 1, &sum_op));
+
+  std::vector<std::chrono::high_resolution_clock::duration> block_times(
+    schur_off_diagonal.blocks.size(),
+    std::chrono::high_resolution_clock::duration::zero());
+  Panel_Reduction reduction;
+  for(int64_t panel = 0; panel < num_panels; ++panel)
+    {
+      const int64_t column_begin(panel_boundaries[panel]),
+        column_end(panel_boundaries[panel + 1]);
+      if(column_begin == column_end)
+        {
+          continue;
+        }
+
+      // Rows [0, column_end) of the columns in this panel.  This
+      // includes some of the lower triangle in the diagonal square,
+      // which we compute but do not send.
+      El::DistMatrix<El::BigFloat> Q_panel(column_end,
+                                           column_end - column_begin,
+                                           group_grid);
+      El::Zero(Q_panel);
+      for(size_t block = 0; block < schur_off_diagonal.blocks.size(); block++)
+        {
+          const auto block_start(std::chrono::high_resolution_clock::now());
+          const auto &B(schur_off_diagonal.blocks[block]);
+          for_each_upper_product(
+            columns[block], column_begin, column_end,
+            [&](const int64_t &row_begin, const int64_t &row_end,
+                const int64_t &sub_column_begin,
+                const int64_t &sub_column_end) {
+              const El::DistMatrix<El::BigFloat> B_rows(El::LockedView(
+                B, 0, row_begin, B.Height(), row_end - row_begin)),
+                B_columns(El::LockedView(B, 0, sub_column_begin, B.Height(),
+                                         sub_column_end - sub_column_begin));
+              El::DistMatrix<El::BigFloat> Q_sub(El::View(
+                Q_panel, row_begin, sub_column_begin - column_begin,
+                row_end - row_begin, sub_column_end - sub_column_begin));
+              El::Gemm(El::OrientationNS::TRANSPOSE,
+                       El::OrientationNS::NORMAL, El::BigFloat(1), B_rows,
+                       B_columns, El::BigFloat(1), Q_sub);
+            });
+          block_times[block]
+            += std::chrono::high_resolution_clock::now() - block_start;
+
+          // Give MPI a chance to progress the previous reduction.
+          if(reduction.request != MPI_REQUEST_NULL)
+            {
+              int done;
+              check_mpi_error(
+                MPI_Test(&reduction.request, &done, MPI_STATUS_IGNORE));
+            }
+        }
+
+      if(!reduction.send.empty())
+        {
+          finish_reduction(reduction, serialized_size, Q);
+        }
+
+      // Pack this group's contributions, grouped by the rank that
+      // owns each element of Q.
+      std::vector<int> rank_sizes(total_ranks, 0);
+      for_each_in_panel(column_begin, column_end,
+                        [&](const int64_t &row, const int64_t &column) {
+                          ++rank_sizes[Q.Owner(row, column)];
+                        });
+      std::vector<size_t> offsets(total_ranks, 0);
+      for(int rank = 1; rank < total_ranks; ++rank)
+        {
+          offsets[rank] = offsets[rank - 1] + rank_sizes[rank - 1];
+        }
+
+      reduction.column_begin = column_begin;
+      reduction.column_end = column_end;
+      reduction.send.resize((offsets.back() + rank_sizes.back())
+                            * serialized_size);
+      reduction.receive.resize(
+        std::max(rank_sizes[El::mpi::Rank(solver_comm())], 1)
+        * serialized_size);
+      for_each_in_panel(
+        column_begin, column_end,
+        [&](const int64_t &row, const int64_t &column) {
+          El::byte *destination(reduction.send.data()
+                                + offsets[Q.Owner(row, column)]
+                                    * serialized_size);
+          const int64_t panel_column(column - column_begin);
+          if(Q_panel.IsLocal(row, panel_column))
+            {
+              Q_panel
+                .GetLocal(Q_panel.LocalRow(row),
+                          Q_panel.LocalCol(panel_column))
+                .Serialize(destination);
+            }
+          else
+            {
+              zero.Serialize(destination);
+            }
+          ++offsets[Q.Owner(row, column)];
+        });
+
+      check_mpi_error(MPI_Ireduce_scatter(
+        reduction.send.data(), reduction.receive.data(), rank_sizes.data(),
+        serialized_type, sum_op, solver_comm().comm,
+        &reduction.request));
+    }
+  if(!reduction.send.empty())
+    {
+      finish_reduction(reduction, serialized_size, Q);
+    }
+
+  for(size_t block = 0; block < schur_off_diagonal.blocks.size(); block++)
+    {
+      timers.add_elapsed("run.step.initializeSchurComplementSolver.Q.syrk_"
+                           + std::to_string(block_info.block_indices[block]),
+                         block_times[block]);
+    }
+
+  check_mpi_error(MPI_Op_free(&sum_op));
+  check_mpi_error(MPI_Type_free(&serialized_type));
+  overlapped_timer.stop();
+}
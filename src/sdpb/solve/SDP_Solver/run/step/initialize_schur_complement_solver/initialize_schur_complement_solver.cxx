@@ -1,6 +1,11 @@
 #include "../../../../SDP.hxx"
 #include "../../../../Block_Diagonal_Matrix.hxx"
+#include "../../../../Packed_Upper_Matrix.hxx"
+#include "../../../../Block_Spill.hxx"
+#include "../../../../Step_Workspace.hxx"
+#include "../../../../Blocksize_Profile.hxx"
 #include "../../../../../../Timers.hxx"
+#include "../../../../../SDP_Solver_Parameters.hxx"
 
 // Compute the quantities needed to solve the Schur complement
 // equation
@@ -20,7 +25,9 @@
 //   - L'^{-1} U
 //   - Q = (L'^{-1} B')^T (L'^{-1} B') - {{0, 0}, {0, 1}}
 //
-// - Compute the LU decomposition of Q.
+// - Compute the Cholesky decomposition of Q.  With
+//   overlapQCholesky and a replicated Q, this runs on a background
+//   thread, and Q_cholesky is set to wait for it.
 //
 // This data is sufficient to efficiently solve the above equation for
 // a given r,s.
@@ -28,70 +35,190 @@
 // Inputs:
 // - BilinearPairingsXInv, BilinearPairingsY (these are members of
 //   SDPSolver, but we include them as arguments to emphasize that
-//   they must be computed first)
-// Workspace (members of SDPSolver which are modified by this method
-// and not used later):
-// - SchurComplement
-// Outputs (members of SDPSolver which are modified by this method and
-// used later):
-// - SchurComplementCholesky
+//   they must be computed first).  With memoryMode=low, they are
+//   freed once S is computed, and SchurOffDiagonal is freed once Q is
+//   computed.
+// - With spillDirectory, the large blocks of SchurComplementCholesky
+//   and SchurOffDiagonal are spilled once Q is computed.  They are
+//   loaded again by compute_search_direction().
+// Workspace (members of Step_Workspace which are modified by this
+// method and not used later):
+// - Q_group
+// Q_synchronization_plan is set up once per run, since only the values
+// of Q change between iterations.
+// Outputs (members of Step_Workspace which are modified by this method
+// and used later):
+// - SchurComplementCholesky (S is computed here and then factored in
+//   place)
 // - SchurOffDiagonal
+// - schur_refinement.schur_complement, S itself for the blocks that
+//   are factored at a lower precision
 //
 
 void compute_schur_complement(
   const Block_Info &block_info,
   const Block_Diagonal_Matrix &bilinear_pairings_X_inv,
   const Block_Diagonal_Matrix &bilinear_pairings_Y,
+  const Matrix_Backend &matrix_backend, const size_t &num_threads,
   Block_Diagonal_Matrix &schur_complement, Timers &timers);
 
-void initialize_Q_group(const SDP &sdp, const Block_Info &block_info,
-                        const Block_Diagonal_Matrix &schur_complement,
-                        Block_Matrix &schur_off_diagonal,
-                        Block_Diagonal_Matrix &schur_complement_cholesky,
-                        El::DistMatrix<El::BigFloat> &Q_group, Timers &timers);
+void initialize_schur_off_diagonal(
+  const SDP &sdp, const Block_Info &block_info,
+  const size_t &replicated_panel_threshold, Block_Matrix &schur_off_diagonal,
+  Block_Diagonal_Matrix &schur_complement_cholesky, Timers &timers);
+
+void initialize_Q_group(const Block_Info &block_info,
+                        const Matrix_Backend &matrix_backend,
+                        const Block_Matrix &schur_off_diagonal,
+                        const std::vector<Column_Ranges> &columns,
+                        Packed_Upper_Matrix &Q_group, Timers &timers);
+
+void initialize_Q_overlapped(const Block_Info &block_info,
+                             const Block_Matrix &schur_off_diagonal,
+                             const std::vector<Column_Ranges> &columns,
+                             const El::Grid &group_grid,
+                             El::DistMatrix<El::BigFloat> &Q, Timers &timers);
+
+void upper_cholesky(El::Matrix<El::BigFloat> &A);
 
 void synchronize_Q(El::DistMatrix<El::BigFloat> &Q,
-                   const El::DistMatrix<El::BigFloat> &Q_group,
-                   Timers &timers);
+                   const Packed_Upper_Matrix &Q_group,
+                   const Q_Synchronization_Plan &plan, Timers &timers);
+
+namespace
+{
+  // Free all of the blocks.  They are allocated again where they are
+  // computed.
+  template <typename T> void release_blocks(T &t)
+  {
+    std::vector<El::DistMatrix<El::BigFloat>>().swap(t.blocks);
+  }
+}
 
 void initialize_schur_complement_solver(
   const Block_Info &block_info, const SDP &sdp,
-  const Block_Diagonal_Matrix &bilinear_pairings_X_inv,
-  const Block_Diagonal_Matrix &bilinear_pairings_Y, const El::Grid &group_grid,
+  const SDP_Solver_Parameters &parameters,
+  Block_Diagonal_Matrix &bilinear_pairings_X_inv,
+  Block_Diagonal_Matrix &bilinear_pairings_Y, const El::Grid &group_grid,
   Block_Diagonal_Matrix &schur_complement_cholesky,
-  Block_Matrix &schur_off_diagonal, El::DistMatrix<El::BigFloat> &Q,
+  Step_Workspace::Schur_Refinement &schur_refinement,
+  Block_Matrix &schur_off_diagonal, Block_Spill &schur_complement_spill,
+  Block_Spill &schur_off_diagonal_spill, Packed_Upper_Matrix &Q_group,
+  const Q_Synchronization_Plan &Q_synchronization_plan,
+  El::DistMatrix<El::BigFloat> &Q, std::future<void> &Q_cholesky,
   Timers &timers)
 {
   auto &initialize_timer(
     timers.add_and_start("run.step.initializeSchurComplementSolver"));
-  // The Schur complement matrix S: a Block_Diagonal_Matrix with one
-  // block for each 0 <= j < J.  SchurComplement.blocks[j] has dimension
-  // (d_j+1)*m_j*(m_j+1)/2
-  //
-  Block_Diagonal_Matrix schur_complement(
-    block_info.schur_block_sizes, block_info.block_indices,
-    block_info.schur_block_sizes.size(), group_grid);
 
+  // A factorization left over from an iteration that stopped early
+  // still uses Q.
+  if(Q_cholesky.valid())
+    {
+      Q_cholesky.wait();
+    }
+
+  // The blocks spilled in the last iteration
+  schur_complement_spill.allocate(schur_complement_cholesky.blocks);
+  schur_off_diagonal_spill.allocate(schur_off_diagonal.blocks);
+
+  // Compute S at the full precision for the refined blocks by
+  // swapping in their full precision storage.
+  auto swap_refined_blocks([&]() {
+    for(size_t block = 0; block < schur_refinement.schur_complement.size();
+        ++block)
+      {
+        if(schur_refinement.schur_complement[block].Height() != 0)
+          {
+            std::swap(schur_complement_cholesky.blocks[block],
+                      schur_refinement.schur_complement[block]);
+          }
+      }
+  });
+  swap_refined_blocks();
   compute_schur_complement(block_info, bilinear_pairings_X_inv,
-                           bilinear_pairings_Y, schur_complement, timers);
+                           bilinear_pairings_Y, parameters.matrix_backend,
+                           parameters.threads_per_proc,
+                           schur_complement_cholesky, timers);
+  swap_refined_blocks();
+  const bool is_low_memory(parameters.memory_mode == Memory_Mode::low);
+  if(is_low_memory)
+    {
+      release_blocks(bilinear_pairings_X_inv);
+      release_blocks(bilinear_pairings_Y);
+    }
+  // Assigning keeps the lower precision of the elements.
+  for(size_t block = 0; block < schur_refinement.schur_complement.size();
+      ++block)
+    {
+      const El::DistMatrix<El::BigFloat> &S(
+        schur_refinement.schur_complement[block]);
+      if(S.Height() != 0)
+        {
+          const El::Matrix<El::BigFloat> &S_local(S.LockedMatrix());
+          El::Matrix<El::BigFloat> &local(
+            schur_complement_cholesky.blocks[block].Matrix());
+          for(int64_t column = 0; column < S_local.Width(); ++column)
+            for(int64_t row = 0; row < S_local.Height(); ++row)
+              {
+                local(row, column) = S_local(row, column);
+              }
+        }
+    }
 
   auto &Q_computation_timer(
     timers.add_and_start("run.step.initializeSchurComplementSolver.Q"));
 
-  {
-    // FIXME: Change initialize_Q_group to initialize_Q and
-    // synchronize inside.
-    El::DistMatrix<El::BigFloat> Q_group(Q.Height(), Q.Width(), group_grid);
-    initialize_Q_group(sdp, block_info, schur_complement, schur_off_diagonal,
-                       schur_complement_cholesky, Q_group, timers);
-    synchronize_Q(Q, Q_group, timers);
-  }
+  initialize_schur_off_diagonal(sdp, block_info,
+                                parameters.replicated_panel_threshold,
+                                schur_off_diagonal, schur_complement_cholesky,
+                                timers);
+  // A replicated Q is summed with a single AllReduce, so there is
+  // nothing to overlap.
+  if(parameters.overlap_Q_synchronization && Q.Grid().Size() != 1)
+    {
+      initialize_Q_overlapped(block_info, schur_off_diagonal,
+                              sdp.free_var_columns, group_grid, Q, timers);
+    }
+  else
+    {
+      initialize_Q_group(block_info, parameters.matrix_backend,
+                         schur_off_diagonal, sdp.free_var_columns, Q_group,
+                         timers);
+      synchronize_Q(Q, Q_group, Q_synchronization_plan, timers);
+    }
+  // solve_schur_complement_equation() uses FreeVarMatrix instead.
+  if(is_low_memory)
+    {
+      release_blocks(schur_off_diagonal);
+    }
   Q_computation_timer.stop();
 
+  // The writes overlap with the Cholesky decomposition of Q and the
+  // start of compute_search_direction().
+  schur_complement_spill.spill(schur_complement_cholesky.blocks);
+  schur_off_diagonal_spill.spill(schur_off_diagonal.blocks);
+
+  // A replicated Q needs no communication to factor, so it can be
+  // factored on a background thread.  compute_search_direction()
+  // waits for it just before the first solve with Q.
+  if(parameters.overlap_Q_cholesky && Q.Grid().Size() == 1)
+    {
+      El::Matrix<El::BigFloat> &Q_local(Q.Matrix());
+      Q_cholesky = std::async(std::launch::async,
+                              [&Q_local]() { upper_cholesky(Q_local); });
+      initialize_timer.stop();
+      return;
+    }
   auto &Cholesky_timer(
     timers.add_and_start("run.step.initializeSchurComplementSolver."
                          "Cholesky"));
-  Cholesky(El::UpperOrLowerNS::UPPER, Q);
+  // Only the ranks of Q's grid take part (see Q_Grid).
+  if(Q.Grid().InGrid())
+    {
+      const Scoped_Blocksize blocksize(Blocksize_Kernel::cholesky, Q);
+      Cholesky(El::UpperOrLowerNS::UPPER, Q);
+    }
   Cholesky_timer.stop();
   initialize_timer.stop();
 }
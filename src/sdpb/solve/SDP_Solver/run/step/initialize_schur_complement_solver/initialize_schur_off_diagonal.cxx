@@ -0,0 +1,86 @@
+#include "../../../../SDP.hxx"
+#include "../../../../Block_Diagonal_Matrix.hxx"
+#include "../../../../block_kernels.hxx"
+#include "../../../../../../Timers.hxx"
+
+// Compute the Cholesky decomposition S' = L' L'^T of each block of
+// the Schur complement in place and
+//
+//   SchurOffDiagonal = L'^{-1} FreeVarMatrix
+//
+// The zero columns of FreeVarMatrix stay zero, so the triangular
+// solve only visits sdp.free_var_columns.
+//
+// Distributed blocks with at least replicated_panel_threshold rows
+// are factored and solved together by replicated_panel_cholesky().
+// Their time is all in the cholesky_ timer.
+
+void replicated_panel_cholesky(El::DistMatrix<El::BigFloat> &A,
+                               El::DistMatrix<El::BigFloat> &B,
+                               const Column_Ranges &columns);
+
+void initialize_schur_off_diagonal(
+  const SDP &sdp, const Block_Info &block_info,
+  const size_t &replicated_panel_threshold, Block_Matrix &schur_off_diagonal,
+  Block_Diagonal_Matrix &schur_complement_cholesky, Timers &timers)
+{
+  // schur_off_diagonal is reused between iterations, so only allocate
+  // it the first time.
+  if(schur_off_diagonal.blocks.size()
+     != schur_complement_cholesky.blocks.size())
+    {
+      schur_off_diagonal.blocks.clear();
+      schur_off_diagonal.blocks.reserve(
+        schur_complement_cholesky.blocks.size());
+      for(auto &block : sdp.free_var_matrix.blocks)
+        {
+          schur_off_diagonal.blocks.emplace_back(block.Height(),
+                                                 block.Width(), block.Grid());
+        }
+    }
+
+  for(size_t block = 0; block < schur_complement_cholesky.blocks.size();
+      block++)
+    {
+      El::DistMatrix<El::BigFloat> &cholesky(
+        schur_complement_cholesky.blocks[block]);
+      if(replicated_panel_threshold > 0 && cholesky.Grid().Size() > 1
+         && size_t(cholesky.Height()) >= replicated_panel_threshold)
+        {
+          auto &cholesky_timer(timers.add_and_start(
+            "run.step.initializeSchurComplementSolver.Q.cholesky_"
+            + std::to_string(block_info.block_indices[block])));
+          schur_off_diagonal.blocks[block]
+            = sdp.free_var_matrix.blocks[block];
+          replicated_panel_cholesky(cholesky,
+                                    schur_off_diagonal.blocks[block],
+                                    sdp.free_var_columns[block]);
+          cholesky_timer.stop();
+          continue;
+        }
+
+      auto &cholesky_timer(timers.add_and_start(
+        "run.step.initializeSchurComplementSolver.Q.cholesky_"
+        + std::to_string(block_info.block_indices[block])));
+      block_cholesky_lower(cholesky);
+      cholesky_timer.stop();
+
+      // SchurOffDiagonal = L'^{-1} FreeVarMatrix
+      auto &solve_timer(timers.add_and_start(
+        "run.step.initializeSchurComplementSolver.Q.solve_"
+        + std::to_string(block_info.block_indices[block])));
+
+      schur_off_diagonal.blocks[block] = sdp.free_var_matrix.blocks[block];
+      El::DistMatrix<El::BigFloat> &off_diagonal(
+        schur_off_diagonal.blocks[block]);
+      for(auto &range : sdp.free_var_columns[block])
+        {
+          El::DistMatrix<El::BigFloat> columns(
+            El::View(off_diagonal, 0, range.first, off_diagonal.Height(),
+                     range.second - range.first));
+          block_trsm_lower(El::OrientationNS::NORMAL, cholesky, columns);
+        }
+
+      solve_timer.stop();
+    }
+}
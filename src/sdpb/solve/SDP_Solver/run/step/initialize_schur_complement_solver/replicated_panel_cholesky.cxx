@@ -0,0 +1,214 @@
+#include "../../../../Column_Ranges.hxx"
+#include "../../../../Blocksize_Profile.hxx"
+
+#include <algorithm>
+
+// The Cholesky decomposition A = L L^T of a large block of the Schur
+// complement, fused with
+//
+//   B := L^{-1} B
+//
+// for the nonzero columns of B, for blocks that are spread over many
+// processes (replicatedPanelThreshold).
+//
+// El::Cholesky and El::Trsm on the 2D grid each need several
+// collectives for every panel of the blocksize, and their panel
+// factorizations and solves only use one row or column of the grid.
+// Here, A and B are redistributed once to [STAR,VR], so that each
+// process owns whole columns.  For every panel of L:
+//
+// - The panel goes to [VC,STAR].  Every process factors the diagonal
+//   block, and solves for its rows of the rest of the panel.
+// - The panel is replicated on every process.
+// - Each process updates its own columns of the trailing matrix, and
+//   its own columns of B, without any further communication.
+//
+// That is 3 collectives per panel for the factorization and the solve
+// together, and all of the arithmetic is spread over the whole grid.
+// Each process receives all of L once, which is more data than the 2D
+// algorithms move, but BigFloat arithmetic is much more expensive than
+// sending its limbs, so for the largest blocks the latency of the
+// collectives is what limits strong scaling.
+//
+// Only the lower triangle of A is meaningful afterwards, as with
+// El::Cholesky.  The strict upper triangle is overwritten.  The
+// copies are made at the precision of the elements of A, so blocks
+// with schurRefinementThreshold are still factored at the lower
+// precision.
+
+namespace
+{
+  // Update the trailing columns of A_local in chunks of local columns.
+  // The rows of a chunk start at the diagonal of its first column, so
+  // a chunk updates some entries above the diagonal.  Chunks are kept
+  // narrow enough that those are a small fraction of the work.
+  void update_trailing_columns(
+    const El::DistMatrix<El::BigFloat, El::STAR, El::VR> &A_columns,
+    const El::Matrix<El::BigFloat> &panel, const int64_t &panel_begin,
+    El::Matrix<El::BigFloat> &A_local)
+  {
+    const int64_t height(A_columns.Height()),
+      panel_width(panel.Width()), trailing_begin(panel_begin + panel_width);
+    const int64_t chunk_width(std::max(
+      int64_t(1), height / (16 * int64_t(A_columns.Grid().Size()))));
+
+    int64_t first(0);
+    while(first < A_columns.LocalWidth()
+          && A_columns.GlobalCol(first) < trailing_begin)
+      {
+        ++first;
+      }
+    El::Matrix<El::BigFloat> L_chunk;
+    for(int64_t chunk_begin = first; chunk_begin < A_columns.LocalWidth();
+        chunk_begin += chunk_width)
+      {
+        const int64_t chunk_end(
+          std::min(chunk_begin + chunk_width, A_columns.LocalWidth()));
+        const int64_t row_begin(A_columns.GlobalCol(chunk_begin));
+        L_chunk.Resize(chunk_end - chunk_begin, panel_width);
+        for(int64_t column = chunk_begin; column < chunk_end; ++column)
+          {
+            const int64_t panel_row(A_columns.GlobalCol(column)
+                                    - panel_begin);
+            for(int64_t k = 0; k < panel_width; ++k)
+              {
+                L_chunk(column - chunk_begin, k) = panel(panel_row, k);
+              }
+          }
+        const El::Matrix<El::BigFloat> L_rows(
+          El::LockedView(panel, row_begin - panel_begin, 0,
+                         height - row_begin, panel_width));
+        El::Matrix<El::BigFloat> A_chunk(
+          El::View(A_local, row_begin, chunk_begin, height - row_begin,
+                   chunk_end - chunk_begin));
+        El::Gemm(El::OrientationNS::NORMAL, El::OrientationNS::TRANSPOSE,
+                 El::BigFloat(-1), L_rows, L_chunk, El::BigFloat(1),
+                 A_chunk);
+      }
+  }
+}
+
+void replicated_panel_cholesky(El::DistMatrix<El::BigFloat> &A,
+                               El::DistMatrix<El::BigFloat> &B,
+                               const Column_Ranges &columns)
+{
+  const El::Grid &grid(A.Grid());
+  const int64_t height(A.Height());
+  const Scoped_Blocksize blocksize(Blocksize_Kernel::cholesky, A);
+
+  const int solver_precision(El::gmp::Precision());
+  {
+    int precision(0);
+    if(A.LocalHeight() != 0 && A.LocalWidth() != 0)
+      {
+        precision = A.LockedMatrix()(0, 0).gmp_float.get_prec();
+      }
+    El::gmp::SetPrecision(
+      El::mpi::AllReduce(precision, El::mpi::MAX, grid.Comm()));
+  }
+
+  El::DistMatrix<El::BigFloat, El::STAR, El::VR> A_columns(grid);
+  El::Copy(A, A_columns);
+  El::Matrix<El::BigFloat> &A_local(A_columns.Matrix());
+
+  // The nonzero columns of B, side by side
+  int64_t B_width(0);
+  for(auto &range : columns)
+    {
+      B_width += range.second - range.first;
+    }
+  El::DistMatrix<El::BigFloat, El::STAR, El::VR> B_columns(height, B_width,
+                                                           grid);
+  {
+    int64_t offset(0);
+    for(auto &range : columns)
+      {
+        const int64_t width(range.second - range.first);
+        El::DistMatrix<El::BigFloat, El::STAR, El::VR> destination(
+          El::View(B_columns, 0, offset, height, width));
+        El::Copy(El::LockedView(B, 0, range.first, height, width),
+                 destination);
+        offset += width;
+      }
+  }
+  El::Matrix<El::BigFloat> &B_local(B_columns.Matrix());
+
+  El::DistMatrix<El::BigFloat, El::VC, El::STAR> panel_rows(grid);
+  El::DistMatrix<El::BigFloat, El::STAR, El::STAR> diagonal(grid),
+    panel(grid);
+  for(int64_t panel_begin = 0; panel_begin < height;
+      panel_begin += El::Blocksize())
+    {
+      const int64_t panel_width(
+        std::min(El::Blocksize(), height - panel_begin)),
+        panel_height(height - panel_begin);
+
+      // Factor the panel
+      El::Copy(El::LockedView(A_columns, panel_begin, panel_begin,
+                              panel_height, panel_width),
+               panel_rows);
+      El::Copy(El::LockedView(panel_rows, 0, 0, panel_width, panel_width),
+               diagonal);
+      El::Cholesky(El::UpperOrLowerNS::LOWER, diagonal.Matrix());
+      {
+        El::DistMatrix<El::BigFloat, El::VC, El::STAR> top(
+          El::View(panel_rows, 0, 0, panel_width, panel_width)),
+          bottom(El::View(panel_rows, panel_width, 0,
+                          panel_height - panel_width, panel_width));
+        El::Copy(diagonal, top);
+        El::Trsm(El::LeftOrRightNS::RIGHT, El::UpperOrLowerNS::LOWER,
+                 El::OrientationNS::TRANSPOSE, El::UnitOrNonUnitNS::NON_UNIT,
+                 El::BigFloat(1), diagonal.LockedMatrix(), bottom.Matrix());
+      }
+      El::Copy(panel_rows, panel);
+      const El::Matrix<El::BigFloat> &panel_local(panel.LockedMatrix());
+
+      // Store the lower triangle of the panel in our columns
+      for(int64_t column = 0; column < A_columns.LocalWidth(); ++column)
+        {
+          const int64_t global_column(A_columns.GlobalCol(column));
+          if(global_column < panel_begin
+             || global_column >= panel_begin + panel_width)
+            {
+              continue;
+            }
+          for(int64_t row = global_column; row < height; ++row)
+            {
+              A_local(row, column) = panel_local(row - panel_begin,
+                                                 global_column - panel_begin);
+            }
+        }
+
+      update_trailing_columns(A_columns, panel_local, panel_begin, A_local);
+
+      // B_1 := L_11^{-1} B_1 and B_2 := B_2 - L_21 B_1
+      if(B_local.Width() != 0)
+        {
+          El::Matrix<El::BigFloat> B_1(El::View(
+            B_local, panel_begin, 0, panel_width, B_local.Width())),
+            B_2(El::View(B_local, panel_begin + panel_width, 0,
+                         panel_height - panel_width, B_local.Width()));
+          El::Trsm(El::LeftOrRightNS::LEFT, El::UpperOrLowerNS::LOWER,
+                   El::OrientationNS::NORMAL, El::UnitOrNonUnitNS::NON_UNIT,
+                   El::BigFloat(1), diagonal.LockedMatrix(), B_1);
+          El::Gemm(El::OrientationNS::NORMAL, El::OrientationNS::NORMAL,
+                   El::BigFloat(-1),
+                   El::LockedView(panel_local, panel_width, 0,
+                                  panel_height - panel_width, panel_width),
+                   B_1, El::BigFloat(1), B_2);
+        }
+    }
+
+  El::Copy(A_columns, A);
+  int64_t offset(0);
+  for(auto &range : columns)
+    {
+      const int64_t width(range.second - range.first);
+      El::DistMatrix<El::BigFloat> destination(
+        El::View(B, 0, range.first, height, width));
+      El::Copy(El::LockedView(B_columns, 0, offset, height, width),
+               destination);
+      offset += width;
+    }
+  El::gmp::SetPrecision(solver_precision);
+}
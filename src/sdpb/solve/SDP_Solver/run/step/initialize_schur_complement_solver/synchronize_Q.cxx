@@ -1,10 +1,15 @@
 // Synchronize the results back to the global Q.
 
+#include "../../../../Packed_Upper_Matrix.hxx"
+#include "../../../../Q_Synchronization_Plan.hxx"
+#include "../../../../compact_BigFloat.hxx"
 #include "../../../../../../Timers.hxx"
+#include "../../../../../solver_comm.hxx"
 
 #include <El.hpp>
 
 #include <algorithm>
+#include <cstring>
 
 namespace
 {
@@ -18,170 +23,359 @@ namespace
         El::RuntimeError(std::string(error_string.data()));
       }
   }
-}
 
-void synchronize_Q(El::DistMatrix<El::BigFloat> &Q,
-                   const El::DistMatrix<El::BigFloat> &Q_group, Timers &timers)
-{
-  auto &synchronize_Q_buffers_timer(timers.add_and_start(
-    "run.step.initializeSchurComplementSolver.Q.synchronize_Q"));
+  // Messages are a bitmap with one bit for each entry going to a
+  // given destination, followed by the compact form (see
+  // compact_BigFloat.hxx) of the nonzero entries.  Entries that no
+  // rank has contributed to yet are only a zero bit.
+  size_t bitmap_size(const int &num_entries) { return (num_entries + 7) / 8; }
 
-  const int total_ranks(El::mpi::Size(El::mpi::COMM_WORLD));
-  // Special case serial case
-  if(total_ranks == 1)
-    {
-      for(int64_t row = 0; row < Q_group.Height(); ++row)
-        for(int64_t column = row; column < Q_group.Height(); ++column)
-          {
-            Q.SetLocal(Q.LocalRow(row), Q.LocalCol(column),
-                       Q_group.GetLocal(Q_group.LocalRow(row),
-                                        Q_group.LocalCol(column)));
-          }
-      return;
-    }
+  // Total bytes sent by synchronize_Q on this rank.
+  int64_t bytes_sent(0);
+
+  bool get_bit(const El::byte *bitmap, const size_t &index)
+  {
+    return (bitmap[index / 8] >> (index % 8)) & 1;
+  }
 
-  El::BigFloat zero(0);
-  size_t serialized_size(zero.SerializedSize());
-  std::vector<uint8_t> serialized_zero(serialized_size);
-  zero.Serialize(serialized_zero.data());
+  void set_bit(El::byte *bitmap, const size_t &index)
+  {
+    bitmap[index / 8] |= (1 << (index % 8));
+  }
 
+  // Sum the contributions to a list of entries over all of the ranks
+  // in comm.  rank_sizes[destination] is the number of entries whose
+  // sum goes to the rank destination in comm.  for_each_entry(
+  // destination, f) calls f(contribution) for each of those entries,
+  // where contribution is a pointer to this rank's contribution, or
+  // nullptr if this rank does not have one.  Every rank must enumerate
+  // the same entries in the same order.
+  //
+  // Returns the sums for the entries whose destination is this rank,
+  // in the order they were enumerated.  The time spent waiting for
+  // each message is timed as wait_timer_name.
+  //
   // This is an re-implementation of MPI_Reduce_scatter
   // using the ring algorithm as found in OpenMPI.
-
+  //
   // We re-implement MPI_Reduce_scatter because we can get away with
   // significantly less memory use by not constructing the full send
   // buffer beforehand.  Also, for large blocks, we can skip some
   // elements when summing because those processors do not have
-  // contributions for all of Q.
+  // contributions for all of Q, and we do not send those elements at
+  // all until some rank has a contribution.
+  template <typename For_Each_Entry>
+  std::vector<El::BigFloat>
+  ring_reduce_scatter(const MPI_Comm &comm, Timers &timers,
+                      const std::string &wait_timer_name,
+                      const std::vector<int> &rank_sizes,
+                      const For_Each_Entry &for_each_entry)
+  {
+    int total_ranks, rank;
+    check_mpi_error(MPI_Comm_size(comm, &total_ranks));
+    check_mpi_error(MPI_Comm_rank(comm, &rank));
 
-  // MPI uses 'int' for message sizes.
-  std::vector<int> rank_sizes(total_ranks);
-  for(int64_t row = 0; row < Q_group.Height(); ++row)
-    for(int64_t column = row; column < Q_group.Height(); ++column)
+    std::vector<El::BigFloat> result;
+    if(total_ranks == 1)
       {
-        ++rank_sizes.at(Q.Owner(row, column));
+        result.reserve(rank_sizes[rank]);
+        for_each_entry(rank, [&](const El::BigFloat *contribution) {
+          result.emplace_back(contribution == nullptr ? El::BigFloat(0)
+                                                      : *contribution);
+        });
+        return result;
       }
 
-  int max_buffer_size(*std::max_element(rank_sizes.begin(), rank_sizes.end())
-                      * serialized_size);
-  std::array<std::vector<El::byte>, 2> send_receive(
-    {std::vector<El::byte>(max_buffer_size),
-     std::vector<El::byte>(max_buffer_size)});
+    const int max_rank_size(
+      *std::max_element(rank_sizes.begin(), rank_sizes.end()));
+    const int max_buffer_size(bitmap_size(max_rank_size)
+                              + max_rank_size
+                                  * max_compact_size(El::BigFloat(0)));
+    // Messages have different sizes, so we can not sum in place.
+    // Alternate between two receive buffers, and assemble each
+    // outgoing message in a separate send buffer.
+    std::array<std::vector<El::byte>, 2> receive_buffers(
+      {std::vector<El::byte>(max_buffer_size),
+       std::vector<El::byte>(max_buffer_size)});
+    std::vector<El::byte> send_buffer(max_buffer_size);
+
+    const int send_to_rank((rank + 1) % total_ranks),
+      receive_from_rank((total_ranks + rank - 1) % total_ranks);
+
+    // Fill send_buffer with the entries for destination, adding our
+    // contribution to the message in received (if any).  Returns the
+    // number of bytes in the message.
+    El::BigFloat sum;
+    auto assemble([&](const int &destination, const El::byte *received) {
+      std::fill(send_buffer.begin(),
+                send_buffer.begin() + bitmap_size(rank_sizes[destination]),
+                0);
+      El::byte *insertion_point(send_buffer.data()
+                                + bitmap_size(rank_sizes[destination]));
+      const El::byte *current_receiving(
+        received == nullptr ? nullptr
+                            : received + bitmap_size(rank_sizes[destination])),
+        *receiving_end(received == nullptr ? nullptr
+                                           : received + max_buffer_size);
+      size_t index(0);
+      for_each_entry(destination, [&](const El::BigFloat *contribution) {
+        const bool has_received(received != nullptr
+                                && get_bit(received, index));
+        if(has_received)
+          {
+            read_compact(current_receiving, receiving_end,
+                         sum.gmp_float.get_mpf_t());
+            if(contribution != nullptr)
+              {
+                sum += *contribution;
+              }
+          }
+        else if(contribution != nullptr)
+          {
+            sum = *contribution;
+          }
+        if((has_received || contribution != nullptr)
+           && mpf_sgn(sum.gmp_float.get_mpf_t()) != 0)
+          {
+            set_bit(send_buffer.data(), index);
+            insertion_point
+              = write_compact(sum.gmp_float.get_mpf_t(), insertion_point);
+          }
+        ++index;
+      });
+      return int(insertion_point - send_buffer.data());
+    });
+
+    const size_t wait_timer_id(timers.id(wait_timer_name));
 
-  const int rank(El::mpi::Rank(El::mpi::COMM_WORLD));
-  const int send_to_rank((rank + 1) % total_ranks),
-    receive_from_rank((total_ranks + rank - 1) % total_ranks);
+    // Initial async receive
+    int final_receive_destination((total_ranks + rank - 2) % total_ranks);
+    std::array<MPI_Request, 2> receive_requests;
+    check_mpi_error(MPI_Irecv(receive_buffers[0].data(), max_buffer_size,
+                              MPI_BYTE, receive_from_rank,
+                              final_receive_destination, comm,
+                              &receive_requests[0]));
 
-  // Initial async receive
-  int final_receive_destination((total_ranks + rank - 2) % total_ranks);
-  std::array<MPI_Request, 2> receive_requests;
-  check_mpi_error(MPI_Irecv(send_receive[0].data(),
-                            rank_sizes[final_receive_destination],
-                            El::mpi::TypeMap<El::BigFloat>(),
-                            receive_from_rank, final_receive_destination,
-                            El::mpi::COMM_WORLD.comm, &receive_requests[0]));
+    // Initial fill of send buffer
+    int final_send_destination((total_ranks + rank - 1) % total_ranks);
+    int message_size(assemble(final_send_destination, nullptr));
+    bytes_sent += message_size;
+    check_mpi_error(MPI_Send(send_buffer.data(), message_size, MPI_BYTE,
+                             send_to_rank, final_send_destination, comm));
 
-  // Initial fill of send buffer
-  int final_send_destination((total_ranks + rank - 1) % total_ranks);
+    // Loop over all remaining intermediate ranks
+    for(int rank_offset(2); rank_offset < total_ranks; ++rank_offset)
+      {
+        {
+          final_receive_destination
+            = (total_ranks + rank - (rank_offset + 1)) % total_ranks;
 
-  {
-    El::byte *insertion_point(send_receive[1].data());
-    for(int64_t row = 0; row < Q_group.Height(); ++row)
-      for(int64_t column = row; column < Q_group.Height(); ++column)
+          check_mpi_error(MPI_Irecv(
+            receive_buffers[(rank_offset + 1) % 2].data(), max_buffer_size,
+            MPI_BYTE, receive_from_rank, final_receive_destination, comm,
+            &receive_requests[(rank_offset + 1) % 2]));
+        }
         {
-          if(Q.Owner(row, column) == final_send_destination)
-            {
-              if(Q_group.IsLocal(row, column))
-                {
-                  Q_group
-                    .GetLocal(Q_group.LocalRow(row), Q_group.LocalCol(column))
-                    .Serialize(insertion_point);
-                }
-              else
-                {
-                  std::copy(serialized_zero.begin(), serialized_zero.end(),
-                            insertion_point);
-                }
-              insertion_point += serialized_size;
-            }
+          // This waits for the receive from a previous iteration, not the
+          // one we just initiated.
+
+          // We do not cancel sends, so no need to check status.
+          auto &wait_timer(timers.add_and_start(wait_timer_id));
+          check_mpi_error(
+            MPI_Wait(&receive_requests[rank_offset % 2], MPI_STATUS_IGNORE));
+          wait_timer.stop();
+
+          final_send_destination
+            = (total_ranks + rank - rank_offset) % total_ranks;
+          message_size = assemble(final_send_destination,
+                                  receive_buffers[rank_offset % 2].data());
+          bytes_sent += message_size;
+          check_mpi_error(MPI_Send(send_buffer.data(), message_size,
+                                   MPI_BYTE, send_to_rank,
+                                   final_send_destination, comm));
+        }
+      }
+    // Add the local contribution to the last message.
+
+    auto &wait_timer(timers.add_and_start(wait_timer_id));
+    check_mpi_error(
+      MPI_Wait(&receive_requests[total_ranks % 2], MPI_STATUS_IGNORE));
+    wait_timer.stop();
+    const El::byte *received(receive_buffers[total_ranks % 2].data()),
+      *current_receiving(received + bitmap_size(rank_sizes[rank])),
+      *receiving_end(received + max_buffer_size);
+    result.reserve(rank_sizes[rank]);
+    size_t index(0);
+    for_each_entry(rank, [&](const El::BigFloat *contribution) {
+      result.emplace_back(0);
+      El::BigFloat &received_sum(result.back());
+      if(get_bit(received, index))
+        {
+          read_compact(current_receiving, receiving_end,
+                       received_sum.gmp_float.get_mpf_t());
+        }
+      if(contribution != nullptr)
+        {
+          received_sum += *contribution;
         }
+      ++index;
+    });
+    return result;
   }
 
-  check_mpi_error(MPI_Send(send_receive[1].data(),
-                           rank_sizes[final_send_destination],
-                           El::mpi::TypeMap<El::BigFloat>(), send_to_rank,
-                           final_send_destination, El::mpi::COMM_WORLD.comm));
+  const El::BigFloat *local_contribution(const Packed_Upper_Matrix &Q_group,
+                                         const int64_t &row,
+                                         const int64_t &column)
+  {
+    return Q_group.IsLocal(row, column) ? &Q_group(row, column) : nullptr;
+  }
+}
 
-  // Loop over all remaining intermediate ranks
-  for(int rank_offset(2); rank_offset < total_ranks; ++rank_offset)
-    {
-      {
-        auto &receive_buffer(send_receive[(rank_offset + 1) % 2]);
+// If Q lives on a Grid of size 1, it is replicated on every rank, and
+// Q_group is summed with a single AllReduce.
+//
+// If the plan was made with procs_per_node <= 1, use a single ring
+// over all ranks.
+//
+// If procs_per_node > 1 and there is more than one node, use a two
+// level reduction.  Ranks r and r' are on the same node if
+// r/procs_per_node == r'/procs_per_node, which is the same layout the
+// load balancer assumes.
+//
+// 1) Within each node, reduce-scatter Q_group such that node rank l
+//    gets the node's sum for every element whose owner in Q has node
+//    rank l.
+//
+// 2) The ranks with the same node rank, one on each node, form a ring
+//    across nodes and reduce-scatter those partial sums to the owners
+//    in Q.
+//
+// This replaces a ring of length P with rings of length procs_per_node
+// and num_nodes, and only 1/procs_per_node of Q crosses between nodes
+// on any one ring.
+//
+// Within each ring, the entries for a destination are enumerated
+// owner by owner, in increasing world rank, and row major within each
+// owner.  So the node sums that node rank l gets are already grouped
+// by their owner in Q, which is the destination of the cross node
+// ring.
 
-        final_receive_destination
-          = (total_ranks + rank - (rank_offset + 1)) % total_ranks;
+void synchronize_Q(El::DistMatrix<El::BigFloat> &Q,
+                   const Packed_Upper_Matrix &Q_group,
+                   const Q_Synchronization_Plan &plan, Timers &timers)
+{
+  auto &synchronize_Q_buffers_timer(timers.add_and_start(
+    "run.step.initializeSchurComplementSolver.Q.synchronize_Q"));
 
-        check_mpi_error(MPI_Irecv(
-          receive_buffer.data(), rank_sizes[final_receive_destination],
-          El::mpi::TypeMap<El::BigFloat>(), receive_from_rank,
-          final_receive_destination, El::mpi::COMM_WORLD.comm,
-          &receive_requests[(rank_offset + 1) % 2]));
-      }
-      {
-        // This waits for the receive from a previous iteration, not the
-        // one we just initiated.
-
-        // We do not cancel sends, so no need to check status.
-        check_mpi_error(
-          MPI_Wait(&receive_requests[rank_offset % 2], MPI_STATUS_IGNORE));
-
-        final_send_destination
-          = (total_ranks + rank - rank_offset) % total_ranks;
-        auto &receive_then_send_buffer(send_receive[rank_offset % 2]);
-        El::byte *current_receiving(receive_then_send_buffer.data());
-        for(int64_t row = 0; row < Q_group.Height(); ++row)
-          for(int64_t column = row; column < Q_group.Height(); ++column)
-            {
-              if(Q.Owner(row, column) == final_send_destination)
-                {
-                  if(Q_group.IsLocal(row, column))
-                    {
-                      El::BigFloat received;
-                      received.Deserialize(current_receiving);
-                      received += Q_group.GetLocal(Q_group.LocalRow(row),
-                                                   Q_group.LocalCol(column));
-                      received.Serialize(current_receiving);
-                    }
-                  current_receiving += serialized_size;
-                }
-            }
-        check_mpi_error(MPI_Send(
-          receive_then_send_buffer.data(), rank_sizes[final_send_destination],
-          El::mpi::TypeMap<El::BigFloat>(), send_to_rank,
-          final_send_destination, El::mpi::COMM_WORLD.comm));
-      }
+  const int total_ranks(El::mpi::Size(solver_comm())),
+    rank(El::mpi::Rank(solver_comm()));
+  // Special case serial case
+  if(total_ranks == 1)
+    {
+      for(int64_t row = 0; row < Q_group.Height(); ++row)
+        for(int64_t column = row; column < Q_group.Height(); ++column)
+          {
+            Q.SetLocal(Q.LocalRow(row), Q.LocalCol(column),
+                       Q_group(row, column));
+          }
+      synchronize_Q_buffers_timer.stop();
+      return;
     }
-  // Add the local contribution to the last message and put it into
-  // the global Q.
-
-  check_mpi_error(
-    MPI_Wait(&receive_requests[total_ranks % 2], MPI_STATUS_IGNORE));
-  El::byte *current_receiving(send_receive[total_ranks % 2].data());
-  for(int64_t row = 0; row < Q_group.Height(); ++row)
-    for(int64_t column = row; column < Q_group.Height(); ++column)
-      {
-        if(Q.Owner(row, column) == rank)
+  if(Q.Grid().Size() == 1)
+    {
+      El::Matrix<El::BigFloat> Q_sum;
+      El::Zeros(Q_sum, Q.Height(), Q.Width());
+      for(int64_t row = 0; row < Q_group.Height(); ++row)
+        for(int64_t column = row; column < Q_group.Height(); ++column)
           {
-            El::BigFloat received;
-            received.Deserialize(current_receiving);
             if(Q_group.IsLocal(row, column))
               {
-                received += Q_group.GetLocal(Q_group.LocalRow(row),
-                                             Q_group.LocalCol(column));
+                Q_sum(row, column) = Q_group(row, column);
               }
-            Q.SetLocal(Q.LocalRow(row), Q.LocalCol(column), received);
-            current_receiving += serialized_size;
           }
-      }
+      // El::AllReduce sends the serialized matrix.  Count one copy.
+      bytes_sent += Q_sum.Height() * Q_sum.Width()
+                    * El::BigFloat(0).SerializedSize();
+      El::AllReduce(Q_sum, solver_comm());
+      Q.Matrix() = Q_sum;
+      synchronize_Q_buffers_timer.stop();
+      return;
+    }
+
+  // Time spent waiting for each ring message.
+  const std::string wait_name(
+    "run.step.initializeSchurComplementSolver.Q.synchronize_Q.wait");
+  std::vector<El::BigFloat> result;
+  if(plan.is_hierarchical())
+    {
+      const int node_size(plan.node_size), node_rank(rank % node_size),
+        num_nodes(total_ranks / node_size);
+
+      std::vector<int> node_sizes(node_size, 0), cross_node_sizes(num_nodes);
+      for(int node = 0; node < num_nodes; ++node)
+        {
+          for(int l = 0; l < node_size; ++l)
+            {
+              node_sizes[l] += plan.num_owned(node * node_size + l);
+            }
+          cross_node_sizes[node]
+            = plan.num_owned(node * node_size + node_rank);
+        }
+
+      const std::vector<El::BigFloat> node_sums(ring_reduce_scatter(
+        plan.node_comm, timers, wait_name + ".node", node_sizes,
+        [&](const int &destination, const auto &f) {
+          for(int node = 0; node < num_nodes; ++node)
+            {
+              plan.for_each_owned(
+                node * node_size + destination,
+                [&](const int64_t &row, const int64_t &column) {
+                  f(local_contribution(Q_group, row, column));
+                });
+            }
+        }));
+
+      // Where the node sums for each owner begin
+      std::vector<int64_t> node_sum_offsets(num_nodes, 0);
+      for(int node = 1; node < num_nodes; ++node)
+        {
+          node_sum_offsets[node]
+            = node_sum_offsets[node - 1] + cross_node_sizes[node - 1];
+        }
+      result = ring_reduce_scatter(
+        plan.cross_node_comm, timers, wait_name + ".cross_node",
+        cross_node_sizes, [&](const int &destination, const auto &f) {
+          for(int64_t index = 0; index < cross_node_sizes[destination];
+              ++index)
+            {
+              f(&node_sums[node_sum_offsets[destination] + index]);
+            }
+        });
+    }
+  else
+    {
+      std::vector<int> rank_sizes(total_ranks);
+      for(int owner = 0; owner < total_ranks; ++owner)
+        {
+          rank_sizes[owner] = plan.num_owned(owner);
+        }
+      result = ring_reduce_scatter(
+        solver_comm().comm, timers, wait_name, rank_sizes,
+        [&](const int &destination, const auto &f) {
+          plan.for_each_owned(
+            destination, [&](const int64_t &row, const int64_t &column) {
+              f(local_contribution(Q_group, row, column));
+            });
+        });
+    }
+
+  // Put the sums into the global Q.
+  auto sum(result.begin());
+  plan.for_each_owned(rank, [&](const int64_t &row, const int64_t &column) {
+    Q.SetLocal(Q.LocalRow(row), Q.LocalCol(column), *sum);
+    ++sum;
+  });
   synchronize_Q_buffers_timer.stop();
 }
+
+int64_t synchronize_Q_bytes_sent() { return bytes_sent; }
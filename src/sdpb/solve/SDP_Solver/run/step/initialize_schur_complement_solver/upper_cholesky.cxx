@@ -0,0 +1,44 @@
+#include <El.hpp>
+
+// A = U^T U, with U written over the upper triangle of A.  The lower
+// triangle is not referenced.
+//
+// This is for the replicated Q, which overlapQCholesky factors on a
+// background thread.  It only uses BigFloat arithmetic, so unlike
+// El::Cholesky() it does not touch Elemental's global state, such as
+// the blocksize stack, which the main thread changes at the same
+// time.  BigFloat arithmetic dominates, so an unblocked algorithm
+// costs about the same as a blocked one.
+
+void upper_cholesky(El::Matrix<El::BigFloat> &A)
+{
+  const int64_t height(A.Height());
+  El::BigFloat product;
+  for(int64_t k = 0; k < height; ++k)
+    {
+      El::BigFloat &pivot(A(k, k));
+      if(pivot <= El::BigFloat(0))
+        {
+          throw std::runtime_error(
+            "Q is not positive definite: pivot " + std::to_string(k)
+            + " is not positive");
+        }
+      pivot = El::Sqrt(pivot);
+      for(int64_t column = k + 1; column < height; ++column)
+        {
+          A(k, column) /= pivot;
+        }
+      // Subtract the outer product of row k from the trailing upper
+      // triangle.
+      for(int64_t column = k + 1; column < height; ++column)
+        {
+          const El::BigFloat &A_k_column(A(k, column));
+          for(int64_t row = k + 1; row <= column; ++row)
+            {
+              product = A(k, row);
+              product *= A_k_column;
+              A(row, column) -= product;
+            }
+        }
+    }
+}
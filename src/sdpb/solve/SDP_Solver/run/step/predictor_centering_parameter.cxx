@@ -1,10 +1,11 @@
-#include "../../../SDP_Solver.hxx"
+#include "../../../Step_Controller.hxx"
 
 // Centering parameter \beta_p for the predictor step
 El::BigFloat
-predictor_centering_parameter(const SDP_Solver_Parameters &parameters,
+predictor_centering_parameter(const Step_Controller &step_controller,
                               const bool is_primal_dual_feasible)
 {
-  return is_primal_dual_feasible ? El::BigFloat(0)
-                                 : parameters.infeasible_centering_parameter;
+  return is_primal_dual_feasible
+           ? El::BigFloat(0)
+           : step_controller.infeasible_centering_parameter;
 }
@@ -1,4 +1,6 @@
 #include "../../../SDP_Solver.hxx"
+#include "../../../Step_Workspace.hxx"
+#include "../../../Step_Controller.hxx"
 #include "../../../../../Timers.hxx"
 
 // Tr(A B), where A and B are symmetric
@@ -7,36 +9,62 @@ El::BigFloat frobenius_product_symmetric(const Block_Diagonal_Matrix &A,
 
 void initialize_schur_complement_solver(
   const Block_Info &block_info, const SDP &sdp,
-  const Block_Diagonal_Matrix &bilinear_pairings_X_inv,
-  const Block_Diagonal_Matrix &bilinear_pairings_Y, const El::Grid &block_grid,
+  const SDP_Solver_Parameters &parameters,
+  Block_Diagonal_Matrix &bilinear_pairings_X_inv,
+  Block_Diagonal_Matrix &bilinear_pairings_Y, const El::Grid &block_grid,
   Block_Diagonal_Matrix &schur_complement_cholesky,
-  Block_Matrix &schur_off_diagonal, El::DistMatrix<El::BigFloat> &Q,
+  Step_Workspace::Schur_Refinement &schur_refinement,
+  Block_Matrix &schur_off_diagonal, Block_Spill &schur_complement_spill,
+  Block_Spill &schur_off_diagonal_spill, Packed_Upper_Matrix &Q_group,
+  const Q_Synchronization_Plan &Q_synchronization_plan,
+  El::DistMatrix<El::BigFloat> &Q, std::future<void> &Q_cholesky,
   Timers &timers);
 
+// C := alpha*A*B + beta*C
+void scale_multiply_add(const El::BigFloat &alpha,
+                        const Block_Diagonal_Matrix &A,
+                        const Block_Diagonal_Matrix &B,
+                        const El::BigFloat &beta, Block_Diagonal_Matrix &C);
+
 void compute_search_direction(
-  const Block_Info &block_info, const SDP &sdp, const SDP_Solver &solver,
-  const Block_Diagonal_Matrix &schur_complement_cholesky,
-  const Block_Matrix &schur_off_diagonal,
-  const Block_Diagonal_Matrix &X_cholesky, const El::BigFloat beta,
-  const El::BigFloat &mu, const Block_Vector &primal_residue_p,
+  const Block_Info &block_info, const Matrix_Backend &matrix_backend,
+  const SDP &sdp, const SDP_Solver &solver,
+  Block_Diagonal_Matrix &schur_complement_cholesky,
+  const Step_Workspace::Schur_Refinement &schur_refinement,
+  Block_Matrix &schur_off_diagonal, Block_Spill &schur_complement_spill,
+  Block_Spill &schur_off_diagonal_spill,
+  const Block_Diagonal_Matrix &X_cholesky,
+  const Block_Diagonal_Matrix &X_Y,
+  const Block_Diagonal_Matrix &primal_residues_Y, const El::BigFloat beta,
+  const El::BigFloat &mu,
+  const El::DistMatrix<El::BigFloat> &primal_residue_p,
   const bool &is_corrector_phase, const El::DistMatrix<El::BigFloat> &Q,
-  Block_Vector &dx, Block_Diagonal_Matrix &dX, Block_Vector &dy,
+  std::future<void> &Q_cholesky, Q_Column_Reduction &dy_reduction,
+  Block_Vector &dx,
+  Block_Diagonal_Matrix &dX, El::DistMatrix<El::BigFloat> &dy,
   Block_Diagonal_Matrix &dY);
 
 El::BigFloat
-predictor_centering_parameter(const SDP_Solver_Parameters &parameters,
+predictor_centering_parameter(const Step_Controller &step_controller,
                               const bool is_primal_dual_feasible);
 
 El::BigFloat corrector_centering_parameter(
-  const SDP_Solver_Parameters &parameters, const Block_Diagonal_Matrix &X,
+  const Step_Controller &step_controller, const Block_Diagonal_Matrix &X,
   const Block_Diagonal_Matrix &dX, const Block_Diagonal_Matrix &Y,
   const Block_Diagonal_Matrix &dY, const El::BigFloat &mu,
   const bool is_primal_dual_feasible, const size_t &total_num_rows);
 
-El::BigFloat
-step_length(const Block_Diagonal_Matrix &MCholesky,
-            const Block_Diagonal_Matrix &dM, const El::BigFloat &gamma,
-            const std::string &timer_name, Timers &timers);
+void step_lengths(const Block_Diagonal_Matrix &X,
+                  const Block_Diagonal_Matrix &X_cholesky,
+                  const Block_Diagonal_Matrix &dX,
+                  const Block_Diagonal_Matrix &Y,
+                  const Block_Diagonal_Matrix &Y_cholesky,
+                  const Block_Diagonal_Matrix &dY, const El::BigFloat &gamma,
+                  const Step_Length_Algorithm &algorithm,
+                  const size_t &num_threads, El::BigFloat &primal_step_length,
+                  El::BigFloat &dual_step_length,
+                  Step_Workspace::Next_Cholesky *next_cholesky,
+                  Timers &timers);
 
 void SDP_Solver::step(const SDP_Solver_Parameters &parameters,
                       const std::size_t &total_psd_rows,
@@ -45,49 +73,44 @@ void SDP_Solver::step(const SDP_Solver_Parameters &parameters,
                       const El::Grid &grid,
                       const Block_Diagonal_Matrix &X_cholesky,
                       const Block_Diagonal_Matrix &Y_cholesky,
-                      const Block_Diagonal_Matrix &bilinear_pairings_X_inv,
-                      const Block_Diagonal_Matrix &bilinear_pairings_Y,
-                      const Block_Vector &primal_residue_p, El::BigFloat &mu,
+                      Block_Diagonal_Matrix &bilinear_pairings_X_inv,
+                      Block_Diagonal_Matrix &bilinear_pairings_Y,
+                      const El::DistMatrix<El::BigFloat> &primal_residue_p,
+                      El::BigFloat &mu,
                       El::BigFloat &beta_corrector,
                       El::BigFloat &primal_step_length,
                       El::BigFloat &dual_step_length,
-                      bool &terminate_now, Timers &timers)
+                      Step_Workspace &workspace,
+                      Step_Controller &step_controller, bool &terminate_now,
+                      Timers &timers)
 {
   auto &step_timer(timers.add_and_start("run.step"));
   El::BigFloat beta_predictor;
 
-  // Search direction: These quantities have the same structure
-  // as (x, X, y, Y). They are computed twice each iteration:
-  // once in the predictor step, and once in the corrector step.
-  Block_Vector dx(x), dy(y);
-  Block_Diagonal_Matrix dX(X), dY(Y);
+  // The workspace is allocated once per run.  See Step_Workspace.hxx
+  // for descriptions of these matrices.
+  Block_Vector &dx(workspace.dx);
+  El::DistMatrix<El::BigFloat> &dy(workspace.dy);
+  Block_Diagonal_Matrix &dX(workspace.dX), &dY(workspace.dY);
+  Step_Workspace::Next_Cholesky *next_cholesky(
+    workspace.next_cholesky.get_ptr());
   {
-    // SchurComplementCholesky = L', the Cholesky decomposition of the
-    // Schur complement matrix S.
-    Block_Diagonal_Matrix schur_complement_cholesky(
-      block_info.schur_block_sizes, block_info.block_indices,
-      block_info.schur_block_sizes.size(), grid);
-
-    // SchurOffDiagonal = L'^{-1} FreeVarMatrix, needed in solving the
-    // Schur complement equation.
-    Block_Matrix schur_off_diagonal;
-
-    // Q = B' L'^{-T} L'^{-1} B' - {{0, 0}, {0, 1}}, where B' =
-    // (FreeVarMatrix U).  Q is needed in the factorization of the Schur
-    // complement equation.  Q has dimension N'xN', where
-    //
-    //   N' = cols(B) + cols(U) = N + cols(U)
-    //
-    // where N is the dimension of the dual objective function.  Note
-    // that N' could change with each iteration.
-    El::DistMatrix<El::BigFloat> Q(sdp.dual_objective_b.Height(),
-                                   sdp.dual_objective_b.Height());
+    Block_Diagonal_Matrix &schur_complement_cholesky(
+      workspace.schur_complement_cholesky);
+    Block_Matrix &schur_off_diagonal(workspace.schur_off_diagonal);
+    Block_Spill &schur_complement_spill(workspace.schur_complement_spill),
+      &schur_off_diagonal_spill(workspace.schur_off_diagonal_spill);
+    const El::DistMatrix<El::BigFloat> &Q(workspace.Q);
 
     // Compute SchurComplement and prepare to solve the Schur
     // complement equation for dx, dy
     initialize_schur_complement_solver(
-      block_info, sdp, bilinear_pairings_X_inv, bilinear_pairings_Y, grid,
-      schur_complement_cholesky, schur_off_diagonal, Q, timers);
+      block_info, sdp, parameters, bilinear_pairings_X_inv, bilinear_pairings_Y,
+      grid, schur_complement_cholesky, workspace.schur_refinement,
+      schur_off_diagonal, schur_complement_spill, schur_off_diagonal_spill,
+      workspace.Q_group,
+      workspace.Q_synchronization_plan, workspace.Q, workspace.Q_cholesky,
+      timers);
 
     // Compute the complementarity mu = Tr(X Y)/X.dim
     auto &frobenius_timer(
@@ -100,62 +123,136 @@ void SDP_Solver::step(const SDP_Solver_Parameters &parameters,
         return;
       }
 
+    // The products that every search direction of this iteration
+    // shares
+    auto &products_timer(
+      timers.add_and_start("run.step.computeSearchDirection(products)"));
+    scale_multiply_add(El::BigFloat(1), X, Y, El::BigFloat(0),
+                       workspace.X_Y);
+    scale_multiply_add(El::BigFloat(1), primal_residues, Y, El::BigFloat(0),
+                       workspace.primal_residues_Y);
+    products_timer.stop();
+
     auto &predictor_timer(
       timers.add_and_start("run.step.computeSearchDirection(betaPredictor)"));
 
     // Compute the predictor solution for (dx, dX, dy, dY)
     beta_predictor
-      = predictor_centering_parameter(parameters, is_primal_and_dual_feasible);
-    compute_search_direction(block_info, sdp, *this, schur_complement_cholesky,
-                             schur_off_diagonal, X_cholesky, beta_predictor,
-                             mu, primal_residue_p, false, Q, dx, dX, dy, dY);
+      = predictor_centering_parameter(step_controller,
+                                      is_primal_and_dual_feasible);
+    compute_search_direction(
+      block_info, parameters.matrix_backend, sdp, *this,
+      schur_complement_cholesky, workspace.schur_refinement,
+      schur_off_diagonal, schur_complement_spill, schur_off_diagonal_spill,
+      X_cholesky, workspace.X_Y, workspace.primal_residues_Y, beta_predictor,
+      mu, primal_residue_p, false, Q, workspace.Q_cholesky,
+      workspace.dy_reduction, dx, dX, dy, dY);
     predictor_timer.stop();
 
     // Compute the corrector solution for (dx, dX, dy, dY)
     auto &corrector_timer(
       timers.add_and_start("run.step.computeSearchDirection(betaCorrector)"));
     beta_corrector = corrector_centering_parameter(
-      parameters, X, dX, Y, dY, mu, is_primal_and_dual_feasible,
+      step_controller, X, dX, Y, dY, mu, is_primal_and_dual_feasible,
       total_psd_rows);
 
-    compute_search_direction(block_info, sdp, *this, schur_complement_cholesky,
-                             schur_off_diagonal, X_cholesky, beta_corrector,
-                             mu, primal_residue_p, true, Q, dx, dX, dy, dY);
+    compute_search_direction(
+      block_info, parameters.matrix_backend, sdp, *this,
+      schur_complement_cholesky, workspace.schur_refinement,
+      schur_off_diagonal, schur_complement_spill, schur_off_diagonal_spill,
+      X_cholesky, workspace.X_Y, workspace.primal_residues_Y, beta_corrector,
+      mu, primal_residue_p, true, Q,
+      workspace.Q_cholesky, workspace.dy_reduction, dx, dX, dy, dY);
     corrector_timer.stop();
-  }
-  // Compute step-lengths that preserve positive definiteness of X, Y
-  primal_step_length
-    = step_length(X_cholesky, dX, parameters.step_length_reduction,
-                  "run.step.stepLength(XCholesky)", timers);
 
-  dual_step_length
-    = step_length(Y_cholesky, dY, parameters.step_length_reduction,
-                  "run.step.stepLength(YCholesky)", timers);
+    // Compute step-lengths that preserve positive definiteness of X, Y
+    step_lengths(X, X_cholesky, dX, Y, Y_cholesky, dY,
+                 step_controller.step_length_reduction,
+                 parameters.step_length_algorithm,
+                 parameters.threads_per_proc, primal_step_length,
+                 dual_step_length, next_cholesky, timers);
+
+    // Additional correctors.  Each one recomputes the corrector with
+    // the second order term dX dY of the last direction, reusing the
+    // factorizations above, and is kept only if it lengthens the
+    // step.
+    for(size_t corrector = 0; corrector < parameters.max_correctors
+                              && El::Min(primal_step_length, dual_step_length)
+                                   < El::BigFloat(1);
+        ++corrector)
+      {
+        Step_Workspace::Search_Direction &previous(
+          *workspace.previous_direction);
+        previous.dx = dx;
+        previous.dX = dX;
+        previous.dy = dy;
+        previous.dY = dY;
+        const El::BigFloat previous_primal_step_length(primal_step_length),
+          previous_dual_step_length(dual_step_length);
+
+        auto &extra_corrector_timer(timers.add_and_start(
+          "run.step.computeSearchDirection(extraCorrectors)"));
+        compute_search_direction(
+          block_info, parameters.matrix_backend, sdp, *this,
+          schur_complement_cholesky, workspace.schur_refinement,
+          schur_off_diagonal, schur_complement_spill,
+          schur_off_diagonal_spill, X_cholesky, workspace.X_Y,
+          workspace.primal_residues_Y, beta_corrector, mu, primal_residue_p,
+          true, Q, workspace.Q_cholesky, workspace.dy_reduction, dx, dX, dy,
+          dY);
+        extra_corrector_timer.stop();
+
+        step_lengths(X, X_cholesky, dX, Y, Y_cholesky, dY,
+                     step_controller.step_length_reduction,
+                     parameters.step_length_algorithm,
+                     parameters.threads_per_proc, primal_step_length,
+                     dual_step_length, next_cholesky, timers);
+        if(El::Min(primal_step_length, dual_step_length)
+           <= El::Min(previous_primal_step_length, previous_dual_step_length))
+          {
+            dx = previous.dx;
+            dX = previous.dX;
+            dy = previous.dy;
+            dY = previous.dY;
+            primal_step_length = previous_primal_step_length;
+            dual_step_length = previous_dual_step_length;
+            // The factors are for the rejected direction.
+            if(next_cholesky)
+              {
+                next_cholesky->is_X_valid = false;
+                next_cholesky->is_Y_valid = false;
+              }
+            break;
+          }
+      }
+  }
 
   // If our problem is both dual-feasible and primal-feasible,
   // ensure we're following the true Newton direction.
   if(is_primal_and_dual_feasible)
     {
+      // The next factors are only for the step lengths that were
+      // checked.
+      if(next_cholesky)
+        {
+          next_cholesky->is_X_valid
+            = next_cholesky->is_X_valid
+              && primal_step_length <= dual_step_length;
+          next_cholesky->is_Y_valid
+            = next_cholesky->is_Y_valid
+              && dual_step_length <= primal_step_length;
+        }
       primal_step_length = El::Min(primal_step_length, dual_step_length);
       dual_step_length = primal_step_length;
     }
+  step_controller.update(mu, primal_step_length, dual_step_length);
 
   // Update the primal point (x, X) += primalStepLength*(dx, dX)
-  for(size_t block = 0; block < x.blocks.size(); ++block)
-    {
-      El::Axpy(primal_step_length, dx.blocks[block], x.blocks[block]);
-    }
-  dX *= primal_step_length;
-
-  X += dX;
+  x += primal_step_length * dx;
+  X += primal_step_length * dX;
 
   // Update the dual point (y, Y) += dualStepLength*(dy, dY)
-  for(size_t block = 0; block < dy.blocks.size(); ++block)
-    {
-      El::Axpy(dual_step_length, dy.blocks[block], y.blocks[block]);
-    }
-  dY *= dual_step_length;
-
-  Y += dY;
+  add_scaled(dual_step_length, dy, y);
+  Y += dual_step_length * dY;
   step_timer.stop();
 }
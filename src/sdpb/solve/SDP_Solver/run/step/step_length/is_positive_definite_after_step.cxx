@@ -0,0 +1,49 @@
+#include "../../../../Block_Diagonal_Matrix.hxx"
+#include "../../../../block_kernels.hxx"
+
+// Whether M + alpha dM is positive definite on the blocks of this
+// rank, checked with a Cholesky decomposition of every block.  The
+// caller combines the results of all ranks.
+//
+// M + alpha dM is congruent to 1 + alpha L^{-1} dM L^{-T}, so this is
+// the same test.  Factoring M + alpha dM itself makes the factor
+// useful: if the step is taken, M_cholesky_next is the Cholesky
+// decomposition of the next iterate.  M + alpha dM is evaluated the
+// same way as the update in step(), and rounded to the precision of
+// M_cholesky_next, so the factor is the same one that the next
+// iteration would compute.
+
+bool is_positive_definite_after_step(const Block_Diagonal_Matrix &M,
+                                     const Block_Diagonal_Matrix &dM,
+                                     const El::BigFloat &alpha,
+                                     Block_Diagonal_Matrix &M_cholesky_next)
+{
+  int local_result(1);
+  El::BigFloat sum, product;
+  for(size_t b = 0; b < M.blocks.size(); ++b)
+    {
+      const El::Matrix<El::BigFloat> &M_local(M.blocks[b].LockedMatrix()),
+        &dM_local(dM.blocks[b].LockedMatrix());
+      El::DistMatrix<El::BigFloat> &next(M_cholesky_next.blocks[b]);
+      El::Matrix<El::BigFloat> &next_local(next.Matrix());
+      for(int64_t column = 0; column < M_local.Width(); ++column)
+        for(int64_t row = 0; row < M_local.Height(); ++row)
+          {
+            product = dM_local(row, column);
+            product *= alpha;
+            sum = M_local(row, column);
+            sum += product;
+            next_local(row, column) = sum;
+          }
+      try
+        {
+          block_cholesky_lower(next);
+        }
+      catch(std::exception &)
+        {
+          local_result = 0;
+          break;
+        }
+    }
+  return local_result == 1;
+}
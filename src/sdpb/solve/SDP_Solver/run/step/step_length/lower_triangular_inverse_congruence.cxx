@@ -1,16 +1,22 @@
-#include "../../../../Block_Diagonal_Matrix.hxx"
+#include "../../../../block_kernels.hxx"
 
-// A := L^{-1} A L^{-T}
-void lower_triangular_inverse_congruence(const Block_Diagonal_Matrix &L,
-                                         Block_Diagonal_Matrix &A)
+// A := L^{-1} A L^{-T}, for one block.  On a single process grid, this
+// only uses the local matrices and makes no MPI calls, so it can run
+// on any thread.
+void lower_triangular_inverse_congruence(const El::DistMatrix<El::BigFloat> &L,
+                                         El::DistMatrix<El::BigFloat> &A)
 {
-  for(size_t b = 0; b < A.blocks.size(); b++)
+  if(is_single_process(A))
     {
       El::Trsm(El::LeftOrRight::RIGHT, El::UpperOrLowerNS::LOWER,
                El::Orientation::TRANSPOSE, El::UnitOrNonUnit::NON_UNIT,
-               El::BigFloat(1), L.blocks[b], A.blocks[b]);
-      El::Trsm(El::LeftOrRight::LEFT, El::UpperOrLowerNS::LOWER,
-               El::Orientation::NORMAL, El::UnitOrNonUnit::NON_UNIT,
-               El::BigFloat(1), L.blocks[b], A.blocks[b]);
+               El::BigFloat(1), L.LockedMatrix(), A.Matrix());
     }
+  else
+    {
+      El::Trsm(El::LeftOrRight::RIGHT, El::UpperOrLowerNS::LOWER,
+               El::Orientation::TRANSPOSE, El::UnitOrNonUnit::NON_UNIT,
+               El::BigFloat(1), L, A);
+    }
+  block_trsm_lower(El::Orientation::NORMAL, L, A);
 }
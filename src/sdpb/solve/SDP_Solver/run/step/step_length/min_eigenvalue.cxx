@@ -1,33 +1,59 @@
-#include "../../../../Block_Diagonal_Matrix.hxx"
+#include "../../../../block_kernels.hxx"
 
-// Minimum eigenvalue of A.  A is assumed to be symmetric.
+// Minimum eigenvalue of one block.  The block is assumed to be
+// symmetric.  The caller takes the minimum over blocks and ranks.  On
+// a single process grid, this only uses the local matrix and makes no
+// MPI calls, so it can run on any thread.
 
 // Annoyingly, El::HermitianEig modifies 'block'.  It is OK, because
-// it is only called from step_length(), which passes in a temporary.
+// it is only called from step_lengths(), which passes in a temporary.
 // Still ugly.
-El::BigFloat min_eigenvalue(Block_Diagonal_Matrix &A)
+
+namespace
 {
-  El::BigFloat local_min(El::limits::Max<El::BigFloat>());
+  El::HermitianEigCtrl<El::BigFloat> eig_ctrl(const int64_t &height)
+  {
+    /// There is a bug in El::HermitianEig when there is more than
+    /// one level of recursion when computing eigenvalues.  One fix
+    /// is to increase the cutoff so that there is no more than one
+    /// level of recursion.
 
-  for(auto &block : A.blocks)
-    {
-      El::DistMatrix<El::BigFloat, El::VR, El::STAR> eigenvalues(block.Grid());
-      /// There is a bug in El::HermitianEig when there is more than
-      /// one level of recursion when computing eigenvalues.  One fix
-      /// is to increase the cutoff so that there is no more than one
-      /// level of recursion.
+    /// An alternate workaround is to compute both eigenvalues and
+    /// eigenvectors, but that seems to be significantly slower.
+    El::HermitianEigCtrl<El::BigFloat> hermitian_eig_ctrl;
+    hermitian_eig_ctrl.tridiagEigCtrl.dcCtrl.cutoff = height / 2 + 1;
 
-      /// An alternate workaround is to compute both eigenvalues and
-      /// eigenvectors, but that seems to be significantly slower.
-      El::HermitianEigCtrl<El::BigFloat> hermitian_eig_ctrl;
-      hermitian_eig_ctrl.tridiagEigCtrl.dcCtrl.cutoff = block.Height() / 2 + 1;
+    /// The default number of iterations is 40.  That is sometimes
+    /// not enough, so we bump it up significantly.
+    hermitian_eig_ctrl.tridiagEigCtrl.dcCtrl.secularCtrl.maxIterations
+      = 16384;
+    return hermitian_eig_ctrl;
+  }
+}
+
+// A block that is entirely on this rank.  Makes no MPI calls.
+El::BigFloat min_eigenvalue(El::Matrix<El::BigFloat> &block)
+{
+  El::Matrix<El::BigFloat> eigenvalues;
+  El::HermitianEig(El::UpperOrLowerNS::LOWER, block, eigenvalues,
+                   eig_ctrl(block.Height()));
+  El::BigFloat result(El::limits::Max<El::BigFloat>());
+  for(int64_t row = 0; row < eigenvalues.Height(); ++row)
+    {
+      result = El::Min(result, eigenvalues(row, 0));
+    }
+  return result;
+}
 
-      /// The default number of iterations is 40.  That is sometimes
-      /// not enough, so we bump it up significantly.
-      hermitian_eig_ctrl.tridiagEigCtrl.dcCtrl.secularCtrl.maxIterations = 16384;
-      El::HermitianEig(El::UpperOrLowerNS::LOWER, block, eigenvalues,
-                       hermitian_eig_ctrl);
-      local_min = El::Min(local_min, El::Min(eigenvalues));
+El::BigFloat min_eigenvalue(El::DistMatrix<El::BigFloat> &block)
+{
+  if(is_single_process(block))
+    {
+      return min_eigenvalue(block.Matrix());
     }
-  return El::mpi::AllReduce(local_min, El::mpi::MIN, El::mpi::COMM_WORLD);
+  El::DistMatrix<El::BigFloat, El::VR, El::STAR> eigenvalues(block.Grid());
+  const Scoped_Blocksize blocksize(Blocksize_Kernel::eig, block);
+  El::HermitianEig(El::UpperOrLowerNS::LOWER, block, eigenvalues,
+                   eig_ctrl(block.Height()));
+  return El::Min(eigenvalues);
 }
@@ -0,0 +1,199 @@
+#include "../../../../Block_Diagonal_Matrix.hxx"
+
+// Estimate the minimum eigenvalue of A with the Lanczos algorithm.  A
+// is assumed to be symmetric.  This only looks at a Krylov subspace
+// of dimension at most max_lanczos_iterations, so the smallest Ritz
+// value theta can be larger than the true minimum.  The estimate is
+// theta minus the residual norm |A u - theta u| of its Ritz vector u,
+// which is below the true minimum whenever theta has converged to it,
+// since some eigenvalue is within the residual norm of theta.  That is
+// still not a proof, so callers must check the result.  Like
+// min_eigenvalue(), this only covers the blocks on this rank.
+//
+// We use full reorthogonalization.  The subspaces are small, so this
+// is cheap compared to the matrix-vector products, and it avoids
+// spurious copies of eigenvalues.
+
+namespace
+{
+  const int64_t max_lanczos_iterations(40);
+
+  // Number of eigenvalues of the symmetric tridiagonal matrix with
+  // diagonal 'diagonal' and off-diagonal 'off_diagonal' that are less
+  // than x, using a Sturm sequence.
+  int64_t num_eigenvalues_below(const std::vector<El::BigFloat> &diagonal,
+                                const std::vector<El::BigFloat> &off_diagonal,
+                                const El::BigFloat &x)
+  {
+    const El::BigFloat tiny(El::limits::Epsilon<El::BigFloat>()), zero(0);
+    int64_t result(0);
+    El::BigFloat d(1);
+    for(size_t index = 0; index < diagonal.size(); ++index)
+      {
+        d = diagonal[index] - x
+            - (index == 0 ? El::BigFloat(0)
+                          : off_diagonal[index - 1] * off_diagonal[index - 1]
+                              / d);
+        if(d == zero)
+          {
+            d = tiny;
+          }
+        if(d < zero)
+          {
+            ++result;
+          }
+      }
+    return result;
+  }
+
+  El::BigFloat
+  tridiagonal_min_eigenvalue(const std::vector<El::BigFloat> &diagonal,
+                             const std::vector<El::BigFloat> &off_diagonal)
+  {
+    // Gershgorin bounds
+    El::BigFloat lower(diagonal.front()), upper(diagonal.front());
+    for(size_t index = 0; index < diagonal.size(); ++index)
+      {
+        El::BigFloat radius(0);
+        if(index > 0)
+          {
+            radius += El::Abs(off_diagonal[index - 1]);
+          }
+        if(index + 1 < diagonal.size())
+          {
+            radius += El::Abs(off_diagonal[index]);
+          }
+        lower = El::Min(lower, diagonal[index] - radius);
+        upper = El::Max(upper, diagonal[index] + radius);
+      }
+
+    // The step length only needs a few digits.
+    const El::BigFloat half(0.5);
+    for(size_t iteration = 0; iteration < 64; ++iteration)
+      {
+        const El::BigFloat middle((lower + upper) * half);
+        if(num_eigenvalues_below(diagonal, off_diagonal, middle) > 0)
+          {
+            upper = middle;
+          }
+        else
+          {
+            lower = middle;
+          }
+      }
+    return lower;
+  }
+
+  // |s_k|, the last component of the normalized eigenvector of the
+  // tridiagonal matrix for its eigenvalue theta.  The residual norm of
+  // the Ritz vector is beta_k |s_k|.  With at most
+  // max_lanczos_iterations rows, the forward recurrence is accurate
+  // enough at BigFloat precision.
+  El::BigFloat
+  last_eigenvector_component(const std::vector<El::BigFloat> &diagonal,
+                             const std::vector<El::BigFloat> &off_diagonal,
+                             const El::BigFloat &theta)
+  {
+    std::vector<El::BigFloat> x(diagonal.size());
+    x[0] = 1;
+    El::BigFloat norm_squared(1);
+    for(size_t index = 0; index + 1 < diagonal.size(); ++index)
+      {
+        x[index + 1] = (theta - diagonal[index]) * x[index];
+        if(index > 0)
+          {
+            x[index + 1] -= off_diagonal[index - 1] * x[index - 1];
+          }
+        x[index + 1] /= off_diagonal[index];
+        norm_squared += x[index + 1] * x[index + 1];
+      }
+    return El::Min(El::Abs(x.back()) / El::Sqrt(norm_squared),
+                   El::BigFloat(1));
+  }
+
+  El::BigFloat lanczos_min_eigenvalue(const El::DistMatrix<El::BigFloat> &A)
+  {
+    const int64_t dimension(A.Height());
+    const int64_t num_iterations(std::min(dimension, max_lanczos_iterations));
+
+    // Columns of V are the Lanczos vectors.
+    El::DistMatrix<El::BigFloat> V(A.Grid()), w(A.Grid()),
+      coefficients(A.Grid());
+    El::Zeros(V, dimension, num_iterations);
+
+    // A fixed, generic starting vector, so that every rank agrees.
+    El::DistMatrix<El::BigFloat> v0(El::View(V, 0, 0, dimension, 1));
+    for(int64_t row = 0; row < v0.LocalHeight(); ++row)
+      for(int64_t column = 0; column < v0.LocalWidth(); ++column)
+        {
+          const int64_t global_row(v0.GlobalRow(row));
+          v0.SetLocal(row, column,
+                      El::BigFloat(1 + (global_row * 7919) % 104729)
+                        / El::BigFloat(104729));
+        }
+    El::Scale(El::BigFloat(1) / El::Nrm2(v0), v0);
+
+    std::vector<El::BigFloat> diagonal, off_diagonal;
+    // The norm of the part of A V that is outside of the span of V
+    El::BigFloat residual_beta(0);
+    const El::BigFloat breakdown(El::limits::Epsilon<El::BigFloat>()
+                                 * El::FrobeniusNorm(A));
+    for(int64_t iteration = 0; iteration < num_iterations; ++iteration)
+      {
+        const El::DistMatrix<El::BigFloat> v(
+          El::LockedView(V, 0, iteration, dimension, 1)),
+          V_iteration(El::LockedView(V, 0, 0, dimension, iteration + 1));
+
+        El::Zeros(w, dimension, 1);
+        El::Gemv(El::OrientationNS::NORMAL, El::BigFloat(1), A, v,
+                 El::BigFloat(0), w);
+        diagonal.push_back(El::Dot(v, w));
+
+        // Orthogonalize against all previous vectors.  Doing it twice
+        // keeps the basis orthogonal to working precision.
+        for(size_t pass = 0; pass < 2; ++pass)
+          {
+            El::Zeros(coefficients, iteration + 1, 1);
+            El::Gemv(El::OrientationNS::TRANSPOSE, El::BigFloat(1),
+                     V_iteration, w, El::BigFloat(0), coefficients);
+            El::Gemv(El::OrientationNS::NORMAL, El::BigFloat(-1),
+                     V_iteration, coefficients, El::BigFloat(1), w);
+          }
+
+        const El::BigFloat beta(El::Nrm2(w));
+        if(beta <= breakdown)
+          {
+            break;
+          }
+        if(iteration + 1 == num_iterations)
+          {
+            residual_beta = beta;
+            break;
+          }
+        off_diagonal.push_back(beta);
+        El::DistMatrix<El::BigFloat> v_next(
+          El::View(V, 0, iteration + 1, dimension, 1));
+        El::Copy(w, v_next);
+        El::Scale(El::BigFloat(1) / beta, v_next);
+      }
+    const El::BigFloat theta(
+      tridiagonal_min_eigenvalue(diagonal, off_diagonal));
+    if(residual_beta == El::BigFloat(0))
+      {
+        return theta;
+      }
+    return theta
+           - residual_beta
+               * last_eigenvector_component(diagonal, off_diagonal, theta);
+  }
+}
+
+El::BigFloat min_eigenvalue_lanczos(const Block_Diagonal_Matrix &A)
+{
+  El::BigFloat local_min(El::limits::Max<El::BigFloat>());
+  for(auto &block : A.blocks)
+    {
+      local_min = El::Min(local_min, lanczos_min_eigenvalue(block));
+    }
+  return local_min;
+}
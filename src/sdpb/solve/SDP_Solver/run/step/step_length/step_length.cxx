@@ -1,4 +1,16 @@
 #include "../../../../SDP_Solver.hxx"
+#include "../../../../Step_Workspace.hxx"
+#include "../../../../Reduction_Batch.hxx"
+#include "../../../../block_kernels.hxx"
+#include "../../../../../../parallel_for.hxx"
+#include "../../../../../solver_comm.hxx"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
 
 // min(gamma \alpha(M, dM), 1), where \alpha(M, dM) denotes the
 // largest positive real number such that M + \alpha dM is positive
@@ -9,40 +21,279 @@
 // + \alpha L^{-1} dM L^{-T}.  The correct \alpha is then -1/lambda,
 // where lambda is the smallest eigenvalue of L^{-1} dM L^{-T}.
 //
+// With Step_Length_Algorithm::lanczos, lambda is only estimated, and
+// the estimate may be above the true minimum.  The resulting step is
+// accepted only if M + (step / gamma) dM is positive definite, which
+// proves that step < gamma \alpha(M, dM), so the safety margin of
+// stepLengthReduction is kept.  Otherwise, we fall back to computing
+// every eigenvalue.  The matrices between M and M + (step / gamma) dM
+// are then positive definite too, so M + step dM is factored as well
+// and kept in next_cholesky, so that the next iteration does not have
+// to factor it again.
+//
 // Inputs:
-// - MCholesky = L, the Cholesky decomposition of M (M itself is not needed)
+// - M (only used by the lanczos check)
+// - MCholesky = L, the Cholesky decomposition of M
 // - dM, a Block_Diagonal_Matrix with the same structure as M
 // Workspace:
 // - MInvDM (NB: overwritten when computing minEigenvalue)
 // - eigenvalues, a Vector of eigenvalues for each block of M
 // Output:
-// - min(\gamma \alpha(M, dM), 1) (returned)
+// - min(\gamma \alpha(M, dM), 1), for M = X (primal_step_length) and
+//   M = Y (dual_step_length)
+//
+// The primal and dual step lengths are computed together, so that
+// each of the reductions over ranks is done once for both, and with
+// threadsPerProc > 1 the congruences and eigenvalues of the blocks of
+// both matrices are computed concurrently.
+//
+// The distributed eigensolver is dominated by communication for small
+// blocks.  So distributed blocks with at most max_gathered_height rows
+// are instead gathered onto one rank of their grid, chosen to balance
+// the O(height^3) work, and solved there locally.  That is a single
+// collective per block, and the ranks of a grid then solve their
+// blocks at the same time, together with the local blocks.
 
 // A := L^{-1} A L^{-T}
-void lower_triangular_inverse_congruence(const Block_Diagonal_Matrix &L,
-                                         Block_Diagonal_Matrix &A);
+void lower_triangular_inverse_congruence(const El::DistMatrix<El::BigFloat> &L,
+                                         El::DistMatrix<El::BigFloat> &A);
+
+El::BigFloat min_eigenvalue(El::DistMatrix<El::BigFloat> &block);
+El::BigFloat min_eigenvalue(El::Matrix<El::BigFloat> &block);
+
+El::BigFloat min_eigenvalue_lanczos(const Block_Diagonal_Matrix &A);
 
-El::BigFloat min_eigenvalue(Block_Diagonal_Matrix &A);
+bool is_positive_definite_after_step(const Block_Diagonal_Matrix &M,
+                                     const Block_Diagonal_Matrix &dM,
+                                     const El::BigFloat &alpha,
+                                     Block_Diagonal_Matrix &M_cholesky_next);
 
-El::BigFloat step_length(const Block_Diagonal_Matrix &MCholesky,
-                         const Block_Diagonal_Matrix &dM,
-                         const El::BigFloat &gamma,
-                         const std::string &timer_name,
-                         Timers &timers)
+namespace
 {
-  auto &step_length_timer(
-        timers.add_and_start(timer_name));
+  const int64_t max_gathered_height(512);
+
+  El::BigFloat
+  step_length_from_eigenvalue(const El::BigFloat &lambda,
+                              const El::BigFloat &gamma)
+  {
+    if(lambda > -gamma)
+      {
+        return 1;
+      }
+    else
+      {
+        return -gamma / lambda;
+      }
+  }
+}
+
+void step_lengths(const Block_Diagonal_Matrix &X,
+                  const Block_Diagonal_Matrix &X_cholesky,
+                  const Block_Diagonal_Matrix &dX,
+                  const Block_Diagonal_Matrix &Y,
+                  const Block_Diagonal_Matrix &Y_cholesky,
+                  const Block_Diagonal_Matrix &dY, const El::BigFloat &gamma,
+                  const Step_Length_Algorithm &algorithm,
+                  const size_t &num_threads, El::BigFloat &primal_step_length,
+                  El::BigFloat &dual_step_length,
+                  Step_Workspace::Next_Cholesky *next_cholesky,
+                  Timers &timers)
+{
+  const std::array<std::string, 2> timer_names(
+    {"run.step.stepLength(XCholesky)", "run.step.stepLength(YCholesky)"});
+  const std::array<const Block_Diagonal_Matrix *, 2> cholesky(
+    {&X_cholesky, &Y_cholesky}),
+    M({&X, &Y}), dM({&dX, &dY});
+  const std::array<El::BigFloat *, 2> result(
+    {&primal_step_length, &dual_step_length});
+
   // MInvDM = L^{-1} dM L^{-T}, where M = L L^T
-  Block_Diagonal_Matrix MInvDM(dM);
-  lower_triangular_inverse_congruence(MCholesky, MInvDM);
-  const El::BigFloat lambda(min_eigenvalue(MInvDM));
-  step_length_timer.stop();
-  if(lambda > -gamma)
+  std::vector<Block_Diagonal_Matrix> MInvDM;
+  MInvDM.reserve(2);
+  MInvDM.emplace_back(dX);
+  MInvDM.emplace_back(dY);
+
+  // The per block work for X and Y is independent.  Blocks on a
+  // single process make no MPI calls, so those of both matrices are
+  // shared among the threads.  Distributed blocks are done on this
+  // thread first.
+  std::vector<std::pair<size_t, size_t>> distributed_items, local_items;
+  for(size_t index = 0; index < 2; ++index)
+    for(size_t block = 0; block < dM[index]->blocks.size(); ++block)
+      {
+        (is_single_process(dM[index]->blocks[block]) ? local_items
+                                                     : distributed_items)
+          .emplace_back(index, block);
+      }
+  auto for_each_block(
+    [&](const std::function<void(const size_t &, const size_t &)> &f) {
+      std::array<std::atomic<int64_t>, 2> nanoseconds;
+      nanoseconds[0] = 0;
+      nanoseconds[1] = 0;
+      auto timed([&](const std::pair<size_t, size_t> &item) {
+        const auto start(std::chrono::high_resolution_clock::now());
+        f(item.first, item.second);
+        nanoseconds[item.first]
+          += std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::high_resolution_clock::now() - start)
+               .count();
+      });
+      for(auto &item : distributed_items)
+        {
+          timed(item);
+        }
+      parallel_for(num_threads, local_items.size(),
+                   [&](const size_t &item) { timed(local_items[item]); });
+      for(size_t index = 0; index < 2; ++index)
+        {
+          timers.add_elapsed(
+            timer_names[index],
+            std::chrono::nanoseconds(nanoseconds[index].load()));
+        }
+    });
+
+  for_each_block([&](const size_t &index, const size_t &block) {
+    lower_triangular_inverse_congruence(cholesky[index]->blocks[block],
+                                        MInvDM[index].blocks[block]);
+  });
+
+  Reduction_Batch batch;
+  std::array<El::BigFloat, 2> lambda;
+  std::array<bool, 2> is_done({false, false});
+  if(algorithm == Step_Length_Algorithm::lanczos)
+    {
+      if(!next_cholesky)
+        {
+          throw std::runtime_error(
+            "step_lengths: no storage for the next Cholesky factors");
+        }
+      const std::array<Block_Diagonal_Matrix *, 2> cholesky_next(
+        {&next_cholesky->X, &next_cholesky->Y});
+      for(size_t index = 0; index < 2; ++index)
+        {
+          auto &timer(timers.add_and_start(timer_names[index]));
+          batch.min(min_eigenvalue_lanczos(MInvDM[index]), lambda[index]);
+          timer.stop();
+        }
+      batch.reduce(solver_comm());
+
+      std::array<El::BigFloat, 2> is_positive_definite;
+      for(size_t index = 0; index < 2; ++index)
+        {
+          auto &timer(timers.add_and_start(timer_names[index]));
+          *result[index] = step_length_from_eigenvalue(lambda[index], gamma);
+          batch.min(El::BigFloat(is_positive_definite_after_step(
+                                   *M[index], *dM[index],
+                                   *result[index] / gamma,
+                                   *cholesky_next[index])
+                                   ? 1
+                                   : 0),
+                    is_positive_definite[index]);
+          timer.stop();
+        }
+      batch.reduce(solver_comm());
+      std::array<El::BigFloat, 2> is_factored;
+      for(size_t index = 0; index < 2; ++index)
+        {
+          is_done[index] = (is_positive_definite[index] == El::BigFloat(1));
+          auto &timer(timers.add_and_start(timer_names[index]));
+          batch.min(El::BigFloat(is_done[index]
+                                     && is_positive_definite_after_step(
+                                       *M[index], *dM[index], *result[index],
+                                       *cholesky_next[index])
+                                   ? 1
+                                   : 0),
+                    is_factored[index]);
+          timer.stop();
+        }
+      batch.reduce(solver_comm());
+      next_cholesky->is_X_valid = (is_factored[0] == El::BigFloat(1));
+      next_cholesky->is_Y_valid = (is_factored[1] == El::BigFloat(1));
+    }
+
+  if(is_done[0] && is_done[1])
+    {
+      return;
+    }
+  std::array<std::vector<El::BigFloat>, 2> block_min;
+  for(size_t index = 0; index < 2; ++index)
+    {
+      block_min[index].resize(MInvDM[index].blocks.size(),
+                              El::limits::Max<El::BigFloat>());
+    }
+  struct Gathered_Block
+  {
+    size_t index, block;
+    El::Matrix<El::BigFloat> matrix;
+  };
+  std::vector<Gathered_Block> gathered_blocks;
+  // The work given to each rank of the grid by the gathers
+  std::vector<double> root_loads;
+  for_each_block([&](const size_t &index, const size_t &block) {
+    if(is_done[index])
+      {
+        return;
+      }
+    El::DistMatrix<El::BigFloat> &M_block(MInvDM[index].blocks[block]);
+    if(is_single_process(M_block) || M_block.Height() > max_gathered_height)
+      {
+        block_min[index][block] = min_eigenvalue(M_block);
+        return;
+      }
+    // Only distributed blocks get here, and those are done in the same
+    // order on every rank of the grid.
+    root_loads.resize(M_block.Grid().Size(), 0);
+    const int root(std::distance(
+      root_loads.begin(),
+      std::min_element(root_loads.begin(), root_loads.end())));
+    root_loads[root] += std::pow(double(M_block.Height()), 3);
+    El::DistMatrix<El::BigFloat, El::CIRC, El::CIRC> gathered(
+      M_block.Grid(), root);
+    gathered = M_block;
+    if(gathered.CrossRank() == gathered.Root())
+      {
+        gathered_blocks.push_back({index, block, gathered.LockedMatrix()});
+      }
+  });
+  {
+    std::array<std::atomic<int64_t>, 2> nanoseconds;
+    nanoseconds[0] = 0;
+    nanoseconds[1] = 0;
+    parallel_for(num_threads, gathered_blocks.size(), [&](const size_t &item) {
+      const auto start(std::chrono::high_resolution_clock::now());
+      Gathered_Block &gathered(gathered_blocks[item]);
+      block_min[gathered.index][gathered.block]
+        = min_eigenvalue(gathered.matrix);
+      nanoseconds[gathered.index]
+        += std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::high_resolution_clock::now() - start)
+             .count();
+    });
+    for(size_t index = 0; index < 2; ++index)
+      {
+        timers.add_elapsed(
+          timer_names[index],
+          std::chrono::nanoseconds(nanoseconds[index].load()));
+      }
+  }
+  for(size_t index = 0; index < 2; ++index)
     {
-      return 1;
+      if(!is_done[index])
+        {
+          El::BigFloat local_min(El::limits::Max<El::BigFloat>());
+          for(auto &block_lambda : block_min[index])
+            {
+              local_min = El::Min(local_min, block_lambda);
+            }
+          batch.min(local_min, lambda[index]);
+        }
     }
-  else
+  batch.reduce(solver_comm());
+  for(size_t index = 0; index < 2; ++index)
     {
-      return -gamma / lambda;
+      if(!is_done[index])
+        {
+          *result[index] = step_length_from_eigenvalue(lambda[index], gamma);
+        }
     }
 }
@@ -0,0 +1,198 @@
+// Append one JSON record per iteration to metricsFile, for job
+// monitoring.  Each record has the objectives, errors and step
+// lengths, the forecast of the remaining iterations and seconds (null
+// while there is none, see Convergence_Forecast.hxx), and for each
+// phase the max, min and mean over ranks of the time spent in the
+// current iteration, along with the MPI
+// messages, bytes and blocking time in that phase (see
+// mpi_statistics.cxx).  It also has the peak resident memory and the
+// bytes sent by synchronize_Q since the last record, as the max and
+// total over ranks.
+//
+// This is collective.  Only the root writes.  The first call in a
+// process starts a new file.
+
+#include "../../SDP_Solver.hxx"
+#include "../../Convergence_Forecast.hxx"
+#include "../../../../Timers.hxx"
+#include "../../../solver_comm.hxx"
+
+#include <boost/filesystem/fstream.hpp>
+
+#include <sys/resource.h>
+
+#include <cmath>
+#include <limits>
+
+int64_t synchronize_Q_bytes_sent();
+
+namespace
+{
+  // The same list on every rank, so that the reductions line up.
+  const std::vector<std::string> phases(
+    {"run.checkpoint", "run.objectives", "run.choleskyDecomposition",
+     "run.bilinear_pairings", "run.computeDualResidues",
+     "run.computePrimalResidues", "run.reduce", "run.step",
+     "run.step.frobenius_product_symmetric",
+     "run.step.initializeSchurComplementSolver",
+     "run.step.initializeSchurComplementSolver.schur_complement",
+     "run.step.initializeSchurComplementSolver.Q",
+     "run.step.initializeSchurComplementSolver.Q.synchronize_Q",
+     "run.step.initializeSchurComplementSolver.Q.synchronize_Q.wait",
+     "run.step.initializeSchurComplementSolver.Q.synchronize_Q.wait.node",
+     "run.step.initializeSchurComplementSolver.Q.synchronize_Q.wait."
+     "cross_node",
+     "run.step.initializeSchurComplementSolver.Cholesky",
+     "run.step.computeSearchDirection(products)",
+     "run.step.computeSearchDirection(betaPredictor)",
+     "run.step.computeSearchDirection(betaCorrector)",
+     "run.step.computeSearchDirection(extraCorrectors)",
+     "run.step.stepLength(XCholesky)", "run.step.stepLength(YCholesky)"});
+
+  bool is_first_write(true);
+  int64_t last_bytes_sent(0);
+
+  // JSON has no inf or nan.
+  void write_number(std::ostream &os, const double &x)
+  {
+    if(std::isfinite(x))
+      {
+        os << x;
+      }
+    else
+      {
+        os << "null";
+      }
+  }
+}
+
+void write_iteration_metrics(
+  const boost::filesystem::path &metrics_file, const int &iteration,
+  const El::BigFloat &mu, const El::BigFloat &primal_step_length,
+  const El::BigFloat &dual_step_length, const El::BigFloat &beta_corrector,
+  const SDP_Solver &sdp_solver,
+  const std::chrono::time_point<std::chrono::high_resolution_clock>
+    &solver_start_time,
+  const Convergence_Forecast &forecast, const Timers &timers)
+{
+  if(metrics_file.empty())
+    {
+      return;
+    }
+
+  const size_t num_phases(phases.size());
+  // The time of each phase in this iteration, reduced over ranks.
+  std::vector<double> max_seconds(num_phases), min_seconds(num_phases),
+    sum_seconds(num_phases);
+  for(size_t phase = 0; phase < num_phases; ++phase)
+    {
+      const Timer_Statistics *statistics(timers.find(phases[phase]));
+      max_seconds[phase]
+        = (statistics == nullptr
+             ? 0
+             : Timer_Statistics::seconds(statistics->iteration_total));
+    }
+  min_seconds = sum_seconds = max_seconds;
+  El::mpi::AllReduce(max_seconds.data(), num_phases, El::mpi::MAX,
+                     solver_comm());
+  El::mpi::AllReduce(min_seconds.data(), num_phases, El::mpi::MIN,
+                     solver_comm());
+  El::mpi::AllReduce(sum_seconds.data(), num_phases, El::mpi::SUM,
+                     solver_comm());
+
+  // The MPI traffic of each phase, as {messages, bytes, blocking
+  // seconds}, reduced over ranks.
+  std::vector<double> max_mpi(3 * num_phases), sum_mpi;
+  for(size_t phase = 0; phase < num_phases; ++phase)
+    {
+      const Timer_Statistics *statistics(timers.find(phases[phase]));
+      if(statistics != nullptr)
+        {
+          max_mpi[3 * phase] = statistics->iteration_mpi.messages;
+          max_mpi[3 * phase + 1] = statistics->iteration_mpi.bytes;
+          max_mpi[3 * phase + 2] = Timer_Statistics::seconds(
+            statistics->iteration_mpi.blocking);
+        }
+    }
+  sum_mpi = max_mpi;
+  El::mpi::AllReduce(max_mpi.data(), max_mpi.size(), El::mpi::MAX,
+                     solver_comm());
+  El::mpi::AllReduce(sum_mpi.data(), sum_mpi.size(), El::mpi::SUM,
+                     solver_comm());
+
+  // ru_maxrss is in kilobytes on Linux.
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  const int64_t peak_rss(int64_t(usage.ru_maxrss) * 1024),
+    bytes_sent(synchronize_Q_bytes_sent() - last_bytes_sent);
+  last_bytes_sent = synchronize_Q_bytes_sent();
+  const int64_t max_peak_rss(El::mpi::AllReduce(peak_rss, El::mpi::MAX,
+                                                solver_comm())),
+    total_peak_rss(
+      El::mpi::AllReduce(peak_rss, El::mpi::SUM, solver_comm())),
+    max_bytes_sent(
+      El::mpi::AllReduce(bytes_sent, El::mpi::MAX, solver_comm())),
+    total_bytes_sent(
+      El::mpi::AllReduce(bytes_sent, El::mpi::SUM, solver_comm()));
+
+  if(El::mpi::Rank(solver_comm()) != 0)
+    {
+      return;
+    }
+  boost::filesystem::ofstream metrics(
+    metrics_file, is_first_write ? std::ios::out : std::ios::app);
+  is_first_write = false;
+  metrics.precision(std::numeric_limits<double>::max_digits10);
+
+  metrics << "{\"iteration\":" << iteration << ",\"elapsed_seconds\":"
+          << std::chrono::duration<double>(
+               std::chrono::high_resolution_clock::now() - solver_start_time)
+               .count();
+  const std::vector<std::pair<std::string, El::BigFloat>> values(
+    {{"mu", mu},
+     {"primal_objective", sdp_solver.primal_objective},
+     {"dual_objective", sdp_solver.dual_objective},
+     {"duality_gap", sdp_solver.duality_gap},
+     {"primal_error_P", sdp_solver.primal_error_P},
+     {"primal_error_p", sdp_solver.primal_error_p},
+     {"dual_error", sdp_solver.dual_error},
+     {"primal_step_length", primal_step_length},
+     {"dual_step_length", dual_step_length},
+     {"beta_corrector", beta_corrector}});
+  for(auto &value : values)
+    {
+      metrics << ",\"" << value.first << "\":";
+      write_number(metrics, static_cast<double>(value.second));
+    }
+  metrics << ",\"forecast\":{\"iterations\":";
+  write_number(metrics, forecast.remaining_iterations());
+  metrics << ",\"seconds\":";
+  write_number(metrics, forecast.remaining_seconds());
+  metrics << "}";
+  metrics << ",\"peak_rss_bytes\":{\"max\":" << max_peak_rss
+          << ",\"total\":" << total_peak_rss << "}"
+          << ",\"synchronize_Q_bytes\":{\"max\":" << max_bytes_sent
+          << ",\"total\":" << total_bytes_sent << "}"
+          << ",\"phases\":{";
+  const int num_procs(El::mpi::Size(solver_comm()));
+  for(size_t phase = 0; phase < num_phases; ++phase)
+    {
+      metrics << (phase == 0 ? "" : ",") << "\"" << phases[phase]
+              << "\":{\"max\":" << max_seconds[phase]
+              << ",\"min\":" << min_seconds[phase]
+              << ",\"mean\":" << sum_seconds[phase] / num_procs
+              << ",\"mpi_messages\":{\"max\":" << max_mpi[3 * phase]
+              << ",\"total\":" << sum_mpi[3 * phase] << "}"
+              << ",\"mpi_bytes\":{\"max\":" << max_mpi[3 * phase + 1]
+              << ",\"total\":" << sum_mpi[3 * phase + 1] << "}"
+              << ",\"mpi_blocking\":{\"max\":" << max_mpi[3 * phase + 2]
+              << ",\"mean\":" << sum_mpi[3 * phase + 2] / num_procs
+              << "}}";
+    }
+  metrics << "}}\n" << std::flush;
+  if(!metrics.good())
+    {
+      throw std::runtime_error("Error when writing to: "
+                               + metrics_file.string());
+    }
+}
@@ -1,41 +1,133 @@
+#include "checkpoint_compression.hxx"
 #include "../SDP_Solver.hxx"
+#include "../serialize_local.hxx"
+#include "../compact_BigFloat.hxx"
+#include "../../solver_comm.hxx"
 
 #include <boost/filesystem.hpp>
-#include <boost/filesystem/fstream.hpp>
-#include <boost/property_tree/json_parser.hpp>
+
+#include <array>
+#include <cstring>
+
+void write_single_file_checkpoint(const boost::filesystem::path &filename,
+                                  const Block_Info &block_info,
+                                  const SDP_Solver &solver);
+void write_checkpoint_metadata(const SDP_Solver_Parameters &parameters,
+                               const int64_t &current_generation,
+                               const int64_t &backup_generation);
 
 // We use binary checkpointing because writing text does not write all
 // of the necessary digits.  The GMP library sets it to one less than
 // required for round-tripping.
+//
+// The local blocks are serialized into a staging buffer, which is
+// then written by a Checkpoint_Writer.  With asynchronous, the write
+// happens on a background thread, and the checkpoint is finalized in
+// finish_checkpoint() once every rank's file is on disk.
+//
+// Each file starts with per_rank_checkpoint_magic and the global
+// indices of the rank's blocks.  Every block then records its local
+// size and its shifts and strides in the grid, so that
+// load_binary_checkpoint can map every local element back to its
+// global position, and a checkpoint can be loaded with a different
+// number of processes or block mapping.
+//
+// With compressCheckpoint, the file starts with
+// per_rank_compressed_checkpoint_magic instead.  The elements of each
+// block are then encoded and compressed as described in
+// checkpoint_compression.hxx, and stored after the block header as
+// the uncompressed size, the compressed size and the compressed
+// bytes.
+//
+// With singleFileCheckpoint, all ranks instead write one file with
+// collective MPI-IO (see single_file_checkpoint.cxx).  That is always
+// synchronous.
+void write_local_blocks_header(const std::vector<size_t> &block_indices,
+                               std::vector<char> &buffer)
+{
+  std::vector<int64_t> header(1, block_indices.size());
+  header.insert(header.end(), block_indices.begin(), block_indices.end());
+  const size_t offset(buffer.size());
+  buffer.resize(offset + header.size() * sizeof(int64_t));
+  std::memcpy(buffer.data() + offset, header.data(),
+              header.size() * sizeof(int64_t));
+}
+
 template <typename T>
-void write_local_blocks(const T &t,
-                        boost::filesystem::ofstream &checkpoint_stream)
+void write_compressed_local_blocks(const T &t, std::vector<char> &buffer)
 {
+  std::vector<char> encoded;
+  for(auto &block : t.blocks)
+    {
+      const std::array<int64_t, 6> block_header(
+        {{block.LocalHeight(), block.LocalWidth(), block.ColShift(),
+          block.RowShift(), block.ColStride(), block.RowStride()}});
+      encoded.clear();
+      for(int64_t row = 0; row < block.LocalHeight(); ++row)
+        for(int64_t column = 0; column < block.LocalWidth(); ++column)
+          {
+            const El::BigFloat &element(block.GetLocal(row, column));
+            const size_t offset(encoded.size());
+            encoded.resize(offset + max_compact_size(element));
+            const El::byte *end(write_compact(
+              element.gmp_float.get_mpf_t(),
+              reinterpret_cast<El::byte *>(encoded.data() + offset)));
+            encoded.resize(reinterpret_cast<const char *>(end)
+                           - encoded.data());
+          }
+
+      const size_t offset(buffer.size());
+      buffer.resize(offset + sizeof(block_header) + 2 * sizeof(uint64_t));
+      checkpoint_compression::compress(encoded.data(), encoded.size(),
+                                       buffer);
+      const std::array<uint64_t, 2> sizes(
+        {{encoded.size(), buffer.size() - offset - sizeof(block_header)
+                            - 2 * sizeof(uint64_t)}});
+      std::memcpy(buffer.data() + offset, block_header.data(),
+                  sizeof(block_header));
+      std::memcpy(buffer.data() + offset + sizeof(block_header),
+                  sizes.data(), sizeof(sizes));
+    }
+}
+
+template <typename T>
+void write_local_blocks(const T &t, const bool &compress,
+                        std::vector<char> &buffer)
+{
+  if(compress)
+    {
+      write_compressed_local_blocks(t, buffer);
+      return;
+    }
   El::BigFloat zero(0);
   const size_t serialized_size(zero.SerializedSize());
-  std::vector<uint8_t> local_array(serialized_size);
 
   for(auto &block : t.blocks)
     {
-      int64_t local_height(block.LocalHeight()),
+      const int64_t local_height(block.LocalHeight()),
         local_width(block.LocalWidth());
-      checkpoint_stream.write(reinterpret_cast<char *>(&local_height),
-                              sizeof(int64_t));
-      checkpoint_stream.write(reinterpret_cast<char *>(&local_width),
-                              sizeof(int64_t));
-      for(int64_t row = 0; row < local_height; ++row)
-        for(int64_t column = 0; column < local_width; ++column)
-          {
-            block.GetLocal(row, column).Serialize(local_array.data());
-            checkpoint_stream.write(
-              reinterpret_cast<char *>(local_array.data()),
-              std::streamsize(local_array.size()));
-          }
+      const std::array<int64_t, 6> block_header(
+        {{local_height, local_width, block.ColShift(), block.RowShift(),
+          block.ColStride(), block.RowStride()}});
+      size_t offset(buffer.size());
+      buffer.resize(offset + sizeof(block_header)
+                    + local_height * local_width * serialized_size);
+      std::memcpy(buffer.data() + offset, block_header.data(),
+                  sizeof(block_header));
+      offset += sizeof(block_header);
+      serialize_local(block.LockedMatrix(), serialized_size,
+                      reinterpret_cast<El::byte *>(buffer.data() + offset));
     }
 }
 
-void SDP_Solver::save_checkpoint(const SDP_Solver_Parameters &parameters)
+void SDP_Solver::save_checkpoint(const SDP_Solver_Parameters &parameters,
+                                 const Block_Info &block_info,
+                                 const bool &asynchronous)
 {
+  // Only one checkpoint is in flight at a time, so that the rotation
+  // below never removes a file that checkpoint.json points to.
+  finish_checkpoint(parameters, true);
+
   const boost::filesystem::path &checkpoint_directory(
     parameters.checkpoint_out);
 
@@ -49,71 +141,69 @@ void SDP_Solver::save_checkpoint(const SDP_Solver_Parameters &parameters)
                                + checkpoint_directory.string()
                                + "'already exists, but is not a directory");
     }
+  // The backup may have been written in either format.
   if(backup_generation)
     {
       remove(checkpoint_directory
              / ("checkpoint_" + std::to_string(backup_generation.value()) + "_"
-                + std::to_string(El::mpi::Rank())));
+                + std::to_string(El::mpi::Rank(solver_comm()))));
+      if(El::mpi::Rank(solver_comm()) == 0)
+        {
+          remove(checkpoint_directory
+                 / ("checkpoint_" + std::to_string(backup_generation.value())
+                    + ".bin"));
+        }
     }
   backup_generation = current_generation;
   current_generation += 1;
-  boost::filesystem::path checkpoint_filename(
-    checkpoint_directory
-    / ("checkpoint_" + std::to_string(current_generation) + "_"
-       + std::to_string(El::mpi::Rank())));
 
-  const size_t max_retries(10);
-  bool wrote_successfully(false);
-  for(size_t attempt = 0; attempt < max_retries && !wrote_successfully;
-      ++attempt)
+  if(parameters.single_file_checkpoint)
     {
-      boost::filesystem::ofstream checkpoint_stream(checkpoint_filename);
-      if(parameters.verbosity >= Verbosity::regular && El::mpi::Rank() == 0)
+      if(parameters.verbosity >= Verbosity::regular
+         && El::mpi::Rank(solver_comm()) == 0)
         {
           std::cout << "Saving checkpoint to    : " << checkpoint_directory
                     << '\n';
         }
-      // TODO: Write and read precision, num of mpi procs, and procs_per_node.
-      write_local_blocks(x, checkpoint_stream);
-      write_local_blocks(X, checkpoint_stream);
-      write_local_blocks(y, checkpoint_stream);
-      write_local_blocks(Y, checkpoint_stream);
-      wrote_successfully = checkpoint_stream.good();
-      if(!wrote_successfully)
-        {
-          if(attempt + 1 < max_retries)
-            {
-              std::stringstream ss;
-              ss << "Error writing checkpoint file '" << checkpoint_filename
-                 << "'.  Retrying " << (attempt + 2) << "/" << max_retries
-                 << "\n";
-              std::cerr << ss.str() << std::flush;
-            }
-          else
-            {
-              std::stringstream ss;
-              ss << "Error writing checkpoint file '" << checkpoint_filename
-                 << "'.  Exceeded max retries.\n";
-              throw std::runtime_error(ss.str());
-            }
-        }
+      write_single_file_checkpoint(
+        checkpoint_directory
+          / ("checkpoint_" + std::to_string(current_generation) + ".bin"),
+        block_info, *this);
+      write_checkpoint_metadata(parameters, current_generation,
+                                backup_generation.value());
+      return;
     }
-  if(El::mpi::Rank() == 0)
+  boost::filesystem::path checkpoint_filename(
+    checkpoint_directory
+    / ("checkpoint_" + std::to_string(current_generation) + "_"
+       + std::to_string(El::mpi::Rank(solver_comm()))));
+
+  if(parameters.verbosity >= Verbosity::regular
+     && El::mpi::Rank(solver_comm()) == 0)
     {
-      boost::filesystem::ofstream metadata(checkpoint_directory
-                                           / "checkpoint_new.json");
-      metadata << "{\n    \"current\": " << current_generation << ",\n"
-               << "    \"backup\": " << backup_generation.value() << ",\n"
-               << "    \"version\": \"" << SDPB_VERSION_STRING
-               << "\",\n    \"options\": \n";
+      std::cout << "Saving checkpoint to    : " << checkpoint_directory
+                << '\n';
+    }
+  // TODO: Write and read precision and procs_per_node.
+  const bool &compress(parameters.compress_checkpoint);
+  const char *magic(compress ? per_rank_compressed_checkpoint_magic
+                             : per_rank_checkpoint_magic);
+  std::vector<char> buffer(magic, magic + sizeof(per_rank_checkpoint_magic));
+  write_local_blocks_header(block_info.block_indices, buffer);
+  write_local_blocks(x, compress, buffer);
+  write_local_blocks(X, compress, buffer);
+  write_local_blocks(y_block_views(), compress, buffer);
+  write_local_blocks(Y, compress, buffer);
 
-      boost::property_tree::write_json(metadata, to_property_tree(parameters));
-      metadata << "}\n";
+  checkpoint_writer.reset(
+    new Checkpoint_Writer(checkpoint_filename, std::move(buffer)));
+  if(asynchronous)
+    {
+      checkpoint_writer->start();
     }
-  El::mpi::Barrier(El::mpi::COMM_WORLD);
-  if(El::mpi::Rank() == 0)
+  else
     {
-      rename(checkpoint_directory / "checkpoint_new.json",
-             checkpoint_directory / "checkpoint.json");
+      checkpoint_writer->write_now();
+      finish_checkpoint(parameters, true);
     }
 }
@@ -1,49 +1,29 @@
 #include "../SDP_Solver.hxx"
 #include "../../../set_stream_precision.hxx"
+#include "../../solver_comm.hxx"
 
 #include <boost/filesystem/fstream.hpp>
 
 #include <iomanip>
 
-namespace
-{
-  void write_psd_block(const boost::filesystem::path &outfile,
-                       const El::DistMatrix<El::BigFloat> &block)
-  {
-    boost::filesystem::ofstream stream;
-    if(block.DistRank() == block.Root())
-      {
-        stream.open(outfile);
-      }
-    El::Print(block,
-              std::to_string(block.Height()) + " "
-                + std::to_string(block.Width()),
-              "\n", stream);
-    if(block.DistRank() == block.Root())
-      {
-        stream << "\n";
-        if(!stream.good())
-          {
-            throw std::runtime_error("Error when writing to: "
-                                     + outfile.string());
-          }
-      }
-  }
-}
+void write_distributed_text_block(const boost::filesystem::path &outfile,
+                                  const El::DistMatrix<El::BigFloat> &block);
 
 void SDP_Solver::save_solution(
   const SDP_Solver_Terminate_Reason terminate_reason,
-  const std::pair<std::string, Timer> &timer_pair,
+  const Timer_Statistics &solver_timer,
   const boost::filesystem::path &out_directory,
   const Write_Solution &write_solution,
   const std::vector<size_t> &block_indices, const Verbosity &verbosity) const
 {
+  // out.txt and y.txt are small, so they are written from the root.
   // Internally, El::Print() sync's everything to the root core and
-  // outputs it from there.  So do not actually open the file on
-  // anything but the root node.
+  // outputs it from there.  So do not actually open y.txt on anything
+  // but the root node.  The blocks of x, X and Y are written in
+  // parallel by write_distributed_text_block().
 
   boost::filesystem::ofstream out_stream;
-  if(El::mpi::Rank() == 0)
+  if(El::mpi::Rank(solver_comm()) == 0)
     {
       if(verbosity >= Verbosity::regular)
         {
@@ -58,8 +38,8 @@ void SDP_Solver::save_solution(
                  << "dualityGap      = " << duality_gap << ";\n"
                  << "primalError     = " << primal_error() << ";\n"
                  << "dualError       = " << dual_error << ";\n"
-                 << std::setw(16) << std::left << timer_pair.first << "= "
-                 << timer_pair.second.elapsed_seconds() << ";\n";
+                 << std::setw(16) << std::left << solver_timer.name << "= "
+                 << solver_timer.timer.elapsed_seconds() << ";\n";
       if(!out_stream.good())
         {
           throw std::runtime_error("Error when writing to: "
@@ -68,19 +48,18 @@ void SDP_Solver::save_solution(
     }
   // y is duplicated among cores, so only need to print out copy on
   // the root node.
-  if(write_solution.vector_y && !y.blocks.empty())
+  if(write_solution.vector_y)
     {
       const boost::filesystem::path y_path(out_directory / "y.txt");
       boost::filesystem::ofstream y_stream;
-      if(El::mpi::Rank() == 0)
+      if(El::mpi::Rank(solver_comm()) == 0)
         {
           y_stream.open(y_path);
         }
-      El::Print(y.blocks.at(0),
-                std::to_string(y.blocks.at(0).Height()) + " "
-                  + std::to_string(y.blocks.at(0).Width()),
+      El::Print(y,
+                std::to_string(y.Height()) + " " + std::to_string(y.Width()),
                 "\n", y_stream);
-      if(El::mpi::Rank() == 0)
+      if(El::mpi::Rank(solver_comm()) == 0)
         {
           y_stream << "\n";
           if(!y_stream.good())
@@ -98,24 +77,7 @@ void SDP_Solver::save_solution(
         {
           const boost::filesystem::path x_path(
             out_directory / ("x_" + std::to_string(block_index) + ".txt"));
-          boost::filesystem::ofstream x_stream;
-          if(x.blocks.at(block).DistRank() == x.blocks.at(block).Root())
-            {
-              x_stream.open(x_path);
-            }
-          El::Print(x.blocks.at(block),
-                    std::to_string(x.blocks.at(block).Height()) + " "
-                      + std::to_string(x.blocks.at(block).Width()),
-                    "\n", x_stream);
-          if(x.blocks.at(block).DistRank() == x.blocks.at(block).Root())
-            {
-              x_stream << "\n";
-              if(!x_stream.good())
-                {
-                  throw std::runtime_error("Error when writing to: "
-                                           + x_path.string());
-                }
-            }
+          write_distributed_text_block(x_path, x.blocks.at(block));
         }
       for(size_t psd_block(0); psd_block < 2; ++psd_block)
         {
@@ -125,14 +87,16 @@ void SDP_Solver::save_solution(
           if(write_solution.matrix_X
              && X.blocks.at(2 * block + psd_block).Height() != 0)
             {
-              write_psd_block(out_directory / ("X_matrix_" + suffix),
-                              X.blocks.at(2 * block + psd_block));
+              write_distributed_text_block(
+                out_directory / ("X_matrix_" + suffix),
+                X.blocks.at(2 * block + psd_block));
             }
           if(write_solution.matrix_Y
              && Y.blocks.at(2 * block + psd_block).Height() != 0)
             {
-              write_psd_block(out_directory / ("Y_matrix_" + suffix),
-                              Y.blocks.at(2 * block + psd_block));
+              write_distributed_text_block(
+                out_directory / ("Y_matrix_" + suffix),
+                Y.blocks.at(2 * block + psd_block));
             }
         }
     }
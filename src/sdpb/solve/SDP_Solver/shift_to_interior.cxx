@@ -0,0 +1,14 @@
+#include "../Block_Diagonal_Matrix.hxx"
+#include "../../solver_comm.hxx"
+
+// A solution of a nearby SDP is close to the boundary of the cone,
+// where X Y is almost zero, and the Newton steps from there are tiny.
+// Adding a multiple of the identity makes X strictly positive again.
+// The shift is relative to the largest element of X over all blocks,
+// so that it does not depend on the normalization of the SDP.
+void shift_to_interior(const El::BigFloat &shift, Block_Diagonal_Matrix &X)
+{
+  const El::BigFloat max_abs(
+    El::mpi::AllReduce(X.max_abs(), El::mpi::MAX, solver_comm()));
+  X.add_diagonal(shift * (max_abs == 0 ? El::BigFloat(1) : max_abs));
+}
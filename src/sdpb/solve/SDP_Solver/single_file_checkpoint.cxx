@@ -0,0 +1,314 @@
+#include "../SDP_Solver.hxx"
+#include "../../solver_comm.hxx"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+// A checkpoint in a single file, written and read with collective
+// MPI-IO.  The layout is global, indexed by block rather than by
+// rank:
+//
+//   Single_File_Checkpoint_Header
+//   x.blocks[0 .. J)          (schur_block_sizes[j] x 1)
+//   X.blocks[0 .. 2J)         (psd_matrix_block_sizes[b] square)
+//   y                         (N x 1, stored once)
+//   Y.blocks[0 .. 2J)         (psd_matrix_block_sizes[b] square)
+//
+// with each block stored column major, and each element as
+// El::BigFloat::Serialize() writes it.  Each rank holds all of y, so
+// y is written by the owners of block 0, and read by every rank.
+//
+// Where an element goes in the file does not depend on the number of
+// ranks or the block mapping, so a checkpoint can be read back by a
+// run with any layout.
+
+namespace
+{
+  const char checkpoint_magic[8] = {'S', 'D', 'P', 'B', 'C', 'K', 'P', 'T'};
+  const uint32_t checkpoint_version(1);
+
+  struct Single_File_Checkpoint_Header
+  {
+    char magic[8];
+    uint32_t version, serialized_size;
+    int64_t num_blocks, y_height;
+  };
+
+  void check_mpi_error(const int &mpi_error)
+  {
+    if(mpi_error != MPI_SUCCESS)
+      {
+        std::vector<char> error_string(MPI_MAX_ERROR_STRING);
+        int lengthOfErrorString;
+        MPI_Error_string(mpi_error, error_string.data(), &lengthOfErrorString);
+        El::RuntimeError(std::string(error_string.data()));
+      }
+  }
+
+  // Byte offsets in the file of the first element of every global
+  // block.
+  struct Checkpoint_Layout
+  {
+    size_t serialized_size, y_height, y_offset, file_size;
+    std::vector<size_t> x_offsets, X_offsets, Y_offsets;
+
+    Checkpoint_Layout(const Block_Info &block_info, const size_t &Y_height)
+        : serialized_size(El::BigFloat(0).SerializedSize()),
+          y_height(Y_height)
+    {
+      size_t offset(sizeof(Single_File_Checkpoint_Header));
+      for(auto &size : block_info.schur_block_sizes)
+        {
+          x_offsets.push_back(offset);
+          offset += size * serialized_size;
+        }
+      for(auto &size : block_info.psd_matrix_block_sizes)
+        {
+          X_offsets.push_back(offset);
+          offset += size * size * serialized_size;
+        }
+      y_offset = offset;
+      offset += y_height * serialized_size;
+      for(auto &size : block_info.psd_matrix_block_sizes)
+        {
+          Y_offsets.push_back(offset);
+          offset += size * size * serialized_size;
+        }
+      file_size = offset;
+    }
+  };
+
+  // The local blocks of x, X, y and Y, with the offset of each block
+  // in the file, sorted by offset.  MPI requires the displacements of
+  // a file view to be nondecreasing, and the elements of each block
+  // are visited in increasing order below, so sorting the blocks is
+  // enough.  y is included by the owners of global block 0 when
+  // writing (is_writing), and by every rank when reading.
+  template <typename Solver, typename Matrix>
+  std::vector<std::pair<size_t, Matrix *>>
+  local_blocks(Solver &solver, const Block_Info &block_info,
+               const Checkpoint_Layout &layout, const bool &is_writing)
+  {
+    std::vector<std::pair<size_t, Matrix *>> result;
+    const std::vector<size_t> &block_indices(block_info.block_indices);
+    if(!is_writing
+       || std::find(block_indices.begin(), block_indices.end(), 0)
+            != block_indices.end())
+      {
+        result.emplace_back(layout.y_offset, &solver.y);
+      }
+    for(size_t block = 0; block < block_info.block_indices.size(); ++block)
+      {
+        const size_t block_index(block_info.block_indices[block]);
+        result.emplace_back(layout.x_offsets.at(block_index),
+                            &solver.x.blocks[block]);
+        for(size_t parity = 0; parity < 2; ++parity)
+          {
+            result.emplace_back(
+              layout.X_offsets.at(2 * block_index + parity),
+              &solver.X.blocks[2 * block + parity]);
+            result.emplace_back(
+              layout.Y_offsets.at(2 * block_index + parity),
+              &solver.Y.blocks[2 * block + parity]);
+          }
+      }
+    std::sort(result.begin(), result.end(),
+              [](const std::pair<size_t, Matrix *> &a,
+                 const std::pair<size_t, Matrix *> &b) {
+                return a.first < b.first;
+              });
+    return result;
+  }
+
+  // Call f(block, local_row, local_column, offset) for every local
+  // element, in the order of their offsets in the file.
+  template <typename Matrix, typename F>
+  void for_each_local_element(
+    const std::vector<std::pair<size_t, Matrix *>> &blocks,
+    const size_t &serialized_size, const F &f)
+  {
+    for(auto &offset_block : blocks)
+      {
+        Matrix &block(*offset_block.second);
+        for(int64_t column = 0; column < block.LocalWidth(); ++column)
+          for(int64_t row = 0; row < block.LocalHeight(); ++row)
+            {
+              f(block, row, column,
+                offset_block.first
+                  + (block.GlobalCol(column) * block.Height()
+                     + block.GlobalRow(row))
+                      * serialized_size);
+            }
+      }
+  }
+
+  // A file view that selects the local elements, in the same order as
+  // for_each_local_element().  Runs of adjacent elements are merged
+  // into a single entry of the view.
+  template <typename Matrix>
+  MPI_Datatype
+  file_view(const std::vector<std::pair<size_t, Matrix *>> &blocks,
+            const size_t &serialized_size, const MPI_Datatype &element_type,
+            size_t &num_elements)
+  {
+    std::vector<int> run_lengths;
+    std::vector<MPI_Aint> run_offsets;
+    num_elements = 0;
+    for_each_local_element(
+      blocks, serialized_size,
+      [&](const El::DistMatrix<El::BigFloat> &, const int64_t &,
+          const int64_t &, const size_t &offset) {
+        ++num_elements;
+        if(!run_offsets.empty()
+           && size_t(run_offsets.back())
+                  + run_lengths.back() * serialized_size
+                == offset)
+          {
+            ++run_lengths.back();
+          }
+        else
+          {
+            run_offsets.push_back(offset);
+            run_lengths.push_back(1);
+          }
+      });
+    MPI_Datatype file_type;
+    check_mpi_error(MPI_Type_create_hindexed(
+      run_lengths.size(), run_lengths.data(), run_offsets.data(),
+      element_type, &file_type));
+    check_mpi_error(MPI_Type_commit(&file_type));
+    return file_type;
+  }
+}
+
+void write_single_file_checkpoint(const boost::filesystem::path &filename,
+                                  const Block_Info &block_info,
+                                  const SDP_Solver &solver)
+{
+  const Checkpoint_Layout layout(block_info, solver.y.Height());
+  const std::vector<std::pair<size_t, const El::DistMatrix<El::BigFloat> *>>
+    blocks(local_blocks<const SDP_Solver, const El::DistMatrix<El::BigFloat>>(
+      solver, block_info, layout, true));
+
+  MPI_Datatype element_type;
+  check_mpi_error(
+    MPI_Type_contiguous(layout.serialized_size, MPI_BYTE, &element_type));
+  check_mpi_error(MPI_Type_commit(&element_type));
+
+  size_t num_elements;
+  MPI_Datatype file_type(
+    file_view(blocks, layout.serialized_size, element_type, num_elements));
+  std::vector<El::byte> buffer(num_elements * layout.serialized_size);
+  El::byte *current(buffer.data());
+  // One temporary for all of the elements, instead of the copy that
+  // GetLocal() makes of each one
+  El::BigFloat element;
+  for_each_local_element(
+    blocks, layout.serialized_size,
+    [&](const El::DistMatrix<El::BigFloat> &block, const int64_t &row,
+        const int64_t &column, const size_t &) {
+      element = block.LockedMatrix()(row, column);
+      element.Serialize(current);
+      current += layout.serialized_size;
+    });
+
+  MPI_File file;
+  check_mpi_error(MPI_File_open(solver_comm().comm, filename.c_str(),
+                                MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                                MPI_INFO_NULL, &file));
+  check_mpi_error(MPI_File_set_size(file, layout.file_size));
+  if(El::mpi::Rank(solver_comm()) == 0)
+    {
+      Single_File_Checkpoint_Header header;
+      std::memcpy(header.magic, checkpoint_magic, sizeof(header.magic));
+      header.version = checkpoint_version;
+      header.serialized_size = layout.serialized_size;
+      header.num_blocks = block_info.schur_block_sizes.size();
+      header.y_height = layout.y_height;
+      check_mpi_error(MPI_File_write_at(file, 0, &header, sizeof(header),
+                                        MPI_BYTE, MPI_STATUS_IGNORE));
+    }
+  check_mpi_error(MPI_File_set_view(file, 0, element_type, file_type,
+                                    "native", MPI_INFO_NULL));
+  check_mpi_error(MPI_File_write_all(file, buffer.data(), num_elements,
+                                     element_type, MPI_STATUS_IGNORE));
+  check_mpi_error(MPI_File_sync(file));
+  check_mpi_error(MPI_File_close(&file));
+
+  check_mpi_error(MPI_Type_free(&file_type));
+  check_mpi_error(MPI_Type_free(&element_type));
+}
+
+void read_single_file_checkpoint(const boost::filesystem::path &filename,
+                                 const Block_Info &block_info,
+                                 SDP_Solver &solver)
+{
+  const size_t y_height(solver.y.Height());
+  const Checkpoint_Layout layout(block_info, y_height);
+
+  MPI_File file;
+  check_mpi_error(MPI_File_open(solver_comm().comm, filename.c_str(),
+                                MPI_MODE_RDONLY, MPI_INFO_NULL, &file));
+  Single_File_Checkpoint_Header header;
+  check_mpi_error(MPI_File_read_at_all(file, 0, &header, sizeof(header),
+                                       MPI_BYTE, MPI_STATUS_IGNORE));
+  MPI_Offset file_size;
+  check_mpi_error(MPI_File_get_size(file, &file_size));
+  if(std::memcmp(header.magic, checkpoint_magic, sizeof(header.magic)) != 0
+     || header.version != checkpoint_version)
+    {
+      check_mpi_error(MPI_File_close(&file));
+      throw std::runtime_error("Not a single file checkpoint: "
+                               + filename.string());
+    }
+  if(header.serialized_size != layout.serialized_size
+     || header.num_blocks != int64_t(block_info.schur_block_sizes.size())
+     || header.y_height != int64_t(y_height)
+     || size_t(file_size) != layout.file_size)
+    {
+      check_mpi_error(MPI_File_close(&file));
+      std::stringstream ss;
+      ss << "Incompatible single file checkpoint: " << filename
+         << ".  Expected " << block_info.schur_block_sizes.size()
+         << " blocks, a y of height " << y_height
+         << " and elements of size " << layout.serialized_size
+         << ", but found " << header.num_blocks << ", " << header.y_height
+         << " and " << header.serialized_size
+         << ".  The precision and the SDP must match the original run.";
+      throw std::runtime_error(ss.str());
+    }
+
+  MPI_Datatype element_type;
+  check_mpi_error(
+    MPI_Type_contiguous(layout.serialized_size, MPI_BYTE, &element_type));
+  check_mpi_error(MPI_Type_commit(&element_type));
+
+  const std::vector<std::pair<size_t, El::DistMatrix<El::BigFloat> *>> blocks(
+    local_blocks<SDP_Solver, El::DistMatrix<El::BigFloat>>(solver, block_info,
+                                                           layout, false));
+  size_t num_elements;
+  MPI_Datatype file_type(
+    file_view(blocks, layout.serialized_size, element_type, num_elements));
+  std::vector<El::byte> buffer(num_elements * layout.serialized_size);
+
+  check_mpi_error(MPI_File_set_view(file, 0, element_type, file_type,
+                                    "native", MPI_INFO_NULL));
+  check_mpi_error(MPI_File_read_all(file, buffer.data(), num_elements,
+                                    element_type, MPI_STATUS_IGNORE));
+  check_mpi_error(MPI_File_close(&file));
+  check_mpi_error(MPI_Type_free(&file_type));
+
+  El::BigFloat input;
+  const El::byte *current(buffer.data());
+  for_each_local_element(
+    blocks, layout.serialized_size,
+    [&](El::DistMatrix<El::BigFloat> &block, const int64_t &row,
+        const int64_t &column, const size_t &) {
+      input.Deserialize(current);
+      current += layout.serialized_size;
+      block.SetLocal(row, column, input);
+    });
+  check_mpi_error(MPI_Type_free(&element_type));
+}
@@ -0,0 +1,137 @@
+#include "../../../set_stream_precision.hxx"
+
+#include <El.hpp>
+#include <boost/filesystem.hpp>
+
+#include <sstream>
+
+// Write a distributed block as text, in the same layout that
+// El::Print() uses (a "height width" header, then the elements row by
+// row), with every rank in the block's grid writing its own elements
+// to the file with collective MPI-IO.  Nothing is gathered to a root.
+//
+// To let each rank compute where its elements go, every element is
+// padded with spaces to a fixed width, which is an upper bound on the
+// length of a number at the current precision.  Readers that split on
+// whitespace see the same numbers as before.
+//
+// The local rows are formatted and written in batches, so no rank
+// holds more than one batch of text at a time.
+
+namespace
+{
+  void check_mpi_error(const int &mpi_error)
+  {
+    if(mpi_error != MPI_SUCCESS)
+      {
+        std::vector<char> error_string(MPI_MAX_ERROR_STRING);
+        int lengthOfErrorString;
+        MPI_Error_string(mpi_error, error_string.data(), &lengthOfErrorString);
+        El::RuntimeError(std::string(error_string.data()));
+      }
+  }
+}
+
+void write_distributed_text_block(const boost::filesystem::path &outfile,
+                                  const El::DistMatrix<El::BigFloat> &block)
+{
+  std::stringstream ss;
+  set_stream_precision(ss);
+  // Significant digits, plus a sign, a decimal point, "e-", and the
+  // largest possible decimal exponent of an mpf.
+  const size_t field_width(ss.precision() + 4 + 21),
+    record_size(field_width + 1);
+
+  const std::string header(std::to_string(block.Height()) + " "
+                           + std::to_string(block.Width()) + "\n");
+  const size_t line_size(block.Width() * record_size);
+
+  const El::mpi::Comm &comm(block.DistComm());
+  MPI_File file;
+  check_mpi_error(MPI_File_open(comm.comm, outfile.c_str(),
+                                MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                                MPI_INFO_NULL, &file));
+  check_mpi_error(
+    MPI_File_set_size(file, header.size() + block.Height() * line_size));
+  if(El::mpi::Rank(comm) == 0)
+    {
+      check_mpi_error(MPI_File_write_at(file, 0, header.data(),
+                                        header.size(), MPI_CHAR,
+                                        MPI_STATUS_IGNORE));
+    }
+
+  MPI_Datatype record_type;
+  check_mpi_error(MPI_Type_contiguous(record_size, MPI_CHAR, &record_type));
+  check_mpi_error(MPI_Type_commit(&record_type));
+
+  // Every rank must make the same number of collective calls.
+  const int64_t batch_elements(1 << 16),
+    rows_per_batch(
+      std::max(int64_t(1), batch_elements
+                             / std::max(int64_t(1), block.LocalWidth())));
+  const int64_t num_batches(El::mpi::AllReduce(
+    (block.LocalHeight() + rows_per_batch - 1) / rows_per_batch, El::mpi::MAX,
+    comm));
+
+  const El::Matrix<El::BigFloat> &local(block.LockedMatrix());
+  std::vector<char> buffer;
+  std::vector<int> run_lengths;
+  std::vector<MPI_Aint> run_offsets;
+  std::string element;
+  for(int64_t batch = 0; batch < num_batches; ++batch)
+    {
+      buffer.clear();
+      run_lengths.clear();
+      run_offsets.clear();
+      const int64_t row_begin(std::min(batch * rows_per_batch,
+                                       block.LocalHeight())),
+        row_end(std::min(row_begin + rows_per_batch, block.LocalHeight()));
+      for(int64_t row = row_begin; row < row_end; ++row)
+        for(int64_t column = 0; column < block.LocalWidth(); ++column)
+          {
+            const int64_t global_column(block.GlobalCol(column));
+            const size_t offset(header.size()
+                                + block.GlobalRow(row) * line_size
+                                + global_column * record_size);
+            if(!run_offsets.empty()
+               && size_t(run_offsets.back())
+                      + run_lengths.back() * record_size
+                    == offset)
+              {
+                ++run_lengths.back();
+              }
+            else
+              {
+                run_offsets.push_back(offset);
+                run_lengths.push_back(1);
+              }
+
+            ss.str("");
+            ss << local(row, column);
+            element = ss.str();
+            if(element.size() > field_width)
+              {
+                throw std::runtime_error("Element too long when writing: "
+                                         + outfile.string());
+              }
+            element.resize(field_width, ' ');
+            element.push_back(global_column + 1 == block.Width() ? '\n'
+                                                                 : ' ');
+            buffer.insert(buffer.end(), element.begin(), element.end());
+          }
+
+      MPI_Datatype file_type;
+      check_mpi_error(MPI_Type_create_hindexed(
+        run_lengths.size(), run_lengths.data(), run_offsets.data(),
+        record_type, &file_type));
+      check_mpi_error(MPI_Type_commit(&file_type));
+      check_mpi_error(MPI_File_set_view(file, 0, record_type, file_type,
+                                        "native", MPI_INFO_NULL));
+      check_mpi_error(MPI_File_write_all(file, buffer.data(),
+                                         buffer.size() / record_size,
+                                         record_type, MPI_STATUS_IGNORE));
+      check_mpi_error(MPI_Type_free(&file_type));
+    }
+  check_mpi_error(MPI_File_close(&file));
+  check_mpi_error(MPI_Type_free(&record_type));
+}
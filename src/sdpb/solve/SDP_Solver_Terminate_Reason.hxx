@@ -12,9 +12,12 @@ enum class SDP_Solver_Terminate_Reason
   DualFeasible,
   PrimalFeasibleJumpDetected,
   DualFeasibleJumpDetected,
+  PrimalInfeasible,
+  DualInfeasible,
   MaxComplementarityExceeded,
   MaxIterationsExceeded,
   MaxRuntimeExceeded,
+  SignalReceived,
 };
 
 std::ostream &
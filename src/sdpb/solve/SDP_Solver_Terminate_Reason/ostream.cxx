@@ -20,6 +20,12 @@ operator<<(std::ostream &os, const SDP_Solver_Terminate_Reason &r)
     case SDP_Solver_Terminate_Reason::DualFeasibleJumpDetected:
       os << "dual feasible jump detected";
       break;
+    case SDP_Solver_Terminate_Reason::PrimalInfeasible:
+      os << "found primal infeasibility certificate";
+      break;
+    case SDP_Solver_Terminate_Reason::DualInfeasible:
+      os << "found dual infeasibility certificate";
+      break;
     case SDP_Solver_Terminate_Reason::MaxIterationsExceeded:
       os << "maxIterations exceeded";
       break;
@@ -29,6 +35,9 @@ operator<<(std::ostream &os, const SDP_Solver_Terminate_Reason &r)
     case SDP_Solver_Terminate_Reason::MaxComplementarityExceeded:
       os << "maxComplementarity exceeded";
       break;
+    case SDP_Solver_Terminate_Reason::SignalReceived:
+      os << "termination signal received";
+      break;
     }
   return os;
 }
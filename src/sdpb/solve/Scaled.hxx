@@ -0,0 +1,39 @@
+#pragma once
+
+#include <El.hpp>
+
+// The expression alpha * A, for a Block_Diagonal_Matrix or Block_Vector
+// A.  Nothing is computed when it is formed.  Adding it to a matrix
+// with the same structure, as in X += alpha * dX, updates every local
+// element in a single pass, without scaling A or making a temporary
+// copy of it.
+//
+// Only references are stored, so a Scaled must not outlive the
+// expression it appears in.
+template <typename T> struct Scaled
+{
+  const El::BigFloat &alpha;
+  const T &value;
+};
+
+// B += alpha A, for blocks with the same size and grid
+inline void add_scaled(const El::BigFloat &alpha,
+                       const El::DistMatrix<El::BigFloat> &A,
+                       El::DistMatrix<El::BigFloat> &B)
+{
+  if(A.ColAlign() != B.ColAlign() || A.RowAlign() != B.RowAlign())
+    {
+      El::Axpy(alpha, A, B);
+      return;
+    }
+  const El::Matrix<El::BigFloat> &A_local(A.LockedMatrix());
+  El::Matrix<El::BigFloat> &B_local(B.Matrix());
+  El::BigFloat product;
+  for(int64_t column = 0; column < A_local.Width(); ++column)
+    for(int64_t row = 0; row < A_local.Height(); ++row)
+      {
+        product = A_local(row, column);
+        product *= alpha;
+        B_local(row, column) += product;
+      }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../SDP_Solver_Parameters.hxx"
+
+#include <El.hpp>
+
+// The step length reduction gamma and the centering parameters beta
+// used by SDP_Solver::step().  By default these are the fixed values
+// from the parameters.  With adaptiveStepParameters, update() adjusts
+// them after every iteration: repeated short steps mean the iterates
+// have drifted from the central path, so the centering is increased
+// and gamma goes back to its default.  Long steps that also reduce
+// the complementarity let gamma grow towards the boundary and the
+// centering relax back to its defaults.
+//
+// The inputs to update() are the same on every rank, so every rank
+// makes the same choices.  The state is not checkpointed, so a
+// restarted run begins from the defaults again.
+class Step_Controller
+{
+public:
+  El::BigFloat step_length_reduction, feasible_centering_parameter,
+    infeasible_centering_parameter;
+
+  explicit Step_Controller(const SDP_Solver_Parameters &parameters);
+
+  // mu is the complementarity at the start of the iteration, and the
+  // step lengths are the ones taken from there.
+  void update(const El::BigFloat &mu, const El::BigFloat &primal_step_length,
+              const El::BigFloat &dual_step_length);
+
+private:
+  bool is_adaptive;
+  El::BigFloat default_step_length_reduction,
+    default_feasible_centering_parameter,
+    default_infeasible_centering_parameter, previous_mu,
+    previous_step_length;
+  size_t num_short_steps = 0;
+};
@@ -0,0 +1,77 @@
+#include "../Step_Controller.hxx"
+
+namespace
+{
+  // Steps shorter than this are short, and this many of them in a row
+  // trigger more centering.
+  constexpr double short_step_length(0.2);
+  constexpr size_t max_short_steps(2);
+  // A step is long if it is at least this long and the complementarity
+  // shrank by at least long_step_mu_ratio.
+  constexpr double long_step_length(0.8), long_step_mu_ratio(0.5);
+  // gamma never grows past this, unless the default is already larger.
+  constexpr double max_step_length_reduction(0.95);
+
+  // x moves the fraction (1/denominator) of the way to target
+  void move_towards(const El::BigFloat &target, const int &denominator,
+                    El::BigFloat &x)
+  {
+    x += (target - x) / denominator;
+  }
+}
+
+Step_Controller::Step_Controller(const SDP_Solver_Parameters &parameters)
+    : step_length_reduction(parameters.step_length_reduction),
+      feasible_centering_parameter(parameters.feasible_centering_parameter),
+      infeasible_centering_parameter(
+        parameters.infeasible_centering_parameter),
+      is_adaptive(parameters.adaptive_step_parameters),
+      default_step_length_reduction(parameters.step_length_reduction),
+      default_feasible_centering_parameter(
+        parameters.feasible_centering_parameter),
+      default_infeasible_centering_parameter(
+        parameters.infeasible_centering_parameter),
+      previous_mu(0), previous_step_length(0)
+{}
+
+void Step_Controller::update(const El::BigFloat &mu,
+                             const El::BigFloat &primal_step_length,
+                             const El::BigFloat &dual_step_length)
+{
+  if(!is_adaptive)
+    {
+      return;
+    }
+  // How much the previous step reduced the complementarity
+  const bool is_mu_reduced(previous_mu > El::BigFloat(0)
+                           && mu < El::BigFloat(long_step_mu_ratio)
+                                     * previous_mu);
+  const bool was_long_step(previous_step_length
+                           >= El::BigFloat(long_step_length));
+  const El::BigFloat step_length(
+    El::Min(primal_step_length, dual_step_length));
+  previous_mu = mu;
+  previous_step_length = step_length;
+
+  num_short_steps
+    = (step_length < El::BigFloat(short_step_length) ? num_short_steps + 1
+                                                      : 0);
+  if(num_short_steps >= max_short_steps)
+    {
+      move_towards(El::BigFloat(1), 4, feasible_centering_parameter);
+      move_towards(El::BigFloat(1), 4, infeasible_centering_parameter);
+      step_length_reduction = default_step_length_reduction;
+      num_short_steps = 0;
+    }
+  else if(was_long_step && is_mu_reduced
+          && step_length >= El::BigFloat(long_step_length))
+    {
+      move_towards(El::Max(El::BigFloat(max_step_length_reduction),
+                           default_step_length_reduction),
+                   2, step_length_reduction);
+      move_towards(default_feasible_centering_parameter, 2,
+                   feasible_centering_parameter);
+      move_towards(default_infeasible_centering_parameter, 2,
+                   infeasible_centering_parameter);
+    }
+}
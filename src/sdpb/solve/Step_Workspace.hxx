@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Block_Diagonal_Matrix.hxx"
+#include "Block_Matrix.hxx"
+#include "Block_Spill.hxx"
+#include "Block_Vector.hxx"
+#include "Packed_Upper_Matrix.hxx"
+#include "Q_Column_Reduction.hxx"
+#include "Q_Grid.hxx"
+#include "Q_Synchronization_Plan.hxx"
+#include "SDP.hxx"
+
+#include "../SDP_Solver_Parameters.hxx"
+
+#include <boost/optional.hpp>
+
+#include <future>
+
+// Matrices used inside SDP_Solver::step().  BigFloat matrices are
+// expensive to allocate and free, since every element has its own
+// limb allocation, so these are allocated once per run and reused in
+// every iteration.  Except for next_cholesky, none of the values carry
+// over between iterations.
+struct Step_Workspace
+{
+  // Search direction: These quantities have the same structure
+  // as (x, X, y, Y). They are computed twice each iteration:
+  // once in the predictor step, and once in the corrector step.
+  Block_Vector dx;
+  El::DistMatrix<El::BigFloat> dy;
+  Block_Diagonal_Matrix dX, dY;
+
+  // X Y and PrimalResidues Y.  These enter R and Z for every search
+  // direction of an iteration, but do not depend on beta or on the
+  // corrector, so step() computes them once per iteration.
+  Block_Diagonal_Matrix X_Y, primal_residues_Y;
+
+  // The last accepted search direction, kept while trying additional
+  // correctors.  Only allocated if maxCorrectors > 0.
+  struct Search_Direction
+  {
+    Block_Vector dx;
+    El::DistMatrix<El::BigFloat> dy;
+    Block_Diagonal_Matrix dX, dY;
+  };
+  boost::optional<Search_Direction> previous_direction;
+
+  // The Cholesky decompositions of X + primal_step_length dX and Y +
+  // dual_step_length dY, computed by the positive definiteness check
+  // of stepLengthAlgorithm=lanczos.  When they are valid, run() uses
+  // them for the next iteration instead of factoring X and Y again.
+  // Only allocated for the lanczos algorithm.  The blocks have the
+  // same precisions as X_cholesky and Y_cholesky.
+  struct Next_Cholesky
+  {
+    Block_Diagonal_Matrix X, Y;
+    bool is_X_valid = false, is_Y_valid = false;
+  };
+  boost::optional<Next_Cholesky> next_cholesky;
+
+  // SchurComplementCholesky = L', the Cholesky decomposition of the
+  // Schur complement matrix S.  S is a Block_Diagonal_Matrix with one
+  // block for each 0 <= j < J.  SchurComplement.blocks[j] has
+  // dimension (d_j+1)*m_j*(m_j+1)/2.  S is computed directly into
+  // this storage and factored in place, so S itself is never stored
+  // separately.
+  Block_Diagonal_Matrix schur_complement_cholesky;
+
+  // With schurRefinementThreshold, the blocks of
+  // schur_complement_cholesky with at least that many rows are kept
+  // at schurRefinementPrecision, so they are factored at that
+  // precision.  S for those blocks is computed into schur_complement
+  // at the full precision instead, and rounded into
+  // schur_complement_cholesky.  The other blocks of schur_complement
+  // are empty.  is_enabled is the same on every rank.
+  struct Schur_Refinement
+  {
+    bool is_enabled = false;
+    std::vector<El::DistMatrix<El::BigFloat>> schur_complement;
+  };
+  Schur_Refinement schur_refinement;
+
+  // SchurOffDiagonal = L'^{-1} FreeVarMatrix, needed in solving the
+  // Schur complement equation.
+  Block_Matrix schur_off_diagonal;
+
+  // Q = B' L'^{-T} L'^{-1} B' - {{0, 0}, {0, 1}}, where B' =
+  // (FreeVarMatrix U).  Q is needed in the factorization of the Schur
+  // complement equation.  Q has dimension N'xN', where
+  //
+  //   N' = cols(B) + cols(U) = N + cols(U)
+  //
+  // where N is the dimension of the dual objective function.
+  //
+  // If N is small, the latency of distributing Q dominates, so Q
+  // is replicated on every rank by putting it on a single rank
+  // Grid.  Every rank then does the Cholesky decomposition and
+  // solves with Q redundantly.  Otherwise Q is distributed over as
+  // many ranks as its size warrants (see Q_Grid).
+  Q_Grid Q_grid;
+  El::DistMatrix<El::BigFloat> Q;
+
+  // With overlapQCholesky, the background factorization of a
+  // replicated Q.  Not valid otherwise, or once it has been waited
+  // for.
+  std::future<void> Q_cholesky;
+
+  // Sums the contributions of the blocks to dy into Q's distribution
+  // in solve_schur_complement_equation().
+  Q_Column_Reduction dy_reduction;
+
+  // This group's contribution to Q.  Only the upper triangle is
+  // stored.
+  Packed_Upper_Matrix Q_group;
+
+  // How Q_group is summed into Q by synchronize_Q()
+  Q_Synchronization_Plan Q_synchronization_plan;
+
+  // With spillDirectory, the blocks of schur_complement_cholesky and
+  // schur_off_diagonal with at least spillThreshold rows are kept in
+  // files while they are not in use.
+  Block_Spill schur_complement_spill, schur_off_diagonal_spill;
+
+  Step_Workspace(const SDP_Solver_Parameters &parameters,
+                 const Block_Info &block_info, const SDP &sdp,
+                 const El::Grid &grid, const Block_Vector &x,
+                 const Block_Diagonal_Matrix &X,
+                 const El::DistMatrix<El::BigFloat> &y);
+};
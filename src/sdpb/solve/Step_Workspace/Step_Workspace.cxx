@@ -0,0 +1,73 @@
+#include "../Step_Workspace.hxx"
+#include "../set_block_precisions.hxx"
+
+Step_Workspace::Step_Workspace(const SDP_Solver_Parameters &parameters,
+                               const Block_Info &block_info, const SDP &sdp,
+                               const El::Grid &grid, const Block_Vector &x,
+                               const Block_Diagonal_Matrix &X,
+                               const El::DistMatrix<El::BigFloat> &y)
+    : dx(x), dy(y), dX(X), dY(X), X_Y(X), primal_residues_Y(X),
+      schur_complement_cholesky(block_info.schur_block_sizes,
+                                block_info.block_indices,
+                                block_info.schur_block_sizes.size(), grid),
+      Q_grid(parameters, sdp.dual_objective_b.Height()),
+      Q(sdp.dual_objective_b.Height(), sdp.dual_objective_b.Height(),
+        Q_grid.grid()),
+      dy_reduction(Q),
+      Q_group(Q.Height(), grid),
+      Q_synchronization_plan(Q, parameters.hierarchical_Q_reduction
+                                  ? parameters.procs_per_node
+                                  : 1),
+      schur_complement_spill(parameters.spill_directory,
+                             "schur_complement_cholesky",
+                             parameters.spill_threshold),
+      schur_off_diagonal_spill(parameters.spill_directory,
+                               "schur_off_diagonal",
+                               parameters.spill_threshold)
+{
+  const size_t refinement_precision(
+    parameters.schur_refinement_precision == 0
+      ? parameters.working_precision / 2
+      : parameters.schur_refinement_precision);
+  if(parameters.schur_refinement_threshold > 0
+     && refinement_precision < parameters.working_precision)
+    {
+      for(auto &size : block_info.schur_block_sizes)
+        {
+          schur_refinement.is_enabled
+            = schur_refinement.is_enabled
+              || size >= parameters.schur_refinement_threshold;
+        }
+    }
+  if(schur_refinement.is_enabled)
+    {
+      schur_refinement.schur_complement.reserve(
+        schur_complement_cholesky.blocks.size());
+      for(auto &block : schur_complement_cholesky.blocks)
+        {
+          if(size_t(block.Height()) < parameters.schur_refinement_threshold)
+            {
+              schur_refinement.schur_complement.emplace_back(block.Grid());
+              continue;
+            }
+          schur_refinement.schur_complement.emplace_back(block);
+          El::Matrix<El::BigFloat> &local(block.Matrix());
+          for(int64_t column = 0; column < local.Width(); ++column)
+            for(int64_t row = 0; row < local.Height(); ++row)
+              {
+                local(row, column).gmp_float.set_prec(refinement_precision);
+              }
+        }
+    }
+
+  if(parameters.max_correctors > 0)
+    {
+      previous_direction = Search_Direction{x, y, X, X};
+    }
+  if(parameters.step_length_algorithm == Step_Length_Algorithm::lanczos)
+    {
+      next_cholesky = Next_Cholesky{X, X};
+      set_block_precisions(block_info, next_cholesky->X.blocks);
+      set_block_precisions(block_info, next_cholesky->Y.blocks);
+    }
+}
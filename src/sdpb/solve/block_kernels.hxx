@@ -0,0 +1,121 @@
+#pragma once
+
+#include "Blocksize_Profile.hxx"
+#include "native_kernels.hxx"
+
+#include <El.hpp>
+
+// Wrappers around the Elemental kernels used on the blocks of the
+// SDP.  Most small blocks end up on a grid with a single process.
+// For those, the wrappers call the sequential El::Matrix version
+// directly, skipping the distributed algorithm's redistributions and
+// alignment bookkeeping.  Otherwise they call the distributed
+// version, with the blocksize from the Blocksize_Profile.
+//
+// All matrices passed to one call must be on the same grid.  On a
+// single process grid, the local matrix of a DistMatrix (or of a View
+// into one) is the whole matrix, so both paths compute the same thing.
+//
+// With --scalar=double or doubleDouble, the sequential versions run
+// in that arithmetic instead (see native_kernels.hxx).
+
+inline bool is_single_process(const El::DistMatrix<El::BigFloat> &A)
+{
+  return A.Grid().Size() == 1;
+}
+
+inline bool is_native_scalar()
+{
+  return block_kernel_scalar() != Scalar_Type::bigfloat;
+}
+
+inline void block_gemm(const El::Orientation &orientation_A,
+                       const El::Orientation &orientation_B,
+                       const El::BigFloat &alpha,
+                       const El::DistMatrix<El::BigFloat> &A,
+                       const El::DistMatrix<El::BigFloat> &B,
+                       const El::BigFloat &beta,
+                       El::DistMatrix<El::BigFloat> &C)
+{
+  if(is_single_process(C) && is_native_scalar())
+    {
+      native_gemm(orientation_A, orientation_B, alpha, A.LockedMatrix(),
+                  B.LockedMatrix(), beta, C.Matrix());
+    }
+  else if(is_single_process(C))
+    {
+      El::Gemm(orientation_A, orientation_B, alpha, A.LockedMatrix(),
+               B.LockedMatrix(), beta, C.Matrix());
+    }
+  else
+    {
+      const Scoped_Blocksize blocksize(Blocksize_Kernel::gemm, C);
+      El::Gemm(orientation_A, orientation_B, alpha, A, B, beta, C,
+               blocksize.gemm_algorithm());
+    }
+}
+
+inline void block_syrk(const El::UpperOrLower &uplo,
+                       const El::Orientation &orientation,
+                       const El::BigFloat &alpha,
+                       const El::DistMatrix<El::BigFloat> &A,
+                       const El::BigFloat &beta,
+                       El::DistMatrix<El::BigFloat> &C)
+{
+  if(is_single_process(C) && is_native_scalar())
+    {
+      native_syrk(uplo, orientation, alpha, A.LockedMatrix(), beta,
+                  C.Matrix());
+    }
+  else if(is_single_process(C))
+    {
+      El::Syrk(uplo, orientation, alpha, A.LockedMatrix(), beta, C.Matrix());
+    }
+  else
+    {
+      const Scoped_Blocksize blocksize(Blocksize_Kernel::syrk, C);
+      El::Syrk(uplo, orientation, alpha, A, beta, C);
+    }
+}
+
+// B := alpha op(L)^{-1} B, where L is lower triangular and non-unit.
+inline void block_trsm_lower(const El::Orientation &orientation,
+                             const El::DistMatrix<El::BigFloat> &L,
+                             El::DistMatrix<El::BigFloat> &B)
+{
+  if(is_single_process(B) && is_native_scalar())
+    {
+      native_trsm_lower(orientation, L.LockedMatrix(), B.Matrix());
+    }
+  else if(is_single_process(B))
+    {
+      El::Trsm(El::LeftOrRightNS::LEFT, El::UpperOrLowerNS::LOWER,
+               orientation, El::UnitOrNonUnitNS::NON_UNIT, El::BigFloat(1),
+               L.LockedMatrix(), B.Matrix());
+    }
+  else
+    {
+      const Scoped_Blocksize blocksize(Blocksize_Kernel::trsm, B);
+      El::Trsm(El::LeftOrRightNS::LEFT, El::UpperOrLowerNS::LOWER,
+               orientation, El::UnitOrNonUnitNS::NON_UNIT, El::BigFloat(1),
+               L, B);
+    }
+}
+
+// A := L, where A = L L^T, only touching the lower triangle.
+inline void block_cholesky_lower(El::DistMatrix<El::BigFloat> &A)
+{
+  if(is_single_process(A) && is_native_scalar())
+    {
+      native_cholesky_lower(A.Matrix());
+    }
+  else if(is_single_process(A))
+    {
+      El::Cholesky(El::UpperOrLowerNS::LOWER, A.Matrix());
+    }
+  else
+    {
+      const Scoped_Blocksize blocksize(Blocksize_Kernel::cholesky, A);
+      El::Cholesky(El::UpperOrLowerNS::LOWER, A);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <El.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+// A compact binary form of a BigFloat, for the messages of
+// synchronize_Q and the compressed per-rank checkpoints:
+//
+//   int32_t size;       // sign * number of limbs stored
+//   int64_t exponent;   // GMP's _mp_exp, or 0 for zero
+//   mp_limb_t limbs[abs(size)];
+//
+// GMP stores the limbs least significant first, and the trailing zero
+// limbs at the beginning are dropped, so zero takes no limbs and
+// numbers with few significant limbs stay short.
+
+// The largest number of bytes that write_compact() writes for x
+inline size_t max_compact_size(const El::BigFloat &x)
+{
+  return sizeof(int32_t) + sizeof(int64_t)
+         + (x.gmp_float.get_mpf_t()->_mp_prec + 1) * sizeof(mp_limb_t);
+}
+
+// Returns the end of the written bytes.
+inline El::byte *write_compact(mpf_srcptr x, El::byte *destination)
+{
+  const int32_t num_limbs(std::abs(x->_mp_size));
+  int32_t first_limb(0);
+  while(first_limb < num_limbs && x->_mp_d[first_limb] == 0)
+    {
+      ++first_limb;
+    }
+  const int32_t stored_limbs(num_limbs - first_limb),
+    size(x->_mp_size < 0 ? -stored_limbs : stored_limbs);
+  const int64_t exponent(stored_limbs == 0 ? 0 : x->_mp_exp);
+
+  std::memcpy(destination, &size, sizeof(size));
+  destination += sizeof(size);
+  std::memcpy(destination, &exponent, sizeof(exponent));
+  destination += sizeof(exponent);
+  std::memcpy(destination, x->_mp_d + first_limb,
+              stored_limbs * sizeof(mp_limb_t));
+  return destination + stored_limbs * sizeof(mp_limb_t);
+}
+
+// Read from [source, end) into x at x's precision, dropping the least
+// significant limbs if there are too many, and advance source.
+inline void
+read_compact(const El::byte *&source, const El::byte *end, mpf_ptr x)
+{
+  int32_t size;
+  int64_t exponent;
+  if(size_t(end - source) < sizeof(size) + sizeof(exponent))
+    {
+      throw std::runtime_error("Truncated compact BigFloat");
+    }
+  std::memcpy(&size, source, sizeof(size));
+  source += sizeof(size);
+  std::memcpy(&exponent, source, sizeof(exponent));
+  source += sizeof(exponent);
+  const int32_t num_limbs(std::abs(size));
+  if(size_t(end - source) < num_limbs * sizeof(mp_limb_t))
+    {
+      throw std::runtime_error("Truncated compact BigFloat");
+    }
+  const int32_t kept_limbs(std::min(num_limbs, int32_t(x->_mp_prec + 1)));
+  std::memcpy(x->_mp_d,
+              source + (num_limbs - kept_limbs) * sizeof(mp_limb_t),
+              kept_limbs * sizeof(mp_limb_t));
+  source += num_limbs * sizeof(mp_limb_t);
+  x->_mp_size = (size < 0 ? -kept_limbs : kept_limbs);
+  x->_mp_exp = exponent;
+}
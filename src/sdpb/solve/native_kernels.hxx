@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../Scalar_Type.hxx"
+
+#include <El.hpp>
+
+// The sequential kernels of block_kernels.hxx, computed in double or
+// Double_Double arithmetic instead of BigFloat.  The inputs are
+// rounded to the scalar type, the kernel runs in it, and the outputs
+// are converted back to the BigFloats, which keep their precision.
+// The conversions are O(n^2), so the O(n^3) kernels that dominate
+// the solver run at the speed of the native arithmetic.
+
+// The scalar type of the block kernels.  Set once by run_sdpb().
+Scalar_Type &block_kernel_scalar();
+
+void native_gemm(const El::Orientation &orientation_A,
+                 const El::Orientation &orientation_B,
+                 const El::BigFloat &alpha,
+                 const El::Matrix<El::BigFloat> &A,
+                 const El::Matrix<El::BigFloat> &B, const El::BigFloat &beta,
+                 El::Matrix<El::BigFloat> &C);
+
+void native_syrk(const El::UpperOrLower &uplo,
+                 const El::Orientation &orientation,
+                 const El::BigFloat &alpha,
+                 const El::Matrix<El::BigFloat> &A, const El::BigFloat &beta,
+                 El::Matrix<El::BigFloat> &C);
+
+void native_trsm_lower(const El::Orientation &orientation,
+                       const El::Matrix<El::BigFloat> &L,
+                       El::Matrix<El::BigFloat> &B);
+
+void native_cholesky_lower(El::Matrix<El::BigFloat> &A);
@@ -0,0 +1,175 @@
+#include "../Double_Double.hxx"
+
+#include <stdexcept>
+
+// Straightforward column major loops.  The innermost loops run down a
+// column, so they stream through contiguous memory.
+
+namespace
+{
+  bool is_transposed(const El::Orientation &orientation)
+  {
+    return orientation != El::OrientationNS::NORMAL;
+  }
+
+  // op(A) as a column major matrix
+  void apply_orientation(const El::Orientation &orientation,
+                         const Double_Double_Matrix &A,
+                         Double_Double_Matrix &result)
+  {
+    if(!is_transposed(orientation))
+      {
+        result = A;
+        return;
+      }
+    result.resize(A.width, A.height);
+    for(int64_t column = 0; column < A.width; ++column)
+      for(int64_t row = 0; row < A.height; ++row)
+        {
+          result(column, row) = A(row, column);
+        }
+  }
+
+  void scale(const Double_Double &beta, Double_Double_Matrix &C)
+  {
+    for(auto &element : C.elements)
+      {
+        element = beta * element;
+      }
+  }
+}
+
+void double_double_gemm(const El::Orientation &orientation_A,
+                        const El::Orientation &orientation_B,
+                        const Double_Double &alpha,
+                        const Double_Double_Matrix &A,
+                        const Double_Double_Matrix &B,
+                        const Double_Double &beta, Double_Double_Matrix &C)
+{
+  Double_Double_Matrix op_A, op_B;
+  apply_orientation(orientation_A, A, op_A);
+  apply_orientation(orientation_B, B, op_B);
+  if(op_A.height != C.height || op_B.width != C.width
+     || op_A.width != op_B.height)
+    {
+      throw std::runtime_error("double_double_gemm: nonconformal matrices");
+    }
+  scale(beta, C);
+  for(int64_t column = 0; column < C.width; ++column)
+    for(int64_t k = 0; k < op_A.width; ++k)
+      {
+        const Double_Double b(alpha * op_B(k, column));
+        for(int64_t row = 0; row < C.height; ++row)
+          {
+            C(row, column) += op_A(row, k) * b;
+          }
+      }
+}
+
+void double_double_syrk(const El::UpperOrLower &uplo,
+                        const El::Orientation &orientation,
+                        const Double_Double &alpha,
+                        const Double_Double_Matrix &A,
+                        const Double_Double &beta, Double_Double_Matrix &C)
+{
+  // C := alpha M M^T + beta C, with M = op(A)
+  Double_Double_Matrix M;
+  apply_orientation(orientation, A, M);
+  if(M.height != C.height || C.height != C.width)
+    {
+      throw std::runtime_error("double_double_syrk: nonconformal matrices");
+    }
+  const bool is_lower(uplo == El::UpperOrLowerNS::LOWER);
+  for(int64_t column = 0; column < C.width; ++column)
+    {
+      const int64_t begin(is_lower ? column : 0),
+        end(is_lower ? C.height : column + 1);
+      for(int64_t row = begin; row < end; ++row)
+        {
+          C(row, column) = beta * C(row, column);
+        }
+      for(int64_t k = 0; k < M.width; ++k)
+        {
+          const Double_Double m(alpha * M(column, k));
+          for(int64_t row = begin; row < end; ++row)
+            {
+              C(row, column) += M(row, k) * m;
+            }
+        }
+    }
+}
+
+void double_double_trsm_lower(const El::Orientation &orientation,
+                              const Double_Double_Matrix &L,
+                              Double_Double_Matrix &B)
+{
+  const int64_t height(L.height);
+  if(L.width != height || B.height != height)
+    {
+      throw std::runtime_error(
+        "double_double_trsm_lower: nonconformal matrices");
+    }
+  for(int64_t column = 0; column < B.width; ++column)
+    {
+      if(!is_transposed(orientation))
+        {
+          // Forward substitution with L
+          for(int64_t k = 0; k < height; ++k)
+            {
+              B(k, column) = B(k, column) / L(k, k);
+              const Double_Double b(B(k, column));
+              for(int64_t row = k + 1; row < height; ++row)
+                {
+                  B(row, column) -= L(row, k) * b;
+                }
+            }
+        }
+      else
+        {
+          // Back substitution with L^T.  Row k of L^T is column k of L.
+          for(int64_t k = height - 1; k >= 0; --k)
+            {
+              Double_Double sum(B(k, column));
+              for(int64_t row = k + 1; row < height; ++row)
+                {
+                  sum -= L(row, k) * B(row, column);
+                }
+              B(k, column) = sum / L(k, k);
+            }
+        }
+    }
+}
+
+void double_double_cholesky_lower(Double_Double_Matrix &A)
+{
+  const int64_t height(A.height);
+  if(A.width != height)
+    {
+      throw std::runtime_error(
+        "double_double_cholesky_lower: matrix is not square");
+    }
+  // Right looking, on the lower triangle only
+  for(int64_t k = 0; k < height; ++k)
+    {
+      if(!(A(k, k).hi > 0))
+        {
+          throw std::runtime_error(
+            "double_double_cholesky_lower: matrix is not numerically "
+            "positive definite");
+        }
+      A(k, k) = sqrt(A(k, k));
+      const Double_Double diagonal(A(k, k));
+      for(int64_t row = k + 1; row < height; ++row)
+        {
+          A(row, k) = A(row, k) / diagonal;
+        }
+      for(int64_t column = k + 1; column < height; ++column)
+        {
+          const Double_Double a(A(column, k));
+          for(int64_t row = column; row < height; ++row)
+            {
+              A(row, column) -= A(row, k) * a;
+            }
+        }
+    }
+}
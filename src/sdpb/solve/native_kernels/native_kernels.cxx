@@ -0,0 +1,200 @@
+#include "../native_kernels.hxx"
+#include "../Double_Double.hxx"
+
+#include <stdexcept>
+
+namespace
+{
+  // x rounded to a Double_Double.  mpf_get_d truncates, so the
+  // remainder is taken twice.
+  Double_Double to_double_double(const El::BigFloat &x)
+  {
+    mpf_srcptr mpf(x.gmp_float.get_mpf_t());
+    const double hi(mpf_get_d(mpf));
+    mpf_class remainder(x.gmp_float);
+    remainder -= hi;
+    const double lo(mpf_get_d(remainder.get_mpf_t()));
+    return double_double::fast_two_sum(hi, lo);
+  }
+
+  void from_double_double(const Double_Double &x, El::BigFloat &result)
+  {
+    result.gmp_float = x.hi;
+    result.gmp_float += x.lo;
+  }
+
+  // Which elements to write back
+  enum class Part
+  {
+    all,
+    lower,
+    upper
+  };
+
+  bool is_in(const Part &part, const int64_t &row, const int64_t &column)
+  {
+    return part == Part::all || (part == Part::lower && row >= column)
+           || (part == Part::upper && row <= column);
+  }
+
+  void convert(const El::Matrix<El::BigFloat> &A, El::Matrix<double> &result)
+  {
+    result.Resize(A.Height(), A.Width());
+    for(int64_t column = 0; column < A.Width(); ++column)
+      for(int64_t row = 0; row < A.Height(); ++row)
+        {
+          const Double_Double x(to_double_double(A(row, column)));
+          result(row, column) = x.hi + x.lo;
+        }
+  }
+
+  void convert(const El::Matrix<El::BigFloat> &A,
+               Double_Double_Matrix &result)
+  {
+    result.resize(A.Height(), A.Width());
+    for(int64_t column = 0; column < A.Width(); ++column)
+      for(int64_t row = 0; row < A.Height(); ++row)
+        {
+          result(row, column) = to_double_double(A(row, column));
+        }
+  }
+
+  void convert_back(const El::Matrix<double> &A, const Part &part,
+                    El::Matrix<El::BigFloat> &result)
+  {
+    for(int64_t column = 0; column < A.Width(); ++column)
+      for(int64_t row = 0; row < A.Height(); ++row)
+        {
+          if(is_in(part, row, column))
+            {
+              result(row, column).gmp_float = A(row, column);
+            }
+        }
+  }
+
+  void convert_back(const Double_Double_Matrix &A, const Part &part,
+                    El::Matrix<El::BigFloat> &result)
+  {
+    for(int64_t column = 0; column < A.width; ++column)
+      for(int64_t row = 0; row < A.height; ++row)
+        {
+          if(is_in(part, row, column))
+            {
+              from_double_double(A(row, column), result(row, column));
+            }
+        }
+  }
+
+  bool is_double()
+  {
+    return block_kernel_scalar() == Scalar_Type::native_double;
+  }
+}
+
+Scalar_Type &block_kernel_scalar()
+{
+  static Scalar_Type scalar(Scalar_Type::bigfloat);
+  return scalar;
+}
+
+void native_gemm(const El::Orientation &orientation_A,
+                 const El::Orientation &orientation_B,
+                 const El::BigFloat &alpha,
+                 const El::Matrix<El::BigFloat> &A,
+                 const El::Matrix<El::BigFloat> &B, const El::BigFloat &beta,
+                 El::Matrix<El::BigFloat> &C)
+{
+  if(is_double())
+    {
+      El::Matrix<double> A_native, B_native, C_native;
+      convert(A, A_native);
+      convert(B, B_native);
+      convert(C, C_native);
+      const Double_Double alpha_native(to_double_double(alpha)),
+        beta_native(to_double_double(beta));
+      El::Gemm(orientation_A, orientation_B, alpha_native.hi, A_native,
+               B_native, beta_native.hi, C_native);
+      convert_back(C_native, Part::all, C);
+    }
+  else
+    {
+      Double_Double_Matrix A_native, B_native, C_native;
+      convert(A, A_native);
+      convert(B, B_native);
+      convert(C, C_native);
+      double_double_gemm(orientation_A, orientation_B,
+                         to_double_double(alpha), A_native, B_native,
+                         to_double_double(beta), C_native);
+      convert_back(C_native, Part::all, C);
+    }
+}
+
+void native_syrk(const El::UpperOrLower &uplo,
+                 const El::Orientation &orientation,
+                 const El::BigFloat &alpha,
+                 const El::Matrix<El::BigFloat> &A, const El::BigFloat &beta,
+                 El::Matrix<El::BigFloat> &C)
+{
+  const Part part(uplo == El::UpperOrLowerNS::LOWER ? Part::lower
+                                                    : Part::upper);
+  if(is_double())
+    {
+      El::Matrix<double> A_native, C_native;
+      convert(A, A_native);
+      convert(C, C_native);
+      El::Syrk(uplo, orientation, to_double_double(alpha).hi, A_native,
+               to_double_double(beta).hi, C_native);
+      convert_back(C_native, part, C);
+    }
+  else
+    {
+      Double_Double_Matrix A_native, C_native;
+      convert(A, A_native);
+      convert(C, C_native);
+      double_double_syrk(uplo, orientation, to_double_double(alpha),
+                         A_native, to_double_double(beta), C_native);
+      convert_back(C_native, part, C);
+    }
+}
+
+void native_trsm_lower(const El::Orientation &orientation,
+                       const El::Matrix<El::BigFloat> &L,
+                       El::Matrix<El::BigFloat> &B)
+{
+  if(is_double())
+    {
+      El::Matrix<double> L_native, B_native;
+      convert(L, L_native);
+      convert(B, B_native);
+      El::Trsm(El::LeftOrRightNS::LEFT, El::UpperOrLowerNS::LOWER,
+               orientation, El::UnitOrNonUnitNS::NON_UNIT, 1.0, L_native,
+               B_native);
+      convert_back(B_native, Part::all, B);
+    }
+  else
+    {
+      Double_Double_Matrix L_native, B_native;
+      convert(L, L_native);
+      convert(B, B_native);
+      double_double_trsm_lower(orientation, L_native, B_native);
+      convert_back(B_native, Part::all, B);
+    }
+}
+
+void native_cholesky_lower(El::Matrix<El::BigFloat> &A)
+{
+  if(is_double())
+    {
+      El::Matrix<double> A_native;
+      convert(A, A_native);
+      El::Cholesky(El::UpperOrLowerNS::LOWER, A_native);
+      convert_back(A_native, Part::lower, A);
+    }
+  else
+    {
+      Double_Double_Matrix A_native;
+      convert(A, A_native);
+      double_double_cholesky_lower(A_native);
+      convert_back(A_native, Part::lower, A);
+    }
+}
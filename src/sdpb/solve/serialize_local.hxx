@@ -0,0 +1,46 @@
+#pragma once
+
+#include <El.hpp>
+
+// Bulk serialization of the local elements of a matrix, in row major
+// order, with El::BigFloat(0).SerializedSize() bytes per element.
+// The whole matrix goes into one contiguous buffer, so that it can be
+// written or read with a single call, and a single temporary is
+// reused for all of the elements instead of one per element.
+
+// destination must have room for Height() * Width() * serialized_size
+// bytes.  Each element is rounded to the default precision, so that
+// elements of lower precision blocks still fill a whole record.
+// Returns the end of the serialized elements.
+inline El::byte *serialize_local(const El::Matrix<El::BigFloat> &local,
+                                 const size_t &serialized_size,
+                                 El::byte *destination)
+{
+  El::BigFloat element;
+  for(int64_t row = 0; row < local.Height(); ++row)
+    for(int64_t column = 0; column < local.Width(); ++column)
+      {
+        element = local(row, column);
+        element.Serialize(destination);
+        destination += serialized_size;
+      }
+  return destination;
+}
+
+// The inverse of serialize_local().  local must already have its
+// size.  Assigning keeps the precision of the elements of local.
+// Returns the end of the serialized elements.
+inline const El::byte *deserialize_local(const El::byte *source,
+                                         const size_t &serialized_size,
+                                         El::Matrix<El::BigFloat> &local)
+{
+  El::BigFloat element;
+  for(int64_t row = 0; row < local.Height(); ++row)
+    for(int64_t column = 0; column < local.Width(); ++column)
+      {
+        element.Deserialize(source);
+        source += serialized_size;
+        local(row, column) = element;
+      }
+  return source;
+}
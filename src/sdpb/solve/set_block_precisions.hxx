@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../Block_Info.hxx"
+
+#include <El.hpp>
+
+// Set the precision of the local elements of the blocks of a matrix
+// with two blocks for each block index, like X, to the precision of
+// their block.  Assigning to an element keeps its precision, so
+// everything that is later written into these blocks is rounded to
+// the block's precision, and GMP only uses that many bits of them in
+// products.
+inline void
+set_block_precisions(const Block_Info &block_info,
+                     std::vector<El::DistMatrix<El::BigFloat>> &blocks)
+{
+  for(size_t block = 0; block < blocks.size(); ++block)
+    {
+      const mp_bitcnt_t precision(
+        block_info.block_precision(block_info.block_indices[block / 2]));
+      if(precision == mpf_get_default_prec())
+        {
+          continue;
+        }
+      El::Matrix<El::BigFloat> &local(blocks[block].Matrix());
+      for(El::Int column = 0; column < local.Width(); ++column)
+        for(El::Int row = 0; row < local.Height(); ++row)
+          {
+            local(row, column).gmp_float.set_prec(precision);
+          }
+    }
+}
@@ -6,46 +6,522 @@
 //=======================================================================
 
 #include "SDP_Solver.hxx"
+#include "SDP_Prefetch.hxx"
+#include "../limb_pool.hxx"
 #include "../../Timers.hxx"
 #include "../../set_stream_precision.hxx"
+#include "../solver_comm.hxx"
 
 #include <El.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory>
+
+void write_timing(const boost::filesystem::path &checkpoint_out,
+                  const boost::filesystem::path &block_cost_database,
+                  const Block_Info &block_info, const Timers &timers,
+                  const bool &debug, El::Matrix<int32_t> &block_timings);
+std::chrono::time_point<std::chrono::high_resolution_clock> trace_origin();
+void write_trace(const boost::filesystem::path &trace_file,
+                 const Timers &timers);
+void shift_to_interior(const El::BigFloat &shift, Block_Diagonal_Matrix &X);
+void write_memory_profile(const std::string &prefix, const Timers &timers,
+                          const size_t &procs_per_node);
+void tune_blocksizes(const SDP_Solver_Parameters &parameters,
+                     const Block_Info &block_info, const El::Grid &grid,
+                     const int64_t &Q_height);
+
+namespace
+{
+  // The SDP comes from memory if a driver handed it over, and from
+  // sdp_directory otherwise.
+  SDP *new_sdp(const SDP_Solver_Parameters &parameters,
+               const Block_Info &block_info, const El::Grid &grid)
+  {
+    return parameters.in_memory_sdp
+             ? new SDP(*parameters.in_memory_sdp, block_info, grid)
+             : new SDP(parameters.sdp_directory, block_info, grid);
+  }
+
+  // Start reading the files of this rank's blocks as soon as the
+  // mapping is known.  Nothing to read for an SDP in memory.
+  std::unique_ptr<SDP_Prefetch>
+  start_prefetch(const SDP_Solver_Parameters &parameters,
+                 const Block_Info &block_info)
+  {
+    return std::unique_ptr<SDP_Prefetch>(
+      parameters.in_memory_sdp
+        ? nullptr
+        : new SDP_Prefetch(parameters.sdp_directory,
+                           block_info.block_indices));
+  }
+
+  void report_and_save(const Block_Info &block_info,
+                       const SDP_Solver_Parameters &parameters,
+                       const SDP_Solver_Terminate_Reason &reason,
+                       const Timers &timers, SDP_Solver &solver)
+  {
+    if(timers.debug)
+      {
+        const Limb_Pool_Statistics statistics(limb_pool_statistics());
+        El::Output(El::mpi::Rank(solver_comm()), " limb pool: allocations ",
+                   statistics.allocations, " reused ", statistics.reused,
+                   " reallocations ", statistics.reallocations, " frees ",
+                   statistics.frees, " pooled bytes ",
+                   statistics.pooled_bytes, " shared pooled bytes ",
+                   statistics.shared_pooled_bytes, " slab bytes ",
+                   statistics.slab_bytes, " arenas ", statistics.arenas,
+                   " process arenas ", statistics.process_arenas,
+                   " arena bytes ", statistics.arena_bytes,
+                   " huge page bytes ", statistics.huge_page_bytes,
+                   " NUMA local bytes ", statistics.numa_local_bytes);
+        write_memory_profile(parameters.checkpoint_out.string() + ".memory",
+                             timers, parameters.procs_per_node);
+      }
+
+    if(parameters.verbosity >= Verbosity::regular
+       && El::mpi::Rank(solver_comm()) == 0)
+      {
+        set_stream_precision(std::cout);
+        std::cout << "-----" << reason << "-----\n"
+                  << '\n'
+                  << "primalObjective = " << solver.primal_objective << '\n'
+                  << "dualObjective   = " << solver.dual_objective << '\n'
+                  << "dualityGap      = " << solver.duality_gap << '\n'
+                  << "primalError     = " << solver.primal_error() << '\n'
+                  << "dualError       = " << solver.dual_error << '\n'
+                  << '\n';
+      }
+
+    // A signal usually means that the job is about to be killed, so
+    // its state is saved in any case.
+    if(!parameters.no_final_checkpoint
+       || reason == SDP_Solver_Terminate_Reason::SignalReceived)
+      {
+        solver.save_checkpoint(parameters, block_info, false);
+      }
+    solver.save_solution(reason, timers.front(), parameters.out_directory,
+                         parameters.write_solution,
+                         block_info.block_indices, parameters.verbosity);
+  }
+
+  // With traceFile, the timers also record every interval.
+  Timers make_timers(const SDP_Solver_Parameters &parameters)
+  {
+    Timers result(parameters.verbosity >= Verbosity::debug);
+    if(!parameters.trace_file.empty())
+      {
+        result.start_trace(trace_origin());
+      }
+    return result;
+  }
+
+  Timers run_and_save(const Block_Info &block_info,
+                      const SDP_Solver_Parameters &parameters,
+                      const El::Grid &grid, const SDP &sdp,
+                      SDP_Solver &solver)
+  {
+    Timers timers(make_timers(parameters));
+    SDP_Solver_Terminate_Reason reason
+      = solver.run(parameters, block_info, sdp, grid, timers);
+    write_trace(parameters.trace_file, timers);
+    report_and_save(block_info, parameters, reason, timers, solver);
+    return timers;
+  }
+
+  // Whether every rank has the same blocks, in the same group of
+  // ranks, under both mappings.
+  bool is_same_mapping(const Block_Info &a, const Block_Info &b)
+  {
+    int comparison;
+    MPI_Comm_compare(a.mpi_comm.value.comm, b.mpi_comm.value.comm,
+                     &comparison);
+    const int local_same(
+      (a.block_indices == b.block_indices
+       && (comparison == MPI_IDENT || comparison == MPI_CONGRUENT))
+        ? 1
+        : 0);
+    return El::mpi::AllReduce(local_same, El::mpi::MIN, solver_comm())
+           == 1;
+  }
+
+  // The load of the most loaded rank divided by the average load.
+  // The load of a rank is the cost of its blocks divided by the
+  // number of ranks that share them.
+  double load_imbalance(const Block_Info &block_info,
+                        const El::Matrix<int32_t> &block_timings)
+  {
+    double local_load(0);
+    for(auto &index : block_info.block_indices)
+      {
+        local_load += block_timings(index, 0);
+      }
+    local_load /= El::mpi::Size(block_info.mpi_comm.value);
+    const double max_load(El::mpi::AllReduce(local_load, El::mpi::MAX,
+                                             solver_comm())),
+      total_load(El::mpi::AllReduce(local_load, El::mpi::SUM,
+                                    solver_comm()));
+    return total_load > 0
+             ? max_load * El::mpi::Size(solver_comm()) / total_load
+             : 1;
+  }
+
+  // Solve in segments of rebalanceInterval iterations.  After each
+  // segment, measure the cost of each block.  If the load imbalance
+  // is above rebalanceThreshold and the costs give a different
+  // mapping, checkpoint, recreate the grid, the SDP and the solver
+  // with the new mapping, and continue from the checkpoint.  The
+  // blocks of x, X, y and Y move through the redistributing
+  // checkpoint reader, and each rank reads the SDP blocks it now
+  // owns.
+  //
+  // The solver only stops at the end of a segment after computing the
+  // residues of the next iteration, so each segment repeats that part
+  // of an iteration.
+  Timers solve_with_rebalancing(const Block_Info &block_info,
+                                SDP_Solver_Parameters parameters,
+                                std::unique_ptr<El::Grid> &&initial_grid,
+                                std::unique_ptr<SDP> &&initial_sdp,
+                                std::unique_ptr<SDP_Solver> &&initial_solver)
+  {
+    // Destroy the solver, SDP and grid before the Block_Info that
+    // owns their communicator.
+    std::unique_ptr<Block_Info> rebalanced_info;
+    const Block_Info *current_info(&block_info);
+    std::unique_ptr<El::Grid> grid(std::move(initial_grid));
+    std::unique_ptr<SDP> sdp(std::move(initial_sdp));
+    std::unique_ptr<SDP_Solver> solver(std::move(initial_solver));
+
+    auto last_checkpoint_time(std::chrono::high_resolution_clock::now());
+    while(parameters.max_iterations > parameters.rebalance_interval)
+      {
+        SDP_Solver_Parameters segment_parameters(parameters);
+        segment_parameters.max_iterations = parameters.rebalance_interval;
+        segment_parameters.no_final_checkpoint = true;
+        segment_parameters.checkpoint_interval = std::max(
+          int64_t(0),
+          parameters.checkpoint_interval
+            - std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::high_resolution_clock::now()
+                - last_checkpoint_time)
+                .count());
+        const int64_t generation(solver->current_generation);
+
+        Timers timers(make_timers(parameters));
+        SDP_Solver_Terminate_Reason reason(solver->run(
+          segment_parameters, *current_info, *sdp, *grid, timers));
+        write_trace(parameters.trace_file, timers);
+        parameters.max_iterations -= parameters.rebalance_interval;
+        parameters.max_runtime -= timers.front().timer.elapsed_seconds();
+        if(solver->current_generation != generation)
+          {
+            last_checkpoint_time = std::chrono::high_resolution_clock::now();
+          }
+        if(reason != SDP_Solver_Terminate_Reason::MaxIterationsExceeded)
+          {
+            report_and_save(*current_info, parameters, reason, timers,
+                            *solver);
+            return timers;
+          }
+
+        El::Matrix<int32_t> block_timings(current_info->dimensions.size(),
+                                          1);
+        write_timing(parameters.checkpoint_out,
+                     parameters.block_cost_database, *current_info, timers,
+                     parameters.verbosity >= Verbosity::debug,
+                     block_timings);
+        const double imbalance(load_imbalance(*current_info, block_timings));
+        if(imbalance <= parameters.rebalance_threshold)
+          {
+            continue;
+          }
+        std::unique_ptr<Block_Info> new_info(new Block_Info(
+          parameters.sdp_directory, block_timings, parameters.procs_per_node,
+          parameters.proc_granularity, parameters.memory_per_node,
+          parameters.verbosity, parameters.in_memory_sdp.get()));
+        if(is_same_mapping(*current_info, *new_info))
+          {
+            continue;
+          }
+        if(parameters.verbosity >= Verbosity::regular
+           && El::mpi::Rank(solver_comm()) == 0)
+          {
+            std::cout << "Rebalancing blocks, load imbalance " << imbalance
+                      << '\n';
+          }
+
+        solver->save_checkpoint(parameters, *current_info, false);
+        last_checkpoint_time = std::chrono::high_resolution_clock::now();
+        parameters.checkpoint_in = parameters.checkpoint_out;
+        parameters.require_initial_checkpoint = true;
+        solver.reset();
+        sdp.reset();
+        grid.reset();
+        rebalanced_info = std::move(new_info);
+        current_info = rebalanced_info.get();
+
+        grid.reset(new El::Grid(current_info->mpi_comm.value,
+                                current_info->grid_height()));
+        sdp.reset(new_sdp(parameters, *current_info, *grid));
+        solver.reset(new SDP_Solver(parameters, *current_info, *grid,
+                                    sdp->dual_objective_b.Height()));
+      }
+    parameters.checkpoint_interval = std::max(
+      int64_t(0), parameters.checkpoint_interval
+                    - std::chrono::duration_cast<std::chrono::seconds>(
+                        std::chrono::high_resolution_clock::now()
+                        - last_checkpoint_time)
+                        .count());
+    return run_and_save(*current_info, parameters, *grid, *sdp, *solver);
+  }
+
+  // Run at working_precision until the duality gap and the errors
+  // are below 2^(-precisionRampFraction * working_precision), and
+  // then double the precision.  The SDP is read again, since its
+  // numbers were rounded to the lower precision, and the new solver
+  // starts from the current point.  If the solver terminates for
+  // another reason before reaching the full precision, the results
+  // are saved and the timers of the last stage are returned.
+  boost::optional<Timers>
+  ramp_precision(const Block_Info &block_info,
+                 SDP_Solver_Parameters &parameters, const El::Grid &grid,
+                 std::unique_ptr<SDP> &sdp,
+                 std::unique_ptr<SDP_Solver> &solver)
+  {
+    while(parameters.working_precision < parameters.precision)
+      {
+        El::BigFloat threshold(1);
+        mpf_div_2exp(threshold.gmp_float.get_mpf_t(),
+                     threshold.gmp_float.get_mpf_t(),
+                     mp_bitcnt_t(parameters.precision_ramp_fraction
+                                 * parameters.working_precision));
+        SDP_Solver_Parameters stage_parameters(parameters);
+        stage_parameters.no_final_checkpoint = true;
+        stage_parameters.duality_gap_threshold
+          = std::max(threshold, parameters.duality_gap_threshold);
+        stage_parameters.primal_error_threshold
+          = std::max(threshold, parameters.primal_error_threshold);
+        stage_parameters.dual_error_threshold
+          = std::max(threshold, parameters.dual_error_threshold);
+
+        Timers timers(make_timers(parameters));
+        const SDP_Solver_Terminate_Reason reason(
+          solver->run(stage_parameters, block_info, *sdp, grid, timers));
+        write_trace(parameters.trace_file, timers);
+        if(reason != SDP_Solver_Terminate_Reason::PrimalDualOptimal)
+          {
+            report_and_save(block_info, parameters, reason, timers, *solver);
+            return boost::optional<Timers>(std::move(timers));
+          }
+        // The last iteration only computes the residues.
+        parameters.max_iterations
+          -= timers.find("run.checkpoint")->count - 1;
+        parameters.max_runtime -= timers.front().timer.elapsed_seconds();
+
+        parameters.working_precision = std::min(
+          2 * parameters.working_precision, parameters.precision);
+        if(parameters.verbosity >= Verbosity::regular
+           && El::mpi::Rank(solver_comm()) == 0)
+          {
+            std::cout << "Raising the precision to "
+                      << parameters.working_precision << " bits\n";
+          }
+        El::gmp::SetPrecision(parameters.working_precision);
+        sdp.reset();
+        sdp.reset(new_sdp(parameters, block_info, grid));
+        std::unique_ptr<SDP_Solver> new_solver(new SDP_Solver(
+          *solver, block_info, grid, sdp->dual_objective_b.Height()));
+        solver = std::move(new_solver);
+      }
+    return boost::none;
+  }
+
+  Timers solve(const Block_Info &block_info,
+               const SDP_Solver_Parameters &initial_parameters,
+               std::unique_ptr<El::Grid> &&grid, std::unique_ptr<SDP> &&sdp,
+               std::unique_ptr<SDP_Solver> &&solver)
+  {
+    SDP_Solver_Parameters parameters(initial_parameters);
+    if(parameters.working_precision < parameters.precision)
+      {
+        boost::optional<Timers> timers(
+          ramp_precision(block_info, parameters, *grid, sdp, solver));
+        if(timers)
+          {
+            return std::move(timers.get());
+          }
+      }
+    if(parameters.rebalance_interval == 0)
+      {
+        return run_and_save(block_info, parameters, *grid, *sdp, *solver);
+      }
+    return solve_with_rebalancing(block_info, parameters, std::move(grid),
+                                  std::move(sdp), std::move(solver));
+  }
+}
 
 Timers
 solve(const Block_Info &block_info, const SDP_Solver_Parameters &parameters)
 {
   // Read an SDP from sdpFile and create a solver for it
-  El::Grid grid(block_info.mpi_comm.value);
-  SDP sdp(parameters.sdp_directory, block_info, grid);
-  SDP_Solver solver(parameters, block_info, grid,
-                    sdp.dual_objective_b.Height());
+  std::unique_ptr<SDP_Prefetch> prefetch(
+    start_prefetch(parameters, block_info));
+  std::unique_ptr<El::Grid> grid(
+    new El::Grid(block_info.mpi_comm.value, block_info.grid_height()));
+  std::unique_ptr<SDP> sdp(new_sdp(parameters, block_info, *grid));
+  prefetch.reset();
+  std::unique_ptr<SDP_Solver> solver(new SDP_Solver(
+    parameters, block_info, *grid, sdp->dual_objective_b.Height()));
+  tune_blocksizes(parameters, block_info, *grid,
+                  sdp->dual_objective_b.Height());
+  return solve(block_info, parameters, std::move(grid), std::move(sdp),
+               std::move(solver));
+}
 
-  Timers timers(parameters.verbosity >= Verbosity::debug);
-  SDP_Solver_Terminate_Reason reason
-    = solver.run(parameters, block_info, sdp, grid, timers);
+// Solve on a grid that already exists, without rebalancing.  Used to
+// solve a queue of SDPs with the same block structure.  sdp and
+// solver are kept for the next SDP in the queue.
+//
+// With objectives_only, the SDP has the same constraints as sdp, or
+// as the SDP in constraints_directory if there is no sdp yet, and only
+// its objectives are read from sdpDir.  Unless there is a checkpoint
+// for it, the solver starts from the last solution, shifted into the
+// interior by warmStartShift.
+Timers solve(const Block_Info &block_info,
+             const SDP_Solver_Parameters &parameters, const El::Grid &grid,
+             const bool &objectives_only,
+             const boost::filesystem::path &constraints_directory,
+             std::unique_ptr<SDP> &sdp, std::unique_ptr<SDP_Solver> &solver)
+{
+  const bool is_new_sdp(!objectives_only || !sdp || !solver);
+  if(is_new_sdp)
+    {
+      solver.reset();
+      sdp.reset();
+      sdp.reset(new SDP(objectives_only ? constraints_directory
+                                        : parameters.sdp_directory,
+                        block_info, grid));
+    }
+  if(objectives_only)
+    {
+      sdp->replace_objectives(parameters.sdp_directory, block_info, grid);
+    }
 
-  if(parameters.verbosity >= Verbosity::regular && El::mpi::Rank() == 0)
+  if(is_new_sdp)
     {
-      set_stream_precision(std::cout);
-      std::cout << "-----" << reason << "-----\n"
-                << '\n'
-                << "primalObjective = " << solver.primal_objective << '\n'
-                << "dualObjective   = " << solver.dual_objective << '\n'
-                << "dualityGap      = " << solver.duality_gap << '\n'
-                << "primalError     = " << solver.primal_error() << '\n'
-                << "dualError       = " << solver.dual_error << '\n'
-                << '\n';
+      solver.reset(new SDP_Solver(parameters, block_info, grid,
+                                  sdp->dual_objective_b.Height()));
     }
+  else if(!solver->load_checkpoint(parameters.checkpoint_in, block_info,
+                                   parameters.verbosity,
+                                   parameters.threads_per_proc, false))
+    {
+      shift_to_interior(parameters.warm_start_shift, solver->X);
+      shift_to_interior(parameters.warm_start_shift, solver->Y);
+      // The generations belong to the last SDP's checkpoints.
+      solver->current_generation = 0;
+      solver->backup_generation = boost::none;
+    }
+  return run_and_save(block_info, parameters, grid, *sdp, *solver);
+}
 
-  if(!parameters.no_final_checkpoint)
+// Run a couple of iterations to measure the cost of each block, use
+// the timings to compute a new mapping of blocks to ranks, and then
+// solve with the new mapping.
+//
+// The state of the timing run is not thrown away.  If the new mapping
+// is the same as the old one, the solver continues from it with the
+// SDP that is already in memory.  Otherwise, the timing run writes a
+// checkpoint, which is then loaded with the new mapping (see
+// read_redistributed_checkpoint).  Only the blocks of the SDP that
+// move to a different group of ranks are read again.
+void solve_with_timing_run(Block_Info &block_info,
+                           SDP_Solver_Parameters &parameters)
+{
+  SDP_Solver_Parameters timing_parameters(parameters);
+  timing_parameters.max_iterations = 2;
+  timing_parameters.no_final_checkpoint = true;
+  timing_parameters.checkpoint_interval = std::numeric_limits<int64_t>::max();
+  timing_parameters.max_runtime = std::numeric_limits<int64_t>::max();
+  timing_parameters.duality_gap_threshold = 0;
+  timing_parameters.primal_error_threshold = 0;
+  timing_parameters.dual_error_threshold = 0;
+  if(timing_parameters.verbosity != Verbosity::debug)
+    {
+      timing_parameters.verbosity = Verbosity::none;
+    }
+
+  std::unique_ptr<SDP_Prefetch> prefetch(
+    start_prefetch(parameters, block_info));
+  std::unique_ptr<El::Grid> grid(
+    new El::Grid(block_info.mpi_comm.value, block_info.grid_height()));
+  std::unique_ptr<SDP> sdp(new_sdp(timing_parameters, block_info, *grid));
+  prefetch.reset();
+  std::unique_ptr<SDP_Solver> solver(
+    new SDP_Solver(timing_parameters, block_info, *grid,
+                   sdp->dual_objective_b.Height()));
+  tune_blocksizes(parameters, block_info, *grid,
+                  sdp->dual_objective_b.Height());
+  Timers timers(make_timers(timing_parameters));
+  const SDP_Solver_Terminate_Reason reason(
+    solver->run(timing_parameters, block_info, *sdp, *grid, timers));
+  write_trace(timing_parameters.trace_file, timers);
+  if(reason == SDP_Solver_Terminate_Reason::SignalReceived)
+    {
+      report_and_save(block_info, parameters, reason, timers, *solver);
+      return;
+    }
+
+  El::Matrix<int32_t> block_timings(block_info.dimensions.size(), 1);
+  write_timing(timing_parameters.checkpoint_out,
+               timing_parameters.block_cost_database, block_info, timers,
+               timing_parameters.verbosity >= Verbosity::debug,
+               block_timings);
+  El::mpi::Barrier(solver_comm());
+  Block_Info new_info(parameters.sdp_directory, block_timings,
+                      parameters.procs_per_node, parameters.proc_granularity,
+                      parameters.memory_per_node, parameters.verbosity,
+                      parameters.in_memory_sdp.get());
+
+  parameters.max_runtime -= timers.front().timer.elapsed_seconds();
+
+  if(is_same_mapping(block_info, new_info))
     {
-      solver.save_checkpoint(parameters);
+      solve(block_info, parameters, std::move(grid), std::move(sdp),
+            std::move(solver));
+      return;
     }
-  solver.save_solution(reason, timers.front(), parameters.out_directory,
-                       parameters.write_solution,
-                       block_info.block_indices,
-                       parameters.verbosity);
-  return timers;
+
+  // The files of the blocks that move are read while the checkpoint
+  // is written.  Blocks that stay on the same group of ranks are moved
+  // from the SDP of the timing run instead of being read again.
+  prefetch = start_prefetch(parameters, new_info);
+  solver->save_checkpoint(parameters, block_info, false);
+  parameters.checkpoint_in = parameters.checkpoint_out;
+  solver.reset();
+  {
+    std::unique_ptr<El::Grid> new_grid(
+      new El::Grid(new_info.mpi_comm.value, new_info.grid_height()));
+    std::unique_ptr<SDP> moved_sdp(
+      parameters.in_memory_sdp
+        ? new_sdp(parameters, new_info, *new_grid)
+        : new SDP(parameters.sdp_directory, new_info, *new_grid, *sdp,
+                  block_info));
+    prefetch.reset();
+    sdp.reset();
+    grid.reset();
+    std::unique_ptr<SDP_Solver> new_solver(
+      new SDP_Solver(parameters, new_info, *new_grid,
+                     moved_sdp->dual_objective_b.Height()));
+    tune_blocksizes(parameters, new_info, *new_grid,
+                    moved_sdp->dual_objective_b.Height());
+    solve(new_info, parameters, std::move(new_grid), std::move(moved_sdp),
+          std::move(new_solver));
+  }
+  std::swap(block_info, new_info);
 }
@@ -0,0 +1,234 @@
+// Keep running after the first SDP, and solve the SDPs listed in the
+// queue file in turn.  This saves the startup of MPI and Elemental,
+// and, while the block structure stays the same, the timing run, the
+// block mapping and the process grid.  The limb pool also keeps its
+// limbs between SDPs.
+//
+// Each line of the queue is
+//
+//   sdpDir [outDir [checkpointDir]]
+//
+// with the same defaults as the command line options.  A line
+//
+//   objectives sdpDir [outDir [checkpointDir]]
+//
+// is an SDP with the same constraints as the SDP before it, which is
+// kept in memory, so sdpDir only has to hold the objectives.  The
+// solver then starts from the previous solution.  Blank lines and
+// lines starting with '#' are skipped, and a line 'quit' stops the
+// queue.  Only the root reads the queue.  At the end of the file,
+// it waits for more lines, so the queue can be a file that another
+// program appends to, or a named pipe.  All of the other options are
+// the same for every SDP.  Rebalancing is not done for SDPs from the
+// queue, and they are solved at the full precision.
+//
+// block_info is the Block_Info of the SDP that was solved before the
+// queue, or nullptr if there is none, as for the members of an
+// ensemble.
+
+#include "SDP_Solver_Parameters.hxx"
+#include "Block_Info.hxx"
+#include "solve/SDP_Solver.hxx"
+#include "../Timers.hxx"
+#include "solver_comm.hxx"
+
+#include <boost/filesystem/fstream.hpp>
+
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+Timers solve(const Block_Info &block_info,
+             const SDP_Solver_Parameters &parameters, const El::Grid &grid,
+             const bool &objectives_only,
+             const boost::filesystem::path &constraints_directory,
+             std::unique_ptr<SDP> &sdp, std::unique_ptr<SDP_Solver> &solver);
+
+namespace
+{
+  // Collective.  Returns an empty string after 'quit'.
+  std::string next_entry(boost::filesystem::ifstream &queue)
+  {
+    std::string entry;
+    if(El::mpi::Rank(solver_comm()) == 0)
+      {
+        std::string line;
+        while(true)
+          {
+            const int c(queue.get());
+            if(c == std::char_traits<char>::eof())
+              {
+                if(queue.bad())
+                  {
+                    throw std::runtime_error("Error when reading the queue");
+                  }
+                queue.clear();
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+                continue;
+              }
+            if(c != '\n')
+              {
+                line.push_back(c);
+                continue;
+              }
+            const size_t begin(line.find_first_not_of(" \t\r")),
+              end(line.find_last_not_of(" \t\r"));
+            if(begin != std::string::npos && line[begin] != '#')
+              {
+                entry = line.substr(begin, end + 1 - begin);
+                break;
+              }
+            line.clear();
+          }
+        if(entry == "quit")
+          {
+            entry.clear();
+          }
+      }
+    int size(entry.size());
+    El::mpi::Broadcast(size, 0, solver_comm());
+    entry.resize(size);
+    El::mpi::Broadcast(&entry[0], size, 0, solver_comm());
+    return entry;
+  }
+
+  SDP_Solver_Parameters
+  parameters_for_entry(const SDP_Solver_Parameters &parameters,
+                       const std::string &entry, bool &objectives_only)
+  {
+    SDP_Solver_Parameters result(parameters);
+    std::stringstream ss(entry);
+    std::string sdp_directory, out_directory, checkpoint_directory, extra;
+    ss >> sdp_directory;
+    objectives_only = (sdp_directory == "objectives");
+    if(objectives_only)
+      {
+        ss >> sdp_directory;
+      }
+    ss >> out_directory >> checkpoint_directory >> extra;
+    if(!extra.empty())
+      {
+        throw std::runtime_error("Too many directories in queue entry: '"
+                                 + entry + "'");
+      }
+    if(!boost::filesystem::is_directory(sdp_directory))
+      {
+        throw std::runtime_error("sdp directory '" + sdp_directory
+                                 + "' from the queue is not a directory");
+      }
+    result.sdp_directory = sdp_directory;
+    result.out_directory
+      = (out_directory.empty()
+           ? sdp_directory_with_suffix(result.sdp_directory, "_out")
+           : boost::filesystem::path(out_directory));
+    result.checkpoint_out
+      = (checkpoint_directory.empty()
+           ? sdp_directory_with_suffix(result.sdp_directory, ".ck")
+           : boost::filesystem::path(checkpoint_directory));
+    result.checkpoint_in = result.checkpoint_out;
+    result.require_initial_checkpoint = false;
+    result.in_memory_sdp.reset();
+    return result;
+  }
+}
+
+void solve_queue(Block_Info *block_info,
+                 const SDP_Solver_Parameters &parameters)
+{
+  boost::filesystem::ifstream queue;
+  if(El::mpi::Rank(solver_comm()) == 0)
+    {
+      queue.open(parameters.queue_file);
+      if(!queue.good())
+        {
+          throw std::runtime_error("Unable to open queue '"
+                                   + parameters.queue_file.string() + "'");
+        }
+    }
+
+  // The first SDP may have stopped before ramping up to the full
+  // precision.
+  El::gmp::SetPrecision(parameters.precision);
+
+  // Destroy the grid before the Block_Info that owns its
+  // communicator.
+  std::unique_ptr<Block_Info> new_info;
+  Block_Info *current_info(block_info);
+  std::unique_ptr<El::Grid> grid;
+  // The last SDP is kept for entries that only change the objectives.
+  // The constraints of the first SDP are read again if needed.
+  std::unique_ptr<SDP> sdp;
+  std::unique_ptr<SDP_Solver> solver;
+  boost::filesystem::path constraints_directory(parameters.sdp_directory);
+  for(std::string entry(next_entry(queue)); !entry.empty();
+      entry = next_entry(queue))
+    {
+      bool objectives_only;
+      const SDP_Solver_Parameters entry_parameters(
+        parameters_for_entry(parameters, entry, objectives_only));
+      if(objectives_only)
+        {
+          if(current_info == nullptr)
+            {
+              throw std::runtime_error(
+                "The first SDP in the queue can not be 'objectives'");
+            }
+          if(!grid)
+            {
+              grid.reset(new El::Grid(current_info->mpi_comm.value,
+                                      current_info->grid_height()));
+            }
+          if(entry_parameters.verbosity >= Verbosity::regular
+             && El::mpi::Rank(solver_comm()) == 0)
+            {
+              std::cout << "Solving " << entry_parameters.sdp_directory
+                        << ", reusing the constraints of "
+                        << constraints_directory << '\n';
+            }
+          solve(*current_info, entry_parameters, *grid, true,
+                constraints_directory, sdp, solver);
+          continue;
+        }
+
+      constraints_directory = entry_parameters.sdp_directory;
+      const Block_Structure structure(entry_parameters.sdp_directory);
+      const bool is_same(current_info != nullptr
+                         && current_info->is_same_structure(structure));
+      if(is_same)
+        {
+          // The blocks may be split between files differently, and
+          // have different precisions.
+          current_info->file_num_procs = structure.file_num_procs;
+          current_info->file_block_indices = structure.file_block_indices;
+          current_info->block_precisions = structure.block_precisions;
+        }
+      else
+        {
+          solver.reset();
+          sdp.reset();
+          grid.reset();
+          new_info.reset(new Block_Info(
+            entry_parameters.sdp_directory, entry_parameters.checkpoint_in,
+            entry_parameters.procs_per_node,
+            entry_parameters.proc_granularity,
+            entry_parameters.memory_per_node, entry_parameters.verbosity,
+            nullptr, entry_parameters.block_cost_database));
+          current_info = new_info.get();
+        }
+      if(!grid)
+        {
+          grid.reset(new El::Grid(current_info->mpi_comm.value,
+                                  current_info->grid_height()));
+        }
+      if(entry_parameters.verbosity >= Verbosity::regular
+         && El::mpi::Rank(solver_comm()) == 0)
+        {
+          std::cout << "Solving " << entry_parameters.sdp_directory
+                    << (is_same ? ", reusing the block mapping" : "")
+                    << '\n';
+        }
+      solve(*current_info, entry_parameters, *grid, false,
+            constraints_directory, sdp, solver);
+    }
+}
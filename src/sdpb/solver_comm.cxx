@@ -0,0 +1,30 @@
+#include "solver_comm.hxx"
+
+namespace
+{
+  const El::mpi::Comm *current_comm(nullptr);
+  const El::Grid *current_grid(nullptr);
+}
+
+const El::mpi::Comm &solver_comm()
+{
+  return current_comm == nullptr ? El::mpi::COMM_WORLD : *current_comm;
+}
+
+const El::Grid &solver_grid()
+{
+  return current_grid == nullptr ? El::Grid::Default() : *current_grid;
+}
+
+Scoped_Solver_Comm::Scoped_Solver_Comm(const El::mpi::Comm &comm)
+    : grid(new El::Grid(comm))
+{
+  current_comm = &comm;
+  current_grid = grid.get();
+}
+
+Scoped_Solver_Comm::~Scoped_Solver_Comm()
+{
+  current_comm = nullptr;
+  current_grid = nullptr;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <El.hpp>
+
+#include <memory>
+
+// The ranks that solve an SDP together.  This is COMM_WORLD, except
+// with ensembleSize > 1, where COMM_WORLD is split into ensemble
+// members that each solve their own queue of SDPs, independently of
+// the others.  Everything that is collective over the solver uses
+// these instead of COMM_WORLD and El::Grid::Default().
+const El::mpi::Comm &solver_comm();
+// The grid over all of solver_comm()
+const El::Grid &solver_grid();
+
+// Makes comm the solver communicator for the lifetime of the object.
+// comm must outlive it.
+class Scoped_Solver_Comm
+{
+public:
+  explicit Scoped_Solver_Comm(const El::mpi::Comm &comm);
+  ~Scoped_Solver_Comm();
+  Scoped_Solver_Comm(const Scoped_Solver_Comm &) = delete;
+  Scoped_Solver_Comm &operator=(const Scoped_Solver_Comm &) = delete;
+
+private:
+  std::unique_ptr<El::Grid> grid;
+};
@@ -0,0 +1,52 @@
+#include "SDP_Solver_Parameters.hxx"
+#include "solver_comm.hxx"
+
+#include <boost/property_tree/json_parser.hpp>
+
+// The precision to start the solver at.  With initialPrecision, a run
+// that resumes from a checkpoint continues at the precision that the
+// checkpoint was written at, since binary checkpoints can only be read
+// at that precision.  The same holds for a warm start.  Checkpoints
+// that do not record their working precision were written at the full
+// precision.
+size_t starting_precision(const SDP_Solver_Parameters &parameters)
+{
+  if(parameters.initial_precision == 0
+     || parameters.initial_precision >= parameters.precision)
+    {
+      return parameters.precision;
+    }
+  int64_t result(parameters.initial_precision);
+  if(El::mpi::Rank(solver_comm()) == 0)
+    {
+      for(auto &directory : {parameters.checkpoint_in, parameters.warm_start})
+        {
+          if(directory.empty())
+            {
+              continue;
+            }
+          const boost::filesystem::path metadata(directory
+                                                 / "checkpoint.json");
+          if(exists(metadata))
+            {
+              boost::property_tree::ptree tree;
+              boost::property_tree::read_json(metadata.string(), tree);
+              result = tree.get<int64_t>(
+                "options.precision_working",
+                tree.get<int64_t>("options.precision",
+                                  parameters.precision));
+              break;
+            }
+          if(exists(directory / "checkpoint.0"))
+            {
+              result = parameters.precision;
+              break;
+            }
+        }
+    }
+  // See load_binary_checkpoint() about broadcasting an int64_t.
+  El::mpi::Broadcast(reinterpret_cast<El::byte *>(&result),
+                     sizeof(result) / sizeof(El::byte), 0,
+                     solver_comm());
+  return result;
+}
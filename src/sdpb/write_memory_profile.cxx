@@ -0,0 +1,123 @@
+// Reduce the memory high-water marks of each timer over the ranks on
+// each node, and write one file per node, <prefix>.node<N>.  Each
+// line is
+//
+//   {name, max_rss, sum_rss, max_heap, sum_heap}
+//
+// in bytes, sorted by name.  The max is over the ranks of the node,
+// and the sum is an upper bound for the whole node, since the ranks
+// may reach their peaks at different times.  Nodes are ranks
+// rank/procs_per_node, as in the rest of SDPB.
+//
+// This is collective.  It only has data in debug mode.
+
+#include "../Timers.hxx"
+#include "solver_comm.hxx"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <array>
+#include <map>
+
+void write_memory_profile(const std::string &prefix, const Timers &timers,
+                          const size_t &procs_per_node)
+{
+  const int rank(El::mpi::Rank(solver_comm()));
+  El::mpi::Comm node_comm;
+  El::mpi::Split(solver_comm(), rank / procs_per_node, rank,
+                 node_comm);
+  const int node_rank(El::mpi::Rank(node_comm)),
+    node_size(El::mpi::Size(node_comm));
+
+  // Names are sent as null terminated strings.
+  std::vector<char> names;
+  std::vector<int64_t> values;
+  for(auto &statistics : timers)
+    {
+      if(statistics.max_rss == 0 && statistics.max_heap == 0)
+        {
+          continue;
+        }
+      names.insert(names.end(), statistics.name.begin(),
+                   statistics.name.end());
+      names.push_back('\0');
+      values.push_back(statistics.max_rss);
+      values.push_back(statistics.max_heap);
+    }
+
+  std::array<int, 2> sizes({{int(names.size()), int(values.size())}});
+  std::vector<int> all_sizes(2 * node_size);
+  MPI_Gather(sizes.data(), 2, MPI_INT, all_sizes.data(), 2, MPI_INT, 0,
+             node_comm.comm);
+  std::vector<int> name_counts(node_size), name_offsets(node_size),
+    value_counts(node_size), value_offsets(node_size);
+  for(int node_proc = 0; node_proc < node_size; ++node_proc)
+    {
+      name_counts[node_proc] = all_sizes[2 * node_proc];
+      value_counts[node_proc] = all_sizes[2 * node_proc + 1];
+      if(node_proc > 0)
+        {
+          name_offsets[node_proc]
+            = name_offsets[node_proc - 1] + name_counts[node_proc - 1];
+          value_offsets[node_proc]
+            = value_offsets[node_proc - 1] + value_counts[node_proc - 1];
+        }
+    }
+  std::vector<char> all_names(node_rank == 0 ? name_offsets.back()
+                                                 + name_counts.back()
+                                             : 0);
+  std::vector<int64_t> all_values(
+    node_rank == 0 ? value_offsets.back() + value_counts.back() : 0);
+  MPI_Gatherv(names.data(), sizes[0], MPI_CHAR, all_names.data(),
+              name_counts.data(), name_offsets.data(), MPI_CHAR, 0,
+              node_comm.comm);
+  MPI_Gatherv(values.data(), sizes[1], MPI_INT64_T, all_values.data(),
+              value_counts.data(), value_offsets.data(), MPI_INT64_T, 0,
+              node_comm.comm);
+  El::mpi::Free(node_comm);
+
+  if(node_rank != 0)
+    {
+      return;
+    }
+
+  // {max_rss, sum_rss, max_heap, sum_heap} for each name.
+  std::map<std::string, std::array<int64_t, 4>> node_memory;
+  auto name(all_names.begin());
+  for(auto value(all_values.begin()); value != all_values.end(); value += 2)
+    {
+      auto name_end(std::find(name, all_names.end(), '\0'));
+      auto &memory(node_memory
+                     .emplace(std::string(name, name_end),
+                              std::array<int64_t, 4>({{0, 0, 0, 0}}))
+                     .first->second);
+      memory[0] = std::max(memory[0], *value);
+      memory[1] += *value;
+      memory[2] = std::max(memory[2], *(value + 1));
+      memory[3] += *(value + 1);
+      name = std::next(name_end);
+    }
+
+  const boost::filesystem::path filename(
+    prefix + ".node" + std::to_string(rank / procs_per_node));
+  boost::filesystem::ofstream f(filename);
+  f << "{" << '\n';
+  for(auto iter(node_memory.begin()); iter != node_memory.end();)
+    {
+      f << "    {\"" << iter->first << "\", " << iter->second[0] << ", "
+        << iter->second[1] << ", " << iter->second[2] << ", "
+        << iter->second[3] << "}";
+      ++iter;
+      if(iter != node_memory.end())
+        {
+          f << ",";
+        }
+      f << '\n';
+    }
+  f << "}" << '\n';
+  if(!f.good())
+    {
+      throw std::runtime_error("Error when writing to: " + filename.string());
+    }
+}
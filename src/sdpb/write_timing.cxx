@@ -1,37 +1,176 @@
 #include "Block_Info.hxx"
+#include "Block_Cost_Database.hxx"
 #include "../Timers.hxx"
+#include "solver_comm.hxx"
 
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 
+#include <algorithm>
+#include <cmath>
+
+void write_block_timings(const boost::filesystem::path &checkpoint_out,
+                         const El::Matrix<int32_t> &block_timings);
+
+namespace
+{
+  // Timers for a single block are named <prefix><block index>.
+  const std::vector<std::string> block_timer_prefixes(
+    {"run.step.initializeSchurComplementSolver.Q.syrk_",
+     "run.step.initializeSchurComplementSolver.Q.solve_",
+     "run.step.initializeSchurComplementSolver.Q.cholesky_",
+     "run.step.initializeSchurComplementSolver.schur_complement_",
+     "run.computeDualResidues_"});
+
+  // Timers that cover all of a rank's blocks at once.  Their time is
+  // split among the local blocks in proportion to an estimate of each
+  // block's share.  For the blocks of X and Y, that is the cube of
+  // their size R.  For the bilinear pairings, it is R K (R + K), where
+  // K is the size of the pairings.
+  const std::vector<std::string> psd_block_timers(
+    {"run.choleskyDecomposition", "run.computePrimalResidues",
+     "run.step.frobenius_product_symmetric",
+     "run.step.computeSearchDirection(betaPredictor)",
+     "run.step.computeSearchDirection(betaCorrector)",
+     "run.step.computeSearchDirection(extraCorrectors)",
+     "run.step.stepLength(XCholesky)", "run.step.stepLength(YCholesky)"}),
+    pairing_timers({"run.bilinear_pairings"});
+
+  bool contains(const std::vector<std::string> &names, const std::string &name)
+  {
+    return std::find(names.begin(), names.end(), name) != names.end();
+  }
+
+  double elapsed_milliseconds(const Timer_Statistics::Duration &duration)
+  {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  }
+}
+
+// The cost of a block is its share of the time of the last complete
+// iteration.  The first iteration is a poor estimate, because many
+// quantities are zero, and the last iteration of the timing run stops
+// before the step.
+//
+// If block_cost_database is set, the costs are also added to it, with
+// the number of processes that each block was spread over.
 void write_timing(const boost::filesystem::path &checkpoint_out,
+                  const boost::filesystem::path &block_cost_database,
                   const Block_Info &block_info, const Timers &timers,
                   const bool &debug, El::Matrix<int32_t> &block_timings)
 {
   if(debug)
     {
       timers.write_profile(checkpoint_out.string() + ".profiling."
-                           + std::to_string(El::mpi::Rank()));
+                           + std::to_string(El::mpi::Rank(solver_comm())));
     }
 
-  El::Zero(block_timings);
+  // Timers::start_iteration() is called at the top of each iteration.
+  // If the current iteration stopped before its step, use the one
+  // before it.
+  const Timer_Statistics *step(timers.find("run.step"));
+  if(step == nullptr
+     || (step->iteration_count == 0 && step->previous_iteration_count == 0))
+    {
+      throw std::runtime_error("No complete iteration in the timing run");
+    }
+  const bool use_previous(step->iteration_count == 0);
+
+  std::vector<double> milliseconds(block_timings.Height(), 0);
+  double psd_block_milliseconds(0), pairing_milliseconds(0);
+  for(auto &timer : timers)
+    {
+      const std::string &name(timer.name);
+      const double elapsed(
+        elapsed_milliseconds(use_previous ? timer.previous_iteration_total
+                                          : timer.iteration_total));
+      if(contains(psd_block_timers, name))
+        {
+          psd_block_milliseconds += elapsed;
+          continue;
+        }
+      if(contains(pairing_timers, name))
+        {
+          pairing_milliseconds += elapsed;
+          continue;
+        }
+      const size_t underscore(name.rfind('_'));
+      if(underscore != std::string::npos
+         && contains(block_timer_prefixes, name.substr(0, underscore + 1)))
+        {
+          milliseconds.at(std::stoul(name.substr(underscore + 1))) += elapsed;
+        }
+    }
+
+  std::vector<double> psd_block_weights, pairing_weights;
+  double psd_block_total(0), pairing_total(0);
   for(auto &index : block_info.block_indices)
     {
-      block_timings(index, 0) = timers.elapsed_milliseconds(
-                                  "run.step.initializeSchurComplementSolver."
-                                  "Q.syrk_"
-                                  + std::to_string(index))
-                                + timers.elapsed_milliseconds(
-                                    "run.step.initializeSchurComplementSolver."
-                                    "Q.solve_"
-                                    + std::to_string(index))
-                                + timers.elapsed_milliseconds(
-                                    "run.step.initializeSchurComplementSolver."
-                                    "Q.cholesky_"
-                                    + std::to_string(index));
-    }
-  El::AllReduce(block_timings, El::mpi::COMM_WORLD);
-  if(El::mpi::Rank() == 0)
+      psd_block_weights.push_back(0);
+      pairing_weights.push_back(0);
+      for(size_t parity = 0; parity < 2; ++parity)
+        {
+          const size_t psd_block(2 * index + parity);
+          const double R(block_info.psd_matrix_block_sizes[psd_block]),
+            K(block_info.bilinear_pairing_block_sizes[psd_block]);
+          psd_block_weights.back() += R * R * R;
+          pairing_weights.back() += R * K * (R + K);
+        }
+      psd_block_total += psd_block_weights.back();
+      pairing_total += pairing_weights.back();
+    }
+
+  El::Zero(block_timings);
+  for(size_t block = 0; block < block_info.block_indices.size(); ++block)
+    {
+      const size_t index(block_info.block_indices[block]);
+      if(psd_block_total > 0)
+        {
+          milliseconds[index] += psd_block_milliseconds
+                                 * psd_block_weights[block] / psd_block_total;
+        }
+      if(pairing_total > 0)
+        {
+          milliseconds[index]
+            += pairing_milliseconds * pairing_weights[block] / pairing_total;
+        }
+      block_timings(index, 0) = std::lround(milliseconds[index]);
+    }
+  El::AllReduce(block_timings, solver_comm());
+
+  El::Matrix<int32_t> grid_sizes;
+  if(!block_cost_database.empty())
+    {
+      El::Zeros(grid_sizes, block_timings.Height(), 1);
+      for(auto &index : block_info.block_indices)
+        {
+          grid_sizes(index, 0) = El::mpi::Size(block_info.mpi_comm.value);
+        }
+      El::AllReduce(grid_sizes, solver_comm(), El::mpi::MAX);
+    }
+  if(El::mpi::Rank(solver_comm()) == 0 && !block_cost_database.empty())
+    {
+      Block_Cost_Database database;
+      database.read(block_cost_database);
+      for(int64_t index = 0; index < block_timings.Height(); ++index)
+        {
+          database.add({int64_t(block_info.dimensions[index]),
+                        int64_t(block_info.degrees[index]),
+                        int64_t(block_info.num_free_variables),
+                        int64_t(block_info.block_precision(index)),
+                        grid_sizes(index, 0)},
+                       block_timings(index, 0));
+        }
+      database.write(block_cost_database);
+    }
+  write_block_timings(checkpoint_out, block_timings);
+}
+
+// Rank 0 writes checkpoint_out/block_timings.
+void write_block_timings(const boost::filesystem::path &checkpoint_out,
+                         const El::Matrix<int32_t> &block_timings)
+{
+  if(El::mpi::Rank(solver_comm()) == 0)
     {
       boost::filesystem::create_directories(checkpoint_out);
       boost::filesystem::path block_timings_path(checkpoint_out
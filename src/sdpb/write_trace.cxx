@@ -0,0 +1,132 @@
+// Write the intervals recorded by Timers::start_trace() in the Chrome
+// trace event format, which can be viewed with chrome://tracing or
+// https://ui.perfetto.dev.  Each rank is a process in the trace, and
+// each interval is a complete ("X") event with times in microseconds.
+//
+// All of the ranks write into a single file with
+// MPI_File_write_ordered, in rank order.  The file uses the JSON
+// Array Format without the closing ']', which the viewers accept.
+// That lets later segments of a run (e.g. after rebalancing) append
+// to the same file.  The first call in a process starts a new file.
+
+#include "../Timers.hxx"
+#include "solver_comm.hxx"
+
+#include <boost/filesystem.hpp>
+
+#include <limits>
+#include <sstream>
+
+namespace
+{
+  void check_mpi_error(const int &mpi_error)
+  {
+    if(mpi_error != MPI_SUCCESS)
+      {
+        std::vector<char> error_string(MPI_MAX_ERROR_STRING);
+        int lengthOfErrorString;
+        MPI_Error_string(mpi_error, error_string.data(), &lengthOfErrorString);
+        El::RuntimeError(std::string(error_string.data()));
+      }
+  }
+
+  std::string escape(const std::string &name)
+  {
+    std::string result;
+    for(auto &c : name)
+      {
+        if(c == '"' || c == '\\')
+          {
+            result.push_back('\\');
+          }
+        result.push_back(c);
+      }
+    return result;
+  }
+
+  double microseconds(
+    const std::chrono::high_resolution_clock::duration &duration)
+  {
+    return std::chrono::duration<double, std::micro>(duration).count();
+  }
+
+  bool is_first_write(true);
+}
+
+// A common origin for the traces of all ranks.  The first call is
+// collective.  Clocks on different nodes are only aligned to within
+// the time of a barrier.
+std::chrono::time_point<std::chrono::high_resolution_clock> trace_origin()
+{
+  static bool is_set(false);
+  static std::chrono::time_point<std::chrono::high_resolution_clock> result;
+  if(!is_set)
+    {
+      El::mpi::Barrier(solver_comm());
+      result = std::chrono::high_resolution_clock::now();
+      is_set = true;
+    }
+  return result;
+}
+
+void write_trace(const boost::filesystem::path &trace_file,
+                 const Timers &timers)
+{
+  const std::vector<Trace_Event> *events(timers.trace_events());
+  if(events == nullptr)
+    {
+      return;
+    }
+  const int rank(El::mpi::Rank(solver_comm()));
+
+  std::stringstream ss;
+  if(is_first_write)
+    {
+      if(rank == 0)
+        {
+          ss << "[\n";
+        }
+      ss << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << rank
+         << ",\"args\":{\"name\":\"rank " << rank << "\"}},\n"
+         << "{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":" << rank
+         << ",\"args\":{\"sort_index\":" << rank << "}},\n"
+         << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << rank
+         << ",\"tid\":1,\"args\":{\"name\":\"accumulated\"}},\n";
+    }
+  ss.precision(3);
+  ss << std::fixed;
+  for(auto &event : *events)
+    {
+      // Timers is a deque of Timer_Statistics indexed by id.
+      ss << "{\"name\":\"" << escape(timers[event.id].name)
+         << "\",\"ph\":\"X\",\"pid\":" << rank << ",\"tid\":" << event.lane
+         << ",\"ts\":" << microseconds(event.start - timers.trace_origin)
+         << ",\"dur\":" << microseconds(event.stop - event.start) << "},\n";
+    }
+  const std::string buffer(ss.str());
+  if(buffer.size() > size_t(std::numeric_limits<int>::max()))
+    {
+      throw std::runtime_error("Trace for rank " + std::to_string(rank)
+                               + " is too large to write");
+    }
+
+  MPI_File file;
+  check_mpi_error(MPI_File_open(solver_comm().comm, trace_file.c_str(),
+                                MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                                MPI_INFO_NULL, &file));
+  if(is_first_write)
+    {
+      check_mpi_error(MPI_File_set_size(file, 0));
+    }
+  else
+    {
+      MPI_Offset size;
+      check_mpi_error(MPI_File_get_size(file, &size));
+      check_mpi_error(MPI_File_seek_shared(file, size, MPI_SEEK_SET));
+    }
+  check_mpi_error(MPI_File_write_ordered(
+    file, const_cast<char *>(buffer.data()), int(buffer.size()), MPI_CHAR,
+    MPI_STATUS_IGNORE));
+  check_mpi_error(MPI_File_close(&file));
+  is_first_write = false;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <El.hpp>
+
+#include <string>
+
+// The fastest time on this rank for one kernel.
+struct Benchmark_Result
+{
+  std::string kernel;
+  double seconds;
+};
@@ -0,0 +1,215 @@
+// Time the El::BigFloat kernels that dominate an SDPB iteration, for
+// comparing matrix backends, allocators and MPI libraries.  For each
+// precision, matrix size and grid size, every rank joins a group of
+// that size, and all of the groups time the kernels at the same time,
+// as the block groups do in the solver.  The results are written as
+// CSV, one line per kernel and configuration.
+
+#include "Benchmark_Result.hxx"
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <sstream>
+
+namespace po = boost::program_options;
+
+std::vector<Benchmark_Result>
+time_kernels(const El::Grid &grid, const El::Int &size, const El::Int &width,
+             const size_t &repeats);
+
+namespace
+{
+  std::vector<int> parse_list(const std::string &list)
+  {
+    std::vector<int> result;
+    std::stringstream ss(list);
+    std::string element;
+    while(std::getline(ss, element, ','))
+      {
+        try
+          {
+            result.push_back(std::stoi(element));
+          }
+        catch(std::exception &)
+          {
+            throw std::runtime_error("Invalid element '" + element
+                                     + "' in list '" + list + "'");
+          }
+        if(result.back() <= 0)
+          {
+            throw std::runtime_error("Elements of '" + list
+                                     + "' must be positive");
+          }
+      }
+    return result;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  El::Environment env(argc, argv);
+
+  try
+    {
+      std::string precisions_list, sizes_list, grid_sizes_list;
+      int width;
+      size_t repeats;
+      boost::filesystem::path output_file;
+
+      po::options_description options("Basic options");
+      options.add_options()("help,h", "Show this helpful message.");
+      options.add_options()(
+        "precisions",
+        po::value<std::string>(&precisions_list)
+          ->default_value("128,256,512,1024,2048"),
+        "Comma separated list of precisions, in bits.");
+      options.add_options()(
+        "sizes",
+        po::value<std::string>(&sizes_list)->default_value("16,32,64,128"),
+        "Comma separated list of matrix sizes.  A size is the dimension "
+        "of the square matrices, such as a block of X or of the Schur "
+        "complement.");
+      options.add_options()(
+        "width", po::value<int>(&width)->default_value(0),
+        "The number of columns of the rectangular matrix B, which plays "
+        "the role of the free variable matrix in the Trsm and Syrk that "
+        "build Q.  0 means the same as the size.");
+      options.add_options()(
+        "gridSizes", po::value<std::string>(&grid_sizes_list),
+        "Comma separated list of the number of processes in a grid.  "
+        "Each must divide the number of processes.  Defaults to 1 and "
+        "the number of processes.");
+      options.add_options()("repeats",
+                            po::value<size_t>(&repeats)->default_value(3),
+                            "The number of times to run each kernel.  The "
+                            "fastest run is reported.");
+      options.add_options()(
+        "output,o", po::value<boost::filesystem::path>(&output_file),
+        "CSV file for the results.  Defaults to standard output.");
+
+      po::variables_map variables_map;
+      po::store(po::parse_command_line(argc, argv, options), variables_map);
+
+      if(variables_map.count("help") != 0)
+        {
+          if(El::mpi::Rank() == 0)
+            {
+              std::cout << options << '\n';
+            }
+          return 0;
+        }
+      po::notify(variables_map);
+
+      const int num_procs(El::mpi::Size(El::mpi::COMM_WORLD)),
+        rank(El::mpi::Rank(El::mpi::COMM_WORLD));
+      const std::vector<int> precisions(parse_list(precisions_list)),
+        sizes(parse_list(sizes_list)),
+        grid_sizes(grid_sizes_list.empty()
+                     ? parse_list(num_procs == 1
+                                    ? "1"
+                                    : "1," + std::to_string(num_procs))
+                     : parse_list(grid_sizes_list));
+      if(width < 0)
+        {
+          throw std::runtime_error("width must not be negative");
+        }
+      if(repeats == 0)
+        {
+          throw std::runtime_error("repeats must be positive");
+        }
+      for(auto &grid_size : grid_sizes)
+        {
+          if(num_procs % grid_size != 0)
+            {
+              throw std::runtime_error(
+                "Grid size " + std::to_string(grid_size)
+                + " does not divide the number of processes "
+                + std::to_string(num_procs));
+            }
+        }
+
+      boost::filesystem::ofstream output_stream;
+      if(rank == 0 && !output_file.empty())
+        {
+          output_stream.open(output_file);
+          if(!output_stream.good())
+            {
+              throw std::runtime_error("Unable to open '"
+                                       + output_file.string() + "'");
+            }
+        }
+      std::ostream &output(output_file.empty() ? std::cout : output_stream);
+      if(rank == 0)
+        {
+          output << "kernel,precision,size,width,grid_size,grid_height,"
+                    "grid_width,num_groups,min_seconds,max_seconds,"
+                    "mean_seconds\n";
+        }
+
+      for(auto &grid_size : grid_sizes)
+        {
+          // Consecutive ranks share a group, so that small groups stay
+          // on one node.
+          El::mpi::Comm group_comm;
+          El::mpi::Split(El::mpi::COMM_WORLD, rank / grid_size, rank,
+                         group_comm);
+          {
+            const El::Grid grid(group_comm);
+            for(auto &precision : precisions)
+              {
+                El::gmp::SetPrecision(precision);
+                for(auto &size : sizes)
+                  {
+                    const El::Int columns(width == 0 ? size : width);
+                    const std::vector<Benchmark_Result> results(
+                      time_kernels(grid, size, columns, repeats));
+                    // The fastest run on each rank, summarized over
+                    // all ranks.
+                    std::vector<double> min_seconds, max_seconds,
+                      sum_seconds;
+                    for(auto &result : results)
+                      {
+                        min_seconds.push_back(result.seconds);
+                      }
+                    max_seconds = sum_seconds = min_seconds;
+                    El::mpi::AllReduce(min_seconds.data(), results.size(),
+                                       El::mpi::MIN, El::mpi::COMM_WORLD);
+                    El::mpi::AllReduce(max_seconds.data(), results.size(),
+                                       El::mpi::MAX, El::mpi::COMM_WORLD);
+                    El::mpi::AllReduce(sum_seconds.data(), results.size(),
+                                       El::mpi::SUM, El::mpi::COMM_WORLD);
+                    for(size_t index = 0; rank == 0 && index < results.size();
+                        ++index)
+                      {
+                        output << results[index].kernel << "," << precision
+                               << "," << size << "," << columns << ","
+                               << grid_size << "," << grid.Height() << ","
+                               << grid.Width() << "," << num_procs / grid_size
+                               << "," << min_seconds[index] << ","
+                               << max_seconds[index] << ","
+                               << sum_seconds[index] / num_procs << "\n"
+                               << std::flush;
+                      }
+                  }
+              }
+          }
+          El::mpi::Free(group_comm);
+        }
+      if(rank == 0 && !output.good())
+        {
+          throw std::runtime_error("Error when writing results");
+        }
+    }
+  catch(std::exception &e)
+    {
+      std::cerr << "Error: " << e.what() << "\n" << std::flush;
+      El::mpi::Abort(El::mpi::COMM_WORLD, 1);
+    }
+  catch(...)
+    {
+      std::cerr << "Unknown Error\n" << std::flush;
+      El::mpi::Abort(El::mpi::COMM_WORLD, 1);
+    }
+}
@@ -0,0 +1,127 @@
+#include "Benchmark_Result.hxx"
+#include "../sdpb/solve/block_kernels.hxx"
+
+#include <chrono>
+#include <limits>
+
+// Time each kernel on 'grid' with the same calls as the solver:
+//
+//   gemm, syrk:     the products of B that build Q in initialize_Q_group
+//   trsm:           the solve with the Cholesky factor of X in
+//                   compute_bilinear_pairings_X_inv
+//   cholesky:       the Cholesky decompositions of X, Y and the Schur
+//                   complement
+//   hermitian_eig:  the eigenvalues in min_eigenvalue
+//   hadamard:       an elementwise product, for the memory bandwidth
+//                   of BigFloat
+//
+// The square matrices are size x size, and B is size x width.  The
+// kernels that overwrite their input start from a copy, which is not
+// timed.  All ranks in the grid start each run together.
+
+namespace
+{
+  // Symmetric and positive definite, with entries that are not exactly
+  // representable, so that every operation works at full precision.
+  void fill_positive(El::DistMatrix<El::BigFloat> &A)
+  {
+    const El::Int n(A.Height());
+    for(El::Int row = 0; row < A.LocalHeight(); ++row)
+      for(El::Int column = 0; column < A.LocalWidth(); ++column)
+        {
+          const El::Int global_row(A.GlobalRow(row)),
+            global_column(A.GlobalCol(column));
+          A.SetLocal(row, column,
+                     El::BigFloat(1)
+                         / El::BigFloat(int(1 + global_row + global_column))
+                       + (global_row == global_column ? El::BigFloat(int(n))
+                                                      : El::BigFloat(0)));
+        }
+  }
+
+  void fill_rectangular(El::DistMatrix<El::BigFloat> &A)
+  {
+    for(El::Int row = 0; row < A.LocalHeight(); ++row)
+      for(El::Int column = 0; column < A.LocalWidth(); ++column)
+        {
+          A.SetLocal(row, column,
+                     El::BigFloat(1)
+                       / El::BigFloat(int(1 + A.GlobalRow(row)
+                                          + 2 * A.GlobalCol(column))));
+        }
+  }
+
+  template <typename Setup, typename Run>
+  double fastest(const El::Grid &grid, const size_t &repeats,
+                 const Setup &setup, const Run &run)
+  {
+    double result(std::numeric_limits<double>::max());
+    for(size_t repeat = 0; repeat < repeats; ++repeat)
+      {
+        setup();
+        El::mpi::Barrier(grid.Comm());
+        const auto start(std::chrono::high_resolution_clock::now());
+        run();
+        result = std::min(
+          result, std::chrono::duration<double>(
+                    std::chrono::high_resolution_clock::now() - start)
+                    .count());
+      }
+    return result;
+  }
+}
+
+std::vector<Benchmark_Result>
+time_kernels(const El::Grid &grid, const El::Int &size, const El::Int &width,
+             const size_t &repeats)
+{
+  El::DistMatrix<El::BigFloat> positive(size, size, grid),
+    B(size, width, grid), L(grid), work(grid), Q(width, width, grid),
+    product(size, size, grid);
+  fill_positive(positive);
+  fill_rectangular(B);
+  L = positive;
+  block_cholesky_lower(L);
+
+  std::vector<Benchmark_Result> result;
+  result.push_back(
+    {"gemm", fastest(grid, repeats, [&]() { El::Zero(Q); },
+                     [&]() {
+                       block_gemm(El::OrientationNS::TRANSPOSE,
+                                  El::OrientationNS::NORMAL, El::BigFloat(1),
+                                  B, B, El::BigFloat(1), Q);
+                     })});
+  result.push_back(
+    {"syrk", fastest(grid, repeats, [&]() { El::Zero(Q); },
+                     [&]() {
+                       block_syrk(El::UpperOrLowerNS::UPPER,
+                                  El::OrientationNS::TRANSPOSE,
+                                  El::BigFloat(1), B, El::BigFloat(1), Q);
+                     })});
+  result.push_back(
+    {"trsm", fastest(grid, repeats, [&]() { El::Copy(B, work); },
+                     [&]() {
+                       block_trsm_lower(El::Orientation::NORMAL, L, work);
+                     })});
+  result.push_back({"cholesky",
+                    fastest(grid, repeats, [&]() { El::Copy(positive, work); },
+                            [&]() { block_cholesky_lower(work); })});
+
+  El::DistMatrix<El::BigFloat, El::VR, El::STAR> eigenvalues(grid);
+  El::HermitianEigCtrl<El::BigFloat> hermitian_eig_ctrl;
+  // The same settings as min_eigenvalue()
+  hermitian_eig_ctrl.tridiagEigCtrl.dcCtrl.cutoff = size / 2 + 1;
+  hermitian_eig_ctrl.tridiagEigCtrl.dcCtrl.secularCtrl.maxIterations = 16384;
+  result.push_back({"hermitian_eig",
+                    fastest(grid, repeats, [&]() { El::Copy(positive, work); },
+                            [&]() {
+                              El::HermitianEig(El::UpperOrLowerNS::LOWER, work,
+                                               eigenvalues,
+                                               hermitian_eig_ctrl);
+                            })});
+  result.push_back(
+    {"hadamard", fastest(grid, repeats, []() {}, [&]() {
+       El::Hadamard(positive, positive, product);
+     })});
+  return result;
+}
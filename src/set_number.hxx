@@ -0,0 +1,68 @@
+#pragma once
+
+#include <El.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+// An exact binary number, (-1)^is_negative * mantissa * 2^exponent,
+// with the magnitude of the mantissa as big endian bytes, as in the
+// bignums and bigfloats of CBOR.  The bytes are not owned.
+struct Binary_Number
+{
+  bool is_negative = false;
+  int64_t exponent = 0;
+  const unsigned char *mantissa = nullptr;
+  size_t mantissa_size = 0;
+};
+
+// x = the decimal number in the null terminated string number.  For
+// BigFloat, the string goes straight to GMP, which writes into x at
+// x's precision without a temporary BigFloat or std::string.  Throws
+// if number is not a valid number.
+inline void set_number(const char *number, El::BigFloat &x)
+{
+  if(mpf_set_str(x.gmp_float.get_mpf_t(), number, 10) != 0)
+    {
+      throw std::runtime_error("Invalid number: '" + std::string(number)
+                               + "'");
+    }
+}
+
+// x = number, truncated to x's precision.  No decimal conversion is
+// involved.
+inline void set_number(const Binary_Number &number, El::BigFloat &x)
+{
+  mpz_class mantissa;
+  mpz_import(mantissa.get_mpz_t(), number.mantissa_size, 1, 1, 1, 0,
+             number.mantissa);
+  mpf_ptr result(x.gmp_float.get_mpf_t());
+  mpf_set_z(result, mantissa.get_mpz_t());
+  if(number.is_negative)
+    {
+      mpf_neg(result, result);
+    }
+  if(number.exponent >= 0)
+    {
+      mpf_mul_2exp(result, result, number.exponent);
+    }
+  else
+    {
+      mpf_div_2exp(result, result, -number.exponent);
+    }
+}
+
+template <typename Float_Type>
+void set_number(const char *number, Float_Type &x)
+{
+  try
+    {
+      x = Float_Type(number);
+    }
+  catch(...)
+    {
+      throw std::runtime_error("Invalid number: '" + std::string(number)
+                               + "'");
+    }
+}
@@ -0,0 +1,66 @@
+#!/bin/bash
+
+# Strong and weak scaling runs on problems from generate_sdp.  Run
+# this from the top level directory.  Settings can be overridden from
+# the environment, e.g.
+#
+#   PROCS="4 8 16 32" PROCS_PER_NODE=16 BLOCKS=400 test/run_scaling.sh
+#
+# Strong scaling solves the same problem with BLOCKS blocks on each
+# number of processes.  Weak scaling uses BLOCKS_PER_PROC blocks per
+# process.  Each line of the output has the mode, the number of
+# processes and blocks, the iterations completed, and the mean
+# seconds per iteration, taken from --metricsFile.
+
+PROCS=${PROCS:-"1 2 4"}
+PROCS_PER_NODE=${PROCS_PER_NODE:-4}
+BLOCKS=${BLOCKS:-64}
+BLOCKS_PER_PROC=${BLOCKS_PER_PROC:-16}
+DIMS=${DIMS:-"1:2"}
+DEGREES=${DEGREES:-"10:30"}
+FREE_VARIABLES=${FREE_VARIABLES:-100}
+PRECISION=${PRECISION:-768}
+ITERATIONS=${ITERATIONS:-10}
+SEED=${SEED:-0}
+WORK=${WORK:-test/scaling}
+
+rm -rf $WORK
+mkdir -p $WORK
+
+# run MODE PROCS BLOCKS
+run()
+{
+    local mode=$1 procs=$2 blocks=$3
+    local sdp=$WORK/sdp_$blocks
+    if [ ! -d $sdp ]
+    then
+        mpirun -n $PROCS_PER_NODE --quiet ./build/generate_sdp \
+               --precision=$PRECISION --blocks=$blocks --dims=$DIMS \
+               --degrees=$DEGREES --numFreeVariables=$FREE_VARIABLES \
+               --seed=$SEED --binary -o $sdp || exit 1
+    fi
+    local node_procs=$(( procs < PROCS_PER_NODE ? procs : PROCS_PER_NODE ))
+    local metrics=$WORK/metrics_${mode}_$procs.jsonl
+    mpirun -n $procs --quiet ./build/sdpb --precision=$PRECISION \
+           --procsPerNode=$node_procs -s $sdp -c $WORK/ck_${mode}_$procs \
+           --noFinalCheckpoint --maxIterations=$ITERATIONS \
+           --metricsFile=$metrics --verbosity=0 > /dev/null || exit 1
+    # The first iteration includes the timing run, so skip it.
+    awk -v mode=$mode -v procs=$procs -v blocks=$blocks '
+        { match($0, /"elapsed_seconds":[0-9.e+-]+/);
+          seconds = substr($0, RSTART + 18, RLENGTH - 18);
+          if (NR == 1) { first = seconds }
+          last = seconds }
+        END { printf "%s\t%d\t%d\t%d\t%g\n", mode, procs, blocks, NR,
+                     (NR > 1 ? (last - first) / (NR - 1) : last) }' $metrics
+}
+
+printf "mode\tprocs\tblocks\titerations\tseconds_per_iteration\n"
+for procs in $PROCS
+do
+    run strong $procs $BLOCKS
+done
+for procs in $PROCS
+do
+    run weak $procs $(( procs * BLOCKS_PER_PROC ))
+done
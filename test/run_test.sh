@@ -3,6 +3,35 @@
 # Run this from the top level directory
 result=0
 
+# Check that the run with the output directory $1 found the same kind
+# of solution as test/test_out_orig, with objectives that agree to 25
+# digits.  This is for runs that may legitimately sum in a different
+# order, such as with more processes, so that they can not be diffed.
+check_objectives()
+{
+    python3 - "$1/out.txt" test/test_out_orig/out.txt <<'EOF'
+import sys
+from decimal import Decimal, getcontext
+
+getcontext().prec = 400
+
+def read(filename):
+    result = {}
+    for line in open(filename):
+        if '=' in line:
+            key, value = line.split('=', 1)
+            result[key.strip()] = value.strip().rstrip(';').strip('"')
+    return result
+
+out, orig = read(sys.argv[1]), read(sys.argv[2])
+is_same = out['terminateReason'] == orig['terminateReason']
+for key in ('primalObjective', 'dualObjective'):
+    difference = abs(Decimal(out[key]) - Decimal(orig[key]))
+    is_same = is_same and difference <= Decimal('1e-25') * abs(Decimal(orig[key]))
+sys.exit(0 if is_same else 1)
+EOF
+}
+
 rm -rf test/test/
 ./build/pvm2sdp 1024 test/file_list.nsv test/test/
 if [ $? == 0 ]
@@ -427,4 +456,323 @@ else
 fi
 rm -rf test/io_tests
 
+mkdir -p test/io_tests
+mpirun -n 2 --quiet ./build/sdpb --precision=1024 --procsPerNode=1 -s test/test/ -c test/io_tests/ck -o test/io_tests/out_start --maxIterations=10 --verbosity=0
+mpirun -n 1 --quiet ./build/sdpb --precision=1024 --noFinalCheckpoint --procsPerNode=1 -s test/test/ -c test/io_tests/ck -o test/io_tests/out --verbosity=0
+diff test/io_tests/out test/test_out_orig
+if [ $? == 0 ]
+then
+    echo "PASS binary checkpoint resume"
+else
+    echo "FAIL binary checkpoint resume"
+    result=1
+fi
+rm -rf test/io_tests
+
+mkdir -p test/io_tests
+mpirun -n 2 --quiet ./build/sdpb --precision=1024 --procsPerNode=1 -s test/test/ -c test/io_tests/ck -o test/io_tests/out_start --maxIterations=10 --verbosity=0 --singleFileCheckpoint
+mpirun -n 1 --quiet ./build/sdpb --precision=1024 --noFinalCheckpoint --procsPerNode=1 -s test/test/ -c test/io_tests/ck -o test/io_tests/out --verbosity=0
+diff test/io_tests/out test/test_out_orig
+if [ $? == 0 ]
+then
+    echo "PASS single file checkpoint resume"
+else
+    echo "FAIL single file checkpoint resume"
+    result=1
+fi
+rm -rf test/io_tests
+
+mkdir -p test/io_tests
+mpirun -n 2 --quiet ./build/sdpb --precision=1024 --procsPerNode=1 -s test/test/ -c test/io_tests/ck -o test/io_tests/out_start --maxIterations=10 --verbosity=0 --compressCheckpoint
+mpirun -n 1 --quiet ./build/sdpb --precision=1024 --noFinalCheckpoint --procsPerNode=1 -s test/test/ -c test/io_tests/ck -o test/io_tests/out --verbosity=0
+diff test/io_tests/out test/test_out_orig
+if [ $? == 0 ]
+then
+    echo "PASS compressed checkpoint resume"
+else
+    echo "FAIL compressed checkpoint resume"
+    result=1
+fi
+rm -rf test/io_tests
+
+mkdir -p test/io_tests
+./build/pvm2sdp --binary 1024 test/file_list.nsv test/io_tests/binary
+./build/sdpb --precision=1024 --noFinalCheckpoint --procsPerNode=1 -s test/io_tests/binary -c test/io_tests/ck -o test/io_tests/out --verbosity=0
+diff test/io_tests/out test/test_out_orig
+if [ $? == 0 ]
+then
+    echo "PASS binary input"
+else
+    echo "FAIL binary input"
+    result=1
+fi
+rm -rf test/io_tests
+
+mkdir -p test/io_tests
+./build/pvm2sdp --compress 1024 test/file_list.nsv test/io_tests/compressed
+./build/sdpb --precision=1024 --noFinalCheckpoint --procsPerNode=1 -s test/io_tests/compressed -c test/io_tests/ck -o test/io_tests/out --verbosity=0
+diff test/io_tests/out test/test_out_orig
+if [ $? == 0 ]
+then
+    echo "PASS compressed input"
+else
+    echo "FAIL compressed input"
+    result=1
+fi
+rm -rf test/io_tests
+
+# Convert the JSON example to CBOR, with the numbers as decimal text
+# strings, and check that it solves exactly like the JSON.
+mkdir -p test/io_tests
+python3 - test/sdp2input_test.json test/io_tests/sdp2input_test.cbor <<'EOF'
+import json, struct, sys
+
+def head(major, n):
+    if n < 24:
+        return bytes([major << 5 | n])
+    for additional, format in ((24, '>B'), (25, '>H'), (26, '>I')):
+        if n < 1 << (8 * struct.calcsize(format)):
+            return bytes([major << 5 | additional]) + struct.pack(format, n)
+    return bytes([major << 5 | 27]) + struct.pack('>Q', n)
+
+def encode(x):
+    if isinstance(x, dict):
+        return head(5, len(x)) + b''.join(encode(k) + encode(v)
+                                          for k, v in x.items())
+    if isinstance(x, list):
+        return head(4, len(x)) + b''.join(encode(v) for v in x)
+    text = str(x).encode()
+    return head(3, len(text)) + text
+
+with open(sys.argv[1]) as input, open(sys.argv[2], 'wb') as output:
+    output.write(encode(json.load(input)))
+EOF
+./build/sdp2input --precision=1024 --input=test/sdp2input_test.json --output=test/io_tests/json
+./build/sdpb --precision=1024 --noFinalCheckpoint --procsPerNode=1 -s test/io_tests/json -c test/io_tests/ck -o test/io_tests/json_out --verbosity=0
+./build/sdp2input --precision=1024 --input=test/io_tests/sdp2input_test.cbor --output=test/io_tests/cbor
+./build/sdpb --precision=1024 --noFinalCheckpoint --procsPerNode=1 -s test/io_tests/cbor -c test/io_tests/ck -o test/io_tests/cbor_out --verbosity=0
+diff test/io_tests/cbor_out test/io_tests/json_out
+if [ $? == 0 ]
+then
+    echo "PASS CBOR input"
+else
+    echo "FAIL CBOR input"
+    result=1
+fi
+rm -rf test/io_tests
+
+mkdir -p test/io_tests
+./build/sdp2input --precision=1024 --binary --input=test/sdp2input_test.json --output=test/io_tests/json
+./build/sdpb --precision=1024 --noFinalCheckpoint --procsPerNode=1 -s test/io_tests/json -c test/io_tests/ck -o test/io_tests/json_out --verbosity=0
+./build/sdp2sdpb --input=test/sdp2input_test.json --precision=1024 --noFinalCheckpoint --procsPerNode=1 -s test/io_tests/json -c test/io_tests/ck_in_memory -o test/io_tests/in_memory_out --verbosity=0
+diff test/io_tests/in_memory_out test/io_tests/json_out
+if [ $? == 0 ]
+then
+    echo "PASS sdp2sdpb"
+else
+    echo "FAIL sdp2sdpb"
+    result=1
+fi
+rm -rf test/io_tests
+
+mkdir -p test/io_tests
+./build/sdpb --precision=1024 --noFinalCheckpoint --procsPerNode=1 -s test/test/ -c test/io_tests/ck -o test/io_tests/out --matrixBackend=mpmat --verbosity=0
+diff test/io_tests/out test/test_out_orig
+if [ $? == 0 ]
+then
+    echo "PASS matrixBackend=mpmat"
+else
+    echo "FAIL matrixBackend=mpmat"
+    result=1
+fi
+rm -rf test/io_tests
+
+mkdir -p test/io_tests
+./build/sdpb --precision=1024 --noFinalCheckpoint --procsPerNode=1 -s test/test/ -c test/io_tests/ck -o test/io_tests/out --matrixBackend=fixedpoint --verbosity=0
+diff test/io_tests/out test/test_out_orig
+if [ $? == 0 ]
+then
+    echo "PASS matrixBackend=fixedpoint"
+else
+    echo "FAIL matrixBackend=fixedpoint"
+    result=1
+fi
+rm -rf test/io_tests
+
+mkdir -p test/io_tests
+./build/sdpb --precision=1024 --noFinalCheckpoint --procsPerNode=1 -s test/test/ -c test/io_tests/ck -o test/io_tests/out --matrixBackend=simd --verbosity=0
+diff test/io_tests/out test/test_out_orig
+if [ $? == 0 ]
+then
+    echo "PASS matrixBackend=simd"
+else
+    echo "FAIL matrixBackend=simd"
+    result=1
+fi
+rm -rf test/io_tests
+
+# The double and doubleDouble kernels cannot reproduce the 1024 bit
+# output, so only check that they converge with looser thresholds.
+mkdir -p test/io_tests
+./build/sdpb --scalar=double --dualityGapThreshold=1e-8 --primalErrorThreshold=1e-8 --dualErrorThreshold=1e-8 --noFinalCheckpoint --procsPerNode=1 -s test/test/ -c test/io_tests/ck -o test/io_tests/out --verbosity=0
+grep -q 'terminateReason = "found primal-dual optimal solution";' test/io_tests/out/out.txt
+if [ $? == 0 ]
+then
+    echo "PASS scalar=double"
+else
+    echo "FAIL scalar=double"
+    result=1
+fi
+rm -rf test/io_tests
+
+mkdir -p test/io_tests
+./build/sdpb --scalar=doubleDouble --dualityGapThreshold=1e-20 --primalErrorThreshold=1e-20 --dualErrorThreshold=1e-20 --noFinalCheckpoint --procsPerNode=1 -s test/test/ -c test/io_tests/ck -o test/io_tests/out --verbosity=0
+grep -q 'terminateReason = "found primal-dual optimal solution";' test/io_tests/out/out.txt
+if [ $? == 0 ]
+then
+    echo "PASS scalar=doubleDouble"
+else
+    echo "FAIL scalar=doubleDouble"
+    result=1
+fi
+rm -rf test/io_tests
+
+# SIGUSR1 saves a checkpoint and continues, and SIGTERM saves one and
+# stops.  The duality gap threshold of 0 is never reached, so the
+# solver is still running when the signals arrive.
+mkdir -p test/io_tests
+./build/sdpb --precision=1024 --noFinalCheckpoint --procsPerNode=1 -s test/test/ -c test/io_tests/ck -o test/io_tests/out --dualityGapThreshold=0 --maxIterations=100000 --verbosity=1 > test/io_tests/log 2>&1 &
+pid=$!
+for i in $(seq 600)
+do
+    grep -q "^5 " test/io_tests/log && break
+    sleep 0.1
+done
+kill -USR1 $pid
+for i in $(seq 600)
+do
+    [ -f test/io_tests/ck/checkpoint.json ] && break
+    sleep 0.1
+done
+[ -f test/io_tests/ck/checkpoint.json ]
+has_checkpoint=$?
+kill -TERM $pid
+wait $pid
+if [ $has_checkpoint == 0 ] && grep -q 'terminateReason = "termination signal received";' test/io_tests/out/out.txt
+then
+    echo "PASS signals"
+else
+    echo "FAIL signals"
+    result=1
+fi
+rm -rf test/io_tests
+
+mkdir -p test/io_tests
+mpirun -n 2 --quiet ./build/sdpb --precision=1024 --noFinalCheckpoint --procsPerNode=1 -s test/test/ -c test/io_tests/ck -o test/io_tests/out --replicateQThreshold=0 --verbosity=0
+check_objectives test/io_tests/out
+if [ $? == 0 ]
+then
+    echo "PASS distributed Q"
+else
+    echo "FAIL distributed Q"
+    result=1
+fi
+rm -rf test/io_tests
+
+mkdir -p test/io_tests
+./build/sdpb --precision=1024 --noFinalCheckpoint -s test/test/ -c test/io_tests/ck -o test/io_tests/out --verbosity=0 --procsPerNode=1 --stepLengthAlgorithm=lanczos
+check_objectives test/io_tests/out
+if [ $? == 0 ]
+then
+    echo "PASS lanczos"
+else
+    echo "FAIL lanczos"
+    result=1
+fi
+rm -rf test/io_tests
+
+mkdir -p test/io_tests
+mpirun -n 2 --quiet ./build/sdpb --precision=1024 --noFinalCheckpoint -s test/test/ -c test/io_tests/ck -o test/io_tests/out --verbosity=0 --procsPerNode=2 --stepLengthAlgorithm=lanczos
+check_objectives test/io_tests/out
+if [ $? == 0 ]
+then
+    echo "PASS lanczos distributed"
+else
+    echo "FAIL lanczos distributed"
+    result=1
+fi
+rm -rf test/io_tests
+
+mkdir -p test/io_tests
+./build/sdpb --precision=1024 --noFinalCheckpoint -s test/test/ -c test/io_tests/ck -o test/io_tests/out --verbosity=0 --procsPerNode=1 --overlapQCholesky
+diff test/io_tests/out test/test_out_orig
+if [ $? == 0 ]
+then
+    echo "PASS overlapQCholesky"
+else
+    echo "FAIL overlapQCholesky"
+    result=1
+fi
+rm -rf test/io_tests
+
+mkdir -p test/io_tests
+./build/sdpb --precision=1024 --noFinalCheckpoint -s test/test/ -c test/io_tests/ck -o test/io_tests/out --verbosity=0 --procsPerNode=1 --threadsPerProc=4
+diff test/io_tests/out test/test_out_orig
+if [ $? == 0 ]
+then
+    echo "PASS threadsPerProc"
+else
+    echo "FAIL threadsPerProc"
+    result=1
+fi
+rm -rf test/io_tests
+
+mkdir -p test/io_tests
+mpirun -n 4 --oversubscribe --quiet ./build/sdpb --precision=1024 --noFinalCheckpoint -s test/test/ -c test/io_tests/ck -o test/io_tests/out --verbosity=0 --procsPerNode=2 --replicateQThreshold=0 --hierarchicalQReduction
+check_objectives test/io_tests/out
+if [ $? == 0 ]
+then
+    echo "PASS hierarchicalQReduction"
+else
+    echo "FAIL hierarchicalQReduction"
+    result=1
+fi
+rm -rf test/io_tests
+
+mkdir -p test/io_tests
+mpirun -n 4 --oversubscribe --quiet ./build/sdpb --precision=1024 --noFinalCheckpoint -s test/test/ -c test/io_tests/ck -o test/io_tests/out --verbosity=0 --procsPerNode=2 --replicateQThreshold=0
+check_objectives test/io_tests/out
+if [ $? == 0 ]
+then
+    echo "PASS Q ring"
+else
+    echo "FAIL Q ring"
+    result=1
+fi
+rm -rf test/io_tests
+
+mkdir -p test/io_tests
+mpirun -n 4 --oversubscribe --quiet ./build/sdpb --precision=1024 --noFinalCheckpoint -s test/test/ -c test/io_tests/ck -o test/io_tests/out --verbosity=0 --procsPerNode=2 --replicateQThreshold=0 --overlapQSynchronization
+check_objectives test/io_tests/out
+if [ $? == 0 ]
+then
+    echo "PASS overlapQSynchronization"
+else
+    echo "FAIL overlapQSynchronization"
+    result=1
+fi
+rm -rf test/io_tests
+
+mkdir -p test/io_tests
+mpirun -n 2 --quiet ./build/sdpb --precision=1024 --noFinalCheckpoint -s test/test/ -c test/io_tests/ck -o test/io_tests/out --verbosity=0 --procsPerNode=2 --replicateQThreshold=0 --matrixBackend=mpmat
+check_objectives test/io_tests/out
+if [ $? == 0 ]
+then
+    echo "PASS matrixBackend=mpmat distributed"
+else
+    echo "FAIL matrixBackend=mpmat distributed"
+    result=1
+fi
+rm -rf test/io_tests
+
 exit $result